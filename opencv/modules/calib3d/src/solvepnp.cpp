@@ -81,31 +81,6 @@ namespace cv
             transform(points, modif_points, transformation);
         }
         
-        class Mutex
-        {
-        public:
-            Mutex() {}
-            void lock()
-            {
-#ifdef HAVE_TBB
-                slock.acquire(resultsMutex);
-#endif
-            }
-            
-            void unlock()
-            {
-#ifdef HAVE_TBB
-                slock.release();
-#endif
-            }
-            
-        private:
-#ifdef HAVE_TBB
-            tbb::mutex resultsMutex;
-            tbb::mutex::scoped_lock slock;
-#endif
-        };
-        
         struct CameraParameters
         {
             void init(Mat _intrinsics, Mat _distCoeffs)
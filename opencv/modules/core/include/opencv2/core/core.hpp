@@ -260,6 +260,7 @@ CV_EXPORTS_W int64 getCPUTickCount();
   - CV_CPU_SSE4_2 - SSE 4.2
   - CV_CPU_POPCNT - POPCOUNT
   - CV_CPU_AVX - AVX
+  - CV_CPU_AVX2 - AVX 2
   
   \note {Note that the function output is not static. Once you called cv::useOptimized(false),
   most of the hardware acceleration is disabled and thus the function will returns false,
@@ -267,6 +268,14 @@ CV_EXPORTS_W int64 getCPUTickCount();
 */
 CV_EXPORTS_W bool checkHardwareSupport(int feature);
 
+/*!
+  Enables or disables the use of the particular CPU feature by the optimized code.
+
+  A feature that is not supported by the host hardware can not be enabled. The function
+  is mainly intended for benchmarking and testing the code paths for different instruction sets.
+*/
+CV_EXPORTS void setUseHardwareFeature(int feature, bool flag);
+
 //! returns the number of CPUs (including hyper-threading)
 CV_EXPORTS_W int getNumberOfCPUs();
     
@@ -1370,6 +1379,73 @@ public:
                           uchar*& datastart, uchar*& data, size_t* step) = 0;
     virtual void deallocate(int* refcount, uchar* datastart, uchar* data) = 0;
 };
+
+/*!
+   Pooled array allocator
+
+   The allocator keeps the released buffers in the free lists bucketed by size class
+   (4 classes per power of two) instead of returning them to the system, so re-creating matrices
+   of the same size, e.g. the frames in a video processing loop, does not call malloc().
+   Each thread has its own free lists; the buffers that do not fit into the thread cache go to
+   the shared pool, which is also used when a buffer is allocated and released by different threads.
+
+   The allocator can be set for the particular matrix (Mat::allocator) or for all the matrices
+   created without an explicit allocator (see cv::setDefaultMatAllocator()).
+   It must outlive all the buffers allocated by it.
+*/
+class CV_EXPORTS PoolMatAllocator : public MatAllocator
+{
+public:
+    struct CV_EXPORTS Stats
+    {
+        Stats();
+        //! the number of allocations served from the pool
+        int64 hits;
+        //! the number of allocations that had to allocate a new buffer
+        int64 misses;
+        //! the total size of the free buffers kept in the pool
+        size_t bytesHeld;
+        //! the number of the free buffers kept in the pool
+        size_t blocksHeld;
+    };
+
+    //! the buffers larger than that are allocated and freed directly
+    enum { MAX_CACHED_SIZE = 1 << 30 };
+
+    /*!
+     \param maxThreadBytes the maximum total size of the free buffers kept by each thread
+     \param maxSharedBytes the maximum total size of the free buffers kept in the shared pool
+    */
+    PoolMatAllocator(size_t maxThreadBytes=(size_t)1 << 28, size_t maxSharedBytes=(size_t)1 << 28);
+    virtual ~PoolMatAllocator();
+
+    virtual void allocate(int dims, const int* sizes, int type, int*& refcount,
+                          uchar*& datastart, uchar*& data, size_t* step);
+    virtual void deallocate(int* refcount, uchar* datastart, uchar* data);
+
+    //! returns the pool statistics, accumulated over all the threads
+    Stats getStats() const;
+    //! releases all the free buffers kept in the pool; returns the number of released bytes
+    size_t trim();
+
+protected:
+    void* impl;
+
+private:
+    PoolMatAllocator(const PoolMatAllocator&);
+    PoolMatAllocator& operator = (const PoolMatAllocator&);
+};
+
+/*!
+ sets the allocator used by Mat::create() for the matrices without own allocator (0 means cv::fastMalloc()).
+
+ The default allocator is looked up for every new buffer. The matrix header refers to it
+ only while it holds that buffer: Mat::release() resets Mat::allocator back to 0,
+ so the default allocator can be replaced or destroyed once the buffers allocated by it are released.
+*/
+CV_EXPORTS void setDefaultMatAllocator(MatAllocator* allocator);
+//! returns the allocator set by cv::setDefaultMatAllocator()
+CV_EXPORTS MatAllocator* getDefaultMatAllocator();
     
 /*!
    The n-dimensional matrix class.
@@ -1847,13 +1923,15 @@ public:
     template<typename _Tp> MatConstIterator_<_Tp> begin() const;
     template<typename _Tp> MatConstIterator_<_Tp> end() const;
 
-    enum { MAGIC_VAL=0x42FF0000, AUTO_STEP=0, CONTINUOUS_FLAG=CV_MAT_CONT_FLAG, SUBMATRIX_FLAG=CV_SUBMAT_FLAG };
+    enum { MAGIC_VAL=0x42FF0000, AUTO_STEP=0, CONTINUOUS_FLAG=CV_MAT_CONT_FLAG, SUBMATRIX_FLAG=CV_SUBMAT_FLAG,
+           DEFAULT_ALLOCATOR_FLAG=1 << 12 };
 
     /*! includes several bit-fields:
          - the magic signature
          - continuity flag
          - depth
          - number of channels
+         - the flag telling that the allocator was taken from cv::setDefaultMatAllocator()
      */
     int flags;
     //! the matrix dimensionality, >= 2
@@ -3771,6 +3849,11 @@ class CV_EXPORTS FileNode;
  
  The class describes an object associated with XML or YAML file.
  It can be used to store data to such a file or read and decode the data.
+ The same data can also be stored in the binary format (the ".bin" extension),
+ where the matrices are read directly from the memory-mapped file, without copying.
+ Huge YAML files can be opened with READ+STREAM flags; then the top-level sequences
+ are not kept in memory, their elements are parsed one by one as they are accessed
+ via FileNode or FileNodeIterator (their CvSeq headers are empty).
  
  The storage is organized as a tree of nested sequences (or lists) and mappings.
  Sequence is a heterogenious array, which elements are accessed by indices or sequentially using an iterator.
@@ -3871,7 +3954,8 @@ public:
     {
         READ=0, //! read mode
         WRITE=1, //! write mode
-        APPEND=2 //! append mode
+        APPEND=2, //! append mode
+        STREAM=4 //! can be combined with READ; the top-level YAML sequences are parsed on demand
     };
     enum
     {
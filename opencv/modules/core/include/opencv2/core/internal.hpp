@@ -154,6 +154,40 @@ CV_INLINE IppiSize ippiSize(int width, int height)
 
 #ifdef __cplusplus
 
+    namespace cv
+    {
+        /*!
+         Lightweight mutex, used by the built-in parallel framework and by the parallel loop bodies
+         that need to serialize access to shared state.
+        */
+        class CV_EXPORTS Mutex
+        {
+        public:
+            Mutex();
+            ~Mutex();
+            void lock();
+            bool trylock();
+            void unlock();
+
+        protected:
+            void* impl;
+
+        private:
+            Mutex(const Mutex&);
+            Mutex& operator = (const Mutex&);
+        };
+
+        class CV_EXPORTS AutoLock
+        {
+        public:
+            AutoLock(Mutex& m) : mutex(&m) { mutex->lock(); }
+            ~AutoLock() { mutex->unlock(); }
+
+        protected:
+            Mutex* mutex;
+        };
+    }
+
 #ifdef HAVE_TBB
     namespace cv
     {
@@ -198,6 +232,7 @@ CV_INLINE IppiSize ippiSize(int width, int height)
             int _begin, _end, _grainsize;
         };
 
+        class Split {};
 
 #ifdef HAVE_THREADING_FRAMEWORK 
 #include "opencv2/core/threading_framework.hpp"
@@ -211,30 +246,162 @@ CV_INLINE IppiSize ippiSize(int width, int height)
         typedef tf::ConcurrentVector<Rect> ConcurrentRectVector;
         typedef tf::ConcurrentVector<double> ConcurrentDoubleVector;
 #else
+        /*!
+         The base class for the loop bodies executed by the built-in thread pool.
+         parallel_for() wraps an arbitrary TBB-style body into it, so the invokers do not need to derive from it.
+        */
+        class CV_EXPORTS ParallelLoopBody
+        {
+        public:
+            virtual ~ParallelLoopBody();
+            virtual void operator()(const BlockedRange& range) const = 0;
+        };
+
+        /*!
+         Runs body over the range using the built-in work-stealing thread pool.
+
+         The range is cut into chunks of at least range.grainsize() iterations that are spread
+         among getNumThreads() threads (the calling thread participates too); idle threads steal
+         the remaining chunks from the busy ones. The calls made from inside a parallel region
+         (nested loops) or while the pool is busy with another caller's loop are executed serially
+         by the calling thread, so the number of running threads never exceeds getNumThreads().
+        */
+        CV_EXPORTS void parallel_for_( const BlockedRange& range, const ParallelLoopBody& body );
+
+        template<typename Body> class ParallelLoopBodyWrapper : public ParallelLoopBody
+        {
+        public:
+            ParallelLoopBodyWrapper(const Body& _body) : body(&_body) {}
+            void operator()(const BlockedRange& range) const { (*body)(range); }
+
+        protected:
+            const Body* body;
+        };
+
         template<typename Body> static inline
         void parallel_for( const BlockedRange& range, const Body& body )
         {
-            body(range); 
+            parallel_for_(range, ParallelLoopBodyWrapper<Body>(body));
         }
-        typedef std::vector<Rect> ConcurrentRectVector;
-        typedef std::vector<double> ConcurrentDoubleVector;
+
+        //! the maximum number of partial bodies created by parallel_reduce
+        enum { PARALLEL_REDUCE_MAX_CHUNKS = 64 };
+
+        template<typename Body> class ParallelReduceBodyWrapper : public ParallelLoopBody
+        {
+        public:
+            ParallelReduceBodyWrapper(const BlockedRange& _range, int _nchunks, Body** _bodies)
+                : range(_range), nchunks(_nchunks), bodies(_bodies) {}
+
+            void operator()(const BlockedRange& r) const
+            {
+                int64 len = range.end() - range.begin();
+                for( int i = r.begin(); i < r.end(); i++ )
+                {
+                    int b = range.begin() + (int)(len*i/nchunks);
+                    int e = range.begin() + (int)(len*(i+1)/nchunks);
+                    (*bodies[i])(BlockedRange(b, e, range.grainsize()));
+                }
+            }
+
+        protected:
+            BlockedRange range;
+            int nchunks;
+            Body** bodies;
+        };
+
+        /*!
+         Reduces the range in parallel using TBB-style split constructor Body(Body&, Split) and Body::join().
+
+         The range is divided into chunks that depend only on the range and its grain size,
+         and the partial results are joined from left to right, so the result does not depend
+         on the number of threads or on the scheduling.
+        */
+        template<typename Body> static inline
+        void parallel_reduce( const BlockedRange& range, Body& body )
+        {
+            int len = range.end() - range.begin(), grain = std::max(range.grainsize(), 1);
+            int nchunks = std::min((len + grain - 1)/grain, (int)PARALLEL_REDUCE_MAX_CHUNKS);
+            if( nchunks <= 1 )
+            {
+                body(range);
+                return;
+            }
+
+            std::vector<Body*> bodies(nchunks, (Body*)0);
+            bodies[0] = &body;
+            try
+            {
+                for( int i = 1; i < nchunks; i++ )
+                    bodies[i] = new Body(body, Split());
+                parallel_for_(BlockedRange(0, nchunks), ParallelReduceBodyWrapper<Body>(range, nchunks, &bodies[0]));
+                for( int i = 1; i < nchunks; i++ )
+                    body.join(*bodies[i]);
+            }
+            catch(...)
+            {
+                for( int i = 1; i < nchunks; i++ )
+                    delete bodies[i];
+                throw;
+            }
+            for( int i = 1; i < nchunks; i++ )
+                delete bodies[i];
+        }
+
+        /*!
+         std::vector with the thread-safe push_back(), used to collect the results of parallel_for bodies.
+         The other methods must not be called concurrently with push_back().
+        */
+        template<typename T> class ConcurrentVector : public std::vector<T>
+        {
+        public:
+            ConcurrentVector() {}
+            void push_back(const T& elem)
+            {
+                AutoLock lock(mutex);
+                std::vector<T>::push_back(elem);
+            }
+
+        protected:
+            Mutex mutex;
+        };
+
+        typedef ConcurrentVector<Rect> ConcurrentRectVector;
+        typedef ConcurrentVector<double> ConcurrentDoubleVector;
 #endif
         
+        template<typename Iterator, typename Body> class ParallelDoBodyWrapper
+        {
+        public:
+            ParallelDoBodyWrapper(const std::vector<Iterator>& _items, const Body& _body)
+                : items(&_items), body(&_body) {}
+            void operator()(const BlockedRange& range) const
+            {
+                for( int i = range.begin(); i < range.end(); i++ )
+                    (*body)(*(*items)[i]);
+            }
+
+        protected:
+            const std::vector<Iterator>* items;
+            const Body* body;
+        };
+
         template<typename Iterator, typename Body> static inline
         void parallel_do( Iterator first, Iterator last, const Body& body )
         {
+            std::vector<Iterator> items;
             for( ; first != last; ++first )
-                body(*first);
+                items.push_back(first);
+            parallel_for(BlockedRange(0, (int)items.size()), ParallelDoBodyWrapper<Iterator, Body>(items, body));
         }
         
-        class Split {};
-        
+#ifdef HAVE_THREADING_FRAMEWORK
         template<typename Body> static inline
         void parallel_reduce( const BlockedRange& range, Body& body )
         {
             body(range);
         }
-        
+#endif
     }
 #endif
 #endif
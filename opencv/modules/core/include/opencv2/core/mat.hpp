@@ -383,6 +383,12 @@ inline void Mat::release()
     data = datastart = dataend = datalimit = 0;
     size.p[0] = 0;
     refcount = 0;
+    // the default allocator is bound to the released buffer, not to the header
+    if( flags & DEFAULT_ALLOCATOR_FLAG )
+    {
+        allocator = 0;
+        flags &= ~DEFAULT_ALLOCATOR_FLAG;
+    }
 }
 
 inline Mat Mat::operator()( Range rowRange, Range colRange ) const
@@ -967,6 +967,9 @@ CV_EXPORTS float normL1_(const float* a, const float* b, int n);
 CV_EXPORTS int normL1_(const uchar* a, const uchar* b, int n);
 CV_EXPORTS int normHamming(const uchar* a, const uchar* b, int n);
 CV_EXPORTS int normHamming(const uchar* a, const uchar* b, int n, int cellSize);
+//! computes the Hamming distances between a and each of the count vectors b, b + bstep, ..., b + bstep*(count-1)
+CV_EXPORTS void batchNormHamming(const uchar* a, const uchar* b, size_t bstep,
+                                 int n, int count, int* dist, int cellSize=1);
     
 template<> inline float normL2Sqr(const float* a, const float* b, int n)
 {
@@ -2844,13 +2847,6 @@ inline bool FileNode::isInt() const { return type() == INT; }
 inline bool FileNode::isReal() const { return type() == REAL; }
 inline bool FileNode::isString() const { return type() == STR; }
 inline bool FileNode::isNamed() const { return !node ? false : (node->tag & NAMED) != 0; }
-inline size_t FileNode::size() const
-{
-    int t = type();
-    return t == MAP ? ((CvSet*)node->data.map)->active_count :
-        t == SEQ ? node->data.seq->total : node != 0;
-}
-
 inline CvFileNode* FileNode::operator *() { return (CvFileNode*)node; }
 inline const CvFileNode* FileNode::operator* () const { return node; }
 
@@ -2997,12 +2993,6 @@ inline FileNodeIterator FileNode::end() const
     return FileNodeIterator(fs, node, size());
 }
 
-inline FileNode FileNodeIterator::operator *() const
-{ return FileNode(fs, (const CvFileNode*)reader.ptr); }
-
-inline FileNode FileNodeIterator::operator ->() const
-{ return FileNode(fs, (const CvFileNode*)reader.ptr); }
-
 template<typename _Tp> static inline FileNodeIterator& operator >> (FileNodeIterator& it, _Tp& value)
 { read( *it, value, _Tp()); return ++it; }
 
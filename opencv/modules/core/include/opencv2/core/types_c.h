@@ -1733,6 +1733,8 @@ typedef struct CvFileStorage CvFileStorage;
 #define CV_STORAGE_WRITE_TEXT    CV_STORAGE_WRITE
 #define CV_STORAGE_WRITE_BINARY  CV_STORAGE_WRITE
 #define CV_STORAGE_APPEND        2
+/* can be combined with CV_STORAGE_READ: the top-level YAML sequences are parsed lazily */
+#define CV_STORAGE_STREAM        4
 
 /* List of attributes: */
 typedef struct CvAttrList
@@ -1,4 +1,5 @@
 #include "perf_precomp.hpp"
+#include "opencv2/core/core_c.h"
 
 using namespace std;
 using namespace cv;
@@ -61,6 +62,61 @@ PERF_TEST_P__CORE_ARITHM_SCALAR(add, TYPICAL_MATS_CORE_ARITHM)
 PERF_TEST_P__CORE_ARITHM_SCALAR(subtract, TYPICAL_MATS_CORE_ARITHM)
 PERF_TEST_P__CORE_ARITHM_SCALAR(absdiff, TYPICAL_MATS_CORE_ARITHM)
 
+/*
+// The same operations with the optimized code restricted to the particular instruction set,
+// so the speedup of each kernel level can be seen on a single machine
+*/
+CV_ENUM(CpuFeature, CV_CPU_NONE, CV_CPU_SSE2, CV_CPU_AVX2)
+typedef std::tr1::tuple<Size, MatType, CpuFeature> Size_MatType_CpuFeature_t;
+typedef perf::TestBaseWithParam<Size_MatType_CpuFeature_t> Size_MatType_CpuFeature;
+
+#define TYPICAL_MAT_TYPES_ARITHM_ISA    CV_8UC1, CV_16SC1, CV_32SC1, CV_32FC1
+#define TYPICAL_MATS_ARITHM_ISA         testing::Combine( testing::Values( TYPICAL_MAT_SIZES_CORE_ARITHM ), testing::Values( TYPICAL_MAT_TYPES_ARITHM_ISA ), testing::ValuesIn( CpuFeature::all() ) )
+
+class CpuFeatureLimit
+{
+public:
+    CpuFeatureLimit(int feature)
+    {
+        setUseOptimized(feature != CV_CPU_NONE);
+        setUseHardwareFeature(CV_CPU_AVX2, feature >= CV_CPU_AVX2);
+    }
+    ~CpuFeatureLimit()
+    {
+        setUseOptimized(true);
+        setUseHardwareFeature(CV_CPU_AVX2, true);
+    }
+};
+
+static void compareGT(InputArray a, InputArray b, OutputArray c) { compare(a, b, c, CMP_GT); }
+static void addWeightedHalf(InputArray a, InputArray b, OutputArray c) { addWeighted(a, 0.5, b, 0.5, 0, c); }
+
+#define PERF_TEST_P__CORE_ARITHM_ISA(__f, __testset) \
+PERF_TEST_P(Size_MatType_CpuFeature, core_arithm_isa__ ## __f, __testset)  \
+{                                                              \
+    Size sz = std::tr1::get<0>(GetParam());                    \
+    int type = std::tr1::get<1>(GetParam());                   \
+    CpuFeatureLimit limit(std::tr1::get<2>(GetParam()));       \
+    cv::Mat a = Mat(sz, type);                                 \
+    cv::Mat b = Mat(sz, type);                                 \
+    cv::Mat c = Mat(sz, type);                                 \
+                                                               \
+    declare.in(a, b, WARMUP_RNG)                               \
+        .out(c);                                               \
+                                                               \
+    TEST_CYCLE(100) __f(a,b, c);                               \
+                                                               \
+    SANITY_CHECK(c);                                           \
+}
+
+PERF_TEST_P__CORE_ARITHM_ISA(add, TYPICAL_MATS_ARITHM_ISA)
+PERF_TEST_P__CORE_ARITHM_ISA(subtract, TYPICAL_MATS_ARITHM_ISA)
+PERF_TEST_P__CORE_ARITHM_ISA(absdiff, TYPICAL_MATS_ARITHM_ISA)
+PERF_TEST_P__CORE_ARITHM_ISA(max, TYPICAL_MATS_ARITHM_ISA)
+PERF_TEST_P__CORE_ARITHM_ISA(bitwise_and, TYPICAL_MATS_ARITHM_ISA)
+PERF_TEST_P__CORE_ARITHM_ISA(compareGT, TYPICAL_MATS_ARITHM_ISA)
+PERF_TEST_P__CORE_ARITHM_ISA(addWeightedHalf, TYPICAL_MATS_ARITHM_ISA)
+
 #ifdef ANDROID
 PERF_TEST(convert, cvRound)
 {
@@ -1,28 +1,75 @@
-#include "perf_precomp.hpp"
-
-using namespace std;
-using namespace cv;
-using namespace perf;
-
-#define MAT_TYPES_DFT  CV_32FC1, CV_64FC1
-#define MAT_SIZES_DFT  sz1080p, sz2K
-#define TEST_MATS_DFT testing::Combine( testing::Values(MAT_SIZES_DFT), testing::Values(MAT_TYPES_DFT) )
-
-PERF_TEST_P(Size_MatType, dft, TEST_MATS_DFT)
-{
-    Size sz = std::tr1::get<0>(GetParam());
-    int type = std::tr1::get<1>(GetParam());
-
-    Mat src(sz, type);
-    Mat dst(sz, type);
- 
-    declare.in(src, WARMUP_RNG);
-    declare.time(60);
-
-    TEST_CYCLE(100) 
-    {
-        dft(src, dst);
-    }
-
-    SANITY_CHECK(dst);
-} 
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+#define MAT_TYPES_DFT  CV_32FC1, CV_64FC1
+#define MAT_SIZES_DFT  sz1080p, sz2K
+#define TEST_MATS_DFT testing::Combine( testing::Values(MAT_SIZES_DFT), testing::Values(MAT_TYPES_DFT) )
+
+PERF_TEST_P(Size_MatType, dft, TEST_MATS_DFT)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int type = std::tr1::get<1>(GetParam());
+
+    Mat src(sz, type);
+    Mat dst(sz, type);
+ 
+    declare.in(src, WARMUP_RNG);
+    declare.time(60);
+
+    TEST_CYCLE(100) 
+    {
+        dft(src, dst);
+    }
+
+    SANITY_CHECK(dst);
+} 
+
+// small fixed-size tiles, transformed over and over again (phase correlation, template matching)
+#define MAT_SIZES_DFT_TILES  Size(32, 32), Size(64, 64), Size(128, 128), Size(100, 100)
+
+PERF_TEST_P(Size_MatType, dft_tiles, testing::Combine(testing::Values(MAT_SIZES_DFT_TILES), testing::Values(MAT_TYPES_DFT)))
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int type = std::tr1::get<1>(GetParam());
+
+    Mat src(sz, type);
+    Mat spectrum(sz, type);
+    Mat dst(sz, type);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE(1000)
+    {
+        dft(src, spectrum);
+        idft(spectrum, dst, DFT_SCALE);
+    }
+
+    SANITY_CHECK(dst);
+}
+
+CV_FLAGS(DftFlags, 0, DFT_INVERSE, DFT_ROWS, DFT_COMPLEX_OUTPUT)
+typedef std::tr1::tuple<Size, MatType, DftFlags> Size_MatType_DftFlags_t;
+typedef perf::TestBaseWithParam<Size_MatType_DftFlags_t> Size_MatType_DftFlags;
+
+PERF_TEST_P(Size_MatType_DftFlags, dft_flags,
+            testing::Combine(testing::Values(szVGA, sz1080p),
+                             testing::Values(CV_32FC1, CV_32FC2, CV_64FC1),
+                             testing::Values((int)0, (int)DFT_INVERSE, (int)DFT_ROWS, (int)DFT_COMPLEX_OUTPUT)))
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int type = std::tr1::get<1>(GetParam());
+    int flags = std::tr1::get<2>(GetParam());
+
+    Mat src(sz, type);
+    Mat dst;
+
+    declare.in(src, WARMUP_RNG);
+    declare.time(60);
+
+    TEST_CYCLE(10) dft(src, dst, flags);
+
+    SANITY_CHECK(dst);
+}
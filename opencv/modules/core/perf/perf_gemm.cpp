@@ -0,0 +1,59 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+using std::tr1::get;
+
+typedef std::tr1::tuple<int, MatType> Order_MatType;
+typedef perf::TestBaseWithParam<Order_MatType> Order_MatType_gemm;
+
+PERF_TEST_P(Order_MatType_gemm, gemm_square,
+            testing::Combine(testing::Values(64, 128, 256, 512, 1024), testing::Values(CV_32FC1, CV_64FC1)))
+{
+    int n = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat a(n, n, type), b(n, n, type), c(n, n, type), dst(n, n, type);
+
+    declare.in(a, b, c, WARMUP_RNG).out(dst);
+    declare.time(100);
+
+    TEST_CYCLE(10) gemm(a, b, 1., c, 1., dst);
+
+    SANITY_CHECK(dst);
+}
+
+// a tall-skinny matrix times a small square one: 100000x16 * 16x16, 100000x64 * 64x64, ...
+PERF_TEST_P(Order_MatType_gemm, gemm_tallSkinny,
+            testing::Combine(testing::Values(16, 64, 128), testing::Values(CV_32FC1, CV_64FC1)))
+{
+    int n = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat a(100000, n, type), b(n, n, type), dst(100000, n, type);
+
+    declare.in(a, b, WARMUP_RNG).out(dst);
+    declare.time(100);
+
+    TEST_CYCLE(10) gemm(a, b, 1., noArray(), 0., dst);
+
+    SANITY_CHECK(dst);
+}
+
+// the same shape through the transposed flavour: (100000xN)^T * 100000xN
+PERF_TEST_P(Order_MatType_gemm, gemm_tallSkinnyAtB,
+            testing::Combine(testing::Values(16, 64, 128), testing::Values(CV_32FC1, CV_64FC1)))
+{
+    int n = get<0>(GetParam());
+    int type = get<1>(GetParam());
+
+    Mat a(100000, n, type), dst(n, n, type);
+
+    declare.in(a, WARMUP_RNG).out(dst);
+    declare.time(100);
+
+    TEST_CYCLE(10) gemm(a, a, 1., noArray(), 0., dst, GEMM_1_T);
+
+    SANITY_CHECK(dst);
+}
@@ -0,0 +1,36 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+#define TYPICAL_MAT_TYPES_MATEXPR  CV_8UC1, CV_8UC3, CV_32FC1
+#define TYPICAL_MATS_MATEXPR       testing::Combine( testing::Values( szVGA, sz1080p, Size(3840, 2160) ), testing::Values( TYPICAL_MAT_TYPES_MATEXPR ) )
+
+PERF_TEST_P(Size_MatType, matexpr_absAddWeightedSub, TYPICAL_MATS_MATEXPR)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int type = std::tr1::get<1>(GetParam());
+
+    Mat a(sz, type), b(sz, type), c(sz, type), dst(sz, type);
+
+    declare.in(a, b, c, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE(100) dst = abs(a*0.5 + b*1.5 - c);
+
+    SANITY_CHECK(dst);
+}
+
+PERF_TEST_P(Size_MatType, matexpr_mulSumDiff, TYPICAL_MATS_MATEXPR)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int type = std::tr1::get<1>(GetParam());
+
+    Mat a(sz, type), b(sz, type), c(sz, type), d(sz, type), dst(sz, type);
+
+    declare.in(a, b, c, d, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE(100) dst = (a + b).mul(c - d, 0.25);
+
+    SANITY_CHECK(dst);
+}
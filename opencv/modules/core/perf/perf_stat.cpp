@@ -434,3 +434,81 @@ PERF_TEST_P( Size_MatType_ROp, reduceC,
     
     SANITY_CHECK(vec);
 }
+
+enum { STAT_SUM, STAT_MEAN_STDDEV, STAT_NORM_L2, STAT_MIN_MAX_LOC, STAT_COUNT_NON_ZERO, STAT_REDUCE_R };
+CV_ENUM(StatFunc, STAT_SUM, STAT_MEAN_STDDEV, STAT_NORM_L2, STAT_MIN_MAX_LOC, STAT_COUNT_NON_ZERO, STAT_REDUCE_R)
+typedef std::tr1::tuple<StatFunc, MatType, int> StatFunc_MatType_Threads_t;
+typedef perf::TestBaseWithParam<StatFunc_MatType_Threads_t> StatFunc_MatType_Threads;
+
+/*
+// the reductions of a large non-continuous array with the given number of threads
+*/
+PERF_TEST_P( StatFunc_MatType_Threads, reduction_threads,
+             testing::Combine( testing::ValuesIn(StatFunc::all()),
+                               testing::Values( CV_8UC1, CV_32FC1 ),
+                               testing::Values( 1, 2, 4 ) ) )
+{
+    int func = std::tr1::get<0>(GetParam());
+    int matType = std::tr1::get<1>(GetParam());
+    int threads = std::tr1::get<2>(GetParam());
+
+    Mat big(2200, 4000, matType);
+    Mat src = big(Rect(10, 10, 3840, 2160));
+    Mat vec;
+    Scalar s;
+    double minVal = 0, maxVal = 0;
+    int cnt = 0;
+
+    declare.in(src, WARMUP_RNG);
+
+    int threads0 = getNumThreads();
+    setNumThreads(threads);
+
+    TEST_CYCLE(100)
+    {
+        switch( func )
+        {
+        case STAT_SUM: s = sum(src); break;
+        case STAT_MEAN_STDDEV: meanStdDev(src, s, noArray()); break;
+        case STAT_NORM_L2: s[0] = norm(src, NORM_L2); break;
+        case STAT_MIN_MAX_LOC: minMaxLoc(src, &minVal, &maxVal); break;
+        case STAT_COUNT_NON_ZERO: cnt = countNonZero(src); break;
+        case STAT_REDUCE_R: reduce(src, vec, 0, CV_REDUCE_SUM, CV_64F); break;
+        }
+    }
+
+    setNumThreads(threads0);
+
+    SANITY_CHECK(s);
+    SANITY_CHECK(minVal);
+    SANITY_CHECK(maxVal);
+    SANITY_CHECK(cnt);
+}
+
+CV_ENUM(HammingCpuFeature, CV_CPU_NONE, CV_CPU_POPCNT, CV_CPU_AVX2)
+typedef std::tr1::tuple<int, HammingCpuFeature> DescriptorSize_CpuFeature_t;
+typedef perf::TestBaseWithParam<DescriptorSize_CpuFeature_t> DescriptorSize_CpuFeature;
+
+/*
+// void batchNormHamming(const uchar* a, const uchar* b, size_t bstep, int n, int count, int* dist, int cellSize)
+*/
+PERF_TEST_P( DescriptorSize_CpuFeature, batchNormHamming,
+             testing::Combine( testing::Values(32, 64), testing::ValuesIn(HammingCpuFeature::all()) ) )
+{
+    int n = std::tr1::get<0>(GetParam());
+    int feature = std::tr1::get<1>(GetParam());
+
+    Mat query(1, n, CV_8U), train(100000, n, CV_8U), dist(1, train.rows, CV_32S);
+
+    declare.in(query, train, WARMUP_RNG).out(dist);
+
+    setUseHardwareFeature(CV_CPU_POPCNT, feature >= CV_CPU_POPCNT);
+    setUseHardwareFeature(CV_CPU_AVX2, feature >= CV_CPU_AVX2);
+
+    TEST_CYCLE(100) batchNormHamming(query.data, train.data, train.step, n, train.rows, dist.ptr<int>());
+
+    setUseHardwareFeature(CV_CPU_POPCNT, true);
+    setUseHardwareFeature(CV_CPU_AVX2, true);
+
+    SANITY_CHECK(dist);
+}
@@ -676,6 +676,305 @@ void fastFree( void* ptr )
 
 #endif
 
+/****************************************************************************************\
+*                                   Pooled Mat allocator                                 *
+\****************************************************************************************/
+
+// the header stored in front of every buffer allocated by PoolMatAllocator
+struct PoolBlock
+{
+    PoolBlock* next;
+    size_t capacity;
+    int sizeClass;
+};
+
+enum
+{
+    POOL_HDR_SIZE = (sizeof(PoolBlock) + CV_MALLOC_ALIGN - 1) & -CV_MALLOC_ALIGN,
+    POOL_MIN_CLASS_SHIFT = 6,
+    POOL_MAX_CLASS_SHIFT = 30,
+    POOL_NCLASSES = (POOL_MAX_CLASS_SHIFT - POOL_MIN_CLASS_SHIFT)*4 + 1
+};
+
+// There are 4 size classes per power of two: (1 + j/4)*2^k, j=1..4, and the single class
+// for the buffers smaller than 2^POOL_MIN_CLASS_SHIFT bytes. Returns -1 for the buffers that are not cached.
+static int poolSizeClass(size_t size, size_t& capacity)
+{
+    if( size <= ((size_t)1 << POOL_MIN_CLASS_SHIFT) )
+    {
+        capacity = (size_t)1 << POOL_MIN_CLASS_SHIFT;
+        return 0;
+    }
+    if( size > ((size_t)1 << POOL_MAX_CLASS_SHIFT) )
+    {
+        capacity = size;
+        return -1;
+    }
+    int k = POOL_MIN_CLASS_SHIFT;
+    while( ((size_t)2 << k) < size )
+        k++;
+    size_t q = (size_t)1 << (k - 2);
+    int j = (int)((size - 1 - ((size_t)1 << k))/q);
+    capacity = ((size_t)1 << k) + (j + 1)*q;
+    return (k - POOL_MIN_CLASS_SHIFT)*4 + j + 1;
+}
+
+struct PoolAllocatorImpl;
+
+struct PoolCache
+{
+    PoolCache(PoolAllocatorImpl* _pool=0) : pool(_pool), bytesHeld(0), blocksHeld(0), hits(0), misses(0)
+    {
+        memset(bins, 0, sizeof(bins));
+    }
+
+    PoolBlock* pop(int idx)
+    {
+        PoolBlock* block = bins[idx];
+        if( block )
+        {
+            bins[idx] = block->next;
+            bytesHeld -= block->capacity;
+            blocksHeld--;
+        }
+        return block;
+    }
+
+    bool push(PoolBlock* block, size_t maxBytes)
+    {
+        if( bytesHeld + block->capacity > maxBytes )
+            return false;
+        block->next = bins[block->sizeClass];
+        bins[block->sizeClass] = block;
+        bytesHeld += block->capacity;
+        blocksHeld++;
+        return true;
+    }
+
+    size_t release()
+    {
+        size_t released = bytesHeld;
+        for( int i = 0; i < POOL_NCLASSES; i++ )
+        {
+            PoolBlock* block = bins[i];
+            while( block )
+            {
+                PoolBlock* next = block->next;
+                fastFree(block);
+                block = next;
+            }
+            bins[i] = 0;
+        }
+        bytesHeld = blocksHeld = 0;
+        return released;
+    }
+
+    PoolAllocatorImpl* pool;
+    Mutex mutex;
+    PoolBlock* bins[POOL_NCLASSES];
+    size_t bytesHeld, blocksHeld;
+    int64 hits, misses;
+};
+
+#if defined WIN32 && defined WINCE && !defined TLS_OUT_OF_INDEXES
+#	define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
+#endif
+
+struct PoolAllocatorImpl
+{
+    PoolAllocatorImpl(size_t _maxThreadBytes, size_t _maxSharedBytes)
+        : maxThreadBytes(_maxThreadBytes), maxSharedBytes(_maxSharedBytes)
+    {
+#ifdef WIN32
+        tlsKey = TlsAlloc();
+        CV_Assert( tlsKey != TLS_OUT_OF_INDEXES );
+#else
+        int errcode = pthread_key_create(&tlsKey, deleteThreadCache);
+        CV_Assert( errcode == 0 );
+#endif
+    }
+
+    ~PoolAllocatorImpl()
+    {
+#ifdef WIN32
+        TlsFree(tlsKey);
+#else
+        pthread_key_delete(tlsKey);
+#endif
+        for( size_t i = 0; i < caches.size(); i++ )
+        {
+            caches[i]->release();
+            delete caches[i];
+        }
+        shared.release();
+    }
+
+    PoolCache* getThreadCache()
+    {
+#ifdef WIN32
+        PoolCache* cache = (PoolCache*)TlsGetValue(tlsKey);
+#else
+        PoolCache* cache = (PoolCache*)pthread_getspecific(tlsKey);
+#endif
+        if( !cache )
+        {
+            cache = new PoolCache(this);
+            {
+            AutoLock lock(registryMutex);
+            caches.push_back(cache);
+            }
+#ifdef WIN32
+            TlsSetValue(tlsKey, cache);
+#else
+            pthread_setspecific(tlsKey, cache);
+#endif
+        }
+        return cache;
+    }
+
+#ifndef WIN32
+    // hands the buffers of the terminated thread over to the shared pool
+    static void deleteThreadCache(void* data)
+    {
+        PoolCache* cache = (PoolCache*)data;
+        PoolAllocatorImpl* pool = cache->pool;
+
+        {
+        AutoLock lock(pool->registryMutex);
+        pool->caches.erase(std::find(pool->caches.begin(), pool->caches.end(), cache));
+        }
+
+        AutoLock lock(pool->shared.mutex);
+        pool->shared.hits += cache->hits;
+        pool->shared.misses += cache->misses;
+        for( int i = 0; i < POOL_NCLASSES; i++ )
+        {
+            while( PoolBlock* block = cache->pop(i) )
+                if( !pool->shared.push(block, pool->maxSharedBytes) )
+                    fastFree(block);
+        }
+        delete cache;
+    }
+#endif
+
+    size_t maxThreadBytes, maxSharedBytes;
+#ifdef WIN32
+    DWORD tlsKey;
+#else
+    pthread_key_t tlsKey;
+#endif
+    Mutex registryMutex;
+    std::vector<PoolCache*> caches;
+    PoolCache shared;
+};
+
+PoolMatAllocator::Stats::Stats() : hits(0), misses(0), bytesHeld(0), blocksHeld(0) {}
+
+PoolMatAllocator::PoolMatAllocator(size_t maxThreadBytes, size_t maxSharedBytes)
+{
+    impl = new PoolAllocatorImpl(maxThreadBytes, maxSharedBytes);
+}
+
+PoolMatAllocator::~PoolMatAllocator()
+{
+    delete (PoolAllocatorImpl*)impl;
+}
+
+void PoolMatAllocator::allocate(int dims, const int* sizes, int type, int*& refcount,
+                                uchar*& datastart, uchar*& data, size_t* step)
+{
+    PoolAllocatorImpl* pool = (PoolAllocatorImpl*)impl;
+    size_t total = CV_ELEM_SIZE(type);
+    for( int i = dims-1; i >= 0; i-- )
+    {
+        step[i] = total;
+        total *= sizes[i];
+    }
+    total = alignSize(total, (int)sizeof(*refcount));
+
+    size_t capacity = 0;
+    int idx = poolSizeClass(total + sizeof(*refcount), capacity);
+    PoolBlock* block = 0;
+    PoolCache* cache = pool->getThreadCache();
+
+    {
+    AutoLock lock(cache->mutex);
+    if( idx >= 0 && (block = cache->pop(idx)) != 0 )
+        cache->hits++;
+    }
+
+    if( !block )
+    {
+        AutoLock lock(pool->shared.mutex);
+        if( idx >= 0 && (block = pool->shared.pop(idx)) != 0 )
+            pool->shared.hits++;
+        else
+            pool->shared.misses++;
+    }
+
+    if( !block )
+    {
+        block = (PoolBlock*)fastMalloc(POOL_HDR_SIZE + capacity);
+        block->capacity = capacity;
+        block->sizeClass = idx;
+    }
+    block->next = 0;
+
+    data = datastart = (uchar*)block + POOL_HDR_SIZE;
+    refcount = (int*)(data + total);
+    *refcount = 1;
+}
+
+void PoolMatAllocator::deallocate(int*, uchar* datastart, uchar*)
+{
+    PoolAllocatorImpl* pool = (PoolAllocatorImpl*)impl;
+    PoolBlock* block = (PoolBlock*)(datastart - POOL_HDR_SIZE);
+    if( block->sizeClass >= 0 )
+    {
+        PoolCache* cache = pool->getThreadCache();
+        {
+        AutoLock lock(cache->mutex);
+        if( cache->push(block, pool->maxThreadBytes) )
+            return;
+        }
+        AutoLock lock(pool->shared.mutex);
+        if( pool->shared.push(block, pool->maxSharedBytes) )
+            return;
+    }
+    fastFree(block);
+}
+
+PoolMatAllocator::Stats PoolMatAllocator::getStats() const
+{
+    PoolAllocatorImpl* pool = (PoolAllocatorImpl*)impl;
+    Stats stats;
+    AutoLock lock(pool->registryMutex);
+    for( size_t i = 0; i <= pool->caches.size(); i++ )
+    {
+        PoolCache* cache = i < pool->caches.size() ? pool->caches[i] : &pool->shared;
+        AutoLock cacheLock(cache->mutex);
+        stats.hits += cache->hits;
+        stats.misses += cache->misses;
+        stats.bytesHeld += cache->bytesHeld;
+        stats.blocksHeld += cache->blocksHeld;
+    }
+    return stats;
+}
+
+size_t PoolMatAllocator::trim()
+{
+    PoolAllocatorImpl* pool = (PoolAllocatorImpl*)impl;
+    size_t released = 0;
+    AutoLock lock(pool->registryMutex);
+    for( size_t i = 0; i <= pool->caches.size(); i++ )
+    {
+        PoolCache* cache = i < pool->caches.size() ? pool->caches[i] : &pool->shared;
+        AutoLock cacheLock(cache->mutex);
+        released += cache->release();
+    }
+    return released;
+}
+
 }
 
 CV_IMPL void cvSetMemoryManager( CvAllocFunc, CvFreeFunc, void * )
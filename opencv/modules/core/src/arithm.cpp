@@ -65,6 +65,26 @@ IPPArithmInitializer ippArithmInitializer;
 
 struct NOP {};
 
+/*
+   Chooses between the baseline kernels (SSE2 or plain C++) and the AVX2 kernels
+   from arithm_avx2.cpp at runtime, depending on checkHardwareSupport(CV_CPU_AVX2).
+   The depths that have no AVX2 kernel keep using the baseline ones.
+*/
+struct ArithmDispatchTab
+{
+    ArithmDispatchTab(BinaryFunc* _tab, int op, int n=8) : tab(_tab)
+    {
+        const BinaryFunc* tabAVX2 = getArithmTabAVX2(op);
+        for( int i = 0; i < 8; i++ )
+            avx2[i] = i >= n ? 0 : tabAVX2 && tabAVX2[i] ? tabAVX2[i] : tab[i];
+    }
+
+    BinaryFunc* get() { return checkHardwareSupport(CV_CPU_AVX2) ? avx2 : tab; }
+
+    BinaryFunc* tab;
+    BinaryFunc avx2[8];
+};
+
 template<typename T, class Op, class Op8>
 void vBinOp8(const T* src1, size_t step1, const T* src2, size_t step2, T* dst, size_t step, Size sz)
 {
@@ -140,7 +160,7 @@ void vBinOp16(const T* src1, size_t step1, const T* src2, size_t step2,
                 r0 = op16(r0,_mm_loadu_si128((const __m128i*)(src2 + x)));
                 r1 = op16(r1,_mm_loadu_si128((const __m128i*)(src2 + x + 8)));
                 _mm_storeu_si128((__m128i*)(dst + x), r0);
-                _mm_storeu_si128((__m128i*)(dst + x + 16), r1);
+                _mm_storeu_si128((__m128i*)(dst + x + 8), r1);
             }
             for( ; x <= sz.width - 4; x += 4 )
             {
@@ -194,7 +214,7 @@ void vBinOp32s(const int* src1, size_t step1, const int* src2, size_t step2,
                     r0 = op32(r0,_mm_load_si128((const __m128i*)(src2 + x)));
                     r1 = op32(r1,_mm_load_si128((const __m128i*)(src2 + x + 4)));
                     _mm_store_si128((__m128i*)(dst + x), r0);
-                    _mm_store_si128((__m128i*)(dst + x + 16), r1);
+                    _mm_store_si128((__m128i*)(dst + x + 4), r1);
                 }
             else
                 for( ; x <= sz.width - 8; x += 8 )
@@ -204,7 +224,7 @@ void vBinOp32s(const int* src1, size_t step1, const int* src2, size_t step2,
                     r0 = op32(r0,_mm_loadu_si128((const __m128i*)(src2 + x)));
                     r1 = op32(r1,_mm_loadu_si128((const __m128i*)(src2 + x + 4)));
                     _mm_storeu_si128((__m128i*)(dst + x), r0);
-                    _mm_storeu_si128((__m128i*)(dst + x + 16), r1);
+                    _mm_storeu_si128((__m128i*)(dst + x + 4), r1);
                 }
         }
 #endif
@@ -452,7 +472,7 @@ struct _VAbsDiff64f
 struct _VAnd8u { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_and_si128(a,b); }};
 struct _VOr8u  { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_or_si128(a,b); }};
 struct _VXor8u { __m128i operator()(const __m128i& a, const __m128i& b) const { return _mm_xor_si128(a,b); }};
-struct _VNot8u { __m128i operator()(const __m128i& a, const __m128i&) const { return _mm_andnot_si128(_mm_setzero_si128(),a); }};
+struct _VNot8u { __m128i operator()(const __m128i& a, const __m128i&) const { return _mm_xor_si128(_mm_set1_epi32(-1),a); }};
 
 #endif
 
@@ -1140,64 +1160,69 @@ static BinaryFunc minTab[] =
     0
 };
 
+static BinaryFunc andTab[] = { (BinaryFunc)GET_OPTIMIZED(and8u) };
+static BinaryFunc orTab[] = { (BinaryFunc)GET_OPTIMIZED(or8u) };
+static BinaryFunc xorTab[] = { (BinaryFunc)GET_OPTIMIZED(xor8u) };
+static BinaryFunc notTab[] = { (BinaryFunc)GET_OPTIMIZED(not8u) };
+
+static ArithmDispatchTab maxTabs(maxTab, ARITHM_MAX), minTabs(minTab, ARITHM_MIN);
+static ArithmDispatchTab andTabs(andTab, ARITHM_AND, 1), orTabs(orTab, ARITHM_OR, 1),
+    xorTabs(xorTab, ARITHM_XOR, 1), notTabs(notTab, ARITHM_NOT, 1);
+
 }
 
 void cv::bitwise_and(InputArray a, InputArray b, OutputArray c, InputArray mask)
 {
-    BinaryFunc f = (BinaryFunc)GET_OPTIMIZED(and8u);
-    binary_op(a, b, c, mask, &f, true);
+    binary_op(a, b, c, mask, andTabs.get(), true);
 }
 
 void cv::bitwise_or(InputArray a, InputArray b, OutputArray c, InputArray mask)
 {
-    BinaryFunc f = (BinaryFunc)GET_OPTIMIZED(or8u);
-    binary_op(a, b, c, mask, &f, true);
+    binary_op(a, b, c, mask, orTabs.get(), true);
 }
 
 void cv::bitwise_xor(InputArray a, InputArray b, OutputArray c, InputArray mask)
 {
-    BinaryFunc f = (BinaryFunc)GET_OPTIMIZED(xor8u);
-    binary_op(a, b, c, mask, &f, true);
+    binary_op(a, b, c, mask, xorTabs.get(), true);
 }
 
 void cv::bitwise_not(InputArray a, OutputArray c, InputArray mask)
 {
-    BinaryFunc f = (BinaryFunc)GET_OPTIMIZED(not8u);
-    binary_op(a, a, c, mask, &f, true);
+    binary_op(a, a, c, mask, notTabs.get(), true);
 }
 
 void cv::max( InputArray src1, InputArray src2, OutputArray dst )
 {
-    binary_op(src1, src2, dst, noArray(), maxTab, false );
+    binary_op(src1, src2, dst, noArray(), maxTabs.get(), false );
 }
 
 void cv::min( InputArray src1, InputArray src2, OutputArray dst )
 {
-    binary_op(src1, src2, dst, noArray(), minTab, false );
+    binary_op(src1, src2, dst, noArray(), minTabs.get(), false );
 }
 
 void cv::max(const Mat& src1, const Mat& src2, Mat& dst)
 {
     OutputArray _dst(dst);
-    binary_op(src1, src2, _dst, noArray(), maxTab, false );
+    binary_op(src1, src2, _dst, noArray(), maxTabs.get(), false );
 }
 
 void cv::min(const Mat& src1, const Mat& src2, Mat& dst)
 {
     OutputArray _dst(dst);
-    binary_op(src1, src2, _dst, noArray(), minTab, false );
+    binary_op(src1, src2, _dst, noArray(), minTabs.get(), false );
 }
 
 void cv::max(const Mat& src1, double src2, Mat& dst)
 {
     OutputArray _dst(dst);
-    binary_op(src1, src2, _dst, noArray(), maxTab, false );
+    binary_op(src1, src2, _dst, noArray(), maxTabs.get(), false );
 }
 
 void cv::min(const Mat& src1, double src2, Mat& dst)
 {
     OutputArray _dst(dst);
-    binary_op(src1, src2, _dst, noArray(), minTab, false );
+    binary_op(src1, src2, _dst, noArray(), minTabs.get(), false );
 }
 
 /****************************************************************************************\
@@ -1470,23 +1495,26 @@ static BinaryFunc absdiffTab[] =
     0
 };
 
+static ArithmDispatchTab addTabs(addTab, ARITHM_ADD), subTabs(subTab, ARITHM_SUB),
+    absdiffTabs(absdiffTab, ARITHM_ABSDIFF);
+
 }
 
 void cv::add( InputArray src1, InputArray src2, OutputArray dst,
           InputArray mask, int dtype )
 {
-    arithm_op(src1, src2, dst, mask, dtype, addTab );
+    arithm_op(src1, src2, dst, mask, dtype, addTabs.get() );
 }
 
 void cv::subtract( InputArray src1, InputArray src2, OutputArray dst,
                InputArray mask, int dtype )
 {
-    arithm_op(src1, src2, dst, mask, dtype, subTab );
+    arithm_op(src1, src2, dst, mask, dtype, subTabs.get() );
 }
 
 void cv::absdiff( InputArray src1, InputArray src2, OutputArray dst )
 {
-    arithm_op(src1, src2, dst, noArray(), -1, absdiffTab);
+    arithm_op(src1, src2, dst, noArray(), -1, absdiffTabs.get());
 }
 
 /****************************************************************************************\
@@ -1958,13 +1986,15 @@ static BinaryFunc addWeightedTab[] =
     (BinaryFunc)addWeighted64f, 0
 };
 
+static ArithmDispatchTab addWeightedTabs(addWeightedTab, ARITHM_ADD_WEIGHTED);
+
 }
 
 void cv::addWeighted( InputArray src1, double alpha, InputArray src2,
                       double beta, double gamma, OutputArray dst, int dtype )
 {
     double scalars[] = {alpha, beta, gamma};
-    arithm_op(src1, src2, dst, noArray(), dtype, addWeightedTab, true, scalars);
+    arithm_op(src1, src2, dst, noArray(), dtype, addWeightedTabs.get(), true, scalars);
 }
 
 
@@ -2084,6 +2114,8 @@ static BinaryFunc cmpTab[] =
     0
 };
 
+static ArithmDispatchTab cmpTabs(cmpTab, ARITHM_CMP);
+
 
 static double getMinVal(int depth)
 {
@@ -2113,7 +2145,7 @@ void cv::compare(InputArray _src1, InputArray _src2, OutputArray _dst, int op)
         _dst.create(src1.size(), CV_8UC(cn));
         Mat dst = _dst.getMat();
         Size sz = getContinuousSize(src1, src2, dst, src1.channels());
-        cmpTab[src1.depth()](src1.data, src1.step, src2.data, src2.step, dst.data, dst.step, sz, &op);
+        cmpTabs.get()[src1.depth()](src1.data, src1.step, src2.data, src2.step, dst.data, dst.step, sz, &op);
         return;
     }
 
@@ -2145,7 +2177,7 @@ void cv::compare(InputArray _src1, InputArray _src2, OutputArray _dst, int op)
     
     size_t esz = src1.elemSize();
     size_t blocksize0 = (size_t)(BLOCK_SIZE + esz-1)/esz;
-    BinaryFunc func = cmpTab[depth1];
+    BinaryFunc func = cmpTabs.get()[depth1];
 
     if( !haveScalar )
     {
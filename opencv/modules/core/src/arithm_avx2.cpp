@@ -0,0 +1,723 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+/* ////////////////////////////////////////////////////////////////////
+//
+//  AVX2 versions of the per-element arithmetic, bitwise and comparison
+//  kernels. The file is compiled with AVX2 code generation enabled, and
+//  the kernels are only called after checkHardwareSupport(CV_CPU_AVX2),
+//  see the dispatch tables in arithm.cpp.
+//
+//  Since the whole file may contain AVX2 instructions, it should not
+//  instantiate any inline functions or templates from the public headers
+//  (the linker may pick such an instance for the rest of the library).
+//  That is why the scalar tails here use their own small helpers.
+//
+// */
+
+#include "precomp.hpp"
+
+#if defined __AVX2__
+#include <immintrin.h>
+#endif
+
+namespace cv
+{
+
+#if defined __AVX2__
+
+namespace
+{
+
+inline uchar sat8u(int v) { return (uchar)((unsigned)v <= UCHAR_MAX ? v : v > 0 ? UCHAR_MAX : 0); }
+inline schar sat8s(int v) { return (schar)((unsigned)(v - SCHAR_MIN) <= (unsigned)UCHAR_MAX ? v : v > 0 ? SCHAR_MAX : SCHAR_MIN); }
+inline ushort sat16u(int v) { return (ushort)((unsigned)v <= (unsigned)USHRT_MAX ? v : v > 0 ? USHRT_MAX : 0); }
+inline short sat16s(int v) { return (short)((unsigned)(v - SHRT_MIN) <= (unsigned)USHRT_MAX ? v : v > 0 ? SHRT_MAX : SHRT_MIN); }
+inline int iabs(int v) { return v >= 0 ? v : -v; }
+// rounds like cvRound(), which must not be instantiated here
+inline int iround(double v) { return _mm_cvtsd_si32(_mm_set_sd(v)); }
+
+inline __m256i vx_load(const uchar* p) { return _mm256_loadu_si256((const __m256i*)p); }
+inline __m256i vx_load(const schar* p) { return _mm256_loadu_si256((const __m256i*)p); }
+inline __m256i vx_load(const ushort* p) { return _mm256_loadu_si256((const __m256i*)p); }
+inline __m256i vx_load(const short* p) { return _mm256_loadu_si256((const __m256i*)p); }
+inline __m256i vx_load(const int* p) { return _mm256_loadu_si256((const __m256i*)p); }
+inline __m256 vx_load(const float* p) { return _mm256_loadu_ps(p); }
+inline __m256d vx_load(const double* p) { return _mm256_loadu_pd(p); }
+
+inline void vx_store(uchar* p, const __m256i& v) { _mm256_storeu_si256((__m256i*)p, v); }
+inline void vx_store(schar* p, const __m256i& v) { _mm256_storeu_si256((__m256i*)p, v); }
+inline void vx_store(ushort* p, const __m256i& v) { _mm256_storeu_si256((__m256i*)p, v); }
+inline void vx_store(short* p, const __m256i& v) { _mm256_storeu_si256((__m256i*)p, v); }
+inline void vx_store(int* p, const __m256i& v) { _mm256_storeu_si256((__m256i*)p, v); }
+inline void vx_store(float* p, const __m256& v) { _mm256_storeu_ps(p, v); }
+inline void vx_store(double* p, const __m256d& v) { _mm256_storeu_pd(p, v); }
+
+/****************************************************************************************\
+*                            add, subtract, absdiff, min, max                            *
+\****************************************************************************************/
+
+template<typename T, typename VT> struct VOpBase
+{
+    typedef T type;
+    typedef VT vtype;
+};
+
+struct VAdd8u : VOpBase<uchar, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_adds_epu8(a, b); }
+    uchar operator()(uchar a, uchar b) const { return sat8u(a + b); }
+};
+
+struct VAdd8s : VOpBase<schar, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_adds_epi8(a, b); }
+    schar operator()(schar a, schar b) const { return sat8s(a + b); }
+};
+
+struct VAdd16u : VOpBase<ushort, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_adds_epu16(a, b); }
+    ushort operator()(ushort a, ushort b) const { return sat16u(a + b); }
+};
+
+struct VAdd16s : VOpBase<short, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_adds_epi16(a, b); }
+    short operator()(short a, short b) const { return sat16s(a + b); }
+};
+
+struct VAdd32s : VOpBase<int, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_add_epi32(a, b); }
+    int operator()(int a, int b) const { return (int)((unsigned)a + (unsigned)b); }
+};
+
+struct VAdd32f : VOpBase<float, __m256>
+{
+    __m256 operator()(const __m256& a, const __m256& b) const { return _mm256_add_ps(a, b); }
+    float operator()(float a, float b) const { return a + b; }
+};
+
+struct VAdd64f : VOpBase<double, __m256d>
+{
+    __m256d operator()(const __m256d& a, const __m256d& b) const { return _mm256_add_pd(a, b); }
+    double operator()(double a, double b) const { return a + b; }
+};
+
+struct VSub8u : VOpBase<uchar, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_subs_epu8(a, b); }
+    uchar operator()(uchar a, uchar b) const { return sat8u(a - b); }
+};
+
+struct VSub8s : VOpBase<schar, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_subs_epi8(a, b); }
+    schar operator()(schar a, schar b) const { return sat8s(a - b); }
+};
+
+struct VSub16u : VOpBase<ushort, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_subs_epu16(a, b); }
+    ushort operator()(ushort a, ushort b) const { return sat16u(a - b); }
+};
+
+struct VSub16s : VOpBase<short, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_subs_epi16(a, b); }
+    short operator()(short a, short b) const { return sat16s(a - b); }
+};
+
+struct VSub32s : VOpBase<int, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_sub_epi32(a, b); }
+    int operator()(int a, int b) const { return (int)((unsigned)a - (unsigned)b); }
+};
+
+struct VSub32f : VOpBase<float, __m256>
+{
+    __m256 operator()(const __m256& a, const __m256& b) const { return _mm256_sub_ps(a, b); }
+    float operator()(float a, float b) const { return a - b; }
+};
+
+struct VSub64f : VOpBase<double, __m256d>
+{
+    __m256d operator()(const __m256d& a, const __m256d& b) const { return _mm256_sub_pd(a, b); }
+    double operator()(double a, double b) const { return a - b; }
+};
+
+struct VAbsDiff8u : VOpBase<uchar, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    { return _mm256_or_si256(_mm256_subs_epu8(a, b), _mm256_subs_epu8(b, a)); }
+    uchar operator()(uchar a, uchar b) const { return (uchar)iabs(a - b); }
+};
+
+struct VAbsDiff8s : VOpBase<schar, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    {
+        __m256i d = _mm256_subs_epi8(a, b);
+        __m256i m = _mm256_cmpgt_epi8(b, a);
+        return _mm256_subs_epi8(_mm256_xor_si256(d, m), m);
+    }
+    schar operator()(schar a, schar b) const { return sat8s(iabs(a - b)); }
+};
+
+struct VAbsDiff16u : VOpBase<ushort, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    { return _mm256_or_si256(_mm256_subs_epu16(a, b), _mm256_subs_epu16(b, a)); }
+    ushort operator()(ushort a, ushort b) const { return (ushort)iabs(a - b); }
+};
+
+struct VAbsDiff16s : VOpBase<short, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    { return _mm256_subs_epi16(_mm256_max_epi16(a, b), _mm256_min_epi16(a, b)); }
+    short operator()(short a, short b) const { return sat16s(iabs(a - b)); }
+};
+
+struct VAbsDiff32s : VOpBase<int, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const
+    { return _mm256_abs_epi32(_mm256_sub_epi32(a, b)); }
+    int operator()(int a, int b) const
+    {
+        int d = (int)((unsigned)a - (unsigned)b);
+        return d >= 0 ? d : (int)(0u - (unsigned)d);
+    }
+};
+
+struct VAbsDiff32f : VOpBase<float, __m256>
+{
+    __m256 operator()(const __m256& a, const __m256& b) const
+    { return _mm256_andnot_ps(_mm256_set1_ps(-0.f), _mm256_sub_ps(a, b)); }
+    float operator()(float a, float b) const { float d = a - b; return d >= 0 ? d : -d; }
+};
+
+struct VAbsDiff64f : VOpBase<double, __m256d>
+{
+    __m256d operator()(const __m256d& a, const __m256d& b) const
+    { return _mm256_andnot_pd(_mm256_set1_pd(-0.), _mm256_sub_pd(a, b)); }
+    double operator()(double a, double b) const { double d = a - b; return d >= 0 ? d : -d; }
+};
+
+#define CV_AVX2_MINMAX_OP(name, T, VT, vop, cmp) \
+struct name : VOpBase<T, VT> \
+{ \
+    VT operator()(const VT& a, const VT& b) const { return vop(a, b); } \
+    T operator()(T a, T b) const { return b cmp a ? b : a; } \
+}
+
+CV_AVX2_MINMAX_OP(VMin8u, uchar, __m256i, _mm256_min_epu8, <);
+CV_AVX2_MINMAX_OP(VMin8s, schar, __m256i, _mm256_min_epi8, <);
+CV_AVX2_MINMAX_OP(VMin16u, ushort, __m256i, _mm256_min_epu16, <);
+CV_AVX2_MINMAX_OP(VMin16s, short, __m256i, _mm256_min_epi16, <);
+CV_AVX2_MINMAX_OP(VMin32s, int, __m256i, _mm256_min_epi32, <);
+CV_AVX2_MINMAX_OP(VMin32f, float, __m256, _mm256_min_ps, <);
+CV_AVX2_MINMAX_OP(VMin64f, double, __m256d, _mm256_min_pd, <);
+
+CV_AVX2_MINMAX_OP(VMax8u, uchar, __m256i, _mm256_max_epu8, >);
+CV_AVX2_MINMAX_OP(VMax8s, schar, __m256i, _mm256_max_epi8, >);
+CV_AVX2_MINMAX_OP(VMax16u, ushort, __m256i, _mm256_max_epu16, >);
+CV_AVX2_MINMAX_OP(VMax16s, short, __m256i, _mm256_max_epi16, >);
+CV_AVX2_MINMAX_OP(VMax32s, int, __m256i, _mm256_max_epi32, >);
+CV_AVX2_MINMAX_OP(VMax32f, float, __m256, _mm256_max_ps, >);
+CV_AVX2_MINMAX_OP(VMax64f, double, __m256d, _mm256_max_pd, >);
+
+#undef CV_AVX2_MINMAX_OP
+
+struct VAnd8u : VOpBase<uchar, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_and_si256(a, b); }
+    uchar operator()(uchar a, uchar b) const { return (uchar)(a & b); }
+};
+
+struct VOr8u : VOpBase<uchar, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_or_si256(a, b); }
+    uchar operator()(uchar a, uchar b) const { return (uchar)(a | b); }
+};
+
+struct VXor8u : VOpBase<uchar, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i& b) const { return _mm256_xor_si256(a, b); }
+    uchar operator()(uchar a, uchar b) const { return (uchar)(a ^ b); }
+};
+
+struct VNot8u : VOpBase<uchar, __m256i>
+{
+    __m256i operator()(const __m256i& a, const __m256i&) const { return _mm256_xor_si256(a, _mm256_set1_epi32(-1)); }
+    uchar operator()(uchar a, uchar) const { return (uchar)~a; }
+};
+
+template<class Op> void
+vBinOpAVX2( const uchar* _src1, size_t step1, const uchar* _src2, size_t step2,
+            uchar* _dst, size_t step, int width, int height )
+{
+    typedef typename Op::type T;
+    typedef typename Op::vtype VT;
+    enum { VSIZE = 32/sizeof(T) };
+    Op op;
+
+    for( ; height--; _src1 += step1, _src2 += step2, _dst += step )
+    {
+        const T* src1 = (const T*)_src1;
+        const T* src2 = (const T*)_src2;
+        T* dst = (T*)_dst;
+        int x = 0;
+
+        for( ; x <= width - VSIZE*2; x += VSIZE*2 )
+        {
+            VT r0 = vx_load(src1 + x), r1 = vx_load(src1 + x + VSIZE);
+            r0 = op(r0, vx_load(src2 + x));
+            r1 = op(r1, vx_load(src2 + x + VSIZE));
+            vx_store(dst + x, r0);
+            vx_store(dst + x + VSIZE, r1);
+        }
+        for( ; x <= width - VSIZE; x += VSIZE )
+            vx_store(dst + x, op(vx_load(src1 + x), vx_load(src2 + x)));
+
+        for( ; x < width; x++ )
+            dst[x] = op(src1[x], src2[x]);
+    }
+}
+
+#define CV_AVX2_BINARY_FUNC(name, Op) \
+void name( const uchar* src1, size_t step1, const uchar* src2, size_t step2, \
+           uchar* dst, size_t step, Size sz, void* ) \
+{ \
+    vBinOpAVX2<Op>(src1, step1, src2, step2, dst, step, sz.width, sz.height); \
+}
+
+CV_AVX2_BINARY_FUNC(add8u, VAdd8u)
+CV_AVX2_BINARY_FUNC(add8s, VAdd8s)
+CV_AVX2_BINARY_FUNC(add16u, VAdd16u)
+CV_AVX2_BINARY_FUNC(add16s, VAdd16s)
+CV_AVX2_BINARY_FUNC(add32s, VAdd32s)
+CV_AVX2_BINARY_FUNC(add32f, VAdd32f)
+CV_AVX2_BINARY_FUNC(add64f, VAdd64f)
+
+CV_AVX2_BINARY_FUNC(sub8u, VSub8u)
+CV_AVX2_BINARY_FUNC(sub8s, VSub8s)
+CV_AVX2_BINARY_FUNC(sub16u, VSub16u)
+CV_AVX2_BINARY_FUNC(sub16s, VSub16s)
+CV_AVX2_BINARY_FUNC(sub32s, VSub32s)
+CV_AVX2_BINARY_FUNC(sub32f, VSub32f)
+CV_AVX2_BINARY_FUNC(sub64f, VSub64f)
+
+CV_AVX2_BINARY_FUNC(absdiff8u, VAbsDiff8u)
+CV_AVX2_BINARY_FUNC(absdiff8s, VAbsDiff8s)
+CV_AVX2_BINARY_FUNC(absdiff16u, VAbsDiff16u)
+CV_AVX2_BINARY_FUNC(absdiff16s, VAbsDiff16s)
+CV_AVX2_BINARY_FUNC(absdiff32s, VAbsDiff32s)
+CV_AVX2_BINARY_FUNC(absdiff32f, VAbsDiff32f)
+CV_AVX2_BINARY_FUNC(absdiff64f, VAbsDiff64f)
+
+CV_AVX2_BINARY_FUNC(min8u, VMin8u)
+CV_AVX2_BINARY_FUNC(min8s, VMin8s)
+CV_AVX2_BINARY_FUNC(min16u, VMin16u)
+CV_AVX2_BINARY_FUNC(min16s, VMin16s)
+CV_AVX2_BINARY_FUNC(min32s, VMin32s)
+CV_AVX2_BINARY_FUNC(min32f, VMin32f)
+CV_AVX2_BINARY_FUNC(min64f, VMin64f)
+
+CV_AVX2_BINARY_FUNC(max8u, VMax8u)
+CV_AVX2_BINARY_FUNC(max8s, VMax8s)
+CV_AVX2_BINARY_FUNC(max16u, VMax16u)
+CV_AVX2_BINARY_FUNC(max16s, VMax16s)
+CV_AVX2_BINARY_FUNC(max32s, VMax32s)
+CV_AVX2_BINARY_FUNC(max32f, VMax32f)
+CV_AVX2_BINARY_FUNC(max64f, VMax64f)
+
+CV_AVX2_BINARY_FUNC(and8u, VAnd8u)
+CV_AVX2_BINARY_FUNC(or8u, VOr8u)
+CV_AVX2_BINARY_FUNC(xor8u, VXor8u)
+CV_AVX2_BINARY_FUNC(not8u, VNot8u)
+
+#undef CV_AVX2_BINARY_FUNC
+
+/****************************************************************************************\
+*                                        compare                                         *
+\****************************************************************************************/
+
+// each function compares 32 elements and packs the result into 32 bytes of 0/255
+inline __m256i packMask16(const __m256i& m0, const __m256i& m1)
+{
+    return _mm256_permute4x64_epi64(_mm256_packs_epi16(m0, m1), 0xD8);
+}
+
+inline __m256i packMask32(const __m256i& m0, const __m256i& m1, const __m256i& m2, const __m256i& m3)
+{
+    __m256i m = _mm256_packs_epi16(_mm256_packs_epi32(m0, m1), _mm256_packs_epi32(m2, m3));
+    return _mm256_permutevar8x32_epi32(m, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+}
+
+inline __m256i vx_cmpgt(const uchar* a, const uchar* b)
+{
+    __m256i delta = _mm256_set1_epi8((char)-128);
+    return _mm256_cmpgt_epi8(_mm256_xor_si256(vx_load(a), delta), _mm256_xor_si256(vx_load(b), delta));
+}
+
+inline __m256i vx_cmpeq(const uchar* a, const uchar* b)
+{ return _mm256_cmpeq_epi8(vx_load(a), vx_load(b)); }
+
+inline __m256i vx_cmpgt(const schar* a, const schar* b)
+{ return _mm256_cmpgt_epi8(vx_load(a), vx_load(b)); }
+
+inline __m256i vx_cmpeq(const schar* a, const schar* b)
+{ return _mm256_cmpeq_epi8(vx_load(a), vx_load(b)); }
+
+inline __m256i vx_cmpgt(const ushort* a, const ushort* b)
+{
+    __m256i delta = _mm256_set1_epi16((short)-32768);
+    return packMask16(
+        _mm256_cmpgt_epi16(_mm256_xor_si256(vx_load(a), delta), _mm256_xor_si256(vx_load(b), delta)),
+        _mm256_cmpgt_epi16(_mm256_xor_si256(vx_load(a + 16), delta), _mm256_xor_si256(vx_load(b + 16), delta)));
+}
+
+inline __m256i vx_cmpeq(const ushort* a, const ushort* b)
+{
+    return packMask16(_mm256_cmpeq_epi16(vx_load(a), vx_load(b)),
+                      _mm256_cmpeq_epi16(vx_load(a + 16), vx_load(b + 16)));
+}
+
+inline __m256i vx_cmpgt(const short* a, const short* b)
+{
+    return packMask16(_mm256_cmpgt_epi16(vx_load(a), vx_load(b)),
+                      _mm256_cmpgt_epi16(vx_load(a + 16), vx_load(b + 16)));
+}
+
+inline __m256i vx_cmpeq(const short* a, const short* b)
+{
+    return packMask16(_mm256_cmpeq_epi16(vx_load(a), vx_load(b)),
+                      _mm256_cmpeq_epi16(vx_load(a + 16), vx_load(b + 16)));
+}
+
+inline __m256i vx_cmpgt(const int* a, const int* b)
+{
+    return packMask32(_mm256_cmpgt_epi32(vx_load(a), vx_load(b)),
+                      _mm256_cmpgt_epi32(vx_load(a + 8), vx_load(b + 8)),
+                      _mm256_cmpgt_epi32(vx_load(a + 16), vx_load(b + 16)),
+                      _mm256_cmpgt_epi32(vx_load(a + 24), vx_load(b + 24)));
+}
+
+inline __m256i vx_cmpeq(const int* a, const int* b)
+{
+    return packMask32(_mm256_cmpeq_epi32(vx_load(a), vx_load(b)),
+                      _mm256_cmpeq_epi32(vx_load(a + 8), vx_load(b + 8)),
+                      _mm256_cmpeq_epi32(vx_load(a + 16), vx_load(b + 16)),
+                      _mm256_cmpeq_epi32(vx_load(a + 24), vx_load(b + 24)));
+}
+
+inline __m256i vx_cmpgt(const float* a, const float* b)
+{
+    return packMask32(_mm256_castps_si256(_mm256_cmp_ps(vx_load(a), vx_load(b), _CMP_GT_OQ)),
+                      _mm256_castps_si256(_mm256_cmp_ps(vx_load(a + 8), vx_load(b + 8), _CMP_GT_OQ)),
+                      _mm256_castps_si256(_mm256_cmp_ps(vx_load(a + 16), vx_load(b + 16), _CMP_GT_OQ)),
+                      _mm256_castps_si256(_mm256_cmp_ps(vx_load(a + 24), vx_load(b + 24), _CMP_GT_OQ)));
+}
+
+inline __m256i vx_cmpeq(const float* a, const float* b)
+{
+    return packMask32(_mm256_castps_si256(_mm256_cmp_ps(vx_load(a), vx_load(b), _CMP_EQ_OQ)),
+                      _mm256_castps_si256(_mm256_cmp_ps(vx_load(a + 8), vx_load(b + 8), _CMP_EQ_OQ)),
+                      _mm256_castps_si256(_mm256_cmp_ps(vx_load(a + 16), vx_load(b + 16), _CMP_EQ_OQ)),
+                      _mm256_castps_si256(_mm256_cmp_ps(vx_load(a + 24), vx_load(b + 24), _CMP_EQ_OQ)));
+}
+
+template<typename T> void
+cmpAVX2( const uchar* _src1, size_t step1, const uchar* _src2, size_t step2,
+         uchar* dst, size_t step, int width, int height, int code )
+{
+    if( code == CMP_GE || code == CMP_LT )
+    {
+        const uchar* t = _src1; _src1 = _src2; _src2 = t;
+        size_t tstep = step1; step1 = step2; step2 = tstep;
+        code = code == CMP_GE ? CMP_LE : CMP_GT;
+    }
+
+    bool gt = code == CMP_GT || code == CMP_LE;
+    int m = code == CMP_GT || code == CMP_EQ ? 0 : 255;
+    __m256i vm = _mm256_set1_epi8((char)m);
+
+    for( ; height--; _src1 += step1, _src2 += step2, dst += step )
+    {
+        const T* src1 = (const T*)_src1;
+        const T* src2 = (const T*)_src2;
+        int x = 0;
+
+        if( gt )
+        {
+            for( ; x <= width - 32; x += 32 )
+                _mm256_storeu_si256((__m256i*)(dst + x), _mm256_xor_si256(vx_cmpgt(src1 + x, src2 + x), vm));
+            for( ; x < width; x++ )
+                dst[x] = (uchar)(-(src1[x] > src2[x]) ^ m);
+        }
+        else
+        {
+            for( ; x <= width - 32; x += 32 )
+                _mm256_storeu_si256((__m256i*)(dst + x), _mm256_xor_si256(vx_cmpeq(src1 + x, src2 + x), vm));
+            for( ; x < width; x++ )
+                dst[x] = (uchar)(-(src1[x] == src2[x]) ^ m);
+        }
+    }
+}
+
+#define CV_AVX2_CMP_FUNC(name, T) \
+void name( const uchar* src1, size_t step1, const uchar* src2, size_t step2, \
+           uchar* dst, size_t step, Size sz, void* _cmpop ) \
+{ \
+    cmpAVX2<T>(src1, step1, src2, step2, dst, step, sz.width, sz.height, *(int*)_cmpop); \
+}
+
+CV_AVX2_CMP_FUNC(cmp8u, uchar)
+CV_AVX2_CMP_FUNC(cmp8s, schar)
+CV_AVX2_CMP_FUNC(cmp16u, ushort)
+CV_AVX2_CMP_FUNC(cmp16s, short)
+CV_AVX2_CMP_FUNC(cmp32s, int)
+CV_AVX2_CMP_FUNC(cmp32f, float)
+
+#undef CV_AVX2_CMP_FUNC
+
+/****************************************************************************************\
+*                                      addWeighted                                       *
+\****************************************************************************************/
+
+// the arithmetic follows addWeighted_ and addWeighted8u from arithm.cpp operation by operation,
+// so the results are bit-exact with the baseline kernels
+
+void addWeighted8u( const uchar* src1, size_t step1, const uchar* src2, size_t step2,
+                    uchar* dst, size_t step, Size sz, void* _scalars )
+{
+    const double* scalars = (const double*)_scalars;
+    float alpha = (float)scalars[0], beta = (float)scalars[1], gamma = (float)scalars[2];
+    __m256 a8 = _mm256_set1_ps(alpha), b8 = _mm256_set1_ps(beta), g8 = _mm256_set1_ps(gamma);
+    int width = sz.width, height = sz.height;
+
+    for( ; height--; src1 += step1, src2 += step2, dst += step )
+    {
+        int x = 0;
+        for( ; x <= width - 16; x += 16 )
+        {
+            __m128i u = _mm_loadu_si128((const __m128i*)(src1 + x));
+            __m128i v = _mm_loadu_si128((const __m128i*)(src2 + x));
+
+            __m256 u0 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(u));
+            __m256 u1 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(u, 8)));
+            __m256 v0 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(v));
+            __m256 v1 = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(v, 8)));
+
+            u0 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(u0, a8), _mm256_mul_ps(v0, b8)), g8);
+            u1 = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(u1, a8), _mm256_mul_ps(v1, b8)), g8);
+
+            __m256i w = _mm256_permute4x64_epi64(_mm256_packs_epi32(_mm256_cvtps_epi32(u0),
+                                                                    _mm256_cvtps_epi32(u1)), 0xD8);
+            _mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(_mm256_castsi256_si128(w),
+                                                                   _mm256_extracti128_si256(w, 1)));
+        }
+
+        for( ; x < width; x++ )
+        {
+            float t = (float)src1[x]*alpha + (float)src2[x]*beta + gamma;
+            dst[x] = sat8u(iround(t));
+        }
+    }
+}
+
+void addWeighted16u( const uchar* _src1, size_t step1, const uchar* _src2, size_t step2,
+                     uchar* _dst, size_t step, Size sz, void* _scalars )
+{
+    const double* scalars = (const double*)_scalars;
+    float alpha = (float)scalars[0], beta = (float)scalars[1], gamma = (float)scalars[2];
+    __m256 a8 = _mm256_set1_ps(alpha), b8 = _mm256_set1_ps(beta), g8 = _mm256_set1_ps(gamma);
+    int width = sz.width, height = sz.height;
+
+    for( ; height--; _src1 += step1, _src2 += step2, _dst += step )
+    {
+        const ushort* src1 = (const ushort*)_src1;
+        const ushort* src2 = (const ushort*)_src2;
+        ushort* dst = (ushort*)_dst;
+        int x = 0;
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m256 u = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src1 + x))));
+            __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(_mm_loadu_si128((const __m128i*)(src2 + x))));
+            __m256i w = _mm256_cvtps_epi32(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(u, a8), _mm256_mul_ps(v, b8)), g8));
+            _mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi32(_mm256_castsi256_si128(w),
+                                                                   _mm256_extracti128_si256(w, 1)));
+        }
+
+        for( ; x < width; x++ )
+            dst[x] = sat16u(iround(src1[x]*alpha + src2[x]*beta + gamma));
+    }
+}
+
+void addWeighted16s( const uchar* _src1, size_t step1, const uchar* _src2, size_t step2,
+                     uchar* _dst, size_t step, Size sz, void* _scalars )
+{
+    const double* scalars = (const double*)_scalars;
+    float alpha = (float)scalars[0], beta = (float)scalars[1], gamma = (float)scalars[2];
+    __m256 a8 = _mm256_set1_ps(alpha), b8 = _mm256_set1_ps(beta), g8 = _mm256_set1_ps(gamma);
+    int width = sz.width, height = sz.height;
+
+    for( ; height--; _src1 += step1, _src2 += step2, _dst += step )
+    {
+        const short* src1 = (const short*)_src1;
+        const short* src2 = (const short*)_src2;
+        short* dst = (short*)_dst;
+        int x = 0;
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m256 u = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src1 + x))));
+            __m256 v = _mm256_cvtepi32_ps(_mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src2 + x))));
+            __m256i w = _mm256_cvtps_epi32(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(u, a8), _mm256_mul_ps(v, b8)), g8));
+            _mm_storeu_si128((__m128i*)(dst + x), _mm_packs_epi32(_mm256_castsi256_si128(w),
+                                                                  _mm256_extracti128_si256(w, 1)));
+        }
+
+        for( ; x < width; x++ )
+            dst[x] = sat16s(iround(src1[x]*alpha + src2[x]*beta + gamma));
+    }
+}
+
+void addWeighted32f( const uchar* _src1, size_t step1, const uchar* _src2, size_t step2,
+                     uchar* _dst, size_t step, Size sz, void* _scalars )
+{
+    const double* scalars = (const double*)_scalars;
+    double alpha = scalars[0], beta = scalars[1], gamma = scalars[2];
+    __m256d a4 = _mm256_set1_pd(alpha), b4 = _mm256_set1_pd(beta), g4 = _mm256_set1_pd(gamma);
+    int width = sz.width, height = sz.height;
+
+    for( ; height--; _src1 += step1, _src2 += step2, _dst += step )
+    {
+        const float* src1 = (const float*)_src1;
+        const float* src2 = (const float*)_src2;
+        float* dst = (float*)_dst;
+        int x = 0;
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m256d u0 = _mm256_cvtps_pd(_mm_loadu_ps(src1 + x));
+            __m256d u1 = _mm256_cvtps_pd(_mm_loadu_ps(src1 + x + 4));
+            __m256d v0 = _mm256_cvtps_pd(_mm_loadu_ps(src2 + x));
+            __m256d v1 = _mm256_cvtps_pd(_mm_loadu_ps(src2 + x + 4));
+            u0 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(u0, a4), _mm256_mul_pd(v0, b4)), g4);
+            u1 = _mm256_add_pd(_mm256_add_pd(_mm256_mul_pd(u1, a4), _mm256_mul_pd(v1, b4)), g4);
+            _mm_storeu_ps(dst + x, _mm256_cvtpd_ps(u0));
+            _mm_storeu_ps(dst + x + 4, _mm256_cvtpd_ps(u1));
+        }
+
+        for( ; x < width; x++ )
+            dst[x] = (float)(src1[x]*alpha + src2[x]*beta + gamma);
+    }
+}
+
+BinaryFunc addTabAVX2[] =
+{
+    add8u, add8s, add16u, add16s, add32s, add32f, add64f, 0
+};
+
+BinaryFunc subTabAVX2[] =
+{
+    sub8u, sub8s, sub16u, sub16s, sub32s, sub32f, sub64f, 0
+};
+
+BinaryFunc absdiffTabAVX2[] =
+{
+    absdiff8u, absdiff8s, absdiff16u, absdiff16s, absdiff32s, absdiff32f, absdiff64f, 0
+};
+
+BinaryFunc minTabAVX2[] =
+{
+    min8u, min8s, min16u, min16s, min32s, min32f, min64f, 0
+};
+
+BinaryFunc maxTabAVX2[] =
+{
+    max8u, max8s, max16u, max16s, max32s, max32f, max64f, 0
+};
+
+BinaryFunc cmpTabAVX2[] =
+{
+    cmp8u, cmp8s, cmp16u, cmp16s, cmp32s, cmp32f, 0, 0
+};
+
+BinaryFunc addWeightedTabAVX2[] =
+{
+    addWeighted8u, 0, addWeighted16u, addWeighted16s, 0, addWeighted32f, 0, 0
+};
+
+BinaryFunc andTabAVX2[] = { and8u };
+BinaryFunc orTabAVX2[] = { or8u };
+BinaryFunc xorTabAVX2[] = { xor8u };
+BinaryFunc notTabAVX2[] = { not8u };
+
+}
+
+const BinaryFunc* getArithmTabAVX2(int op)
+{
+    static const BinaryFunc* tabs[] =
+    {
+        addTabAVX2, subTabAVX2, absdiffTabAVX2, minTabAVX2, maxTabAVX2, cmpTabAVX2,
+        addWeightedTabAVX2, andTabAVX2, orTabAVX2, xorTabAVX2, notTabAVX2
+    };
+    return 0 <= op && op < (int)(sizeof(tabs)/sizeof(tabs[0])) ? tabs[op] : 0;
+}
+
+#else
+
+const BinaryFunc* getArithmTabAVX2(int)
+{
+    return 0;
+}
+
+#endif
+
+}
+
+/* End of file. */
@@ -1449,6 +1449,187 @@ static void CCSIDFT_64f( const double* src, double* dst, int n, int nf, int* fac
     CCSIDFT( src, dst, n, nf, factors, itab, wave, tab_size, spec, buf, flags, scale);
 }
     
+
+/*
+   Factorization, permutation table and twiddle factors of a 1D DFT of the particular
+   length and precision. The plans are immutable once built, so they are shared by
+   the concurrent dft() calls and by the parallel row/column passes of a single call.
+*/
+struct DFTPlan
+{
+    DFTPlan( int _len, int _complex_elem_size, int _inv_itab )
+        : len(_len), complex_elem_size(_complex_elem_size), inv_itab(_inv_itab)
+    {
+        nf = DFTFactorize( len, factors );
+        inplace = factors[0] == factors[nf-1];
+
+        int i = nf > 1 && (factors[0] & 1) == 0;
+        work_size = (factors[i] & 1) != 0 && factors[i] > 5 ? (factors[i]+1)*complex_elem_size : 0;
+
+        wave.resize( len*2 );
+        itab.resize( len );
+        DFTInit( len, nf, factors, &itab[0], complex_elem_size, &wave[0], inv_itab );
+    }
+
+    int len, complex_elem_size, inv_itab;
+    int nf, factors[34];
+    bool inplace;
+    // the scratch space, needed by DFT() for the odd radices > 5
+    int work_size;
+    // twiddle factors; Complexf or Complexd, depending on complex_elem_size
+    std::vector<double> wave;
+    std::vector<int> itab;
+};
+
+enum { DFT_PLAN_CACHE_SIZE = 16 };
+
+static Mutex dftPlanCacheMutex;
+static Ptr<DFTPlan> dftPlanCache[DFT_PLAN_CACHE_SIZE];
+static int dftPlanCacheIdx = 0;
+
+// returns the cached plan or builds a new one, replacing the oldest cache entry
+static Ptr<DFTPlan> getDFTPlan( int len, int complex_elem_size, int inv_itab )
+{
+    {
+    AutoLock lock(dftPlanCacheMutex);
+    for( int i = 0; i < DFT_PLAN_CACHE_SIZE; i++ )
+    {
+        const Ptr<DFTPlan>& p = dftPlanCache[i];
+        if( !p.empty() && p->len == len && p->complex_elem_size == complex_elem_size &&
+            p->inv_itab == inv_itab )
+            return p;
+    }
+    }
+
+    Ptr<DFTPlan> plan = new DFTPlan( len, complex_elem_size, inv_itab );
+
+    AutoLock lock(dftPlanCacheMutex);
+    dftPlanCache[dftPlanCacheIdx] = plan;
+    dftPlanCacheIdx = (dftPlanCacheIdx + 1) % DFT_PLAN_CACHE_SIZE;
+    return plan;
+}
+
+// the minimal number of elements, processed by a single parallel_for chunk
+enum { DFT_PARALLEL_GRAIN_SIZE = 1 << 15 };
+
+class DFTRowsInvoker
+{
+public:
+    DFTRowsInvoker( const Mat& _src, const Mat& _dst, DFTFunc _dft_func, int _len,
+                    int _nf, const int* _factors, const int* _itab, const void* _wave,
+                    const void* _spec, int _work_size, int _complex_elem_size, bool _use_buf,
+                    int _dptr_offset, int _dst_full_len, int _flags, double _scale )
+        : src(_src), dst(_dst), dft_func(_dft_func), len(_len), nf(_nf), factors(_factors),
+          itab(_itab), wave(_wave), spec(_spec), work_size(_work_size),
+          complex_elem_size(_complex_elem_size), use_buf(_use_buf), dptr_offset(_dptr_offset),
+          dst_full_len(_dst_full_len), flags(_flags), scale(_scale) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int tmp_size = use_buf ? len*complex_elem_size : 0;
+        AutoBuffer<uchar> buf( tmp_size + work_size + 32 );
+        uchar* tmp_buf = use_buf ? alignPtr((uchar*)buf, 16) : 0;
+        uchar* ptr = alignPtr((uchar*)buf + tmp_size, 16);
+        // the real transforms temporarily modify the factors, so each body needs its own copy
+        int _factors[34];
+        memcpy( _factors, factors, nf*sizeof(_factors[0]) );
+
+        for( int i = range.begin(); i < range.end(); i++ )
+        {
+            uchar* sptr = src.data + i*src.step;
+            uchar* dptr0 = dst.data + i*dst.step;
+            uchar* dptr = tmp_buf ? tmp_buf : dptr0;
+
+            dft_func( sptr, dptr, len, nf, _factors, itab, wave, len, spec, ptr, flags, scale );
+            if( dptr != dptr0 )
+                memcpy( dptr0, dptr + dptr_offset, dst_full_len );
+        }
+    }
+
+protected:
+    Mat src, dst;
+    DFTFunc dft_func;
+    int len, nf;
+    const int* factors;
+    const int* itab;
+    const void* wave;
+    const void* spec;
+    int work_size, complex_elem_size;
+    bool use_buf;
+    int dptr_offset, dst_full_len, flags;
+    double scale;
+};
+
+// processes the pairs of complex columns [range.begin()*2, range.end()*2)
+class DFTColumnsInvoker
+{
+public:
+    DFTColumnsInvoker( const uchar* _sptr0, size_t _sstep, uchar* _dptr0, size_t _dstep,
+                       int _ncols, DFTFunc _dft_func, int _len, int _nf, const int* _factors,
+                       const int* _itab, const void* _wave, const void* _spec, int _work_size,
+                       int _complex_elem_size, bool _use_buf, int _inv, double _scale )
+        : sptr0(_sptr0), sstep(_sstep), dptr0(_dptr0), dstep(_dstep), ncols(_ncols),
+          dft_func(_dft_func), len(_len), nf(_nf), factors(_factors), itab(_itab), wave(_wave),
+          spec(_spec), work_size(_work_size), complex_elem_size(_complex_elem_size),
+          use_buf(_use_buf), inv(_inv), scale(_scale) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int vsize = len*complex_elem_size;
+        AutoBuffer<uchar> buf( vsize*3 + work_size + 32 );
+        uchar *buf0 = alignPtr((uchar*)buf, 16), *buf1 = buf0 + vsize;
+        uchar *dbuf0 = buf0, *dbuf1 = buf1, *ptr = buf1 + vsize;
+
+        if( use_buf )
+        {
+            dbuf1 = ptr;
+            dbuf0 = buf1;
+            ptr += vsize;
+        }
+        ptr = alignPtr(ptr, 16);
+
+        for( int i = range.begin()*2; i < range.end()*2 && i < ncols; i += 2 )
+        {
+            const uchar* sptr = sptr0 + i*complex_elem_size;
+            uchar* dptr = dptr0 + i*complex_elem_size;
+
+            if( i+1 < ncols )
+            {
+                CopyFrom2Columns( sptr, sstep, buf0, buf1, len, complex_elem_size );
+                dft_func( buf1, dbuf1, len, nf, (int*)factors, itab,
+                          wave, len, spec, ptr, inv, scale );
+            }
+            else
+                CopyColumn( sptr, sstep, buf0, complex_elem_size, len, complex_elem_size );
+
+            dft_func( buf0, dbuf0, len, nf, (int*)factors, itab,
+                      wave, len, spec, ptr, inv, scale );
+
+            if( i+1 < ncols )
+                CopyTo2Columns( dbuf0, dbuf1, dptr, dstep, len, complex_elem_size );
+            else
+                CopyColumn( dbuf0, complex_elem_size, dptr, dstep, len, complex_elem_size );
+        }
+    }
+
+protected:
+    const uchar* sptr0;
+    size_t sstep;
+    uchar* dptr0;
+    size_t dstep;
+    int ncols;
+    DFTFunc dft_func;
+    int len, nf;
+    const int* factors;
+    const int* itab;
+    const void* wave;
+    const void* spec;
+    int work_size, complex_elem_size;
+    bool use_buf;
+    int inv;
+    double scale;
+};
+    
 }
     
 
@@ -1464,11 +1645,10 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
         (DFTFunc)CCSIDFT_64f
     };
 
-    AutoBuffer<uchar> buf;
     void *spec = 0;
     
     Mat src0 = _src0.getMat(), src = src0;
-    int prev_len = 0, stage = 0;
+    int stage = 0;
     bool inv = (flags & DFT_INVERSE) != 0;
     int nf = 0, real_transform = src.channels() == 1 || (inv && (flags & DFT_REAL_OUTPUT)!=0);
     int type = src.type(), depth = src.depth();
@@ -1511,12 +1691,12 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
     for(;;)
     {
         double scale = 1;
-        uchar* wave = 0;
-        int* itab = 0;
-        uchar* ptr;
-        int i, len, count, sz = 0;
+        const void* wave = 0;
+        const int* itab = 0;
+        int i, len, count, work_size = 0;
         int use_buf = 0, odd_real = 0;
         DFTFunc dft_func;
+        Ptr<DFTPlan> plan;
 
         if( stage == 0 ) // row-wise transform
         {
@@ -1533,7 +1713,6 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
         {
             len = dst.rows;
             count = !inv ? src0.cols : dst.cols;
-            sz = 2*len*complex_elem_size;
         }
 
         spec = 0;
@@ -1583,63 +1762,35 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
                 spec = spec_c;
             }
 
-            sz += ipp_sz;
+            work_size = ipp_sz;
         }
         else
 #endif
         {
-            if( len != prev_len )
-                nf = DFTFactorize( len, factors );
-
-            inplace_transform = factors[0] == factors[nf-1];
-            sz += len*(complex_elem_size + sizeof(int));
-            i = nf > 1 && (factors[0] & 1) == 0;
-            if( (factors[i] & 1) != 0 && factors[i] > 5 )
-                sz += (factors[i]+1)*complex_elem_size;
+            // the factorization and the tables are taken from the cache of the DFT plans;
+            // the inverse real transform uses the inverted permutation table on the row-wise stage
+            plan = getDFTPlan( len, complex_elem_size, stage == 0 && inv && real_transform );
+            nf = plan->nf;
+            memcpy( factors, plan->factors, nf*sizeof(factors[0]) );
+            inplace_transform = plan->inplace;
+            work_size = plan->work_size;
+            wave = &plan->wave[0];
+            itab = &plan->itab[0];
 
             if( (stage == 0 && ((src.data == dst.data && !inplace_transform) || odd_real)) ||
                 (stage == 1 && !inplace_transform) )
-            {
                 use_buf = 1;
-                sz += len*complex_elem_size;
-            }
-        }
-
-        ptr = (uchar*)buf;
-        buf.allocate( sz + 32 );
-        if( ptr != (uchar*)buf )
-            prev_len = 0; // because we release the buffer,
-                          // force recalculation of
-                          // twiddle factors and permutation table
-        ptr = (uchar*)buf;
-        if( !spec )
-        {
-            wave = ptr;
-            ptr += len*complex_elem_size;
-            itab = (int*)ptr;
-            ptr = (uchar*)cvAlignPtr( ptr + len*sizeof(int), 16 );
-
-            if( len != prev_len || (!inplace_transform && inv && real_transform))
-                DFTInit( len, nf, factors, itab, complex_elem_size,
-                            wave, stage == 0 && inv && real_transform );
-            // otherwise reuse the tables calculated on the previous stage
         }
 
         if( stage == 0 )
         {
-            uchar* tmp_buf = 0;
             int dptr_offset = 0;
             int dst_full_len = len*elem_size;
             int _flags = inv + (src.channels() != dst.channels() ?
                          DFT_COMPLEX_INPUT_OR_OUTPUT : 0);
-            if( use_buf )
-            {
-                tmp_buf = ptr;
-                ptr += len*complex_elem_size;
-                if( odd_real && !inv && len > 1 &&
-                    !(_flags & DFT_COMPLEX_INPUT_OR_OUTPUT))
-                    dptr_offset = elem_size;
-            }
+            if( use_buf && odd_real && !inv && len > 1 &&
+                !(_flags & DFT_COMPLEX_INPUT_OR_OUTPUT))
+                dptr_offset = elem_size;
 
             if( !inv && (_flags & DFT_COMPLEX_INPUT_OR_OUTPUT) )
                 dst_full_len += (len & 1) ? elem_size : complex_elem_size;
@@ -1654,21 +1805,12 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
             if( nonzero_rows <= 0 || nonzero_rows > count )
                 nonzero_rows = count;
 
-            for( i = 0; i < nonzero_rows; i++ )
-            {
-                uchar* sptr = src.data + i*src.step;
-                uchar* dptr0 = dst.data + i*dst.step;
-                uchar* dptr = dptr0;
+            parallel_for( BlockedRange(0, nonzero_rows, std::max(DFT_PARALLEL_GRAIN_SIZE/len, 1)),
+                          DFTRowsInvoker(src, dst, dft_func, len, nf, factors, itab, wave, spec,
+                                         work_size, complex_elem_size, use_buf != 0, dptr_offset,
+                                         dst_full_len, _flags, scale) );
 
-                if( tmp_buf )
-                    dptr = tmp_buf;
-                
-                dft_func( sptr, dptr, len, nf, factors, itab, wave, len, spec, ptr, _flags, scale );
-                if( dptr != dptr0 )
-                    memcpy( dptr0, dptr + dptr_offset, dst_full_len );
-            }
-
-            for( ; i < count; i++ )
+            for( i = nonzero_rows; i < count; i++ )
             {
                 uchar* dptr0 = dst.data + i*dst.step;
                 memset( dptr0, 0, dst_full_len );
@@ -1681,21 +1823,8 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
         else
         {
             int a = 0, b = count;
-            uchar *buf0, *buf1, *dbuf0, *dbuf1;
             uchar* sptr0 = src.data;
             uchar* dptr0 = dst.data;
-            buf0 = ptr;
-            ptr += len*complex_elem_size;
-            buf1 = ptr;
-            ptr += len*complex_elem_size;
-            dbuf0 = buf0, dbuf1 = buf1;
-            
-            if( use_buf )
-            {
-                dbuf1 = ptr;
-                dbuf0 = buf1;
-                ptr += len*complex_elem_size;
-            }
 
             dft_func = dft_tbl[(depth == CV_64F)*3];
 
@@ -1707,6 +1836,19 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
             if( real_transform )
             {
                 int even;
+                int vsize = len*complex_elem_size;
+                AutoBuffer<uchar> buf( vsize*3 + work_size + 32 );
+                uchar *buf0 = alignPtr((uchar*)buf, 16), *buf1 = buf0 + vsize;
+                uchar *dbuf0 = buf0, *dbuf1 = buf1, *ptr = buf1 + vsize;
+
+                if( use_buf )
+                {
+                    dbuf1 = ptr;
+                    dbuf0 = buf1;
+                    ptr += vsize;
+                }
+                ptr = alignPtr(ptr, 16);
+
                 a = 1;
                 even = (count & 1) == 0;
                 b = (count+1)/2;
@@ -1792,26 +1934,13 @@ void cv::dft( InputArray _src0, OutputArray _dst, int flags, int nonzero_rows )
                 }
             }
 
-            for( i = a; i < b; i += 2 )
+            if( a < b )
             {
-                if( i+1 < b )
-                {
-                    CopyFrom2Columns( sptr0, src.step, buf0, buf1, len, complex_elem_size );
-                    dft_func( buf1, dbuf1, len, nf, factors, itab,
-                              wave, len, spec, ptr, inv, scale );
-                }
-                else
-                    CopyColumn( sptr0, src.step, buf0, complex_elem_size, len, complex_elem_size );
-
-                dft_func( buf0, dbuf0, len, nf, factors, itab,
-                          wave, len, spec, ptr, inv, scale );
-
-                if( i+1 < b )
-                    CopyTo2Columns( dbuf0, dbuf1, dptr0, dst.step, len, complex_elem_size );
-                else
-                    CopyColumn( dbuf0, complex_elem_size, dptr0, dst.step, len, complex_elem_size );
-                sptr0 += 2*complex_elem_size;
-                dptr0 += 2*complex_elem_size;
+                int npairs = (b - a + 1)/2;
+                parallel_for( BlockedRange(0, npairs, std::max(DFT_PARALLEL_GRAIN_SIZE/(len*2), 1)),
+                              DFTColumnsInvoker(sptr0, src.step, dptr0, dst.step, b - a, dft_func,
+                                                len, nf, factors, itab, wave, spec, work_size,
+                                                complex_elem_size, use_buf != 0, inv, scale) );
             }
 
             if( stage != 0 )
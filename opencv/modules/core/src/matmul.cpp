@@ -683,6 +683,266 @@ static void GEMMStore_64fc( const Complexd* c_data, size_t c_step,
     GEMMStore(c_data, c_step, d_buf, d_buf_step, d_data, d_step, d_size, alpha, beta, flags);
 }
 
+/****************************************************************************************\
+*                                  Packed-panel GEMM                                     *
+\****************************************************************************************/
+
+/*
+   Cache-blocked GEMM for the real single-channel types.
+
+   D is computed by GEMM_PACK_MC x GEMM_PACK_KC blocks of op(A) times GEMM_PACK_KC x n
+   slices of op(B). op(B) is repacked once into column panels of GEMMPackTraits<T>::NR
+   elements, op(A) is repacked per block of rows into panels of GEMM_PACK_MR rows,
+   so the micro-kernel reads both operands sequentially and the transposition flags
+   are resolved by the packing. The row blocks are processed in parallel.
+*/
+
+enum { GEMM_PACK_MR = 4, GEMM_PACK_MC = 64, GEMM_PACK_KC = 256 };
+
+// do not bother with packing for the products smaller than that (in multiply-adds)
+static const double GEMM_PACK_MIN_OPS = 64.*64.*64.;
+
+template<typename T> struct GEMMPackTraits {};
+
+template<> struct GEMMPackTraits<float>
+{
+    enum { NR = 4 };
+
+    // the products are accumulated in double precision, like in the non-blocked code path
+    static void kernel( const float* a, const float* b, int kc, double* ab )
+    {
+        int k = 0;
+    #if CV_SSE2
+        if( USE_SSE2 )
+        {
+            __m128d c00 = _mm_setzero_pd(), c01 = c00, c10 = c00, c11 = c00;
+            __m128d c20 = c00, c21 = c00, c30 = c00, c31 = c00;
+            for( ; k < kc; k++, a += GEMM_PACK_MR, b += NR )
+            {
+                __m128 bf = _mm_load_ps(b);
+                __m128d b0 = _mm_cvtps_pd(bf), b1 = _mm_cvtps_pd(_mm_movehl_ps(bf, bf)), t;
+                t = _mm_set1_pd(a[0]);
+                c00 = _mm_add_pd(c00, _mm_mul_pd(t, b0));
+                c01 = _mm_add_pd(c01, _mm_mul_pd(t, b1));
+                t = _mm_set1_pd(a[1]);
+                c10 = _mm_add_pd(c10, _mm_mul_pd(t, b0));
+                c11 = _mm_add_pd(c11, _mm_mul_pd(t, b1));
+                t = _mm_set1_pd(a[2]);
+                c20 = _mm_add_pd(c20, _mm_mul_pd(t, b0));
+                c21 = _mm_add_pd(c21, _mm_mul_pd(t, b1));
+                t = _mm_set1_pd(a[3]);
+                c30 = _mm_add_pd(c30, _mm_mul_pd(t, b0));
+                c31 = _mm_add_pd(c31, _mm_mul_pd(t, b1));
+            }
+            _mm_store_pd(ab, c00); _mm_store_pd(ab + 2, c01);
+            _mm_store_pd(ab + 4, c10); _mm_store_pd(ab + 6, c11);
+            _mm_store_pd(ab + 8, c20); _mm_store_pd(ab + 10, c21);
+            _mm_store_pd(ab + 12, c30); _mm_store_pd(ab + 14, c31);
+            return;
+        }
+    #endif
+        for( int i = 0; i < GEMM_PACK_MR*NR; i++ )
+            ab[i] = 0.;
+        for( ; k < kc; k++, a += GEMM_PACK_MR, b += NR )
+            for( int i = 0; i < GEMM_PACK_MR; i++ )
+            {
+                double t = a[i];
+                for( int j = 0; j < NR; j++ )
+                    ab[i*NR + j] += t*b[j];
+            }
+    }
+};
+
+template<> struct GEMMPackTraits<double>
+{
+    enum { NR = 4 };
+
+    static void kernel( const double* a, const double* b, int kc, double* ab )
+    {
+        int k = 0;
+    #if CV_SSE2
+        if( USE_SSE2 )
+        {
+            __m128d c00 = _mm_setzero_pd(), c01 = c00, c10 = c00, c11 = c00;
+            __m128d c20 = c00, c21 = c00, c30 = c00, c31 = c00;
+            for( ; k < kc; k++, a += GEMM_PACK_MR, b += NR )
+            {
+                __m128d b0 = _mm_load_pd(b), b1 = _mm_load_pd(b + 2), t;
+                t = _mm_set1_pd(a[0]);
+                c00 = _mm_add_pd(c00, _mm_mul_pd(t, b0));
+                c01 = _mm_add_pd(c01, _mm_mul_pd(t, b1));
+                t = _mm_set1_pd(a[1]);
+                c10 = _mm_add_pd(c10, _mm_mul_pd(t, b0));
+                c11 = _mm_add_pd(c11, _mm_mul_pd(t, b1));
+                t = _mm_set1_pd(a[2]);
+                c20 = _mm_add_pd(c20, _mm_mul_pd(t, b0));
+                c21 = _mm_add_pd(c21, _mm_mul_pd(t, b1));
+                t = _mm_set1_pd(a[3]);
+                c30 = _mm_add_pd(c30, _mm_mul_pd(t, b0));
+                c31 = _mm_add_pd(c31, _mm_mul_pd(t, b1));
+            }
+            _mm_store_pd(ab, c00); _mm_store_pd(ab + 2, c01);
+            _mm_store_pd(ab + 4, c10); _mm_store_pd(ab + 6, c11);
+            _mm_store_pd(ab + 8, c20); _mm_store_pd(ab + 10, c21);
+            _mm_store_pd(ab + 12, c30); _mm_store_pd(ab + 14, c31);
+            return;
+        }
+    #endif
+        for( int i = 0; i < GEMM_PACK_MR*NR; i++ )
+            ab[i] = 0.;
+        for( ; k < kc; k++, a += GEMM_PACK_MR, b += NR )
+            for( int i = 0; i < GEMM_PACK_MR; i++ )
+            {
+                double t = a[i];
+                for( int j = 0; j < NR; j++ )
+                    ab[i*NR + j] += t*b[j];
+            }
+    }
+};
+
+
+template<typename T> class GEMMPackedInvoker
+{
+public:
+    enum { MR = GEMM_PACK_MR, NR = GEMMPackTraits<T>::NR };
+
+    GEMMPackedInvoker( const Mat& _A, size_t _a_step0, size_t _a_step1, const T* _bpack,
+                       const Mat& _C, size_t _c_step0, size_t _c_step1, const Mat& _D,
+                       int _len, double _alpha, double _beta )
+        : A(_A), a_step0(_a_step0), a_step1(_a_step1), bpack(_bpack),
+          C(_C), c_step0(_c_step0), c_step1(_c_step1), D(_D),
+          len(_len), alpha(_alpha), beta(_beta) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int m = D.rows, n = D.cols, np = alignSize(n, NR);
+        int kc0 = std::min(len, (int)GEMM_PACK_KC);
+        AutoBuffer<T> _abuf(GEMM_PACK_MC*kc0 + 16/sizeof(T));
+        T* abuf = alignPtr((T*)_abuf, 16);
+        double CV_DECL_ALIGNED(16) ab[MR*NR];
+
+        for( int bi = range.begin(); bi < range.end(); bi++ )
+        {
+            int i0 = bi*GEMM_PACK_MC, mc = std::min((int)GEMM_PACK_MC, m - i0);
+
+            for( int k0 = 0; k0 < len; k0 += GEMM_PACK_KC )
+            {
+                int kc = std::min((int)GEMM_PACK_KC, len - k0);
+                const T* bslice = bpack + (size_t)k0*np;
+                packA( i0, mc, k0, kc, abuf );
+
+                for( int j0 = 0; j0 < n; j0 += NR )
+                {
+                    const T* bp = bslice + (size_t)j0*kc;
+                    int nr = std::min((int)NR, n - j0);
+                    for( int ii = 0; ii < mc; ii += MR )
+                    {
+                        GEMMPackTraits<T>::kernel( abuf + ii*kc, bp, kc, ab );
+                        store( i0 + ii, j0, std::min((int)MR, mc - ii), nr, ab, k0 == 0 );
+                    }
+                }
+            }
+        }
+    }
+
+protected:
+    // copies op(A)(i0:i0+mc, k0:k0+kc) into MR-row panels, padding the last one with zeros
+    void packA( int i0, int mc, int k0, int kc, T* dst ) const
+    {
+        for( int ii = 0; ii < mc; ii += MR )
+        {
+            int mr = std::min((int)MR, mc - ii);
+            const uchar* a = A.data + (i0 + ii)*a_step0 + k0*a_step1;
+            for( int k = 0; k < kc; k++, dst += MR, a += a_step1 )
+            {
+                int r = 0;
+                for( ; r < mr; r++ )
+                    dst[r] = *(const T*)(a + r*a_step0);
+                for( ; r < MR; r++ )
+                    dst[r] = 0;
+            }
+        }
+    }
+
+    // D(i0:i0+mr, j0:j0+nr) = alpha*ab + (first ? beta*op(C) : D);
+    // the partial sums of the float products are rounded to float once per GEMM_PACK_KC slice
+    void store( int i0, int j0, int mr, int nr, const double* ab, bool first ) const
+    {
+        for( int r = 0; r < mr; r++, ab += NR )
+        {
+            T* d = (T*)(D.data + (i0 + r)*D.step) + j0;
+            if( !first )
+                for( int j = 0; j < nr; j++ )
+                    d[j] = (T)(d[j] + alpha*ab[j]);
+            else if( C.data )
+            {
+                const uchar* c = C.data + (i0 + r)*c_step0 + j0*c_step1;
+                for( int j = 0; j < nr; j++ )
+                    d[j] = (T)(alpha*ab[j] + beta*(*(const T*)(c + j*c_step1)));
+            }
+            else
+                for( int j = 0; j < nr; j++ )
+                    d[j] = (T)(alpha*ab[j]);
+        }
+    }
+
+    Mat A;
+    size_t a_step0, a_step1;
+    const T* bpack;
+    Mat C;
+    size_t c_step0, c_step1;
+    Mat D;
+    int len;
+    double alpha, beta;
+};
+
+
+template<typename T> static void
+GEMMPacked( const Mat& A, const Mat& B, const Mat& C, Mat& D,
+            int len, double alpha, double beta, int flags )
+{
+    const int NR = GEMMPackTraits<T>::NR;
+    int n = D.cols, np = alignSize(n, NR);
+    size_t esz = sizeof(T);
+    size_t a_step0 = A.step, a_step1 = esz, b_step0 = B.step, b_step1 = esz;
+    size_t c_step0 = C.step, c_step1 = esz;
+
+    if( flags & GEMM_1_T )
+        std::swap(a_step0, a_step1);
+    if( flags & GEMM_2_T )
+        std::swap(b_step0, b_step1);
+    if( flags & GEMM_3_T )
+        std::swap(c_step0, c_step1);
+
+    // op(B) is packed as a sequence of GEMM_PACK_KC-row slices;
+    // each slice is a sequence of NR-column panels stored row by row
+    AutoBuffer<T> _bbuf((size_t)len*np + 16/esz);
+    T* bpack = alignPtr((T*)_bbuf, 16);
+
+    for( int k0 = 0; k0 < len; k0 += GEMM_PACK_KC )
+    {
+        int kc = std::min((int)GEMM_PACK_KC, len - k0);
+        T* dst = bpack + (size_t)k0*np;
+        for( int j0 = 0; j0 < n; j0 += NR )
+        {
+            int nr = std::min(NR, n - j0);
+            const uchar* b = B.data + k0*b_step0 + j0*b_step1;
+            for( int k = 0; k < kc; k++, dst += NR, b += b_step0 )
+            {
+                int j = 0;
+                for( ; j < nr; j++ )
+                    dst[j] = *(const T*)(b + j*b_step1);
+                for( ; j < NR; j++ )
+                    dst[j] = 0;
+            }
+        }
+    }
+
+    parallel_for( BlockedRange(0, (D.rows + GEMM_PACK_MC - 1)/GEMM_PACK_MC),
+                  GEMMPackedInvoker<T>(A, a_step0, a_step1, bpack, C, c_step0, c_step1,
+                                       D, len, alpha, beta) );
+}
+
 }
 
 void cv::gemm( InputArray matA, InputArray matB, double alpha,
@@ -1040,7 +1300,11 @@ void cv::gemm( InputArray matA, InputArray matB, double alpha,
         matD = &tmat;
     }
 
-    if( (d_size.width == 1 || len == 1) && !(flags & GEMM_2_T) && B.isContinuous() )
+    bool usePacked = (type == CV_32FC1 || type == CV_64FC1) && len > 10 &&
+        std::min(d_size.width, d_size.height) >= GEMM_PACK_MR*2 &&
+        (double)d_size.width*d_size.height*len >= GEMM_PACK_MIN_OPS;
+
+    if( !usePacked && (d_size.width == 1 || len == 1) && !(flags & GEMM_2_T) && B.isContinuous() )
     {
         b_step = d_size.width == 1 ? 0 : CV_ELEM_SIZE(type);
         flags |= GEMM_2_T;
@@ -1108,7 +1372,14 @@ void cv::gemm( InputArray matA, InputArray matB, double alpha,
                    &_beta, D->data.ptr, &ldd );
         }
     }
-    else*/ if( ((d_size.height <= block_lin_size/2 || d_size.width <= block_lin_size/2) &&
+    else*/ if( usePacked )
+    {
+        if( type == CV_32FC1 )
+            GEMMPacked<float>( A, B, C, *matD, len, alpha, beta, flags );
+        else
+            GEMMPacked<double>( A, B, C, *matD, len, alpha, beta, flags );
+    }
+    else if( ((d_size.height <= block_lin_size/2 || d_size.width <= block_lin_size/2) &&
         len <= 10000) || len <= 10 ||
         (d_size.width <= block_lin_size &&
         d_size.height <= block_lin_size && len <= block_lin_size) )
@@ -2616,7 +2887,7 @@ static double dotProd_8u(const uchar* src1, const uchar* src2, int len)
                 s0 = _mm_madd_epi16(s0, s1);
                 s1 = _mm_madd_epi16(s2, s3);
                 s = _mm_add_epi32(s, s0);
-                s = _mm_add_epi32(s, s2);
+                s = _mm_add_epi32(s, s1);
             }
 
             for( ; j < blockSize; j += 4 )
@@ -119,6 +119,75 @@ public:
 };
     
 static MatOp_Cmp g_MatOp_Cmp;
+
+/*
+ Element-wise MatOp_AddEx, MatOp_Bin or MatOp_Cmp node, some operands of which
+ are other element-wise expressions (ea, eb) rather than matrices.
+ The whole expression tree is evaluated in a single pass over the matrices,
+ tile by tile, so that the intermediate results never take more than a few cache lines.
+
+ There is one MatOp_Fused instance per base operation. The flags, a, b, alpha, beta
+ and s fields have the same meaning as in the base operation, while c, which the
+ element-wise operations do not use otherwise, carries the sub-expressions (FusedOperands).
+ The sub-expressions are evaluated when the fused expression is assigned to a matrix.
+*/
+class MatOp_Fused : public MatOp
+{
+public:
+    MatOp_Fused(const MatOp* _base) : base(_base) {}
+    virtual ~MatOp_Fused() {}
+    
+    bool elementWise(const MatExpr& /*expr*/) const { return true; }
+    void assign(const MatExpr& expr, Mat& m, int type=-1) const;
+    void roi(const MatExpr& expr, const Range& rowRange,
+             const Range& colRange, MatExpr& res) const;
+    void diag(const MatExpr& expr, int d, MatExpr& res) const;
+    
+    void add(const MatExpr& e1, const Scalar& s, MatExpr& res) const;
+    void subtract(const Scalar& s, const MatExpr& expr, MatExpr& res) const;
+    void multiply(const MatExpr& e1, double s, MatExpr& res) const;
+    void abs(const MatExpr& expr, MatExpr& res) const;
+    
+    Size size(const MatExpr& expr) const;
+    int type(const MatExpr& expr) const;
+    
+    void assignSeparately(const MatExpr& e, Mat& m, int type=-1) const;
+    
+    static void makeExpr(MatExpr& res, const Ptr<MatExpr>& ea, const Ptr<MatExpr>& eb);
+    static void makeExpr(MatExpr& res, const MatOp* base, const Ptr<MatExpr>& ea, const Ptr<MatExpr>& eb);
+    
+    const MatOp* base;
+};
+
+static MatOp_Fused g_MatOp_FusedAddEx(&g_MatOp_AddEx);
+static MatOp_Fused g_MatOp_FusedBin(&g_MatOp_Bin);
+static MatOp_Fused g_MatOp_FusedCmp(&g_MatOp_Cmp);
+
+// the sub-expressions of a fused expression, shared by its copies through MatExpr::c
+struct FusedOperands
+{
+    FusedOperands(const Ptr<MatExpr>& _ea, const Ptr<MatExpr>& _eb) : ea(_ea), eb(_eb), refcount(1) {}
+    
+    Ptr<MatExpr> ea, eb;
+    int refcount;
+};
+
+// deletes FusedOperands when the last expression referencing them is released
+class FusedOperandsAllocator : public MatAllocator
+{
+public:
+    void allocate(int, const int*, int, int*&, uchar*&, uchar*&, size_t*)
+    {
+        CV_Error( CV_StsNotImplemented, "The operands of a fused expression can not be reallocated" );
+    }
+    
+    void deallocate(int*, uchar* datastart, uchar*)
+    {
+        delete (FusedOperands*)datastart;
+    }
+};
+
+static FusedOperandsAllocator g_FusedOperandsAllocator;
     
 class MatOp_GEMM : public MatOp
 {
@@ -216,6 +285,27 @@ static inline bool isSolve(const MatExpr& e) { return e.op == &g_MatOp_Solve; }
 static inline bool isGEMM(const MatExpr& e) { return e.op == &g_MatOp_GEMM; }
 static inline bool isMatProd(const MatExpr& e) { return e.op == &g_MatOp_GEMM && (!e.c.data || e.beta == 0); }
 static inline bool isInitializer(const MatExpr& e) { return e.op == &g_MatOp_Initializer; }
+static inline bool isFused(const MatExpr& e)
+{
+    return e.op == &g_MatOp_FusedAddEx || e.op == &g_MatOp_FusedBin || e.op == &g_MatOp_FusedCmp;
+}
+static inline const FusedOperands& getFusedOperands(const MatExpr& e)
+{
+    if( !e.c.data || e.c.allocator != &g_FusedOperandsAllocator )
+        CV_Error( CV_StsBadArg, "The fused expression does not have its operands; MatExpr::c has been modified" );
+    return *(const FusedOperands*)e.c.data;
+}
+static inline bool isFusable(const MatExpr& e) { return isAddEx(e) || e.op == &g_MatOp_Bin || isCmp(e) || isFused(e); }
+    
+// retrieves an operand of an element-wise operation: the element-wise expressions
+// are passed further as they are, the rest is evaluated into a temporary matrix
+static void getOperand(const MatExpr& e, Mat& m, Ptr<MatExpr>& pe)
+{
+    if( isFusable(e) )
+        pe = new MatExpr(e);
+    else
+        e.op->assign(e, m);
+}
     
 /////////////////////////////////////////////////////////////////////////////////////////////////////
     
@@ -330,6 +420,7 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
         double alpha = 1, beta = 1;
         Scalar s;
         Mat m1, m2;
+        Ptr<MatExpr> pe1, pe2;
         if( isAddEx(e1) && (!e1.b.data || e1.beta == 0) )
         {
             m1 = e1.a;
@@ -337,7 +428,7 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
             s = e1.s;
         }
         else
-            e1.op->assign(e1, m1);
+            getOperand(e1, m1, pe1);
         
         if( isAddEx(e2) && (!e2.b.data || e2.beta == 0) )
         {
@@ -346,8 +437,9 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
             s += e2.s;
         }    
         else
-            e2.op->assign(e2, m2);
+            getOperand(e2, m2, pe2);
         MatOp_AddEx::makeExpr(res, m1, m2, alpha, beta, s);
+        MatOp_Fused::makeExpr(res, pe1, pe2);
     }
     else
         e2.op->add(e1, e2, res);
@@ -357,8 +449,10 @@ void MatOp::add(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 void MatOp::add(const MatExpr& expr1, const Scalar& s, MatExpr& res) const
 {
     Mat m1;
-    expr1.op->assign(expr1, m1);
+    Ptr<MatExpr> pe1;
+    getOperand(expr1, m1, pe1);
     MatOp_AddEx::makeExpr(res, m1, Mat(), 1, 0, s);
+    MatOp_Fused::makeExpr(res, pe1, Ptr<MatExpr>());
 }
 
     
@@ -369,6 +463,7 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
         double alpha = 1, beta = -1;
         Scalar s;
         Mat m1, m2;
+        Ptr<MatExpr> pe1, pe2;
         if( isAddEx(e1) && (!e1.b.data || e1.beta == 0) )
         {
             m1 = e1.a;
@@ -376,7 +471,7 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
             s = e1.s;
         }
         else
-            e1.op->assign(e1, m1);
+            getOperand(e1, m1, pe1);
         
         if( isAddEx(e2) && (!e2.b.data || e2.beta == 0) )
         {
@@ -385,8 +480,9 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
             s -= e2.s;
         }    
         else
-            e2.op->assign(e2, m2);
+            getOperand(e2, m2, pe2);
         MatOp_AddEx::makeExpr(res, m1, m2, alpha, beta, s);
+        MatOp_Fused::makeExpr(res, pe1, pe2);
     }
     else
         e2.op->subtract(e1, e2, res);
@@ -396,8 +492,10 @@ void MatOp::subtract(const MatExpr& e1, const MatExpr& e2, MatExpr& res) const
 void MatOp::subtract(const Scalar& s, const MatExpr& expr, MatExpr& res) const
 {
     Mat m;
-    expr.op->assign(expr, m);
+    Ptr<MatExpr> pe;
+    getOperand(expr, m, pe);
     MatOp_AddEx::makeExpr(res, m, Mat(), -1, 0, s);
+    MatOp_Fused::makeExpr(res, pe, Ptr<MatExpr>());
 }
 
     
@@ -406,6 +504,7 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
     if( this == e2.op )
     {
         Mat m1, m2;
+        Ptr<MatExpr> pe1, pe2;
         
         if( isReciprocal(e1) )
         {
@@ -415,9 +514,10 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
                 m2 = e2.a;
             }
             else
-                e2.op->assign(e2, m2);
+                getOperand(e2, m2, pe2);
 
             MatOp_Bin::makeExpr(res, '/', m2, e1.a, scale/e1.alpha);
+            MatOp_Fused::makeExpr(res, pe2, Ptr<MatExpr>());
         }
         else
         {
@@ -428,7 +528,7 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
                 scale *= e1.alpha;
             }
             else
-                e1.op->assign(e1, m1);
+                getOperand(e1, m1, pe1);
             
             if( isScaled(e2) )
             {
@@ -442,9 +542,10 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
                 scale /= e2.alpha;
             }
             else
-                e2.op->assign(e2, m2);
+                getOperand(e2, m2, pe2);
             
             MatOp_Bin::makeExpr(res, op, m1, m2, scale);
+            MatOp_Fused::makeExpr(res, pe1, pe2);
         }
     }
     else
@@ -455,8 +556,10 @@ void MatOp::multiply(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double
 void MatOp::multiply(const MatExpr& expr, double s, MatExpr& res) const
 {
     Mat m;
-    expr.op->assign(expr, m);
-    MatOp_AddEx::makeExpr(res, m, Mat(), s, 0); 
+    Ptr<MatExpr> pe;
+    getOperand(expr, m, pe);
+    MatOp_AddEx::makeExpr(res, m, Mat(), s, 0);
+    MatOp_Fused::makeExpr(res, pe, Ptr<MatExpr>());
 }
     
     
@@ -469,6 +572,7 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
         else
         {
             Mat m1, m2;
+            Ptr<MatExpr> pe1, pe2;
             char op = '/';
             
             if( isScaled(e1) )
@@ -477,7 +581,7 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
                 scale *= e1.alpha;
             }
             else
-                e1.op->assign(e1, m1);
+                getOperand(e1, m1, pe1);
             
             if( isScaled(e2) )
             {
@@ -491,8 +595,9 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
                 op = '*';
             }
             else
-                e2.op->assign(e2, m2);
+                getOperand(e2, m2, pe2);
             MatOp_Bin::makeExpr(res, op, m1, m2, scale);
+            MatOp_Fused::makeExpr(res, pe1, pe2);
         }
     }
     else
@@ -503,16 +608,20 @@ void MatOp::divide(const MatExpr& e1, const MatExpr& e2, MatExpr& res, double sc
 void MatOp::divide(double s, const MatExpr& expr, MatExpr& res) const
 {
     Mat m;
-    expr.op->assign(expr, m);
+    Ptr<MatExpr> pe;
+    getOperand(expr, m, pe);
     MatOp_Bin::makeExpr(res, '/', m, Mat(), s);
+    MatOp_Fused::makeExpr(res, pe, Ptr<MatExpr>());
 }
 
     
 void MatOp::abs(const MatExpr& expr, MatExpr& res) const
 {
     Mat m;
-    expr.op->assign(expr, m);
+    Ptr<MatExpr> pe;
+    getOperand(expr, m, pe);
     MatOp_Bin::makeExpr(res, 'a', m, Mat());
+    MatOp_Fused::makeExpr(res, pe, Ptr<MatExpr>());
 }
 
     
@@ -1405,6 +1514,318 @@ inline void MatOp_Cmp::makeExpr(MatExpr& res, int cmpop, const Mat& a, double al
     res = MatExpr(&g_MatOp_Cmp, cmpop, a, Mat(), Mat(), alpha, 1);
 }
 
+///////////////////////////////////////////////////////////////////////////////////////////////////////
+
+// the maximum number of elements in a tile processed by the fused expression in one go
+static const int FUSED_TILE_SIZE = 1 << 12;
+    
+struct FusedExprNode
+{
+    const MatOp* op;
+    int flags;
+    Mat a, b;
+    double alpha, beta;
+    Scalar s;
+    // the indices of the nodes computing a and b (or -1) and the type of the node output
+    int ia, ib, type;
+};
+
+// puts the expression tree into the list of nodes, so that all the operands precede their consumers
+static int addFusedExprNode(const MatExpr& e, std::vector<FusedExprNode>& nodes)
+{
+    FusedExprNode n;
+    const FusedOperands* fe = isFused(e) ? &getFusedOperands(e) : 0;
+    n.op = fe ? ((const MatOp_Fused*)e.op)->base : e.op;
+    n.flags = e.flags;
+    n.a = e.a;
+    n.b = e.b;
+    n.alpha = e.alpha;
+    n.beta = e.beta;
+    n.s = e.s;
+    n.ia = fe && !fe->ea.empty() ? addFusedExprNode(*fe->ea, nodes) : -1;
+    n.ib = fe && !fe->eb.empty() ? addFusedExprNode(*fe->eb, nodes) : -1;
+    int atype = n.ia >= 0 ? nodes[n.ia].type : n.a.type();
+    n.type = n.op == &g_MatOp_Cmp ? CV_8UC(CV_MAT_CN(atype)) : atype;
+    nodes.push_back(n);
+    return (int)nodes.size() - 1;
+}
+
+// checks that src can be read while dst is being written tile by tile
+static bool isSameOrDisjoint(const Mat& src, const Mat& dst)
+{
+    if( src.data == dst.data && src.step == dst.step && src.elemSize() == dst.elemSize() )
+        return true;
+    const uchar* sptr0 = src.data, *sptr1 = src.data + src.step*(src.rows - 1) + src.cols*src.elemSize();
+    const uchar* dptr0 = dst.data, *dptr1 = dst.data + dst.step*(dst.rows - 1) + dst.cols*dst.elemSize();
+    return sptr1 <= dptr0 || dptr1 <= sptr0;
+}
+
+class FusedExprInvoker
+{
+public:
+    FusedExprInvoker(const std::vector<FusedExprNode>& _nodes, const Mat& _dst, int _dtype, Size _tile)
+        : nodes(&_nodes), dst(_dst), dtype(_dtype), tile(_tile) {}
+    
+    void operator()(const BlockedRange& range) const
+    {
+        const std::vector<FusedExprNode>& n = *nodes;
+        size_t i, nn = n.size();
+        int ntx = (dst.cols + tile.width - 1)/tile.width;
+        
+        // each intermediate result is kept within a single tile-size buffer
+        std::vector<Mat> buf(nn);
+        for( i = 0; i + 1 < nn; i++ )
+            buf[i].create(tile, n[i].type);
+        
+        for( int t = range.begin(); t < range.end(); t++ )
+        {
+            int y = (t / ntx)*tile.height, x = (t % ntx)*tile.width;
+            Range rows(y, std::min(y + tile.height, dst.rows)), cols(x, std::min(x + tile.width, dst.cols));
+            Rect r(0, 0, cols.size(), rows.size());
+            
+            for( i = 0; i < nn; i++ )
+            {
+                const FusedExprNode& ni = n[i];
+                MatExpr e(ni.op, ni.flags, ni.ia >= 0 ? buf[ni.ia](r) : ni.a(rows, cols),
+                          ni.ib >= 0 ? buf[ni.ib](r) : ni.b.data ? ni.b(rows, cols) : Mat(),
+                          Mat(), ni.alpha, ni.beta, ni.s);
+                Mat d = i + 1 < nn ? buf[i](r) : dst(rows, cols);
+                ni.op->assign(e, d, i + 1 < nn ? -1 : dtype);
+            }
+        }
+    }
+    
+private:
+    const std::vector<FusedExprNode>* nodes;
+    Mat dst;
+    int dtype;
+    Size tile;
+};
+    
+void MatOp_Fused::assignSeparately(const MatExpr& e, Mat& m, int _type) const
+{
+    const Ptr<MatExpr>& ea = getFusedOperands(e).ea, &eb = getFusedOperands(e).eb;
+    MatExpr temp(base, e.flags, ea.empty() ? e.a : (Mat)*ea,
+                 eb.empty() ? e.b : (Mat)*eb, Mat(), e.alpha, e.beta, e.s);
+    base->assign(temp, m, _type);
+}
+    
+void MatOp_Fused::assign(const MatExpr& e, Mat& m, int _type) const
+{
+    std::vector<FusedExprNode> nodes;
+    addFusedExprNode(e, nodes);
+    
+    Size sz = size(e);
+    bool fusable = sz.width > 0 && sz.height > 0;
+    bool continuous = true;
+    size_t i;
+    
+    for( i = 0; i < nodes.size() && fusable; i++ )
+    {
+        const Mat& a = nodes[i].a, &b = nodes[i].b;
+        fusable = (!a.data || (a.dims <= 2 && a.size() == sz)) &&
+                  (!b.data || (b.dims <= 2 && b.size() == sz));
+        continuous = continuous && a.isContinuous() && b.isContinuous();
+    }
+    
+    int type = nodes.back().type;
+    if( _type >= 0 )
+        type = CV_MAKETYPE(CV_MAT_DEPTH(_type), CV_MAT_CN(type));
+    
+    if( !fusable )
+    {
+        // evaluate the operands separately; base->assign() reports the size mismatch, if any
+        assignSeparately(e, m, _type);
+        return;
+    }
+    
+    m.create(sz, type);
+    continuous = continuous && m.isContinuous();
+    
+    if( !continuous && (sz.width*CV_MAT_CN(type)) % 4 != 0 )
+    {
+        // cv::divide() rounds the quotients of each 4 consecutive elements of a row together.
+        // The row-wise tiles keep this grouping unless the row length is not a multiple of 4,
+        // while the separate evaluation would merge the rows of its temporary matrices.
+        for( i = 0; i < nodes.size(); i++ )
+            if( nodes[i].op == &g_MatOp_Bin && nodes[i].flags == '/' )
+            {
+                assignSeparately(e, m, _type);
+                return;
+            }
+    }
+    
+    for( i = 0; i < nodes.size(); i++ )
+        if( (nodes[i].a.data && !isSameOrDisjoint(nodes[i].a, m)) ||
+            (nodes[i].b.data && !isSameOrDisjoint(nodes[i].b, m)) )
+        {
+            // the output partially overlaps one of the inputs
+            Mat temp;
+            assign(e, temp, type);
+            temp.copyTo(m);
+            return;
+        }
+    
+    Mat dst = m;
+    if( continuous )
+    {
+        for( i = 0; i < nodes.size(); i++ )
+        {
+            if( nodes[i].a.data )
+                nodes[i].a = nodes[i].a.reshape(0, 1);
+            if( nodes[i].b.data )
+                nodes[i].b = nodes[i].b.reshape(0, 1);
+        }
+        dst = dst.reshape(0, 1);
+    }
+    
+    Size tile(std::min(dst.cols, FUSED_TILE_SIZE), 1);
+    tile.height = std::min(std::max(FUSED_TILE_SIZE/tile.width, 1), dst.rows);
+    int ntiles = ((dst.cols + tile.width - 1)/tile.width)*((dst.rows + tile.height - 1)/tile.height);
+    
+    parallel_for(BlockedRange(0, ntiles, 8), FusedExprInvoker(nodes, dst, type, tile));
+}
+    
+void MatOp_Fused::roi(const MatExpr& e, const Range& rowRange, const Range& colRange, MatExpr& res) const
+{
+    const Ptr<MatExpr>& ea = getFusedOperands(e).ea, &eb = getFusedOperands(e).eb;
+    MatExpr r = e;
+    Ptr<MatExpr> ra, rb;
+    if( e.a.data )
+        r.a = e.a(rowRange, colRange);
+    if( e.b.data )
+        r.b = e.b(rowRange, colRange);
+    if( !ea.empty() )
+        ra = new MatExpr((*ea)(rowRange, colRange));
+    if( !eb.empty() )
+        rb = new MatExpr((*eb)(rowRange, colRange));
+    makeExpr(r, base, ra, rb);
+    res = r;
+}
+    
+void MatOp_Fused::diag(const MatExpr& e, int d, MatExpr& res) const
+{
+    const Ptr<MatExpr>& ea = getFusedOperands(e).ea, &eb = getFusedOperands(e).eb;
+    MatExpr r = e;
+    Ptr<MatExpr> ra, rb;
+    if( e.a.data )
+        r.a = e.a.diag(d);
+    if( e.b.data )
+        r.b = e.b.diag(d);
+    if( !ea.empty() )
+        ra = new MatExpr(ea->diag(d));
+    if( !eb.empty() )
+        rb = new MatExpr(eb->diag(d));
+    makeExpr(r, base, ra, rb);
+    res = r;
+}
+    
+void MatOp_Fused::add(const MatExpr& e, const Scalar& s, MatExpr& res) const
+{
+    if( base == &g_MatOp_AddEx )
+    {
+        res = e;
+        res.s += s;
+    }
+    else
+        MatOp::add(e, s, res);
+}
+    
+void MatOp_Fused::subtract(const Scalar& s, const MatExpr& e, MatExpr& res) const
+{
+    if( base == &g_MatOp_AddEx )
+    {
+        res = e;
+        res.alpha = -res.alpha;
+        res.beta = -res.beta;
+        res.s = s - res.s;
+    }
+    else
+        MatOp::subtract(s, e, res);
+}
+    
+void MatOp_Fused::multiply(const MatExpr& e, double s, MatExpr& res) const
+{
+    if( base == &g_MatOp_AddEx )
+    {
+        res = e;
+        res.alpha *= s;
+        res.beta *= s;
+        res.s *= s;
+    }
+    else if( base == &g_MatOp_Bin && (e.flags == '*' || e.flags == '/') )
+    {
+        res = e;
+        res.alpha *= s;
+    }
+    else
+        MatOp::multiply(e, s, res);
+}
+    
+void MatOp_Fused::abs(const MatExpr& e, MatExpr& res) const
+{
+    const Ptr<MatExpr>& ea = getFusedOperands(e).ea, &eb = getFusedOperands(e).eb;
+    bool hasB = e.b.data || !eb.empty();
+    if( base == &g_MatOp_AddEx && (!hasB || e.beta == 0) && fabs(e.alpha) == 1 )
+    {
+        MatExpr r = e;
+        r.flags = 'a';
+        r.b = Mat();
+        r.s = -e.s*e.alpha;
+        r.alpha = 1;
+        r.beta = 0;
+        makeExpr(r, &g_MatOp_Bin, ea, Ptr<MatExpr>());
+        res = r;
+    }
+    else if( base == &g_MatOp_AddEx && hasB && e.alpha + e.beta == 0 &&
+             e.alpha*e.beta == -1 && e.s == Scalar() )
+    {
+        MatExpr r = e;
+        r.flags = 'a';
+        r.alpha = r.beta = 1;
+        makeExpr(r, &g_MatOp_Bin, ea, eb);
+        res = r;
+    }
+    else
+        MatOp::abs(e, res);
+}
+    
+Size MatOp_Fused::size(const MatExpr& e) const
+{
+    const Ptr<MatExpr>& ea = getFusedOperands(e).ea;
+    return !ea.empty() ? ea->size() : e.a.size();
+}
+
+int MatOp_Fused::type(const MatExpr& e) const
+{
+    const Ptr<MatExpr>& ea = getFusedOperands(e).ea;
+    int atype = !ea.empty() ? ea->type() : e.a.type();
+    return base == &g_MatOp_Cmp ? CV_8UC(CV_MAT_CN(atype)) : atype;
+}
+    
+// turns the AddEx, Bin or Cmp expression into the fused one, if some of its operands are expressions
+inline void MatOp_Fused::makeExpr(MatExpr& res, const Ptr<MatExpr>& ea, const Ptr<MatExpr>& eb)
+{
+    if( ea.empty() && eb.empty() )
+        return;
+    const MatOp* base = isAddEx(res) ? (const MatOp*)&g_MatOp_AddEx :
+                        isCmp(res) ? (const MatOp*)&g_MatOp_Cmp : (const MatOp*)&g_MatOp_Bin;
+    if( !eb.empty() && base == &g_MatOp_Bin )
+        res.beta = 1;
+    makeExpr(res, base, ea, eb);
+}
+
+void MatOp_Fused::makeExpr(MatExpr& res, const MatOp* base, const Ptr<MatExpr>& ea, const Ptr<MatExpr>& eb)
+{
+    FusedOperands* operands = new FusedOperands(ea, eb);
+    Mat holder(1, (int)sizeof(*operands), CV_8U, operands);
+    holder.refcount = &operands->refcount;
+    holder.allocator = &g_FusedOperandsAllocator;
+    res.c = holder;
+    res.op = base == &g_MatOp_AddEx ? &g_MatOp_FusedAddEx :
+             base == &g_MatOp_Cmp ? &g_MatOp_FusedCmp : &g_MatOp_FusedBin;
+}
+
 /////////////////////////////////////////////////////////////////////////////////////////////////////////
     
 void MatOp_T::assign(const MatExpr& e, Mat& m, int type) const
@@ -178,6 +178,18 @@ static void finalizeHdr(Mat& m)
 }
     
     
+static MatAllocator* defaultMatAllocator = 0;
+
+void setDefaultMatAllocator(MatAllocator* allocator)
+{
+    defaultMatAllocator = allocator;
+}
+
+MatAllocator* getDefaultMatAllocator()
+{
+    return defaultMatAllocator;
+}
+
 void Mat::create(int d, const int* _sizes, int _type)
 {
     int i;
@@ -199,6 +211,11 @@ void Mat::create(int d, const int* _sizes, int _type)
     if( d == 0 )
         return;
     flags = (_type & CV_MAT_TYPE_MASK) | MAGIC_VAL;
+    if( !allocator && defaultMatAllocator )
+    {
+        allocator = defaultMatAllocator;
+        flags |= DEFAULT_ALLOCATOR_FLAG;
+    }
     setSize(*this, d, _sizes, 0, allocator == 0);
     
     if( total() > 0 )
@@ -1858,6 +1875,37 @@ reduceC_( const Mat& srcmat, Mat& dstmat )
 
 typedef void (*ReduceFunc)( const Mat& src, Mat& dst );
 
+/* the columns (dim=0) or the rows (dim=1) are reduced independently of each other,
+   so the stripes are processed in parallel without changing the result */
+class ReduceInvoker
+{
+public:
+    ReduceInvoker(const Mat& _src, Mat& _dst, int _dim, ReduceFunc _func)
+        : src(&_src), dst(&_dst), dim(_dim), func(_func) {}
+
+    void operator()(const BlockedRange& range) const
+    {
+        Mat srcStripe, dstStripe;
+        if( dim == 0 )
+        {
+            srcStripe = src->colRange(range.begin(), range.end());
+            dstStripe = dst->colRange(range.begin(), range.end());
+        }
+        else
+        {
+            srcStripe = src->rowRange(range.begin(), range.end());
+            dstStripe = dst->rowRange(range.begin(), range.end());
+        }
+        func( srcStripe, dstStripe );
+    }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    int dim;
+    ReduceFunc func;
+};
+
 }
     
 void cv::reduce(InputArray _src, OutputArray _dst, int dim, int op, int dtype)
@@ -1998,7 +2046,10 @@ void cv::reduce(InputArray _src, OutputArray _dst, int dim, int op, int dtype)
         CV_Error( CV_StsUnsupportedFormat,
         "Unsupported combination of input and output array formats" );
 
-    func( src, temp );
+    int len = dim == 0 ? src.cols : src.rows;
+    int work = (dim == 0 ? src.rows : src.cols)*cn;
+    int grain = std::max((1 << 16)/std::max(work, 1), dim == 0 ? 16 : 1);
+    parallel_for( BlockedRange(0, len, grain), ReduceInvoker(src, temp, dim, func) );
 
     if( op0 == CV_REDUCE_AVG )
         temp.convertTo(dst, dst.type(), 1./(dim == 0 ? src.rows : src.cols));
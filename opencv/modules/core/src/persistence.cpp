@@ -45,6 +45,12 @@
 #include <wchar.h>
 #include <zlib.h>
 
+#if defined WIN32 || defined _WIN32
+#include <io.h>
+#else
+#include <sys/mman.h>
+#endif
+
 /****************************************************************************************\
 *                            Common macros and type definitions                          *
 \****************************************************************************************/
@@ -205,10 +211,25 @@ typedef void (*CvWriteString)( struct CvFileStorage* fs, const char* key,
 typedef void (*CvWriteComment)( struct CvFileStorage* fs, const char* comment, int eol_comment );
 typedef void (*CvStartNextStream)( struct CvFileStorage* fs );
 
+/* the memory image of a binary file storage; shared by the storage and
+   by the matrices that are read from it without copying */
+typedef struct CvFileMapping
+{
+    int refcount; // must be the first field, it is used as Mat::refcount
+    uchar* data;
+    size_t size;
+    int is_mapped;
+#if defined WIN32 || defined _WIN32
+    HANDLE handle;
+#endif
+}
+CvFileMapping;
+
 typedef struct CvFileStorage
 {
     int flags;
     int is_xml;
+    int is_binary;
     int write_mode;
     int is_first;
     CvMemStorage* memstorage;
@@ -232,6 +253,14 @@ typedef struct CvFileStorage
     int dummy_eof;
     const char* errmsg;
     char errmsgbuf[128];
+    CvFileMapping* mapping;
+    int64 blob_pos;
+    size_t blob_count;
+    int blob_depth;
+    int streaming;
+    int defer_seqs;
+    int64 line_pos;
+    CvSeq* lazy_seqs;
 
     CvStartWriteStruct start_write_struct;
     CvEndWriteStruct end_write_struct;
@@ -253,9 +282,14 @@ static void icvPuts( CvFileStorage* fs, const char* str )
         gzputs( fs->gzfile, str );
 }
 
+static int64 icvTell( CvFileStorage* fs );
+
 static char* icvGets( CvFileStorage* fs, char* str, int maxCount )
 {
     CV_Assert( fs->file || fs->gzfile );
+    // in the streaming mode the parser needs to know where each line starts
+    if( fs->streaming )
+        fs->line_pos = icvTell( fs );
     if( fs->file )
         return fgets( str, maxCount, fs->file );
     return gzgets( fs->gzfile, str, maxCount );
@@ -288,10 +322,96 @@ static void icvRewind( CvFileStorage* fs )
         gzrewind(fs->gzfile);
 }
 
+static int64 icvFTell( FILE* f )
+{
+#if (defined _MSC_VER && _MSC_VER >= 1400) || defined __MINGW32__
+    int64 pos = _ftelli64( f );
+#else
+    // off_t is 64-bit, since the module is built with _FILE_OFFSET_BITS=64 (see CMakeLists.txt)
+    int64 pos = ftello( f );
+#endif
+    if( pos < 0 )
+        CV_Error( CV_StsError, "Can not get the current position in the file" );
+    return pos;
+}
+
+static void icvFSeek( FILE* f, int64 pos, int origin )
+{
+#if (defined _MSC_VER && _MSC_VER >= 1400) || defined __MINGW32__
+    int code = _fseeki64( f, pos, origin );
+#else
+    int code = fseeko( f, (off_t)pos, origin );
+#endif
+    if( code != 0 )
+        CV_Error( CV_StsError, "Can not set the position in the file" );
+}
+
+static int64 icvTell( CvFileStorage* fs )
+{
+    CV_Assert( fs->file || fs->gzfile );
+    if( fs->file )
+        return icvFTell( fs->file );
+    return gztell( fs->gzfile );
+}
+
+static void icvSeek( CvFileStorage* fs, int64 pos )
+{
+    CV_Assert( fs->file || fs->gzfile );
+    if( fs->file )
+        icvFSeek( fs->file, pos, SEEK_SET );
+    else
+        gzseek( fs->gzfile, (z_off_t)pos, SEEK_SET );
+}
+
 #define CV_YML_INDENT  3
 #define CV_XML_INDENT  2
 #define CV_YML_INDENT_FLOW  1
 #define CV_FS_MAX_LEN 4096
+#define CV_FS_MAX_NESTING 1024
+
+/* numerical sequences read from a binary storage (e.g. matrix data) are not
+   converted to file nodes; they reference the raw elements in the file mapping.
+   When the elements are accessed as file nodes, they are converted once into
+   the separate sequence of nodes, and the blob itself is kept intact */
+typedef struct CvFileBlobSeq
+{
+    CV_SEQUENCE_FIELDS()
+    CvSeq* nodes;           // the elements converted to file nodes, or NULL
+}
+CvFileBlobSeq;
+
+#define CV_FS_IS_BLOB_SEQ(seq) \
+    (!CV_IS_SET(seq) && (seq)->elem_size != (int)sizeof(CvFileNode))
+
+/* in the streaming mode the top-level YAML block sequences are not parsed when
+   the file is opened, only their elements are counted. The elements are parsed
+   one at a time on request into a separate storage that is cleared each time.
+   The sequence itself is kept empty (total == 0, first == 0), so the C functions
+   that access it directly, like cvGetSeqElem() or cvStartReadSeq(), see no elements */
+typedef struct CvFileLazySeq
+{
+    CV_SEQUENCE_FIELDS()
+    int count;              // the number of elements in the file
+    int64 first_pos;        // position of the line where the first element starts
+    int64 next_pos;         // position of the line where the element #next_idx starts
+    int first_lineno;
+    int next_lineno;
+    int next_idx;           // index of the element that will be parsed next
+    int indent;             // column of '-' that precedes each element
+    CvFileNode* elem;       // the last parsed element, i.e. #next_idx-1
+    CvMemStorage* elem_storage; // storage of the last parsed element
+    struct CvFileStorage* fs;
+}
+CvFileLazySeq;
+
+#define CV_FS_IS_LAZY_SEQ(seq) \
+    (!CV_IS_SET(seq) && (seq)->header_size == (int)sizeof(CvFileLazySeq))
+
+/* the number of elements in the collection, including the not yet parsed ones */
+static inline int icvFSCollectionSize( const CvSeq* seq )
+{
+    return CV_FS_IS_LAZY_SEQ(seq) ? ((const CvFileLazySeq*)seq)->count : seq->total;
+}
 
 #define CV_FILE_STORAGE ('Y' + ('A' << 8) + ('M' << 16) + ('L' << 24))
 #define CV_IS_FILE_STORAGE(fs) ((fs) != 0 && (fs)->flags == CV_FILE_STORAGE)
@@ -477,6 +597,9 @@ icvFSFlush( CvFileStorage* fs )
 }
 
 
+static void icvBinCloseBlob( CvFileStorage* fs );
+static void icvReleaseFileMapping( CvFileMapping* mapping );
+
 /* closes file storage and deallocates buffers */
 CV_IMPL  void
 cvReleaseFileStorage( CvFileStorage** p_fs )
@@ -496,15 +619,29 @@ cvReleaseFileStorage( CvFileStorage** p_fs )
                 while( fs->write_stack->total > 0 )
                     cvEndWriteStruct(fs);
             }
-            icvFSFlush(fs);
-            if( fs->is_xml )
-                icvPuts( fs, "</opencv_storage>\n" );
+            if( fs->is_binary )
+                icvBinCloseBlob(fs);
+            else
+            {
+                icvFSFlush(fs);
+                if( fs->is_xml )
+                    icvPuts( fs, "</opencv_storage>\n" );
+            }
         }
 
         //icvFSReleaseCollection( fs->roots ); // delete all the user types recursively
 
         icvClose(fs);
+        icvReleaseFileMapping( fs->mapping );
 
+        if( fs->lazy_seqs )
+        {
+            for( int i = 0; i < fs->lazy_seqs->total; i++ )
+            {
+                CvFileLazySeq* seq = *(CvFileLazySeq**)cvGetSeqElem( fs->lazy_seqs, i );
+                cvReleaseMemStorage( &seq->elem_storage );
+            }
+        }
         cvReleaseMemStorage( &fs->strstorage );
 
         cvFree( &fs->buffer_start );
@@ -601,7 +738,7 @@ cvGetFileNode( CvFileStorage* fs, CvFileNode* _map_node,
 
         if( !CV_NODE_IS_MAP(map_node->tag) )
         {
-            if( (!CV_NODE_IS_SEQ(map_node->tag) || map_node->data.seq->total != 0) &&
+            if( (!CV_NODE_IS_SEQ(map_node->tag) || icvFSCollectionSize(map_node->data.seq) != 0) &&
                 CV_NODE_TYPE(map_node->tag) != CV_NODE_NONE )
                 CV_Error( CV_StsError, "The node is neither a map nor an empty collection" );
             return 0;
@@ -680,7 +817,7 @@ cvGetFileNodeByName( const CvFileStorage* fs, const CvFileNode* _map_node, const
 
         if( !CV_NODE_IS_MAP(map_node->tag) )
         {
-            if( (!CV_NODE_IS_SEQ(map_node->tag) || map_node->data.seq->total != 0) &&
+            if( (!CV_NODE_IS_SEQ(map_node->tag) || icvFSCollectionSize(map_node->data.seq) != 0) &&
                 CV_NODE_TYPE(map_node->tag) != CV_NODE_NONE )
                 CV_Error( CV_StsError, "The node is neither a map nor an empty collection" );
             return 0;
@@ -971,6 +1108,69 @@ icvYMLParseKey( CvFileStorage* fs, char* ptr,
 }
 
 
+/* counts the elements of a top-level block sequence and skips it;
+   the elements are parsed later by icvFSGetLazyElem() */
+static char*
+icvYMLDeferSeq( CvFileStorage* fs, char* ptr, CvFileNode* node )
+{
+    CvFileLazySeq* seq = (CvFileLazySeq*)cvCreateSeq( 0, sizeof(CvFileLazySeq),
+                                            sizeof(CvFileNode), fs->memstorage );
+    int indent = (int)(ptr - fs->buffer_start);
+    int count = 1;
+
+    seq->first_pos = seq->next_pos = fs->line_pos;
+    seq->first_lineno = seq->next_lineno = fs->lineno;
+    seq->next_idx = 0;
+    seq->indent = indent;
+    seq->elem = 0;
+    seq->elem_storage = 0;
+    seq->fs = fs;
+
+    for(;;)
+    {
+        int max_size = (int)(fs->buffer_end - fs->buffer_start);
+        ptr = icvGets( fs, fs->buffer_start, max_size );
+        if( !ptr )
+        {
+            // emulate end of stream
+            ptr = fs->buffer_start;
+            ptr[0] = ptr[1] = ptr[2] = '.';
+            ptr[3] = '\0';
+            fs->dummy_eof = 1;
+            break;
+        }
+        else
+        {
+            int l = (int)strlen(ptr);
+            if( ptr[l-1] != '\n' && ptr[l-1] != '\r' && !icvEof(fs) )
+                CV_PARSE_ERROR( "Too long string or a last string w/o newline" );
+        }
+        fs->lineno++;
+
+        while( *ptr == ' ' )
+            ptr++;
+        if( *ptr == '\0' || *ptr == '\n' || *ptr == '\r' || *ptr == '#' ||
+            ptr - fs->buffer_start > indent )
+            continue;
+        if( ptr - fs->buffer_start < indent || *ptr != '-' ||
+            (indent == 0 && memcmp( ptr, "---", 3 ) == 0) )
+            break;
+        if( ++count == INT_MAX )
+            CV_PARSE_ERROR( "Too many elements in the sequence" );
+    }
+
+    seq->count = count;
+    node->tag = CV_NODE_SEQ;
+    node->data.seq = (CvSeq*)seq;
+
+    if( !fs->lazy_seqs )
+        fs->lazy_seqs = cvCreateSeq( 0, sizeof(CvSeq), sizeof(seq), fs->memstorage );
+    cvSeqPush( fs->lazy_seqs, &seq );
+
+    return ptr;
+}
+
+
 static char*
 icvYMLParseValue( CvFileStorage* fs, char* ptr, CvFileNode* node,
                   int parent_flags, int min_indent )
@@ -1230,7 +1430,13 @@ force_string:
             struct_flags = CV_NODE_MAP;
         }
         else
+        {
             struct_flags = CV_NODE_SEQ;
+            // a top-level sequence or a sequence stored in the top-level map
+            if( fs->defer_seqs && !node->info &&
+                (min_indent == 0 || (min_indent == 1 && CV_NODE_IS_MAP(parent_flags))) )
+                return icvYMLDeferSeq( fs, ptr, node );
+        }
 
         icvFSCreateCollection( fs, struct_flags +
                     (node->info ? CV_NODE_USER : 0), node );
@@ -1349,6 +1555,107 @@ icvYMLParse( CvFileStorage* fs )
 }
 
 
+/* reads the line where one of the elements of the deferred sequence starts */
+static char*
+icvYMLSeekLazySeq( CvFileStorage* fs, CvFileLazySeq* seq, int64 pos, int lineno )
+{
+    int max_size = (int)(fs->buffer_end - fs->buffer_start);
+    char* ptr;
+
+    if( !fs->buffer_start || (!fs->file && !fs->gzfile) )
+        CV_Error( CV_StsError, "The file storage has been closed" );
+
+    icvSeek( fs, pos );
+    ptr = icvGets( fs, fs->buffer_start, max_size );
+    fs->lineno = lineno;
+    if( !ptr || (int)strlen(ptr) <= seq->indent || ptr[seq->indent] != '-' )
+        CV_PARSE_ERROR( "The file has been modified after it was opened" );
+    return ptr + seq->indent;
+}
+
+
+/* parses the specified element of the deferred sequence; the previously parsed element
+   of the sequence is released, unless it is the requested one */
+static CvFileNode*
+icvFSGetLazyElem( const CvFileNode* node, int index )
+{
+    CvFileLazySeq* seq = (CvFileLazySeq*)node->data.seq;
+    CvFileStorage* fs = seq->fs;
+    CvMemStorage* memstorage = fs->memstorage;
+
+    if( (unsigned)index >= (unsigned)seq->count )
+        return 0;
+    if( seq->elem && index == seq->next_idx - 1 )
+        return seq->elem;
+
+    if( index < seq->next_idx )
+    {
+        // rewind to the beginning of the sequence
+        seq->next_idx = 0;
+        seq->next_pos = seq->first_pos;
+        seq->next_lineno = seq->first_lineno;
+    }
+
+    if( !seq->elem_storage )
+        seq->elem_storage = cvCreateChildMemStorage( fs->memstorage );
+
+    // the node contents (nested collections and strings) go to the element storage
+    fs->memstorage = seq->elem_storage;
+    try
+    {
+        while( seq->next_idx <= index )
+        {
+            char* ptr;
+            cvClearMemStorage( seq->elem_storage );
+            seq->elem = 0;
+
+            ptr = icvYMLSeekLazySeq( fs, seq, seq->next_pos, seq->next_lineno );
+            CvFileNode* elem = (CvFileNode*)cvMemStorageAlloc( seq->elem_storage, sizeof(*elem) );
+            ptr = icvYMLSkipSpaces( fs, ptr + 1, seq->indent + 1, INT_MAX );
+            ptr = icvYMLParseValue( fs, ptr, elem, CV_NODE_SEQ, seq->indent + 1 );
+
+            if( ++seq->next_idx < seq->count )
+            {
+                // find the line where the next element starts
+                ptr = icvYMLSkipSpaces( fs, ptr, 0, INT_MAX );
+                if( ptr - fs->buffer_start != seq->indent || *ptr != '-' )
+                    CV_PARSE_ERROR( "The file has been modified after it was opened" );
+                seq->next_pos = fs->line_pos;
+                seq->next_lineno = fs->lineno;
+            }
+            seq->elem = elem;
+        }
+    }
+    catch(...)
+    {
+        fs->memstorage = memstorage;
+        throw;
+    }
+    fs->memstorage = memstorage;
+
+    return seq->elem;
+}
+
+
+/* replaces the deferred sequence with the completely parsed one */
+static void
+icvFSLoadLazySeq( const CvFileNode* _node )
+{
+    CvFileNode* node = (CvFileNode*)_node;
+    CvFileLazySeq* seq;
+    CvFileStorage* fs;
+    char* ptr;
+
+    if( !node || !CV_NODE_IS_SEQ(node->tag) || !CV_FS_IS_LAZY_SEQ(node->data.seq) )
+        return;
+
+    seq = (CvFileLazySeq*)node->data.seq;
+    fs = seq->fs;
+    ptr = icvYMLSeekLazySeq( fs, seq, seq->first_pos, seq->first_lineno );
+    icvYMLParseValue( fs, ptr, node, CV_NODE_NONE, seq->indent );
+}
+
+
 /****************************************************************************************\
 *                                       YAML Emitter                                     *
 \****************************************************************************************/
@@ -2446,144 +2753,814 @@ icvXMLWriteString( CvFileStorage* fs, const char* key, const char* str, int quot
     if( !str )
         CV_Error( CV_StsNullPtr, "Null string pointer" );
 
-    len = (int)strlen(str);
-    if( len > CV_FS_MAX_LEN )
-        CV_Error( CV_StsBadArg, "The written string is too long" );
+    len = (int)strlen(str);
+    if( len > CV_FS_MAX_LEN )
+        CV_Error( CV_StsBadArg, "The written string is too long" );
+
+    if( quote || len == 0 || str[0] != '\"' || str[0] != str[len-1] )
+    {
+        int need_quote = quote || len == 0;
+        data = buf;
+        *data++ = '\"';
+        for( i = 0; i < len; i++ )
+        {
+            char c = str[i];
+
+            if( (uchar)c >= 128 || c == ' ' )
+            {
+                *data++ = c;
+                need_quote = 1;
+            }
+            else if( !cv_isprint(c) || c == '<' || c == '>' || c == '&' || c == '\'' || c == '\"' )
+            {
+                *data++ = '&';
+                if( c == '<' )
+                {
+                    memcpy(data, "lt", 2);
+                    data += 2;
+                }
+                else if( c == '>' )
+                {
+                    memcpy(data, "gt", 2);
+                    data += 2;
+                }
+                else if( c == '&' )
+                {
+                    memcpy(data, "amp", 3);
+                    data += 3;
+                }
+                else if( c == '\'' )
+                {
+                    memcpy(data, "apos", 4);
+                    data += 4;
+                }
+                else if( c == '\"' )
+                {
+                    memcpy( data, "quot", 4);
+                    data += 4;
+                }
+                else
+                {
+                    sprintf( data, "#x%02x", (uchar)c );
+                    data += 4;
+                }
+                *data++ = ';';
+                need_quote = 1;
+            }
+            else
+                *data++ = c;
+        }
+        if( !need_quote && (cv_isdigit(str[0]) ||
+            str[0] == '+' || str[0] == '-' || str[0] == '.' ))
+            need_quote = 1;
+
+        if( need_quote )
+            *data++ = '\"';
+        len = (int)(data - buf) - !need_quote;
+        *data++ = '\0';
+        data = buf + !need_quote;
+    }
+
+    icvXMLWriteScalar( fs, key, data, len );
+}
+
+
+static void
+icvXMLWriteComment( CvFileStorage* fs, const char* comment, int eol_comment )
+{
+    int len;
+    int multiline;
+    const char* eol;
+    char* ptr;
+
+    if( !comment )
+        CV_Error( CV_StsNullPtr, "Null comment" );
+
+    if( strstr(comment, "--") != 0 )
+        CV_Error( CV_StsBadArg, "Double hyphen \'--\' is not allowed in the comments" );
+
+    len = (int)strlen(comment);
+    eol = strchr(comment, '\n');
+    multiline = eol != 0;
+    ptr = fs->buffer;
+
+    if( multiline || !eol_comment || fs->buffer_end - ptr < len + 5 )
+        ptr = icvXMLFlush( fs );
+    else if( ptr > fs->buffer_start + fs->struct_indent )
+        *ptr++ = ' ';
+
+    if( !multiline )
+    {
+        ptr = icvFSResizeWriteBuffer( fs, ptr, len + 9 );
+        sprintf( ptr, "<!-- %s -->", comment );
+        len = (int)strlen(ptr);
+    }
+    else
+    {
+        strcpy( ptr, "<!--" );
+        len = 4;
+    }
+
+    fs->buffer = ptr + len;
+    ptr = icvXMLFlush(fs);
+
+    if( multiline )
+    {
+        while( comment )
+        {
+            if( eol )
+            {
+                ptr = icvFSResizeWriteBuffer( fs, ptr, (int)(eol - comment) + 1 );
+                memcpy( ptr, comment, eol - comment + 1 );
+                ptr += eol - comment;
+                comment = eol + 1;
+                eol = strchr( comment, '\n' );
+            }
+            else
+            {
+                len = (int)strlen(comment);
+                ptr = icvFSResizeWriteBuffer( fs, ptr, len );
+                memcpy( ptr, comment, len );
+                ptr += len;
+                comment = 0;
+            }
+            fs->buffer = ptr;
+            ptr = icvXMLFlush( fs );
+        }
+        sprintf( ptr, "-->" );
+        fs->buffer = ptr + 3;
+        icvXMLFlush( fs );
+    }
+}
+
+
+/****************************************************************************************\
+*                                Binary Parser & Emitter                                 *
+\****************************************************************************************/
+
+/*
+   The binary storage is a flat stream of records in the native byte order:
+
+   header:  "%OCVBIN:1.0\n" and the 32-bit byte order mark CV_FS_BIN_BOM;
+   record:  <code:uint8> [<key length:uint32> <key>] <payload>,
+            the key is present iff CV_FS_BIN_NAMED bit is set in the code;
+   payload: INT       - int32
+            REAL      - float64
+            STR       - <length:uint32> <characters>
+            SEQ, MAP  - <type name length:uint32> <type name>, the elements, END
+            BLOB      - <depth:uint8> <count:uint64>, zero padding up to the
+                        next multiple of CV_FS_BIN_ALIGN file offset, the elements
+            STREAM    - the next stream starts
+
+   The numbers written with cvWriteRawData are stored as BLOBs, so that the matrix
+   data can be used right from the mapped file without any conversion.
+*/
+
+static const char icvBinSignature[] = "%OCVBIN:1.0\n";
+
+enum
+{
+    CV_FS_BIN_END = 0,
+    CV_FS_BIN_INT = CV_NODE_INT,
+    CV_FS_BIN_REAL = CV_NODE_REAL,
+    CV_FS_BIN_STR = CV_NODE_STR,
+    CV_FS_BIN_SEQ = CV_NODE_SEQ,
+    CV_FS_BIN_MAP = CV_NODE_MAP,
+    CV_FS_BIN_BLOB = 16,
+    CV_FS_BIN_STREAM = 17,
+    CV_FS_BIN_NAMED = 128,
+    CV_FS_BIN_BOM = 0x01020304,
+    CV_FS_BIN_HEADER_SIZE = 16,
+    CV_FS_BIN_ALIGN = 16
+};
+
+static void
+icvBinPut( CvFileStorage* fs, const void* data, size_t len )
+{
+    if( len > 0 && fwrite( data, 1, len, fs->file ) != len )
+        CV_Error( CV_StsError, "Could not write to the binary file storage" );
+}
+
+static void
+icvBinPutString( CvFileStorage* fs, const char* str, size_t len )
+{
+    unsigned ulen = (unsigned)len;
+    icvBinPut( fs, &ulen, sizeof(ulen) );
+    icvBinPut( fs, str, len );
+}
+
+static void
+icvBinCloseBlob( CvFileStorage* fs )
+{
+    if( fs->blob_pos > 0 )
+    {
+        int64 pos = icvTell( fs );
+        uint64 count = fs->blob_count;
+        icvSeek( fs, fs->blob_pos );
+        icvBinPut( fs, &count, sizeof(count) );
+        icvSeek( fs, pos );
+        fs->blob_pos = 0;
+        fs->blob_count = 0;
+    }
+}
+
+static void
+icvBinStartRecord( CvFileStorage* fs, const char* key, int code )
+{
+    int struct_flags = fs->struct_flags;
+
+    icvBinCloseBlob( fs );
+
+    if( key && key[0] == '\0' )
+        key = 0;
+
+    if( CV_NODE_IS_COLLECTION(struct_flags) )
+    {
+        if( (CV_NODE_IS_MAP(struct_flags) ^ (key != 0)) )
+            CV_Error( CV_StsBadArg, "An attempt to add element without a key to a map, "
+                                    "or add element with key to sequence" );
+    }
+    else
+    {
+        fs->is_first = 0;
+        struct_flags = CV_NODE_EMPTY | (key ? CV_NODE_MAP : CV_NODE_SEQ);
+    }
+
+    uchar c = (uchar)(code | (key ? CV_FS_BIN_NAMED : 0));
+    icvBinPut( fs, &c, 1 );
+
+    if( key )
+    {
+        size_t keylen = strlen(key);
+        if( keylen > CV_FS_MAX_LEN )
+            CV_Error( CV_StsBadArg, "The key is too long" );
+        icvBinPutString( fs, key, keylen );
+    }
+
+    fs->struct_flags = struct_flags & ~CV_NODE_EMPTY;
+}
+
+
+static void
+icvBinStartWriteStruct( CvFileStorage* fs, const char* key, int struct_flags,
+                        const char* type_name CV_DEFAULT(0))
+{
+    int parent_flags;
+
+    struct_flags = (struct_flags & (CV_NODE_TYPE_MASK|CV_NODE_FLOW)) | CV_NODE_EMPTY;
+    if( !CV_NODE_IS_COLLECTION(struct_flags))
+        CV_Error( CV_StsBadArg,
+        "Some collection type - CV_NODE_SEQ or CV_NODE_MAP, must be specified" );
+
+    icvBinStartRecord( fs, key, CV_NODE_IS_MAP(struct_flags) ? CV_FS_BIN_MAP : CV_FS_BIN_SEQ );
+    icvBinPutString( fs, type_name, type_name ? strlen(type_name) : 0 );
+
+    parent_flags = fs->struct_flags;
+    cvSeqPush( fs->write_stack, &parent_flags );
+    fs->struct_flags = struct_flags;
+}
+
+
+static void
+icvBinEndWriteStruct( CvFileStorage* fs )
+{
+    int parent_flags = 0;
+    uchar c = CV_FS_BIN_END;
+
+    icvBinCloseBlob( fs );
+    if( fs->write_stack->total == 0 )
+        CV_Error( CV_StsError, "EndWriteStruct w/o matching StartWriteStruct" );
+
+    cvSeqPop( fs->write_stack, &parent_flags );
+    icvBinPut( fs, &c, 1 );
+    fs->struct_flags = parent_flags;
+}
+
+
+static void
+icvBinStartNextStream( CvFileStorage* fs )
+{
+    if( !fs->is_first )
+    {
+        uchar c = CV_FS_BIN_STREAM;
+        while( fs->write_stack->total > 0 )
+            icvBinEndWriteStruct(fs);
+        icvBinCloseBlob( fs );
+        icvBinPut( fs, &c, 1 );
+        fs->struct_flags = CV_NODE_EMPTY;
+        fs->is_first = 1;
+    }
+}
+
+
+static void
+icvBinWriteInt( CvFileStorage* fs, const char* key, int value )
+{
+    icvBinStartRecord( fs, key, CV_FS_BIN_INT );
+    icvBinPut( fs, &value, sizeof(value) );
+}
+
+
+static void
+icvBinWriteReal( CvFileStorage* fs, const char* key, double value )
+{
+    icvBinStartRecord( fs, key, CV_FS_BIN_REAL );
+    icvBinPut( fs, &value, sizeof(value) );
+}
+
+
+static void
+icvBinWriteString( CvFileStorage* fs, const char* key, const char* str, int /*quote*/ )
+{
+    if( !str )
+        CV_Error( CV_StsNullPtr, "Null string pointer" );
+
+    size_t len = strlen(str);
+    if( len > CV_FS_MAX_LEN )
+        CV_Error( CV_StsBadArg, "The written string is too long" );
+
+    icvBinStartRecord( fs, key, CV_FS_BIN_STR );
+    icvBinPutString( fs, str, len );
+}
+
+
+static void
+icvBinWriteComment( CvFileStorage*, const char*, int )
+{
+    // comments are not stored in binary storages
+}
+
+
+/* appends count elements of the specified depth to the current blob,
+   or starts a new blob if the previous record was not a blob of the same depth */
+static void
+icvBinWriteBlob( CvFileStorage* fs, const void* data, size_t count, int depth )
+{
+    if( fs->blob_pos == 0 || fs->blob_depth != depth )
+    {
+        uchar d = (uchar)depth, pad[CV_FS_BIN_ALIGN] = {0};
+        uint64 zero = 0;
+
+        icvBinStartRecord( fs, 0, CV_FS_BIN_BLOB );
+        icvBinPut( fs, &d, 1 );
+        fs->blob_pos = icvTell( fs );
+        icvBinPut( fs, &zero, sizeof(zero) );
+        int64 pos = fs->blob_pos + (int64)sizeof(zero);
+        icvBinPut( fs, pad, (size_t)((CV_FS_BIN_ALIGN - pos % CV_FS_BIN_ALIGN) % CV_FS_BIN_ALIGN) );
+        fs->blob_depth = depth;
+    }
+
+    icvBinPut( fs, data, count*CV_ELEM_SIZE(depth) );
+    fs->blob_count += count;
+}
+
+
+/* writes a single element of a complex raw data record */
+static void
+icvBinWriteRawScalar( CvFileStorage* fs, const char* data, int depth )
+{
+    switch( depth )
+    {
+    case CV_8U:
+        icvBinWriteInt( fs, 0, *(uchar*)data );
+        break;
+    case CV_8S:
+        icvBinWriteInt( fs, 0, *(schar*)data );
+        break;
+    case CV_16U:
+        icvBinWriteInt( fs, 0, *(ushort*)data );
+        break;
+    case CV_16S:
+        icvBinWriteInt( fs, 0, *(short*)data );
+        break;
+    case CV_32S:
+        icvBinWriteInt( fs, 0, *(int*)data );
+        break;
+    case CV_32F:
+        icvBinWriteReal( fs, 0, *(float*)data );
+        break;
+    case CV_64F:
+        icvBinWriteReal( fs, 0, *(double*)data );
+        break;
+    case CV_USRTYPE1: /* reference */
+        icvBinWriteInt( fs, 0, (int)*(size_t*)data );
+        break;
+    default:
+        assert(0);
+    }
+}
+
+
+/* converts an element of a blob to the equivalent scalar file node */
+static void
+icvBinBlobElemToNode( const uchar* data, int depth, CvFileNode* node )
+{
+    memset( node, 0, sizeof(*node) );
+    node->tag = depth < CV_32F ? CV_NODE_INT : CV_NODE_REAL;
+    switch( depth )
+    {
+    case CV_8U:
+        node->data.i = *data;
+        break;
+    case CV_8S:
+        node->data.i = *(const schar*)data;
+        break;
+    case CV_16U:
+        node->data.i = *(const ushort*)data;
+        break;
+    case CV_16S:
+        node->data.i = *(const short*)data;
+        break;
+    case CV_32S:
+        node->data.i = *(const int*)data;
+        break;
+    case CV_32F:
+        node->data.f = *(const float*)data;
+        break;
+    default:
+        node->data.f = *(const double*)data;
+    }
+}
+
+
+/* replaces the blob sequence with the regular sequence of scalar file nodes */
+// serializes the conversion of the blobs, so that a storage can be read from several threads
+static cv::Mutex icvFSBlobMutex;
+
+/* returns the elements of the blob sequence as file nodes, converting them on the first call */
+static const CvSeq*
+icvFSGetBlobNodes( const CvFileStorage* fs, const CvSeq* _blob )
+{
+    CvFileBlobSeq* blob = (CvFileBlobSeq*)_blob;
+    cv::AutoLock lock( icvFSBlobMutex );
+
+    if( !blob->nodes )
+    {
+        int i, depth = CV_MAT_DEPTH(blob->flags);
+        const uchar* data = blob->first ? (const uchar*)blob->first->data : 0;
+        CvSeq* seq = cvCreateSeq( 0, sizeof(CvSeq), sizeof(CvFileNode), fs->memstorage );
+
+        for( i = 0; i < blob->total; i++, data += blob->elem_size )
+            icvBinBlobElemToNode( data, depth, (CvFileNode*)cvSeqPush( seq, 0 ));
+
+        seq->flags |= CV_NODE_SEQ_SIMPLE;
+        blob->nodes = seq;
+    }
+    return blob->nodes;
+}
+
+
+static void
+icvBinParseError( CvFileStorage* fs, const uchar* ptr, const char* err_msg )
+{
+    // report the byte offset instead of the line number
+    fs->lineno = (int)(ptr - fs->mapping->data);
+    CV_PARSE_ERROR( err_msg );
+}
+
+
+static const uchar*
+icvBinGet( CvFileStorage* fs, const uchar* ptr, void* dst, size_t len )
+{
+    if( (size_t)(fs->mapping->data + fs->mapping->size - ptr) < len )
+        icvBinParseError( fs, ptr, "Unexpected end of file" );
+    memcpy( dst, ptr, len );
+    return ptr + len;
+}
+
+
+static const uchar*
+icvBinGetString( CvFileStorage* fs, const uchar* ptr, const char** str, int* len )
+{
+    unsigned ulen = 0;
+    ptr = icvBinGet( fs, ptr, &ulen, sizeof(ulen) );
+    if( ulen > CV_FS_MAX_LEN || (size_t)(fs->mapping->data + fs->mapping->size - ptr) < ulen )
+        icvBinParseError( fs, ptr, "Invalid string length" );
+    *str = (const char*)ptr;
+    *len = (int)ulen;
+    return ptr + ulen;
+}
+
+
+/* parses the blob header and returns the pointer right after the blob elements */
+static const uchar*
+icvBinGetBlob( CvFileStorage* fs, const uchar* ptr, const uchar** data,
+               size_t* count, int* depth )
+{
+    uchar d = 0;
+    uint64 n = 0;
+    const uchar* end = fs->mapping->data + fs->mapping->size;
+
+    ptr = icvBinGet( fs, ptr, &d, 1 );
+    if( d > CV_64F )
+        icvBinParseError( fs, ptr, "Invalid blob element type" );
+    ptr = icvBinGet( fs, ptr, &n, sizeof(n) );
+    ptr = fs->mapping->data + cv::alignSize( (size_t)(ptr - fs->mapping->data), CV_FS_BIN_ALIGN );
+
+    size_t elem_size = CV_ELEM_SIZE(d);
+    if( ptr > end || n > (uint64)((end - ptr)/elem_size) )
+        icvBinParseError( fs, ptr, "Unexpected end of file" );
+
+    *data = ptr;
+    *count = (size_t)n;
+    *depth = d;
+    return ptr + n*elem_size;
+}
+
+
+static void
+icvBinSetBlobSeq( CvFileStorage* fs, CvFileNode* node, const uchar* data,
+                  size_t count, int depth )
+{
+    int elem_size = CV_ELEM_SIZE(depth);
+    CvSeq* seq;
+
+    if( count > (size_t)INT_MAX )
+        icvBinParseError( fs, data, "Too long sequence" );
+
+    seq = cvCreateSeq( depth, sizeof(CvFileBlobSeq), elem_size, fs->memstorage );
+    ((CvFileBlobSeq*)seq)->nodes = 0;
+    if( count > 0 )
+    {
+        CvSeqBlock* block = (CvSeqBlock*)cvMemStorageAlloc( fs->memstorage, sizeof(*block) );
+        block->prev = block->next = block;
+        block->start_index = 0;
+        block->count = (int)count;
+        block->data = (schar*)data;
+        seq->first = block;
+        seq->total = (int)count;
+        seq->ptr = seq->block_max = block->data + count*elem_size;
+    }
+    seq->flags |= CV_NODE_SEQ_SIMPLE;
+    node->data.seq = seq;
+}
+
+
+static const uchar*
+icvBinParseCollection( CvFileStorage* fs, const uchar* ptr, CvFileNode* node,
+                       int type, int keep_blob, int level );
+
+static const uchar*
+icvBinParseElem( CvFileStorage* fs, const uchar* ptr, CvFileNode* container,
+                 int code, int* is_simple, int level )
+{
+    CvFileNode* elem;
+    const char* key = 0;
+    int keylen = 0;
+
+    if( code & CV_FS_BIN_NAMED )
+    {
+        ptr = icvBinGetString( fs, ptr, &key, &keylen );
+        if( keylen == 0 )
+            icvBinParseError( fs, ptr, "Empty key" );
+        if( !CV_NODE_IS_COLLECTION(container->tag) )
+            icvFSCreateCollection( fs, CV_NODE_MAP, container );
+        else if( !CV_NODE_IS_MAP(container->tag) )
+            icvBinParseError( fs, ptr, "Sequence element should not have name" );
+        code &= ~CV_FS_BIN_NAMED;
+    }
+    else
+    {
+        if( !CV_NODE_IS_COLLECTION(container->tag) )
+            icvFSCreateCollection( fs, CV_NODE_SEQ, container );
+        else if( !CV_NODE_IS_SEQ(container->tag) )
+            icvBinParseError( fs, ptr, "Map element should have a name" );
+    }
+
+    if( code == CV_FS_BIN_BLOB )
+    {
+        const uchar* data = 0;
+        size_t i, count = 0;
+        int depth = 0;
+
+        if( key )
+            icvBinParseError( fs, ptr, "Blob should not have name" );
+        ptr = icvBinGetBlob( fs, ptr, &data, &count, &depth );
+        for( i = 0; i < count; i++, data += CV_ELEM_SIZE(depth) )
+            icvBinBlobElemToNode( data, depth, (CvFileNode*)cvSeqPush( container->data.seq, 0 ));
+        return ptr;
+    }
+
+    if( key )
+    {
+        elem = cvGetFileNode( fs, container, cvGetHashedKey( fs, key, keylen, 1 ), 1 );
+        memset( elem, 0, sizeof(*elem) );
+        elem->tag = CV_NODE_NAMED;
+    }
+    else
+    {
+        elem = (CvFileNode*)cvSeqPush( container->data.seq, 0 );
+        memset( elem, 0, sizeof(*elem) );
+    }
+
+    switch( code )
+    {
+    case CV_FS_BIN_INT:
+        elem->tag |= CV_NODE_INT;
+        ptr = icvBinGet( fs, ptr, &elem->data.i, sizeof(int) );
+        break;
+    case CV_FS_BIN_REAL:
+        elem->tag |= CV_NODE_REAL;
+        ptr = icvBinGet( fs, ptr, &elem->data.f, sizeof(double) );
+        break;
+    case CV_FS_BIN_STR:
+        {
+        const char* str = 0;
+        int len = 0;
+        ptr = icvBinGetString( fs, ptr, &str, &len );
+        elem->tag |= CV_NODE_STRING;
+        elem->data.str = cvMemStorageAllocString( fs->memstorage, str, len );
+        }
+        break;
+    case CV_FS_BIN_SEQ:
+    case CV_FS_BIN_MAP:
+        {
+        // keep the matrix data in the mapped memory
+        int keep_blob = keylen == 4 && memcmp( key, "data", 4 ) == 0 &&
+            container->info && (strcmp( container->info->type_name, CV_TYPE_NAME_MAT ) == 0 ||
+                                strcmp( container->info->type_name, CV_TYPE_NAME_MATND ) == 0);
+        int tag = elem->tag;
+        elem->tag = CV_NODE_NONE;
+        ptr = icvBinParseCollection( fs, ptr, elem, code, keep_blob, level + 1 );
+        elem->tag |= tag;
+        *is_simple = 0;
+        }
+        break;
+    default:
+        icvBinParseError( fs, ptr, "Invalid record type" );
+    }
+
+    return ptr;
+}
+
+
+static const uchar*
+icvBinParseCollection( CvFileStorage* fs, const uchar* ptr, CvFileNode* node,
+                       int type, int keep_blob, int level )
+{
+    const char* type_name = 0;
+    int len = 0, is_simple = 1;
+    uchar code = 0;
+
+    if( level > CV_FS_MAX_NESTING )
+        icvBinParseError( fs, ptr, "Too deep nesting" );
+
+    ptr = icvBinGetString( fs, ptr, &type_name, &len );
+    if( len > 0 )
+    {
+        char buf[CV_FS_MAX_LEN + 1];
+        memcpy( buf, type_name, len );
+        buf[len] = '\0';
+        node->info = cvFindType( buf );
+    }
+
+    icvFSCreateCollection( fs, type | (node->info ? CV_NODE_USER : 0), node );
 
-    if( quote || len == 0 || str[0] != '\"' || str[0] != str[len-1] )
+    if( keep_blob && type == CV_FS_BIN_SEQ )
     {
-        int need_quote = quote || len == 0;
-        data = buf;
-        *data++ = '\"';
-        for( i = 0; i < len; i++ )
-        {
-            char c = str[i];
+        const uchar* data = 0, *end = fs->mapping->data + fs->mapping->size, *blob_end;
+        size_t count = 0;
+        int depth = 0;
 
-            if( (uchar)c >= 128 || c == ' ' )
-            {
-                *data++ = c;
-                need_quote = 1;
-            }
-            else if( !cv_isprint(c) || c == '<' || c == '>' || c == '&' || c == '\'' || c == '\"' )
+        if( ptr < end && *ptr == CV_FS_BIN_BLOB )
+        {
+            blob_end = icvBinGetBlob( fs, ptr + 1, &data, &count, &depth );
+            if( blob_end < end && *blob_end == CV_FS_BIN_END )
             {
-                *data++ = '&';
-                if( c == '<' )
-                {
-                    memcpy(data, "lt", 2);
-                    data += 2;
-                }
-                else if( c == '>' )
-                {
-                    memcpy(data, "gt", 2);
-                    data += 2;
-                }
-                else if( c == '&' )
-                {
-                    memcpy(data, "amp", 3);
-                    data += 3;
-                }
-                else if( c == '\'' )
-                {
-                    memcpy(data, "apos", 4);
-                    data += 4;
-                }
-                else if( c == '\"' )
-                {
-                    memcpy( data, "quot", 4);
-                    data += 4;
-                }
-                else
-                {
-                    sprintf( data, "#x%02x", (uchar)c );
-                    data += 4;
-                }
-                *data++ = ';';
-                need_quote = 1;
+                icvBinSetBlobSeq( fs, node, data, count, depth );
+                return blob_end + 1;
             }
-            else
-                *data++ = c;
         }
-        if( !need_quote && (cv_isdigit(str[0]) ||
-            str[0] == '+' || str[0] == '-' || str[0] == '.' ))
-            need_quote = 1;
+    }
 
-        if( need_quote )
-            *data++ = '\"';
-        len = (int)(data - buf) - !need_quote;
-        *data++ = '\0';
-        data = buf + !need_quote;
+    for(;;)
+    {
+        ptr = icvBinGet( fs, ptr, &code, 1 );
+        if( code == CV_FS_BIN_END )
+            break;
+        ptr = icvBinParseElem( fs, ptr, node, code, &is_simple, level );
     }
 
-    icvXMLWriteScalar( fs, key, data, len );
+    node->data.seq->flags |= is_simple ? CV_NODE_SEQ_SIMPLE : 0;
+    return ptr;
 }
 
 
 static void
-icvXMLWriteComment( CvFileStorage* fs, const char* comment, int eol_comment )
+icvBinParse( CvFileStorage* fs )
 {
-    int len;
-    int multiline;
-    const char* eol;
-    char* ptr;
+    const uchar* ptr = fs->mapping->data + CV_FS_BIN_HEADER_SIZE;
+    const uchar* end = fs->mapping->data + fs->mapping->size;
+    unsigned bom = 0;
 
-    if( !comment )
-        CV_Error( CV_StsNullPtr, "Null comment" );
+    if( fs->mapping->size < CV_FS_BIN_HEADER_SIZE )
+        icvBinParseError( fs, fs->mapping->data, "Unexpected end of file" );
+    memcpy( &bom, fs->mapping->data + sizeof(icvBinSignature) - 1, sizeof(bom) );
+    if( bom != CV_FS_BIN_BOM )
+        icvBinParseError( fs, fs->mapping->data, "The binary storage has been written "
+                          "on a platform with different byte order" );
 
-    if( strstr(comment, "--") != 0 )
-        CV_Error( CV_StsBadArg, "Double hyphen \'--\' is not allowed in the comments" );
+    CvFileNode* root = (CvFileNode*)cvSeqPush( fs->roots, 0 );
+    memset( root, 0, sizeof(*root) );
 
-    len = (int)strlen(comment);
-    eol = strchr(comment, '\n');
-    multiline = eol != 0;
-    ptr = fs->buffer;
+    while( ptr < end )
+    {
+        int is_simple = 1;
+        uchar code = *ptr++;
 
-    if( multiline || !eol_comment || fs->buffer_end - ptr < len + 5 )
-        ptr = icvXMLFlush( fs );
-    else if( ptr > fs->buffer_start + fs->struct_indent )
-        *ptr++ = ' ';
+        if( code == CV_FS_BIN_STREAM )
+        {
+            root = (CvFileNode*)cvSeqPush( fs->roots, 0 );
+            memset( root, 0, sizeof(*root) );
+        }
+        else
+            ptr = icvBinParseElem( fs, ptr, root, code, &is_simple, 0 );
+    }
+}
 
-    if( !multiline )
+
+static CvFileMapping*
+icvCreateFileMapping( size_t size )
+{
+    CvFileMapping* mapping = (CvFileMapping*)cvAlloc( sizeof(*mapping) );
+    memset( mapping, 0, sizeof(*mapping) );
+    mapping->refcount = 1;
+    mapping->size = size;
+    return mapping;
+}
+
+
+/* maps the file in the copy-on-write mode, so that the matrices that
+   reference the file data can be modified without affecting the file.
+   If the file can not be mapped, it is read into memory */
+static CvFileMapping*
+icvMapFile( FILE* f )
+{
+    icvFSeek( f, 0, SEEK_END );
+    int64 size = icvFTell( f );
+    if( size < CV_FS_BIN_HEADER_SIZE || (uint64)size != (size_t)size )
+        return 0;
+
+    CvFileMapping* mapping = icvCreateFileMapping( (size_t)size );
+
+#if defined WIN32 || defined _WIN32
+    mapping->handle = CreateFileMapping( (HANDLE)_get_osfhandle(_fileno(f)),
+                                         0, PAGE_WRITECOPY, 0, 0, 0 );
+    if( mapping->handle )
     {
-        ptr = icvFSResizeWriteBuffer( fs, ptr, len + 9 );
-        sprintf( ptr, "<!-- %s -->", comment );
-        len = (int)strlen(ptr);
+        mapping->data = (uchar*)MapViewOfFile( mapping->handle, FILE_MAP_COPY, 0, 0, 0 );
+        if( !mapping->data )
+        {
+            CloseHandle( mapping->handle );
+            mapping->handle = 0;
+        }
     }
+#else
+    void* ptr = mmap( 0, mapping->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fileno(f), 0 );
+    if( ptr != MAP_FAILED )
+        mapping->data = (uchar*)ptr;
+#endif
+
+    if( mapping->data )
+        mapping->is_mapped = 1;
     else
     {
-        strcpy( ptr, "<!--" );
-        len = 4;
+        mapping->data = (uchar*)cv::fastMalloc( mapping->size );
+        rewind( f );
+        if( fread( mapping->data, 1, mapping->size, f ) != mapping->size )
+        {
+            cv::fastFree( mapping->data );
+            cvFree( &mapping );
+        }
     }
 
-    fs->buffer = ptr + len;
-    ptr = icvXMLFlush(fs);
+    return mapping;
+}
 
-    if( multiline )
+
+static void
+icvFreeFileMapping( CvFileMapping* mapping )
+{
+    if( !mapping->is_mapped )
+        cv::fastFree( mapping->data );
+    else
     {
-        while( comment )
-        {
-            if( eol )
-            {
-                ptr = icvFSResizeWriteBuffer( fs, ptr, (int)(eol - comment) + 1 );
-                memcpy( ptr, comment, eol - comment + 1 );
-                ptr += eol - comment;
-                comment = eol + 1;
-                eol = strchr( comment, '\n' );
-            }
-            else
-            {
-                len = (int)strlen(comment);
-                ptr = icvFSResizeWriteBuffer( fs, ptr, len );
-                memcpy( ptr, comment, len );
-                ptr += len;
-                comment = 0;
-            }
-            fs->buffer = ptr;
-            ptr = icvXMLFlush( fs );
-        }
-        sprintf( ptr, "-->" );
-        fs->buffer = ptr + 3;
-        icvXMLFlush( fs );
+#if defined WIN32 || defined _WIN32
+        UnmapViewOfFile( mapping->data );
+        CloseHandle( mapping->handle );
+#else
+        munmap( mapping->data, mapping->size );
+#endif
     }
+    cvFree( &mapping );
+}
+
+
+static void
+icvReleaseFileMapping( CvFileMapping* mapping )
+{
+    if( mapping && CV_XADD(&mapping->refcount, -1) == 1 )
+        icvFreeFileMapping( mapping );
 }
 
 
@@ -2591,6 +3568,19 @@ icvXMLWriteComment( CvFileStorage* fs, const char* comment, int eol_comment )
 *                              Common High-Level Functions                               *
 \****************************************************************************************/
 
+// checks whether the name, without the optional .gz suffix, has the .bin extension
+static bool icvIsBinaryStorageName( const char* filename, bool* isGZ )
+{
+    int len = (int)strlen(filename);
+    const char* dot_pos = strrchr(filename, '.');
+    *isGZ = dot_pos && dot_pos[1] == 'g' && dot_pos[2] == 'z' &&
+        (dot_pos[3] == '\0' || (cv_isdigit(dot_pos[3]) && dot_pos[4] == '\0'));
+    if( *isGZ )
+        len = (int)(dot_pos - filename);
+    return len > 4 && (memcmp( filename + len - 4, ".bin", 4) == 0 ||
+        memcmp(filename + len - 4, ".BIN", 4) == 0 || memcmp(filename + len - 4, ".Bin", 4) == 0);
+}
+
 CV_IMPL CvFileStorage*
 cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, const char* encoding )
 {
@@ -2603,6 +3593,17 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
     if( !filename )
         CV_Error( CV_StsNullPtr, "NULL filename" );
 
+    // the binary storages are always written from scratch; the unsupported modes
+    // are rejected before anything is allocated and before the file is touched
+    if( (flags & 3) != 0 && icvIsBinaryStorageName( filename, &isGZ ) )
+    {
+        if( isGZ )
+            CV_Error( CV_StsBadArg, "Compressed binary file storages are not supported" );
+        if( append )
+            CV_Error( CV_StsBadArg, "Binary file storages can not be opened for appending, "
+                      "write the whole storage at once" );
+    }
+
     fs = (CvFileStorage*)cvAlloc( sizeof(*fs) );
     memset( fs, 0, sizeof(*fs));
 
@@ -2633,9 +3634,15 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
     fs->flags = CV_FILE_STORAGE;
     fs->write_mode = (flags & 3) != 0;
 
+    if( fs->write_mode )
+    {
+        fs->is_binary = icvIsBinaryStorageName( filename, &isGZ );
+    }
+
     if( !isGZ )
     {
-        fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : !append ? "wt" : "a+t" );
+        fs->file = fopen(fs->filename, !fs->write_mode ? "rt" : fs->is_binary ? "wb" :
+                         !append ? "wt" : "a+t" );
         if( !fs->file )
             goto _exit_;
     }
@@ -2737,6 +3744,19 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
             fs->write_comment = icvXMLWriteComment;
             fs->start_next_stream = icvXMLStartNextStream;
         }
+        else if( fs->is_binary )
+        {
+            unsigned bom = CV_FS_BIN_BOM;
+            icvBinPut( fs, icvBinSignature, sizeof(icvBinSignature) - 1 );
+            icvBinPut( fs, &bom, sizeof(bom) );
+            fs->start_write_struct = icvBinStartWriteStruct;
+            fs->end_write_struct = icvBinEndWriteStruct;
+            fs->write_int = icvBinWriteInt;
+            fs->write_real = icvBinWriteReal;
+            fs->write_string = icvBinWriteString;
+            fs->write_comment = icvBinWriteComment;
+            fs->start_next_stream = icvBinStartNextStream;
+        }
         else
         {
             if( !append )
@@ -2757,17 +3777,30 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
         int buf_size = 1 << 20;
         const char* yaml_signature = "%YAML:";
         char buf[16];
-        icvGets( fs, buf, sizeof(buf)-2 );
-        fs->is_xml = strncmp( buf, yaml_signature, strlen(yaml_signature) ) != 0;
+        if( !icvGets( fs, buf, sizeof(buf)-2 ) )
+            buf[0] = '\0';
+        fs->is_binary = strcmp( buf, icvBinSignature ) == 0;
+        fs->is_xml = !fs->is_binary && strncmp( buf, yaml_signature, strlen(yaml_signature) ) != 0;
 
-        if( !isGZ )
+        if( fs->is_binary )
+        {
+            if( isGZ )
+                CV_Error(CV_StsNotImplemented, "Compressed binary file storages are not supported" );
+            // the data is accessed via the file mapping, the file itself is not needed after that
+            icvClose( fs );
+            fs->file = fopen( fs->filename, "rb" );
+            if( fs->file && (fs->mapping = icvMapFile( fs->file )) == 0 )
+                icvClose( fs );
+            if( !fs->file )
+                goto _exit_;
+        }
+        else if( !isGZ )
         {
             fseek( fs->file, 0, SEEK_END );
             buf_size = ftell( fs->file );
             buf_size = MIN( buf_size, (1 << 20) );
             buf_size = MAX( buf_size, CV_FS_MAX_LEN*2 + 1024 );
         }
-        icvRewind(fs);
 
         fs->str_hash = cvCreateMap( 0, sizeof(CvStringHash),
                         sizeof(CvStringHashNode), fs->memstorage, 256 );
@@ -2775,11 +3808,21 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
         fs->roots = cvCreateSeq( 0, sizeof(CvSeq),
                         sizeof(CvFileNode), fs->memstorage );
 
+        if( fs->is_binary )
+        {
+            icvBinParse( fs );
+            goto _exit_;
+        }
+
+        icvRewind(fs);
         fs->buffer = fs->buffer_start = (char*)cvAlloc( buf_size + 256 );
         fs->buffer_end = fs->buffer_start + buf_size;
         fs->buffer[0] = '\n';
         fs->buffer[1] = '\0';
 
+        // only YAML can be parsed lazily, the other formats are always parsed completely
+        fs->streaming = fs->defer_seqs = (flags & CV_STORAGE_STREAM) != 0 && !fs->is_xml;
+
         //mode = cvGetErrMode();
         //cvSetErrMode( CV_ErrModeSilent );
         if( fs->is_xml )
@@ -2787,10 +3830,15 @@ cvOpenFileStorage( const char* filename, CvMemStorage* dststorage, int flags, co
         else
             icvYMLParse( fs );
         //cvSetErrMode( mode );
+        fs->defer_seqs = 0;
 
-        // release resources that we do not need anymore
-        cvFree( &fs->buffer_start );
-        fs->buffer = fs->buffer_end = 0;
+        // release resources that we do not need anymore;
+        // the deferred sequences are parsed from the file on request
+        if( !fs->lazy_seqs )
+        {
+            cvFree( &fs->buffer_start );
+            fs->buffer = fs->buffer_end = 0;
+        }
     }
 _exit_:
     if( fs )
@@ -2799,7 +3847,7 @@ _exit_:
         {
             cvReleaseFileStorage( &fs );
         }
-        else if( !fs->write_mode )
+        else if( !fs->write_mode && !fs->lazy_seqs )
         {
             icvClose(fs);
         }
@@ -2999,6 +4047,12 @@ cvWriteRawData( CvFileStorage* fs, const void* _data, int len, const char* dt )
     {
         fmt_pairs[0] *= len;
         len = 1;
+
+        if( fs->is_binary && fmt_pairs[1] != CV_USRTYPE1 )
+        {
+            icvBinWriteBlob( fs, data0, fmt_pairs[0], fmt_pairs[1] );
+            return;
+        }
     }
 
     for(;len--;)
@@ -3013,6 +4067,14 @@ cvWriteRawData( CvFileStorage* fs, const void* _data, int len, const char* dt )
             offset = cvAlign( offset, elem_size );
             data = data0 + offset;
 
+            if( fs->is_binary )
+            {
+                for( i = 0; i < count; i++, data += elem_size )
+                    icvBinWriteRawScalar( fs, data, elem_type );
+                offset = (int)(data - data0);
+                continue;
+            }
+
             for( i = 0; i < count; i++ )
             {
                 switch( elem_type )
@@ -3089,6 +4151,7 @@ cvStartReadRawData( const CvFileStorage* fs, const CvFileNode* src, CvSeqReader*
     }
     else if( node_type == CV_NODE_SEQ )
     {
+        icvFSLoadLazySeq( src );
         cvStartReadSeq( src->data.seq, reader, 0 );
     }
     else if( node_type == CV_NODE_NONE )
@@ -3107,6 +4170,8 @@ cvReadRawDataSlice( const CvFileStorage* fs, CvSeqReader* reader,
     char* data0 = (char*)_data;
     int fmt_pairs[CV_FS_MAX_FMT_PAIRS*2], k = 0, fmt_pair_count;
     int i = 0, offset = 0, count = 0;
+    int blob_depth = -1, elem_step = (int)sizeof(CvFileNode);
+    CvFileNode blob_node;
 
     CV_CHECK_FILE_STORAGE( fs );
 
@@ -3118,6 +4183,30 @@ cvReadRawDataSlice( const CvFileStorage* fs, CvSeqReader* reader,
 
     fmt_pair_count = icvDecodeFormat( dt, fmt_pairs, CV_FS_MAX_FMT_PAIRS );
 
+    if( reader->seq && CV_FS_IS_BLOB_SEQ(reader->seq) )
+    {
+        blob_depth = CV_MAT_DEPTH(reader->seq->flags);
+        elem_step = reader->seq->elem_size;
+
+        // the elements have the requested type already, just copy them
+        if( fmt_pair_count == 1 && fmt_pairs[1] == blob_depth && len % fmt_pairs[0] == 0 )
+        {
+            while( len > 0 )
+            {
+                int n = std::min( len, (int)((reader->block_max - reader->ptr)/elem_step) );
+                if( n <= 0 )
+                    CV_Error( CV_StsBadSize, "The sequence is empty" );
+                memcpy( data0, reader->ptr, n*elem_step );
+                data0 += n*elem_step;
+                reader->ptr += n*elem_step;
+                len -= n;
+                if( reader->ptr >= reader->block_max )
+                    cvChangeSeqBlock( reader, 1 );
+            }
+            return;
+        }
+    }
+
     for(;;)
     {
         for( k = 0; k < fmt_pair_count; k++ )
@@ -3132,7 +4221,13 @@ cvReadRawDataSlice( const CvFileStorage* fs, CvSeqReader* reader,
 
             for( i = 0; i < count; i++ )
             {
-                CvFileNode* node = (CvFileNode*)reader->ptr;
+                const CvFileNode* node = (const CvFileNode*)reader->ptr;
+                if( blob_depth >= 0 )
+                {
+                    icvBinBlobElemToNode( (const uchar*)reader->ptr, blob_depth, &blob_node );
+                    node = &blob_node;
+                }
+
                 if( CV_NODE_IS_INT(node->tag) )
                 {
                     int ival = node->data.i;
@@ -3230,7 +4325,7 @@ cvReadRawDataSlice( const CvFileStorage* fs, CvSeqReader* reader,
                     CV_Error( CV_StsError,
                     "The sequence element is not a numerical scalar" );
 
-                CV_NEXT_SEQ_ELEM( sizeof(CvFileNode), *reader );
+                CV_NEXT_SEQ_ELEM( elem_step, *reader );
                 if( !--len )
                     goto end_loop;
             }
@@ -3270,11 +4365,26 @@ icvWriteFileNode( CvFileStorage* fs, const char* name, const CvFileNode* node );
 static void
 icvWriteCollection( CvFileStorage* fs, const CvFileNode* node )
 {
-    int i, total = node->data.seq->total;
+    int i, total = icvFSCollectionSize( node->data.seq );
     int elem_size = node->data.seq->elem_size;
     int is_map = CV_NODE_IS_MAP(node->tag);
     CvSeqReader reader;
 
+    if( !is_map && CV_FS_IS_BLOB_SEQ(node->data.seq) )
+    {
+        char dt[] = { icvTypeSymbol[CV_MAT_DEPTH(node->data.seq->flags)], '\0' };
+        if( total > 0 )
+            cvWriteRawData( fs, node->data.seq->first->data, total, dt );
+        return;
+    }
+
+    if( !is_map && CV_FS_IS_LAZY_SEQ(node->data.seq) )
+    {
+        for( i = 0; i < total; i++ )
+            icvWriteFileNode( fs, 0, icvFSGetLazyElem( node, i ) );
+        return;
+    }
+
     cvStartReadSeq( node->data.seq, &reader, 0 );
 
     for( i = 0; i < total; i++ )
@@ -3417,7 +4527,7 @@ icvWriteMat( CvFileStorage* fs, const char* name,
 static int
 icvFileNodeSeqLen( CvFileNode* node )
 {
-    return CV_NODE_IS_COLLECTION(node->tag) ? node->data.seq->total :
+    return CV_NODE_IS_COLLECTION(node->tag) ? icvFSCollectionSize(node->data.seq) :
            CV_NODE_TYPE(node->tag) != CV_NODE_NONE;
 }
 
@@ -5162,10 +6272,22 @@ FileNode FileNode::operator[](const char* nodename) const
     return FileNode(fs, cvGetFileNodeByName(fs, node, nodename));
 }
 
+size_t FileNode::size() const
+{
+    int t = type();
+    return t == MAP ? (size_t)((CvSet*)node->data.map)->active_count :
+        t == SEQ ? (size_t)icvFSCollectionSize(node->data.seq) : (size_t)(node != 0);
+}
+
 FileNode FileNode::operator[](int i) const
 {
-    return isSeq() ? FileNode(fs, (CvFileNode*)cvGetSeqElem(node->data.seq, i)) :
-        i == 0 ? *this : FileNode();
+    if( !isSeq() )
+        return i == 0 ? *this : FileNode();
+    if( CV_FS_IS_LAZY_SEQ(node->data.seq) )
+        return FileNode(fs, icvFSGetLazyElem(node, i));
+    if( CV_FS_IS_BLOB_SEQ(node->data.seq) )
+        return FileNode(fs, (const CvFileNode*)cvGetSeqElem(icvFSGetBlobNodes(fs, node->data.seq), i));
+    return FileNode(fs, (CvFileNode*)cvGetSeqElem(node->data.seq, i));
 }
     
 string FileNode::name() const
@@ -5227,11 +6349,32 @@ FileNodeIterator::FileNodeIterator(const FileNodeIterator& it)
     remaining = it.remaining;
 }
 
+FileNode FileNodeIterator::operator *() const
+{
+    if( reader.seq && CV_FS_IS_LAZY_SEQ(reader.seq) )
+    {
+        // the element is parsed when it is accessed
+        return FileNode(fs, icvFSGetLazyElem(container, (int)(icvFSCollectionSize(reader.seq) - remaining)));
+    }
+    if( reader.seq && CV_FS_IS_BLOB_SEQ(reader.seq) )
+    {
+        // the raw elements are converted to file nodes on the first access
+        return FileNode(fs, (const CvFileNode*)cvGetSeqElem(icvFSGetBlobNodes(fs, reader.seq),
+                                (int)(reader.seq->total - remaining)));
+    }
+    return FileNode(fs, (const CvFileNode*)reader.ptr);
+}
+
+FileNode FileNodeIterator::operator ->() const
+{
+    return operator *();
+}
+
 FileNodeIterator& FileNodeIterator::operator ++()
 {
     if( remaining > 0 )
     {
-        if( reader.seq )
+        if( reader.seq && !CV_FS_IS_LAZY_SEQ(reader.seq) )
             CV_NEXT_SEQ_ELEM( reader.seq->elem_size, reader );
         remaining--;
     }
@@ -5249,7 +6392,7 @@ FileNodeIterator& FileNodeIterator::operator --()
 {
     if( remaining < FileNode(fs, container).size() )
     {
-        if( reader.seq )
+        if( reader.seq && !CV_FS_IS_LAZY_SEQ(reader.seq) )
             CV_PREV_SEQ_ELEM( reader.seq->elem_size, reader );
         remaining++;
     }
@@ -5275,7 +6418,7 @@ FileNodeIterator& FileNodeIterator::operator += (int ofs)
         ofs = (int)(remaining - std::min(remaining - ofs, count));
     }
     remaining -= ofs;
-    if( reader.seq )
+    if( reader.seq && !CV_FS_IS_LAZY_SEQ(reader.seq) )
         cvSetSeqReaderPos( &reader, ofs, 1 );
     return *this;
 }
@@ -5295,7 +6438,28 @@ FileNodeIterator& FileNodeIterator::readRaw( const string& fmt, uchar* vec, size
         CV_Assert( elem_size > 0 );
         size_t count = std::min(remaining, maxCount);
         
-        if( reader.seq )
+        if( reader.seq && CV_FS_IS_LAZY_SEQ(reader.seq) )
+        {
+            // convert the elements in small portions to keep the memory footprint low
+            MemStorage storage(cvCreateMemStorage(0));
+            CvSeq* seq = cvCreateSeq( 0, sizeof(CvSeq), sizeof(CvFileNode), storage );
+            size_t i, n, chunk = cn*256;
+            CvSeqReader chunk_reader;
+
+            for( ; count > 0; count -= n, vec += (n/cn)*elem_size )
+            {
+                n = std::min(count, chunk);
+                cvClearSeq( seq );
+                for( i = 0; i < n; i++, ++(*this) )
+                {
+                    FileNode elem = *(*this);
+                    cvSeqPush( seq, elem.node );
+                }
+                cvStartReadSeq( seq, &chunk_reader );
+                cvReadRawDataSlice( fs, &chunk_reader, (int)n, vec, fmt.c_str() );
+            }
+        }
+        else if( reader.seq )
         {
             cvReadRawDataSlice( fs, &reader, (int)count, vec, fmt.c_str() );
             remaining -= count*cn;
@@ -5366,7 +6530,93 @@ WriteStructContext::WriteStructContext(FileStorage& _fs, const string& name,
     
 WriteStructContext::~WriteStructContext() { cvEndWriteStruct(**fs); }    
 
-    
+
+/*
+  The allocator of the matrices that reference the data of binary file storages.
+  Mat::refcount of such matrices points to CvFileMapping::refcount, so the file
+  is unmapped when both the storage and the last of the matrices are released.
+*/
+class FileMappingAllocator : public MatAllocator
+{
+public:
+    void allocate(int dims, const int* sizes, int type, int*& refcount,
+                  uchar*& datastart, uchar*& data, size_t* step)
+    {
+        // the matrix is reallocated; the new data is put to the heap
+        size_t total = CV_ELEM_SIZE(type);
+        for( int i = dims-1; i >= 0; i-- )
+        {
+            if( step )
+                step[i] = total;
+            total *= sizes[i];
+        }
+        CvFileMapping* mapping = icvCreateFileMapping( total );
+        mapping->data = (uchar*)fastMalloc( total );
+        refcount = &mapping->refcount;
+        datastart = data = mapping->data;
+    }
+
+    void deallocate(int* refcount, uchar*, uchar*)
+    {
+        icvFreeFileMapping( (CvFileMapping*)refcount );
+    }
+};
+
+static FileMappingAllocator fileMappingAllocator;
+
+// makes the matrix header for the matrix data stored in the binary file storage
+static bool readMappedMat( const FileNode& node, Mat& mat )
+{
+    CvFileStorage* fs = (CvFileStorage*)node.fs;
+    const CvFileNode* n = *node;
+
+    if( !fs->mapping || !n->info || !CV_NODE_IS_MAP(n->tag) )
+        return false;
+
+    bool isND = strcmp( n->info->type_name, CV_TYPE_NAME_MATND ) == 0;
+    if( !isND && strcmp( n->info->type_name, CV_TYPE_NAME_MAT ) != 0 )
+        return false;
+
+    const CvFileNode* data = cvGetFileNodeByName( fs, n, "data" );
+    const char* dt = cvReadStringByName( fs, n, "dt", 0 );
+    if( !data || !dt || !CV_NODE_IS_SEQ(data->tag) || !CV_FS_IS_BLOB_SEQ(data->data.seq) )
+        return false;
+
+    int i, dims = 2, sizes[CV_MAX_DIM], type = icvDecodeSimpleFormat( dt );
+    if( isND )
+    {
+        const CvFileNode* sizes_node = cvGetFileNodeByName( fs, n, "sizes" );
+        dims = sizes_node ? icvFileNodeSeqLen( (CvFileNode*)sizes_node ) : 0;
+        if( dims <= 0 || dims > CV_MAX_DIM )
+            return false;
+        cvReadRawData( fs, sizes_node, sizes, "i" );
+    }
+    else
+    {
+        sizes[0] = cvReadIntByName( fs, n, "rows", -1 );
+        sizes[1] = cvReadIntByName( fs, n, "cols", -1 );
+    }
+
+    size_t total = CV_MAT_CN(type);
+    for( i = 0; i < dims; i++ )
+    {
+        if( sizes[i] <= 0 )
+            return false;
+        total *= sizes[i];
+    }
+
+    const CvSeq* seq = data->data.seq;
+    if( CV_MAT_DEPTH(seq->flags) != CV_MAT_DEPTH(type) || (size_t)seq->total != total )
+        return false;
+
+    Mat m(dims, sizes, type, seq->first->data);
+    m.refcount = &fs->mapping->refcount;
+    CV_XADD(m.refcount, 1);
+    m.allocator = &fileMappingAllocator;
+    mat = m;
+    return true;
+}
+
 void read( const FileNode& node, Mat& mat, const Mat& default_mat )
 {
     if( node.empty() )
@@ -5374,6 +6624,8 @@ void read( const FileNode& node, Mat& mat, const Mat& default_mat )
         default_mat.copyTo(mat);
         return;
     }
+    if( readMappedMat(node, mat) )
+        return;
     void* obj = cvRead((CvFileStorage*)node.fs, (CvFileNode*)*node);
     if(CV_IS_MAT_HDR_Z(obj))
     {
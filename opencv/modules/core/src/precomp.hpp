@@ -187,6 +187,25 @@ BinaryFunc getCopyMaskFunc(size_t esz);
 
 enum { BLOCK_SIZE = 1024 };
 
+enum
+{
+    ARITHM_ADD=0, ARITHM_SUB=1, ARITHM_ABSDIFF=2, ARITHM_MIN=3, ARITHM_MAX=4, ARITHM_CMP=5,
+    ARITHM_ADD_WEIGHTED=6, ARITHM_AND=7, ARITHM_OR=8, ARITHM_XOR=9, ARITHM_NOT=10
+};
+
+// returns the table of AVX2 kernels for the operation (indexed by depth, the bitwise operations
+// have a single entry), or 0 if the compiler could not build arithm_avx2.cpp with AVX2 enabled.
+// Null entries mean that there is no AVX2 kernel for the particular depth.
+const BinaryFunc* getArithmTabAVX2(int op);
+
+typedef void (*HammingBatchFunc)(const uchar* a, const uchar* b, size_t bstep,
+                                 int n, int count, int* dist, int cellSize);
+
+// return the implementations of batchNormHamming() that use the POPCNT and AVX2 instructions,
+// or 0 if the compiler could not build them (see stat_popcnt.cpp and stat_avx2.cpp)
+HammingBatchFunc getHammingBatchFuncPOPCNT();
+HammingBatchFunc getHammingBatchFuncAVX2();
+
 #ifdef HAVE_IPP
 static inline IppiSize ippiSize(int width, int height) { IppiSize sz = { width, height}; return sz; }
 static inline IppiSize ippiSize(Size _sz)              { IppiSize sz = { _sz.width, _sz.height}; return sz; }
@@ -55,6 +55,63 @@ template<typename T> static inline Scalar rawToScalar(const T& v)
     return s;
 }    
 
+/*
+ The planes of the iterated arrays (see NAryMatIterator) split into blocks of at most
+ STAT_BLOCK_SIZE elements. The reductions process the consecutive ranges of the blocks
+ with parallel_reduce(), where each range is processed by a separate body and the partial
+ results are joined from left to right. The blocks and the ranges depend only on the array
+ sizes, therefore the results do not depend on the number of threads.
+
+ The block size is small enough to accumulate the sums of 8-bit and 16-bit values (and the
+ sums of squares of 8-bit values) of up to 4 channels in int without overflow.
+*/
+enum { STAT_BLOCK_SIZE = 1 << 12, STAT_MIN_CHUNK_SIZE = 1 << 16 };
+
+class StatBlocks
+{
+public:
+    StatBlocks(const Mat** arrays)
+    {
+        uchar* ptrs[4];
+        NAryMatIterator it(arrays, ptrs);
+        CV_Assert( it.narrays <= 4 );
+        narrays = it.narrays;
+        total = (int)it.size;
+        blockSize = std::max(std::min(total, (int)STAT_BLOCK_SIZE), 1);
+        blocksPerPlane = (total + blockSize - 1)/blockSize;
+        nblocks = (int)it.nplanes*blocksPerPlane;
+        planes.resize(it.nplanes*narrays);
+        for( size_t i = 0; i < it.nplanes; i++, ++it )
+            for( int k = 0; k < narrays; k++ )
+                planes[i*narrays + k] = ptrs[k];
+        for( int k = 0; k < narrays; k++ )
+            esz[k] = arrays[k]->elemSize();
+    }
+
+    //! the range of the blocks with the grain size that makes the parallel processing worthwhile
+    BlockedRange range() const
+    {
+        return BlockedRange(0, nblocks, std::max((int)STAT_MIN_CHUNK_SIZE/blockSize, 1));
+    }
+
+    //! sets the pointers to the block beginning and returns the block size in elements
+    int getBlock(int idx, uchar** ptrs, size_t* startIdx=0) const
+    {
+        int plane = idx/blocksPerPlane, ofs = (idx - plane*blocksPerPlane)*blockSize;
+        const uchar* const* pptrs = &planes[plane*narrays];
+        for( int k = 0; k < narrays; k++ )
+            ptrs[k] = pptrs[k] ? (uchar*)pptrs[k] + ofs*esz[k] : 0;
+        if( startIdx )
+            *startIdx = (size_t)plane*total + ofs;
+        return std::min(total - ofs, blockSize);
+    }
+
+protected:
+    vector<uchar*> planes;
+    size_t esz[4];
+    int narrays, total, blockSize, blocksPerPlane, nblocks;
+};
+
 /****************************************************************************************\
 *                                        sum                                             *
 \****************************************************************************************/
@@ -392,59 +449,134 @@ static SumSqrFunc sumSqrTab[] =
     (SumSqrFunc)sqsum32s, (SumSqrFunc)sqsum32f, (SumSqrFunc)sqsum64f, 0
 };
 
+class SumInvoker
+{
+public:
+    SumInvoker(const StatBlocks& _blocks, SumFunc _func, int _cn, bool _intSum)
+        : blocks(&_blocks), func(_func), cn(_cn), intSum(_intSum), nz(0) {}
+    SumInvoker(const SumInvoker& b, Split)
+        : blocks(b.blocks), func(b.func), cn(b.cn), intSum(b.intSum), nz(0) {}
+
+    void operator()(const BlockedRange& range)
+    {
+        uchar* ptrs[2] = {0, 0};
+        for( int i = range.begin(); i < range.end(); i++ )
+        {
+            int k, len = blocks->getBlock(i, ptrs);
+            if( intSum )
+            {
+                int buf[4] = {0, 0, 0, 0};
+                nz += func( ptrs[0], ptrs[1], (uchar*)buf, len, cn );
+                for( k = 0; k < cn; k++ )
+                    s[k] += buf[k];
+            }
+            else
+                nz += func( ptrs[0], ptrs[1], (uchar*)&s[0], len, cn );
+        }
+    }
+
+    void join(const SumInvoker& b)
+    {
+        s += b.s;
+        nz += b.nz;
+    }
+
+    const StatBlocks* blocks;
+    SumFunc func;
+    int cn;
+    bool intSum;
+    Scalar s;
+    size_t nz;
+};
+
+class CountNonZeroInvoker
+{
+public:
+    CountNonZeroInvoker(const StatBlocks& _blocks, CountNonZeroFunc _func)
+        : blocks(&_blocks), func(_func), nz(0) {}
+    CountNonZeroInvoker(const CountNonZeroInvoker& b, Split)
+        : blocks(b.blocks), func(b.func), nz(0) {}
+
+    void operator()(const BlockedRange& range)
+    {
+        uchar* ptrs[1] = {0};
+        for( int i = range.begin(); i < range.end(); i++ )
+        {
+            int len = blocks->getBlock(i, ptrs);
+            nz += func( ptrs[0], len );
+        }
+    }
+
+    void join(const CountNonZeroInvoker& b) { nz += b.nz; }
+
+    const StatBlocks* blocks;
+    CountNonZeroFunc func;
+    int nz;
+};
+
+class SumSqrInvoker
+{
+public:
+    SumSqrInvoker(const StatBlocks& _blocks, SumSqrFunc _func, int _cn, bool _intSum, bool _intSqSum)
+        : blocks(&_blocks), func(_func), cn(_cn), intSum(_intSum), intSqSum(_intSqSum),
+          sums(_cn*2, 0.), nz(0) {}
+    SumSqrInvoker(const SumSqrInvoker& b, Split)
+        : blocks(b.blocks), func(b.func), cn(b.cn), intSum(b.intSum), intSqSum(b.intSqSum),
+          sums(b.cn*2, 0.), nz(0) {}
+
+    void operator()(const BlockedRange& range)
+    {
+        uchar* ptrs[2] = {0, 0};
+        AutoBuffer<int> _buf(cn*2);
+        int *sbuf = _buf, *sqbuf = sbuf + cn;
+        double *s = &sums[0], *sq = s + cn;
+
+        for( int i = range.begin(); i < range.end(); i++ )
+        {
+            int k, len = blocks->getBlock(i, ptrs);
+            for( k = 0; k < cn*2; k++ )
+                sbuf[k] = 0;
+            nz += func( ptrs[0], ptrs[1], intSum ? (uchar*)sbuf : (uchar*)s,
+                        intSqSum ? (uchar*)sqbuf : (uchar*)sq, len, cn );
+            if( intSum )
+                for( k = 0; k < cn; k++ )
+                    s[k] += sbuf[k];
+            if( intSqSum )
+                for( k = 0; k < cn; k++ )
+                    sq[k] += sqbuf[k];
+        }
+    }
+
+    void join(const SumSqrInvoker& b)
+    {
+        for( int k = 0; k < cn*2; k++ )
+            sums[k] += b.sums[k];
+        nz += b.nz;
+    }
+
+    const StatBlocks* blocks;
+    SumSqrFunc func;
+    int cn;
+    bool intSum, intSqSum;
+    vector<double> sums;
+    int nz;
+};
+
 }
     
 cv::Scalar cv::sum( InputArray _src )
 {
     Mat src = _src.getMat();
-    int k, cn = src.channels(), depth = src.depth();
+    int cn = src.channels(), depth = src.depth();
     SumFunc func = sumTab[depth];
     
     CV_Assert( cn <= 4 && func != 0 );
     
     const Mat* arrays[] = {&src, 0};
-    uchar* ptrs[1];
-    NAryMatIterator it(arrays, ptrs);
-    Scalar s;
-    int total = (int)it.size, blockSize = total, intSumBlockSize = 0;
-    int j, count = 0;
-    AutoBuffer<int> _buf;
-    int* buf = (int*)&s[0];
-    size_t esz = 0;
-    bool blockSum = depth < CV_32S;
-    
-    if( blockSum )
-    {
-        intSumBlockSize = depth <= CV_8S ? (1 << 23) : (1 << 15);
-        blockSize = std::min(blockSize, intSumBlockSize);
-        _buf.allocate(cn);
-        buf = _buf;
-    
-        for( k = 0; k < cn; k++ )
-            buf[k] = 0;
-        esz = src.elemSize();
-    }
-        
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-    {
-        for( j = 0; j < total; j += blockSize )
-        {
-            int bsz = std::min(total - j, blockSize);
-            func( ptrs[0], 0, (uchar*)buf, bsz, cn );
-            count += bsz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    s[k] += buf[k];
-                    buf[k] = 0;
-                }
-                count = 0;
-            }
-            ptrs[0] += bsz*esz;
-        }
-    }
-    return s;
+    StatBlocks blocks(arrays);
+    SumInvoker body(blocks, func, cn, depth < CV_32S);
+    parallel_reduce(blocks.range(), body);
+    return body.s;
 }
 
 int cv::countNonZero( InputArray _src )
@@ -455,14 +587,10 @@ int cv::countNonZero( InputArray _src )
     CV_Assert( src.channels() == 1 && func != 0 );
     
     const Mat* arrays[] = {&src, 0};
-    uchar* ptrs[1];
-    NAryMatIterator it(arrays, ptrs);
-    int total = (int)it.size, nz = 0;
-    
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-        nz += func( ptrs[0], total );
-    
-    return nz;
+    StatBlocks blocks(arrays);
+    CountNonZeroInvoker body(blocks, func);
+    parallel_reduce(blocks.range(), body);
+    return body.nz;
 }    
     
 cv::Scalar cv::mean( InputArray _src, InputArray _mask )
@@ -470,57 +598,16 @@ cv::Scalar cv::mean( InputArray _src, InputArray _mask )
     Mat src = _src.getMat(), mask = _mask.getMat();
     CV_Assert( mask.empty() || mask.type() == CV_8U );
     
-    int k, cn = src.channels(), depth = src.depth();
+    int cn = src.channels(), depth = src.depth();
     SumFunc func = sumTab[depth];
     
     CV_Assert( cn <= 4 && func != 0 );
     
     const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2];
-    NAryMatIterator it(arrays, ptrs);
-    Scalar s;
-    int total = (int)it.size, blockSize = total, intSumBlockSize = 0;
-    int j, count = 0;
-    AutoBuffer<int> _buf;
-    int* buf = (int*)&s[0];
-    bool blockSum = depth <= CV_16S;
-    size_t esz = 0, nz0 = 0;
-    
-    if( blockSum )
-    {
-        intSumBlockSize = depth <= CV_8S ? (1 << 23) : (1 << 15);
-        blockSize = std::min(blockSize, intSumBlockSize);
-        _buf.allocate(cn);
-        buf = _buf;
-        
-        for( k = 0; k < cn; k++ )
-            buf[k] = 0;
-        esz = src.elemSize();
-    }
-    
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-    {
-        for( j = 0; j < total; j += blockSize )
-        {
-            int bsz = std::min(total - j, blockSize);
-            int nz = func( ptrs[0], ptrs[1], (uchar*)buf, bsz, cn );
-            count += nz;
-            nz0 += nz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    s[k] += buf[k];
-                    buf[k] = 0;
-                }
-                count = 0;
-            }
-            ptrs[0] += bsz*esz;
-            if( ptrs[1] )
-                ptrs[1] += bsz;
-        }
-    }
-    return s*(nz0 ? 1./nz0 : 0);
+    StatBlocks blocks(arrays);
+    SumInvoker body(blocks, func, cn, depth <= CV_16S);
+    parallel_reduce(blocks.range(), body);
+    return body.s*(body.nz ? 1./body.nz : 0);
 }    
 
     
@@ -529,69 +616,18 @@ void cv::meanStdDev( InputArray _src, OutputArray _mean, OutputArray _sdv, Input
     Mat src = _src.getMat(), mask = _mask.getMat();
     CV_Assert( mask.empty() || mask.type() == CV_8U );
     
-    int k, cn = src.channels(), depth = src.depth();
+    int j, k, cn = src.channels(), depth = src.depth();
     SumSqrFunc func = sumSqrTab[depth];
     
     CV_Assert( func != 0 );
     
     const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2];
-    NAryMatIterator it(arrays, ptrs);
-    int total = (int)it.size, blockSize = total, intSumBlockSize = 0;
-    int j, count = 0, nz0 = 0;
-    AutoBuffer<double> _buf(cn*4);
-    double *s = (double*)_buf, *sq = s + cn;
-    int *sbuf = (int*)s, *sqbuf = (int*)sq;
-    bool blockSum = depth <= CV_16S, blockSqSum = depth <= CV_8S;
-    size_t esz = 0;
-    
-    for( k = 0; k < cn; k++ )
-        s[k] = sq[k] = 0;
-    
-    if( blockSum )
-    {
-        intSumBlockSize = 1 << 15;
-        blockSize = std::min(blockSize, intSumBlockSize);
-        sbuf = (int*)(sq + cn);
-        if( blockSqSum )
-            sqbuf = sbuf + cn;
-        for( k = 0; k < cn; k++ )
-            sbuf[k] = sqbuf[k] = 0;
-        esz = src.elemSize();
-    }
-    
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-    {
-        for( j = 0; j < total; j += blockSize )
-        {
-            int bsz = std::min(total - j, blockSize);
-            int nz = func( ptrs[0], ptrs[1], (uchar*)sbuf, (uchar*)sqbuf, bsz, cn );
-            count += nz;
-            nz0 += nz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
-            {
-                for( k = 0; k < cn; k++ )
-                {
-                    s[k] += sbuf[k];
-                    sbuf[k] = 0;
-                }
-                if( blockSqSum )
-                {
-                    for( k = 0; k < cn; k++ )
-                    {
-                        sq[k] += sqbuf[k];
-                        sqbuf[k] = 0;
-                    }
-                }
-                count = 0;
-            }
-            ptrs[0] += bsz*esz;
-            if( ptrs[1] )
-                ptrs[1] += bsz;
-        }
-    }
+    StatBlocks blocks(arrays);
+    SumSqrInvoker body(blocks, func, cn, depth <= CV_16S, depth <= CV_8S);
+    parallel_reduce(blocks.range(), body);
+    double *s = &body.sums[0], *sq = s + cn;
     
-    double scale = nz0 ? 1./nz0 : 0.;
+    double scale = body.nz ? 1./body.nz : 0.;
     for( k = 0; k < cn; k++ )
     {
         s[k] *= scale;
@@ -713,6 +749,66 @@ static MinMaxIdxFunc minmaxTab[] =
     0
 };
     
+class MinMaxIdxInvoker
+{
+public:
+    MinMaxIdxInvoker(const StatBlocks& _blocks, MinMaxIdxFunc _func, int _depth, int _cn)
+        : blocks(&_blocks), func(_func), depth(_depth), cn(_cn) { init(); }
+    MinMaxIdxInvoker(const MinMaxIdxInvoker& b, Split)
+        : blocks(b.blocks), func(b.func), depth(b.depth), cn(b.cn) { init(); }
+
+    void init()
+    {
+        minidx = maxidx = 0;
+        iminval = INT_MAX; imaxval = INT_MIN;
+        fminval = FLT_MAX; fmaxval = -FLT_MAX;
+        dminval = DBL_MAX; dmaxval = -DBL_MAX;
+    }
+
+    void operator()(const BlockedRange& range)
+    {
+        uchar* ptrs[2] = {0, 0};
+        int *minval = &iminval, *maxval = &imaxval;
+        if( depth == CV_32F )
+            minval = (int*)&fminval, maxval = (int*)&fmaxval;
+        else if( depth == CV_64F )
+            minval = (int*)&dminval, maxval = (int*)&dmaxval;
+
+        for( int i = range.begin(); i < range.end(); i++ )
+        {
+            size_t startidx;
+            int len = blocks->getBlock(i, ptrs, &startidx);
+            func( ptrs[0], ptrs[1], minval, maxval, &minidx, &maxidx, len*cn, startidx*cn + 1 );
+        }
+    }
+
+    double minVal() const { return depth == CV_64F ? dminval : depth == CV_32F ? fminval : iminval; }
+    double maxVal() const { return depth == CV_64F ? dmaxval : depth == CV_32F ? fmaxval : imaxval; }
+
+    // in case of ties the leftmost element is taken, as in the sequential processing
+    void join(const MinMaxIdxInvoker& b)
+    {
+        if( b.minidx != 0 && (minidx == 0 || b.minVal() < minVal()) )
+        {
+            minidx = b.minidx;
+            iminval = b.iminval; fminval = b.fminval; dminval = b.dminval;
+        }
+        if( b.maxidx != 0 && (maxidx == 0 || b.maxVal() > maxVal()) )
+        {
+            maxidx = b.maxidx;
+            imaxval = b.imaxval; fmaxval = b.fmaxval; dmaxval = b.dmaxval;
+        }
+    }
+
+    const StatBlocks* blocks;
+    MinMaxIdxFunc func;
+    int depth, cn;
+    size_t minidx, maxidx;
+    int iminval, imaxval;
+    float fminval, fmaxval;
+    double dminval, dmaxval;
+};
+
 static void ofs2idx(const Mat& a, size_t ofs, int* idx)
 {
     int i, d = a.dims;
@@ -748,31 +844,14 @@ void cv::minMaxIdx(InputArray _src, double* minVal,
     CV_Assert( func != 0 );
     
     const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2];
-    NAryMatIterator it(arrays, ptrs);
-    
-    size_t minidx = 0, maxidx = 0;
-    int iminval = INT_MAX, imaxval = INT_MIN;
-    float fminval = FLT_MAX, fmaxval = -FLT_MAX;
-    double dminval = DBL_MAX, dmaxval = -DBL_MAX;
-    size_t startidx = 1;
-    int *minval = &iminval, *maxval = &imaxval;
-    int planeSize = (int)it.size*cn;
-    
-    if( depth == CV_32F )
-        minval = (int*)&fminval, maxval = (int*)&fmaxval;
-    else if( depth == CV_64F )
-        minval = (int*)&dminval, maxval = (int*)&dmaxval;
-    
-    for( size_t i = 0; i < it.nplanes; i++, ++it, startidx += planeSize )
-        func( ptrs[0], ptrs[1], minval, maxval, &minidx, &maxidx, planeSize, startidx );
-    
-    if( minidx == 0 )
-        dminval = dmaxval = 0;
-    else if( depth == CV_32F )
-        dminval = fminval, dmaxval = fmaxval;
-    else if( depth <= CV_32S )
-        dminval = iminval, dmaxval = imaxval;
+    StatBlocks blocks(arrays);
+    MinMaxIdxInvoker body(blocks, func, depth, cn);
+    parallel_reduce(blocks.range(), body);
+    
+    size_t minidx = body.minidx, maxidx = body.maxidx;
+    double dminval = 0, dmaxval = 0;
+    if( minidx != 0 )
+        dminval = body.minVal(), dmaxval = body.maxVal();
     
     if( minVal )
         *minVal = dminval;
@@ -955,7 +1034,7 @@ static const uchar popCountTable4[] =
     1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2
 };
     
-int normHamming(const uchar* a, const uchar* b, int n)
+static int normHamming_(const uchar* a, const uchar* b, int n)
 {
     int i = 0, result = 0;
 #if CV_NEON
@@ -984,18 +1063,9 @@ int normHamming(const uchar* a, const uchar* b, int n)
         result += popCountTable[a[i] ^ b[i]];
     return result;
 }
-    
-int normHamming(const uchar* a, const uchar* b, int n, int cellSize)
+
+static int normHamming_(const uchar* a, const uchar* b, int n, const uchar* tab)
 {
-    if( cellSize == 1 )
-        return normHamming(a, b, n);
-    const uchar* tab = 0;
-    if( cellSize == 2 )
-        tab = popCountTable2;
-    else if( cellSize == 4 )
-        tab = popCountTable4;
-    else
-        CV_Error( CV_StsBadSize, "bad cell size (not 1, 2 or 4) in normHamming" );
     int i = 0, result = 0;
     for( ; i <= n - 4; i += 4 )
         result += tab[a[i] ^ b[i]] + tab[a[i+1] ^ b[i+1]] +
@@ -1005,6 +1075,50 @@ int normHamming(const uchar* a, const uchar* b, int n, int cellSize)
     return result;
 }
     
+static void batchNormHamming_(const uchar* a, const uchar* b, size_t bstep,
+                              int n, int count, int* dist, int cellSize)
+{
+    const uchar* tab = cellSize == 2 ? popCountTable2 : cellSize == 4 ? popCountTable4 : 0;
+    for( int j = 0; j < count; j++, b += bstep )
+        dist[j] = tab ? normHamming_(a, b, n, tab) : normHamming_(a, b, n);
+}
+
+static const HammingBatchFunc hammingBatchPOPCNT = getHammingBatchFuncPOPCNT();
+static const HammingBatchFunc hammingBatchAVX2 = getHammingBatchFuncAVX2();
+
+static HammingBatchFunc getHammingBatchFunc()
+{
+    if( hammingBatchAVX2 && checkHardwareSupport(CV_CPU_AVX2) && checkHardwareSupport(CV_CPU_POPCNT) )
+        return hammingBatchAVX2;
+    if( hammingBatchPOPCNT && checkHardwareSupport(CV_CPU_POPCNT) )
+        return hammingBatchPOPCNT;
+    return batchNormHamming_;
+}
+    
+int normHamming(const uchar* a, const uchar* b, int n)
+{
+    int result;
+    getHammingBatchFunc()(a, b, 0, n, 1, &result, 1);
+    return result;
+}
+    
+int normHamming(const uchar* a, const uchar* b, int n, int cellSize)
+{
+    if( cellSize != 1 && cellSize != 2 && cellSize != 4 )
+        CV_Error( CV_StsBadSize, "bad cell size (not 1, 2 or 4) in normHamming" );
+    int result;
+    getHammingBatchFunc()(a, b, 0, n, 1, &result, cellSize);
+    return result;
+}
+    
+void batchNormHamming(const uchar* a, const uchar* b, size_t bstep, int n, int count, int* dist, int cellSize)
+{
+    if( cellSize != 1 && cellSize != 2 && cellSize != 4 )
+        CV_Error( CV_StsBadSize, "bad cell size (not 1, 2 or 4) in batchNormHamming" );
+    CV_Assert( n >= 0 && count >= 0 );
+    getHammingBatchFunc()(a, b, bstep, n, count, dist, cellSize);
+}
+    
     
 template<typename T, typename ST> int
 normInf_(const T* src, const uchar* mask, ST* _result, int len, int cn)
@@ -1201,6 +1315,62 @@ static NormDiffFunc normDiffTab[3][8] =
     }
 };
 
+//! computes the norm of one array (func != 0) or the norm of the difference of two arrays (diffFunc != 0)
+class NormInvoker
+{
+public:
+    NormInvoker(const StatBlocks& _blocks, NormFunc _func, NormDiffFunc _diffFunc,
+                int _normType, int _depth, int _cn, bool _intSum)
+        : blocks(&_blocks), func(_func), diffFunc(_diffFunc), normType(_normType),
+          depth(_depth), cn(_cn), intSum(_intSum) { result.d = 0; }
+    NormInvoker(const NormInvoker& b, Split)
+        : blocks(b.blocks), func(b.func), diffFunc(b.diffFunc), normType(b.normType),
+          depth(b.depth), cn(b.cn), intSum(b.intSum) { result.d = 0; }
+
+    void operator()(const BlockedRange& range)
+    {
+        uchar* ptrs[3] = {0, 0, 0};
+        for( int i = range.begin(); i < range.end(); i++ )
+        {
+            int len = blocks->getBlock(i, ptrs);
+            unsigned isum = 0;
+            uchar* r = intSum ? (uchar*)&isum : (uchar*)&result;
+            if( func )
+                func( ptrs[0], ptrs[1], r, len, cn );
+            else
+                diffFunc( ptrs[0], ptrs[1], ptrs[2], r, len, cn );
+            if( intSum )
+                result.d += isum;
+        }
+    }
+
+    void join(const NormInvoker& b)
+    {
+        if( normType != NORM_INF )
+            result.d += b.result.d;
+        else if( depth == CV_64F )
+            result.d = std::max(result.d, b.result.d);
+        else if( depth == CV_32F )
+            result.f = std::max(result.f, b.result.f);
+        else
+            result.u = std::max(result.u, b.result.u);
+    }
+
+    const StatBlocks* blocks;
+    NormFunc func;
+    NormDiffFunc diffFunc;
+    int normType, depth, cn;
+    bool intSum;
+    union
+    {
+        double d;
+        float f;
+        int i;
+        unsigned u;
+    }
+    result;
+};
+
 }
     
 double cv::norm( InputArray _src, int normType, InputArray _mask )
@@ -1213,8 +1383,9 @@ double cv::norm( InputArray _src, int normType, InputArray _mask )
     
     if( depth == CV_32F && src.isContinuous() && mask.empty() )
     {
+        // the small arrays are processed at once, the large ones are reduced in parallel below
         size_t len = src.total()*cn;
-        if( len == (size_t)(int)len )
+        if( len < (size_t)STAT_MIN_CHUNK_SIZE )
         {
             const float* data = src.ptr<float>();
             
@@ -1244,63 +1415,26 @@ double cv::norm( InputArray _src, int normType, InputArray _mask )
     CV_Assert( func != 0 );
     
     const Mat* arrays[] = {&src, &mask, 0};
-    uchar* ptrs[2];
-    union
-    {
-        double d;
-        int i;
-        float f;
-    }
-    result;
-    result.d = 0;
-    NAryMatIterator it(arrays, ptrs);
-    int j, total = (int)it.size, blockSize = total, intSumBlockSize = 0, count = 0;
-    bool blockSum = (normType == NORM_L1 && depth <= CV_16S) ||
-                    (normType == NORM_L2 && depth <= CV_8S);
-    int isum = 0;
-    int *ibuf = &result.i;
-    size_t esz = 0;
-    
-    if( blockSum )
-    {
-        intSumBlockSize = (normType == NORM_L1 && depth <= CV_8S ? (1 << 23) : (1 << 15))/cn;
-        blockSize = std::min(blockSize, intSumBlockSize);
-        ibuf = &isum;
-        esz = src.elemSize();
-    }
-    
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-    {
-        for( j = 0; j < total; j += blockSize )
-        {
-            int bsz = std::min(total - j, blockSize);
-            func( ptrs[0], ptrs[1], (uchar*)ibuf, bsz, cn );
-            count += bsz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
-            {
-                result.d += isum;
-                isum = 0;
-                count = 0;
-            }
-            ptrs[0] += bsz*esz;
-            if( ptrs[1] )
-                ptrs[1] += bsz;
-        }
-    }
+    StatBlocks blocks(arrays);
+    NormInvoker body(blocks, func, 0, normType, depth, cn,
+                     (normType == NORM_L1 && depth <= CV_16S) ||
+                     (normType == NORM_L2 && depth <= CV_8S));
+    parallel_reduce(blocks.range(), body);
     
+    double result = body.result.d;
     if( normType == NORM_INF )
     {
         if( depth == CV_64F )
             ;
         else if( depth == CV_32F )
-            result.d = result.f;
+            result = body.result.f;
         else
-            result.d = result.i;
+            result = body.result.i;
     }
     else if( normType == NORM_L2 )
-        result.d = std::sqrt(result.d);
+        result = std::sqrt(result);
     
-    return result.d;
+    return result;
 }
 
     
@@ -1320,7 +1454,7 @@ double cv::norm( InputArray _src1, InputArray _src2, int normType, InputArray _m
     if( src1.depth() == CV_32F && src1.isContinuous() && src2.isContinuous() && mask.empty() )
     {
         size_t len = src1.total()*src1.channels();
-        if( len == (size_t)(int)len )
+        if( len < (size_t)STAT_MIN_CHUNK_SIZE )
         {
             const float* data1 = src1.ptr<float>();
             const float* data2 = src2.ptr<float>();
@@ -1351,65 +1485,26 @@ double cv::norm( InputArray _src1, InputArray _src2, int normType, InputArray _m
     CV_Assert( func != 0 );
     
     const Mat* arrays[] = {&src1, &src2, &mask, 0};
-    uchar* ptrs[3];
-    union
-    {
-        double d;
-        float f;
-        int i;
-        unsigned u;
-    }
-    result;
-    result.d = 0;
-    NAryMatIterator it(arrays, ptrs);
-    int j, total = (int)it.size, blockSize = total, intSumBlockSize = 0, count = 0;
-    bool blockSum = (normType == NORM_L1 && depth <= CV_16S) ||
-    (normType == NORM_L2 && depth <= CV_8S);
-    unsigned isum = 0;
-    unsigned *ibuf = &result.u;
-    size_t esz = 0;
-    
-    if( blockSum )
-    {
-        intSumBlockSize = normType == NORM_L1 && depth <= CV_8S ? (1 << 23) : (1 << 15);
-        blockSize = std::min(blockSize, intSumBlockSize);
-        ibuf = &isum;
-        esz = src1.elemSize();
-    }
-    
-    for( size_t i = 0; i < it.nplanes; i++, ++it )
-    {
-        for( j = 0; j < total; j += blockSize )
-        {
-            int bsz = std::min(total - j, blockSize);
-            func( ptrs[0], ptrs[1], ptrs[2], (uchar*)ibuf, bsz, cn );
-            count += bsz;
-            if( blockSum && (count + blockSize >= intSumBlockSize || (i+1 >= it.nplanes && j+bsz >= total)) )
-            {
-                result.d += isum;
-                isum = 0;
-                count = 0;
-            }
-            ptrs[0] += bsz*esz;
-            ptrs[1] += bsz*esz;
-            if( ptrs[2] )
-                ptrs[2] += bsz;
-        }
-    }
+    StatBlocks blocks(arrays);
+    NormInvoker body(blocks, 0, func, normType, depth, cn,
+                     (normType == NORM_L1 && depth <= CV_16S) ||
+                     (normType == NORM_L2 && depth <= CV_8S));
+    parallel_reduce(blocks.range(), body);
     
+    double result = body.result.d;
     if( normType == NORM_INF )
     {
         if( depth == CV_64F )
             ;
         else if( depth == CV_32F )
-            result.d = result.f;
+            result = body.result.f;
         else
-            result.d = result.u;
+            result = body.result.u;
     }
     else if( normType == NORM_L2 )
-        result.d = std::sqrt(result.d);
+        result = std::sqrt(result);
     
-    return result.d;
+    return result;
 }
 
 
@@ -0,0 +1,209 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+/* ////////////////////////////////////////////////////////////////////
+//
+//  AVX2 version of the batched Hamming distance. The bits are counted
+//  with the 4-bit lookup table (vpshufb) and summed with vpsadbw; the
+//  distances to 4 train vectors are computed at once, so that the query
+//  vector is loaded once per 4 rows. The file is compiled with AVX2 and
+//  POPCNT code generation enabled, the function is only called after
+//  checkHardwareSupport(CV_CPU_AVX2) and checkHardwareSupport(CV_CPU_POPCNT),
+//  see stat.cpp. Like arithm_avx2.cpp, it should not instantiate anything
+//  from the public headers.
+//
+// */
+
+#include "precomp.hpp"
+
+#if defined __AVX2__
+#include <immintrin.h>
+#if defined _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace cv
+{
+
+#if defined __AVX2__
+
+namespace
+{
+
+#if defined _MSC_VER && defined _M_X64
+inline int popCount64(uint64 x) { return (int)__popcnt64(x); }
+#elif defined _MSC_VER
+inline int popCount64(uint64 x) { return (int)(__popcnt((unsigned)x) + __popcnt((unsigned)(x >> 32))); }
+#else
+inline int popCount64(uint64 x) { return __builtin_popcountll(x); }
+#endif
+
+inline uint64 load64(const uchar* p)
+{
+    uint64 x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+inline __m256i vx_load(const uchar* p) { return _mm256_loadu_si256((const __m256i*)p); }
+
+// leaves a single bit per cell, set if any of the cell bits is set
+template<int cellSize> inline uint64 foldCells(uint64 x);
+template<> inline uint64 foldCells<1>(uint64 x) { return x; }
+template<> inline uint64 foldCells<2>(uint64 x) { return (x | (x >> 1)) & CV_BIG_UINT(0x5555555555555555); }
+template<> inline uint64 foldCells<4>(uint64 x)
+{
+    x |= x >> 1;
+    x |= x >> 2;
+    return x & CV_BIG_UINT(0x1111111111111111);
+}
+
+template<int cellSize> inline __m256i foldCells(__m256i x);
+template<> inline __m256i foldCells<1>(__m256i x) { return x; }
+template<> inline __m256i foldCells<2>(__m256i x)
+{
+    return _mm256_and_si256(_mm256_or_si256(x, _mm256_srli_epi64(x, 1)), _mm256_set1_epi8(0x55));
+}
+template<> inline __m256i foldCells<4>(__m256i x)
+{
+    x = _mm256_or_si256(x, _mm256_srli_epi64(x, 1));
+    x = _mm256_or_si256(x, _mm256_srli_epi64(x, 2));
+    return _mm256_and_si256(x, _mm256_set1_epi8(0x11));
+}
+
+// the number of bits in each 64-bit lane of (a ^ b)
+template<int cellSize> inline __m256i popCount(__m256i a, __m256i b)
+{
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i mask = _mm256_set1_epi8(0x0f);
+    __m256i x = foldCells<cellSize>(_mm256_xor_si256(a, b));
+    x = _mm256_add_epi8(_mm256_shuffle_epi8(lut, _mm256_and_si256(x, mask)),
+                        _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(x, 4), mask)));
+    return _mm256_sad_epu8(x, _mm256_setzero_si256());
+}
+
+template<int cellSize> inline int tailHamming(const uchar* a, const uchar* b, int i, int n)
+{
+    int s = 0;
+    for( ; i <= n - 8; i += 8 )
+        s += popCount64(foldCells<cellSize>(load64(a + i) ^ load64(b + i)));
+    for( ; i < n; i++ )
+        s += popCount64(foldCells<cellSize>((uint64)(a[i] ^ b[i])));
+    return s;
+}
+
+template<int cellSize> void
+batchNormHamming_(const uchar* a, const uchar* b, size_t bstep, int n, int count, int* dist)
+{
+    int i, j = 0, n32 = n & -32;
+    
+    for( ; j <= count - 4; j += 4, b += bstep*4 )
+    {
+        const uchar *b0 = b, *b1 = b + bstep, *b2 = b + bstep*2, *b3 = b + bstep*3;
+        __m256i s0 = _mm256_setzero_si256(), s1 = s0, s2 = s0, s3 = s0;
+        
+        for( i = 0; i < n32; i += 32 )
+        {
+            __m256i va = vx_load(a + i);
+            s0 = _mm256_add_epi64(s0, popCount<cellSize>(va, vx_load(b0 + i)));
+            s1 = _mm256_add_epi64(s1, popCount<cellSize>(va, vx_load(b1 + i)));
+            s2 = _mm256_add_epi64(s2, popCount<cellSize>(va, vx_load(b2 + i)));
+            s3 = _mm256_add_epi64(s3, popCount<cellSize>(va, vx_load(b3 + i)));
+        }
+        
+        // sum the 64-bit lanes of each of s0..s3 and pack the 4 sums into 32-bit integers
+        s0 = _mm256_add_epi64(_mm256_unpacklo_epi64(s0, s1), _mm256_unpackhi_epi64(s0, s1));
+        s2 = _mm256_add_epi64(_mm256_unpacklo_epi64(s2, s3), _mm256_unpackhi_epi64(s2, s3));
+        s0 = _mm256_add_epi64(_mm256_permute2x128_si256(s0, s2, 0x20), _mm256_permute2x128_si256(s0, s2, 0x31));
+        s0 = _mm256_permutevar8x32_epi32(s0, _mm256_setr_epi32(0, 2, 4, 6, 1, 3, 5, 7));
+        __m128i r = _mm256_castsi256_si128(s0);
+        
+        if( n32 < n )
+            r = _mm_add_epi32(r, _mm_setr_epi32(tailHamming<cellSize>(a, b0, n32, n),
+                                                 tailHamming<cellSize>(a, b1, n32, n),
+                                                 tailHamming<cellSize>(a, b2, n32, n),
+                                                 tailHamming<cellSize>(a, b3, n32, n)));
+        _mm_storeu_si128((__m128i*)(dist + j), r);
+    }
+    
+    for( ; j < count; j++, b += bstep )
+    {
+        __m256i s = _mm256_setzero_si256();
+        for( i = 0; i < n32; i += 32 )
+            s = _mm256_add_epi64(s, popCount<cellSize>(vx_load(a + i), vx_load(b + i)));
+        __m128i t = _mm_add_epi64(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+        t = _mm_add_epi64(t, _mm_unpackhi_epi64(t, t));
+        dist[j] = _mm_cvtsi128_si32(t) + tailHamming<cellSize>(a, b, n32, n);
+    }
+}
+
+void batchNormHammingAVX2(const uchar* a, const uchar* b, size_t bstep,
+                          int n, int count, int* dist, int cellSize)
+{
+    if( cellSize == 1 )
+        batchNormHamming_<1>(a, b, bstep, n, count, dist);
+    else if( cellSize == 2 )
+        batchNormHamming_<2>(a, b, bstep, n, count, dist);
+    else
+        batchNormHamming_<4>(a, b, bstep, n, count, dist);
+}
+
+}
+
+HammingBatchFunc getHammingBatchFuncAVX2()
+{
+    return batchNormHammingAVX2;
+}
+
+#else
+
+HammingBatchFunc getHammingBatchFuncAVX2()
+{
+    return 0;
+}
+
+#endif
+
+}
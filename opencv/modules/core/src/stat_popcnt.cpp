@@ -0,0 +1,145 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009-2011, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+/* ////////////////////////////////////////////////////////////////////
+//
+//  Hamming distance computed with the POPCNT instruction. The file is
+//  compiled with POPCNT code generation enabled and the function is only
+//  called after checkHardwareSupport(CV_CPU_POPCNT), see stat.cpp.
+//  Like arithm_avx2.cpp, it should not instantiate anything from the
+//  public headers.
+//
+// */
+
+#include "precomp.hpp"
+
+#if defined _MSC_VER && (defined _M_IX86 || defined _M_X64)
+#include <intrin.h>
+#define CV_HAVE_POPCNT_INTRINSICS 1
+#elif defined __GNUC__ && defined __POPCNT__
+#define CV_HAVE_POPCNT_INTRINSICS 1
+#endif
+
+namespace cv
+{
+
+#if CV_HAVE_POPCNT_INTRINSICS
+
+namespace
+{
+
+#if defined _MSC_VER && defined _M_X64
+inline int popCount64(uint64 x) { return (int)__popcnt64(x); }
+#elif defined _MSC_VER
+inline int popCount64(uint64 x) { return (int)(__popcnt((unsigned)x) + __popcnt((unsigned)(x >> 32))); }
+#else
+inline int popCount64(uint64 x) { return __builtin_popcountll(x); }
+#endif
+
+inline uint64 load64(const uchar* p)
+{
+    uint64 x;
+    memcpy(&x, p, sizeof(x));
+    return x;
+}
+
+// leaves a single bit per cell, set if any of the cell bits is set
+template<int cellSize> inline uint64 foldCells(uint64 x);
+template<> inline uint64 foldCells<1>(uint64 x) { return x; }
+template<> inline uint64 foldCells<2>(uint64 x) { return (x | (x >> 1)) & CV_BIG_UINT(0x5555555555555555); }
+template<> inline uint64 foldCells<4>(uint64 x)
+{
+    x |= x >> 1;
+    x |= x >> 2;
+    return x & CV_BIG_UINT(0x1111111111111111);
+}
+
+template<int cellSize> void
+batchNormHamming_(const uchar* a, const uchar* b, size_t bstep, int n, int count, int* dist)
+{
+    for( int j = 0; j < count; j++, b += bstep )
+    {
+        int i = 0, s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+        for( ; i <= n - 32; i += 32 )
+        {
+            s0 += popCount64(foldCells<cellSize>(load64(a + i) ^ load64(b + i)));
+            s1 += popCount64(foldCells<cellSize>(load64(a + i + 8) ^ load64(b + i + 8)));
+            s2 += popCount64(foldCells<cellSize>(load64(a + i + 16) ^ load64(b + i + 16)));
+            s3 += popCount64(foldCells<cellSize>(load64(a + i + 24) ^ load64(b + i + 24)));
+        }
+        for( ; i <= n - 8; i += 8 )
+            s0 += popCount64(foldCells<cellSize>(load64(a + i) ^ load64(b + i)));
+        for( ; i < n; i++ )
+            s1 += popCount64(foldCells<cellSize>((uint64)(a[i] ^ b[i])));
+        dist[j] = s0 + s1 + s2 + s3;
+    }
+}
+
+void batchNormHammingPOPCNT(const uchar* a, const uchar* b, size_t bstep,
+                            int n, int count, int* dist, int cellSize)
+{
+    if( cellSize == 1 )
+        batchNormHamming_<1>(a, b, bstep, n, count, dist);
+    else if( cellSize == 2 )
+        batchNormHamming_<2>(a, b, bstep, n, count, dist);
+    else
+        batchNormHamming_<4>(a, b, bstep, n, count, dist);
+}
+
+}
+
+HammingBatchFunc getHammingBatchFuncPOPCNT()
+{
+    return batchNormHammingPOPCNT;
+}
+
+#else
+
+HammingBatchFunc getHammingBatchFuncPOPCNT()
+{
+    return 0;
+}
+
+#endif
+
+}
@@ -136,9 +136,20 @@ struct HWFeatures
     {
         HWFeatures f;
         int cpuid_data[4] = { 0, 0, 0, 0 };
+        int cpuid_data7[4] = { 0, 0, 0, 0 };
+        bool haveYMMState = false;
 
     #if defined _MSC_VER && (defined _M_IX86 || defined _M_X64)
         __cpuid(cpuid_data, 1);
+        #if _MSC_VER >= 1600
+        int cpuid_data0[4] = { 0, 0, 0, 0 };
+        __cpuid(cpuid_data0, 0);
+        if( cpuid_data0[0] >= 7 )
+            __cpuidex(cpuid_data7, 7, 0);
+        // the OS must save the AVX registers on context switch (OSXSAVE + XCR0 bits 1 and 2)
+        if( (cpuid_data[2] & (1<<27)) != 0 )
+            haveYMMState = (_xgetbv(0) & 6) == 6;
+        #endif
     #elif defined __GNUC__ && (defined __i386__ || defined __x86_64__)
         #ifdef __x86_64__
         asm __volatile__
@@ -149,6 +160,23 @@ struct HWFeatures
          :
          : "cc"
         );
+        int max_leaf = 0;
+        asm __volatile__
+        (
+         "xorl %%eax, %%eax\n\t"
+         "cpuid\n\t"
+         : "=a"(max_leaf)
+         :
+         : "ebx", "ecx", "edx", "cc"
+        );
+        if( max_leaf >= 7 )
+            asm __volatile__
+            (
+             "cpuid\n\t"
+             : "=a"(cpuid_data7[0]), "=b"(cpuid_data7[1]), "=c"(cpuid_data7[2]), "=d"(cpuid_data7[3])
+             : "a"(7), "c"(0)
+             : "cc"
+            );
         #else
         asm volatile
         (
@@ -160,7 +188,41 @@ struct HWFeatures
          :
          : "cc"
         );
+        int max_leaf = 0;
+        asm volatile
+        (
+         "pushl %%ebx\n\t"
+         "xorl %%eax, %%eax\n\t"
+         "cpuid\n\t"
+         "popl %%ebx\n\t"
+         : "=a"(max_leaf)
+         :
+         : "ecx", "edx", "cc"
+        );
+        if( max_leaf >= 7 )
+            asm volatile
+            (
+             "pushl %%ebx\n\t"
+             "cpuid\n\t"
+             "movl %%ebx, %%esi\n\t"
+             "popl %%ebx\n\t"
+             : "=a"(cpuid_data7[0]), "=S"(cpuid_data7[1]), "=c"(cpuid_data7[2]), "=d"(cpuid_data7[3])
+             : "a"(7), "c"(0)
+             : "cc"
+            );
         #endif
+        if( (cpuid_data[2] & (1<<27)) != 0 )
+        {
+            // xgetbv is emitted as raw bytes, since older assemblers do not know the mnemonic
+            unsigned xcr0 = 0, xcr0_hi = 0;
+            asm volatile
+            (
+             ".byte 0x0f, 0x01, 0xd0\n\t"
+             : "=a"(xcr0), "=d"(xcr0_hi)
+             : "c"(0)
+            );
+            haveYMMState = (xcr0 & 6) == 6;
+        }
     #endif
 
         f.x86_family = (cpuid_data[0] >> 8) & 15;
@@ -174,7 +236,8 @@ struct HWFeatures
             f.have[CV_CPU_SSE4_1] = (cpuid_data[2] & (1<<19)) != 0;
             f.have[CV_CPU_SSE4_2] = (cpuid_data[2] & (1<<20)) != 0;
             f.have[CV_CPU_POPCNT] = (cpuid_data[2] & (1<<23)) != 0;
-            f.have[CV_CPU_AVX]    = (cpuid_data[2] & (1<<28)) != 0;
+            f.have[CV_CPU_AVX]    = (cpuid_data[2] & (1<<28)) != 0 && haveYMMState;
+            f.have[CV_CPU_AVX2]   = (cpuid_data7[1] & (1<<5)) != 0 && f.have[CV_CPU_AVX];
         }
 
         return f;
@@ -184,7 +247,8 @@ struct HWFeatures
     bool have[MAX_FEATURE+1];
 };
 
-static HWFeatures  featuresEnabled = HWFeatures::initialize(), featuresDisabled = HWFeatures();
+static HWFeatures  hostFeatures = HWFeatures::initialize();
+static HWFeatures  featuresEnabled = hostFeatures, featuresDisabled = HWFeatures();
 static HWFeatures* currentFeatures = &featuresEnabled;
 
 bool checkHardwareSupport(int feature)
@@ -206,7 +270,7 @@ IPPInitializer ippInitializer;
 volatile bool useOptimizedFlag = true;
 #endif
 
-volatile bool USE_SSE2 = false;
+volatile bool USE_SSE2 = featuresEnabled.have[CV_CPU_SSE2];
 
 void setUseOptimized( bool flag )
 {
@@ -215,6 +279,13 @@ void setUseOptimized( bool flag )
     USE_SSE2 = currentFeatures->have[CV_CPU_SSE2];
 }
 
+void setUseHardwareFeature( int feature, bool flag )
+{
+    CV_Assert( 0 <= feature && feature <= CV_HARDWARE_MAX_FEATURE );
+    featuresEnabled.have[feature] = flag && hostFeatures.have[feature];
+    USE_SSE2 = currentFeatures->have[CV_CPU_SSE2];
+}
+
 bool useOptimized(void)
 {
     return useOptimizedFlag;
@@ -339,18 +410,14 @@ int getNumThreads(void)
     return numThreads;
 }
 
-void setNumThreads( int
-#ifdef _OPENMP
-                             threads
-#endif
-                  )
+void setNumThreads( int threads )
 {
     if( !numProcs )
     {
 #ifdef _OPENMP
         numProcs = omp_get_num_procs();
 #else
-        numProcs = 1;
+        numProcs = std::max(getNumberOfCPUs(), 1);
 #endif
     }
 
@@ -361,16 +428,480 @@ void setNumThreads( int
         threads = MIN( threads, numProcs );
 
     numThreads = threads;
-#else
+#elif defined HAVE_TBB
+    (void)threads;
     numThreads = 1;
+#else
+    numThreads = threads <= 0 ? numProcs : threads;
+#endif
+}
+
+
+/****************************************************************************************\
+*                          Mutex and the built-in thread pool                           *
+\****************************************************************************************/
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+
+Mutex::Mutex()
+{
+    CRITICAL_SECTION* cs = new CRITICAL_SECTION;
+    InitializeCriticalSection(cs);
+    impl = cs;
+}
+
+Mutex::~Mutex()
+{
+    DeleteCriticalSection((CRITICAL_SECTION*)impl);
+    delete (CRITICAL_SECTION*)impl;
+}
+
+void Mutex::lock() { EnterCriticalSection((CRITICAL_SECTION*)impl); }
+bool Mutex::trylock() { return TryEnterCriticalSection((CRITICAL_SECTION*)impl) != 0; }
+void Mutex::unlock() { LeaveCriticalSection((CRITICAL_SECTION*)impl); }
+
+#else
+
+Mutex::Mutex()
+{
+    pthread_mutex_t* m = new pthread_mutex_t;
+    pthread_mutex_init(m, 0);
+    impl = m;
+}
+
+Mutex::~Mutex()
+{
+    pthread_mutex_destroy((pthread_mutex_t*)impl);
+    delete (pthread_mutex_t*)impl;
+}
+
+void Mutex::lock() { pthread_mutex_lock((pthread_mutex_t*)impl); }
+bool Mutex::trylock() { return pthread_mutex_trylock((pthread_mutex_t*)impl) == 0; }
+void Mutex::unlock() { pthread_mutex_unlock((pthread_mutex_t*)impl); }
+
+#endif
+
+#if !defined HAVE_TBB && !defined HAVE_THREADING_FRAMEWORK
+
+ParallelLoopBody::~ParallelLoopBody() {}
+
+// auto-reset event: wait() blocks until somebody calls set() and then resets the event
+#if defined WIN32 || defined _WIN32 || defined WINCE
+struct ThreadEvent
+{
+    ThreadEvent() { handle = CreateEvent(0, FALSE, FALSE, 0); }
+    ~ThreadEvent() { CloseHandle(handle); }
+    void set() { SetEvent(handle); }
+    void wait() { WaitForSingleObject(handle, INFINITE); }
+
+    HANDLE handle;
+};
+#else
+struct ThreadEvent
+{
+    ThreadEvent() : signaled(false)
+    {
+        pthread_mutex_init(&mutex, 0);
+        pthread_cond_init(&cond, 0);
+    }
+    ~ThreadEvent()
+    {
+        pthread_cond_destroy(&cond);
+        pthread_mutex_destroy(&mutex);
+    }
+    void set()
+    {
+        pthread_mutex_lock(&mutex);
+        signaled = true;
+        pthread_cond_signal(&cond);
+        pthread_mutex_unlock(&mutex);
+    }
+    void wait()
+    {
+        pthread_mutex_lock(&mutex);
+        while( !signaled )
+            pthread_cond_wait(&cond, &mutex);
+        signaled = false;
+        pthread_mutex_unlock(&mutex);
+    }
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool signaled;
+};
+#endif
+
+// thread-local index of the current thread inside the parallel region (+1), 0 outside of it
+#if defined WIN32 || defined _WIN32 || defined WINCE
+#ifdef WINCE
+#	define TLS_OUT_OF_INDEXES ((DWORD)0xFFFFFFFF)
+#endif
+static DWORD tlsRegionKey = TLS_OUT_OF_INDEXES;
+
+static void initRegionKey()
+{
+    if( tlsRegionKey == TLS_OUT_OF_INDEXES )
+        tlsRegionKey = TlsAlloc();
+}
+
+static size_t getRegionIdx()
+{
+    return tlsRegionKey != TLS_OUT_OF_INDEXES ? (size_t)TlsGetValue(tlsRegionKey) : 0;
+}
+
+static void setRegionIdx(size_t idx)
+{
+    TlsSetValue(tlsRegionKey, (void*)idx);
+}
+#else
+static pthread_key_t tlsRegionKey = 0;
+static pthread_once_t tlsRegionKeyOnce = PTHREAD_ONCE_INIT;
+
+static void makeRegionKey()
+{
+    int errcode = pthread_key_create(&tlsRegionKey, 0);
+    CV_Assert(errcode == 0);
+}
+
+static void initRegionKey()
+{
+    pthread_once(&tlsRegionKeyOnce, makeRegionKey);
+}
+
+static size_t getRegionIdx()
+{
+    initRegionKey();
+    return (size_t)pthread_getspecific(tlsRegionKey);
+}
+
+static void setRegionIdx(size_t idx)
+{
+    pthread_setspecific(tlsRegionKey, (void*)idx);
+}
+#endif
+
+/*
+  The parallel loop being executed by the pool. The range is split into chunks of at least
+  grainsize iterations, and the chunks are initially distributed evenly between the slots,
+  one slot per participating thread. A thread takes the chunks from the front of its own slot;
+  when it is empty, the thread steals the back half of the fullest slot. Thus the slots of the
+  threads that have not woken up yet, or have been preempted, are processed by the others.
+*/
+struct ParallelJob
+{
+    struct Slot
+    {
+        Mutex mutex;
+        int begin, end;
+    };
+
+    ParallelJob(const BlockedRange& _range, const ParallelLoopBody& _body, int _nslots)
+        : range(_range), body(&_body), nslots(_nslots), nactive(0), closed(false), failed(false)
+    {
+        enum { CHUNKS_PER_THREAD = 8 };
+        int len = range.end() - range.begin(), grain = std::max(range.grainsize(), 1);
+        nchunks = std::min((len + grain - 1)/grain, nslots*CHUNKS_PER_THREAD);
+        nslots = std::min(nslots, nchunks);
+        slots = new Slot[nslots];
+        for( int i = 0; i < nslots; i++ )
+        {
+            slots[i].begin = (int)((int64)nchunks*i/nslots);
+            slots[i].end = (int)((int64)nchunks*(i+1)/nslots);
+        }
+    }
+
+    ~ParallelJob() { delete[] slots; }
+
+    bool popChunk(int idx, int& chunk)
+    {
+        Slot& slot = slots[idx];
+        AutoLock lock(slot.mutex);
+        if( slot.begin >= slot.end )
+            return false;
+        chunk = slot.begin++;
+        return true;
+    }
+
+    bool steal(int idx)
+    {
+        for(;;)
+        {
+            int victim = -1, maxRemaining = 0;
+            for( int i = 0; i < nslots; i++ )
+            {
+                int remaining = slots[i].end - slots[i].begin;
+                if( i != idx && remaining > maxRemaining )
+                    victim = i, maxRemaining = remaining;
+            }
+            if( victim < 0 )
+                return false;
+
+            int b, e;
+            {
+            Slot& vslot = slots[victim];
+            AutoLock lock(vslot.mutex);
+            if( vslot.begin >= vslot.end )
+                continue;
+            e = vslot.end;
+            b = vslot.end = vslot.end - (vslot.end - vslot.begin + 1)/2;
+            }
+
+            Slot& slot = slots[idx];
+            AutoLock lock(slot.mutex);
+            slot.begin = b;
+            slot.end = e;
+            return true;
+        }
+    }
+
+    void run(int idx)
+    {
+        size_t prevIdx = getRegionIdx();
+        setRegionIdx(idx + 1);
+        int64 len = range.end() - range.begin();
+        try
+        {
+            for(;;)
+            {
+                int chunk;
+                if( failed || (!popChunk(idx, chunk) && !(steal(idx) && popChunk(idx, chunk))) )
+                    break;
+                int b = range.begin() + (int)(len*chunk/nchunks);
+                int e = range.begin() + (int)(len*(chunk+1)/nchunks);
+                (*body)(BlockedRange(b, e, range.grainsize()));
+            }
+        }
+        catch(const cv::Exception& e)
+        {
+            setError(e);
+        }
+        catch(const std::exception& e)
+        {
+            setError(cv::Exception(CV_StsError, e.what(), "parallel_for_", __FILE__, __LINE__));
+        }
+        catch(...)
+        {
+            setError(cv::Exception(CV_StsError, "Unknown exception", "parallel_for_", __FILE__, __LINE__));
+        }
+        setRegionIdx(prevIdx);
+    }
+
+    void setError(const cv::Exception& e)
+    {
+        AutoLock lock(errorMutex);
+        if( !failed )
+            error = e;
+        failed = true;
+    }
+
+    BlockedRange range;
+    const ParallelLoopBody* body;
+    int nslots, nchunks;
+    Slot* slots;
+    int nactive;
+    bool closed;
+    volatile bool failed;
+    Mutex errorMutex;
+    cv::Exception error;
+};
+
+class ThreadPool
+{
+public:
+    ThreadPool() : job(0), stopping(false) {}
+
+    ~ThreadPool()
+    {
+        {
+        AutoLock lock(mutex);
+        stopping = true;
+        }
+        for( size_t i = 0; i < workers.size(); i++ )
+            workers[i]->wakeup.set();
+#if !(defined WIN32 || defined _WIN32 || defined WINCE)
+        // on Windows the threads are terminated by the system at the process exit,
+        // and they can not be joined from the DLL detach notification anyway.
+        for( size_t i = 0; i < workers.size(); i++ )
+        {
+            pthread_join(workers[i]->thread, 0);
+            delete workers[i];
+        }
 #endif
+    }
+
+    void run(const BlockedRange& range, const ParallelLoopBody& body, int nthreads)
+    {
+        // nested loops and the loops started by other threads while the pool is busy are run serially
+        if( getRegionIdx() != 0 || !busy.trylock() )
+        {
+            body(range);
+            return;
+        }
+
+        ParallelJob* _job = 0;
+        try
+        {
+            _job = new ParallelJob(range, body, nthreads);
+            startWorkers(_job->nslots - 1);
+        }
+        catch(...)
+        {
+            delete _job;
+            busy.unlock();
+            throw;
+        }
+
+        {
+        AutoLock lock(mutex);
+        job = _job;
+        }
+        for( int i = 0; i < _job->nslots - 1; i++ )
+            workers[i]->wakeup.set();
+
+        _job->run(0);
+
+        bool wait;
+        {
+        AutoLock lock(mutex);
+        _job->closed = true;
+        wait = _job->nactive > 0;
+        }
+        if( wait )
+            done.wait();
+
+        {
+        AutoLock lock(mutex);
+        job = 0;
+        }
+        busy.unlock();
+
+        bool failed = _job->failed;
+        cv::Exception error = _job->error;
+        delete _job;
+        if( failed )
+            throw error;
+    }
+
+protected:
+    struct Worker
+    {
+        ThreadPool* pool;
+        int idx;
+        ThreadEvent wakeup;
+#if defined WIN32 || defined _WIN32 || defined WINCE
+        HANDLE thread;
+#else
+        pthread_t thread;
+#endif
+    };
+
+    void startWorkers(int count)
+    {
+        while( (int)workers.size() < count )
+        {
+            Worker* w = new Worker;
+            w->pool = this;
+            w->idx = (int)workers.size() + 1;
+#if defined WIN32 || defined _WIN32 || defined WINCE
+            w->thread = CreateThread(0, 0, workerProc, w, 0, 0);
+            bool ok = w->thread != 0;
+#else
+            bool ok = pthread_create(&w->thread, 0, workerProc, w) == 0;
+#endif
+            if( !ok )
+            {
+                delete w;
+                CV_Error(CV_StsError, "Can not create a worker thread");
+            }
+            workers.push_back(w);
+        }
+    }
+
+    void workerLoop(Worker* w)
+    {
+        for(;;)
+        {
+            w->wakeup.wait();
+
+            ParallelJob* _job;
+            {
+            AutoLock lock(mutex);
+            if( stopping )
+                break;
+            _job = job;
+            // the job may have been finished by the other threads before this one woke up
+            if( !_job || _job->closed || w->idx >= _job->nslots )
+                continue;
+            _job->nactive++;
+            }
+
+            _job->run(w->idx);
+
+            AutoLock lock(mutex);
+            if( --_job->nactive == 0 && _job->closed )
+                done.set();
+        }
+    }
+
+#if defined WIN32 || defined _WIN32 || defined WINCE
+    static DWORD WINAPI workerProc(LPVOID arg)
+#else
+    static void* workerProc(void* arg)
+#endif
+    {
+        Worker* w = (Worker*)arg;
+        w->pool->workerLoop(w);
+        return 0;
+    }
+
+    Mutex mutex, busy;
+    ThreadEvent done;
+    ParallelJob* job;
+    bool stopping;
+    std::vector<Worker*> workers;
+};
+
+static ThreadPool* threadPool = 0;
+static Mutex threadPoolInitMutex;
+
+struct ThreadPoolCleaner
+{
+    ~ThreadPoolCleaner() { delete threadPool; threadPool = 0; }
+};
+
+static ThreadPoolCleaner threadPoolCleaner;
+
+void parallel_for_( const BlockedRange& range, const ParallelLoopBody& body )
+{
+    int nthreads = getNumThreads();
+    if( nthreads <= 1 || range.end() - range.begin() <= std::max(range.grainsize(), 1) )
+    {
+        if( range.end() > range.begin() )
+            body(range);
+        return;
+    }
+
+    if( !threadPool )
+    {
+        AutoLock lock(threadPoolInitMutex);
+        if( !threadPool )
+        {
+            initRegionKey();
+            threadPool = new ThreadPool;
+        }
+    }
+    threadPool->run(range, body, nthreads);
 }
 
+#endif
 
 int getThreadNum(void)
 {
 #ifdef _OPENMP
     return omp_get_thread_num();
+#elif !defined HAVE_TBB && !defined HAVE_THREADING_FRAMEWORK
+    size_t idx = getRegionIdx();
+    return idx > 0 ? (int)idx - 1 : 0;
 #else
     return 0;
 #endif
@@ -1403,3 +1403,180 @@ INSTANTIATE_TEST_CASE_P(Core_CartToPolarToCart, ElemWiseTest, ::testing::Values(
 
 
 
+
+static void runArithmOps(const Mat& a, const Mat& b, vector<Mat>& results)
+{
+    results.clear();
+    Mat c;
+    add(a, b, c); results.push_back(c.clone());
+    subtract(a, b, c); results.push_back(c.clone());
+    absdiff(a, b, c); results.push_back(c.clone());
+    min(a, b, c); results.push_back(c.clone());
+    max(a, b, c); results.push_back(c.clone());
+    addWeighted(a, 0.3, b, 1.7, -5.5, c); results.push_back(c.clone());
+    for( int cmpop = CMP_EQ; cmpop <= CMP_NE; cmpop++ )
+    {
+        compare(a, b, c, cmpop);
+        results.push_back(c.clone());
+    }
+    bitwise_and(a, b, c); results.push_back(c.clone());
+    bitwise_or(a, b, c); results.push_back(c.clone());
+    bitwise_xor(a, b, c); results.push_back(c.clone());
+    bitwise_not(a, c); results.push_back(c.clone());
+}
+
+TEST(Core_ArithmDispatch, same_results_for_all_isa)
+{
+    RNG& rng = theRNG();
+    const int features[] = { CV_CPU_AVX2, CV_CPU_SSE2 };
+
+    for( int depth = CV_8U; depth <= CV_64F; depth++ )
+    {
+        Mat a(13, 67, CV_MAKETYPE(depth, 1)), b(a.size(), a.type());
+        rng.fill(a, RNG::UNIFORM, Scalar::all(-1000), Scalar::all(1000));
+        rng.fill(b, RNG::UNIFORM, Scalar::all(-1000), Scalar::all(1000));
+        b.row(3).setTo(Scalar::all(7));
+        a.row(3).setTo(Scalar::all(7));
+
+        vector<Mat> ref, dst;
+        setUseOptimized(false);
+        runArithmOps(a, b, ref);
+        setUseOptimized(true);
+
+        for( int k = 0; k <= (int)(sizeof(features)/sizeof(features[0])); k++ )
+        {
+            // k-th step disables one more instruction set, so that each implementation is run
+            runArithmOps(a, b, dst);
+            ASSERT_EQ(ref.size(), dst.size());
+            for( size_t i = 0; i < ref.size(); i++ )
+                EXPECT_EQ(0, norm(ref[i], dst[i], NORM_INF)) << "depth=" << depth << ", op=" << i << ", step=" << k;
+            if( k < (int)(sizeof(features)/sizeof(features[0])) )
+                setUseHardwareFeature(features[k], false);
+        }
+
+        setUseHardwareFeature(CV_CPU_AVX2, true);
+        setUseHardwareFeature(CV_CPU_SSE2, true);
+    }
+}
+
+static int normHammingNaive(const uchar* a, const uchar* b, int n, int cellSize)
+{
+    int result = 0;
+    for( int i = 0; i < n; i++ )
+    {
+        int x = a[i] ^ b[i];
+        for( int j = 0; j < 8; j += cellSize )
+            result += ((x >> j) & ((1 << cellSize) - 1)) != 0;
+    }
+    return result;
+}
+
+TEST(Core_NormHamming, same_results_for_all_isa)
+{
+    RNG& rng = theRNG();
+    const int features[] = { CV_CPU_AVX2, CV_CPU_POPCNT };
+    const int nfeatures = (int)(sizeof(features)/sizeof(features[0]));
+    const int lengths[] = { 0, 1, 7, 8, 16, 31, 32, 33, 64, 100, 256 };
+
+    for( int k = 0; k <= nfeatures; k++ )
+    {
+        // k-th step disables one more instruction set, so that each implementation is run
+        for( size_t l = 0; l < sizeof(lengths)/sizeof(lengths[0]); l++ )
+        {
+            int n = lengths[l], count = 11;
+            Mat a(1, n + 1, CV_8U), b(count, n + 5, CV_8U);
+            rng.fill(a, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+            rng.fill(b, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+            b.row(2) = Scalar::all(0);
+            Mat b3 = b.row(3).colRange(0, n + 1);
+            a.copyTo(b3);
+
+            for( int cellSize = 1; cellSize <= 4; cellSize *= 2 )
+            {
+                vector<int> dist(count, -1);
+                batchNormHamming(a.data, b.data, b.step, n, count, &dist[0], cellSize);
+                for( int j = 0; j < count; j++ )
+                {
+                    int expected = normHammingNaive(a.data, b.ptr(j), n, cellSize);
+                    EXPECT_EQ(expected, dist[j]) << "n=" << n << ", cellSize=" << cellSize << ", row=" << j << ", step=" << k;
+                    EXPECT_EQ(expected, cellSize == 1 ? normHamming(a.data, b.ptr(j), n) :
+                              normHamming(a.data, b.ptr(j), n, cellSize)) << "n=" << n << ", step=" << k;
+                }
+            }
+        }
+        if( k < nfeatures )
+            setUseHardwareFeature(features[k], false);
+    }
+
+    setUseHardwareFeature(CV_CPU_AVX2, true);
+    setUseHardwareFeature(CV_CPU_POPCNT, true);
+}
+
+static void runReductions(const Mat& src, const Mat& mask, vector<double>& results)
+{
+    results.clear();
+    Scalar s = sum(src), m = mean(src, mask), sdv;
+    results.insert(results.end(), &s[0], &s[0] + 4);
+    results.insert(results.end(), &m[0], &m[0] + 4);
+    meanStdDev(src, m, sdv, mask);
+    results.insert(results.end(), &m[0], &m[0] + 4);
+    results.insert(results.end(), &sdv[0], &sdv[0] + 4);
+    for( int normType = NORM_INF; normType <= NORM_L2; normType *= 2 )
+    {
+        results.push_back(norm(src, normType, mask));
+        results.push_back(norm(src, src.t().t() + Scalar::all(1), normType, mask));
+    }
+
+    Mat src1 = src.reshape(1);
+    double minVal = 0, maxVal = 0;
+    Point minLoc, maxLoc;
+    minMaxLoc(src1, &minVal, &maxVal, &minLoc, &maxLoc);
+    results.push_back(minVal); results.push_back(maxVal);
+    results.push_back(minLoc.x); results.push_back(minLoc.y);
+    results.push_back(maxLoc.x); results.push_back(maxLoc.y);
+    results.push_back(countNonZero(src1));
+
+    Mat r0, r1;
+    reduce(src, r0, 0, CV_REDUCE_SUM, CV_64F);
+    reduce(src, r1, 1, CV_REDUCE_MAX);
+    results.push_back(sum(r0)[0]);
+    results.push_back(sum(r1)[0]);
+}
+
+TEST(Core_Reduce, parallel_results_do_not_depend_on_threads)
+{
+    RNG rng(0x4c1d);
+    cvtest::ThreadsGuard threadsGuard;
+    const int types[] = { CV_8UC1, CV_16SC3, CV_32FC1, CV_64FC2 };
+
+    for( size_t t = 0; t < sizeof(types)/sizeof(types[0]); t++ )
+    {
+        // a non-continuous array with several blocks per row and many rows
+        Mat big(613, 5031, types[t]), mask(600, 5000, CV_8U);
+        rng.fill(big, RNG::UNIFORM, Scalar::all(-100), Scalar::all(100));
+        rng.fill(mask, RNG::UNIFORM, Scalar::all(0), Scalar::all(2));
+        Mat src = big(Rect(7, 3, 5000, 600));
+
+        // the sequential reference for the sum
+        Scalar ref;
+        for( int y = 0; y < src.rows; y++ )
+            ref += sum(src.row(y));
+
+        vector<double> results0, results;
+        for( int nthreads = 1; nthreads <= 4; nthreads++ )
+        {
+            setNumThreads(nthreads);
+            runReductions(src, mask, results);
+            if( nthreads == 1 )
+            {
+                results0 = results;
+                for( int k = 0; k < 4; k++ )
+                    EXPECT_NEAR(ref[k], results0[k], 1e-9*src.total()*100) << "type=" << types[t];
+                continue;
+            }
+            ASSERT_EQ(results0.size(), results.size());
+            for( size_t i = 0; i < results.size(); i++ )
+                EXPECT_EQ(results0[i], results[i]) << "type=" << types[t] << ", i=" << i << ", nthreads=" << nthreads;
+        }
+    }
+}
@@ -828,3 +828,29 @@ TEST(Core_DFT, accuracy) { CxCore_DFTTest test; test.safe_run(); }
 TEST(Core_MulSpectrums, accuracy) { CxCore_MulSpectrumsTest test; test.safe_run(); }
 
 
+
+TEST(Core_DFT, cached_plans)
+{
+    // more sizes than the plan cache holds, so that the plans get evicted and rebuilt
+    const int nsizes = 40;
+    vector<Mat> src(nsizes), spectrum(nsizes);
+    RNG rng(0x12345);
+
+    for( int i = 0; i < nsizes; i++ )
+    {
+        int depth = i % 2 ? CV_64F : CV_32F;
+        src[i].create(rng.uniform(8, 300), rng.uniform(8, 300), depth);
+        rng.fill(src[i], RNG::UNIFORM, Scalar::all(-1), Scalar::all(1));
+        dft(src[i], spectrum[i]);
+    }
+
+    for( int i = nsizes - 1; i >= 0; i-- )
+    {
+        Mat spectrum2, inv;
+        dft(src[i], spectrum2);
+        EXPECT_EQ(0., norm(spectrum[i], spectrum2, NORM_INF)) << "size=" << src[i].cols << "x" << src[i].rows;
+
+        idft(spectrum2, inv, DFT_SCALE);
+        EXPECT_LE(norm(src[i], inv, NORM_INF), src[i].depth() == CV_32F ? 1e-4 : 1e-10) << "size=" << src[i].cols << "x" << src[i].rows;
+    }
+}
@@ -91,7 +91,7 @@ protected:
             {-1000000, 1000000}, {-10, 10}, {-10, 10}};
         RNG& rng = ts->get_rng();
         RNG rng0;
-        test_case_count = 2;
+        test_case_count = 3;
         int progress = 0;
         MemStorage storage(cvCreateMemStorage(0));
         
@@ -102,7 +102,7 @@ protected:
             
             cvClearMemStorage(storage);
             
-            string filename = tempfile(idx % 2 ? ".yml" : ".xml");
+            string filename = tempfile(idx == 2 ? ".bin" : idx % 2 ? ".yml" : ".xml");
             
             FileStorage fs(filename.c_str(), FileStorage::WRITE);
             
@@ -376,3 +376,217 @@ protected:
 };
 
 TEST(Core_InputOutput, write_read_consistency) { Core_IOTest test; test.safe_run(); }
+
+TEST(Core_InputOutput, binary_storage_zero_copy)
+{
+    RNG rng(0x2b5d);
+    string filename = cv::tempfile(".bin");
+
+    Mat m(37, 53, CV_32FC3), big(61, 70, CV_16S), mnd;
+    int sz[] = { 4, 5, 6 };
+    mnd.create(3, sz, CV_8UC2);
+    rng.fill(m, RNG::UNIFORM, Scalar::all(-100), Scalar::all(100));
+    rng.fill(big, RNG::UNIFORM, Scalar::all(-30000), Scalar::all(30000));
+    rng.fill(mnd, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    Mat roi = big(Rect(3, 5, 40, 31));
+    vector<int> vec(1000);
+    for( size_t i = 0; i < vec.size(); i++ )
+        vec[i] = (int)rng;
+
+    {
+        FileStorage fs(filename, FileStorage::WRITE);
+        fs << "m" << m << "roi" << roi << "mnd" << mnd;
+        fs << "vec" << "[:";
+        fs.writeRaw("i", (const uchar*)&vec[0], vec.size()*sizeof(vec[0]));
+        fs << "]";
+        fs << "name" << "binary storage" << "pi" << CV_PI;
+        fs << "list" << "[" << 1 << 2.5 << "x" << "{" << "a" << -1 << "}" << "]";
+    }
+
+    Mat m2, m3, roi2, mnd2;
+    {
+        FileStorage fs(filename, FileStorage::READ);
+        ASSERT_TRUE(fs.isOpened());
+
+        fs["m"] >> m2;
+        fs["m"] >> m3;
+        fs["roi"] >> roi2;
+        fs["mnd"] >> mnd2;
+
+        // the matrices reference the aligned data in the mapped file
+        EXPECT_EQ(m2.data, m3.data);
+        EXPECT_EQ(0, (int)((size_t)m2.data % 16));
+        EXPECT_EQ(0, (int)((size_t)roi2.data % 16));
+
+        vector<int> vec2;
+        fs["vec"] >> vec2;
+        EXPECT_TRUE(vec == vec2);
+        EXPECT_EQ("binary storage", (string)fs["name"]);
+        EXPECT_EQ(CV_PI, (double)fs["pi"]);
+
+        FileNode list = fs["list"];
+        ASSERT_EQ(FileNode::SEQ, list.type());
+        ASSERT_EQ(4u, list.size());
+        EXPECT_EQ(1, (int)list[0]);
+        EXPECT_EQ(2.5, (double)list[1]);
+        EXPECT_EQ("x", (string)list[2]);
+        EXPECT_EQ(-1, (int)list[3]["a"]);
+
+        // the matrix data can be navigated as a regular sequence
+        FileNode data = fs["m"]["data"];
+        ASSERT_EQ(FileNode::SEQ, data.type());
+        ASSERT_EQ(m.total()*m.channels(), data.size());
+
+        const float* mptr = m.ptr<float>();
+        float fbuf[6];
+        double dbuf[6];
+        FileNodeIterator it = data.begin();
+        it.readRaw("f", (uchar*)fbuf, 6);
+        it.readRaw("d", (uchar*)dbuf, 6);
+        for( int i = 0; i < 6; i++ )
+        {
+            EXPECT_EQ(mptr[i], fbuf[i]);
+            EXPECT_EQ((double)mptr[i + 6], dbuf[i]);
+        }
+        EXPECT_EQ(mptr[12], (float)*it);
+        EXPECT_EQ(mptr[5], (float)data[5]);
+        EXPECT_EQ(mptr[data.size() - 1], (float)data[(int)data.size() - 1]);
+
+        // the element access does not replace the matrix data, so it is still read without copying
+        Mat m5;
+        fs["m"] >> m5;
+        EXPECT_EQ(m2.data, m5.data);
+    }
+
+    // the matrices outlive the storage
+    EXPECT_EQ(0, norm(m, m2, NORM_INF));
+    EXPECT_EQ(0, norm(roi, roi2, NORM_INF));
+    EXPECT_EQ(0, norm(mnd, mnd2, NORM_INF));
+
+    // the changes in the read matrices do not affect the file
+    m2.setTo(Scalar::all(0));
+    Mat m4;
+    FileStorage(filename, FileStorage::READ)["m"] >> m4;
+    EXPECT_EQ(0, norm(m, m4, NORM_INF));
+    EXPECT_EQ(0, norm(m3, Mat::zeros(m3.size(), m3.type()), NORM_INF));
+
+    m2.release();
+    m3.release();
+    m4.release();
+    roi2.release();
+    mnd2.release();
+    remove(filename.c_str());
+}
+
+TEST(Core_InputOutput, yaml_streaming_read)
+{
+    RNG rng(0x7a31);
+    string filename = cv::tempfile(".yml");
+    const int n = 3000;
+
+    vector<Point2f> pts(n);
+    vector<int> vec(777);
+    for( int i = 0; i < n; i++ )
+        pts[i] = Point2f(rng.uniform(0.f, 640.f), rng.uniform(0.f, 480.f));
+    for( size_t i = 0; i < vec.size(); i++ )
+        vec[i] = (int)rng;
+
+    {
+        FileStorage fs(filename, FileStorage::WRITE);
+        fs << "count" << n;
+        fs << "keypoints" << "[";
+        for( int i = 0; i < n; i++ )
+        {
+            fs << "{" << "x" << pts[i].x << "y" << pts[i].y << "id" << i;
+            if( i % 10 == 0 )
+                fs << "tags" << "[" << "corner" << i/10 << "]";
+            fs << "}";
+        }
+        fs << "]";
+        fs << "vec" << "[";
+        fs.writeRaw("i", (const uchar*)&vec[0], vec.size()*sizeof(vec[0]));
+        fs << "]";
+        fs << "tail" << "the end";
+    }
+
+    FileStorage fs(filename, FileStorage::READ + FileStorage::STREAM);
+    ASSERT_TRUE(fs.isOpened());
+    EXPECT_EQ(n, (int)fs["count"]);
+    EXPECT_EQ("the end", (string)fs["tail"]);
+
+    FileNode kpts = fs["keypoints"];
+    ASSERT_EQ(FileNode::SEQ, kpts.type());
+    ASSERT_EQ((size_t)n, kpts.size());
+
+    int i = 0;
+    for( FileNodeIterator it = kpts.begin(); it != kpts.end(); ++it, i++ )
+    {
+        FileNode kp = *it;
+        ASSERT_EQ(i, (int)kp["id"]);
+        EXPECT_EQ(pts[i].x, (float)kp["x"]);
+        EXPECT_EQ(pts[i].y, (float)kp["y"]);
+        if( i % 10 == 0 )
+        {
+            ASSERT_EQ(2u, kp["tags"].size());
+            EXPECT_EQ("corner", (string)kp["tags"][0]);
+            EXPECT_EQ(i/10, (int)kp["tags"][1]);
+        }
+        else
+            EXPECT_TRUE(kp["tags"].empty());
+    }
+    EXPECT_EQ(n, i);
+
+    // random access, including going backwards
+    EXPECT_EQ(n - 1, (int)kpts[n - 1]["id"]);
+    EXPECT_EQ(17, (int)kpts[17]["id"]);
+    EXPECT_EQ(pts[18].x, (float)kpts[18]["x"]);
+    FileNodeIterator it = kpts.end();
+    --it;
+    EXPECT_EQ(n - 1, (int)(*it)["id"]);
+    it -= 100;
+    EXPECT_EQ(n - 101, (int)(*it)["id"]);
+
+    // the sequence looks empty to the C functions that access it directly
+    CvFileNode* kpts_node = cvGetFileNodeByName(*fs, 0, "keypoints");
+    ASSERT_TRUE(kpts_node != 0);
+    EXPECT_EQ(0, kpts_node->data.seq->total);
+    EXPECT_TRUE(cvGetSeqElem(kpts_node->data.seq, 0) == 0);
+    CvSeqReader reader;
+    cvStartReadSeq(kpts_node->data.seq, &reader);
+    EXPECT_EQ((size_t)n, kpts.size());
+
+    vector<int> vec2;
+    fs["vec"] >> vec2;
+    EXPECT_TRUE(vec == vec2);
+
+    // the C API reads the whole sequence at once
+    CvFileNode* vec_node = cvGetFileNodeByName(*fs, 0, "vec");
+    ASSERT_TRUE(vec_node != 0);
+    vector<int> vec3(vec.size());
+    cvReadRawData(*fs, vec_node, &vec3[0], "i");
+    EXPECT_TRUE(vec == vec3);
+
+    fs.release();
+    remove(filename.c_str());
+}
+
+TEST(Core_InputOutput, binary_storage_rejects_append)
+{
+    string filename = cv::tempfile(".bin");
+    Mat m(10, 12, CV_8UC1, Scalar::all(7)), m2;
+    {
+        FileStorage fs(filename, FileStorage::WRITE);
+        fs << "m" << m;
+    }
+
+    // the binary storages are written from scratch only; the existing file stays intact
+    EXPECT_THROW(FileStorage(filename, FileStorage::APPEND), cv::Exception);
+    EXPECT_THROW(FileStorage(filename + ".gz", FileStorage::WRITE), cv::Exception);
+
+    FileStorage fs(filename, FileStorage::READ);
+    ASSERT_TRUE(fs.isOpened());
+    fs["m"] >> m2;
+    EXPECT_EQ(0, norm(m, m2, NORM_INF));
+    fs.release();
+    remove(filename.c_str());
+}
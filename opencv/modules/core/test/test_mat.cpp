@@ -821,4 +821,81 @@ TEST(Core_PCA, accuracy) { Core_PCATest test; test.safe_run(); }
 TEST(Core_Reduce, accuracy) { Core_ReduceTest test; test.safe_run(); }
 TEST(Core_Array, basic_operations) { Core_ArrayOpTest test; test.safe_run(); }
 
+TEST(Core_PoolMatAllocator, reuse_and_trim)
+{
+    PoolMatAllocator pool;
+    {
+        Mat a, b;
+        a.allocator = b.allocator = &pool;
+        a.create(480, 640, CV_8UC3);
+        b.create(480, 640, CV_8UC3);
+        uchar* data = a.data;
+        a.setTo(Scalar::all(7));
+        a.release();
+
+        // the buffer of the same size class is taken from the pool
+        a.create(479, 641, CV_8UC3);
+        EXPECT_EQ(data, a.data);
+        EXPECT_TRUE(a.isContinuous());
+        a.setTo(Scalar::all(1));
+        EXPECT_EQ(1., norm(a, NORM_INF));
+
+        PoolMatAllocator::Stats stats = pool.getStats();
+        EXPECT_EQ(1, stats.hits);
+        EXPECT_EQ(2, stats.misses);
+        EXPECT_EQ(0u, stats.blocksHeld);
+    }
+
+    PoolMatAllocator::Stats stats = pool.getStats();
+    EXPECT_EQ(2u, stats.blocksHeld);
+    EXPECT_LE((size_t)480*640*3*2, stats.bytesHeld);
+    EXPECT_EQ(stats.bytesHeld, pool.trim());
+    EXPECT_EQ(0u, pool.getStats().bytesHeld);
+}
+
+TEST(Core_PoolMatAllocator, default_allocator)
+{
+    PoolMatAllocator pool;
+    MatAllocator* prev = getDefaultMatAllocator();
+    setDefaultMatAllocator(&pool);
+    {
+        Mat m(100, 100, CV_32FC2, Scalar(1, 2)), m2 = m.clone();
+        EXPECT_EQ(&pool, m.allocator);
+        EXPECT_EQ(0., norm(m, m2, NORM_INF));
+        int sz[] = { 3, 4, 5 };
+        Mat nd(3, sz, CV_16S, Scalar::all(3));
+        EXPECT_EQ(nd.step[0], (size_t)4*5*2);
+        EXPECT_EQ(3*4*5*3., sum(nd)[0]);
+    }
+    setDefaultMatAllocator(prev);
+    EXPECT_EQ(3, (int)pool.getStats().misses);
+    EXPECT_EQ(3u, pool.getStats().blocksHeld);
+}
 
+TEST(Core_PoolMatAllocator, default_allocator_is_not_kept_after_release)
+{
+    MatAllocator* prev = getDefaultMatAllocator();
+    Mat m, explicitAlloc;
+    PoolMatAllocator other;
+    explicitAlloc.allocator = &other;
+    {
+        PoolMatAllocator pool;
+        setDefaultMatAllocator(&pool);
+        m.create(10, 10, CV_8U);
+        Mat copy = m;
+        explicitAlloc.create(10, 10, CV_8U);
+        EXPECT_EQ(&pool, m.allocator);
+        EXPECT_EQ(&other, explicitAlloc.allocator);
+        setDefaultMatAllocator(prev);
+        copy.release();
+        m.release();
+        EXPECT_TRUE(m.allocator == 0);
+        EXPECT_EQ(1u, pool.getStats().blocksHeld);
+    }
+    // the pool is gone; the header must not refer to it any more
+    m.create(20, 20, CV_8U);
+    EXPECT_EQ(prev, m.allocator);
+    explicitAlloc.release();
+    explicitAlloc.create(20, 20, CV_8U);
+    EXPECT_EQ(&other, explicitAlloc.allocator);
+}
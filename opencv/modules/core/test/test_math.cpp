@@ -2369,6 +2369,36 @@ TEST(Core_SVBkSb, accuracy) { Core_SVBkSbTest test; test.safe_run(); }
 TEST(Core_Trace, accuracy) { Core_TraceTest test; test.safe_run(); }
 TEST(Core_SolvePoly, accuracy) { Core_SolvePolyTest test; test.safe_run(); }
 
+TEST(Core_GEMM, packed_panels)
+{
+    // sizes that go through the blocked code path: ragged edges, several K-slices, tall-skinny
+    const int sizes[][3] = { {67, 131, 45}, {300, 9, 513}, {2000, 16, 24}, {9, 700, 100} };
+    RNG& rng = theRNG();
+
+    for( int t = 0; t < (int)(sizeof(sizes)/sizeof(sizes[0])); t++ )
+        for( int depth = CV_32F; depth <= CV_64F; depth++ )
+            for( int iter = 0; iter < 16; iter++ )
+            {
+                int flags = iter & 7, m = sizes[t][0], n = sizes[t][1], k = sizes[t][2];
+                Mat A = (flags & GEMM_1_T) ? Mat(k, m, depth) : Mat(m, k, depth);
+                Mat B = (flags & GEMM_2_T) ? Mat(n, k, depth) : Mat(k, n, depth);
+                Mat C = (flags & GEMM_3_T) ? Mat(n, m, depth) : Mat(m, n, depth);
+                rng.fill(A, RNG::UNIFORM, Scalar::all(-1), Scalar::all(1));
+                rng.fill(B, RNG::UNIFORM, Scalar::all(-1), Scalar::all(1));
+                rng.fill(C, RNG::UNIFORM, Scalar::all(-1), Scalar::all(1));
+                bool useC = (iter & 8) != 0;
+                double alpha = 0.7, beta = useC ? -1.3 : 0.;
+
+                Mat D, Dref;
+                gemm(A, B, alpha, useC ? C : Mat(), beta, D, flags);
+                cvtest::gemm(A, B, alpha, useC ? C : Mat(), beta, Dref, flags);
+
+                double err = norm(D, Dref, NORM_INF)/norm(Dref, NORM_INF);
+                EXPECT_LE(err, depth == CV_32F ? 1e-6 : 1e-12)
+                    << "size=" << m << "x" << n << "x" << k << ", depth=" << depth << ", flags=" << flags;
+            }
+}
+
 // TODO: eigenvv, invsqrt, cbrt, fastarctan, (round, floor, ceil(?)),
 
 /* End of file. */
@@ -885,3 +885,143 @@ void CV_OperationsTest::run( int /* start_from */)
 }
 
 TEST(Core_Array, expressions) { CV_OperationsTest test; test.safe_run(); }
+
+static void checkFusedExpr(const Mat& a, const Mat& b, const Mat& c, const Mat& d)
+{
+    Mat t1, t2, ref, dst;
+    
+    // abs(a*alpha + b*beta - c)
+    addWeighted(a, 0.75, b, -1.5, 0, t1);
+    absdiff(t1, c, ref);
+    dst = abs(a*0.75 + b*(-1.5) - c);
+    EXPECT_EQ(0, norm(ref, dst, NORM_INF));
+    
+    Rect roi(a.cols/3, a.rows/4, a.cols/2, a.rows/2);
+    dst = abs(a*0.75 + b*(-1.5) - c)(roi);
+    EXPECT_EQ(0, norm(ref(roi), dst, NORM_INF));
+    
+    // (a + b).mul(c - d, 0.5)
+    add(a, b, t1);
+    subtract(c, d, t2);
+    multiply(t1, t2, ref, 0.5);
+    dst = (a + b).mul(c - d, 0.5);
+    EXPECT_EQ(0, norm(ref, dst, NORM_INF));
+    
+    // ((a - b)*2 + 1)/abs(c - d)
+    addWeighted(a, 2, b, -2, 1, t1);
+    absdiff(c, d, t2);
+    divide(t1, t2, ref);
+    dst = ((a - b)*2 + 1)/abs(c - d);
+    EXPECT_EQ(0, norm(ref, dst, NORM_INF));
+    
+    // the copy of the fused expression outlives the original
+    MatExpr e = ((a - b)*2 + 1)/abs(c - d), e1 = e;
+    e = MatExpr();
+    dst = e1;
+    EXPECT_EQ(0, norm(ref, dst, NORM_INF));
+    
+    if( a.channels() == 1 )
+    {
+        // 100 - abs(a - d), converted to another type
+        absdiff(a, d, t1);
+        subtract(Scalar::all(100), t1, t2);
+        t2.convertTo(ref, CV_32F);
+        Mat_<float> fdst = Scalar::all(100) - abs(a - d);
+        EXPECT_EQ(0, norm(ref, fdst, NORM_INF));
+        
+        // (a > b) + (c <= d)
+        compare(a, b, t1, CMP_GT);
+        compare(c, d, t2, CMP_LE);
+        add(t1, t2, ref);
+        dst = (a > b) + (c <= d);
+        EXPECT_EQ(0, norm(ref, dst, NORM_INF));
+    }
+    
+    // in-place: a = abs(a*alpha + b*beta - c)
+    Mat a1 = a.clone();
+    Mat a2 = a1;
+    addWeighted(a, 0.75, b, -1.5, 0, t1);
+    absdiff(t1, c, ref);
+    a1 = abs(a1*0.75 + b*(-1.5) - c);
+    EXPECT_EQ(a2.data, a1.data);
+    EXPECT_EQ(0, norm(ref, a1, NORM_INF));
+}
+
+TEST(Core_MatExpr, fused_elementwise)
+{
+    RNG& rng = theRNG();
+    const int types[] = { CV_8UC1, CV_16SC1, CV_32FC1, CV_8UC3, CV_64FC1 };
+    const Size sizes[] = { Size(53, 200), Size(4111, 7), Size(640, 480) };
+    
+    for( size_t i = 0; i < sizeof(types)/sizeof(types[0]); i++ )
+        for( size_t j = 0; j < sizeof(sizes)/sizeof(sizes[0]); j++ )
+        {
+            Mat m[4];
+            for( int k = 0; k < 4; k++ )
+            {
+                // every other set of operands is not continuous
+                if( j % 2 == 0 )
+                    m[k] = Mat(sizes[j].height + 2, sizes[j].width + 3, types[i])(Rect(Point(1, 1), sizes[j]));
+                else
+                    m[k].create(sizes[j], types[i]);
+                rng.fill(m[k], RNG::UNIFORM, Scalar::all(0), Scalar::all(200));
+            }
+            SCOPED_TRACE(cv::format("type=%d, size=%dx%d", types[i], sizes[j].width, sizes[j].height));
+            checkFusedExpr(m[0], m[1], m[2], m[3]);
+        }
+}
+
+TEST(Core_MatExpr, fused_elementwise_overlapped_output)
+{
+    Mat big(100, 100, CV_32F);
+    randu(big, Scalar::all(-10), Scalar::all(10));
+    Mat a = big(Rect(0, 0, 90, 90)), b = big(Rect(5, 7, 90, 90)), c = big(Rect(10, 1, 90, 90));
+    
+    Mat t1, ref;
+    addWeighted(a, 2, b, 3, 0, t1);
+    absdiff(t1, c, ref);
+    
+    // the result is written over the inputs, shifted relative to them
+    Mat dst = big(Rect(3, 2, 90, 90));
+    dst = abs(a*2 + b*3 - c);
+    EXPECT_EQ(0, norm(ref, dst, NORM_INF));
+}
+
+TEST(Core_MatExpr, fused_lifetime_and_laziness)
+{
+    Mat a(30, 40, CV_32F), b(30, 40, CV_32F), c(30, 40, CV_32F), t, t1, ref, dst;
+    randu(a, Scalar::all(-10), Scalar::all(10));
+    randu(b, Scalar::all(-10), Scalar::all(10));
+    randu(c, Scalar::all(-10), Scalar::all(10));
+    
+    // the operands, including those of the sub-expressions, are read when the expression
+    // is assigned to a matrix, just like the operands of a single operation
+    MatExpr e = abs(a - b)*2 + c, e0 = a + b;
+    a.setTo(Scalar::all(1));
+    absdiff(a, b, t);
+    t *= 2;
+    add(t, c, ref);
+    dst = e;
+    EXPECT_EQ(0, norm(ref, dst, NORM_INF));
+    add(a, b, t1);
+    dst = e0;
+    EXPECT_EQ(0, norm(t1, dst, NORM_INF));
+    
+    // the sub-expressions are shared by the copies and by the expressions derived from e,
+    // and they stay alive as long as any of them does
+    Rect roi(3, 4, 20, 10);
+    MatExpr e1 = e, e2 = e(roi), e3 = e*0.5 + 1;
+    e = MatExpr();
+    dst = e1;
+    EXPECT_EQ(0, norm(ref, dst, NORM_INF));
+    e1 = MatExpr();
+    dst = e2;
+    EXPECT_EQ(0, norm(ref(roi), dst, NORM_INF));
+    dst = e3;
+    addWeighted(t, 0.5, c, 0.5, 1, ref);
+    EXPECT_EQ(0, norm(ref, dst, NORM_INF));
+    
+    // the sub-expressions are carried by MatExpr::c; an expression that lost them is rejected
+    e2.c.release();
+    EXPECT_THROW(dst = e2, cv::Exception);
+}
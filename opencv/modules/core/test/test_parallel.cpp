@@ -0,0 +1,180 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                           License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000-2008, Intel Corporation, all rights reserved.
+// Copyright (C) 2009, Willow Garage Inc., all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of the copyright holders may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+#include "test_precomp.hpp"
+#include "opencv2/core/internal.hpp"
+
+using namespace cv;
+using namespace std;
+
+namespace
+{
+
+struct MarkInvoker
+{
+    MarkInvoker(vector<int>& _hits, Mutex& _mtx, int& _minChunk)
+        : hits(&_hits), mtx(&_mtx), minChunk(&_minChunk) {}
+
+    void operator()(const BlockedRange& range) const
+    {
+        for( int i = range.begin(); i < range.end(); i++ )
+            CV_XADD(&(*hits)[i], 1);
+        AutoLock lock(*mtx);
+        *minChunk = std::min(*minChunk, range.end() - range.begin());
+    }
+
+    vector<int>* hits;
+    Mutex* mtx;
+    int* minChunk;
+};
+
+struct NestedInvoker
+{
+    NestedInvoker(vector<int>& _hits) : hits(&_hits) {}
+
+    void operator()(const BlockedRange& range) const
+    {
+        Mutex mtx;
+        int minChunk = INT_MAX;
+        for( int i = range.begin(); i < range.end(); i++ )
+        {
+            CV_Assert( getThreadNum() < getNumThreads() );
+            parallel_for(BlockedRange(i*100, (i+1)*100, 10), MarkInvoker(*hits, mtx, minChunk));
+        }
+    }
+
+    vector<int>* hits;
+};
+
+struct SumReducer
+{
+    SumReducer(const vector<float>& _data) : data(&_data), sum(0.f) {}
+    SumReducer(SumReducer& r, Split) : data(r.data), sum(0.f) {}
+
+    void operator()(const BlockedRange& range)
+    {
+        for( int i = range.begin(); i < range.end(); i++ )
+            sum += (*data)[i];
+    }
+
+    void join(const SumReducer& r) { sum += r.sum; }
+
+    const vector<float>* data;
+    float sum;
+};
+
+struct ThrowingInvoker
+{
+    void operator()(const BlockedRange& range) const
+    {
+        if( range.begin() <= 500 && 500 < range.end() )
+            CV_Error(CV_StsOutOfRange, "expected");
+    }
+};
+
+class Core_ParallelTest : public ::testing::Test
+{
+protected:
+    cvtest::ThreadsGuard threadsGuard;
+};
+
+}
+
+TEST_F(Core_ParallelTest, for_covers_range_once)
+{
+    const int N = 100003, grain = 37;
+    const int threads[] = { 1, 2, 3, 8 };
+
+    for( size_t k = 0; k < sizeof(threads)/sizeof(threads[0]); k++ )
+    {
+        setNumThreads(threads[k]);
+
+        vector<int> hits(N + 10, 0);
+        Mutex mtx;
+        int minChunk = INT_MAX;
+        parallel_for(BlockedRange(10, N + 10, grain), MarkInvoker(hits, mtx, minChunk));
+
+        EXPECT_EQ(0, std::count(hits.begin(), hits.begin() + 10, 1));
+        EXPECT_EQ(N, std::count(hits.begin() + 10, hits.end(), 1));
+        EXPECT_LE(grain, minChunk);
+    }
+}
+
+TEST_F(Core_ParallelTest, nested_for)
+{
+    setNumThreads(4);
+    vector<int> hits(100*100, 0);
+    parallel_for(BlockedRange(0, 100), NestedInvoker(hits));
+    EXPECT_EQ(100*100, std::count(hits.begin(), hits.end(), 1));
+}
+
+TEST_F(Core_ParallelTest, reduce_is_deterministic)
+{
+    vector<float> data(123457);
+    RNG rng(0x1234);
+    for( size_t i = 0; i < data.size(); i++ )
+        data[i] = rng.uniform(-1.f, 1.f)*(float)(i % 1000);
+
+    float sum0 = 0;
+    for( int nthreads = 1; nthreads <= 8; nthreads++ )
+    {
+        setNumThreads(nthreads);
+        SumReducer r(data);
+        parallel_reduce(BlockedRange(0, (int)data.size(), 100), r);
+        if( nthreads == 1 )
+            sum0 = r.sum;
+        EXPECT_EQ(sum0, r.sum);
+    }
+}
+
+TEST_F(Core_ParallelTest, exception_is_propagated)
+{
+    setNumThreads(4);
+    EXPECT_THROW(parallel_for(BlockedRange(0, 1000), ThrowingInvoker()), cv::Exception);
+
+    // the pool must remain usable after the exception
+    vector<int> hits(1000, 0);
+    Mutex mtx;
+    int minChunk = INT_MAX;
+    parallel_for(BlockedRange(0, 1000), MarkInvoker(hits, mtx, minChunk));
+    EXPECT_EQ(1000, std::count(hits.begin(), hits.end(), 1));
+}
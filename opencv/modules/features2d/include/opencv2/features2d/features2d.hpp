@@ -2161,6 +2161,31 @@ template<int cellsize> struct CV_EXPORTS HammingMultilevel
     }
 };
     
+/*
+ * Computes the distances between the query descriptor and each of the train descriptors (rows of train).
+ * The generic version calls the distance functor for every pair, the Hamming distances
+ * to all the train descriptors are computed by a single batchNormHamming() call.
+ */
+template<class Distance> inline void
+batchDistance( Distance& distance, const typename Distance::ValueType* query, const Mat& train,
+               int dimension, typename Distance::ResultType* dist )
+{
+    typedef typename Distance::ValueType ValueType;
+    for( int i = 0; i < train.rows; i++ )
+        dist[i] = distance( query, (const ValueType*)(train.data + train.step*i), dimension );
+}
+
+inline void batchDistance( Hamming&, const unsigned char* query, const Mat& train, int dimension, int* dist )
+{
+    batchNormHamming( query, train.data, train.step, dimension, train.rows, dist );
+}
+
+template<int cellsize> inline void
+batchDistance( HammingMultilevel<cellsize>&, const unsigned char* query, const Mat& train, int dimension, int* dist )
+{
+    batchNormHamming( query, train.data, train.step, dimension, train.rows, dist, cellsize );
+}
+
 /****************************************************************************************\
 *                                      DMatch                                            *
 \****************************************************************************************/
@@ -2423,10 +2448,17 @@ inline void BruteForceMatcher<Distance>::commonKnnMatchImpl( BruteForceMatcher<D
                            matcher.trainDescCollection[iIdx].empty() );
 
                 const ValueType* d1 = (const ValueType*)(queryDescriptors.data + queryDescriptors.step*qIdx);
+                if( masks.empty() || masks[iIdx].empty() )
+                {
+                    if( !allDists[iIdx].empty() )
+                        batchDistance( matcher.distance, d1, matcher.trainDescCollection[iIdx], dimension,
+                                       allDists[iIdx].ptr<DistanceType>() );
+                    continue;
+                }
                 allDists[iIdx].setTo( Scalar::all(std::numeric_limits<DistanceType>::max()) );
                 for( int tIdx = 0; tIdx < matcher.trainDescCollection[iIdx].rows; tIdx++ )
                 {
-                    if( masks.empty() || matcher.isPossibleMatch(masks[iIdx], qIdx, tIdx) )
+                    if( matcher.isPossibleMatch(masks[iIdx], qIdx, tIdx) )
                     {
                         const ValueType* d2 = (const ValueType*)(matcher.trainDescCollection[iIdx].data +
                                                                  matcher.trainDescCollection[iIdx].step*tIdx);
@@ -2479,6 +2511,7 @@ inline void BruteForceMatcher<Distance>::commonRadiusMatchImpl( BruteForceMatche
     matches.reserve(queryDescriptors.rows);
 
     size_t imgCount = matcher.trainDescCollection.size();
+    vector<DistanceType> dists; // distances between one query descriptor and the train descriptors of one image
     for( int qIdx = 0; qIdx < queryDescriptors.rows; qIdx++ )
     {
         if( matcher.isMaskedOut( masks, qIdx ) )
@@ -2498,9 +2531,20 @@ inline void BruteForceMatcher<Distance>::commonRadiusMatchImpl( BruteForceMatche
 						   matcher.trainDescCollection[iIdx].empty() );
 
                 const ValueType* d1 = (const ValueType*)(queryDescriptors.data + queryDescriptors.step*qIdx);
+                if( masks.empty() || masks[iIdx].empty() )
+                {
+                    int trainCount = matcher.trainDescCollection[iIdx].rows;
+                    dists.resize( trainCount );
+                    if( trainCount > 0 )
+                        batchDistance( matcher.distance, d1, matcher.trainDescCollection[iIdx], dimension, &dists[0] );
+                    for( int tIdx = 0; tIdx < trainCount; tIdx++ )
+                        if( dists[tIdx] < maxDistance )
+                            curMatches->push_back( DMatch( qIdx, tIdx, (int)iIdx, (float)dists[tIdx] ) );
+                    continue;
+                }
                 for( int tIdx = 0; tIdx < matcher.trainDescCollection[iIdx].rows; tIdx++ )
                 {
-                    if( masks.empty() || matcher.isPossibleMatch(masks[iIdx], qIdx, tIdx) )
+                    if( matcher.isPossibleMatch(masks[iIdx], qIdx, tIdx) )
                     {
                         const ValueType* d2 = (const ValueType*)(matcher.trainDescCollection[iIdx].data +
                                                                  matcher.trainDescCollection[iIdx].step*tIdx);
@@ -1105,3 +1105,61 @@ TEST( Features2d_DescriptorMatcher_FlannBased, regression )
     CV_DescriptorMatcherTest test( "descriptor-matcher-flann-based", new FlannBasedMatcher, 0.04f );
     test.safe_run();
 }
+
+// uses the generic per-pair distance computation instead of the batched one
+struct HammingPerPair : public Hamming
+{
+};
+
+static void checkSameMatches( const vector<vector<DMatch> >& m1, const vector<vector<DMatch> >& m2 )
+{
+    ASSERT_EQ( m1.size(), m2.size() );
+    for( size_t i = 0; i < m1.size(); i++ )
+    {
+        ASSERT_EQ( m1[i].size(), m2[i].size() );
+        for( size_t j = 0; j < m1[i].size(); j++ )
+        {
+            EXPECT_EQ( m1[i][j].queryIdx, m2[i][j].queryIdx );
+            EXPECT_EQ( m1[i][j].trainIdx, m2[i][j].trainIdx );
+            EXPECT_EQ( m1[i][j].imgIdx, m2[i][j].imgIdx );
+            EXPECT_EQ( m1[i][j].distance, m2[i][j].distance );
+        }
+    }
+}
+
+TEST( Features2d_DescriptorMatcher_BruteForceHamming, batched_distances )
+{
+    RNG& rng = theRNG();
+    Mat query( 50, 32, CV_8U ), train( 1003, 32, CV_8U ), mask( query.rows, train.rows, CV_8U );
+    rng.fill( query, RNG::UNIFORM, Scalar::all(0), Scalar::all(256) );
+    rng.fill( train, RNG::UNIFORM, Scalar::all(0), Scalar::all(256) );
+    rng.fill( mask, RNG::UNIFORM, Scalar::all(0), Scalar::all(2) );
+    // make the distances unique, so that the order of the matches does not depend on the sorting
+    for( int i = 0; i < query.rows; i++ )
+    {
+        Mat trainRow = train.row(i*20);
+        query.row(i).copyTo( trainRow );
+    }
+
+    BruteForceMatcher<Hamming> batched;
+    BruteForceMatcher<HammingPerPair> perPair;
+    vector<vector<DMatch> > m1, m2;
+
+    batched.knnMatch( query, train, m1, 2 );
+    perPair.knnMatch( query, train, m2, 2 );
+    checkSameMatches( m1, m2 );
+    for( int i = 0; i < query.rows; i++ )
+        EXPECT_EQ( i*20, m1[i][0].trainIdx );
+
+    batched.knnMatch( query, train, m1, 1, mask );
+    perPair.knnMatch( query, train, m2, 1, mask );
+    checkSameMatches( m1, m2 );
+
+    batched.radiusMatch( query, train, m1, 120.f );
+    perPair.radiusMatch( query, train, m2, 120.f );
+    checkSameMatches( m1, m2 );
+
+    batched.radiusMatch( query, train, m1, 120.f, mask );
+    perPair.radiusMatch( query, train, m2, 120.f, mask );
+    checkSameMatches( m1, m2 );
+}
@@ -87,6 +87,10 @@ public:
     //! the filtering operator. Must be overrided in the derived classes. The horizontal border interpolation is done outside of the class.
     virtual void operator()(const uchar* src, uchar* dst,
                             int width, int cn) = 0;
+    //! returns an independent copy of the filter or an empty pointer if the filter can not be copied.
+    //! cv::FilterEngine uses the copies to process horizontal stripes of the image in parallel.
+    //! The default implementation returns an empty pointer, so the filter is applied serially.
+    virtual Ptr<BaseRowFilter> clone() const;
     int ksize, anchor;
 };
 
@@ -116,6 +120,9 @@ public:
                             int dstcount, int width) = 0;
     //! resets the internal buffers, if any
     virtual void reset();
+    //! returns an independent copy of the filter (with its own context) or an empty pointer.
+    //! The default implementation returns an empty pointer, so the filter is applied serially.
+    virtual Ptr<BaseColumnFilter> clone() const;
     int ksize, anchor;
 };
 
@@ -142,6 +149,9 @@ public:
                             int dstcount, int width, int cn) = 0;
     //! resets the internal buffers, if any
     virtual void reset();
+    //! returns an independent copy of the filter (with its own context) or an empty pointer.
+    //! The default implementation returns an empty pointer, so the filter is applied serially.
+    virtual Ptr<BaseFilter> clone() const;
     Size ksize;
     Point anchor;
 };
@@ -250,6 +260,9 @@ public:
     virtual int proceed(const uchar* src, int srcStep, int srcCount,
                         uchar* dst, int dstStep);
     //! applies filter to the specified ROI of the image. if srcRoi=(0,0,-1,-1), the whole image is filtered.
+    //! Large images are split into horizontal stripes that are filtered in parallel,
+    //! each by its own copy of the engine, provided that the filters can be cloned
+    //! and the source and destination do not overlap.
     virtual void apply( const Mat& src, Mat& dst,
                         const Rect& srcRoi=Rect(0,0,-1,-1),
                         Point dstOfs=Point(0,0),
@@ -389,10 +402,15 @@ CV_EXPORTS_W void GaussianBlur( InputArray src,
                                                OutputArray dst, Size ksize,
                                                double sigma1, double sigma2=0,
                                                int borderType=BORDER_DEFAULT );
-//! smooths the image using bilateral filter
+//! type of the bilateral filter implementation
+enum { BILATERAL_EXACT=0, BILATERAL_GRID=1 };
+
+//! smooths the image using bilateral filter. BILATERAL_GRID method takes O(1) time per pixel for any sigmaSpace;
+//! it ignores d and borderType, unless it falls back to the exact filter
 CV_EXPORTS_W void bilateralFilter( InputArray src, OutputArray dst, int d,
                                    double sigmaColor, double sigmaSpace,
-                                   int borderType=BORDER_DEFAULT );
+                                   int borderType=BORDER_DEFAULT,
+                                   int method=BILATERAL_EXACT );
 //! smooths the image using the box filter. Each pixel is processed in O(1) time
 CV_EXPORTS_W void boxFilter( InputArray src, OutputArray dst, int ddepth,
                              Size ksize, Point anchor=Point(-1,-1),
@@ -578,6 +596,9 @@ CV_EXPORTS_AS(integral2) void integral( InputArray src, OutputArray sum,
 CV_EXPORTS_AS(integral3) void integral( InputArray src, OutputArray sum,
                                         OutputArray sqsum, OutputArray tilted,
                                         int sdepth=-1 );
+//! recomputes the integral image (and the integral for the squared image) after the pixels of src inside roi have changed
+CV_EXPORTS void updateIntegral( InputArray src, Rect roi, InputOutputArray sum,
+                                InputOutputArray sqsum=noArray() );
 
 //! adds image to the accumulator (dst += src). Unlike cv::add, dst and src can have different types.
 CV_EXPORTS_W void accumulate( InputArray src, InputOutputArray dst,
@@ -923,6 +944,11 @@ enum
 //! converts image from one color space to another
 CV_EXPORTS_W void cvtColor( InputArray src, OutputArray dst, int code, int dstCn=0 );
 
+//! converts the color space, resizes and scales the image in one tiled pass (cvtColor + resize + Mat::convertTo)
+CV_EXPORTS_W void cvtColorResize( InputArray src, OutputArray dst, int code, Size dsize,
+                                  int interpolation=INTER_LINEAR, int rtype=CV_32F,
+                                  double alpha=1, double beta=0, int dstCn=0 );
+
 //! raster image moments
 class CV_EXPORTS_W_MAP Moments
 {
@@ -959,6 +985,64 @@ enum { TM_SQDIFF=0, TM_SQDIFF_NORMED=1, TM_CCORR=2, TM_CCORR_NORMED=3, TM_CCOEFF
 CV_EXPORTS_W void matchTemplate( InputArray image, InputArray templ,
                                  OutputArray result, int method );
 
+/*!
+ The template matching engine for searching the same templates in many images.
+
+ The template spectra and statistics are computed once and reused for every image of the same size.
+ The image spectrum of every block is shared by all the templates of the same size,
+ and the blocks are processed in parallel. The results are the same as of matchTemplate().
+*/
+class CV_EXPORTS TemplateMatcher
+{
+public:
+    //! the default constructor
+    TemplateMatcher();
+    //! the full constructor that calls create()
+    TemplateMatcher( InputArrayOfArrays templs, int method );
+    //! sets the templates (8-bit or 32-bit floating-point, all of the same type) and the comparison method
+    void create( InputArrayOfArrays templs, int method );
+    //! the number of templates
+    int size() const;
+
+    //! computes the proximity maps of all the templates; results[i] is the same as matchTemplate(image, templs[i], ...)
+    void match( InputArray image, vector<Mat>& results );
+    //! computes the proximity map of the idx-th template
+    void match( InputArray image, int idx, OutputArray result );
+
+protected:
+    void prepare( Size imageSize );
+    void process( const Mat& image, const vector<int>& idx, Mat* results );
+
+    int method;
+    vector<Mat> templs;
+    vector<Scalar> templMean;
+    vector<double> templNorm, templSum2;
+    Size imageSize; //!< the image size the spectra have been computed for
+    vector<Mat> spectra; //!< the DFT of every template, the planes are stacked vertically
+    vector<Size> blockSizes, dftSizes;
+    Mat sum, sqsum;
+};
+
+//! the columns of the connected component statistics computed by connectedComponentsWithStats
+enum
+{
+    CC_STAT_LEFT=0, //!< the leftmost x coordinate of the component bounding box
+    CC_STAT_TOP=1, //!< the topmost y coordinate of the component bounding box
+    CC_STAT_WIDTH=2, //!< the width of the bounding box
+    CC_STAT_HEIGHT=3, //!< the height of the bounding box
+    CC_STAT_AREA=4, //!< the number of pixels in the component
+    CC_STAT_MAX=5
+};
+
+//! labels the connected components of the binary image, returns the number of labels (including the background label 0)
+CV_EXPORTS_W int connectedComponents( InputArray image, OutputArray labels,
+                                      int connectivity=8, int ltype=CV_32S );
+
+//! labels the connected components and computes their bounding boxes, areas and centroids
+CV_EXPORTS_W int connectedComponentsWithStats( InputArray image, OutputArray labels,
+                                               OutputArray stats, OutputArray centroids,
+                                               int connectivity=8, int ltype=CV_32S );
+
 //! mode of the contour retrieval algorithm
 enum
 {
@@ -986,6 +1070,37 @@ CV_EXPORTS_W void findContours( InputOutputArray image, OutputArrayOfArrays cont
 CV_EXPORTS void findContours( InputOutputArray image, OutputArrayOfArrays contours,
                               int mode, int method, Point offset=Point());
 
+/*!
+ The contours stored one after another in a single point array.
+
+ The i-th contour occupies points[offsets[i]] ... points[offsets[i+1]-1].
+ The contours are stored in the order they are found (the raster order of their starting points);
+ hierarchy[i] contains the indices of the next and the previous contours at the same level,
+ the first child and the parent contour, or -1 when there is no such contour.
+ The vectors keep their capacity between the findContours() calls,
+ so processing a video stream does not allocate memory after the first frames.
+*/
+class CV_EXPORTS ContourBuffer
+{
+public:
+    //! the number of contours
+    int size() const { return (int)hierarchy.size(); }
+    //! the number of points in the i-th contour
+    int count(int i) const { return offsets[i+1] - offsets[i]; }
+    //! the pointer to the first point of the i-th contour
+    const Point* contour(int i) const { return &points[0] + offsets[i]; }
+    //! removes all the contours, but keeps the allocated memory
+    void clear();
+
+    vector<Point> points; //!< the points of all the contours
+    vector<int> offsets; //!< the starting positions of the contours in points, size()+1 elements
+    vector<Vec4i> hierarchy; //!< (next, previous, first child, parent) for every contour
+};
+
+//! retrieves contours into the flat buffer; only CHAIN_APPROX_NONE and CHAIN_APPROX_SIMPLE are supported
+CV_EXPORTS void findContours( InputOutputArray image, ContourBuffer& contours,
+                              int mode, int method, Point offset=Point());
+
 //! draws contours in the image
 CV_EXPORTS_W void drawContours( InputOutputArray image, InputArrayOfArrays contours,
                               int contourIdx, const Scalar& color,
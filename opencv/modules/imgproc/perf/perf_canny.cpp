@@ -35,5 +35,36 @@ PERF_TEST_P( Img_Aperture_L2_thresholds, canny,
     TEST_CYCLE(100) { Canny(img, edges, thresh_low, thresh_high, aperture, useL2); }
 
 
+    SANITY_CHECK(edges);
+}
+
+typedef std::tr1::tuple<Size, int> Size_Threads_t;
+typedef perf::TestBaseWithParam<Size_Threads_t> Size_Threads;
+
+PERF_TEST_P( Size_Threads, canny_threads,
+             testing::Combine(
+                 testing::Values( sz720p, sz1080p ),
+                 testing::Values( 1, 2, 4, 8, 16 )
+             )
+           )
+{
+    Size sz = get<0>(GetParam());
+    int threads = get<1>(GetParam());
+
+    Mat img = imread(getDataPath("stitching/b1.jpg"), IMREAD_GRAYSCALE);
+    if (img.empty())
+        FAIL() << "Unable to load source image stitching/b1.jpg";
+    resize(img, img, sz);
+    Mat edges(img.size(), img.type());
+
+    declare.in(img).out(edges);
+
+    int nthreads = getNumThreads();
+    setNumThreads(threads);
+
+    TEST_CYCLE(100) { Canny(img, edges, 50, 100); }
+
+    setNumThreads(nthreads);
+
     SANITY_CHECK(edges);
 }
@@ -0,0 +1,30 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+typedef std::tr1::tuple<Size, int> Size_Connectivity_t;
+typedef TestBaseWithParam<Size_Connectivity_t> Size_Connectivity;
+
+PERF_TEST_P( Size_Connectivity, connectedComponentsWithStats,
+    testing::Combine(
+        testing::Values( TYPICAL_MAT_SIZES ),
+        testing::Values( 4, 8 )
+    )
+)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int connectivity = std::tr1::get<1>(GetParam());
+
+    Mat noise(sz, CV_8UC1), src;
+    Mat labels(sz, CV_32SC1), stats, centroids;
+    declare.in(noise, WARMUP_RNG).out(labels);
+
+    GaussianBlur(noise, noise, Size(9, 9), 3);
+    threshold(noise, src, 128, 255, THRESH_BINARY);
+
+    TEST_CYCLE(100) { connectedComponentsWithStats(src, labels, stats, centroids, connectivity); }
+
+    SANITY_CHECK(labels);
+}
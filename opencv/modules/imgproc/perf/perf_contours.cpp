@@ -0,0 +1,66 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+CV_ENUM(RetrMode, RETR_EXTERNAL, RETR_LIST, RETR_CCOMP, RETR_TREE)
+
+typedef std::tr1::tuple<Size, RetrMode> Size_RetrMode_t;
+typedef TestBaseWithParam<Size_RetrMode_t> Size_RetrMode;
+
+static Mat makeBlobs(Size sz)
+{
+    Mat noise(sz, CV_8UC1), src;
+    randu(noise, 0, 256);
+    GaussianBlur(noise, noise, Size(9, 9), 3);
+    threshold(noise, src, 128, 255, THRESH_BINARY);
+    return src;
+}
+
+PERF_TEST_P( Size_RetrMode, findContours,
+    testing::Combine(
+        testing::Values( TYPICAL_MAT_SIZES ),
+        testing::ValuesIn( RetrMode::all() )
+    )
+)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int mode = std::tr1::get<1>(GetParam());
+
+    Mat src = makeBlobs(sz), img;
+    vector<vector<Point> > contours;
+    vector<Vec4i> hierarchy;
+    declare.in(src);
+
+    TEST_CYCLE(100)
+    {
+        src.copyTo(img);
+        findContours(img, contours, hierarchy, mode, CHAIN_APPROX_SIMPLE);
+    }
+
+    SANITY_CHECK(img);
+}
+
+PERF_TEST_P( Size_RetrMode, findContoursBuffer,
+    testing::Combine(
+        testing::Values( TYPICAL_MAT_SIZES ),
+        testing::ValuesIn( RetrMode::all() )
+    )
+)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int mode = std::tr1::get<1>(GetParam());
+
+    Mat src = makeBlobs(sz), img;
+    ContourBuffer contours;
+    declare.in(src);
+
+    TEST_CYCLE(100)
+    {
+        src.copyTo(img);
+        findContours(img, contours, mode, CHAIN_APPROX_SIMPLE);
+    }
+
+    SANITY_CHECK(img);
+}
@@ -8,7 +8,11 @@ CV_ENUM(CvtMode, CV_YUV2BGR, CV_YUV2RGB, //YUV
                  CV_YUV420i2BGR, CV_YUV420i2RGB, CV_YUV420sp2BGR, CV_YUV420sp2RGB, //YUV420
                  CV_RGB2GRAY, CV_RGBA2GRAY, CV_BGR2GRAY, CV_BGRA2GRAY, //Gray
                  CV_GRAY2RGB, CV_GRAY2RGBA, /*CV_GRAY2BGR, CV_GRAY2BGRA*/ //Gray2
-                 CV_BGR2HSV, CV_RGB2HSV, CV_BGR2HLS, CV_RGB2HLS //H
+                 CV_BGR2HSV, CV_RGB2HSV, CV_BGR2HLS, CV_RGB2HLS, //H
+                 CV_HSV2BGR, CV_HSV2RGB, CV_HLS2BGR, CV_HLS2RGB, //H2
+                 CV_BGR2Lab, CV_RGB2Lab, CV_Lab2BGR, CV_Lab2RGB, //Lab
+                 CV_BGR2Luv, CV_Luv2BGR, //Luv
+                 CV_BayerBG2BGR, CV_BayerGB2BGR, CV_BayerBG2GRAY, CV_BayerBG2BGR_VNG //Bayer
 )
 
 typedef std::tr1::tuple<Size, CvtMode> Size_CvtMode_t;
@@ -130,3 +134,99 @@ PERF_TEST_P( Size_CvtMode, cvtColorH,
     SANITY_CHECK(dst);
 }
 
+
+
+PERF_TEST_P( Size_CvtMode, cvtColorH2,
+    testing::Combine(
+        testing::Values( TYPICAL_MAT_SIZES ),
+        testing::Values( (int)CV_HSV2BGR, (int)CV_HSV2RGB, (int)CV_HLS2BGR, (int)CV_HLS2RGB )
+    )
+)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int mode = std::tr1::get<1>(GetParam());
+
+    Mat src(sz, CV_8UC3);
+    Mat dst(sz, CV_8UC3);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE(100) { cvtColor(src, dst, mode);  }
+
+    SANITY_CHECK(dst, 1);
+}
+
+
+PERF_TEST_P( Size_CvtMode, cvtColorLab,
+    testing::Combine(
+        testing::Values( TYPICAL_MAT_SIZES ),
+        testing::Values( (int)CV_BGR2Lab, (int)CV_RGB2Lab, (int)CV_Lab2BGR, (int)CV_Lab2RGB,
+                         (int)CV_BGR2Luv, (int)CV_Luv2BGR )
+    )
+)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int mode = std::tr1::get<1>(GetParam());
+
+    Mat src(sz, CV_8UC3);
+    Mat dst(sz, CV_8UC3);
+
+    declare.in(src, WARMUP_RNG).out(dst).time(30);
+
+    TEST_CYCLE(100) { cvtColor(src, dst, mode);  }
+
+    SANITY_CHECK(dst, 1);
+}
+
+
+PERF_TEST_P( Size_CvtMode, cvtColorBayer,
+    testing::Combine(
+        testing::Values( TYPICAL_MAT_SIZES ),
+        testing::Values( (int)CV_BayerBG2BGR, (int)CV_BayerGB2BGR, (int)CV_BayerBG2GRAY, (int)CV_BayerBG2BGR_VNG )
+    )
+)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int mode = std::tr1::get<1>(GetParam());
+
+    Mat src(sz, CV_8UC1);
+    Mat dst(sz, CV_8UC(mode == CV_BayerBG2GRAY ? 1 : 3));
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE(100) { cvtColor(src, dst, mode);  }
+
+    SANITY_CHECK(dst, 1);
+}
+
+CV_ENUM(CvtResizeMode, CV_YUV420sp2BGR, CV_BayerBG2BGR, CV_BayerBG2GRAY, CV_BGR2GRAY)
+CV_ENUM(CvtResizeInterType, INTER_NEAREST, INTER_LINEAR, INTER_AREA)
+
+typedef std::tr1::tuple<Size, CvtResizeMode, CvtResizeInterType> Size_CvtResizeMode_InterType_t;
+typedef perf::TestBaseWithParam<Size_CvtResizeMode_InterType_t> Size_CvtResizeMode_InterType;
+
+PERF_TEST_P( Size_CvtResizeMode_InterType, cvtColorResize,
+    testing::Combine(
+        testing::Values( sz720p, sz1080p ),
+        testing::ValuesIn( CvtResizeMode::all() ),
+        testing::ValuesIn( CvtResizeInterType::all() )
+    )
+)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int mode = std::tr1::get<1>(GetParam());
+    int interType = std::tr1::get<2>(GetParam());
+
+    Mat src;
+    if( mode == CV_YUV420sp2BGR )
+        src.create(sz.height+sz.height/2, sz.width, CV_8UC1);
+    else
+        src.create(sz, mode == CV_BGR2GRAY ? CV_8UC3 : CV_8UC1);
+    Mat dst(szVGA, mode == CV_BGR2GRAY || mode == CV_BayerBG2GRAY ? CV_32FC1 : CV_32FC3);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE(100) { cvtColorResize(src, dst, mode, szVGA, interType, CV_32F, 1./255);  }
+
+    SANITY_CHECK(dst, 1e-5);
+}
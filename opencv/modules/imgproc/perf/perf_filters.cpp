@@ -243,3 +243,28 @@ PERF_TEST_P(Size_MatType_dx_dy_Border3x3ROI, scharrViaSobelFilter,
 
     SANITY_CHECK(dst);
 }
+
+/**************** Bilateral ********************/
+
+typedef std::tr1::tuple<MatType, double> MatType_SigmaSpace_t;
+typedef perf::TestBaseWithParam<MatType_SigmaSpace_t> MatType_SigmaSpace;
+
+PERF_TEST_P(MatType_SigmaSpace, bilateralFilterGrid,
+            testing::Combine(
+                testing::Values(CV_8UC1, CV_8UC3),
+                testing::Values(5., 15., 40.)
+            )
+          )
+{
+    int type = get<0>(GetParam());
+    double sigmaSpace = get<1>(GetParam());
+
+    Mat src(sz1080p, type);
+    Mat dst(sz1080p, type);
+
+    declare.in(src, WARMUP_RNG).out(dst).time(60);
+
+    TEST_CYCLE(100) { bilateralFilter(src, dst, 0, 50, sigmaSpace, BORDER_DEFAULT, BILATERAL_GRID); }
+
+    SANITY_CHECK(dst, 1);
+}
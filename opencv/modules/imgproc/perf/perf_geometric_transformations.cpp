@@ -53,3 +53,126 @@ PERF_TEST_P(MatInfo_Size_Size, resizeDownLinear,
     SANITY_CHECK(dst);
 }
 
+
+CV_ENUM(InterType, INTER_NEAREST, INTER_LINEAR, INTER_CUBIC, INTER_LANCZOS4)
+CV_ENUM(WarpMatType, CV_8UC1, CV_8UC4, CV_16UC1, CV_32FC1)
+
+typedef tr1::tuple<Size, WarpMatType, InterType> Size_WarpMatType_InterType_t;
+typedef TestBaseWithParam<Size_WarpMatType_InterType_t> Size_WarpMatType_InterType;
+
+PERF_TEST_P(Size_WarpMatType_InterType, warpAffine,
+            testing::Combine(
+                testing::Values(szVGA, sz1080p),
+                testing::ValuesIn(WarpMatType::all()),
+                testing::ValuesIn(InterType::all())
+                )
+)
+{
+    Size sz = tr1::get<0>(GetParam());
+    int type = tr1::get<1>(GetParam());
+    int interType = tr1::get<2>(GetParam());
+
+    Mat src(sz, type), dst(sz, type);
+    Mat M = getRotationMatrix2D(Point2f(sz.width/2.f, sz.height/2.f), 5., 1.05);
+
+    declare.in(src, WARMUP_RNG).out(dst).time(60);
+
+    TEST_CYCLE(100) warpAffine(src, dst, M, sz, interType, BORDER_CONSTANT, Scalar::all(150));
+
+    SANITY_CHECK(dst, 1);
+}
+
+PERF_TEST_P(Size_WarpMatType_InterType, warpPerspective,
+            testing::Combine(
+                testing::Values(szVGA, sz1080p),
+                testing::ValuesIn(WarpMatType::all()),
+                testing::ValuesIn(InterType::all())
+                )
+)
+{
+    Size sz = tr1::get<0>(GetParam());
+    int type = tr1::get<1>(GetParam());
+    int interType = tr1::get<2>(GetParam());
+
+    Mat src(sz, type), dst(sz, type);
+    Point2f from[] = { Point2f(0, 0), Point2f((float)sz.width, 0),
+                       Point2f((float)sz.width, (float)sz.height), Point2f(0, (float)sz.height) };
+    Point2f to[] = { Point2f(sz.width*0.05f, sz.height*0.1f), Point2f(sz.width*0.9f, 0),
+                     Point2f((float)sz.width, sz.height*0.95f), Point2f(0, (float)sz.height) };
+    Mat M = getPerspectiveTransform(from, to);
+
+    declare.in(src, WARMUP_RNG).out(dst).time(60);
+
+    TEST_CYCLE(100) warpPerspective(src, dst, M, sz, interType, BORDER_REPLICATE);
+
+    SANITY_CHECK(dst, 1);
+}
+
+CV_ENUM(RemapMapType, CV_32FC1, CV_16SC2)
+
+typedef tr1::tuple<WarpMatType, RemapMapType, InterType> WarpMatType_RemapMapType_InterType_t;
+typedef TestBaseWithParam<WarpMatType_RemapMapType_InterType_t> WarpMatType_RemapMapType_InterType;
+
+PERF_TEST_P(WarpMatType_RemapMapType_InterType, remap,
+            testing::Combine(
+                testing::ValuesIn(WarpMatType::all()),
+                testing::ValuesIn(RemapMapType::all()),
+                testing::ValuesIn(InterType::all())
+                )
+)
+{
+    int type = tr1::get<0>(GetParam());
+    int mapType = tr1::get<1>(GetParam());
+    int interType = tr1::get<2>(GetParam());
+    Size sz = sz1080p;
+
+    // radial distortion-like map, as used for undistortion
+    Mat mapx(sz, CV_32FC1), mapy(sz, CV_32FC1), map1, map2;
+    float cx = sz.width*0.5f, cy = sz.height*0.5f, k = 0.1f/(cx*cx);
+    for( int y = 0; y < sz.height; y++ )
+        for( int x = 0; x < sz.width; x++ )
+        {
+            float dx = x - cx, dy = y - cy, r = 1 + k*(dx*dx + dy*dy);
+            mapx.at<float>(y, x) = cx + dx*r;
+            mapy.at<float>(y, x) = cy + dy*r;
+        }
+    if( mapType == CV_32FC1 )
+        map1 = mapx, map2 = mapy;
+    else
+        convertMaps(mapx, mapy, map1, map2, CV_16SC2, interType == INTER_NEAREST);
+
+    Mat src(sz, type), dst(sz, type);
+
+    declare.in(src, WARMUP_RNG).out(dst).time(60);
+
+    TEST_CYCLE(100) remap(src, dst, map1, map2, interType, BORDER_CONSTANT);
+
+    SANITY_CHECK(dst, 1);
+}
+
+CV_ENUM(ResizeInterType, INTER_NEAREST, INTER_LINEAR, INTER_CUBIC, INTER_AREA, INTER_LANCZOS4)
+
+typedef tr1::tuple<WarpMatType, ResizeInterType, double> WarpMatType_ResizeInterType_Scale_t;
+typedef TestBaseWithParam<WarpMatType_ResizeInterType_Scale_t> WarpMatType_ResizeInterType_Scale;
+
+PERF_TEST_P(WarpMatType_ResizeInterType_Scale, resize,
+            testing::Combine(
+                testing::ValuesIn(WarpMatType::all()),
+                testing::ValuesIn(ResizeInterType::all()),
+                testing::Values(0.3, 0.5, 1.7)
+                )
+)
+{
+    int type = tr1::get<0>(GetParam());
+    int interType = tr1::get<1>(GetParam());
+    double scale = tr1::get<2>(GetParam());
+
+    Size dsz(cvRound(sz1080p.width*scale), cvRound(sz1080p.height*scale));
+    Mat src(sz1080p, type), dst(dsz, type);
+
+    declare.in(src, WARMUP_RNG).out(dst).time(60);
+
+    TEST_CYCLE(100) resize(src, dst, dsz, 0, 0, interType);
+
+    SANITY_CHECK(dst, 1);
+}
@@ -0,0 +1,87 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+typedef std::tr1::tuple<Size, MatType> Size_Source_t;
+typedef TestBaseWithParam<Size_Source_t> Size_Source;
+
+typedef std::tr1::tuple<Size, int> Size_Bins_t;
+typedef TestBaseWithParam<Size_Bins_t> Size_Bins;
+
+PERF_TEST_P( Size_Source, calcHist1d,
+    testing::Combine(
+        testing::Values( TYPICAL_MAT_SIZES ),
+        testing::Values( CV_8UC1, CV_16UC1, CV_32FC1 )
+    )
+)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int type = std::tr1::get<1>(GetParam());
+
+    Mat src(sz, type);
+    Mat hist;
+    int channels[] = {0};
+    int histSize[] = {256};
+    float r[] = {0, 256};
+    const float* ranges[] = {r};
+
+    declare.in(src, WARMUP_RNG).time(20);
+
+    TEST_CYCLE(100) { calcHist(&src, 1, channels, Mat(), hist, 1, histSize, ranges); }
+
+    SANITY_CHECK(hist);
+}
+
+PERF_TEST_P( Size_Bins, calcHist3d,
+    testing::Combine(
+        testing::Values( TYPICAL_MAT_SIZES ),
+        testing::Values( 8, 30 )
+    )
+)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int bins = std::tr1::get<1>(GetParam());
+
+    Mat src(sz, CV_8UC3);
+    Mat hist;
+    int channels[] = {0, 1, 2};
+    int histSize[] = {bins, bins, bins};
+    float r[] = {0, 256};
+    const float* ranges[] = {r, r, r};
+
+    declare.in(src, WARMUP_RNG).time(20);
+
+    TEST_CYCLE(100) { calcHist(&src, 1, channels, Mat(), hist, 3, histSize, ranges); }
+
+    Mat hist2d(bins*bins, bins, CV_32F, hist.data);
+    SANITY_CHECK(hist2d);
+}
+
+PERF_TEST_P( Size_Source, calcBackProject,
+    testing::Combine(
+        testing::Values( TYPICAL_MAT_SIZES ),
+        testing::Values( CV_8UC3, CV_32FC3 )
+    )
+)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int type = std::tr1::get<1>(GetParam());
+
+    Mat src(sz, type);
+    Mat dst(sz, CV_MAT_DEPTH(type));
+    Mat hist;
+    int channels[] = {0, 1, 2};
+    int histSize[] = {8, 8, 8};
+    float r[] = {0, 256};
+    const float* ranges[] = {r, r, r};
+
+    declare.in(src, WARMUP_RNG).out(dst).time(20);
+
+    calcHist(&src, 1, channels, Mat(), hist, 3, histSize, ranges);
+
+    TEST_CYCLE(100) { calcBackProject(&src, 1, channels, hist, dst, ranges); }
+
+    SANITY_CHECK(dst);
+}
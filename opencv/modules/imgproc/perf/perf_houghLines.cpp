@@ -0,0 +1,56 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+typedef std::tr1::tuple<Size, double> Size_Theta_t;
+typedef TestBaseWithParam<Size_Theta_t> Size_Theta;
+
+static Mat makeSegments(Size sz)
+{
+    Mat img(sz, CV_8UC1, Scalar::all(0));
+    RNG rng(12345);
+    for( int i = 0; i < 20; i++ )
+        line(img, Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)),
+             Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)), Scalar::all(255), 2);
+    return img;
+}
+
+PERF_TEST_P( Size_Theta, HoughLines,
+    testing::Combine(
+        testing::Values( TYPICAL_MAT_SIZES ),
+        testing::Values( CV_PI/180, CV_PI/360 )
+    )
+)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    double theta = std::tr1::get<1>(GetParam());
+
+    Mat src = makeSegments(sz);
+    vector<Vec2f> lines;
+    declare.in(src);
+
+    TEST_CYCLE(100) { HoughLines(src, lines, 1, theta, 100); }
+
+    SANITY_CHECK(lines);
+}
+
+PERF_TEST_P( Size_Theta, HoughLinesP,
+    testing::Combine(
+        testing::Values( TYPICAL_MAT_SIZES ),
+        testing::Values( CV_PI/180, CV_PI/360 )
+    )
+)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    double theta = std::tr1::get<1>(GetParam());
+
+    Mat src = makeSegments(sz);
+    vector<Vec4i> lines;
+    declare.in(src);
+
+    TEST_CYCLE(100) { HoughLinesP(src, lines, 1, theta, 80, 30, 5); }
+
+    SANITY_CHECK(lines);
+}
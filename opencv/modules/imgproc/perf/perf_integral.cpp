@@ -91,3 +91,37 @@ PERF_TEST_P( Size_MatType_OutMatDepth, integral_sqsum_tilted,
     SANITY_CHECK(sqsum);
     SANITY_CHECK(tilted);
 }
+
+typedef std::tr1::tuple<Size, MatType, int> Size_MatType_BandRows_t;
+typedef perf::TestBaseWithParam<Size_MatType_BandRows_t> Size_MatType_BandRows;
+
+/*
+// void updateIntegral(InputArray image, Rect roi, InputOutputArray sum, InputOutputArray sqsum=noArray())
+*/
+PERF_TEST_P( Size_MatType_BandRows, updateIntegral,
+    testing::Combine(
+        testing::Values( szVGA, sz1080p ),
+        testing::Values( CV_8UC1, CV_32FC1 ),
+        testing::Values( 16, 64 )
+    )
+    )
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int matType = std::tr1::get<1>(GetParam());
+    int bandRows = std::tr1::get<2>(GetParam());
+    int sdepth = CV_MAT_DEPTH(matType) == CV_8U ? CV_32S : CV_64F;
+
+    Mat src(sz, matType);
+    Mat sum, sqsum;
+    declare.in(src, WARMUP_RNG);
+    integral(src, sum, sqsum, sdepth);
+    declare.out(sum, sqsum);
+
+    // the bottom band of the image is refreshed, as in a sliding window
+    Rect band(0, sz.height - bandRows, sz.width, bandRows);
+
+    TEST_CYCLE(100) { updateIntegral(src, band, sum, sqsum); }
+
+    SANITY_CHECK(sum);
+    SANITY_CHECK(sqsum);
+}
@@ -0,0 +1,62 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+CV_ENUM(MethodType, CV_TM_SQDIFF, CV_TM_SQDIFF_NORMED, CV_TM_CCORR, CV_TM_CCORR_NORMED, CV_TM_CCOEFF, CV_TM_CCOEFF_NORMED)
+
+typedef std::tr1::tuple<Size, Size, MethodType> ImgSize_TmplSize_Method_t;
+typedef TestBaseWithParam<ImgSize_TmplSize_Method_t> ImgSize_TmplSize_Method;
+
+PERF_TEST_P( ImgSize_TmplSize_Method, matchTemplate,
+    testing::Combine(
+        testing::Values( szVGA, sz720p ),
+        testing::Values( Size(16, 16), Size(64, 64) ),
+        testing::ValuesIn( MethodType::all() )
+    )
+)
+{
+    Size imgSz = std::tr1::get<0>(GetParam());
+    Size tmplSz = std::tr1::get<1>(GetParam());
+    int method = std::tr1::get<2>(GetParam());
+
+    Mat img(imgSz, CV_8UC1);
+    Mat tmpl(tmplSz, CV_8UC1);
+    Mat result(imgSz - tmplSz + Size(1, 1), CV_32F);
+
+    declare.in(img, tmpl, WARMUP_RNG).out(result).time(30);
+
+    TEST_CYCLE(100) { matchTemplate(img, tmpl, result, method); }
+
+    SANITY_CHECK(result);
+}
+
+typedef std::tr1::tuple<Size, int> ImgSize_Count_t;
+typedef TestBaseWithParam<ImgSize_Count_t> ImgSize_Count;
+
+PERF_TEST_P( ImgSize_Count, TemplateMatcher,
+    testing::Combine(
+        testing::Values( szVGA, sz720p ),
+        testing::Values( 1, 8 )
+    )
+)
+{
+    Size imgSz = std::tr1::get<0>(GetParam());
+    int count = std::tr1::get<1>(GetParam());
+
+    Mat img(imgSz, CV_8UC1);
+    declare.in(img, WARMUP_RNG).time(30);
+
+    vector<Mat> templs;
+    for( int i = 0; i < count; i++ )
+        templs.push_back(img(Rect(i*16, i*8, 32, 32)).clone());
+
+    TemplateMatcher matcher(templs, CV_TM_CCOEFF_NORMED);
+    vector<Mat> results;
+
+    TEST_CYCLE(100) { matcher.match(img, results); }
+
+    Mat first = results[0];
+    SANITY_CHECK(first);
+}
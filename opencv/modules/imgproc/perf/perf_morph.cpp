@@ -30,3 +30,31 @@ PERF_TEST_P(Size_MatType, erode1, TYPICAL_MATS_MORPH)
 
     SANITY_CHECK(dst);
 }
+
+CV_ENUM(MorphOp, MORPH_ERODE, MORPH_DILATE)
+
+typedef std::tr1::tuple<MatType, MorphOp, Size> MatType_MorphOp_KSize_t;
+typedef perf::TestBaseWithParam<MatType_MorphOp_KSize_t> MatType_MorphOp_KSize;
+
+PERF_TEST_P(MatType_MorphOp_KSize, morphRect,
+            testing::Combine(
+                testing::Values(CV_8UC1, CV_8UC4, CV_32FC1),
+                testing::ValuesIn(MorphOp::all()),
+                testing::Values(Size(15, 15), Size(31, 31), Size(61, 61), Size(101, 1), Size(1, 101))
+                )
+            )
+{
+    int type = std::tr1::get<0>(GetParam());
+    int op = std::tr1::get<1>(GetParam());
+    Size ksize = std::tr1::get<2>(GetParam());
+
+    Mat src(sz1080p, type);
+    Mat dst(sz1080p, type);
+    Mat kernel = getStructuringElement(MORPH_RECT, ksize);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE(100) morphologyEx(src, dst, op, kernel);
+
+    SANITY_CHECK(dst);
+}
@@ -0,0 +1,51 @@
+#include "perf_precomp.hpp"
+
+using namespace std;
+using namespace cv;
+using namespace perf;
+
+typedef std::tr1::tuple<Size, MatType> Size_MatType_t;
+typedef perf::TestBaseWithParam<Size_MatType_t> Size_MatType;
+
+PERF_TEST_P( Size_MatType, pyrDown,
+    testing::Combine(
+        testing::Values( szVGA, sz720p, sz1080p ),
+        testing::Values( CV_8UC1, CV_8UC3, CV_16UC1, CV_32FC1 )
+    )
+)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int matType = std::tr1::get<1>(GetParam());
+
+    Mat src(sz, matType);
+    Mat dst((sz.height + 1)/2, (sz.width + 1)/2, matType);
+
+    declare.in(src, WARMUP_RNG).out(dst);
+
+    TEST_CYCLE(100) { pyrDown(src, dst); }
+
+    SANITY_CHECK(dst);
+}
+
+PERF_TEST_P( Size_MatType, buildPyramid,
+    testing::Combine(
+        testing::Values( szVGA, sz720p, sz1080p ),
+        testing::Values( CV_8UC1, CV_8UC3, CV_16UC1, CV_32FC1 )
+    )
+)
+{
+    Size sz = std::tr1::get<0>(GetParam());
+    int matType = std::tr1::get<1>(GetParam());
+
+    Mat src(sz, matType);
+    declare.in(src, WARMUP_RNG);
+
+    // the levels are allocated on the first call and reused afterwards
+    vector<Mat> pyr;
+    buildPyramid(src, pyr, 4);
+
+    TEST_CYCLE(100) { buildPyramid(src, pyr, 4); }
+
+    Mat top = pyr[4];
+    SANITY_CHECK(top);
+}
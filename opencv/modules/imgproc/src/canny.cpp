@@ -41,237 +41,228 @@
 
 #include "precomp.hpp"
 
-CV_IMPL void cvCanny( const void* srcarr, void* dstarr,
-                      double low_thresh, double high_thresh,
-                      int aperture_size )
+namespace cv
 {
-    cv::Ptr<CvMat> dx, dy;
-    cv::AutoBuffer<char> buffer;
-    std::vector<uchar*> stack;
-    uchar **stack_top = 0, **stack_bottom = 0;
-
-    CvMat srcstub, *src = cvGetMat( srcarr, &srcstub );
-    CvMat dststub, *dst = cvGetMat( dstarr, &dststub );
-    CvSize size;
-    int flags = aperture_size;
-    int low, high;
-    int* mag_buf[3];
-    uchar* map;
-    ptrdiff_t mapstep;
-    int maxsize;
-    int i, j;
-    CvMat mag_row;
-
-    if( CV_MAT_TYPE( src->type ) != CV_8UC1 ||
-        CV_MAT_TYPE( dst->type ) != CV_8UC1 )
-        CV_Error( CV_StsUnsupportedFormat, "" );
-
-    if( !CV_ARE_SIZES_EQ( src, dst ))
-        CV_Error( CV_StsUnmatchedSizes, "" );
-
-    if( low_thresh > high_thresh )
-    {
-        double t;
-        CV_SWAP( low_thresh, high_thresh, t );
-    }
-
-    aperture_size &= INT_MAX;
-    if( (aperture_size & 1) == 0 || aperture_size < 3 || aperture_size > 7 )
-        CV_Error( CV_StsBadFlag, "" );
 
-    size = cvGetMatSize( src );
-
-    dx = cvCreateMat( size.height, size.width, CV_16SC1 );
-    dy = cvCreateMat( size.height, size.width, CV_16SC1 );
-    cvSobel( src, dx, 1, 0, aperture_size );
-    cvSobel( src, dy, 0, 1, aperture_size );
-
-    /*if( icvCannyGetSize_p && icvCanny_16s8u_C1R_p && !(flags & CV_CANNY_L2_GRADIENT) )
-    {
-        int buf_size=  0;
-        IPPI_CALL( icvCannyGetSize_p( size, &buf_size ));
-        CV_CALL( buffer = cvAlloc( buf_size ));
-        IPPI_CALL( icvCanny_16s8u_C1R_p( (short*)dx->data.ptr, dx->step,
-                                     (short*)dy->data.ptr, dy->step,
-                                     dst->data.ptr, dst->step,
-                                     size, (float)low_thresh,
-                                     (float)high_thresh, buffer ));
-        EXIT;
-    }*/
-
-    if( flags & CV_CANNY_L2_GRADIENT )
+/* sector numbers
+   (Top-Left Origin)
+
+    1   2   3
+     *  *  *
+      * * *
+    0*******0
+      * * *
+     *  *  *
+    3   2   1
+*/
+
+#define CANNY_SHIFT 15
+#define TG22  (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5)
+
+// computes one row of gradient magnitude; with L2gradient=true the row
+// holds float values that are compared as integers (they are all non-negative)
+static void cannyMagnitudeRow( const short* dx, const short* dy, int* mag,
+                               int width, bool L2gradient )
+{
+    int j = 0;
+    if( !L2gradient )
     {
-        Cv32suf ul, uh;
-        ul.f = (float)low_thresh;
-        uh.f = (float)high_thresh;
-
-        low = ul.i;
-        high = uh.i;
+#if CV_SSE2
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+        {
+            for( ; j <= width - 8; j += 8 )
+            {
+                __m128i x = _mm_loadu_si128((const __m128i*)(dx + j));
+                __m128i y = _mm_loadu_si128((const __m128i*)(dy + j));
+                __m128i x0 = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+                __m128i x1 = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+                __m128i y0 = _mm_srai_epi32(_mm_unpacklo_epi16(y, y), 16);
+                __m128i y1 = _mm_srai_epi32(_mm_unpackhi_epi16(y, y), 16);
+                __m128i s;
+                s = _mm_srai_epi32(x0, 31); x0 = _mm_sub_epi32(_mm_xor_si128(x0, s), s);
+                s = _mm_srai_epi32(x1, 31); x1 = _mm_sub_epi32(_mm_xor_si128(x1, s), s);
+                s = _mm_srai_epi32(y0, 31); y0 = _mm_sub_epi32(_mm_xor_si128(y0, s), s);
+                s = _mm_srai_epi32(y1, 31); y1 = _mm_sub_epi32(_mm_xor_si128(y1, s), s);
+                _mm_storeu_si128((__m128i*)(mag + j), _mm_add_epi32(x0, y0));
+                _mm_storeu_si128((__m128i*)(mag + j + 4), _mm_add_epi32(x1, y1));
+            }
+        }
+#endif
+        for( ; j < width; j++ )
+            mag[j] = std::abs(dx[j]) + std::abs(dy[j]);
     }
     else
     {
-        low = cvFloor( low_thresh );
-        high = cvFloor( high_thresh );
-    }
-
-    buffer.allocate( (size.width+2)*(size.height+2) + (size.width+2)*3*sizeof(int) );
-
-    mag_buf[0] = (int*)(char*)buffer;
-    mag_buf[1] = mag_buf[0] + size.width + 2;
-    mag_buf[2] = mag_buf[1] + size.width + 2;
-    map = (uchar*)(mag_buf[2] + size.width + 2);
-    mapstep = size.width + 2;
-
-    maxsize = MAX( 1 << 10, size.width*size.height/10 );
-    stack.resize( maxsize );
-    stack_top = stack_bottom = &stack[0];
-
-    memset( mag_buf[0], 0, (size.width+2)*sizeof(int) );
-    memset( map, 1, mapstep );
-    memset( map + mapstep*(size.height + 1), 1, mapstep );
-
-    /* sector numbers 
-       (Top-Left Origin)
-
-        1   2   3
-         *  *  * 
-          * * *  
-        0*******0
-          * * *  
-         *  *  * 
-        3   2   1
-    */
-
-    #define CANNY_PUSH(d)    *(d) = (uchar)2, *stack_top++ = (d)
-    #define CANNY_POP(d)     (d) = *--stack_top
-
-    mag_row = cvMat( 1, size.width, CV_32F );
-
-    // calculate magnitude and angle of gradient, perform non-maxima supression.
-    // fill the map with one of the following values:
-    //   0 - the pixel might belong to an edge
-    //   1 - the pixel can not belong to an edge
-    //   2 - the pixel does belong to an edge
-    for( i = 0; i <= size.height; i++ )
-    {
-        int* _mag = mag_buf[(i > 0) + 1] + 1;
-        float* _magf = (float*)_mag;
-        const short* _dx = (short*)(dx->data.ptr + dx->step*i);
-        const short* _dy = (short*)(dy->data.ptr + dy->step*i);
-        uchar* _map;
-        int x, y;
-        ptrdiff_t magstep1, magstep2;
-        int prev_flag = 0;
-
-        if( i < size.height )
+        float* magf = (float*)mag;
+#if CV_SSE2
+        if( checkHardwareSupport(CV_CPU_SSE2) )
         {
-            _mag[-1] = _mag[size.width] = 0;
-
-            if( !(flags & CV_CANNY_L2_GRADIENT) )
-                for( j = 0; j < size.width; j++ )
-                    _mag[j] = abs(_dx[j]) + abs(_dy[j]);
-            /*else if( icvFilterSobelVert_8u16s_C1R_p != 0 ) // check for IPP
-            {
-                // use vectorized sqrt
-                mag_row.data.fl = _magf;
-                for( j = 0; j < size.width; j++ )
-                {
-                    x = _dx[j]; y = _dy[j];
-                    _magf[j] = (float)((double)x*x + (double)y*y);
-                }
-                cvPow( &mag_row, &mag_row, 0.5 );
-            }*/
-            else
+            // the sum of squares is exact in double precision, and sqrt + conversion
+            // to float round the same way as the scalar branch
+            for( ; j <= width - 4; j += 4 )
             {
-                for( j = 0; j < size.width; j++ )
-                {
-                    x = _dx[j]; y = _dy[j];
-                    _magf[j] = (float)std::sqrt((double)x*x + (double)y*y);
-                }
+                __m128i x = _mm_loadl_epi64((const __m128i*)(dx + j));
+                __m128i y = _mm_loadl_epi64((const __m128i*)(dy + j));
+                x = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+                y = _mm_srai_epi32(_mm_unpacklo_epi16(y, y), 16);
+                __m128d x0 = _mm_cvtepi32_pd(x), x1 = _mm_cvtepi32_pd(_mm_srli_si128(x, 8));
+                __m128d y0 = _mm_cvtepi32_pd(y), y1 = _mm_cvtepi32_pd(_mm_srli_si128(y, 8));
+                x0 = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(x0, x0), _mm_mul_pd(y0, y0)));
+                x1 = _mm_sqrt_pd(_mm_add_pd(_mm_mul_pd(x1, x1), _mm_mul_pd(y1, y1)));
+                _mm_storeu_ps(magf + j, _mm_movelh_ps(_mm_cvtpd_ps(x0), _mm_cvtpd_ps(x1)));
             }
         }
-        else
-            memset( _mag-1, 0, (size.width + 2)*sizeof(int) );
-
-        // at the very beginning we do not have a complete ring
-        // buffer of 3 magnitude rows for non-maxima suppression
-        if( i == 0 )
-            continue;
-
-        _map = map + mapstep*i + 1;
-        _map[-1] = _map[size.width] = 1;
-        
-        _mag = mag_buf[1] + 1; // take the central row
-        _dx = (short*)(dx->data.ptr + dx->step*(i-1));
-        _dy = (short*)(dy->data.ptr + dy->step*(i-1));
-        
-        magstep1 = mag_buf[2] - mag_buf[1];
-        magstep2 = mag_buf[0] - mag_buf[1];
-
-        if( (stack_top - stack_bottom) + size.width > maxsize )
+#endif
+        for( ; j < width; j++ )
         {
-            int sz = (int)(stack_top - stack_bottom);
-            maxsize = MAX( maxsize * 3/2, maxsize + 8 );
-            stack.resize(maxsize);
-            stack_bottom = &stack[0];
-            stack_top = stack_bottom + sz;
+            int x = dx[j], y = dy[j];
+            magf[j] = (float)std::sqrt((double)x*x + (double)y*y);
         }
+    }
+}
+
+// hysteresis: grows the edges from the pixels in the stack over the candidate (0) pixels.
+// The tracing does not leave the map rows [lo, hi) so that the stripes can be traced
+// concurrently; the border rows and columns of the map are 1, so the whole map can be
+// passed as well.
+static void cannyTrace( vector<uchar*>& stack, ptrdiff_t mapstep, const uchar* lo, const uchar* hi )
+{
+    #define CANNY_PUSH(d)    *(d) = (uchar)2, stack.push_back(d)
+
+    while( !stack.empty() )
+    {
+        uchar* m = stack.back();
+        stack.pop_back();
 
-        for( j = 0; j < size.width; j++ )
+        if( !m[-1] )
+            CANNY_PUSH( m - 1 );
+        if( !m[1] )
+            CANNY_PUSH( m + 1 );
+        if( m - mapstep >= lo )
         {
-            #define CANNY_SHIFT 15
-            #define TG22  (int)(0.4142135623730950488016887242097*(1<<CANNY_SHIFT) + 0.5)
+            if( !m[-mapstep-1] )
+                CANNY_PUSH( m - mapstep - 1 );
+            if( !m[-mapstep] )
+                CANNY_PUSH( m - mapstep );
+            if( !m[-mapstep+1] )
+                CANNY_PUSH( m - mapstep + 1 );
+        }
+        if( m + mapstep < hi )
+        {
+            if( !m[mapstep-1] )
+                CANNY_PUSH( m + mapstep - 1 );
+            if( !m[mapstep] )
+                CANNY_PUSH( m + mapstep );
+            if( !m[mapstep+1] )
+                CANNY_PUSH( m + mapstep + 1 );
+        }
+    }
 
-            x = _dx[j];
-            y = _dy[j];
-            int s = x ^ y;
-            int m = _mag[j];
+    #undef CANNY_PUSH
+}
 
-            x = abs(x);
-            y = abs(y);
-            if( m > low )
-            {
-                int tg22x = x * TG22;
-                int tg67x = tg22x + ((x + x) << CANNY_SHIFT);
+// Computes the gradient, does non-maxima suppression and hysteresis for a horizontal
+// stripe of the image. Each stripe runs Sobel on its own rows (plus one row above and
+// below for the magnitude ring buffer); the filter takes the pixels outside the stripe
+// from the parent image, so the result is the same as for the whole image.
+// The map is filled with one of the following values:
+//   0 - the pixel might belong to an edge
+//   1 - the pixel can not belong to an edge
+//   2 - the pixel does belong to an edge
+class CannyInvoker
+{
+public:
+    CannyInvoker( const Mat& _src, Mat& _map, int _low, int _high,
+                  int _aperture_size, bool _L2gradient, int _stripeRows )
+        : src(&_src), map(&_map), low(_low), high(_high), aperture_size(_aperture_size),
+          L2gradient(_L2gradient), stripeRows(_stripeRows) {}
 
-                y <<= CANNY_SHIFT;
+    void operator()( const BlockedRange& range ) const
+    {
+        for( int k = range.begin(); k < range.end(); k++ )
+            processStripe( k*stripeRows, std::min((k+1)*stripeRows, src->rows) );
+    }
 
-                if( y < tg22x )
-                {
-                    if( m > _mag[j-1] && m >= _mag[j+1] )
-                    {
-                        if( m > high && !prev_flag && _map[j-mapstep] != 2 )
-                        {
-                            CANNY_PUSH( _map + j );
-                            prev_flag = 1;
-                        }
-                        else
-                            _map[j] = (uchar)0;
-                        continue;
-                    }
-                }
-                else if( y > tg67x )
+protected:
+    void processStripe( int y0, int y1 ) const
+    {
+        int width = src->cols, height = src->rows;
+        int r0 = std::max(y0 - 1, 0), r1 = std::min(y1 + 1, height);
+        Mat dx(r1 - r0, width, CV_16S), dy(r1 - r0, width, CV_16S);
+        Sobel( src->rowRange(r0, r1), dx, CV_16S, 1, 0, aperture_size, 1, 0, BORDER_REPLICATE );
+        Sobel( src->rowRange(r0, r1), dy, CV_16S, 0, 1, aperture_size, 1, 0, BORDER_REPLICATE );
+
+        AutoBuffer<int> buffer( (width+2)*3 );
+        int* mag_buf[3];
+        mag_buf[0] = buffer;
+        mag_buf[1] = mag_buf[0] + width + 2;
+        mag_buf[2] = mag_buf[1] + width + 2;
+        memset( mag_buf[0], 0, (width+2)*3*sizeof(int) );
+
+        // the magnitude outside of the image is 0
+        if( y0 > 0 )
+            cannyMagnitudeRow( dx.ptr<short>(0), dy.ptr<short>(0), mag_buf[0] + 1, width, L2gradient );
+        cannyMagnitudeRow( dx.ptr<short>(y0 - r0), dy.ptr<short>(y0 - r0), mag_buf[1] + 1, width, L2gradient );
+
+        ptrdiff_t mapstep = map->step;
+        uchar* stripe = map->ptr(y0 + 1);
+        vector<uchar*> stack;
+        stack.reserve( std::max(1 << 10, width*(y1 - y0)/10) );
+
+        for( int i = y0; i < y1; i++ )
+        {
+            if( i + 1 < height )
+                cannyMagnitudeRow( dx.ptr<short>(i + 1 - r0), dy.ptr<short>(i + 1 - r0),
+                                   mag_buf[2] + 1, width, L2gradient );
+            else
+                memset( mag_buf[2], 0, (width+2)*sizeof(int) );
+
+            const int* _mag = mag_buf[1] + 1;
+            const short* _dx = dx.ptr<short>(i - r0);
+            const short* _dy = dy.ptr<short>(i - r0);
+            uchar* _map = map->ptr(i + 1) + 1;
+            // the previous row of the map belongs to another stripe on the first row,
+            // compare with the border row (all 1's) instead
+            const uchar* _prev = i > y0 ? _map - mapstep : map->ptr() + 1;
+            ptrdiff_t magstep1 = mag_buf[2] - mag_buf[1];
+            ptrdiff_t magstep2 = mag_buf[0] - mag_buf[1];
+            int prev_flag = 0;
+
+            _map[-1] = _map[width] = 1;
+
+            for( int j = 0; j < width; j++ )
+            {
+                int x = _dx[j];
+                int y = _dy[j];
+                int s = x ^ y;
+                int m = _mag[j];
+
+                x = std::abs(x);
+                y = std::abs(y);
+                if( m > low )
                 {
-                    if( m > _mag[j+magstep2] && m >= _mag[j+magstep1] )
+                    int tg22x = x * TG22;
+                    int tg67x = tg22x + ((x + x) << CANNY_SHIFT);
+                    bool isMax;
+
+                    y <<= CANNY_SHIFT;
+
+                    if( y < tg22x )
+                        isMax = m > _mag[j-1] && m >= _mag[j+1];
+                    else if( y > tg67x )
+                        isMax = m > _mag[j+magstep2] && m >= _mag[j+magstep1];
+                    else
                     {
-                        if( m > high && !prev_flag && _map[j-mapstep] != 2 )
-                        {
-                            CANNY_PUSH( _map + j );
-                            prev_flag = 1;
-                        }
-                        else
-                            _map[j] = (uchar)0;
-                        continue;
+                        s = s < 0 ? -1 : 1;
+                        isMax = m > _mag[j+magstep2-s] && m > _mag[j+magstep1+s];
                     }
-                }
-                else
-                {
-                    s = s < 0 ? -1 : 1;
-                    if( m > _mag[j+magstep2-s] && m > _mag[j+magstep1+s] )
+
+                    if( isMax )
                     {
-                        if( m > high && !prev_flag && _map[j-mapstep] != 2 )
+                        if( m > high && !prev_flag && _prev[j] != 2 )
                         {
-                            CANNY_PUSH( _map + j );
+                            _map[j] = (uchar)2;
+                            stack.push_back( _map + j );
                             prev_flag = 1;
                         }
                         else
@@ -279,71 +270,140 @@ CV_IMPL void cvCanny( const void* srcarr, void* dstarr,
                         continue;
                     }
                 }
+                prev_flag = 0;
+                _map[j] = (uchar)1;
             }
-            prev_flag = 0;
-            _map[j] = (uchar)1;
+
+            // scroll the ring buffer
+            int* t = mag_buf[0];
+            mag_buf[0] = mag_buf[1];
+            mag_buf[1] = mag_buf[2];
+            mag_buf[2] = t;
         }
 
-        // scroll the ring buffer
-        _mag = mag_buf[0];
-        mag_buf[0] = mag_buf[1];
-        mag_buf[1] = mag_buf[2];
-        mag_buf[2] = _mag;
+        cannyTrace( stack, mapstep, stripe, stripe + mapstep*(y1 - y0) );
     }
 
-    // now track the edges (hysteresis thresholding)
-    while( stack_top > stack_bottom )
+    const Mat* src;
+    Mat* map;
+    int low, high;
+    int aperture_size;
+    bool L2gradient;
+    int stripeRows;
+};
+
+class CannyOutputInvoker
+{
+public:
+    CannyOutputInvoker( const Mat& _map, Mat& _dst ) : map(&_map), dst(&_dst) {}
+
+    void operator()( const BlockedRange& range ) const
     {
-        uchar* m;
-        if( (stack_top - stack_bottom) + 8 > maxsize )
+        int width = dst->cols;
+        for( int i = range.begin(); i < range.end(); i++ )
         {
-            int sz = (int)(stack_top - stack_bottom);
-            maxsize = MAX( maxsize * 3/2, maxsize + 8 );
-            stack.resize(maxsize);
-            stack_bottom = &stack[0];
-            stack_top = stack_bottom + sz;
-        }
+            const uchar* _map = map->ptr(i+1) + 1;
+            uchar* _dst = dst->ptr(i);
 
-        CANNY_POP(m);
-    
-        if( !m[-1] )
-            CANNY_PUSH( m - 1 );
-        if( !m[1] )
-            CANNY_PUSH( m + 1 );
-        if( !m[-mapstep-1] )
-            CANNY_PUSH( m - mapstep - 1 );
-        if( !m[-mapstep] )
-            CANNY_PUSH( m - mapstep );
-        if( !m[-mapstep+1] )
-            CANNY_PUSH( m - mapstep + 1 );
-        if( !m[mapstep-1] )
-            CANNY_PUSH( m + mapstep - 1 );
-        if( !m[mapstep] )
-            CANNY_PUSH( m + mapstep );
-        if( !m[mapstep+1] )
-            CANNY_PUSH( m + mapstep + 1 );
+            for( int j = 0; j < width; j++ )
+                _dst[j] = (uchar)-(_map[j] >> 1);
+        }
     }
 
-    // the final pass, form the final image
-    for( i = 0; i < size.height; i++ )
-    {
-        const uchar* _map = map + mapstep*(i+1) + 1;
-        uchar* _dst = dst->data.ptr + dst->step*i;
-        
-        for( j = 0; j < size.width; j++ )
-            _dst[j] = (uchar)-(_map[j] >> 1);
-    }
+protected:
+    const Mat* map;
+    Mat* dst;
+};
+
 }
 
 void cv::Canny( InputArray image, OutputArray _edges,
                 double threshold1, double threshold2,
                 int apertureSize, bool L2gradient )
 {
-    Mat src = image.getMat();
-    _edges.create(src.size(), CV_8U);
-    CvMat c_src = src, c_dst = _edges.getMat();
-    cvCanny( &c_src, &c_dst, threshold1, threshold2,
-        apertureSize + (L2gradient ? CV_CANNY_L2_GRADIENT : 0));
+    Mat _src = image.getMat();
+    CV_Assert( _src.type() == CV_8UC1 );
+    // the border of the image is replicated even when it is a ROI; the stripes
+    // are ROI's of this header, so they may only look into the neighbor stripes
+    Mat src( _src.size(), _src.type(), _src.data, _src.step );
+
+    // the C API passes the gradient flag together with the aperture size
+    if( apertureSize & CV_CANNY_L2_GRADIENT )
+        L2gradient = true;
+    apertureSize &= INT_MAX;
+    if( (apertureSize & 1) == 0 || apertureSize < 3 || apertureSize > 7 )
+        CV_Error( CV_StsBadFlag, "" );
+
+    if( threshold1 > threshold2 )
+        std::swap( threshold1, threshold2 );
+
+    _edges.create( src.size(), CV_8U );
+    Mat dst = _edges.getMat();
+    if( src.empty() )
+        return;
+
+    int low, high;
+    if( L2gradient )
+    {
+        Cv32suf ul, uh;
+        ul.f = (float)threshold1;
+        uh.f = (float)threshold2;
+
+        low = ul.i;
+        high = uh.i;
+    }
+    else
+    {
+        low = cvFloor( threshold1 );
+        high = cvFloor( threshold2 );
+    }
+
+    int height = src.rows;
+    Mat map( height + 2, src.cols + 2, CV_8U );
+    memset( map.ptr(0), 1, map.cols );
+    memset( map.ptr(height + 1), 1, map.cols );
+
+    // each stripe is traced on its own first, then the edges that cross the
+    // stripe boundaries are traced once more over the whole map
+    int nthreads = std::max(getNumThreads(), 1);
+    int stripeRows = std::max((height + nthreads - 1)/nthreads, 16);
+    int nstripes = (height + stripeRows - 1)/stripeRows;
+
+    parallel_for( BlockedRange(0, nstripes),
+                  CannyInvoker(src, map, low, high, apertureSize, L2gradient, stripeRows) );
+
+    if( nstripes > 1 )
+    {
+        vector<uchar*> stack;
+        for( int k = 1; k < nstripes; k++ )
+        {
+            for( int i = k*stripeRows; i <= k*stripeRows + 1; i++ )
+            {
+                uchar* _map = map.ptr(i);
+                for( int j = 1; j <= src.cols; j++ )
+                    if( _map[j] == 2 )
+                        stack.push_back( _map + j );
+            }
+        }
+        cannyTrace( stack, map.step, map.ptr(), map.ptr(height + 2) );
+    }
+
+    parallel_for( BlockedRange(0, height, std::max(stripeRows/4, 1)), CannyOutputInvoker(map, dst) );
+}
+
+CV_IMPL void cvCanny( const void* srcarr, void* dstarr,
+                      double low_thresh, double high_thresh,
+                      int aperture_size )
+{
+    cv::Mat src = cv::cvarrToMat(srcarr), dst = cv::cvarrToMat(dstarr);
+
+    if( src.type() != CV_8UC1 || dst.type() != CV_8UC1 )
+        CV_Error( CV_StsUnsupportedFormat, "" );
+
+    if( src.size() != dst.size() )
+        CV_Error( CV_StsUnmatchedSizes, "" );
+
+    cv::Canny( src, dst, low_thresh, high_thresh, aperture_size );
 }
 
 /* End of file. */
@@ -156,22 +156,46 @@ template<> struct ColorChannel<float>
     
 ///////////////////////////// Top-level template function ////////////////////////////////
 
-template<class Cvt> void CvtColorLoop(const Mat& srcmat, Mat& dstmat, const Cvt& cvt)
+enum { CVT_COLOR_MIN_CHUNK_AREA = 1 << 15 };
+
+template<class Cvt> class CvtColorLoopInvoker
 {
+public:
     typedef typename Cvt::channel_type _Tp;
-    Size sz = srcmat.size();
-    const uchar* src = srcmat.data;
-    uchar* dst = dstmat.data;
-    size_t srcstep = srcmat.step, dststep = dstmat.step;
-    
-    if( srcmat.isContinuous() && dstmat.isContinuous() )
+
+    CvtColorLoopInvoker(const Mat& _src, Mat& _dst, const Cvt& _cvt)
+        : src(&_src), dst(&_dst), cvt(&_cvt) {}
+
+    void operator()(const BlockedRange& range) const
     {
-        sz.width *= sz.height;
-        sz.height = 1;
-    }    
-    
-    for( ; sz.height--; src += srcstep, dst += dststep )
-        cvt((const _Tp*)src, (_Tp*)dst, sz.width);
+        const Mat& srcmat = *src;
+        Mat& dstmat = *dst;
+        Size sz(srcmat.cols, range.end() - range.begin());
+        const uchar* src = srcmat.ptr(range.begin());
+        uchar* dst = dstmat.ptr(range.begin());
+        size_t srcstep = srcmat.step, dststep = dstmat.step;
+
+        if( srcmat.isContinuous() && dstmat.isContinuous() )
+        {
+            sz.width *= sz.height;
+            sz.height = 1;
+        }
+
+        for( ; sz.height--; src += srcstep, dst += dststep )
+            (*cvt)((const _Tp*)src, (_Tp*)dst, sz.width);
+    }
+
+private:
+    const Mat* src;
+    Mat* dst;
+    const Cvt* cvt;
+};
+
+// every row is converted independently, so the image is processed in parallel stripes
+template<class Cvt> void CvtColorLoop(const Mat& srcmat, Mat& dstmat, const Cvt& cvt)
+{
+    int grain = std::max((int)CVT_COLOR_MIN_CHUNK_AREA/std::max(srcmat.cols, 1), 1);
+    parallel_for(BlockedRange(0, srcmat.rows, grain), CvtColorLoopInvoker<Cvt>(srcmat, dstmat, cvt));
 }
     
     
@@ -315,6 +339,77 @@ struct Gray2RGB
     
     int dstcn;
 };
+
+
+template<> struct Gray2RGB<uchar>
+{
+    typedef uchar channel_type;
+
+    Gray2RGB<uchar>(int _dstcn) : dstcn(_dstcn)
+    {
+#if CV_SSE2
+        haveSSE = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+    }
+
+    void operator()(const uchar* src, uchar* dst, int n) const
+    {
+        int i = 0;
+        if( dstcn == 3 )
+        {
+#if CV_SSE2
+            if( haveSSE )
+                for( ; i <= n - 32; i += 32, dst += 96 )
+                {
+                    __m128i v0 = _mm_loadu_si128((const __m128i*)(src + i));
+                    __m128i v1 = _mm_loadu_si128((const __m128i*)(src + i + 16));
+                    __m128i v2 = v0, v3 = v1, v4 = v0, v5 = v1;
+                    _mm_interleave3_epi8(v0, v1, v2, v3, v4, v5);
+                    _mm_storeu_si128((__m128i*)dst, v0);
+                    _mm_storeu_si128((__m128i*)(dst + 16), v1);
+                    _mm_storeu_si128((__m128i*)(dst + 32), v2);
+                    _mm_storeu_si128((__m128i*)(dst + 48), v3);
+                    _mm_storeu_si128((__m128i*)(dst + 64), v4);
+                    _mm_storeu_si128((__m128i*)(dst + 80), v5);
+                }
+#endif
+            for( ; i < n; i++, dst += 3 )
+            {
+                dst[0] = dst[1] = dst[2] = src[i];
+            }
+        }
+        else
+        {
+            uchar alpha = ColorChannel<uchar>::max();
+#if CV_SSE2
+            if( haveSSE )
+            {
+                __m128i a = _mm_set1_epi8((char)alpha);
+                for( ; i <= n - 16; i += 16, dst += 64 )
+                {
+                    __m128i v = _mm_loadu_si128((const __m128i*)(src + i));
+                    __m128i gg0 = _mm_unpacklo_epi8(v, v), gg1 = _mm_unpackhi_epi8(v, v);
+                    __m128i ga0 = _mm_unpacklo_epi8(v, a), ga1 = _mm_unpackhi_epi8(v, a);
+                    _mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi16(gg0, ga0));
+                    _mm_storeu_si128((__m128i*)(dst + 16), _mm_unpackhi_epi16(gg0, ga0));
+                    _mm_storeu_si128((__m128i*)(dst + 32), _mm_unpacklo_epi16(gg1, ga1));
+                    _mm_storeu_si128((__m128i*)(dst + 48), _mm_unpackhi_epi16(gg1, ga1));
+                }
+            }
+#endif
+            for( ; i < n; i++, dst += 4 )
+            {
+                dst[0] = dst[1] = dst[2] = src[i];
+                dst[3] = alpha;
+            }
+        }
+    }
+
+    int dstcn;
+#if CV_SSE2
+    bool haveSSE;
+#endif
+};
   
 
 struct Gray2RGB5x5
@@ -356,6 +451,67 @@ enum
 };
 
 
+#if CV_SSE2
+
+// buf[j] = src[j]*scale[j%3] + delta[j%3] for packed 3-channel 8-bit data,
+// 4 pixels per iteration. Returns the number of processed elements.
+static int cvtBlock3_8u32f( const uchar* src, float* buf, int n3, const float* scale, const float* delta )
+{
+    int j = 0;
+    if( !checkHardwareSupport(CV_CPU_SSE2) )
+        return 0;
+
+    __m128 s0 = _mm_setr_ps(scale[0], scale[1], scale[2], scale[0]);
+    __m128 s1 = _mm_setr_ps(scale[1], scale[2], scale[0], scale[1]);
+    __m128 s2 = _mm_setr_ps(scale[2], scale[0], scale[1], scale[2]);
+    __m128 d0 = _mm_setr_ps(delta[0], delta[1], delta[2], delta[0]);
+    __m128 d1 = _mm_setr_ps(delta[1], delta[2], delta[0], delta[1]);
+    __m128 d2 = _mm_setr_ps(delta[2], delta[0], delta[1], delta[2]);
+    __m128i z = _mm_setzero_si128();
+
+    for( ; j <= n3 - 16; j += 12 )
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)(src + j));
+        __m128i w0 = _mm_unpacklo_epi8(v, z), w1 = _mm_unpackhi_epi8(v, z);
+        _mm_storeu_ps(buf + j, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(w0, z)), s0), d0));
+        _mm_storeu_ps(buf + j + 4, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(w0, z)), s1), d1));
+        _mm_storeu_ps(buf + j + 8, _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(w1, z)), s2), d2));
+    }
+    return j;
+}
+
+// dst[j] = saturate_cast<uchar>(buf[j]*255), 16 pixels per iteration.
+// Returns the number of processed elements.
+static int cvtBlock3_32f8u( const float* buf, uchar* dst, int n3 )
+{
+    int j = 0;
+    if( !checkHardwareSupport(CV_CPU_SSE2) )
+        return 0;
+
+    __m128 s = _mm_set1_ps(255.f);
+    for( ; j <= n3 - 48; j += 48 )
+    {
+        for( int k = 0; k < 48; k += 16 )
+        {
+            __m128i v0 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(buf + j + k), s));
+            __m128i v1 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(buf + j + k + 4), s));
+            __m128i v2 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(buf + j + k + 8), s));
+            __m128i v3 = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(buf + j + k + 12), s));
+            _mm_storeu_si128((__m128i*)(dst + j + k),
+                             _mm_packus_epi16(_mm_packs_epi32(v0, v1), _mm_packs_epi32(v2, v3)));
+        }
+    }
+    return j;
+}
+
+#else
+
+static int cvtBlock3_8u32f( const uchar*, float*, int, const float*, const float* ) { return 0; }
+static int cvtBlock3_32f8u( const float*, uchar*, int ) { return 0; }
+
+#endif
+
+
 struct RGB5x52Gray
 {
     typedef uchar channel_type;
@@ -426,16 +582,87 @@ template<> struct RGB2Gray<uchar>
             tab[i+256] = g;
             tab[i+512] = r;
         }
+
+#if CV_SSE2
+        haveSSE = checkHardwareSupport(CV_CPU_SSE2) && (srccn == 3 || srccn == 4) &&
+            db >= 0 && dg >= 0 && dr >= 0 && std::max(db, std::max(dg, dr)) <= SHRT_MAX;
+        // src[0]*db + src[1]*dg + src[2]*dr + half is evaluated as two or three _mm_madd_epi16
+        c01 = _mm_set1_epi32((dg << 16) + db);
+        c2h = _mm_set1_epi32(((1 << (yuv_shift-1)) << 16) + dr);
+        c02 = _mm_set1_epi32((dr << 16) + db);
+        c1 = _mm_set1_epi32(dg);
+#endif
+    }
+
+#if CV_SSE2
+    // converts 8 pixels given as 16-bit planes
+    __m128i gray8(__m128i p0, __m128i p1, __m128i p2) const
+    {
+        __m128i one = _mm_set1_epi16(1);
+        __m128i y0 = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(p0, p1), c01),
+                                   _mm_madd_epi16(_mm_unpacklo_epi16(p2, one), c2h));
+        __m128i y1 = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(p0, p1), c01),
+                                   _mm_madd_epi16(_mm_unpackhi_epi16(p2, one), c2h));
+        return _mm_packs_epi32(_mm_srai_epi32(y0, yuv_shift), _mm_srai_epi32(y1, yuv_shift));
     }
+
+    // converts 16 pixels given as 8-bit planes
+    __m128i gray16(__m128i p0, __m128i p1, __m128i p2) const
+    {
+        __m128i z = _mm_setzero_si128();
+        __m128i y0 = gray8(_mm_unpacklo_epi8(p0, z), _mm_unpacklo_epi8(p1, z), _mm_unpacklo_epi8(p2, z));
+        __m128i y1 = gray8(_mm_unpackhi_epi8(p0, z), _mm_unpackhi_epi8(p1, z), _mm_unpackhi_epi8(p2, z));
+        return _mm_packus_epi16(y0, y1);
+    }
+
+    // converts 4 packed 4-channel pixels
+    __m128i gray4x4(const uchar* src) const
+    {
+        __m128i v = _mm_loadu_si128((const __m128i*)src);
+        __m128i y = _mm_add_epi32(_mm_madd_epi16(_mm_and_si128(v, _mm_set1_epi16(0x00ff)), c02),
+                                  _mm_madd_epi16(_mm_srli_epi16(v, 8), c1));
+        return _mm_srai_epi32(_mm_add_epi32(y, _mm_set1_epi32(1 << (yuv_shift-1))), yuv_shift);
+    }
+#endif
+
     void operator()(const uchar* src, uchar* dst, int n) const
     {
-        int scn = srccn;
+        int scn = srccn, i = 0;
 		const int* _tab = tab;
-        for(int i = 0; i < n; i++, src += scn)
+#if CV_SSE2
+        if( haveSSE )
+        {
+            if( scn == 3 )
+                for( ; i <= n - 32; i += 32, src += 96 )
+                {
+                    __m128i v0 = _mm_loadu_si128((const __m128i*)src);
+                    __m128i v1 = _mm_loadu_si128((const __m128i*)(src + 16));
+                    __m128i v2 = _mm_loadu_si128((const __m128i*)(src + 32));
+                    __m128i v3 = _mm_loadu_si128((const __m128i*)(src + 48));
+                    __m128i v4 = _mm_loadu_si128((const __m128i*)(src + 64));
+                    __m128i v5 = _mm_loadu_si128((const __m128i*)(src + 80));
+                    _mm_deinterleave3_epi8(v0, v1, v2, v3, v4, v5);
+                    _mm_storeu_si128((__m128i*)(dst + i), gray16(v0, v2, v4));
+                    _mm_storeu_si128((__m128i*)(dst + i + 16), gray16(v1, v3, v5));
+                }
+            else
+                for( ; i <= n - 16; i += 16, src += 64 )
+                {
+                    __m128i y0 = _mm_packs_epi32(gray4x4(src), gray4x4(src + 16));
+                    __m128i y1 = _mm_packs_epi32(gray4x4(src + 32), gray4x4(src + 48));
+                    _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(y0, y1));
+                }
+        }
+#endif
+        for( ; i < n; i++, src += scn )
             dst[i] = (uchar)((_tab[src[0]] + _tab[src[1]+256] + _tab[src[2]+512]) >> yuv_shift);
     }
     int srccn, blueIdx;
     int tab[256*3];
+#if CV_SSE2
+    bool haveSSE;
+    __m128i c01, c2h, c02, c1;
+#endif
 };
 
     
@@ -783,6 +1010,27 @@ template<typename _Tp> struct XYZ2RGB_i
 ////////////////////////////////////// RGB <-> HSV ///////////////////////////////////////
 
 
+enum { hsv_shift = 12 };
+static int sdiv_table[256];
+static int hdiv_table180[256];
+static int hdiv_table256[256];
+
+static void initHSVTabs()
+{
+    static volatile bool initialized = false;
+    if( !initialized )
+    {
+        sdiv_table[0] = hdiv_table180[0] = hdiv_table256[0] = 0;
+        for( int i = 1; i < 256; i++ )
+        {
+            sdiv_table[i] = saturate_cast<int>((255 << hsv_shift)/(1.*i));
+            hdiv_table180[i] = saturate_cast<int>((180 << hsv_shift)/(6.*i));
+            hdiv_table256[i] = saturate_cast<int>((256 << hsv_shift)/(6.*i));
+        }
+        initialized = true;
+    }
+}
+
 struct RGB2HSV_b
 {
     typedef uchar channel_type;
@@ -791,34 +1039,17 @@ struct RGB2HSV_b
     : srccn(_srccn), blueIdx(_blueIdx), hrange(_hrange)
     {
         CV_Assert( hrange == 180 || hrange == 256 );
+        // the tables are filled here, before the rows are converted in parallel
+        initHSVTabs();
     }
     
     void operator()(const uchar* src, uchar* dst, int n) const
     {
         int i, bidx = blueIdx, scn = srccn;
-        const int hsv_shift = 12;
-        
-        static int sdiv_table[256];
-        static int hdiv_table180[256];
-        static int hdiv_table256[256];
-        static volatile bool initialized = false;
-        
         int hr = hrange;
         const int* hdiv_table = hr == 180 ? hdiv_table180 : hdiv_table256;
         n *= 3;
         
-        if( !initialized )
-        {
-            sdiv_table[0] = hdiv_table180[0] = hdiv_table256[0] = 0;
-            for( i = 1; i < 256; i++ )
-            {
-                sdiv_table[i] = saturate_cast<int>((255 << hsv_shift)/(1.*i));
-                hdiv_table180[i] = saturate_cast<int>((180 << hsv_shift)/(6.*i));
-                hdiv_table256[i] = saturate_cast<int>((256 << hsv_shift)/(6.*i));
-            }
-            initialized = true;
-        }
-        
         for( i = 0; i < n; i += 3, src += scn )
         {
             int b = src[bidx], g = src[1], r = src[bidx^2];
@@ -971,12 +1202,15 @@ struct HSV2RGB_b
         int i, j, dcn = dstcn;
         uchar alpha = ColorChannel<uchar>::max();
         float buf[3*BLOCK_SIZE];
+        static const float scale[] = { 1.f, 1.f/255.f, 1.f/255.f };
+        static const float delta[] = { 0.f, 0.f, 0.f };
         
         for( i = 0; i < n; i += BLOCK_SIZE, src += BLOCK_SIZE*3 )
         {
             int dn = std::min(n - i, (int)BLOCK_SIZE);
             
-            for( j = 0; j < dn*3; j += 3 )
+            j = cvtBlock3_8u32f(src, buf, dn*3, scale, delta);
+            for( ; j < dn*3; j += 3 )
             {
                 buf[j] = src[j];
                 buf[j+1] = src[j+1]*(1.f/255.f);
@@ -984,7 +1218,13 @@ struct HSV2RGB_b
             }
             cvt(buf, buf, dn);
             
-            for( j = 0; j < dn*3; j += 3, dst += dcn )
+            j = 0;
+            if( dcn == 3 )
+            {
+                j = cvtBlock3_32f8u(buf, dst, dn*3);
+                dst += j;
+            }
+            for( ; j < dn*3; j += 3, dst += dcn )
             {
                 dst[0] = saturate_cast<uchar>(buf[j]*255.f);
                 dst[1] = saturate_cast<uchar>(buf[j+1]*255.f);
@@ -1171,12 +1411,15 @@ struct HLS2RGB_b
         int i, j, dcn = dstcn;
         uchar alpha = ColorChannel<uchar>::max();
         float buf[3*BLOCK_SIZE];
+        static const float scale[] = { 1.f, 1.f/255.f, 1.f/255.f };
+        static const float delta[] = { 0.f, 0.f, 0.f };
         
         for( i = 0; i < n; i += BLOCK_SIZE, src += BLOCK_SIZE*3 )
         {
             int dn = std::min(n - i, (int)BLOCK_SIZE);
             
-            for( j = 0; j < dn*3; j += 3 )
+            j = cvtBlock3_8u32f(src, buf, dn*3, scale, delta);
+            for( ; j < dn*3; j += 3 )
             {
                 buf[j] = src[j];
                 buf[j+1] = src[j+1]*(1.f/255.f);
@@ -1184,7 +1427,13 @@ struct HLS2RGB_b
             }
             cvt(buf, buf, dn);
             
-            for( j = 0; j < dn*3; j += 3, dst += dcn )
+            j = 0;
+            if( dcn == 3 )
+            {
+                j = cvtBlock3_32f8u(buf, dst, dn*3);
+                dst += j;
+            }
+            for( ; j < dn*3; j += 3, dst += dcn )
             {
                 dst[0] = saturate_cast<uchar>(buf[j]*255.f);
                 dst[1] = saturate_cast<uchar>(buf[j+1]*255.f);
@@ -1464,12 +1713,15 @@ struct Lab2RGB_b
         int i, j, dcn = dstcn;
         uchar alpha = ColorChannel<uchar>::max();
         float buf[3*BLOCK_SIZE];
+        static const float scale[] = { 100.f/255.f, 1.f, 1.f };
+        static const float delta[] = { 0.f, -128.f, -128.f };
         
         for( i = 0; i < n; i += BLOCK_SIZE, src += BLOCK_SIZE*3 )
         {
             int dn = std::min(n - i, (int)BLOCK_SIZE);
             
-            for( j = 0; j < dn*3; j += 3 )
+            j = cvtBlock3_8u32f(src, buf, dn*3, scale, delta);
+            for( ; j < dn*3; j += 3 )
             {
                 buf[j] = src[j]*(100.f/255.f);
                 buf[j+1] = (float)(src[j+1] - 128);
@@ -1477,7 +1729,13 @@ struct Lab2RGB_b
             }
             cvt(buf, buf, dn);
             
-            for( j = 0; j < dn*3; j += 3, dst += dcn )
+            j = 0;
+            if( dcn == 3 )
+            {
+                j = cvtBlock3_32f8u(buf, dst, dn*3);
+                dst += j;
+            }
+            for( ; j < dn*3; j += 3, dst += dcn )
             {
                 dst[0] = saturate_cast<uchar>(buf[j]*255.f);
                 dst[1] = saturate_cast<uchar>(buf[j+1]*255.f);
@@ -1695,12 +1953,15 @@ struct Luv2RGB_b
         int i, j, dcn = dstcn;
         uchar alpha = ColorChannel<uchar>::max();
         float buf[3*BLOCK_SIZE];
+        static const float scale[] = { 100.f/255.f, 1.388235294117647f, 1.003921568627451f };
+        static const float delta[] = { 0.f, -134.f, -140.f };
         
         for( i = 0; i < n; i += BLOCK_SIZE, src += BLOCK_SIZE*3 )
         {
             int dn = std::min(n - i, (int)BLOCK_SIZE);
             
-            for( j = 0; j < dn*3; j += 3 )
+            j = cvtBlock3_8u32f(src, buf, dn*3, scale, delta);
+            for( ; j < dn*3; j += 3 )
             {
                 buf[j] = src[j]*(100.f/255.f);
                 buf[j+1] = (float)(src[j+1]*1.388235294117647f - 134.f);
@@ -1708,7 +1969,13 @@ struct Luv2RGB_b
             }
             cvt(buf, buf, dn);
             
-            for( j = 0; j < dn*3; j += 3, dst += dcn )
+            j = 0;
+            if( dcn == 3 )
+            {
+                j = cvtBlock3_32f8u(buf, dst, dn*3);
+                dst += j;
+            }
+            for( ; j < dn*3; j += 3, dst += dcn )
             {
                 dst[0] = saturate_cast<uchar>(buf[j]*255.f);
                 dst[1] = saturate_cast<uchar>(buf[j+1]*255.f);
@@ -1885,92 +2152,133 @@ public:
 typedef SIMDBayerStubInterpolator_<uchar> SIMDBayerInterpolator_8u;
 #endif
     
+// the demosaicing reads 3 (VNG: 5) source rows per destination row, but the destination
+// rows are independent, so the image is processed in parallel stripes of rows
+static inline int bayerGrain( Size size )
+{
+    return std::max((int)CVT_COLOR_MIN_CHUNK_AREA/std::max(size.width, 1), 1);
+}
+
 template<typename T, class SIMDInterpolator>
-static void Bayer2Gray_( const Mat& srcmat, Mat& dstmat, int code )
+class Bayer2Gray_Invoker
 {
-    SIMDInterpolator vecOp;
-    const int R2Y = 4899;
-    const int G2Y = 9617;
-    const int B2Y = 1868;
-    const int SHIFT = 14;
-    
-    const T* bayer0 = (const T*)srcmat.data;
-    int bayer_step = (int)(srcmat.step/sizeof(T));
-    T* dst0 = (T*)dstmat.data;
-    int dst_step = (int)(dstmat.step/sizeof(T));
-    Size size = srcmat.size();
-    int bcoeff = B2Y, rcoeff = R2Y;
-    int start_with_green = code == CV_BayerGB2GRAY || code == CV_BayerGR2GRAY;
-    bool brow = true;
-    
-    if( code != CV_BayerBG2GRAY && code != CV_BayerGB2GRAY )
+public:
+    Bayer2Gray_Invoker(const Mat& _src, Mat& _dst, int _code)
+        : src(&_src), dst(&_dst), code(_code) {}
+
+    // converts the rows range.begin()+1 ... range.end() of the destination
+    void operator()(const BlockedRange& range) const
     {
-        brow = false;
-        std::swap(bcoeff, rcoeff);
-    }
-    
-    dst0 += dst_step + 1;
-    size.height -= 2;
-    size.width -= 2;
+        const Mat& srcmat = *src;
+        Mat& dstmat = *dst;
+        SIMDInterpolator vecOp;
+        const int R2Y = 4899;
+        const int G2Y = 9617;
+        const int B2Y = 1868;
+        const int SHIFT = 14;
+    
+        int bayer_step = (int)(srcmat.step/sizeof(T));
+        int dst_step = (int)(dstmat.step/sizeof(T));
+        const T* bayer0 = (const T*)srcmat.data + range.begin()*bayer_step;
+        T* dst0 = (T*)dstmat.data + range.begin()*dst_step;
+        Size size(srcmat.cols, range.end() - range.begin());
+        int bcoeff = B2Y, rcoeff = R2Y;
+        int start_with_green = code == CV_BayerGB2GRAY || code == CV_BayerGR2GRAY;
+        bool brow = true;
+    
+        if( code != CV_BayerBG2GRAY && code != CV_BayerGB2GRAY )
+        {
+            brow = false;
+            std::swap(bcoeff, rcoeff);
+        }
     
-    for( ; size.height-- > 0; bayer0 += bayer_step, dst0 += dst_step )
-    {
-        unsigned t0, t1, t2;
-        const T* bayer = bayer0;
-        T* dst = dst0;
-        const T* bayer_end = bayer + size.width;
-        
-        if( size.width <= 0 )
+        // the pattern alternates from row to row
+        if( range.begin() % 2 != 0 )
         {
-            dst[-1] = dst[size.width] = 0;
-            continue;
+            brow = !brow;
+            std::swap(bcoeff, rcoeff);
+            start_with_green = !start_with_green;
         }
-        
-        if( start_with_green )
+    
+        dst0 += dst_step + 1;
+        size.width -= 2;
+    
+        for( ; size.height-- > 0; bayer0 += bayer_step, dst0 += dst_step )
         {
-            t0 = (bayer[1] + bayer[bayer_step*2+1])*rcoeff;
-            t1 = (bayer[bayer_step] + bayer[bayer_step+2])*bcoeff;
-            t2 = bayer[bayer_step+1]*(2*G2Y);
-            
-            dst[0] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+1);
-            bayer++;
-            dst++;
-        }
+            unsigned t0, t1, t2;
+            const T* bayer = bayer0;
+            T* dst = dst0;
+            const T* bayer_end = bayer + size.width;
         
-        int delta = vecOp.bayer2Gray(bayer, bayer_step, dst, size.width, bcoeff, G2Y, rcoeff);
-        bayer += delta;
-        dst += delta;
+            if( size.width <= 0 )
+            {
+                dst[-1] = dst[size.width] = 0;
+                continue;
+            }
         
-        for( ; bayer <= bayer_end - 2; bayer += 2, dst += 2 )
-        {
-            t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] + bayer[bayer_step*2+2])*rcoeff;
-            t1 = (bayer[1] + bayer[bayer_step] + bayer[bayer_step+2] + bayer[bayer_step*2+1])*G2Y;
-            t2 = bayer[bayer_step+1]*(4*bcoeff);
-            dst[0] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+2);
+            if( start_with_green )
+            {
+                t0 = (bayer[1] + bayer[bayer_step*2+1])*rcoeff;
+                t1 = (bayer[bayer_step] + bayer[bayer_step+2])*bcoeff;
+                t2 = bayer[bayer_step+1]*(2*G2Y);
             
-            t0 = (bayer[2] + bayer[bayer_step*2+2])*rcoeff;
-            t1 = (bayer[bayer_step+1] + bayer[bayer_step+3])*bcoeff;
-            t2 = bayer[bayer_step+2]*(2*G2Y);
-            dst[1] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+1);
-        }
+                dst[0] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+1);
+                bayer++;
+                dst++;
+            }
         
-        if( bayer < bayer_end )
-        {
-            t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] + bayer[bayer_step*2+2])*rcoeff;
-            t1 = (bayer[1] + bayer[bayer_step] + bayer[bayer_step+2] + bayer[bayer_step*2+1])*G2Y;
-            t2 = bayer[bayer_step+1]*(4*bcoeff);
-            dst[0] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+2);
-            bayer++;
-            dst++;
-        }
+            int delta = vecOp.bayer2Gray(bayer, bayer_step, dst, size.width, bcoeff, G2Y, rcoeff);
+            bayer += delta;
+            dst += delta;
         
-        dst0[-1] = dst0[0];
-        dst0[size.width] = dst0[size.width-1];
+            for( ; bayer <= bayer_end - 2; bayer += 2, dst += 2 )
+            {
+                t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] + bayer[bayer_step*2+2])*rcoeff;
+                t1 = (bayer[1] + bayer[bayer_step] + bayer[bayer_step+2] + bayer[bayer_step*2+1])*G2Y;
+                t2 = bayer[bayer_step+1]*(4*bcoeff);
+                dst[0] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+2);
+            
+                t0 = (bayer[2] + bayer[bayer_step*2+2])*rcoeff;
+                t1 = (bayer[bayer_step+1] + bayer[bayer_step+3])*bcoeff;
+                t2 = bayer[bayer_step+2]*(2*G2Y);
+                dst[1] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+1);
+            }
+        
+            if( bayer < bayer_end )
+            {
+                t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] + bayer[bayer_step*2+2])*rcoeff;
+                t1 = (bayer[1] + bayer[bayer_step] + bayer[bayer_step+2] + bayer[bayer_step*2+1])*G2Y;
+                t2 = bayer[bayer_step+1]*(4*bcoeff);
+                dst[0] = (T)CV_DESCALE(t0 + t1 + t2, SHIFT+2);
+                bayer++;
+                dst++;
+            }
         
-        brow = !brow;
-        std::swap(bcoeff, rcoeff);
-        start_with_green = !start_with_green;
+            dst0[-1] = dst0[0];
+            dst0[size.width] = dst0[size.width-1];
+        
+            brow = !brow;
+            std::swap(bcoeff, rcoeff);
+            start_with_green = !start_with_green;
+        }
     }
+
+private:
+    const Mat* src;
+    Mat* dst;
+    int code;
+};
+
+template<typename T, class SIMDInterpolator>
+static void Bayer2Gray_( const Mat& srcmat, Mat& dstmat, int code )
+{
+    Size size = srcmat.size();
+    int dst_step = (int)(dstmat.step/sizeof(T));
+    T* dst0;
+    
+    if( size.height > 2 )
+        parallel_for(BlockedRange(0, size.height - 2, bayerGrain(size)),
+                     Bayer2Gray_Invoker<T, SIMDInterpolator>(srcmat, dstmat, code));
     
     size = dstmat.size();
     dst0 = (T*)dstmat.data;
@@ -1987,113 +2295,146 @@ static void Bayer2Gray_( const Mat& srcmat, Mat& dstmat, int code )
         }
 }
 
-template<typename T, class SIMDInterpolator>    
-static void Bayer2RGB_( const Mat& srcmat, Mat& dstmat, int code )
+template<typename T, class SIMDInterpolator>
+class Bayer2RGB_Invoker
 {
-    SIMDInterpolator vecOp;
-    const T* bayer0 = (const T*)srcmat.data;
-    int bayer_step = (int)(srcmat.step/sizeof(T));
-    T* dst0 = (T*)dstmat.data;
-    int dst_step = (int)(dstmat.step/sizeof(T));
-    Size size = srcmat.size();
-    int blue = code == CV_BayerBG2BGR || code == CV_BayerGB2BGR ? -1 : 1;
-    int start_with_green = code == CV_BayerGB2BGR || code == CV_BayerGR2BGR;
-    
-    dst0 += dst_step + 3 + 1;
-    size.height -= 2;
-    size.width -= 2;
-        
-    for( ; size.height-- > 0; bayer0 += bayer_step, dst0 += dst_step )
+public:
+    Bayer2RGB_Invoker(const Mat& _src, Mat& _dst, int _code)
+        : src(&_src), dst(&_dst), code(_code) {}
+
+    // converts the rows range.begin()+1 ... range.end() of the destination
+    void operator()(const BlockedRange& range) const
     {
-        int t0, t1;
-        const T* bayer = bayer0;
-        T* dst = dst0;
-        const T* bayer_end = bayer + size.width;
-        
-        if( size.width <= 0 )
-        {
-            dst[-4] = dst[-3] = dst[-2] = dst[size.width*3-1] =
-            dst[size.width*3] = dst[size.width*3+1] = 0;
-            continue;
+        const Mat& srcmat = *src;
+        Mat& dstmat = *dst;
+        SIMDInterpolator vecOp;
+        int bayer_step = (int)(srcmat.step/sizeof(T));
+        int dst_step = (int)(dstmat.step/sizeof(T));
+        const T* bayer0 = (const T*)srcmat.data + range.begin()*bayer_step;
+        T* dst0 = (T*)dstmat.data + range.begin()*dst_step;
+        Size size(srcmat.cols, range.end() - range.begin());
+        int blue = code == CV_BayerBG2BGR || code == CV_BayerGB2BGR ? -1 : 1;
+        int start_with_green = code == CV_BayerGB2BGR || code == CV_BayerGR2BGR;
+    
+        // the pattern alternates from row to row
+        if( range.begin() % 2 != 0 )
+        {
+            blue = -blue;
+            start_with_green = !start_with_green;
         }
+    
+        dst0 += dst_step + 3 + 1;
+        size.width -= 2;
         
-        if( start_with_green )
+        for( ; size.height-- > 0; bayer0 += bayer_step, dst0 += dst_step )
         {
-            t0 = (bayer[1] + bayer[bayer_step*2+1] + 1) >> 1;
-            t1 = (bayer[bayer_step] + bayer[bayer_step+2] + 1) >> 1;
-            dst[-blue] = (T)t0;
-            dst[0] = bayer[bayer_step+1];
-            dst[blue] = (T)t1;
-            bayer++;
-            dst += 3;
-        }
+            int t0, t1;
+            const T* bayer = bayer0;
+            T* dst = dst0;
+            const T* bayer_end = bayer + size.width;
         
-        int delta = vecOp.bayer2RGB(bayer, bayer_step, dst, size.width, blue);
-        bayer += delta;
-        dst += delta*3;
+            if( size.width <= 0 )
+            {
+                dst[-4] = dst[-3] = dst[-2] = dst[size.width*3-1] =
+                dst[size.width*3] = dst[size.width*3+1] = 0;
+                continue;
+            }
+        
+            if( start_with_green )
+            {
+                t0 = (bayer[1] + bayer[bayer_step*2+1] + 1) >> 1;
+                t1 = (bayer[bayer_step] + bayer[bayer_step+2] + 1) >> 1;
+                dst[-blue] = (T)t0;
+                dst[0] = bayer[bayer_step+1];
+                dst[blue] = (T)t1;
+                bayer++;
+                dst += 3;
+            }
+        
+            int delta = vecOp.bayer2RGB(bayer, bayer_step, dst, size.width, blue);
+            bayer += delta;
+            dst += delta*3;
                 
-        if( blue > 0 )
-        {
-            for( ; bayer <= bayer_end - 2; bayer += 2, dst += 6 )
+            if( blue > 0 )
             {
-                t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] +
-                      bayer[bayer_step*2+2] + 2) >> 2;
-                t1 = (bayer[1] + bayer[bayer_step] +
-                      bayer[bayer_step+2] + bayer[bayer_step*2+1]+2) >> 2;
-                dst[-1] = (T)t0;
-                dst[0] = (T)t1;
-                dst[1] = bayer[bayer_step+1];
+                for( ; bayer <= bayer_end - 2; bayer += 2, dst += 6 )
+                {
+                    t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] +
+                          bayer[bayer_step*2+2] + 2) >> 2;
+                    t1 = (bayer[1] + bayer[bayer_step] +
+                          bayer[bayer_step+2] + bayer[bayer_step*2+1]+2) >> 2;
+                    dst[-1] = (T)t0;
+                    dst[0] = (T)t1;
+                    dst[1] = bayer[bayer_step+1];
                 
-                t0 = (bayer[2] + bayer[bayer_step*2+2] + 1) >> 1;
-                t1 = (bayer[bayer_step+1] + bayer[bayer_step+3] + 1) >> 1;
-                dst[2] = (T)t0;
-                dst[3] = bayer[bayer_step+2];
-                dst[4] = (T)t1;
+                    t0 = (bayer[2] + bayer[bayer_step*2+2] + 1) >> 1;
+                    t1 = (bayer[bayer_step+1] + bayer[bayer_step+3] + 1) >> 1;
+                    dst[2] = (T)t0;
+                    dst[3] = bayer[bayer_step+2];
+                    dst[4] = (T)t1;
+                }
             }
-        }
-        else
-        {
-            for( ; bayer <= bayer_end - 2; bayer += 2, dst += 6 )
+            else
+            {
+                for( ; bayer <= bayer_end - 2; bayer += 2, dst += 6 )
+                {
+                    t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] +
+                          bayer[bayer_step*2+2] + 2) >> 2;
+                    t1 = (bayer[1] + bayer[bayer_step] +
+                          bayer[bayer_step+2] + bayer[bayer_step*2+1]+2) >> 2;
+                    dst[1] = (T)t0;
+                    dst[0] = (T)t1;
+                    dst[-1] = bayer[bayer_step+1];
+                
+                    t0 = (bayer[2] + bayer[bayer_step*2+2] + 1) >> 1;
+                    t1 = (bayer[bayer_step+1] + bayer[bayer_step+3] + 1) >> 1;
+                    dst[4] = (T)t0;
+                    dst[3] = bayer[bayer_step+2];
+                    dst[2] = (T)t1;
+                }
+            }
+        
+            if( bayer < bayer_end )
             {
                 t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] +
                       bayer[bayer_step*2+2] + 2) >> 2;
                 t1 = (bayer[1] + bayer[bayer_step] +
                       bayer[bayer_step+2] + bayer[bayer_step*2+1]+2) >> 2;
-                dst[1] = (T)t0;
+                dst[-blue] = (T)t0;
                 dst[0] = (T)t1;
-                dst[-1] = bayer[bayer_step+1];
-                
-                t0 = (bayer[2] + bayer[bayer_step*2+2] + 1) >> 1;
-                t1 = (bayer[bayer_step+1] + bayer[bayer_step+3] + 1) >> 1;
-                dst[4] = (T)t0;
-                dst[3] = bayer[bayer_step+2];
-                dst[2] = (T)t1;
+                dst[blue] = bayer[bayer_step+1];
+                bayer++;
+                dst += 3;
             }
-        }
-        
-        if( bayer < bayer_end )
-        {
-            t0 = (bayer[0] + bayer[2] + bayer[bayer_step*2] +
-                  bayer[bayer_step*2+2] + 2) >> 2;
-            t1 = (bayer[1] + bayer[bayer_step] +
-                  bayer[bayer_step+2] + bayer[bayer_step*2+1]+2) >> 2;
-            dst[-blue] = (T)t0;
-            dst[0] = (T)t1;
-            dst[blue] = bayer[bayer_step+1];
-            bayer++;
-            dst += 3;
-        }
         
-        dst0[-4] = dst0[-1];
-        dst0[-3] = dst0[0];
-        dst0[-2] = dst0[1];
-        dst0[size.width*3-1] = dst0[size.width*3-4];
-        dst0[size.width*3] = dst0[size.width*3-3];
-        dst0[size.width*3+1] = dst0[size.width*3-2];
+            dst0[-4] = dst0[-1];
+            dst0[-3] = dst0[0];
+            dst0[-2] = dst0[1];
+            dst0[size.width*3-1] = dst0[size.width*3-4];
+            dst0[size.width*3] = dst0[size.width*3-3];
+            dst0[size.width*3+1] = dst0[size.width*3-2];
         
-        blue = -blue;
-        start_with_green = !start_with_green;
+            blue = -blue;
+            start_with_green = !start_with_green;
+        }
     }
+
+private:
+    const Mat* src;
+    Mat* dst;
+    int code;
+};
+
+template<typename T, class SIMDInterpolator>    
+static void Bayer2RGB_( const Mat& srcmat, Mat& dstmat, int code )
+{
+    Size size = srcmat.size();
+    int dst_step = (int)(dstmat.step/sizeof(T));
+    T* dst0;
+    
+    if( size.height > 2 )
+        parallel_for(BlockedRange(0, size.height - 2, bayerGrain(size)),
+                     Bayer2RGB_Invoker<T, SIMDInterpolator>(srcmat, dstmat, code));
     
     size = dstmat.size();
     dst0 = (T*)dstmat.data;
@@ -2113,532 +2454,567 @@ static void Bayer2RGB_( const Mat& srcmat, Mat& dstmat, int code )
     
 /////////////////// Demosaicing using Variable Number of Gradients ///////////////////////
     
-static void Bayer2RGB_VNG_8u( const Mat& srcmat, Mat& dstmat, int code )
+class Bayer2RGB_VNG_8u_Invoker
 {
-    const uchar* bayer = srcmat.data;
-    int bstep = (int)srcmat.step;
-    uchar* dst = dstmat.data;
-    int dststep = (int)dstmat.step;
-    Size size = srcmat.size();
+public:
+    Bayer2RGB_VNG_8u_Invoker(const Mat& _src, Mat& _dst, int _code)
+        : src(&_src), dst(&_dst), code(_code) {}
+
+    // every stripe of rows fills its own ring buffer of gradients
+    void operator()(const BlockedRange& range) const
+    {
+        const Mat& srcmat = *src;
+        Mat& dstmat = *dst;
+        const uchar* bayer = srcmat.data;
+        int bstep = (int)srcmat.step;
+        uchar* dst = dstmat.data;
+        int dststep = (int)dstmat.step;
+        Size size = srcmat.size();
     
-    int blueIdx = code == CV_BayerBG2BGR_VNG || code == CV_BayerGB2BGR_VNG ? 0 : 2;
-    bool greenCell0 = code != CV_BayerBG2BGR_VNG && code != CV_BayerRG2BGR_VNG;
+        int blueIdx = code == CV_BayerBG2BGR_VNG || code == CV_BayerGB2BGR_VNG ? 0 : 2;
+        bool greenCell0 = code != CV_BayerBG2BGR_VNG && code != CV_BayerRG2BGR_VNG;
     
-    // for too small images use the simple interpolation algorithm
-    if( MIN(size.width, size.height) < 8 )
-    {
-        Bayer2RGB_<uchar, SIMDBayerInterpolator_8u>( srcmat, dstmat, code );
-        return;
-    }
+        // the pattern alternates from row to row
+        if( range.begin() % 2 != 0 )
+        {
+            greenCell0 = !greenCell0;
+            blueIdx ^= 2;
+        }
     
-    const int brows = 3, bcn = 7;
-    int N = size.width, N2 = N*2, N3 = N*3, N4 = N*4, N5 = N*5, N6 = N*6, N7 = N*7;  
-    int i, bufstep = N7*bcn;
-    cv::AutoBuffer<ushort> _buf(bufstep*brows);
-    ushort* buf = (ushort*)_buf;
+        const int brows = 3, bcn = 7;
+        int N = size.width, N2 = N*2, N3 = N*3, N4 = N*4, N5 = N*5, N6 = N*6, N7 = N*7;  
+        int i, bufstep = N7*bcn;
+        cv::AutoBuffer<ushort> _buf(bufstep*brows);
+        ushort* buf = (ushort*)_buf;
     
-    bayer += bstep*2;
+        bayer += bstep*2;
     
 #if CV_SSE2
-    bool haveSSE = cv::checkHardwareSupport(CV_CPU_SSE2);
+        bool haveSSE = cv::checkHardwareSupport(CV_CPU_SSE2);
     #define _mm_absdiff_epu16(a,b) _mm_adds_epu16(_mm_subs_epu16(a, b), _mm_subs_epu16(b, a))
 #endif
     
-    for( int y = 2; y < size.height - 4; y++ )
-    {
-        uchar* dstrow = dst + dststep*y + 6;
-        const uchar* srow;
-        
-        for( int dy = (y == 2 ? -1 : 1); dy <= 1; dy++ )
+        for( int y = range.begin(); y < range.end(); y++ )
         {
-            ushort* brow = buf + ((y + dy - 1)%brows)*bufstep + 1;
-            srow = bayer + (y+dy)*bstep + 1;
+            uchar* dstrow = dst + dststep*y + 6;
+            const uchar* srow;
+        
+            for( int dy = (y == range.begin() ? -1 : 1); dy <= 1; dy++ )
+            {
+                ushort* brow = buf + ((y + dy - 1)%brows)*bufstep + 1;
+                srow = bayer + (y+dy)*bstep + 1;
             
-            for( i = 0; i < bcn; i++ )
-                brow[N*i-1] = brow[(N-2) + N*i] = 0;
+                for( i = 0; i < bcn; i++ )
+                    brow[N*i-1] = brow[(N-2) + N*i] = 0;
             
-            i = 1;
+                i = 1;
             
 #if CV_SSE2
-            if( haveSSE )
-            {
-                __m128i z = _mm_setzero_si128();
-                for( ; i <= N-9; i += 8, srow += 8, brow += 8 )
+                if( haveSSE )
                 {
-                    __m128i s1, s2, s3, s4, s6, s7, s8, s9;
+                    __m128i z = _mm_setzero_si128();
+                    for( ; i <= N-9; i += 8, srow += 8, brow += 8 )
+                    {
+                        __m128i s1, s2, s3, s4, s6, s7, s8, s9;
                     
-                    s1 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1-bstep)),z);
-                    s2 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep)),z);
-                    s3 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1-bstep)),z);
+                        s1 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1-bstep)),z);
+                        s2 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep)),z);
+                        s3 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1-bstep)),z);
                     
-                    s4 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1)),z);
-                    s6 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1)),z);
+                        s4 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1)),z);
+                        s6 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1)),z);
                     
-                    s7 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1+bstep)),z);
-                    s8 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep)),z);
-                    s9 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1+bstep)),z);
+                        s7 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1+bstep)),z);
+                        s8 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep)),z);
+                        s9 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1+bstep)),z);
                     
-                    __m128i b0, b1, b2, b3, b4, b5, b6;
+                        __m128i b0, b1, b2, b3, b4, b5, b6;
                     
-                    b0 = _mm_adds_epu16(_mm_slli_epi16(_mm_absdiff_epu16(s2,s8),1),
-                                        _mm_adds_epu16(_mm_absdiff_epu16(s1, s7),
-                                                       _mm_absdiff_epu16(s3, s9)));
-                    b1 = _mm_adds_epu16(_mm_slli_epi16(_mm_absdiff_epu16(s4,s6),1),
-                                        _mm_adds_epu16(_mm_absdiff_epu16(s1, s3),
-                                                       _mm_absdiff_epu16(s7, s9)));
-                    b2 = _mm_slli_epi16(_mm_absdiff_epu16(s3,s7),1);
-                    b3 = _mm_slli_epi16(_mm_absdiff_epu16(s1,s9),1);
+                        b0 = _mm_adds_epu16(_mm_slli_epi16(_mm_absdiff_epu16(s2,s8),1),
+                                            _mm_adds_epu16(_mm_absdiff_epu16(s1, s7),
+                                                           _mm_absdiff_epu16(s3, s9)));
+                        b1 = _mm_adds_epu16(_mm_slli_epi16(_mm_absdiff_epu16(s4,s6),1),
+                                            _mm_adds_epu16(_mm_absdiff_epu16(s1, s3),
+                                                           _mm_absdiff_epu16(s7, s9)));
+                        b2 = _mm_slli_epi16(_mm_absdiff_epu16(s3,s7),1);
+                        b3 = _mm_slli_epi16(_mm_absdiff_epu16(s1,s9),1);
                     
-                    _mm_storeu_si128((__m128i*)brow, b0);
-                    _mm_storeu_si128((__m128i*)(brow + N), b1);
-                    _mm_storeu_si128((__m128i*)(brow + N2), b2);
-                    _mm_storeu_si128((__m128i*)(brow + N3), b3);
+                        _mm_storeu_si128((__m128i*)brow, b0);
+                        _mm_storeu_si128((__m128i*)(brow + N), b1);
+                        _mm_storeu_si128((__m128i*)(brow + N2), b2);
+                        _mm_storeu_si128((__m128i*)(brow + N3), b3);
                     
-                    b4 = _mm_adds_epu16(b2,_mm_adds_epu16(_mm_absdiff_epu16(s2, s4),
-                                                          _mm_absdiff_epu16(s6, s8)));
-                    b5 = _mm_adds_epu16(b3,_mm_adds_epu16(_mm_absdiff_epu16(s2, s6),
-                                                          _mm_absdiff_epu16(s4, s8)));
-                    b6 = _mm_adds_epu16(_mm_adds_epu16(s2, s4), _mm_adds_epu16(s6, s8));
-                    b6 = _mm_srli_epi16(b6, 1);
+                        b4 = _mm_adds_epu16(b2,_mm_adds_epu16(_mm_absdiff_epu16(s2, s4),
+                                                              _mm_absdiff_epu16(s6, s8)));
+                        b5 = _mm_adds_epu16(b3,_mm_adds_epu16(_mm_absdiff_epu16(s2, s6),
+                                                              _mm_absdiff_epu16(s4, s8)));
+                        b6 = _mm_adds_epu16(_mm_adds_epu16(s2, s4), _mm_adds_epu16(s6, s8));
+                        b6 = _mm_srli_epi16(b6, 1);
                     
-                    _mm_storeu_si128((__m128i*)(brow + N4), b4);
-                    _mm_storeu_si128((__m128i*)(brow + N5), b5);
-                    _mm_storeu_si128((__m128i*)(brow + N6), b6);
+                        _mm_storeu_si128((__m128i*)(brow + N4), b4);
+                        _mm_storeu_si128((__m128i*)(brow + N5), b5);
+                        _mm_storeu_si128((__m128i*)(brow + N6), b6);
+                    }
                 }
-            }
 #endif
             
-            for( ; i < N-1; i++, srow++, brow++ )
-            {
-                brow[0] = (ushort)(std::abs(srow[-1-bstep] - srow[-1+bstep]) +
-                                   std::abs(srow[-bstep] - srow[+bstep])*2 +
-                                   std::abs(srow[1-bstep] - srow[1+bstep]));
-                brow[N] = (ushort)(std::abs(srow[-1-bstep] - srow[1-bstep]) +
-                                   std::abs(srow[-1] - srow[1])*2 +
-                                   std::abs(srow[-1+bstep] - srow[1+bstep]));
-                brow[N2] = (ushort)(std::abs(srow[+1-bstep] - srow[-1+bstep])*2);
-                brow[N3] = (ushort)(std::abs(srow[-1-bstep] - srow[1+bstep])*2);
-                brow[N4] = (ushort)(brow[N2] + std::abs(srow[-bstep] - srow[-1]) +
-                                    std::abs(srow[+bstep] - srow[1]));
-                brow[N5] = (ushort)(brow[N3] + std::abs(srow[-bstep] - srow[1]) +
-                                    std::abs(srow[+bstep] - srow[-1]));
-                brow[N6] = (ushort)((srow[-bstep] + srow[-1] + srow[1] + srow[+bstep])>>1);
+                for( ; i < N-1; i++, srow++, brow++ )
+                {
+                    brow[0] = (ushort)(std::abs(srow[-1-bstep] - srow[-1+bstep]) +
+                                       std::abs(srow[-bstep] - srow[+bstep])*2 +
+                                       std::abs(srow[1-bstep] - srow[1+bstep]));
+                    brow[N] = (ushort)(std::abs(srow[-1-bstep] - srow[1-bstep]) +
+                                       std::abs(srow[-1] - srow[1])*2 +
+                                       std::abs(srow[-1+bstep] - srow[1+bstep]));
+                    brow[N2] = (ushort)(std::abs(srow[+1-bstep] - srow[-1+bstep])*2);
+                    brow[N3] = (ushort)(std::abs(srow[-1-bstep] - srow[1+bstep])*2);
+                    brow[N4] = (ushort)(brow[N2] + std::abs(srow[-bstep] - srow[-1]) +
+                                        std::abs(srow[+bstep] - srow[1]));
+                    brow[N5] = (ushort)(brow[N3] + std::abs(srow[-bstep] - srow[1]) +
+                                        std::abs(srow[+bstep] - srow[-1]));
+                    brow[N6] = (ushort)((srow[-bstep] + srow[-1] + srow[1] + srow[+bstep])>>1);
+                }
             }
-        }
         
-        const ushort* brow0 = buf + ((y - 2) % brows)*bufstep + 2;
-        const ushort* brow1 = buf + ((y - 1) % brows)*bufstep + 2;
-        const ushort* brow2 = buf + (y % brows)*bufstep + 2;
-        static const float scale[] = { 0.f, 0.5f, 0.25f, 0.1666666666667f, 0.125f, 0.1f, 0.08333333333f, 0.0714286f, 0.0625f };
-        srow = bayer + y*bstep + 2;
-        bool greenCell = greenCell0;
+            const ushort* brow0 = buf + ((y - 2) % brows)*bufstep + 2;
+            const ushort* brow1 = buf + ((y - 1) % brows)*bufstep + 2;
+            const ushort* brow2 = buf + (y % brows)*bufstep + 2;
+            static const float scale[] = { 0.f, 0.5f, 0.25f, 0.1666666666667f, 0.125f, 0.1f, 0.08333333333f, 0.0714286f, 0.0625f };
+            srow = bayer + y*bstep + 2;
+            bool greenCell = greenCell0;
         
-        i = 2;
+            i = 2;
 #if CV_SSE2        
-        int limit = !haveSSE ? N-2 : greenCell ? std::min(3, N-2) : 2;
+            int limit = !haveSSE ? N-2 : greenCell ? std::min(3, N-2) : 2;
 #else
-        int limit = N - 2;
+            int limit = N - 2;
 #endif
         
-        do
-        {
-            for( ; i < limit; i++, srow++, brow0++, brow1++, brow2++, dstrow += 3 )
+            do
             {
-                int gradN = brow0[0] + brow1[0];
-                int gradS = brow1[0] + brow2[0];
-                int gradW = brow1[N-1] + brow1[N];
-                int gradE = brow1[N] + brow1[N+1];
-                int minGrad = std::min(std::min(std::min(gradN, gradS), gradW), gradE);
-                int maxGrad = std::max(std::max(std::max(gradN, gradS), gradW), gradE);
-                int R, G, B;
-                
-                if( !greenCell )
+                for( ; i < limit; i++, srow++, brow0++, brow1++, brow2++, dstrow += 3 )
                 {
-                    int gradNE = brow0[N4+1] + brow1[N4];
-                    int gradSW = brow1[N4] + brow2[N4-1];
-                    int gradNW = brow0[N5-1] + brow1[N5];
-                    int gradSE = brow1[N5] + brow2[N5+1];
+                    int gradN = brow0[0] + brow1[0];
+                    int gradS = brow1[0] + brow2[0];
+                    int gradW = brow1[N-1] + brow1[N];
+                    int gradE = brow1[N] + brow1[N+1];
+                    int minGrad = std::min(std::min(std::min(gradN, gradS), gradW), gradE);
+                    int maxGrad = std::max(std::max(std::max(gradN, gradS), gradW), gradE);
+                    int R, G, B;
+                
+                    if( !greenCell )
+                    {
+                        int gradNE = brow0[N4+1] + brow1[N4];
+                        int gradSW = brow1[N4] + brow2[N4-1];
+                        int gradNW = brow0[N5-1] + brow1[N5];
+                        int gradSE = brow1[N5] + brow2[N5+1];
                     
-                    minGrad = std::min(std::min(std::min(std::min(minGrad, gradNE), gradSW), gradNW), gradSE);
-                    maxGrad = std::max(std::max(std::max(std::max(maxGrad, gradNE), gradSW), gradNW), gradSE);
-                    int T = minGrad + maxGrad/2;
+                        minGrad = std::min(std::min(std::min(std::min(minGrad, gradNE), gradSW), gradNW), gradSE);
+                        maxGrad = std::max(std::max(std::max(std::max(maxGrad, gradNE), gradSW), gradNW), gradSE);
+                        int T = minGrad + maxGrad/2;
                     
-                    int Rs = 0, Gs = 0, Bs = 0, ng = 0;
-                    if( gradN < T )
-                    {
-                        Rs += srow[-bstep*2] + srow[0];
-                        Gs += srow[-bstep]*2;
-                        Bs += srow[-bstep-1] + srow[-bstep+1];
-                        ng++;
-                    }
-                    if( gradS < T )
-                    {
-                        Rs += srow[bstep*2] + srow[0];
-                        Gs += srow[bstep]*2;
-                        Bs += srow[bstep-1] + srow[bstep+1];
-                        ng++;
+                        int Rs = 0, Gs = 0, Bs = 0, ng = 0;
+                        if( gradN < T )
+                        {
+                            Rs += srow[-bstep*2] + srow[0];
+                            Gs += srow[-bstep]*2;
+                            Bs += srow[-bstep-1] + srow[-bstep+1];
+                            ng++;
+                        }
+                        if( gradS < T )
+                        {
+                            Rs += srow[bstep*2] + srow[0];
+                            Gs += srow[bstep]*2;
+                            Bs += srow[bstep-1] + srow[bstep+1];
+                            ng++;
+                        }
+                        if( gradW < T )
+                        {
+                            Rs += srow[-2] + srow[0];
+                            Gs += srow[-1]*2;
+                            Bs += srow[-bstep-1] + srow[bstep-1];
+                            ng++;
+                        }
+                        if( gradE < T )
+                        {
+                            Rs += srow[2] + srow[0];
+                            Gs += srow[1]*2;
+                            Bs += srow[-bstep+1] + srow[bstep+1];
+                            ng++;
+                        }
+                        if( gradNE < T )
+                        {
+                            Rs += srow[-bstep*2+2] + srow[0];
+                            Gs += brow0[N6+1];
+                            Bs += srow[-bstep+1]*2;
+                            ng++;
+                        }
+                        if( gradSW < T )
+                        {
+                            Rs += srow[bstep*2-2] + srow[0];
+                            Gs += brow2[N6-1];
+                            Bs += srow[bstep-1]*2;
+                            ng++;
+                        }
+                        if( gradNW < T )
+                        {
+                            Rs += srow[-bstep*2-2] + srow[0];
+                            Gs += brow0[N6-1];
+                            Bs += srow[-bstep+1]*2;
+                            ng++;
+                        }
+                        if( gradSE < T )
+                        {
+                            Rs += srow[bstep*2+2] + srow[0];
+                            Gs += brow2[N6+1];
+                            Bs += srow[-bstep+1]*2;
+                            ng++;
+                        }
+                        R = srow[0];
+                        G = R + cvRound((Gs - Rs)*scale[ng]);
+                        B = R + cvRound((Bs - Rs)*scale[ng]); 
                     }
-                    if( gradW < T )
+                    else
                     {
-                        Rs += srow[-2] + srow[0];
-                        Gs += srow[-1]*2;
-                        Bs += srow[-bstep-1] + srow[bstep-1];
-                        ng++;
-                    }
-                    if( gradE < T )
-                    {
-                        Rs += srow[2] + srow[0];
-                        Gs += srow[1]*2;
-                        Bs += srow[-bstep+1] + srow[bstep+1];
-                        ng++;
-                    }
-                    if( gradNE < T )
-                    {
-                        Rs += srow[-bstep*2+2] + srow[0];
-                        Gs += brow0[N6+1];
-                        Bs += srow[-bstep+1]*2;
-                        ng++;
-                    }
-                    if( gradSW < T )
-                    {
-                        Rs += srow[bstep*2-2] + srow[0];
-                        Gs += brow2[N6-1];
-                        Bs += srow[bstep-1]*2;
-                        ng++;
-                    }
-                    if( gradNW < T )
-                    {
-                        Rs += srow[-bstep*2-2] + srow[0];
-                        Gs += brow0[N6-1];
-                        Bs += srow[-bstep+1]*2;
-                        ng++;
-                    }
-                    if( gradSE < T )
-                    {
-                        Rs += srow[bstep*2+2] + srow[0];
-                        Gs += brow2[N6+1];
-                        Bs += srow[-bstep+1]*2;
-                        ng++;
-                    }
-                    R = srow[0];
-                    G = R + cvRound((Gs - Rs)*scale[ng]);
-                    B = R + cvRound((Bs - Rs)*scale[ng]); 
-                }
-                else
-                {
-                    int gradNE = brow0[N2] + brow0[N2+1] + brow1[N2] + brow1[N2+1];
-                    int gradSW = brow1[N2] + brow1[N2-1] + brow2[N2] + brow2[N2-1];
-                    int gradNW = brow0[N3] + brow0[N3-1] + brow1[N3] + brow1[N3-1];
-                    int gradSE = brow1[N3] + brow1[N3+1] + brow2[N3] + brow2[N3+1];
+                        int gradNE = brow0[N2] + brow0[N2+1] + brow1[N2] + brow1[N2+1];
+                        int gradSW = brow1[N2] + brow1[N2-1] + brow2[N2] + brow2[N2-1];
+                        int gradNW = brow0[N3] + brow0[N3-1] + brow1[N3] + brow1[N3-1];
+                        int gradSE = brow1[N3] + brow1[N3+1] + brow2[N3] + brow2[N3+1];
                     
-                    minGrad = std::min(std::min(std::min(std::min(minGrad, gradNE), gradSW), gradNW), gradSE);
-                    maxGrad = std::max(std::max(std::max(std::max(maxGrad, gradNE), gradSW), gradNW), gradSE);
-                    int T = minGrad + maxGrad/2;
+                        minGrad = std::min(std::min(std::min(std::min(minGrad, gradNE), gradSW), gradNW), gradSE);
+                        maxGrad = std::max(std::max(std::max(std::max(maxGrad, gradNE), gradSW), gradNW), gradSE);
+                        int T = minGrad + maxGrad/2;
                     
-                    int Rs = 0, Gs = 0, Bs = 0, ng = 0;
-                    if( gradN < T )
-                    {
-                        Rs += srow[-bstep*2-1] + srow[-bstep*2+1];
-                        Gs += srow[-bstep*2] + srow[0];
-                        Bs += srow[-bstep]*2;
-                        ng++;
-                    }
-                    if( gradS < T )
-                    {
-                        Rs += srow[bstep*2-1] + srow[bstep*2+1];
-                        Gs += srow[bstep*2] + srow[0];
-                        Bs += srow[bstep]*2;
-                        ng++;
+                        int Rs = 0, Gs = 0, Bs = 0, ng = 0;
+                        if( gradN < T )
+                        {
+                            Rs += srow[-bstep*2-1] + srow[-bstep*2+1];
+                            Gs += srow[-bstep*2] + srow[0];
+                            Bs += srow[-bstep]*2;
+                            ng++;
+                        }
+                        if( gradS < T )
+                        {
+                            Rs += srow[bstep*2-1] + srow[bstep*2+1];
+                            Gs += srow[bstep*2] + srow[0];
+                            Bs += srow[bstep]*2;
+                            ng++;
+                        }
+                        if( gradW < T )
+                        {
+                            Rs += srow[-1]*2;
+                            Gs += srow[-2] + srow[0];
+                            Bs += srow[-bstep-2]+srow[bstep-2];
+                            ng++;
+                        }
+                        if( gradE < T )
+                        {
+                            Rs += srow[1]*2;
+                            Gs += srow[2] + srow[0];
+                            Bs += srow[-bstep+2]+srow[bstep+2];
+                            ng++;
+                        }
+                        if( gradNE < T )
+                        {
+                            Rs += srow[-bstep*2+1] + srow[1];
+                            Gs += srow[-bstep+1]*2;
+                            Bs += srow[-bstep] + srow[-bstep+2];
+                            ng++;
+                        }
+                        if( gradSW < T )
+                        {
+                            Rs += srow[bstep*2-1] + srow[-1];
+                            Gs += srow[bstep-1]*2;
+                            Bs += srow[bstep] + srow[bstep-2];
+                            ng++;
+                        }
+                        if( gradNW < T )
+                        {
+                            Rs += srow[-bstep*2-1] + srow[-1];
+                            Gs += srow[-bstep-1]*2;
+                            Bs += srow[-bstep-2]+srow[-bstep];
+                            ng++;
+                        }
+                        if( gradSE < T )
+                        {
+                            Rs += srow[bstep*2+1] + srow[1];
+                            Gs += srow[bstep+1]*2;
+                            Bs += srow[bstep+2]+srow[bstep];
+                            ng++;
+                        }
+                        G = srow[0];
+                        R = G + cvRound((Rs - Gs)*scale[ng]);
+                        B = G + cvRound((Bs - Gs)*scale[ng]);
                     }
-                    if( gradW < T )
-                    {
-                        Rs += srow[-1]*2;
-                        Gs += srow[-2] + srow[0];
-                        Bs += srow[-bstep-2]+srow[bstep-2];
-                        ng++;
-                    }
-                    if( gradE < T )
-                    {
-                        Rs += srow[1]*2;
-                        Gs += srow[2] + srow[0];
-                        Bs += srow[-bstep+2]+srow[bstep+2];
-                        ng++;
-                    }
-                    if( gradNE < T )
-                    {
-                        Rs += srow[-bstep*2+1] + srow[1];
-                        Gs += srow[-bstep+1]*2;
-                        Bs += srow[-bstep] + srow[-bstep+2];
-                        ng++;
-                    }
-                    if( gradSW < T )
-                    {
-                        Rs += srow[bstep*2-1] + srow[-1];
-                        Gs += srow[bstep-1]*2;
-                        Bs += srow[bstep] + srow[bstep-2];
-                        ng++;
-                    }
-                    if( gradNW < T )
-                    {
-                        Rs += srow[-bstep*2-1] + srow[-1];
-                        Gs += srow[-bstep-1]*2;
-                        Bs += srow[-bstep-2]+srow[-bstep];
-                        ng++;
-                    }
-                    if( gradSE < T )
-                    {
-                        Rs += srow[bstep*2+1] + srow[1];
-                        Gs += srow[bstep+1]*2;
-                        Bs += srow[bstep+2]+srow[bstep];
-                        ng++;
-                    }
-                    G = srow[0];
-                    R = G + cvRound((Rs - Gs)*scale[ng]);
-                    B = G + cvRound((Bs - Gs)*scale[ng]);
+                    dstrow[blueIdx] = CV_CAST_8U(B);
+                    dstrow[1] = CV_CAST_8U(G);
+                    dstrow[blueIdx^2] = CV_CAST_8U(R);
+                    greenCell = !greenCell;
                 }
-                dstrow[blueIdx] = CV_CAST_8U(B);
-                dstrow[1] = CV_CAST_8U(G);
-                dstrow[blueIdx^2] = CV_CAST_8U(R);
-                greenCell = !greenCell;
-            }
             
 #if CV_SSE2
-            if( !haveSSE )
-                break;
-            
-            __m128i emask = _mm_set1_epi32(0x0000ffff),
-                omask = _mm_set1_epi32(0xffff0000),
-                all_ones = _mm_set1_epi16(1),
-                z = _mm_setzero_si128();
-            __m128 _0_5 = _mm_set1_ps(0.5f);
-            
-            #define _mm_merge_epi16(a, b) \
-                _mm_or_si128(_mm_and_si128(a, emask), _mm_and_si128(b, omask))
-            #define _mm_cvtloepi16_ps(a) _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(a,a), 16))
-            #define _mm_cvthiepi16_ps(a) _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(a,a), 16))
-            
-            // process 8 pixels at once
-            for( ; i <= N - 10; i += 8, srow += 8, brow0 += 8, brow1 += 8, brow2 += 8 )
-            {
-                __m128i gradN, gradS, gradW, gradE, gradNE, gradSW, gradNW, gradSE;
-                gradN = _mm_adds_epu16(_mm_loadu_si128((__m128i*)brow0),
-                                       _mm_loadu_si128((__m128i*)brow1));
-                gradS = _mm_adds_epu16(_mm_loadu_si128((__m128i*)brow1),
-                                       _mm_loadu_si128((__m128i*)brow2));
-                gradW = _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow1+N-1)),
-                                       _mm_loadu_si128((__m128i*)(brow1+N)));
-                gradE = _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow1+N+1)),
-                                       _mm_loadu_si128((__m128i*)(brow1+N)));
+                if( !haveSSE )
+                    break;
+            
+                __m128i emask = _mm_set1_epi32(0x0000ffff),
+                    omask = _mm_set1_epi32(0xffff0000),
+                    all_ones = _mm_set1_epi16(1),
+                    z = _mm_setzero_si128();
+                __m128 _0_5 = _mm_set1_ps(0.5f);
+            
+                #define _mm_merge_epi16(a, b) \
+                    _mm_or_si128(_mm_and_si128(a, emask), _mm_and_si128(b, omask))
+                #define _mm_cvtloepi16_ps(a) _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(a,a), 16))
+                #define _mm_cvthiepi16_ps(a) _mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(a,a), 16))
+            
+                // process 8 pixels at once
+                for( ; i <= N - 10; i += 8, srow += 8, brow0 += 8, brow1 += 8, brow2 += 8 )
+                {
+                    __m128i gradN, gradS, gradW, gradE, gradNE, gradSW, gradNW, gradSE;
+                    gradN = _mm_adds_epu16(_mm_loadu_si128((__m128i*)brow0),
+                                           _mm_loadu_si128((__m128i*)brow1));
+                    gradS = _mm_adds_epu16(_mm_loadu_si128((__m128i*)brow1),
+                                           _mm_loadu_si128((__m128i*)brow2));
+                    gradW = _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow1+N-1)),
+                                           _mm_loadu_si128((__m128i*)(brow1+N)));
+                    gradE = _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow1+N+1)),
+                                           _mm_loadu_si128((__m128i*)(brow1+N)));
                 
-                __m128i minGrad, maxGrad, T;
-                minGrad = _mm_min_epi16(_mm_min_epi16(_mm_min_epi16(gradN, gradS), gradW), gradE);
-                maxGrad = _mm_max_epi16(_mm_max_epi16(_mm_max_epi16(gradN, gradS), gradW), gradE);
+                    __m128i minGrad, maxGrad, T;
+                    minGrad = _mm_min_epi16(_mm_min_epi16(_mm_min_epi16(gradN, gradS), gradW), gradE);
+                    maxGrad = _mm_max_epi16(_mm_max_epi16(_mm_max_epi16(gradN, gradS), gradW), gradE);
                 
-                __m128i grad0, grad1;
+                    __m128i grad0, grad1;
                 
-                grad0 = _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow0+N4+1)),
-                                       _mm_loadu_si128((__m128i*)(brow1+N4)));
-                grad1 = _mm_adds_epu16(_mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow0+N2)),
-                                                      _mm_loadu_si128((__m128i*)(brow0+N2+1))),
-                                       _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow1+N2)),
-                                                      _mm_loadu_si128((__m128i*)(brow1+N2+1))));
-                gradNE = _mm_srli_epi16(_mm_merge_epi16(grad0, grad1), 1);
+                    grad0 = _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow0+N4+1)),
+                                           _mm_loadu_si128((__m128i*)(brow1+N4)));
+                    grad1 = _mm_adds_epu16(_mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow0+N2)),
+                                                          _mm_loadu_si128((__m128i*)(brow0+N2+1))),
+                                           _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow1+N2)),
+                                                          _mm_loadu_si128((__m128i*)(brow1+N2+1))));
+                    gradNE = _mm_srli_epi16(_mm_merge_epi16(grad0, grad1), 1);
                 
-                grad0 = _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow2+N4-1)),
-                                       _mm_loadu_si128((__m128i*)(brow1+N4)));
-                grad1 = _mm_adds_epu16(_mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow2+N2)),
-                                                      _mm_loadu_si128((__m128i*)(brow2+N2-1))),
-                                       _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow1+N2)),
-                                                      _mm_loadu_si128((__m128i*)(brow1+N2-1))));
-                gradSW = _mm_srli_epi16(_mm_merge_epi16(grad0, grad1), 1);
+                    grad0 = _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow2+N4-1)),
+                                           _mm_loadu_si128((__m128i*)(brow1+N4)));
+                    grad1 = _mm_adds_epu16(_mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow2+N2)),
+                                                          _mm_loadu_si128((__m128i*)(brow2+N2-1))),
+                                           _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow1+N2)),
+                                                          _mm_loadu_si128((__m128i*)(brow1+N2-1))));
+                    gradSW = _mm_srli_epi16(_mm_merge_epi16(grad0, grad1), 1);
                 
-                minGrad = _mm_min_epi16(_mm_min_epi16(minGrad, gradNE), gradSW);
-                maxGrad = _mm_max_epi16(_mm_max_epi16(maxGrad, gradNE), gradSW);
+                    minGrad = _mm_min_epi16(_mm_min_epi16(minGrad, gradNE), gradSW);
+                    maxGrad = _mm_max_epi16(_mm_max_epi16(maxGrad, gradNE), gradSW);
                 
-                grad0 = _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow0+N5-1)),
-                                       _mm_loadu_si128((__m128i*)(brow1+N5)));
-                grad1 = _mm_adds_epu16(_mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow0+N3)),
-                                                      _mm_loadu_si128((__m128i*)(brow0+N3-1))),
-                                       _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow1+N3)),
-                                                      _mm_loadu_si128((__m128i*)(brow1+N3-1))));
-                gradNW = _mm_srli_epi16(_mm_merge_epi16(grad0, grad1), 1);
+                    grad0 = _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow0+N5-1)),
+                                           _mm_loadu_si128((__m128i*)(brow1+N5)));
+                    grad1 = _mm_adds_epu16(_mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow0+N3)),
+                                                          _mm_loadu_si128((__m128i*)(brow0+N3-1))),
+                                           _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow1+N3)),
+                                                          _mm_loadu_si128((__m128i*)(brow1+N3-1))));
+                    gradNW = _mm_srli_epi16(_mm_merge_epi16(grad0, grad1), 1);
                 
-                grad0 = _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow2+N5+1)),
-                                       _mm_loadu_si128((__m128i*)(brow1+N5)));
-                grad1 = _mm_adds_epu16(_mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow2+N3)),
-                                                      _mm_loadu_si128((__m128i*)(brow2+N3+1))),
-                                       _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow1+N3)),
-                                                      _mm_loadu_si128((__m128i*)(brow1+N3+1))));
-                gradSE = _mm_srli_epi16(_mm_merge_epi16(grad0, grad1), 1);
+                    grad0 = _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow2+N5+1)),
+                                           _mm_loadu_si128((__m128i*)(brow1+N5)));
+                    grad1 = _mm_adds_epu16(_mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow2+N3)),
+                                                          _mm_loadu_si128((__m128i*)(brow2+N3+1))),
+                                           _mm_adds_epu16(_mm_loadu_si128((__m128i*)(brow1+N3)),
+                                                          _mm_loadu_si128((__m128i*)(brow1+N3+1))));
+                    gradSE = _mm_srli_epi16(_mm_merge_epi16(grad0, grad1), 1);
                 
-                minGrad = _mm_min_epi16(_mm_min_epi16(minGrad, gradNW), gradSE);
-                maxGrad = _mm_max_epi16(_mm_max_epi16(maxGrad, gradNW), gradSE);
+                    minGrad = _mm_min_epi16(_mm_min_epi16(minGrad, gradNW), gradSE);
+                    maxGrad = _mm_max_epi16(_mm_max_epi16(maxGrad, gradNW), gradSE);
                 
-                T = _mm_add_epi16(_mm_srli_epi16(maxGrad, 1), minGrad);
-                __m128i RGs = z, GRs = z, Bs = z, ng = z, mask;
+                    T = _mm_add_epi16(_mm_srli_epi16(maxGrad, 1), minGrad);
+                    __m128i RGs = z, GRs = z, Bs = z, ng = z, mask;
                 
-                __m128i t0, t1, x0, x1, x2, x3, x4, x5, x6, x7, x8,
-                x9, x10, x11, x12, x13, x14, x15, x16;
+                    __m128i t0, t1, x0, x1, x2, x3, x4, x5, x6, x7, x8,
+                    x9, x10, x11, x12, x13, x14, x15, x16;
                 
-                x0 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)srow), z);
+                    x0 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)srow), z);
                 
-                x1 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep-1)), z);
-                x2 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep*2-1)), z);
-                x3 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep)), z);
-                x4 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep*2+1)), z);
-                x5 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep+1)), z);
-                x6 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep+2)), z);
-                x7 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1)), z);
-                x8 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep+2)), z);
-                x9 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep+1)), z);
-                x10 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep*2+1)), z);
-                x11 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep)), z);
-                x12 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep*2-1)), z);
-                x13 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep-1)), z);
-                x14 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep-2)), z);
-                x15 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1)), z);
-                x16 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep-2)), z);
+                    x1 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep-1)), z);
+                    x2 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep*2-1)), z);
+                    x3 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep)), z);
+                    x4 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep*2+1)), z);
+                    x5 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep+1)), z);
+                    x6 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep+2)), z);
+                    x7 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+1)), z);
+                    x8 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep+2)), z);
+                    x9 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep+1)), z);
+                    x10 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep*2+1)), z);
+                    x11 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep)), z);
+                    x12 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep*2-1)), z);
+                    x13 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep-1)), z);
+                    x14 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep-2)), z);
+                    x15 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-1)), z);
+                    x16 = _mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep-2)), z);
                 
-                // gradN
-                mask = _mm_cmpgt_epi16(T, gradN);
-                ng = _mm_sub_epi16(ng, mask);
+                    // gradN
+                    mask = _mm_cmpgt_epi16(T, gradN);
+                    ng = _mm_sub_epi16(ng, mask);
                 
-                t0 = _mm_slli_epi16(x3, 1);
-                t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep*2)), z), x0);
+                    t0 = _mm_slli_epi16(x3, 1);
+                    t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep*2)), z), x0);
                 
-                RGs = _mm_adds_epu16(RGs, _mm_and_si128(t1, mask));
-                GRs = _mm_adds_epu16(GRs, _mm_and_si128(_mm_merge_epi16(t0, _mm_adds_epu16(x2,x4)), mask));
-                Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epu16(x1,x5), t0), mask));
+                    RGs = _mm_adds_epu16(RGs, _mm_and_si128(t1, mask));
+                    GRs = _mm_adds_epu16(GRs, _mm_and_si128(_mm_merge_epi16(t0, _mm_adds_epu16(x2,x4)), mask));
+                    Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epu16(x1,x5), t0), mask));
                 
-                // gradNE
-                mask = _mm_cmpgt_epi16(T, gradNE);
-                ng = _mm_sub_epi16(ng, mask);
+                    // gradNE
+                    mask = _mm_cmpgt_epi16(T, gradNE);
+                    ng = _mm_sub_epi16(ng, mask);
                 
-                t0 = _mm_slli_epi16(x5, 1);
-                t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep*2+2)), z), x0);
+                    t0 = _mm_slli_epi16(x5, 1);
+                    t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep*2+2)), z), x0);
                 
-                RGs = _mm_adds_epu16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
-                GRs = _mm_adds_epu16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow0+N6+1)),
-                                                                        _mm_adds_epu16(x4,x7)), mask));
-                Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(t0,_mm_adds_epu16(x3,x6)), mask));
+                    RGs = _mm_adds_epu16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
+                    GRs = _mm_adds_epu16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow0+N6+1)),
+                                                                            _mm_adds_epu16(x4,x7)), mask));
+                    Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(t0,_mm_adds_epu16(x3,x6)), mask));
                 
-                // gradE
-                mask = _mm_cmpgt_epi16(T, gradE);
-                ng = _mm_sub_epi16(ng, mask);
+                    // gradE
+                    mask = _mm_cmpgt_epi16(T, gradE);
+                    ng = _mm_sub_epi16(ng, mask);
                 
-                t0 = _mm_slli_epi16(x7, 1);
-                t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+2)), z), x0);
+                    t0 = _mm_slli_epi16(x7, 1);
+                    t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+2)), z), x0);
                 
-                RGs = _mm_adds_epu16(RGs, _mm_and_si128(t1, mask));
-                GRs = _mm_adds_epu16(GRs, _mm_and_si128(t0, mask));
-                Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epu16(x5,x9),
-                                                                      _mm_adds_epu16(x6,x8)), mask));
+                    RGs = _mm_adds_epu16(RGs, _mm_and_si128(t1, mask));
+                    GRs = _mm_adds_epu16(GRs, _mm_and_si128(t0, mask));
+                    Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epu16(x5,x9),
+                                                                          _mm_adds_epu16(x6,x8)), mask));
                 
-                // gradSE
-                mask = _mm_cmpgt_epi16(T, gradSE);
-                ng = _mm_sub_epi16(ng, mask);
+                    // gradSE
+                    mask = _mm_cmpgt_epi16(T, gradSE);
+                    ng = _mm_sub_epi16(ng, mask);
                 
-                t0 = _mm_slli_epi16(x9, 1);
-                t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep*2+2)), z), x0);
+                    t0 = _mm_slli_epi16(x9, 1);
+                    t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep*2+2)), z), x0);
                 
-                RGs = _mm_adds_epu16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
-                GRs = _mm_adds_epu16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow2+N6+1)),
-                                                                        _mm_adds_epu16(x7,x10)), mask));
-                Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(t0, _mm_adds_epu16(x8,x11)), mask));
+                    RGs = _mm_adds_epu16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
+                    GRs = _mm_adds_epu16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow2+N6+1)),
+                                                                            _mm_adds_epu16(x7,x10)), mask));
+                    Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(t0, _mm_adds_epu16(x8,x11)), mask));
                 
-                // gradS
-                mask = _mm_cmpgt_epi16(T, gradS);
-                ng = _mm_sub_epi16(ng, mask);
+                    // gradS
+                    mask = _mm_cmpgt_epi16(T, gradS);
+                    ng = _mm_sub_epi16(ng, mask);
                 
-                t0 = _mm_slli_epi16(x11, 1);
-                t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep*2)), z), x0);
+                    t0 = _mm_slli_epi16(x11, 1);
+                    t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep*2)), z), x0);
                 
-                RGs = _mm_adds_epu16(RGs, _mm_and_si128(t1, mask));
-                GRs = _mm_adds_epu16(GRs, _mm_and_si128(_mm_merge_epi16(t0, _mm_adds_epu16(x10,x12)), mask));
-                Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epu16(x9,x13), t0), mask));
+                    RGs = _mm_adds_epu16(RGs, _mm_and_si128(t1, mask));
+                    GRs = _mm_adds_epu16(GRs, _mm_and_si128(_mm_merge_epi16(t0, _mm_adds_epu16(x10,x12)), mask));
+                    Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epu16(x9,x13), t0), mask));
                 
-                // gradSW
-                mask = _mm_cmpgt_epi16(T, gradSW);
-                ng = _mm_sub_epi16(ng, mask);
+                    // gradSW
+                    mask = _mm_cmpgt_epi16(T, gradSW);
+                    ng = _mm_sub_epi16(ng, mask);
                 
-                t0 = _mm_slli_epi16(x13, 1);
-                t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep*2-2)), z), x0);
+                    t0 = _mm_slli_epi16(x13, 1);
+                    t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow+bstep*2-2)), z), x0);
                 
-                RGs = _mm_adds_epu16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
-                GRs = _mm_adds_epu16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow2+N6-1)),
-                                                                        _mm_adds_epu16(x12,x15)), mask));
-                Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(t0,_mm_adds_epu16(x11,x14)), mask));
+                    RGs = _mm_adds_epu16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
+                    GRs = _mm_adds_epu16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow2+N6-1)),
+                                                                            _mm_adds_epu16(x12,x15)), mask));
+                    Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(t0,_mm_adds_epu16(x11,x14)), mask));
                 
-                // gradW
-                mask = _mm_cmpgt_epi16(T, gradW);
-                ng = _mm_sub_epi16(ng, mask);
+                    // gradW
+                    mask = _mm_cmpgt_epi16(T, gradW);
+                    ng = _mm_sub_epi16(ng, mask);
                 
-                t0 = _mm_slli_epi16(x15, 1);
-                t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-2)), z), x0);
+                    t0 = _mm_slli_epi16(x15, 1);
+                    t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-2)), z), x0);
                 
-                RGs = _mm_adds_epu16(RGs, _mm_and_si128(t1, mask));
-                GRs = _mm_adds_epu16(GRs, _mm_and_si128(t0, mask));
-                Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epu16(x1,x13),
-                                                                      _mm_adds_epu16(x14,x16)), mask));
+                    RGs = _mm_adds_epu16(RGs, _mm_and_si128(t1, mask));
+                    GRs = _mm_adds_epu16(GRs, _mm_and_si128(t0, mask));
+                    Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(_mm_adds_epu16(x1,x13),
+                                                                          _mm_adds_epu16(x14,x16)), mask));
                 
-                // gradNW
-                mask = _mm_cmpgt_epi16(T, gradNW);
-                ng = _mm_max_epi16(_mm_sub_epi16(ng, mask), all_ones);
+                    // gradNW
+                    mask = _mm_cmpgt_epi16(T, gradNW);
+                    ng = _mm_max_epi16(_mm_sub_epi16(ng, mask), all_ones);
                 
-                __m128 ngf0, ngf1;
-                ngf0 = _mm_div_ps(_0_5, _mm_cvtloepi16_ps(ng));
-                ngf1 = _mm_div_ps(_0_5, _mm_cvthiepi16_ps(ng));
+                    __m128 ngf0, ngf1;
+                    ngf0 = _mm_div_ps(_0_5, _mm_cvtloepi16_ps(ng));
+                    ngf1 = _mm_div_ps(_0_5, _mm_cvthiepi16_ps(ng));
                 
-                t0 = _mm_slli_epi16(x1, 1);
-                t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep*2-2)), z), x0);
+                    t0 = _mm_slli_epi16(x1, 1);
+                    t1 = _mm_adds_epu16(_mm_unpacklo_epi8(_mm_loadl_epi64((__m128i*)(srow-bstep*2-2)), z), x0);
                 
-                RGs = _mm_adds_epu16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
-                GRs = _mm_adds_epu16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow0+N6-1)),
-                                                                        _mm_adds_epu16(x2,x15)), mask));
-                Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(t0,_mm_adds_epu16(x3,x16)), mask));
+                    RGs = _mm_adds_epu16(RGs, _mm_and_si128(_mm_merge_epi16(t1, t0), mask));
+                    GRs = _mm_adds_epu16(GRs, _mm_and_si128(_mm_merge_epi16(_mm_loadu_si128((__m128i*)(brow0+N6-1)),
+                                                                            _mm_adds_epu16(x2,x15)), mask));
+                    Bs = _mm_adds_epu16(Bs, _mm_and_si128(_mm_merge_epi16(t0,_mm_adds_epu16(x3,x16)), mask));
                 
-                // now interpolate r, g & b
-                t0 = _mm_sub_epi16(GRs, RGs);
-                t1 = _mm_sub_epi16(Bs, RGs);
+                    // now interpolate r, g & b
+                    t0 = _mm_sub_epi16(GRs, RGs);
+                    t1 = _mm_sub_epi16(Bs, RGs);
                 
-                t0 = _mm_add_epi16(x0, _mm_packs_epi32(
-                                                       _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtloepi16_ps(t0), ngf0)),
-                                                       _mm_cvtps_epi32(_mm_mul_ps(_mm_cvthiepi16_ps(t0), ngf1))));
+                    t0 = _mm_add_epi16(x0, _mm_packs_epi32(
+                                                           _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtloepi16_ps(t0), ngf0)),
+                                                           _mm_cvtps_epi32(_mm_mul_ps(_mm_cvthiepi16_ps(t0), ngf1))));
                 
-                t1 = _mm_add_epi16(x0, _mm_packs_epi32(
-                                                       _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtloepi16_ps(t1), ngf0)),
-                                                       _mm_cvtps_epi32(_mm_mul_ps(_mm_cvthiepi16_ps(t1), ngf1))));
+                    t1 = _mm_add_epi16(x0, _mm_packs_epi32(
+                                                           _mm_cvtps_epi32(_mm_mul_ps(_mm_cvtloepi16_ps(t1), ngf0)),
+                                                           _mm_cvtps_epi32(_mm_mul_ps(_mm_cvthiepi16_ps(t1), ngf1))));
                 
-                x1 = _mm_merge_epi16(x0, t0);
-                x2 = _mm_merge_epi16(t0, x0);
+                    x1 = _mm_merge_epi16(x0, t0);
+                    x2 = _mm_merge_epi16(t0, x0);
                 
-                uchar R[8], G[8], B[8];
+                    uchar R[8], G[8], B[8];
                 
-                _mm_storel_epi64(blueIdx ? (__m128i*)B : (__m128i*)R, _mm_packus_epi16(x1, z));
-                _mm_storel_epi64((__m128i*)G, _mm_packus_epi16(x2, z));
-                _mm_storel_epi64(blueIdx ? (__m128i*)R : (__m128i*)B, _mm_packus_epi16(t1, z));
+                    _mm_storel_epi64(blueIdx ? (__m128i*)B : (__m128i*)R, _mm_packus_epi16(x1, z));
+                    _mm_storel_epi64((__m128i*)G, _mm_packus_epi16(x2, z));
+                    _mm_storel_epi64(blueIdx ? (__m128i*)R : (__m128i*)B, _mm_packus_epi16(t1, z));
                 
-                for( int j = 0; j < 8; j++, dstrow += 3 )
-                {
-                    dstrow[0] = B[j]; dstrow[1] = G[j]; dstrow[2] = R[j];
+                    for( int j = 0; j < 8; j++, dstrow += 3 )
+                    {
+                        dstrow[0] = B[j]; dstrow[1] = G[j]; dstrow[2] = R[j];
+                    }
                 }
-            }
 #endif
             
-            limit = N - 2;
-        }
-        while( i < N - 2 );
+                limit = N - 2;
+            }
+            while( i < N - 2 );
         
-        for( i = 0; i < 6; i++ )
-        {
-            dst[dststep*y + 5 - i] = dst[dststep*y + 8 - i];
-            dst[dststep*y + (N - 2)*3 + i] = dst[dststep*y + (N - 3)*3 + i];
-        }
+            for( i = 0; i < 6; i++ )
+            {
+                dst[dststep*y + 5 - i] = dst[dststep*y + 8 - i];
+                dst[dststep*y + (N - 2)*3 + i] = dst[dststep*y + (N - 3)*3 + i];
+            }
         
-        greenCell0 = !greenCell0;
-        blueIdx ^= 2;
+            greenCell0 = !greenCell0;
+            blueIdx ^= 2;
+        }
+    }
+
+private:
+    const Mat* src;
+    Mat* dst;
+    int code;
+};
+
+static void Bayer2RGB_VNG_8u( const Mat& srcmat, Mat& dstmat, int code )
+{
+    uchar* dst = dstmat.data;
+    int dststep = (int)dstmat.step;
+    Size size = srcmat.size();
+    int i;
+    
+    // for too small images use the simple interpolation algorithm
+    if( MIN(size.width, size.height) < 8 )
+    {
+        Bayer2RGB_<uchar, SIMDBayerInterpolator_8u>( srcmat, dstmat, code );
+        return;
     }
     
+    // every stripe recomputes the gradients of the two rows above its first row,
+    // so the stripes should not be too thin
+    parallel_for(BlockedRange(2, size.height - 4, std::max(bayerGrain(size), 16)),
+                 Bayer2RGB_VNG_8u_Invoker(srcmat, dstmat, code));
+    
     for( i = 0; i < size.width*3; i++ )
     {
         dst[i] = dst[i + dststep] = dst[i + dststep*2];
@@ -3173,6 +3549,472 @@ void cv::cvtColor( InputArray _src, OutputArray _dst, int code, int dcn )
     }
 }
     
+//////////////////////////////////////////////////////////////////////////////////////////
+//                 Fused color conversion + resize + scaling (cvtColorResize)           //
+//////////////////////////////////////////////////////////////////////////////////////////
+
+namespace cv
+{
+
+enum { CVTRESIZE_TILE_SRC_ROWS = 32 };
+
+enum
+{
+    CVTRESIZE_ROWWISE = 0, // every output row depends on the same input row only
+    CVTRESIZE_BAYER = 1,   // demosaicing reads 3x3 neighborhoods
+    CVTRESIZE_BAYER_VNG = 2, // VNG demosaicing reads 5x5 neighborhoods
+    CVTRESIZE_YUV420 = 3   // Y plane followed by the subsampled interleaved UV plane
+};
+
+// interpolation taps along one axis: the output coordinate i is
+// sum_{k=ofs[i]}^{ofs[i+1]-1} src[idx[k]]*alpha[k]
+struct ResizeTaps
+{
+    ResizeTaps( int ssize, int dsize, double inv_scale, int interpolation, bool area_mode )
+    {
+        double scale = 1./inv_scale;
+        ofs.resize(dsize + 1);
+        ofs[0] = 0;
+        ksize = 1;
+
+        for( int dx = 0; dx < dsize; dx++ )
+        {
+            if( interpolation == INTER_NEAREST )
+                add(std::min(cvFloor(dx*scale), ssize-1), 1.f);
+            else if( interpolation == INTER_AREA && area_mode )
+            {
+                // the same box coverage as in the generic INTER_AREA decimation of resize()
+                double fsx1 = dx*scale, fsx2 = fsx1 + scale;
+                int sx1 = std::min(cvCeil(fsx1), ssize-1), sx2 = std::min(cvFloor(fsx2), ssize-1);
+                float a = (float)inv_scale;
+
+                if( sx1 > fsx1 )
+                    add(sx1-1, (float)((sx1 - fsx1)*inv_scale));
+                for( int sx = sx1; sx < sx2; sx++ )
+                    add(sx, a);
+                if( fsx2 - sx2 > 1e-3 )
+                    add(sx2, (float)((fsx2 - sx2)*inv_scale));
+            }
+            else
+            {
+                int sx;
+                float fx;
+                if( interpolation == INTER_AREA )
+                {
+                    sx = cvFloor(dx*scale);
+                    fx = (float)((dx+1) - (sx+1)*inv_scale);
+                    fx = fx <= 0 ? 0.f : fx - cvFloor(fx);
+                }
+                else
+                {
+                    fx = (float)((dx+0.5)*scale - 0.5);
+                    sx = cvFloor(fx);
+                    fx -= sx;
+                }
+                if( sx < 0 )
+                    fx = 0, sx = 0;
+                if( sx >= ssize-1 )
+                    fx = 0, sx = ssize-1;
+                add(sx, 1.f - fx);
+                if( fx > 0 )
+                    add(sx+1, fx);
+            }
+            ofs[dx+1] = (int)idx.size();
+            ksize = std::max(ksize, ofs[dx+1] - ofs[dx]);
+        }
+    }
+
+    void add( int i, float a )
+    {
+        idx.push_back(i);
+        alpha.push_back(a);
+    }
+
+    // pads every output to ksize taps and premultiplies the indices by cn,
+    // so that the horizontal pass runs with a fixed kernel size
+    void pad( int cn )
+    {
+        int dsize = (int)ofs.size() - 1;
+        kidx.resize(dsize*ksize);
+        kalpha.resize(dsize*ksize);
+        for( int dx = 0; dx < dsize; dx++ )
+            for( int k = 0; k < ksize; k++ )
+            {
+                int j = std::min(ofs[dx] + k, ofs[dx+1] - 1);
+                kidx[dx*ksize + k] = idx[j]*cn;
+                kalpha[dx*ksize + k] = ofs[dx] + k < ofs[dx+1] ? alpha[j] : 0.f;
+            }
+    }
+
+    vector<int> ofs;
+    vector<int> idx;
+    vector<float> alpha;
+    int ksize;
+    vector<int> kidx;
+    vector<float> kalpha;
+};
+
+
+template<typename T, int ksize> static void
+cvtResizeHRow( const T* src, float* dst, int cn, const ResizeTaps& xtab )
+{
+    int dwidth = (int)xtab.ofs.size() - 1, k, ks = ksize > 0 ? ksize : xtab.ksize;
+    const int* idx = &xtab.kidx[0];
+    const float* alpha = &xtab.kalpha[0];
+
+    if( cn == 1 )
+    {
+        for( int dx = 0; dx < dwidth; dx++, idx += ks, alpha += ks )
+        {
+            float s = src[idx[0]]*alpha[0];
+            for( k = 1; k < ks; k++ )
+                s += src[idx[k]]*alpha[k];
+            dst[dx] = s;
+        }
+    }
+    else if( cn == 3 )
+    {
+        for( int dx = 0; dx < dwidth; dx++, dst += 3, idx += ks, alpha += ks )
+        {
+            const T* S = src + idx[0];
+            float a = alpha[0];
+            float s0 = S[0]*a, s1 = S[1]*a, s2 = S[2]*a;
+            for( k = 1; k < ks; k++ )
+            {
+                S = src + idx[k];
+                a = alpha[k];
+                s0 += S[0]*a; s1 += S[1]*a; s2 += S[2]*a;
+            }
+            dst[0] = s0; dst[1] = s1; dst[2] = s2;
+        }
+    }
+    else
+    {
+        for( int dx = 0; dx < dwidth; dx++, dst += cn, idx += ks, alpha += ks )
+        {
+            for( int c = 0; c < cn; c++ )
+                dst[c] = 0;
+            for( k = 0; k < ks; k++ )
+            {
+                const T* S = src + idx[k];
+                float a = alpha[k];
+                for( int c = 0; c < cn; c++ )
+                    dst[c] += S[c]*a;
+            }
+        }
+    }
+}
+
+
+// dst = beta + sum_k rows[k]*alpha[k]
+static void cvtResizeVRow( const float** rows, const float* alpha, int n,
+                           float* dst, int width, float beta )
+{
+    for( int k = 0; k < n; k++ )
+    {
+        const float* S = rows[k];
+        float a = alpha[k];
+        int x = 0;
+#if CV_SSE2
+        if( checkHardwareSupport(CV_CPU_SSE2) )
+        {
+            __m128 a4 = _mm_set1_ps(a), b4 = _mm_set1_ps(beta);
+            for( ; x <= width - 4; x += 4 )
+            {
+                __m128 s = _mm_mul_ps(_mm_loadu_ps(S + x), a4);
+                _mm_storeu_ps(dst + x, _mm_add_ps(s, k == 0 ? b4 : _mm_loadu_ps(dst + x)));
+            }
+        }
+#endif
+        if( k == 0 )
+            for( ; x < width; x++ )
+                dst[x] = S[x]*a + beta;
+        else
+            for( ; x < width; x++ )
+                dst[x] += S[x]*a;
+    }
+}
+
+
+template<typename DT> static void
+cvtResizeStoreRow( const float* src, uchar* _dst, int width )
+{
+    DT* dst = (DT*)_dst;
+    for( int x = 0; x < width; x++ )
+        dst[x] = saturate_cast<DT>(src[x]);
+}
+
+
+template<int R, int SPorI> static void
+cvtColorYUV420Rows( const uchar* y, const uchar* uv, int width, Mat& dst )
+{
+    BlockedRange range(0, dst.rows/2);
+    if( dst.channels() == 3 )
+        YUV4202BGR888Invoker<R, SPorI>(&dst, width, y, uv)(range);
+    else
+        YUV4202BGRA8888Invoker<R, SPorI>(&dst, width, y, uv)(range);
+}
+
+
+class CvtColorResizeInvoker
+{
+public:
+    CvtColorResizeInvoker( const Mat& _src, Mat& _dst, int _code, int _kind, int _dcn,
+                           const ResizeTaps& _xtab, const ResizeTaps& _ytab,
+                           double _alpha, double _beta, int _tileRows )
+    : src(&_src), dst(&_dst), code(_code), kind(_kind), dcn(_dcn), xtab(&_xtab), ytab(&_ytab),
+      alpha(_alpha), beta(_beta), tileRows(_tileRows)
+    {
+        ssize = src->size();
+        if( kind == CVTRESIZE_YUV420 )
+            ssize.height = ssize.height*2/3;
+    }
+
+    void operator()(const BlockedRange& range) const
+    {
+        typedef void (*HResizeFunc)( const void* src, float* dst, int cn, const ResizeTaps& xtab );
+        typedef void (*StoreFunc)( const float* src, uchar* dst, int width );
+        static StoreFunc store_tab[] =
+        {
+            cvtResizeStoreRow<uchar>, cvtResizeStoreRow<schar>, cvtResizeStoreRow<ushort>,
+            cvtResizeStoreRow<short>, cvtResizeStoreRow<int>, 0, cvtResizeStoreRow<double>, 0
+        };
+
+        const ResizeTaps& xt = *xtab;
+        const ResizeTaps& yt = *ytab;
+        int cn = dcn, depth = src->depth(), ddepth = dst->depth();
+        int dwidth = dst->cols*cn;
+        static HResizeFunc hresize_tab[][5] =
+        {
+            {
+                (HResizeFunc)cvtResizeHRow<uchar, 0>, (HResizeFunc)cvtResizeHRow<uchar, 1>,
+                (HResizeFunc)cvtResizeHRow<uchar, 2>, (HResizeFunc)cvtResizeHRow<uchar, 3>,
+                (HResizeFunc)cvtResizeHRow<uchar, 4>
+            },
+            {
+                (HResizeFunc)cvtResizeHRow<ushort, 0>, (HResizeFunc)cvtResizeHRow<ushort, 1>,
+                (HResizeFunc)cvtResizeHRow<ushort, 2>, (HResizeFunc)cvtResizeHRow<ushort, 3>,
+                (HResizeFunc)cvtResizeHRow<ushort, 4>
+            },
+            {
+                (HResizeFunc)cvtResizeHRow<float, 0>, (HResizeFunc)cvtResizeHRow<float, 1>,
+                (HResizeFunc)cvtResizeHRow<float, 2>, (HResizeFunc)cvtResizeHRow<float, 3>,
+                (HResizeFunc)cvtResizeHRow<float, 4>
+            }
+        };
+        StoreFunc store = store_tab[ddepth];
+        CV_Assert( depth == CV_8U || depth == CV_16U || depth == CV_32F );
+        HResizeFunc hresize = hresize_tab[depth == CV_8U ? 0 : depth == CV_16U ? 1 : 2][xt.ksize <= 4 ? xt.ksize : 0];
+
+        Mat cbuf, cstorage;
+        vector<float> hbuf, vbuf(ddepth == CV_32F ? 0 : dwidth);
+        vector<uchar> needed;
+        vector<const float*> rows;
+        vector<float> weights;
+
+        for( int d0 = range.begin(); d0 < range.end(); d0 += tileRows )
+        {
+            int d1 = std::min(d0 + tileRows, range.end());
+            int s0 = INT_MAX, s1 = 0, sy, dy, k;
+
+            // the source rows this tile reads
+            for( k = yt.ofs[d0]; k < yt.ofs[d1]; k++ )
+            {
+                s0 = std::min(s0, yt.idx[k]);
+                s1 = std::max(s1, yt.idx[k] + 1);
+            }
+            needed.assign(s1 - s0, (uchar)0);
+            for( k = yt.ofs[d0]; k < yt.ofs[d1]; k++ )
+                needed[yt.idx[k] - s0] = 1;
+            hbuf.resize((size_t)(s1 - s0)*dwidth);
+
+            // convert and horizontally resize only the needed source rows,
+            // a run of neighbouring rows at a time
+            for( sy = s0; sy < s1; )
+            {
+                if( !needed[sy - s0] )
+                {
+                    sy++;
+                    continue;
+                }
+                int r1 = sy + 1, a, b, t, na, nb;
+                for( ;; )
+                {
+                    while( r1 < s1 && needed[r1 - s0] )
+                        r1++;
+                    expandRun(sy, r1, a, b);
+                    for( t = r1; t < s1 && !needed[t - s0]; t++ )
+                        ;
+                    if( t >= s1 )
+                        break;
+                    expandRun(t, t + 1, na, nb);
+                    if( na > b )
+                        break;
+                    r1 = t + 1;
+                }
+                convertRows(a, b, cbuf, cstorage);
+
+                for( ; sy < r1; sy++ )
+                    if( needed[sy - s0] )
+                        hresize(cbuf.ptr(sy - a), &hbuf[(size_t)(sy - s0)*dwidth], cn, xt);
+            }
+
+            for( dy = d0; dy < d1; dy++ )
+            {
+                int n = yt.ofs[dy+1] - yt.ofs[dy];
+                rows.resize(n);
+                weights.resize(n);
+                for( k = 0; k < n; k++ )
+                {
+                    rows[k] = &hbuf[(size_t)(yt.idx[yt.ofs[dy] + k] - s0)*dwidth];
+                    weights[k] = (float)(yt.alpha[yt.ofs[dy] + k]*alpha);
+                }
+                uchar* D = dst->ptr(dy);
+                if( ddepth == CV_32F )
+                    cvtResizeVRow(&rows[0], &weights[0], n, (float*)D, dwidth, (float)beta);
+                else
+                {
+                    cvtResizeVRow(&rows[0], &weights[0], n, &vbuf[0], dwidth, (float)beta);
+                    store(&vbuf[0], D, dwidth);
+                }
+            }
+        }
+    }
+
+private:
+    // the range of source rows to convert so that rows [r0, r1) come out exactly as
+    // they would from cvtColor() on the whole image
+    void expandRun( int r0, int r1, int& a, int& b ) const
+    {
+        int margin = 0, minRows = 1;
+        if( kind == CVTRESIZE_BAYER )
+            margin = 1, minRows = 3;
+        else if( kind == CVTRESIZE_BAYER_VNG )
+            margin = 4, minRows = 8;
+
+        a = std::max(r0 - margin, 0);
+        b = std::min(r1 + margin, ssize.height);
+        if( kind != CVTRESIZE_ROWWISE )
+        {
+            // keep the Bayer pattern phase and the YUV 2x2 chroma blocks
+            a &= ~1;
+            b = std::min(b + (b & 1), ssize.height);
+        }
+        if( b - a < minRows )
+        {
+            b = std::min(a + minRows, ssize.height);
+            a = std::max(b - minRows, 0) & ~1;
+        }
+    }
+
+    void convertRows( int a, int b, Mat& buf, Mat& storage ) const
+    {
+        int n = b - a, width = ssize.width;
+        if( kind == CVTRESIZE_YUV420 && dcn == 1 )
+        {
+            // the luma plane is the gray image
+            buf = src->rowRange(a, b);
+            return;
+        }
+
+        int type = CV_MAKETYPE(src->depth(), dcn);
+        if( storage.rows < n || storage.type() != type )
+            storage.create(std::max(n, storage.rows), width, type);
+        buf = storage.rowRange(0, n);
+
+        if( kind != CVTRESIZE_YUV420 )
+        {
+            cvtColor(src->rowRange(a, b), buf, code, dcn);
+            return;
+        }
+
+        const uchar* y = src->data + (size_t)a*width;
+        const uchar* uv = src->data + (size_t)ssize.height*width + (size_t)(a/2)*width;
+        if( code == CV_YUV420sp2RGB || code == CV_YUV420sp2RGBA )
+            cvtColorYUV420Rows<2,0>(y, uv, width, buf);
+        else if( code == CV_YUV420sp2BGR || code == CV_YUV420sp2BGRA )
+            cvtColorYUV420Rows<0,0>(y, uv, width, buf);
+        else if( code == CV_YUV420i2RGB || code == CV_YUV420i2RGBA )
+            cvtColorYUV420Rows<2,1>(y, uv, width, buf);
+        else
+            cvtColorYUV420Rows<0,1>(y, uv, width, buf);
+    }
+
+    const Mat* src;
+    Mat* dst;
+    int code, kind, dcn;
+    Size ssize;
+    const ResizeTaps* xtab;
+    const ResizeTaps* ytab;
+    double alpha, beta;
+    int tileRows;
+};
+
+}
+
+void cv::cvtColorResize( InputArray _src, OutputArray _dst, int code, Size dsize,
+                         int interpolation, int rtype, double alpha, double beta, int dcn )
+{
+    Mat src = _src.getMat();
+    Size ssize = src.size();
+    int depth = src.depth(), kind = CVTRESIZE_ROWWISE;
+
+    CV_Assert( dsize.width > 0 && dsize.height > 0 && ssize.width > 0 && ssize.height > 0 );
+    CV_Assert( interpolation == INTER_NEAREST || interpolation == INTER_LINEAR ||
+               interpolation == INTER_AREA );
+
+    switch( code )
+    {
+    case CV_BayerBG2BGR: case CV_BayerGB2BGR: case CV_BayerRG2BGR: case CV_BayerGR2BGR:
+    case CV_BayerBG2GRAY: case CV_BayerGB2GRAY: case CV_BayerRG2GRAY: case CV_BayerGR2GRAY:
+        kind = CVTRESIZE_BAYER;
+        dcn = code >= CV_BayerBG2GRAY ? 1 : 3;
+        CV_Assert( src.channels() == 1 && (depth == CV_8U || depth == CV_16U) );
+        break;
+    case CV_BayerBG2BGR_VNG: case CV_BayerGB2BGR_VNG: case CV_BayerRG2BGR_VNG: case CV_BayerGR2BGR_VNG:
+        kind = CVTRESIZE_BAYER_VNG;
+        dcn = 3;
+        CV_Assert( src.type() == CV_8UC1 );
+        break;
+    case CV_YUV420sp2BGR:  case CV_YUV420sp2RGB:  case CV_YUV420i2BGR:  case CV_YUV420i2RGB:
+    case CV_YUV420sp2BGRA: case CV_YUV420sp2RGBA: case CV_YUV420i2BGRA: case CV_YUV420i2RGBA:
+        kind = CVTRESIZE_YUV420;
+        if( dcn <= 0 )
+            dcn = code == CV_YUV420sp2BGRA || code == CV_YUV420sp2RGBA ||
+                  code == CV_YUV420i2BGRA || code == CV_YUV420i2RGBA ? 4 : 3;
+        CV_Assert( dcn == 1 || dcn == 3 || dcn == 4 );
+        CV_Assert( ssize.width % 2 == 0 && ssize.height % 3 == 0 && src.type() == CV_8UC1 && src.isContinuous() );
+        ssize.height = ssize.height*2/3;
+        break;
+    default:
+        {
+        // let cvtColor() validate the code and report the number of output channels
+        Mat probe;
+        cvtColor(src.row(0), probe, code, dcn);
+        CV_Assert( probe.size() == Size(ssize.width, 1) );
+        dcn = probe.channels();
+        }
+    }
+
+    int ddepth = rtype < 0 ? depth : CV_MAT_DEPTH(rtype);
+    CV_Assert( ddepth != CV_USRTYPE1 );
+    _dst.create(dsize, CV_MAKETYPE(ddepth, dcn));
+    Mat dst = _dst.getMat();
+    CV_Assert( dst.data != src.data );
+
+    double inv_scale_x = (double)dsize.width/ssize.width;
+    double inv_scale_y = (double)dsize.height/ssize.height;
+    bool area_mode = interpolation == INTER_AREA && inv_scale_x <= 1 && inv_scale_y <= 1;
+    ResizeTaps xtab(ssize.width, dsize.width, inv_scale_x, interpolation, area_mode);
+    ResizeTaps ytab(ssize.height, dsize.height, inv_scale_y, interpolation, area_mode);
+    xtab.pad(dcn);
+    int tileRows = std::max(cvRound(CVTRESIZE_TILE_SRC_ROWS*inv_scale_y), 1);
+
+    parallel_for(BlockedRange(0, dsize.height, tileRows),
+                 CvtColorResizeInvoker(src, dst, code, kind, dcn, xtab, ytab, alpha, beta, tileRows));
+}
+
+
 CV_IMPL void
 cvCvtColor( const CvArr* srcarr, CvArr* dstarr, int code )
 {
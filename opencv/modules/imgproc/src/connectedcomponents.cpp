@@ -0,0 +1,385 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                        Intel License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000, Intel Corporation, all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of Intel Corporation may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+#include "precomp.hpp"
+
+/*
+ Connected components labeling.
+
+ The image is split into horizontal stripes that are labeled in parallel: every foreground pixel
+ takes the label of its already visited neighbors (in the upper row of the same stripe and on the left)
+ or gets a new provisional label, and the equivalent labels are merged in a union-find forest where
+ every label points to a smaller or equal one. The stripes allocate the labels from disjoint ranges,
+ so they never touch the same tree. Then the trees are merged across the stripe boundaries and flattened
+ into the consecutive final labels, and the second parallel pass relabels the pixels and accumulates
+ the per-component statistics.
+
+ The root of every tree is the label of the first pixel of the component in the raster order,
+ so the components are numbered in that order whatever the number of stripes is.
+*/
+
+namespace cv
+{
+
+enum { CC_STRIPE_SIZE = 1 << 15 };
+
+static inline int ccFindRoot( const int* P, int i )
+{
+    while( P[i] < i )
+        i = P[i];
+    return i;
+}
+
+static inline void ccSetRoot( int* P, int i, int root )
+{
+    while( P[i] < i )
+    {
+        int j = P[i];
+        P[i] = root;
+        i = j;
+    }
+    P[i] = root;
+}
+
+static inline int ccMerge( int* P, int i, int j )
+{
+    int root = ccFindRoot(P, i);
+    if( i != j )
+    {
+        int rootj = ccFindRoot(P, j);
+        if( root > rootj )
+            root = rootj;
+        ccSetRoot(P, j, root);
+    }
+    ccSetRoot(P, i, root);
+    return root;
+}
+
+
+class CCLabelInvoker
+{
+public:
+    CCLabelInvoker( const Mat& _src, Mat& _labels, int* _P, int* _counts,
+                    int _stripeRows, int _connectivity )
+        : src(&_src), labels(&_labels), P(_P), counts(_counts),
+          stripeRows(_stripeRows), connectivity(_connectivity) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        const Mat& src = *this->src;
+        Mat& labels = *this->labels;
+        int* P = this->P;
+        int cols = src.cols, labelsPerRow = (cols + 1)/2;
+
+        for( int s = range.begin(); s < range.end(); s++ )
+        {
+            int y0 = s*stripeRows, y1 = std::min(y0 + stripeRows, src.rows);
+            int base = 1 + y0*labelsPerRow, label = base;
+
+            for( int y = y0; y < y1; y++ )
+            {
+                const uchar* img = src.ptr(y);
+                int* L = labels.ptr<int>(y);
+                const int* Lp = y > y0 ? labels.ptr<int>(y - 1) : 0;
+
+                for( int x = 0; x < cols; x++ )
+                {
+                    if( !img[x] )
+                    {
+                        L[x] = 0;
+                        continue;
+                    }
+
+                    int b = Lp ? Lp[x] : 0, d = x > 0 ? L[x-1] : 0, l;
+                    if( connectivity == 8 )
+                    {
+                        int a = Lp && x > 0 ? Lp[x-1] : 0;
+                        int c = Lp && x < cols - 1 ? Lp[x+1] : 0;
+                        // a, b, c and d are processed already, and b is adjacent to the others
+                        if( b )
+                            l = b;
+                        else if( c )
+                            l = a ? ccMerge(P, c, a) : d ? ccMerge(P, c, d) : c;
+                        else if( a )
+                            l = a;
+                        else if( d )
+                            l = d;
+                        else
+                        {
+                            l = label++;
+                            P[l] = l;
+                        }
+                    }
+                    else
+                    {
+                        if( b )
+                            l = d ? ccMerge(P, b, d) : b;
+                        else if( d )
+                            l = d;
+                        else
+                        {
+                            l = label++;
+                            P[l] = l;
+                        }
+                    }
+                    L[x] = l;
+                }
+            }
+            counts[s] = label - base;
+        }
+    }
+
+protected:
+    const Mat* src;
+    Mat* labels;
+    int* P;
+    int* counts;
+    int stripeRows, connectivity;
+};
+
+
+class CCRelabelInvoker
+{
+public:
+    CCRelabelInvoker( Mat& _labels, const int* _P, int _nlabels, bool _computeStats )
+        : labels(&_labels), P(_P), nlabels(_nlabels), computeStats(_computeStats)
+    {
+        init();
+    }
+
+    CCRelabelInvoker( CCRelabelInvoker& other, Split )
+        : labels(other.labels), P(other.P), nlabels(other.nlabels), computeStats(other.computeStats)
+    {
+        init();
+    }
+
+    void operator()( const BlockedRange& range )
+    {
+        int cols = labels->cols;
+        int* bbox = computeStats ? &bboxes[0] : 0;
+        int* area = computeStats ? &areas[0] : 0;
+        double* sum = computeStats ? &sums[0] : 0;
+
+        for( int y = range.begin(); y < range.end(); y++ )
+        {
+            int* L = labels->ptr<int>(y);
+            if( !computeStats )
+            {
+                for( int x = 0; x < cols; x++ )
+                    L[x] = P[L[x]];
+                continue;
+            }
+
+            // the statistics are updated once per run of the equal provisional labels
+            for( int x = 0; x < cols; )
+            {
+                int x0 = x, l0 = L[x], l = P[l0];
+                for( ; x < cols && L[x] == l0; x++ )
+                    L[x] = l;
+                int n = x - x0;
+                int* r = bbox + l*4;
+                r[0] = std::min(r[0], x0); r[1] = std::min(r[1], y);
+                r[2] = std::max(r[2], x - 1); r[3] = std::max(r[3], y);
+                area[l] += n;
+                sum[l*2] += (double)(x0 + x - 1)*n*0.5;
+                sum[l*2+1] += (double)y*n;
+            }
+        }
+    }
+
+    void join( CCRelabelInvoker& other )
+    {
+        if( !computeStats )
+            return;
+        for( int l = 0; l < nlabels; l++ )
+        {
+            int* r = &bboxes[l*4];
+            const int* r2 = &other.bboxes[l*4];
+            r[0] = std::min(r[0], r2[0]); r[1] = std::min(r[1], r2[1]);
+            r[2] = std::max(r[2], r2[2]); r[3] = std::max(r[3], r2[3]);
+            areas[l] += other.areas[l];
+            sums[l*2] += other.sums[l*2];
+            sums[l*2+1] += other.sums[l*2+1];
+        }
+    }
+
+    void getStats( Mat& stats, Mat& centroids ) const
+    {
+        for( int l = 0; l < nlabels; l++ )
+        {
+            int* s = stats.ptr<int>(l);
+            double* c = centroids.ptr<double>(l);
+            const int* r = &bboxes[l*4];
+            int n = areas[l];
+            if( n == 0 )
+            {
+                // there are no background pixels
+                s[CC_STAT_LEFT] = s[CC_STAT_TOP] = s[CC_STAT_WIDTH] = s[CC_STAT_HEIGHT] = s[CC_STAT_AREA] = 0;
+                c[0] = c[1] = 0;
+                continue;
+            }
+            s[CC_STAT_LEFT] = r[0];
+            s[CC_STAT_TOP] = r[1];
+            s[CC_STAT_WIDTH] = r[2] - r[0] + 1;
+            s[CC_STAT_HEIGHT] = r[3] - r[1] + 1;
+            s[CC_STAT_AREA] = n;
+            c[0] = sums[l*2]/n;
+            c[1] = sums[l*2+1]/n;
+        }
+    }
+
+protected:
+    void init()
+    {
+        if( !computeStats )
+            return;
+        bboxes.resize(nlabels*4);
+        for( int l = 0; l < nlabels; l++ )
+        {
+            bboxes[l*4] = bboxes[l*4+1] = INT_MAX;
+            bboxes[l*4+2] = bboxes[l*4+3] = INT_MIN;
+        }
+        areas.resize(nlabels, 0);
+        sums.resize(nlabels*2, 0.);
+    }
+
+    Mat* labels;
+    const int* P;
+    int nlabels;
+    bool computeStats;
+    vector<int> bboxes, areas;
+    vector<double> sums;
+};
+
+
+static int connectedComponents_( InputArray _img, OutputArray _labels, OutputArray _stats,
+                                 OutputArray _centroids, int connectivity, int ltype, bool computeStats )
+{
+    Mat img = _img.getMat(), labels;
+    CV_Assert( img.type() == CV_8UC1 );
+    CV_Assert( connectivity == 8 || connectivity == 4 );
+    CV_Assert( ltype == CV_32S || ltype == CV_16U );
+
+    int rows = img.rows, cols = img.cols, labelsPerRow = (cols + 1)/2;
+    CV_Assert( (double)rows*labelsPerRow < INT_MAX );
+
+    _labels.create(img.size(), ltype);
+    if( ltype == CV_32S )
+        labels = _labels.getMat();
+    else
+        labels.create(img.size(), CV_32S);
+
+    int stripeRows = std::max(CC_STRIPE_SIZE/std::max(cols, 1), 4);
+    int nstripes = (rows + stripeRows - 1)/stripeRows;
+    vector<int> _P(1 + rows*labelsPerRow), counts(nstripes);
+    int* P = &_P[0];
+    P[0] = 0;
+
+    parallel_for(BlockedRange(0, nstripes),
+                 CCLabelInvoker(img, labels, P, &counts[0], stripeRows, connectivity));
+
+    // merge the components that cross the stripe boundaries
+    for( int s = 1; s < nstripes; s++ )
+    {
+        int y = s*stripeRows;
+        const int* L = labels.ptr<int>(y);
+        const int* Lp = labels.ptr<int>(y - 1);
+        for( int x = 0; x < cols; x++ )
+        {
+            if( !L[x] )
+                continue;
+            if( connectivity == 8 )
+            {
+                if( x > 0 && Lp[x-1] )
+                    ccMerge(P, L[x], Lp[x-1]);
+                if( x < cols - 1 && Lp[x+1] )
+                    ccMerge(P, L[x], Lp[x+1]);
+            }
+            if( Lp[x] )
+                ccMerge(P, L[x], Lp[x]);
+        }
+    }
+
+    // the label parents precede the labels, so a single pass assigns the final labels
+    int nlabels = 1;
+    for( int s = 0; s < nstripes; s++ )
+    {
+        int base = 1 + s*stripeRows*labelsPerRow;
+        for( int i = base; i < base + counts[s]; i++ )
+            P[i] = P[i] < i ? P[P[i]] : nlabels++;
+    }
+
+    CCRelabelInvoker body(labels, P, nlabels, computeStats);
+    size_t minChunkSize = std::max((size_t)CC_STRIPE_SIZE, computeStats ? (size_t)nlabels*64 : 0);
+    parallel_reduce(BlockedRange(0, rows, (int)std::max(minChunkSize/std::max(cols, 1), (size_t)1)), body);
+
+    if( ltype == CV_16U )
+    {
+        CV_Assert( nlabels <= USHRT_MAX + 1 );
+        Mat dst = _labels.getMat();
+        labels.convertTo(dst, CV_16U);
+    }
+
+    if( computeStats )
+    {
+        _stats.create(nlabels, CC_STAT_MAX, CV_32S);
+        _centroids.create(nlabels, 2, CV_64F);
+        Mat stats = _stats.getMat(), centroids = _centroids.getMat();
+        body.getStats(stats, centroids);
+    }
+    return nlabels;
+}
+
+}
+
+int cv::connectedComponents( InputArray img, OutputArray labels, int connectivity, int ltype )
+{
+    return connectedComponents_(img, labels, noArray(), noArray(), connectivity, ltype, false);
+}
+
+int cv::connectedComponentsWithStats( InputArray img, OutputArray labels, OutputArray stats,
+                                      OutputArray centroids, int connectivity, int ltype )
+{
+    return connectedComponents_(img, labels, stats, centroids, connectivity, ltype, true);
+}
+
+/* End of file. */
@@ -1469,15 +1469,344 @@ cvFindContours( void*  img,  CvMemStorage*  storage,
     return count;
 }
 
+namespace cv
+{
+
+struct FlatContourInfo
+{
+    int next;       // the next contour marked with the same nbd
+    int parent;     // -1 stands for the image frame
+    int lastChild;
+    int is_hole;
+    Point origin;
+    Rect rect;
+};
+
+/* the same border following as icvFetchContourEx, but the points are appended to the flat buffer */
+static void
+fetchFlatContour( schar* ptr, int step, Point pt, Point offset, int is_hole,
+                  int method, int nbd, vector<Point>& points, Rect& _rect )
+{
+    int deltas[16];
+    schar *i0 = ptr, *i1, *i3, *i4;
+    int prev_s = -1, s, s_end;
+    int xmin = pt.x, xmax = pt.x, ymin = pt.y, ymax = pt.y;
+    bool all_points = method == CV_CHAIN_APPROX_NONE;
+
+    CV_INIT_3X3_DELTAS( deltas, step, 1 );
+    memcpy( deltas + 8, deltas, 8 * sizeof( deltas[0] ));
+
+    s_end = s = is_hole ? 0 : 4;
+
+    do
+    {
+        s = (s - 1) & 7;
+        i1 = i0 + deltas[s];
+        if( *i1 != 0 )
+            break;
+    }
+    while( s != s_end );
+
+    if( s == s_end )            /* single pixel domain */
+    {
+        *i0 = (schar) (nbd | 0x80);
+        points.push_back( pt + offset );
+    }
+    else
+    {
+        i3 = i0;
+        prev_s = s ^ 4;
+
+        /* follow border */
+        for( ;; )
+        {
+            s_end = s;
+
+            for( ;; )
+            {
+                i4 = i3 + deltas[++s];
+                if( *i4 != 0 )
+                    break;
+            }
+            s &= 7;
+
+            /* check "right" bound */
+            if( (unsigned) (s - 1) < (unsigned) s_end )
+                *i3 = (schar) (nbd | 0x80);
+            else if( *i3 == 1 )
+                *i3 = (schar) nbd;
+
+            if( s != prev_s )
+            {
+                points.push_back( pt + offset );
+
+                xmin = std::min( xmin, pt.x );
+                xmax = std::max( xmax, pt.x );
+                ymin = std::min( ymin, pt.y );
+                ymax = std::max( ymax, pt.y );
+            }
+            else if( all_points )
+                points.push_back( pt + offset );
+
+            prev_s = s;
+            pt.x += icvCodeDeltas[s].x;
+            pt.y += icvCodeDeltas[s].y;
+
+            if( i4 == i0 && i3 == i1 )
+                break;
+
+            i3 = i4;
+            s = (s + 4) & 7;
+        }
+    }
+
+    _rect = Rect( xmin, ymin, xmax - xmin + 1, ymax - ymin + 1 );
+}
+
+/* Suzuki85 border following (see cvFindNextContour) that stores the contours
+   into the flat buffer and keeps the contour tree as indices */
+static void
+findFlatContours( Mat& image, ContourBuffer& contours, vector<FlatContourInfo>& info,
+                  int mode, int method, Point offset )
+{
+    if( image.type() != CV_8UC1 )
+        CV_Error( CV_StsUnsupportedFormat, "findContours supports only 8uC1 images" );
+
+    int y, cols = image.cols, rows = image.rows;
+    int step = (int)image.step;
+    uchar* data = image.data;
+
+    /* make zero borders and convert all pixels to 0 or 1 */
+    memset( data, 0, cols );
+    memset( data + step * (rows - 1), 0, cols );
+    for( y = 1; y < rows - 1; y++ )
+        data[y*step] = data[y*step + cols - 1] = 0;
+    threshold( image, image, 0, 1, THRESH_BINARY );
+
+    contours.clear();
+    info.clear();
+
+    schar* img0 = (schar*)data;
+    schar* img = img0 + step;
+    int width = cols - 1, height = rows - 1;
+    int cinfo_table[126];
+    int lastTop = -1;
+    int nbd = 2;
+    Point lnbd( 0, 1 );
+
+    for( int k = 0; k < 126; k++ )
+        cinfo_table[k] = -1;
+
+    for( y = 1; y < height; y++, img += step )
+    {
+        int prev = 0;
+        lnbd.x = 0;
+        lnbd.y = y;
+
+        for( int x = 1; x < width; x++ )
+        {
+            int p = img[x];
+
+            if( p == prev )
+                continue;
+
+            int is_hole = 0;
+
+            if( !(prev == 0 && p == 1) )    /* if not external contour */
+            {
+                /* check hole */
+                if( p != 0 || prev < 1 )
+                {
+                    prev = p;
+                    if( prev & -2 )
+                        lnbd.x = x;
+                    continue;
+                }
+
+                if( prev & -2 )
+                    lnbd.x = x - 1;
+                is_hole = 1;
+            }
+
+            if( mode == CV_RETR_EXTERNAL && (is_hole || img0[lnbd.y * step + lnbd.x] > 0) )
+            {
+                prev = p;
+                if( prev & -2 )
+                    lnbd.x = x;
+                continue;
+            }
+
+            Point origin( x - is_hole, y );
+            int parent = -1;
+
+            /* find contour parent */
+            if( !(mode <= CV_RETR_LIST || (!is_hole && mode == CV_RETR_CCOMP) || lnbd.x <= 0) )
+            {
+                int lval = img0[lnbd.y * step + lnbd.x] & 0x7f;
+                int cur = cinfo_table[lval - 2], par = -1;
+
+                CV_DbgAssert( lval >= 2 );
+
+                /* find the first bounding contour */
+                while( cur >= 0 )
+                {
+                    const Rect& r = info[cur].rect;
+                    if( (unsigned) (lnbd.x - r.x) < (unsigned) r.width &&
+                        (unsigned) (lnbd.y - r.y) < (unsigned) r.height )
+                    {
+                        if( par >= 0 && icvTraceContour( img0 + info[par].origin.y * step +
+                                                         info[par].origin.x, step, img + lnbd.x,
+                                                         info[par].is_hole ) > 0 )
+                            break;
+                        par = cur;
+                    }
+                    cur = info[cur].next;
+                }
+
+                CV_DbgAssert( par >= 0 );
+                parent = info[par].is_hole == is_hole ? info[par].parent : par;
+            }
+
+            lnbd.x = x - is_hole;
+
+            int idx = (int)info.size();
+            FlatContourInfo ci;
+            ci.parent = parent;
+            ci.lastChild = -1;
+            ci.is_hole = is_hole;
+            ci.origin = origin;
+
+            contours.offsets.push_back( (int)contours.points.size() );
+            fetchFlatContour( img + x - is_hole, step, origin, offset, is_hole,
+                              method, nbd, contours.points, ci.rect );
+
+            if( mode > CV_RETR_LIST )
+            {
+                ci.next = cinfo_table[nbd - 2];
+                cinfo_table[nbd - 2] = idx;
+
+                /* change nbd */
+                nbd = (nbd + 1) & 127;
+                nbd += nbd == 0 ? 3 : 0;
+            }
+            else
+                ci.next = -1;
+
+            /* append the contour to the children list of its parent */
+            int& last = parent >= 0 ? info[parent].lastChild : lastTop;
+            if( last >= 0 )
+                contours.hierarchy[last][0] = idx;
+            else if( parent >= 0 )
+                contours.hierarchy[parent][2] = idx;
+            contours.hierarchy.push_back( Vec4i(-1, last, -1, parent) );
+            last = idx;
+            info.push_back( ci );
+
+            /* the pixel has been marked by the border following */
+            prev = img[x];
+        }
+    }
+
+    contours.offsets.push_back( (int)contours.points.size() );
+}
+
+}
+
+void cv::ContourBuffer::clear()
+{
+    points.clear();
+    offsets.clear();
+    hierarchy.clear();
+}
+
+void cv::findContours( InputOutputArray _image, ContourBuffer& contours,
+                       int mode, int method, Point offset )
+{
+    if( method != CV_CHAIN_APPROX_NONE && method != CV_CHAIN_APPROX_SIMPLE )
+        CV_Error( CV_StsBadArg, "Only CV_CHAIN_APPROX_NONE and CV_CHAIN_APPROX_SIMPLE "
+                  "are supported by findContours with ContourBuffer" );
+    CV_Assert( CV_RETR_EXTERNAL <= mode && mode <= CV_RETR_TREE );
+
+    Mat image = _image.getMat();
+    vector<FlatContourInfo> info;
+    findFlatContours( image, contours, info, mode, method, offset );
+}
+
 void cv::findContours( InputOutputArray _image, OutputArrayOfArrays _contours,
                    OutputArray _hierarchy, int mode, int method, Point offset )
 {
     Mat image = _image.getMat();
+    if( _hierarchy.needed() )
+        _hierarchy.clear();
+
+    if( image.type() == CV_8UC1 && CV_RETR_EXTERNAL <= mode && mode <= CV_RETR_TREE &&
+        (method == CV_CHAIN_APPROX_NONE || method == CV_CHAIN_APPROX_SIMPLE) )
+    {
+        ContourBuffer buf;
+        vector<FlatContourInfo> info;
+        findFlatContours( image, buf, info, mode, method, offset );
+
+        int i, total = buf.size();
+        if( total == 0 )
+        {
+            _contours.clear();
+            return;
+        }
+
+        /* the contours are output in the order of cvTreeToNodeSeq() applied to the tree built by
+           cvFindContours(): the children are prepended to the lists, so the depth-first traversal
+           visits the siblings in the reverse order */
+        vector<int> order(total), index(total);
+        int node = total - 1;
+        while( buf.hierarchy[node][3] >= 0 )
+            node--;
+        for( i = 0; node >= 0; i++ )
+        {
+            order[i] = node;
+            index[node] = i;
+            if( info[node].lastChild >= 0 )
+                node = info[node].lastChild;
+            else
+            {
+                while( node >= 0 && buf.hierarchy[node][1] < 0 )
+                    node = buf.hierarchy[node][3];
+                if( node >= 0 )
+                    node = buf.hierarchy[node][1];
+            }
+        }
+        CV_Assert( i == total );
+
+        _contours.create(total, 1, 0, -1, true);
+        for( i = 0; i < total; i++ )
+        {
+            int k = order[i], n = buf.count(k);
+            _contours.create(n, 1, CV_32SC2, i, true);
+            Mat ci = _contours.getMat(i);
+            CV_Assert( ci.isContinuous() );
+            memcpy( ci.data, buf.contour(k), n*sizeof(Point) );
+        }
+
+        if( _hierarchy.needed() )
+        {
+            _hierarchy.create(1, total, CV_32SC4, -1, true);
+            Vec4i* hierarchy = _hierarchy.getMat().ptr<Vec4i>();
+
+            for( i = 0; i < total; i++ )
+            {
+                const Vec4i& h = buf.hierarchy[order[i]];
+                int lastChild = info[order[i]].lastChild;
+                hierarchy[i] = Vec4i(h[1] >= 0 ? index[h[1]] : -1,
+                                     h[0] >= 0 ? index[h[0]] : -1,
+                                     lastChild >= 0 ? index[lastChild] : -1,
+                                     h[3] >= 0 ? index[h[3]] : -1);
+            }
+        }
+        return;
+    }
+
     MemStorage storage(cvCreateMemStorage());
     CvMat _cimage = image;
     CvSeq* _ccontours = 0;
-    if( _hierarchy.needed() )
-        _hierarchy.clear();
     cvFindContours(&_cimage, storage, &_ccontours, sizeof(CvContour), mode, method, offset);
     if( !_ccontours )
     {
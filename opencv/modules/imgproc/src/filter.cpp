@@ -95,14 +95,17 @@ namespace cv
 
 BaseRowFilter::BaseRowFilter() { ksize = anchor = -1; }
 BaseRowFilter::~BaseRowFilter() {}
+Ptr<BaseRowFilter> BaseRowFilter::clone() const { return Ptr<BaseRowFilter>(); }
 
 BaseColumnFilter::BaseColumnFilter() { ksize = anchor = -1; }
 BaseColumnFilter::~BaseColumnFilter() {}
 void BaseColumnFilter::reset() {}
+Ptr<BaseColumnFilter> BaseColumnFilter::clone() const { return Ptr<BaseColumnFilter>(); }
 
 BaseFilter::BaseFilter() { ksize = Size(-1,-1); anchor = Point(-1,-1); }
 BaseFilter::~BaseFilter() {}
 void BaseFilter::reset() {}
+Ptr<BaseFilter> BaseFilter::clone() const { return Ptr<BaseFilter>(); }
 
 FilterEngine::FilterEngine()
 {
@@ -429,6 +432,78 @@ int FilterEngine::proceed( const uchar* src, int srcstep, int count,
 }
 
 
+enum
+{
+    FILTER_MIN_STRIPE_AREA = 1 << 15,
+    FILTER_MIN_STRIPE_HEIGHT = 16,
+    FILTER_STRIPE_KSIZE_FACTOR = 8,
+    FILTER_MAX_STRIPES = 64
+};
+
+// makes an engine with the same parameters and its own copies of the filters;
+// returns an empty pointer if some of the filters can not be copied
+static Ptr<FilterEngine> cloneFilterEngine(const FilterEngine& f)
+{
+    Ptr<BaseFilter> filter2D;
+    Ptr<BaseRowFilter> rowFilter;
+    Ptr<BaseColumnFilter> columnFilter;
+
+    if( f.isSeparable() )
+    {
+        rowFilter = f.rowFilter->clone();
+        columnFilter = f.columnFilter->clone();
+        if( rowFilter.empty() || columnFilter.empty() )
+            return Ptr<FilterEngine>();
+    }
+    else
+    {
+        filter2D = f.filter2D->clone();
+        if( filter2D.empty() )
+            return Ptr<FilterEngine>();
+    }
+
+    Ptr<FilterEngine> e = new FilterEngine(filter2D, rowFilter, columnFilter,
+        f.srcType, f.dstType, f.bufType, f.rowBorderType, f.columnBorderType);
+    e->constBorderValue = f.constBorderValue;
+    return e;
+}
+
+// Each stripe of the destination ROI is processed by its own engine as if it was
+// a separate ROI of the same whole image, so the source rows above and below
+// the stripe are taken from the image and the border extrapolation is unchanged.
+class FilterStripeInvoker
+{
+public:
+    FilterStripeInvoker(vector<Ptr<FilterEngine> >& _engines, const Mat& _src, Mat& _dst,
+                        Rect _srcRoi, Point _dstOfs, Size _wholeSize, Point _ofs)
+        : engines(&_engines), src(&_src), dst(&_dst), srcRoi(_srcRoi), dstOfs(_dstOfs),
+          wholeSize(_wholeSize), ofs(_ofs) {}
+
+    void operator()(const BlockedRange& range) const
+    {
+        int nstripes = (int)engines->size();
+        size_t esz = dst->elemSize();
+        for( int i = range.begin(); i < range.end(); i++ )
+        {
+            FilterEngine& e = *(*engines)[i];
+            int y0 = srcRoi.height*i/nstripes, y1 = srcRoi.height*(i+1)/nstripes;
+            Rect stripe(srcRoi.x + ofs.x, srcRoi.y + ofs.y + y0, srcRoi.width, y1 - y0);
+            int y = e.start(wholeSize, stripe) - ofs.y;
+            e.proceed( src->data + y*src->step, (int)src->step, e.endY - e.startY,
+                       dst->data + (dstOfs.y + y0)*dst->step + dstOfs.x*esz, (int)dst->step );
+        }
+    }
+
+protected:
+    vector<Ptr<FilterEngine> >* engines;
+    const Mat* src;
+    Mat* dst;
+    Rect srcRoi;
+    Point dstOfs;
+    Size wholeSize;
+    Point ofs;
+};
+
 void FilterEngine::apply(const Mat& src, Mat& dst,
     const Rect& _srcRoi, Point dstOfs, bool isolated)
 {
@@ -445,9 +520,39 @@ void FilterEngine::apply(const Mat& src, Mat& dst,
         dstOfs.x + srcRoi.width <= dst.cols &&
         dstOfs.y + srcRoi.height <= dst.rows );
 
-    int y = start(src, srcRoi, isolated);
-    proceed( src.data + y*src.step, (int)src.step, endY - startY,
-             dst.data + dstOfs.y*dst.step + dstOfs.x*dst.elemSize(), (int)dst.step );
+    int nstripes = 1;
+    if( getNumThreads() > 1 &&
+        (dst.dataend <= src.datastart || src.dataend <= dst.datastart) )
+    {
+        int minStripeHeight = std::max(std::max(ksize.height*(int)FILTER_STRIPE_KSIZE_FACTOR,
+            (int)FILTER_MIN_STRIPE_HEIGHT), (int)FILTER_MIN_STRIPE_AREA/srcRoi.width);
+        nstripes = std::min(srcRoi.height/minStripeHeight, (int)FILTER_MAX_STRIPES);
+    }
+
+    vector<Ptr<FilterEngine> > engines;
+    for( int i = 0; i < nstripes && nstripes > 1; i++ )
+    {
+        Ptr<FilterEngine> e = cloneFilterEngine(*this);
+        if( e.empty() )
+            nstripes = 1;
+        else
+            engines.push_back(e);
+    }
+
+    if( nstripes <= 1 )
+    {
+        int y = start(src, srcRoi, isolated);
+        proceed( src.data + y*src.step, (int)src.step, endY - startY,
+                 dst.data + dstOfs.y*dst.step + dstOfs.x*dst.elemSize(), (int)dst.step );
+        return;
+    }
+
+    Point ofs;
+    Size wsz(src.cols, src.rows);
+    if( !isolated )
+        src.locateROI( wsz, ofs );
+    parallel_for(BlockedRange(0, nstripes),
+                 FilterStripeInvoker(engines, src, dst, srcRoi, dstOfs, wsz, ofs));
 }
 
 }
@@ -2016,6 +2121,8 @@ template<typename ST, typename DT, class VecOp> struct RowFilter : public BaseRo
         vecOp = _vecOp;
     }
     
+    Ptr<BaseRowFilter> clone() const { return new RowFilter(*this); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         int _ksize = ksize;
@@ -2074,6 +2181,8 @@ template<typename ST, typename DT, class VecOp> struct SymmRowSmallFilter :
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 && this->ksize <= 5 );
     }
     
+    Ptr<BaseRowFilter> clone() const { return new SymmRowSmallFilter(*this); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         int ksize2 = this->ksize/2, ksize2n = ksize2*cn;
@@ -2213,6 +2322,8 @@ template<class CastOp, class VecOp> struct ColumnFilter : public BaseColumnFilte
                    (kernel.rows == 1 || kernel.cols == 1));
     }
 
+    Ptr<BaseColumnFilter> clone() const { return new ColumnFilter(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         const ST* ky = (const ST*)kernel.data;
@@ -2275,6 +2386,8 @@ template<class CastOp, class VecOp> struct SymmColumnFilter : public ColumnFilte
         CV_Assert( (symmetryType & (KERNEL_SYMMETRICAL | KERNEL_ASYMMETRICAL)) != 0 );
     }
 
+    Ptr<BaseColumnFilter> clone() const { return new SymmColumnFilter(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int ksize2 = this->ksize/2;
@@ -2381,6 +2494,8 @@ struct SymmColumnSmallFilter : public SymmColumnFilter<CastOp, VecOp>
         CV_Assert( this->ksize == 3 );
     }
 
+    Ptr<BaseColumnFilter> clone() const { return new SymmColumnSmallFilter(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int ksize2 = this->ksize/2;
@@ -2822,6 +2937,8 @@ template<typename ST, class CastOp, class VecOp> struct Filter2D : public BaseFi
         ptrs.resize( coords.size() );
     }
 
+    Ptr<BaseFilter> clone() const { return new Filter2D(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width, int cn)
     {
         KT _delta = delta;
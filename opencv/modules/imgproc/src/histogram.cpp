@@ -204,6 +204,64 @@ static void histPrepareImages( const Mat* images, int nimages, const int* channe
         }
     }
 }
+
+
+/*
+ The images prepared by histPrepareImages() are processed in parallel by bands of rows or,
+ when the continuous images have been merged into a single row, by segments of
+ HIST_SEGMENT_SIZE pixels. calcHist accumulates every chunk of bands into a private histogram
+ and joins them at the end, so each chunk should cover enough pixels to outweigh the cost of
+ clearing and merging its histogram.
+*/
+enum { HIST_SEGMENT_SIZE = 1 << 12, HIST_MIN_CHUNK_SIZE = 1 << 16 };
+
+class HistBands
+{
+public:
+    HistBands( const vector<uchar*>& _ptrs, const vector<int>& _deltas, Size _imsize,
+               int _dims, size_t _esz, size_t _lastEsz )
+        : ptrs(&_ptrs), deltas(&_deltas), imsize(_imsize), dims(_dims), esz(_esz), lastEsz(_lastEsz)
+    {
+        bandSize = imsize.height > 1 ? imsize.width : std::min(imsize.width, (int)HIST_SEGMENT_SIZE);
+        nbands = imsize.height > 1 ? imsize.height : (imsize.width + bandSize - 1)/std::max(bandSize, 1);
+    }
+
+    //! the range of the bands, where every chunk covers at least minChunkSize pixels
+    BlockedRange range(size_t minChunkSize) const
+    {
+        int grain = (int)std::min((minChunkSize + bandSize - 1)/std::max(bandSize, 1), (size_t)INT_MAX);
+        return BlockedRange(0, nbands, std::max(grain, 1));
+    }
+
+    //! sets the pointers to the beginning of the bands [b, e) and returns the size of the bands
+    Size getBands(int b, int e, vector<uchar*>& bptrs) const
+    {
+        const vector<uchar*>& p = *ptrs;
+        const int* d = &(*deltas)[0];
+        bptrs.resize(dims + 1);
+        if( imsize.height > 1 )
+        {
+            for( int i = 0; i < dims; i++ )
+                bptrs[i] = p[i] + (size_t)b*(imsize.width*d[i*2] + d[i*2+1])*esz;
+            bptrs[dims] = p[dims] ? p[dims] + (size_t)b*d[dims*2+1]*lastEsz : 0;
+            return Size(imsize.width, e - b);
+        }
+        int x0 = b*bandSize, x1 = std::min(e*bandSize, imsize.width);
+        for( int i = 0; i < dims; i++ )
+            bptrs[i] = p[i] + (size_t)x0*d[i*2]*esz;
+        bptrs[dims] = p[dims] ? p[dims] + (size_t)x0*lastEsz : 0;
+        return Size(x1 - x0, 1);
+    }
+
+    const vector<int>& getDeltas() const { return *deltas; }
+
+protected:
+    const vector<uchar*>* ptrs;
+    const vector<int>* deltas;
+    Size imsize;
+    int dims, bandSize, nbands;
+    size_t esz, lastEsz;
+};
     
     
 ////////////////////////////////// C A L C U L A T E    H I S T O G R A M ////////////////////////////////////        
@@ -422,6 +480,131 @@ calcHist_( vector<uchar*>& _ptrs, const vector<int>& _deltas,
     }    
 }
     
+
+#if CV_SSE2
+
+/*
+ SIMD path for the 2D and 3D histograms of an 8-bit 3-channel image (or of 8-bit planes), where every
+ bin covers 2^k consecutive values (e.g. 8x8x8 or 32x32 bins over [0,256)), so the lookup tables
+ reduce to shifts. The bins of 32 pixels are combined into 16-bit histogram indices at once, and the
+ small histograms are counted in 4 copies to avoid waiting on the repeated indices. Returns false
+ when the images or the histogram do not fit.
+*/
+static bool
+calcHistShift_8u( uchar** ptrs, const int* deltas, Size imsize, Mat& hist,
+                  int dims, const size_t* tab )
+{
+    int i, k, x, y, cn = deltas[0], shift[3], ofs[3] = {0, 0, 0};
+    int total = (int)hist.total();
+    
+    if( total > 65536 || !hist.isContinuous() || (cn != 1 && cn != 3) )
+        return false;
+    
+    const uchar* base = ptrs[0];
+    for( i = 0; i < dims; i++ )
+    {
+        if( deltas[i*2] != cn )
+            return false;
+        for( shift[i] = 0; shift[i] < 8; shift[i]++ )
+            if( tab[i*256 + 255] == (size_t)(255 >> shift[i])*hist.step[i] )
+                break;
+        for( k = 0; k < 256; k++ )
+            if( shift[i] == 8 || tab[i*256 + k] != (size_t)(k >> shift[i])*hist.step[i] )
+                return false;
+        if( cn == 3 && ptrs[i] < base )
+            base = ptrs[i];
+    }
+    if( cn == 3 )
+        for( i = 0; i < dims; i++ )
+        {
+            ofs[i] = (int)(ptrs[i] - base);
+            if( ofs[i] > 2 )
+                return false;
+        }
+    
+    int ncopies = total <= 4096 ? 4 : 1;
+    AutoBuffer<int> _hbuf(ncopies > 1 ? total*ncopies : 1);
+    int* hbuf = ncopies > 1 ? (int*)_hbuf : (int*)hist.data;
+    int hofs = ncopies > 1 ? total : 0;
+    if( ncopies > 1 )
+        memset(hbuf, 0, total*ncopies*sizeof(hbuf[0]));
+    
+    __m128i z = _mm_setzero_si128(), bmask[3], mult[3];
+    for( i = 0; i < dims; i++ )
+    {
+        bmask[i] = _mm_set1_epi8((char)(255 >> shift[i]));
+        mult[i] = _mm_set1_epi16((short)(hist.step[i]/sizeof(int)));
+    }
+    // the 3-channel loop may read one pixel ahead when the first channel is not 0
+    int width0 = imsize.width - 32 - (cn == 3);
+    ushort buf[32];
+    
+    for( y = 0; y < imsize.height; y++ )
+    {
+        const uchar* row = base + (size_t)y*(imsize.width*cn + deltas[1]);
+        const uchar* p[3];
+        for( i = 0; i < dims; i++ )
+            p[i] = ptrs[i] + (size_t)y*(imsize.width*cn + deltas[i*2+1]);
+        
+        for( x = 0; x <= width0; x += 32 )
+        {
+            __m128i v[6], idx[4];
+            if( cn == 3 )
+            {
+                const __m128i* src = (const __m128i*)(row + x*3);
+                v[0] = _mm_loadu_si128(src); v[1] = _mm_loadu_si128(src + 1);
+                v[2] = _mm_loadu_si128(src + 2); v[3] = _mm_loadu_si128(src + 3);
+                v[4] = _mm_loadu_si128(src + 4); v[5] = _mm_loadu_si128(src + 5);
+                _mm_deinterleave3_epi8(v[0], v[1], v[2], v[3], v[4], v[5]);
+            }
+            
+            idx[0] = idx[1] = idx[2] = idx[3] = z;
+            for( i = 0; i < dims; i++ )
+            {
+                __m128i b0, b1;
+                if( cn == 3 )
+                    b0 = v[ofs[i]*2], b1 = v[ofs[i]*2 + 1];
+                else
+                    b0 = _mm_loadu_si128((const __m128i*)(p[i] + x)),
+                    b1 = _mm_loadu_si128((const __m128i*)(p[i] + x + 16));
+                b0 = _mm_and_si128(_mm_srli_epi16(b0, shift[i]), bmask[i]);
+                b1 = _mm_and_si128(_mm_srli_epi16(b1, shift[i]), bmask[i]);
+                idx[0] = _mm_add_epi16(idx[0], _mm_mullo_epi16(_mm_unpacklo_epi8(b0, z), mult[i]));
+                idx[1] = _mm_add_epi16(idx[1], _mm_mullo_epi16(_mm_unpackhi_epi8(b0, z), mult[i]));
+                idx[2] = _mm_add_epi16(idx[2], _mm_mullo_epi16(_mm_unpacklo_epi8(b1, z), mult[i]));
+                idx[3] = _mm_add_epi16(idx[3], _mm_mullo_epi16(_mm_unpackhi_epi8(b1, z), mult[i]));
+            }
+            _mm_storeu_si128((__m128i*)buf, idx[0]);
+            _mm_storeu_si128((__m128i*)(buf + 8), idx[1]);
+            _mm_storeu_si128((__m128i*)(buf + 16), idx[2]);
+            _mm_storeu_si128((__m128i*)(buf + 24), idx[3]);
+            
+            for( k = 0; k < 32; k += 4 )
+            {
+                hbuf[buf[k]]++; hbuf[hofs + buf[k+1]]++;
+                hbuf[hofs*2 + buf[k+2]]++; hbuf[hofs*3 + buf[k+3]]++;
+            }
+        }
+        
+        for( ; x < imsize.width; x++ )
+        {
+            size_t hidx = tab[p[0][x*cn]];
+            for( i = 1; i < dims; i++ )
+                hidx += tab[i*256 + p[i][x*cn]];
+            hbuf[hidx/sizeof(int)]++;
+        }
+    }
+    
+    if( ncopies > 1 )
+    {
+        int* H = (int*)hist.data;
+        for( k = 0; k < total; k++ )
+            H[k] += hbuf[k] + hbuf[k + total] + hbuf[k + total*2] + hbuf[k + total*3];
+    }
+    return true;
+}
+
+#endif
     
 static void
 calcHist_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
@@ -439,10 +622,19 @@ calcHist_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
     calcHistLookupTables_8u( hist, SparseMat(), dims, _ranges, _uniranges, uniform, false, _tab );
     const size_t* tab = &_tab[0];
     
+#if CV_SSE2
+    if( (dims == 2 || dims == 3) && !mask && checkHardwareSupport(CV_CPU_SSE2) &&
+        calcHistShift_8u(ptrs, deltas, imsize, hist, dims, tab) )
+        return;
+#endif
+    
     if( dims == 1 )
     {
         int d0 = deltas[0], step0 = deltas[1];
-        int matH[256] = {0};
+        // the consecutive pixels are counted in 4 separate histograms; otherwise the runs
+        // of equal pixels make every increment wait for the previous one to be stored
+        int matH[4][256];
+        memset(matH, 0, sizeof(matH));
         const uchar* p0 = (const uchar*)ptrs[0];
         
         for( ; imsize.height--; p0 += step0, mask += mstep )
@@ -454,9 +646,9 @@ calcHist_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
                     for( x = 0; x <= imsize.width - 4; x += 4 )
                     {
                         int t0 = p0[x], t1 = p0[x+1];
-                        matH[t0]++; matH[t1]++;
+                        matH[0][t0]++; matH[1][t1]++;
                         t0 = p0[x+2]; t1 = p0[x+3];
-                        matH[t0]++; matH[t1]++;
+                        matH[2][t0]++; matH[3][t1]++;
                     }
                     p0 += x;
                 }
@@ -464,27 +656,27 @@ calcHist_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
                     for( x = 0; x <= imsize.width - 4; x += 4 )
                     {
                         int t0 = p0[0], t1 = p0[d0];
-                        matH[t0]++; matH[t1]++;
+                        matH[0][t0]++; matH[1][t1]++;
                         p0 += d0*2;
                         t0 = p0[0]; t1 = p0[d0];
-                        matH[t0]++; matH[t1]++;
+                        matH[2][t0]++; matH[3][t1]++;
                         p0 += d0*2;
                     }
                 
                 for( ; x < imsize.width; x++, p0 += d0 )
-                    matH[*p0]++;
+                    matH[0][*p0]++;
             }
             else
                 for( x = 0; x < imsize.width; x++, p0 += d0 )
                     if( mask[x] )
-                        matH[*p0]++;
+                        matH[x & 3][*p0]++;
         }
         
         for( i = 0; i < 256; i++ )
         {
             size_t hidx = tab[i];
             if( hidx < OUT_OF_RANGE )
-                *(int*)(H + hidx) += matH[i];
+                *(int*)(H + hidx) += matH[0][i] + matH[1][i] + matH[2][i] + matH[3][i];
         }
     }
     else if( dims == 2 )
@@ -590,6 +782,52 @@ calcHist_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
     }
 }
 
+
+class CalcHistInvoker
+{
+public:
+    CalcHistInvoker( const HistBands& _bands, int _depth, Mat& _hist, int _dims,
+                     const float** _ranges, const double* _uniranges, bool _uniform )
+        : bands(&_bands), depth(_depth), hist(_hist), dims(_dims),
+          ranges(_ranges), uniranges(_uniranges), uniform(_uniform) {}
+
+    CalcHistInvoker( CalcHistInvoker& other, Split )
+        : bands(other.bands), depth(other.depth), dims(other.dims),
+          ranges(other.ranges), uniranges(other.uniranges), uniform(other.uniform)
+    {
+        hist.create(other.hist.dims, other.hist.size, CV_32S);
+        hist = Scalar::all(0);
+    }
+
+    void operator()( const BlockedRange& range )
+    {
+        vector<uchar*> ptrs;
+        Size imsize = bands->getBands(range.begin(), range.end(), ptrs);
+        const vector<int>& deltas = bands->getDeltas();
+
+        if( depth == CV_8U )
+            calcHist_8u(ptrs, deltas, imsize, hist, dims, ranges, uniranges, uniform );
+        else if( depth == CV_16U )
+            calcHist_<ushort>(ptrs, deltas, imsize, hist, dims, ranges, uniranges, uniform );
+        else
+            calcHist_<float>(ptrs, deltas, imsize, hist, dims, ranges, uniranges, uniform );
+    }
+
+    void join( CalcHistInvoker& other )
+    {
+        add(hist, other.hist, hist);
+    }
+
+protected:
+    const HistBands* bands;
+    int depth;
+    Mat hist;
+    int dims;
+    const float** ranges;
+    const double* uniranges;
+    bool uniform;
+};
+
 }
 
 void cv::calcHist( const Mat* images, int nimages, const int* channels,
@@ -622,15 +860,13 @@ void cv::calcHist( const Mat* images, int nimages, const int* channels,
     
     int depth = images[0].depth();
     
-    if( depth == CV_8U )
-        calcHist_8u(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform );
-    else if( depth == CV_16U )
-        calcHist_<ushort>(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform );
-    else if( depth == CV_32F )
-        calcHist_<float>(ptrs, deltas, imsize, ihist, dims, ranges, _uniranges, uniform );
-    else
+    if( depth != CV_8U && depth != CV_16U && depth != CV_32F )
         CV_Error(CV_StsUnsupportedFormat, "");
     
+    HistBands bands(ptrs, deltas, imsize, dims, images[0].elemSize1(), 1);
+    CalcHistInvoker body(bands, depth, ihist, dims, ranges, _uniranges, uniform);
+    parallel_reduce(bands.range(std::max((size_t)HIST_MIN_CHUNK_SIZE, ihist.total()*8)), body);
+    
     ihist.convertTo(hist, CV_32F);
 }
 
@@ -1147,6 +1383,40 @@ calcBackProj_8u( vector<uchar*>& _ptrs, const vector<int>& _deltas,
     }
 }    
 
+
+class CalcBackProjInvoker
+{
+public:
+    CalcBackProjInvoker( const HistBands& _bands, int _depth, const Mat& _hist, int _dims,
+                         const float** _ranges, const double* _uniranges, float _scale, bool _uniform )
+        : bands(&_bands), depth(_depth), hist(&_hist), dims(_dims),
+          ranges(_ranges), uniranges(_uniranges), scale(_scale), uniform(_uniform) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        vector<uchar*> ptrs;
+        Size imsize = bands->getBands(range.begin(), range.end(), ptrs);
+        const vector<int>& deltas = bands->getDeltas();
+
+        if( depth == CV_8U )
+            calcBackProj_8u(ptrs, deltas, imsize, *hist, dims, ranges, uniranges, scale, uniform);
+        else if( depth == CV_16U )
+            calcBackProj_<ushort, ushort>(ptrs, deltas, imsize, *hist, dims, ranges, uniranges, scale, uniform );
+        else
+            calcBackProj_<float, float>(ptrs, deltas, imsize, *hist, dims, ranges, uniranges, scale, uniform );
+    }
+
+protected:
+    const HistBands* bands;
+    int depth;
+    const Mat* hist;
+    int dims;
+    const float** ranges;
+    const double* uniranges;
+    float scale;
+    bool uniform;
+};
+
 }
     
 void cv::calcBackProject( const Mat* images, int nimages, const int* channels,
@@ -1168,14 +1438,13 @@ void cv::calcBackProject( const Mat* images, int nimages, const int* channels,
     const double* _uniranges = uniform ? &uniranges[0] : 0;
     
     int depth = images[0].depth();
-    if( depth == CV_8U )
-        calcBackProj_8u(ptrs, deltas, imsize, hist, dims, ranges, _uniranges, (float)scale, uniform);
-    else if( depth == CV_16U )
-        calcBackProj_<ushort, ushort>(ptrs, deltas, imsize, hist, dims, ranges, _uniranges, (float)scale, uniform );
-    else if( depth == CV_32F )
-        calcBackProj_<float, float>(ptrs, deltas, imsize, hist, dims, ranges, _uniranges, (float)scale, uniform );
-    else
+    if( depth != CV_8U && depth != CV_16U && depth != CV_32F )
         CV_Error(CV_StsUnsupportedFormat, "");
+    
+    size_t esz = images[0].elemSize1();
+    HistBands bands(ptrs, deltas, imsize, dims, esz, esz);
+    parallel_for(bands.range(HIST_MIN_CHUNK_SIZE),
+                 CalcBackProjInvoker(bands, depth, hist, dims, ranges, _uniranges, (float)scale, uniform));
 }
 
 
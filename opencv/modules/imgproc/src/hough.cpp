@@ -72,69 +72,149 @@ CvLinePolar;
 
 static CV_IMPLEMENT_QSORT_EX( icvHoughSortDescent32s, int, hough_cmp_gt, const int* )
 
+namespace cv
+{
+
 /*
-Here image is an input raster;
-step is it's step; size characterizes it's ROI;
-rho and theta are discretization steps (in pixels and radians correspondingly).
-threshold is the minimum number of pixels in the feature for it
-to be a candidate for line. lines is the output
-array of (rho, theta) pairs. linesMax is the buffer size (number of pairs).
-Functions return the actual number of found lines.
+   Computes the accumulator offsets abase[n] + cvRound(x*tabCos[n] + y*tabSin[n])
+   of the point (x, y) for all the angles n. The float arithmetic is the same
+   in the SSE2 and in the plain branches, so they vote into the same cells.
 */
 static void
-icvHoughLinesStandard( const CvMat* img, float rho, float theta,
-                       int threshold, CvSeq *lines, int linesMax )
+houghLineOffsets( int x, int y, const float* tabCos, const float* tabSin,
+                  const int* abase, int numangle, int* ofs )
 {
-    cv::AutoBuffer<int> _accum, _sort_buf;
-    cv::AutoBuffer<float> _tabSin, _tabCos;
-
-    const uchar* image;
-    int step, width, height;
-    int numangle, numrho;
-    int total = 0;
-    float ang;
-    int r, n;
-    int i, j;
-    float irho = 1 / rho;
-    double scale;
-
-    CV_Assert( CV_IS_MAT(img) && CV_MAT_TYPE(img->type) == CV_8UC1 );
-
-    image = img->data.ptr;
-    step = img->step;
-    width = img->cols;
-    height = img->rows;
+    int n = 0;
+#if CV_SSE2
+    if( checkHardwareSupport(CV_CPU_SSE2) )
+    {
+        __m128 fx = _mm_set1_ps((float)x), fy = _mm_set1_ps((float)y);
+        for( ; n <= numangle - 4; n += 4 )
+        {
+            __m128 v = _mm_add_ps(_mm_mul_ps(fx, _mm_loadu_ps(tabCos + n)),
+                                  _mm_mul_ps(fy, _mm_loadu_ps(tabSin + n)));
+            __m128i r = _mm_add_epi32(_mm_cvtps_epi32(v),
+                                      _mm_loadu_si128((const __m128i*)(abase + n)));
+            _mm_storeu_si128((__m128i*)(ofs + n), r);
+        }
+    }
+#endif
+    for( ; n < numangle; n++ )
+        ofs[n] = abase[n] + cvRound( x * tabCos[n] + y * tabSin[n] );
+}
 
-    numangle = cvRound(CV_PI / theta);
-    numrho = cvRound(((width + height) * 2 + 1) / rho);
+static void
+houghLineTables( float rho, float theta, int numangle, int numrho, int astep,
+                 vector<float>& tabCos, vector<float>& tabSin, vector<int>& abase )
+{
+    float ang, irho = 1 / rho;
+    int n;
 
-    _accum.allocate((numangle+2) * (numrho+2));
-    _sort_buf.allocate(numangle * numrho);
-    _tabSin.allocate(numangle);
-    _tabCos.allocate(numangle);
-    int *accum = _accum, *sort_buf = _sort_buf;
-    float *tabSin = _tabSin, *tabCos = _tabCos;
-    
-    memset( accum, 0, sizeof(accum[0]) * (numangle+2) * (numrho+2) );
+    tabCos.resize(numangle);
+    tabSin.resize(numangle);
+    abase.resize(numangle);
 
     for( ang = 0, n = 0; n < numangle; ang += theta, n++ )
     {
         tabSin[n] = (float)(sin(ang) * irho);
         tabCos[n] = (float)(cos(ang) * irho);
+        abase[n] = n * astep + (numrho - 1) / 2;
     }
+}
 
-    // stage 1. fill accumulator
-    for( i = 0; i < height; i++ )
-        for( j = 0; j < width; j++ )
+/* the number of image rows voted by one parallel_reduce body, so that
+   every thread gets one accumulator copy */
+static int houghRowsPerThread( int rows )
+{
+    int nthreads = std::max(getNumThreads(), 1);
+    return std::max((rows + nthreads - 1)/nthreads, 1);
+}
+
+class HoughLinesVoteInvoker
+{
+public:
+    HoughLinesVoteInvoker( const Mat& _image, const float* _tabCos, const float* _tabSin,
+                           const int* _abase, int _numangle, Mat& _accum )
+        : image(&_image), tabCos(_tabCos), tabSin(_tabSin), abase(_abase),
+          numangle(_numangle), accum(_accum) {}
+
+    HoughLinesVoteInvoker( HoughLinesVoteInvoker& other, Split )
+        : image(other.image), tabCos(other.tabCos), tabSin(other.tabSin),
+          abase(other.abase), numangle(other.numangle)
+    {
+        accum = Mat::zeros(other.accum.size(), CV_32S);
+    }
+
+    void operator()( const BlockedRange& range )
+    {
+        AutoBuffer<int> _ofs(numangle);
+        int* ofs = _ofs;
+        int* adata = accum.ptr<int>();
+        int width = image->cols;
+
+        for( int i = range.begin(); i < range.end(); i++ )
         {
-            if( image[i * step + j] != 0 )
-                for( n = 0; n < numangle; n++ )
-                {
-                    r = cvRound( j * tabCos[n] + i * tabSin[n] );
-                    r += (numrho - 1) / 2;
-                    accum[(n+1) * (numrho+2) + r+1]++;
-                }
+            const uchar* row = image->ptr(i);
+            for( int j = 0; j < width; j++ )
+            {
+                if( row[j] == 0 )
+                    continue;
+                houghLineOffsets( j, i, tabCos, tabSin, abase, numangle, ofs );
+                for( int n = 0; n < numangle; n++ )
+                    adata[ofs[n]]++;
+            }
         }
+    }
+
+    void join( HoughLinesVoteInvoker& other )
+    {
+        add(accum, other.accum, accum);
+    }
+
+protected:
+    const Mat* image;
+    const float* tabCos;
+    const float* tabSin;
+    const int* abase;
+    int numangle;
+    Mat accum;
+};
+
+/*
+Here image is an input raster;
+rho and theta are discretization steps (in pixels and radians correspondingly).
+threshold is the minimum number of pixels in the feature for it
+to be a candidate for line. lines is the output
+array of (rho, theta) pairs. linesMax is the buffer size (number of pairs).
+The accumulator is filled by the image stripes in parallel.
+*/
+static void
+HoughLinesStandard( const Mat& img, float rho, float theta,
+                    int threshold, vector<Vec2f>& lines, int linesMax )
+{
+    CV_Assert( img.type() == CV_8UC1 || img.type() == CV_8SC1 );
+
+    int width = img.cols, height = img.rows;
+    int numangle = cvRound(CV_PI / theta);
+    int numrho = cvRound(((width + height) * 2 + 1) / rho);
+    int total = 0, r, n, i;
+    vector<float> tabCos, tabSin;
+    vector<int> abase;
+    AutoBuffer<int> _sort_buf(numangle * numrho);
+    int* sort_buf = _sort_buf;
+    Mat _accum = Mat::zeros( numangle+2, numrho+2, CV_32S );
+
+    // the cell (n, r) is stored at accum[(n+1)*(numrho+2) + r+1]
+    houghLineTables( rho, theta, numangle, numrho, numrho+2, tabCos, tabSin, abase );
+    for( n = 0; n < numangle; n++ )
+        abase[n] += numrho + 3;
+
+    lines.clear();
+
+    // stage 1. fill accumulator
+    HoughLinesVoteInvoker body( img, &tabCos[0], &tabSin[0], &abase[0], numangle, _accum );
+    parallel_reduce( BlockedRange(0, height, houghRowsPerThread(height)), body );
+    const int* accum = _accum.ptr<int>();
 
     // stage 2. find local maximums
     for( r = 0; r < numrho; r++ )
@@ -152,19 +232,17 @@ icvHoughLinesStandard( const CvMat* img, float rho, float theta,
 
     // stage 4. store the first min(total,linesMax) lines to the output buffer
     linesMax = MIN(linesMax, total);
-    scale = 1./(numrho+2);
+    double scale = 1./(numrho+2);
     for( i = 0; i < linesMax; i++ )
     {
-        CvLinePolar line;
         int idx = sort_buf[i];
-        int n = cvFloor(idx*scale) - 1;
-        int r = idx - (n+1)*(numrho+2) - 1;
-        line.rho = (r - (numrho - 1)*0.5f) * rho;
-        line.angle = n * theta;
-        cvSeqPush( lines, &line );
+        n = cvFloor(idx*scale) - 1;
+        r = idx - (n+1)*(numrho+2) - 1;
+        lines.push_back( Vec2f((r - (numrho - 1)*0.5f) * rho, n * theta) );
     }
 }
 
+}
 
 /****************************************************************************************\
 *                     Multi-Scale variant of Classical Hough Transform                   *
@@ -334,7 +412,10 @@ icvHoughLinesSDiv( const CvMat* img,
 
     if( count * 100 > rn * tn )
     {
-        icvHoughLinesStandard( img, rho, theta, threshold, lines, linesMax );
+        cv::vector<cv::Vec2f> slines;
+        cv::HoughLinesStandard( cv::Mat(img), rho, theta, threshold, slines, linesMax );
+        if( !slines.empty() )
+            cvSeqPushMulti( lines, &slines[0], (int)slines.size() );
         return;
     }
 
@@ -458,70 +539,60 @@ icvHoughLinesSDiv( const CvMat* img,
 *                              Probabilistic Hough Transform                             *
 \****************************************************************************************/
 
-static void
-icvHoughLinesProbabalistic( CvMat* image,
-                            float rho, float theta, int threshold,
-                            int lineLength, int lineGap,
-                            CvSeq *lines, int linesMax )
+namespace cv
 {
-    cv::Mat accum, mask;
-    cv::vector<float> trigtab;
-    cv::MemStorage storage(cvCreateMemStorage(0));
 
-    CvSeq* seq;
-    CvSeqWriter writer;
+static void
+HoughLinesProbabilistic( const Mat& image, float rho, float theta, int threshold,
+                         int lineLength, int lineGap, vector<Vec4i>& lines, int linesMax )
+{
+    Mat accum, mask;
+    vector<float> tabCos, tabSin;
+    vector<int> abase;
+    vector<Point> nzloc;
+    AutoBuffer<int> _ofs;
+    int* ofs;
     int width, height;
     int numangle, numrho;
-    float ang;
-    int r, n, count;
-    CvPoint pt;
-    float irho = 1 / rho;
+    int n, count;
+    Point pt;
     CvRNG rng = cvRNG(-1);
-    const float* ttab;
     uchar* mdata0;
 
-    CV_Assert( CV_IS_MAT(image) && CV_MAT_TYPE(image->type) == CV_8UC1 );
+    CV_Assert( image.type() == CV_8UC1 || image.type() == CV_8SC1 );
 
-    width = image->cols;
-    height = image->rows;
+    width = image.cols;
+    height = image.rows;
 
     numangle = cvRound(CV_PI / theta);
     numrho = cvRound(((width + height) * 2 + 1) / rho);
 
-    accum.create( numangle, numrho, CV_32SC1 );
+    accum = Mat::zeros( numangle, numrho, CV_32SC1 );
     mask.create( height, width, CV_8UC1 );
-    trigtab.resize(numangle*2);
-    accum = cv::Scalar(0);
-
-    for( ang = 0, n = 0; n < numangle; ang += theta, n++ )
-    {
-        trigtab[n*2] = (float)(cos(ang) * irho);
-        trigtab[n*2+1] = (float)(sin(ang) * irho);
-    }
-    ttab = &trigtab[0];
+    houghLineTables( rho, theta, numangle, numrho, numrho, tabCos, tabSin, abase );
+    _ofs.allocate(numangle);
+    ofs = _ofs;
     mdata0 = mask.data;
-
-    cvStartWriteSeq( CV_32SC2, sizeof(CvSeq), sizeof(CvPoint), storage, &writer );
+    lines.clear();
 
     // stage 1. collect non-zero image points
-    for( pt.y = 0, count = 0; pt.y < height; pt.y++ )
+    for( pt.y = 0; pt.y < height; pt.y++ )
     {
-        const uchar* data = image->data.ptr + pt.y*image->step;
+        const uchar* data = image.ptr(pt.y);
         uchar* mdata = mdata0 + pt.y*width;
         for( pt.x = 0; pt.x < width; pt.x++ )
         {
             if( data[pt.x] )
             {
                 mdata[pt.x] = (uchar)1;
-                CV_WRITE_SEQ_ELEM( pt, writer );
+                nzloc.push_back(pt);
             }
             else
                 mdata[pt.x] = 0;
         }
     }
 
-    seq = cvEndWriteSeq( &writer );
-    count = seq->total;
+    count = (int)nzloc.size();
 
     // stage 2. process all the points in random order
     for( ; count > 0; count-- )
@@ -529,30 +600,26 @@ icvHoughLinesProbabalistic( CvMat* image,
         // choose random point out of the remaining ones
         int idx = cvRandInt(&rng) % count;
         int max_val = threshold-1, max_n = 0;
-        CvPoint* pt = (CvPoint*)cvGetSeqElem( seq, idx );
-        CvPoint line_end[2] = {{0,0}, {0,0}};
+        Point point = nzloc[idx];
+        Point line_end[2];
         float a, b;
-        int* adata = (int*)accum.data;
-        int i, j, k, x0, y0, dx0, dy0, xflag;
+        int* adata = accum.ptr<int>();
+        int i = point.y, j = point.x, k, x0, y0, dx0, dy0, xflag;
         int good_line;
         const int shift = 16;
 
-        i = pt->y;
-        j = pt->x;
-
         // "remove" it by overriding it with the last element
-        *pt = *(CvPoint*)cvGetSeqElem( seq, count-1 );
+        nzloc[idx] = nzloc[count-1];
 
         // check if it has been excluded already (i.e. belongs to some other line)
         if( !mdata0[i*width + j] )
             continue;
 
         // update accumulator, find the most probable line
-        for( n = 0; n < numangle; n++, adata += numrho )
+        houghLineOffsets( j, i, &tabCos[0], &tabSin[0], &abase[0], numangle, ofs );
+        for( n = 0; n < numangle; n++ )
         {
-            r = cvRound( j * ttab[n*2] + i * ttab[n*2+1] );
-            r += (numrho - 1) / 2;
-            int val = ++adata[r];
+            int val = ++adata[ofs[n]];
             if( max_val < val )
             {
                 max_val = val;
@@ -566,8 +633,8 @@ icvHoughLinesProbabalistic( CvMat* image,
 
         // from the current point walk in each direction
         // along the found line and extract the line segment
-        a = -ttab[max_n*2+1];
-        b = ttab[max_n*2];
+        a = -tabSin[max_n];
+        b = tabCos[max_n];
         x0 = j;
         y0 = i;
         if( fabs(a) > fabs(b) )
@@ -630,8 +697,8 @@ icvHoughLinesProbabalistic( CvMat* image,
             }
         }
 
-        good_line = abs(line_end[1].x - line_end[0].x) >= lineLength ||
-                    abs(line_end[1].y - line_end[0].y) >= lineLength;
+        good_line = std::abs(line_end[1].x - line_end[0].x) >= lineLength ||
+                    std::abs(line_end[1].y - line_end[0].y) >= lineLength;
 
         for( k = 0; k < 2; k++ )
         {
@@ -668,13 +735,10 @@ icvHoughLinesProbabalistic( CvMat* image,
                 {
                     if( good_line )
                     {
-                        adata = (int*)accum.data;
-                        for( n = 0; n < numangle; n++, adata += numrho )
-                        {
-                            r = cvRound( j1 * ttab[n*2] + i1 * ttab[n*2+1] );
-                            r += (numrho - 1) / 2;
-                            adata[r]--;
-                        }
+                        adata = accum.ptr<int>();
+                        houghLineOffsets( j1, i1, &tabCos[0], &tabSin[0], &abase[0], numangle, ofs );
+                        for( n = 0; n < numangle; n++ )
+                            adata[ofs[n]]--;
                     }
                     *mdata = 0;
                 }
@@ -686,14 +750,15 @@ icvHoughLinesProbabalistic( CvMat* image,
 
         if( good_line )
         {
-            CvRect lr = { line_end[0].x, line_end[0].y, line_end[1].x, line_end[1].y };
-            cvSeqPush( lines, &lr );
-            if( lines->total >= linesMax )
+            lines.push_back( Vec4i(line_end[0].x, line_end[0].y, line_end[1].x, line_end[1].y) );
+            if( (int)lines.size() >= linesMax )
                 return;
         }
     }
 }
 
+}
+
 /* Wrapper function for standard hough transform */
 CV_IMPL CvSeq*
 cvHoughLines2( CvArr* src_image, void* lineStorage, int method,
@@ -763,16 +828,26 @@ cvHoughLines2( CvArr* src_image, void* lineStorage, int method,
     switch( method )
     {
     case CV_HOUGH_STANDARD:
-          icvHoughLinesStandard( img, (float)rho,
-                (float)theta, threshold, lines, linesMax );
+          {
+          cv::vector<cv::Vec2f> slines;
+          cv::HoughLinesStandard( cv::Mat(img), (float)rho,
+                (float)theta, threshold, slines, linesMax );
+          if( !slines.empty() )
+              cvSeqPushMulti( lines, &slines[0], (int)slines.size() );
+          }
           break;
     case CV_HOUGH_MULTI_SCALE:
           icvHoughLinesSDiv( img, (float)rho, (float)theta,
                 threshold, iparam1, iparam2, lines, linesMax );
           break;
     case CV_HOUGH_PROBABILISTIC:
-          icvHoughLinesProbabalistic( img, (float)rho, (float)theta,
-                threshold, iparam1, iparam2, lines, linesMax );
+          {
+          cv::vector<cv::Vec4i> plines;
+          cv::HoughLinesProbabilistic( cv::Mat(img), (float)rho, (float)theta,
+                threshold, iparam1, iparam2, plines, linesMax );
+          if( !plines.empty() )
+              cvSeqPushMulti( lines, &plines[0], (int)plines.size() );
+          }
           break;
     default:
         CV_Error( CV_StsBadArg, "Unrecognized method id" );
@@ -796,102 +871,226 @@ cvHoughLines2( CvArr* src_image, void* lineStorage, int method,
 *                                     Circle Detection                                   *
 \****************************************************************************************/
 
-static void
-icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
-                         int min_radius, int max_radius,
-                         int canny_threshold, int acc_threshold,
-                         CvSeq* circles, int circles_max )
+namespace cv
 {
-    const int SHIFT = 10, ONE = 1 << SHIFT, R_THRESH = 30;
-    cv::Ptr<CvMat> dx, dy;
-    cv::Ptr<CvMat> edges, accum, dist_buf;
-    std::vector<int> sort_buf;
-    cv::Ptr<CvMemStorage> storage;
-
-    int x, y, i, j, k, center_count, nz_count;
-    float min_radius2 = (float)min_radius*min_radius;
-    float max_radius2 = (float)max_radius*max_radius;
-    int rows, cols, arows, acols;
-    int astep, *adata;
-    float* ddata;
-    CvSeq *nz, *centers;
-    float idp, dr;
-    CvSeqReader reader;
 
-    edges = cvCreateMat( img->rows, img->cols, CV_8UC1 );
-    cvCanny( img, edges, MAX(canny_threshold/2,1), canny_threshold, 3 );
+class HoughCirclesVoteInvoker
+{
+public:
+    enum { SHIFT = 10, ONE = 1 << SHIFT };
 
-    dx = cvCreateMat( img->rows, img->cols, CV_16SC1 );
-    dy = cvCreateMat( img->rows, img->cols, CV_16SC1 );
-    cvSobel( img, dx, 1, 0, 3 );
-    cvSobel( img, dy, 0, 1, 3 );
+    HoughCirclesVoteInvoker( const Mat& _edges, const Mat& _dx, const Mat& _dy, float _idp,
+                             int _min_radius, int _max_radius, Mat& _accum )
+        : edges(&_edges), dx(&_dx), dy(&_dy), idp(_idp),
+          min_radius(_min_radius), max_radius(_max_radius), accum(_accum) {}
 
-    if( dp < 1.f )
-        dp = 1.f;
-    idp = 1.f/dp;
-    accum = cvCreateMat( cvCeil(img->rows*idp)+2, cvCeil(img->cols*idp)+2, CV_32SC1 );
-    cvZero(accum);
+    HoughCirclesVoteInvoker( HoughCirclesVoteInvoker& other, Split )
+        : edges(other.edges), dx(other.dx), dy(other.dy), idp(other.idp),
+          min_radius(other.min_radius), max_radius(other.max_radius)
+    {
+        accum = Mat::zeros(other.accum.size(), CV_32S);
+    }
 
-    storage = cvCreateMemStorage();
-    nz = cvCreateSeq( CV_32SC2, sizeof(CvSeq), sizeof(CvPoint), storage );
-    centers = cvCreateSeq( CV_32SC1, sizeof(CvSeq), sizeof(int), storage );
+    void operator()( const BlockedRange& range )
+    {
+        int cols = edges->cols;
+        int arows = accum.rows - 2, acols = accum.cols - 2;
+        int astep = (int)(accum.step/sizeof(int));
+        int* adata = accum.ptr<int>();
+
+        for( int y = range.begin(); y < range.end(); y++ )
+        {
+            const uchar* edges_row = edges->ptr(y);
+            const short* dx_row = dx->ptr<short>(y);
+            const short* dy_row = dy->ptr<short>(y);
+
+            for( int x = 0; x < cols; x++ )
+            {
+                float vx, vy;
+                int sx, sy, x0, y0, x1, y1, r, k;
+
+                vx = dx_row[x];
+                vy = dy_row[x];
+
+                if( !edges_row[x] || (vx == 0 && vy == 0) )
+                    continue;
+
+                float mag = std::sqrt(vx*vx+vy*vy);
+                assert( mag >= 1 );
+                sx = cvRound((vx*idp)*ONE/mag);
+                sy = cvRound((vy*idp)*ONE/mag);
 
-    rows = img->rows;
-    cols = img->cols;
-    arows = accum->rows - 2;
-    acols = accum->cols - 2;
-    adata = accum->data.i;
-    astep = accum->step/sizeof(adata[0]);
+                x0 = cvRound((x*idp)*ONE);
+                y0 = cvRound((y*idp)*ONE);
+
+                for( k = 0; k < 2; k++ )
+                {
+                    x1 = x0 + min_radius * sx;
+                    y1 = y0 + min_radius * sy;
+
+                    for( r = min_radius; r <= max_radius; x1 += sx, y1 += sy, r++ )
+                    {
+                        int x2 = x1 >> SHIFT, y2 = y1 >> SHIFT;
+                        if( (unsigned)x2 >= (unsigned)acols ||
+                            (unsigned)y2 >= (unsigned)arows )
+                            break;
+                        adata[y2*astep + x2]++;
+                    }
+
+                    sx = -sx; sy = -sy;
+                }
 
-    for( y = 0; y < rows; y++ )
+                nz.push_back(Point(x, y));
+            }
+        }
+    }
+
+    void join( HoughCirclesVoteInvoker& other )
     {
-        const uchar* edges_row = edges->data.ptr + y*edges->step;
-        const short* dx_row = (const short*)(dx->data.ptr + y*dx->step);
-        const short* dy_row = (const short*)(dy->data.ptr + y*dy->step);
+        add(accum, other.accum, accum);
+        nz.insert(nz.end(), other.nz.begin(), other.nz.end());
+    }
 
-        for( x = 0; x < cols; x++ )
-        {
-            float vx, vy;
-            int sx, sy, x0, y0, x1, y1, r, k;
-            CvPoint pt;
+    vector<Point> nz;
 
-            vx = dx_row[x];
-            vy = dy_row[x];
+protected:
+    const Mat* edges;
+    const Mat* dx;
+    const Mat* dy;
+    float idp;
+    int min_radius, max_radius;
+    Mat accum;
+};
 
-            if( !edges_row[x] || (vx == 0 && vy == 0) )
-                continue;
+static bool isCloseToCircles( const vector<Vec3f>& circles, Point2f c, float min_dist2 )
+{
+    for( size_t j = 0; j < circles.size(); j++ )
+        if( (circles[j][0] - c.x)*(circles[j][0] - c.x) +
+            (circles[j][1] - c.y)*(circles[j][1] - c.y) < min_dist2 )
+            return true;
+    return false;
+}
 
-            float mag = sqrt(vx*vx+vy*vy);
-            assert( mag >= 1 );
-            sx = cvRound((vx*idp)*ONE/mag);
-            sy = cvRound((vy*idp)*ONE/mag);
+/* finds the most supported radius and the number of supporting edge points for every center */
+class HoughCircleRadiusInvoker
+{
+public:
+    enum { R_THRESH = 30 };
 
-            x0 = cvRound((x*idp)*ONE);
-            y0 = cvRound((y*idp)*ONE);
+    HoughCircleRadiusInvoker( const vector<Point>& _nz, const Point2f* _centers, float _dr,
+                              int _min_radius, int _max_radius, Vec2f* _radii )
+        : nz(&_nz), centers(_centers), dr(_dr),
+          min_radius(_min_radius), max_radius(_max_radius), radii(_radii) {}
 
-            for( k = 0; k < 2; k++ )
-            {
-                x1 = x0 + min_radius * sx;
-                y1 = y0 + min_radius * sy;
+    void operator()( const BlockedRange& range ) const
+    {
+        int nz_count = (int)nz->size();
+        float min_radius2 = (float)min_radius*min_radius;
+        float max_radius2 = (float)max_radius*max_radius;
+        const Point* pts = &(*nz)[0];
+        vector<float> dist_buf( nz_count );
+        vector<int> sort_buf( nz_count );
+        float* ddata = &dist_buf[0];
+
+        for( int i = range.begin(); i < range.end(); i++ )
+        {
+            float cx = centers[i].x, cy = centers[i].y;
+            float start_dist;
+            float r_best = 0;
+            int j, k, max_count = R_THRESH;
 
-                for( r = min_radius; r <= max_radius; x1 += sx, y1 += sy, r++ )
+            for( j = k = 0; j < nz_count; j++ )
+            {
+                float _dx = cx - pts[j].x, _dy = cy - pts[j].y;
+                float _r2 = _dx*_dx + _dy*_dy;
+                if(min_radius2 <= _r2 && _r2 <= max_radius2 )
                 {
-                    int x2 = x1 >> SHIFT, y2 = y1 >> SHIFT;
-                    if( (unsigned)x2 >= (unsigned)acols ||
-                        (unsigned)y2 >= (unsigned)arows )
-                        break;
-                    adata[y2*astep + x2]++;
+                    ddata[k] = _r2;
+                    sort_buf[k] = k;
+                    k++;
                 }
+            }
+
+            int nz_count1 = k, start_idx = nz_count1 - 1;
+            radii[i] = Vec2f(0.f, 0.f);
+            if( nz_count1 == 0 )
+                continue;
+            Mat dist(1, nz_count1, CV_32F, ddata);
+            pow( dist, 0.5, dist );
+            icvHoughSortDescent32s( &sort_buf[0], nz_count1, (int*)ddata );
+
+            start_dist = ddata[sort_buf[nz_count1-1]];
+            for( j = nz_count1 - 2; j >= 0; j-- )
+            {
+                float d = ddata[sort_buf[j]];
+
+                if( d > max_radius )
+                    break;
 
-                sx = -sx; sy = -sy;
+                if( d - start_dist > dr )
+                {
+                    float r_cur = ddata[sort_buf[(j + start_idx)/2]];
+                    if( (start_idx - j)*r_best >= max_count*r_cur ||
+                        (r_best < FLT_EPSILON && start_idx - j >= max_count) )
+                    {
+                        r_best = r_cur;
+                        max_count = start_idx - j;
+                    }
+                    start_dist = d;
+                    start_idx = j;
+                }
             }
 
-            pt.x = x; pt.y = y;
-            cvSeqPush( nz, &pt );
+            radii[i] = Vec2f(r_best, (float)max_count);
         }
     }
 
-    nz_count = nz->total;
+protected:
+    const vector<Point>* nz;
+    const Point2f* centers;
+    float dr;
+    int min_radius, max_radius;
+    Vec2f* radii;
+};
+
+static void
+HoughCirclesGradient( const Mat& img, float dp, float min_dist,
+                      int min_radius, int max_radius,
+                      int canny_threshold, int acc_threshold,
+                      vector<Vec3f>& circles, int circles_max )
+{
+    Mat edges, dx, dy, _accum;
+    vector<int> centers;
+
+    int x, y, i, k, center_count, nz_count;
+    int rows, cols, arows, acols;
+    const int* adata;
+    float idp;
+
+    circles.clear();
+
+    Canny( img, edges, MAX(canny_threshold/2,1), canny_threshold, 3 );
+    Sobel( img, dx, CV_16S, 1, 0, 3, 1, 0, BORDER_REPLICATE );
+    Sobel( img, dy, CV_16S, 0, 1, 3, 1, 0, BORDER_REPLICATE );
+
+    if( dp < 1.f )
+        dp = 1.f;
+    idp = 1.f/dp;
+    _accum = Mat::zeros( cvCeil(img.rows*idp)+2, cvCeil(img.cols*idp)+2, CV_32SC1 );
+
+    rows = img.rows;
+    cols = img.cols;
+    arows = _accum.rows - 2;
+    acols = _accum.cols - 2;
+
+    // the votes are accumulated by the image stripes in parallel;
+    // the edge points are collected in the raster order
+    HoughCirclesVoteInvoker body( edges, dx, dy, idp, min_radius, max_radius, _accum );
+    parallel_reduce( BlockedRange(0, rows, houghRowsPerThread(rows)), body );
+    const vector<Point>& nz = body.nz;
+    adata = _accum.ptr<int>();
+
+    nz_count = (int)nz.size();
     if( !nz_count )
         return;
 
@@ -903,107 +1102,99 @@ icvHoughCirclesGradient( CvMat* img, float dp, float min_dist,
             if( adata[base] > acc_threshold &&
                 adata[base] > adata[base-1] && adata[base] > adata[base+1] &&
                 adata[base] > adata[base-acols-2] && adata[base] > adata[base+acols+2] )
-                cvSeqPush(centers, &base);
+                centers.push_back(base);
         }
     }
 
-    center_count = centers->total;
+    center_count = (int)centers.size();
     if( !center_count )
         return;
 
-    sort_buf.resize( MAX(center_count,nz_count) );
-    cvCvtSeqToArray( centers, &sort_buf[0] );
-
-    icvHoughSortDescent32s( &sort_buf[0], center_count, adata );
-    cvClearSeq( centers );
-    cvSeqPushMulti( centers, &sort_buf[0], center_count );
+    icvHoughSortDescent32s( &centers[0], center_count, adata );
 
-    dist_buf = cvCreateMat( 1, nz_count, CV_32FC1 );
-    ddata = dist_buf->data.fl;
-
-    dr = dp;
     min_dist = MAX( min_dist, dp );
     min_dist *= min_dist;
 
-    for( i = 0; i < centers->total; i++ )
+    // the radii are estimated for several centers at once; the centers
+    // that are close to the already found circles are skipped, the rest
+    // are accepted in the order of their accumulator values as before
+    int batch_size = std::max(getNumThreads(), 1);
+    vector<Point2f> batch;
+    vector<Vec2f> radii;
+
+    for( i = 0; i < center_count; )
     {
-        int ofs = *(int*)cvGetSeqElem( centers, i );
-        y = ofs/(acols+2) - 1;
-        x = ofs - (y+1)*(acols+2) - 1;
-        float cx = (float)(x*dp), cy = (float)(y*dp);
-        float start_dist, dist_sum;
-        float r_best = 0, c[3];
-        int max_count = R_THRESH;
-
-        for( j = 0; j < circles->total; j++ )
+        batch.clear();
+        for( ; i < center_count && (int)batch.size() < batch_size; i++ )
         {
-            float* c = (float*)cvGetSeqElem( circles, j );
-            if( (c[0] - cx)*(c[0] - cx) + (c[1] - cy)*(c[1] - cy) < min_dist )
-                break;
+            y = centers[i]/(acols+2) - 1;
+            x = centers[i] - (y+1)*(acols+2) - 1;
+            Point2f c((float)(x*dp), (float)(y*dp));
+            if( !isCloseToCircles( circles, c, min_dist ) )
+                batch.push_back( c );
         }
 
-        if( j < circles->total )
+        int count = (int)batch.size();
+        radii.resize( count );
+        if( count == 0 )
             continue;
 
-        cvStartReadSeq( nz, &reader );
-        for( j = k = 0; j < nz_count; j++ )
+        parallel_for( BlockedRange(0, count),
+                      HoughCircleRadiusInvoker( nz, &batch[0], dp, min_radius, max_radius, &radii[0] ) );
+
+        for( k = 0; k < count; k++ )
         {
-            CvPoint pt;
-            float _dx, _dy, _r2;
-            CV_READ_SEQ_ELEM( pt, reader );
-            _dx = cx - pt.x; _dy = cy - pt.y;
-            _r2 = _dx*_dx + _dy*_dy;
-            if(min_radius2 <= _r2 && _r2 <= max_radius2 )
+            if( k > 0 && isCloseToCircles( circles, batch[k], min_dist ) )
+                continue;
+
+            if( radii[k][1] > HoughCircleRadiusInvoker::R_THRESH )
             {
-                ddata[k] = _r2;
-                sort_buf[k] = k;
-                k++;
+                circles.push_back( Vec3f(batch[k].x, batch[k].y, radii[k][0]) );
+                if( (int)circles.size() >= circles_max )
+                    return;
             }
         }
+    }
+}
 
-        int nz_count1 = k, start_idx = nz_count1 - 1;
-        if( nz_count1 == 0 )
-            continue;
-        dist_buf->cols = nz_count1;
-        cvPow( dist_buf, dist_buf, 0.5 );
-        icvHoughSortDescent32s( &sort_buf[0], nz_count1, (int*)ddata );
+}
 
-        dist_sum = start_dist = ddata[sort_buf[nz_count1-1]];
-        for( j = nz_count1 - 2; j >= 0; j-- )
-        {
-            float d = ddata[sort_buf[j]];
+namespace cv
+{
 
-            if( d > max_radius )
-                break;
+static void
+HoughCircles_( const Mat& img, vector<Vec3f>& circles, int method, double dp, double min_dist,
+               double param1, double param2, int min_radius, int max_radius, int circles_max )
+{
+    int canny_threshold = cvRound(param1);
+    int acc_threshold = cvRound(param2);
 
-            if( d - start_dist > dr )
-            {
-                float r_cur = ddata[sort_buf[(j + start_idx)/2]];
-                if( (start_idx - j)*r_best >= max_count*r_cur ||
-                    (r_best < FLT_EPSILON && start_idx - j >= max_count) ) 
-                {
-                    r_best = r_cur;
-                    max_count = start_idx - j;
-                }
-                start_dist = d;
-                start_idx = j;
-                dist_sum = 0;
-            }
-            dist_sum += d;
-        }
+    if( img.type() != CV_8UC1 )
+        CV_Error( CV_StsBadArg, "The source image must be 8-bit, single-channel" );
 
-        if( max_count > R_THRESH )
-        {
-            c[0] = cx;
-            c[1] = cy;
-            c[2] = (float)r_best;
-            cvSeqPush( circles, c );
-            if( circles->total > circles_max )
-                return;
-        }
+    if( dp <= 0 || min_dist <= 0 || canny_threshold <= 0 || acc_threshold <= 0 )
+        CV_Error( CV_StsOutOfRange, "dp, min_dist, canny_threshold and acc_threshold must be all positive numbers" );
+
+    min_radius = MAX( min_radius, 0 );
+    if( max_radius <= 0 )
+        max_radius = MAX( img.rows, img.cols );
+    else if( max_radius <= min_radius )
+        max_radius = min_radius + 2;
+
+    switch( method )
+    {
+    case CV_HOUGH_GRADIENT:
+        HoughCirclesGradient( img, (float)dp, (float)min_dist,
+                              min_radius, max_radius, canny_threshold,
+                              acc_threshold, circles, circles_max );
+        break;
+    default:
+        CV_Error( CV_StsBadArg, "Unrecognized method id" );
     }
 }
 
+}
+
 CV_IMPL CvSeq*
 cvHoughCircles( CvArr* src_image, void* circle_storage,
                 int method, double dp, double min_dist,
@@ -1018,26 +1209,13 @@ cvHoughCircles( CvArr* src_image, void* circle_storage,
     CvSeq circles_header;
     CvSeqBlock circles_block;
     int circles_max = INT_MAX;
-    int canny_threshold = cvRound(param1);
-    int acc_threshold = cvRound(param2);
+    cv::vector<cv::Vec3f> _circles;
 
     img = cvGetMat( img, &stub );
 
-    if( !CV_IS_MASK_ARR(img))
-        CV_Error( CV_StsBadArg, "The source image must be 8-bit, single-channel" );
-
     if( !circle_storage )
         CV_Error( CV_StsNullPtr, "NULL destination" );
 
-    if( dp <= 0 || min_dist <= 0 || canny_threshold <= 0 || acc_threshold <= 0 )
-        CV_Error( CV_StsOutOfRange, "dp, min_dist, canny_threshold and acc_threshold must be all positive numbers" );
-
-    min_radius = MAX( min_radius, 0 );
-    if( max_radius <= 0 )
-        max_radius = MAX( img->rows, img->cols );
-    else if( max_radius <= min_radius )
-        max_radius = min_radius + 2;
-
     if( CV_IS_STORAGE( circle_storage ))
     {
         circles = cvCreateSeq( CV_32FC3, sizeof(CvSeq),
@@ -1060,16 +1238,10 @@ cvHoughCircles( CvArr* src_image, void* circle_storage,
     else
         CV_Error( CV_StsBadArg, "Destination is not CvMemStorage* nor CvMat*" );
 
-    switch( method )
-    {
-    case CV_HOUGH_GRADIENT:
-        icvHoughCirclesGradient( img, (float)dp, (float)min_dist,
-                                min_radius, max_radius, canny_threshold,
-                                acc_threshold, circles, circles_max );
-          break;
-    default:
-        CV_Error( CV_StsBadArg, "Unrecognized method id" );
-    }
+    cv::HoughCircles_( cv::Mat(img), _circles, method, dp, min_dist, param1, param2,
+                       min_radius, max_radius, circles_max );
+    if( !_circles.empty() )
+        cvSeqPushMulti( circles, &_circles[0], (int)_circles.size() );
 
     if( mat )
     {
@@ -1084,7 +1256,6 @@ cvHoughCircles( CvArr* src_image, void* circle_storage,
     return result;
 }
 
-
 namespace cv
 {
 
@@ -1101,6 +1272,28 @@ static void seqToMat(const CvSeq* seq, OutputArray _arr)
     else
         _arr.release();
 }
+
+template<typename _Tp> static void vecToMat(const vector<_Tp>& vec, OutputArray _arr)
+{
+    if( !vec.empty() )
+    {
+        int type = DataType<_Tp>::type;
+        _arr.create(1, (int)vec.size(), type, -1, true);
+        Mat arr = _arr.getMat();
+        Mat(arr.size(), type, (void*)&vec[0]).copyTo(arr);
+    }
+    else
+        _arr.release();
+}
+
+static void checkHoughLinesArgs(const Mat& image, double rho, double theta, int threshold)
+{
+    if( image.type() != CV_8UC1 )
+        CV_Error( CV_StsBadArg, "The source image must be 8-bit, single-channel" );
+
+    if( rho <= 0 || theta <= 0 || threshold <= 0 )
+        CV_Error( CV_StsOutOfRange, "rho, theta and threshold must be positive" );
+}
     
 }
     
@@ -1108,11 +1301,19 @@ void cv::HoughLines( InputArray _image, OutputArray _lines,
                      double rho, double theta, int threshold,
                      double srn, double stn )
 {
-    Ptr<CvMemStorage> storage = cvCreateMemStorage(STORAGE_SIZE);
     Mat image = _image.getMat();
+    if( srn == 0 && stn == 0 )
+    {
+        checkHoughLinesArgs(image, rho, theta, threshold);
+        vector<Vec2f> lines;
+        HoughLinesStandard(image, (float)rho, (float)theta, threshold, lines, INT_MAX);
+        vecToMat(lines, _lines);
+        return;
+    }
+
+    Ptr<CvMemStorage> storage = cvCreateMemStorage(STORAGE_SIZE);
     CvMat c_image = image;
-    CvSeq* seq = cvHoughLines2( &c_image, storage, srn == 0 && stn == 0 ?
-                    CV_HOUGH_STANDARD : CV_HOUGH_MULTI_SCALE,
+    CvSeq* seq = cvHoughLines2( &c_image, storage, CV_HOUGH_MULTI_SCALE,
                     rho, theta, threshold, srn, stn );
     seqToMat(seq, _lines);
 }
@@ -1121,12 +1322,12 @@ void cv::HoughLinesP( InputArray _image, OutputArray _lines,
                       double rho, double theta, int threshold,
                       double minLineLength, double maxGap )
 {
-    Ptr<CvMemStorage> storage = cvCreateMemStorage(STORAGE_SIZE);
     Mat image = _image.getMat();
-    CvMat c_image = image;
-    CvSeq* seq = cvHoughLines2( &c_image, storage, CV_HOUGH_PROBABILISTIC,
-                    rho, theta, threshold, minLineLength, maxGap );
-    seqToMat(seq, _lines);
+    checkHoughLinesArgs(image, rho, theta, threshold);
+    vector<Vec4i> lines;
+    HoughLinesProbabilistic(image, (float)rho, (float)theta, threshold,
+                            cvRound(minLineLength), cvRound(maxGap), lines, INT_MAX);
+    vecToMat(lines, _lines);
 }
 
 void cv::HoughCircles( InputArray _image, OutputArray _circles,
@@ -1134,12 +1335,10 @@ void cv::HoughCircles( InputArray _image, OutputArray _circles,
                        double param1, double param2,
                        int minRadius, int maxRadius )
 {
-    Ptr<CvMemStorage> storage = cvCreateMemStorage(STORAGE_SIZE);
-    Mat image = _image.getMat();
-    CvMat c_image = image;
-    CvSeq* seq = cvHoughCircles( &c_image, storage, method,
-                    dp, min_dist, param1, param2, minRadius, maxRadius );
-    seqToMat(seq, _circles);
+    vector<Vec3f> circles;
+    HoughCircles_(_image.getMat(), circles, method, dp, min_dist, param1, param2,
+                  minRadius, maxRadius, INT_MAX);
+    vecToMat(circles, _circles);
 }
 
 /* End of file. */
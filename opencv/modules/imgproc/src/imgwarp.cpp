@@ -59,8 +59,6 @@ const int INTER_RESIZE_COEF_SCALE=1 << INTER_RESIZE_COEF_BITS;
 const int INTER_REMAP_COEF_BITS=15;
 const int INTER_REMAP_COEF_SCALE=1 << INTER_REMAP_COEF_BITS;
 
-static uchar NNDeltaTab_i[INTER_TAB_SIZE2][2];
-
 static float BilinearTab_f[INTER_TAB_SIZE2][2][2];
 static short BilinearTab_i[INTER_TAB_SIZE2][2][2];
 
@@ -166,8 +164,6 @@ static const void* initInterTab2D( int method, bool fixpt )
             for( j = 0; j < INTER_TAB_SIZE; j++, tab += ksize*ksize, itab += ksize*ksize )
             {
                 int isum = 0;
-                NNDeltaTab_i[i*INTER_TAB_SIZE+j][0] = j < INTER_TAB_SIZE/2;
-                NNDeltaTab_i[i*INTER_TAB_SIZE+j][1] = i < INTER_TAB_SIZE/2;
 
                 for( k1 = 0; k1 < ksize; k1++ )
                 {
@@ -240,6 +236,107 @@ template<typename ST, typename DT, int bits> struct FixedPtCast
 *                                         Resize                                         *
 \****************************************************************************************/
 
+// the minimal number of destination pixels processed by one parallel_for chunk
+enum { RESIZE_MIN_CHUNK_AREA = 1 << 15 };
+
+static inline BlockedRange resizeRange( const Mat& dst )
+{
+    return BlockedRange(0, dst.rows, std::max((int)RESIZE_MIN_CHUNK_AREA/std::max(dst.cols, 1), 1));
+}
+
+class ResizeNNInvoker
+{
+public:
+    ResizeNNInvoker(const Mat& _src, Mat& _dst, const int* _x_ofs, double _ify)
+        : src(&_src), dst(&_dst), x_ofs(_x_ofs), ify(_ify) {}
+
+    void operator()(const BlockedRange& range) const
+    {
+        const Mat& src = *this->src;
+        Mat& dst = *this->dst;
+        Size ssize = src.size(), dsize = dst.size();
+        int pix_size = (int)src.elemSize();
+        int pix_size4 = (int)(pix_size / sizeof(int));
+        int x, y;
+
+        for( y = range.begin(); y < range.end(); y++ )
+        {
+            uchar* D = dst.data + dst.step*y;
+            int sy = std::min(cvFloor(y*ify), ssize.height-1);
+            const uchar* S = src.data + src.step*sy;
+
+            switch( pix_size )
+            {
+            case 1:
+                for( x = 0; x <= dsize.width - 2; x += 2 )
+                {
+                    uchar t0 = S[x_ofs[x]];
+                    uchar t1 = S[x_ofs[x+1]];
+                    D[x] = t0;
+                    D[x+1] = t1;
+                }
+
+                for( ; x < dsize.width; x++ )
+                    D[x] = S[x_ofs[x]];
+                break;
+            case 2:
+                for( x = 0; x < dsize.width; x++ )
+                    *(ushort*)(D + x*2) = *(ushort*)(S + x_ofs[x]);
+                break;
+            case 3:
+                for( x = 0; x < dsize.width; x++, D += 3 )
+                {
+                    const uchar* _tS = S + x_ofs[x];
+                    D[0] = _tS[0]; D[1] = _tS[1]; D[2] = _tS[2];
+                }
+                break;
+            case 4:
+                for( x = 0; x < dsize.width; x++ )
+                    *(int*)(D + x*4) = *(int*)(S + x_ofs[x]);
+                break;
+            case 6:
+                for( x = 0; x < dsize.width; x++, D += 6 )
+                {
+                    const ushort* _tS = (const ushort*)(S + x_ofs[x]);
+                    ushort* _tD = (ushort*)D;
+                    _tD[0] = _tS[0]; _tD[1] = _tS[1]; _tD[2] = _tS[2];
+                }
+                break;
+            case 8:
+                for( x = 0; x < dsize.width; x++, D += 8 )
+                {
+                    const int* _tS = (const int*)(S + x_ofs[x]);
+                    int* _tD = (int*)D;
+                    _tD[0] = _tS[0]; _tD[1] = _tS[1];
+                }
+                break;
+            case 12:
+                for( x = 0; x < dsize.width; x++, D += 12 )
+                {
+                    const int* _tS = (const int*)(S + x_ofs[x]);
+                    int* _tD = (int*)D;
+                    _tD[0] = _tS[0]; _tD[1] = _tS[1]; _tD[2] = _tS[2];
+                }
+                break;
+            default:
+                for( x = 0; x < dsize.width; x++, D += pix_size )
+                {
+                    const int* _tS = (const int*)(S + x_ofs[x]);
+                    int* _tD = (int*)D;
+                    for( int k = 0; k < pix_size4; k++ )
+                        _tD[k] = _tS[k];
+                }
+            }
+        }
+    }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    const int* x_ofs;
+    double ify;
+};
+
 static void
 resizeNN( const Mat& src, Mat& dst, double fx, double fy )
 {
@@ -247,9 +344,8 @@ resizeNN( const Mat& src, Mat& dst, double fx, double fy )
     AutoBuffer<int> _x_ofs(dsize.width);
     int* x_ofs = _x_ofs;
     int pix_size = (int)src.elemSize();
-    int pix_size4 = (int)(pix_size / sizeof(int));
     double ifx = 1./fx, ify = 1./fy;
-    int x, y;
+    int x;
 
     for( x = 0; x < dsize.width; x++ )
     {
@@ -257,75 +353,7 @@ resizeNN( const Mat& src, Mat& dst, double fx, double fy )
         x_ofs[x] = std::min(sx, ssize.width-1)*pix_size;
     }
 
-    for( y = 0; y < dsize.height; y++ )
-    {
-        uchar* D = dst.data + dst.step*y;
-        int sy = std::min(cvFloor(y*ify), ssize.height-1);
-        const uchar* S = src.data + src.step*sy;
-
-        switch( pix_size )
-        {
-        case 1:
-            for( x = 0; x <= dsize.width - 2; x += 2 )
-            {
-                uchar t0 = S[x_ofs[x]];
-                uchar t1 = S[x_ofs[x+1]];
-                D[x] = t0;
-                D[x+1] = t1;
-            }
-
-            for( ; x < dsize.width; x++ )
-                D[x] = S[x_ofs[x]];
-            break;
-        case 2:
-            for( x = 0; x < dsize.width; x++ )
-                *(ushort*)(D + x*2) = *(ushort*)(S + x_ofs[x]);
-            break;
-        case 3:
-            for( x = 0; x < dsize.width; x++, D += 3 )
-            {
-                const uchar* _tS = S + x_ofs[x];
-                D[0] = _tS[0]; D[1] = _tS[1]; D[2] = _tS[2];
-            }
-            break;
-        case 4:
-            for( x = 0; x < dsize.width; x++ )
-                *(int*)(D + x*4) = *(int*)(S + x_ofs[x]);
-            break;
-        case 6:
-            for( x = 0; x < dsize.width; x++, D += 6 )
-            {
-                const ushort* _tS = (const ushort*)(S + x_ofs[x]);
-                ushort* _tD = (ushort*)D;
-                _tD[0] = _tS[0]; _tD[1] = _tS[1]; _tD[2] = _tS[2];
-            }
-            break;
-        case 8:
-            for( x = 0; x < dsize.width; x++, D += 8 )
-            {
-                const int* _tS = (const int*)(S + x_ofs[x]);
-                int* _tD = (int*)D;
-                _tD[0] = _tS[0]; _tD[1] = _tS[1];
-            }
-            break;
-        case 12:
-            for( x = 0; x < dsize.width; x++, D += 12 )
-            {
-                const int* _tS = (const int*)(S + x_ofs[x]);
-                int* _tD = (int*)D;
-                _tD[0] = _tS[0]; _tD[1] = _tS[1]; _tD[2] = _tS[2];
-            }
-            break;
-        default:
-            for( x = 0; x < dsize.width; x++, D += pix_size )
-            {
-                const int* _tS = (const int*)(S + x_ofs[x]);
-                int* _tD = (int*)D;
-                for( int k = 0; k < pix_size4; k++ )
-                    _tD[k] = _tS[k];
-            }
-        }
-    }
+    parallel_for(resizeRange(dst), ResizeNNInvoker(src, dst, x_ofs, ify));
 }
 
 
@@ -340,6 +368,12 @@ struct HResizeNoVec
         const uchar*, int, int, int, int, int) const { return 0; }
 };
 
+struct HResizeKernelNoVec
+{
+    int operator()(const uchar*, uchar*, const int*, const uchar*,
+        int dx, int, int) const { return dx; }
+};
+
 #if CV_SSE2
 
 struct VResizeLinearVec_32s8u
@@ -782,11 +816,256 @@ struct VResizeCubicVec_32f
     }
 };
 
-typedef HResizeNoVec HResizeLinearVec_8u32s;
-typedef HResizeNoVec HResizeLinearVec_16u32f;
-typedef HResizeNoVec HResizeLinearVec_16s32f;
-typedef HResizeNoVec HResizeLinearVec_32f;
-typedef HResizeNoVec HResizeLinearVec_64f;
+// The horizontal vector operations gather the source pixels for 4 destination pixels
+// at once (the positions are arbitrary, so it works for any number of channels) and
+// compute the weighted sums in the same order as the scalar code, so the result is the same.
+
+struct HResizeLinearVec_8u32s
+{
+    int operator()(const uchar** src, uchar** _dst, int count, const int* xofs,
+        const uchar* _alpha, int, int, int cn, int, int xmax ) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        const short* alpha = (const short*)_alpha;
+        int** dst = (int**)_dst;
+        int dx = 0;
+
+        for( ; dx <= xmax - 4; dx += 4 )
+        {
+            __m128i a = _mm_loadu_si128((const __m128i*)(alpha + dx*2));
+            int sx0 = xofs[dx], sx1 = xofs[dx+1], sx2 = xofs[dx+2], sx3 = xofs[dx+3];
+            for( int k = 0; k < count; k++ )
+            {
+                const uchar* S = src[k];
+                __m128i s = _mm_setr_epi32(S[sx0] | (S[sx0+cn] << 16), S[sx1] | (S[sx1+cn] << 16),
+                                           S[sx2] | (S[sx2+cn] << 16), S[sx3] | (S[sx3+cn] << 16));
+                _mm_storeu_si128((__m128i*)(dst[k] + dx), _mm_madd_epi16(s, a));
+            }
+        }
+
+        return dx;
+    }
+};
+
+template<typename T> struct HResizeLinearVec_X32f
+{
+    int operator()(const uchar** _src, uchar** _dst, int count, const int* xofs,
+        const uchar* _alpha, int, int, int cn, int, int xmax ) const
+    {
+        // for multi-channel images gathering the pixels one by one is not faster than scalar code
+        if( cn != 1 || !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        const T** src = (const T**)_src;
+        const float* alpha = (const float*)_alpha;
+        float** dst = (float**)_dst;
+        int dx = 0;
+
+        for( ; dx <= xmax - 4; dx += 4 )
+        {
+            __m128 a0 = _mm_loadu_ps(alpha + dx*2), a1 = _mm_loadu_ps(alpha + dx*2 + 4);
+            __m128 b0 = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(2, 0, 2, 0));
+            __m128 b1 = _mm_shuffle_ps(a0, a1, _MM_SHUFFLE(3, 1, 3, 1));
+            int sx0 = xofs[dx], sx1 = xofs[dx+1], sx2 = xofs[dx+2], sx3 = xofs[dx+3];
+            for( int k = 0; k < count; k++ )
+            {
+                __m128 s0, s1;
+                load2(src[k], sx0, sx1, sx2, sx3, s0, s1);
+                _mm_storeu_ps(dst[k] + dx, _mm_add_ps(_mm_mul_ps(s0, b0), _mm_mul_ps(s1, b1)));
+            }
+        }
+
+        return dx;
+    }
+
+    // loads the pixel pairs (S[sx], S[sx+1]) and splits them into the left and the right pixels
+    static inline void load2(const T* S, int sx0, int sx1, int sx2, int sx3, __m128& s0, __m128& s1)
+    {
+        __m128i p = _mm_setr_epi32(*(const int*)(S + sx0), *(const int*)(S + sx1),
+                                   *(const int*)(S + sx2), *(const int*)(S + sx3));
+        __m128i p0, p1;
+        if( std::numeric_limits<T>::is_signed )
+        {
+            p0 = _mm_srai_epi32(_mm_slli_epi32(p, 16), 16);
+            p1 = _mm_srai_epi32(p, 16);
+        }
+        else
+        {
+            p0 = _mm_and_si128(p, _mm_set1_epi32(0xffff));
+            p1 = _mm_srli_epi32(p, 16);
+        }
+        s0 = _mm_cvtepi32_ps(p0);
+        s1 = _mm_cvtepi32_ps(p1);
+    }
+};
+
+template<> inline void HResizeLinearVec_X32f<float>::load2(const float* S, int sx0, int sx1,
+                                                           int sx2, int sx3, __m128& s0, __m128& s1)
+{
+    __m128 p01 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(S + sx0)), (const __m64*)(S + sx1));
+    __m128 p23 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)(S + sx2)), (const __m64*)(S + sx3));
+    s0 = _mm_shuffle_ps(p01, p23, _MM_SHUFFLE(2, 0, 2, 0));
+    s1 = _mm_shuffle_ps(p01, p23, _MM_SHUFFLE(3, 1, 3, 1));
+}
+
+typedef HResizeLinearVec_X32f<ushort> HResizeLinearVec_16u32f;
+typedef HResizeLinearVec_X32f<short> HResizeLinearVec_16s32f;
+typedef HResizeLinearVec_X32f<float> HResizeLinearVec_32f;
+
+struct HResizeCubicVec_8u32s
+{
+    int operator()(const uchar* S, uchar* _D, const int* xofs, const uchar* _alpha,
+                   int dx, int xmax, int cn ) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return dx;
+
+        const short* alpha = (const short*)_alpha;
+        int* D = (int*)_D;
+
+        for( ; dx <= xmax - 4; dx += 4, alpha += 16 )
+        {
+            // (a0,a1) and (a2,a3) pairs of the 4 destination pixels
+            __m128i a0 = _mm_loadu_si128((const __m128i*)alpha);
+            __m128i a1 = _mm_loadu_si128((const __m128i*)(alpha + 8));
+            __m128i t0 = _mm_unpacklo_epi32(a0, a1), t1 = _mm_unpackhi_epi32(a0, a1);
+            __m128i w01 = _mm_unpacklo_epi32(t0, t1), w23 = _mm_unpackhi_epi32(t0, t1);
+            const uchar *S0 = S + xofs[dx], *S1 = S + xofs[dx+1];
+            const uchar *S2 = S + xofs[dx+2], *S3 = S + xofs[dx+3];
+
+            __m128i s01 = _mm_setr_epi32(S0[-cn] | (S0[0] << 16), S1[-cn] | (S1[0] << 16),
+                                         S2[-cn] | (S2[0] << 16), S3[-cn] | (S3[0] << 16));
+            __m128i s23 = _mm_setr_epi32(S0[cn] | (S0[cn*2] << 16), S1[cn] | (S1[cn*2] << 16),
+                                         S2[cn] | (S2[cn*2] << 16), S3[cn] | (S3[cn*2] << 16));
+            _mm_storeu_si128((__m128i*)(D + dx), _mm_add_epi32(_mm_madd_epi16(s01, w01),
+                                                               _mm_madd_epi16(s23, w23)));
+        }
+
+        return dx;
+    }
+};
+
+template<typename T> struct HResizeCubicVec_X32f
+{
+    int operator()(const uchar* _S, uchar* _D, const int* xofs, const uchar* _alpha,
+                   int dx, int xmax, int cn ) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE) )
+            return dx;
+
+        const T* S = (const T*)_S;
+        const float* alpha = (const float*)_alpha;
+        float* D = (float*)_D;
+
+        for( ; dx <= xmax - 4; dx += 4, alpha += 16 )
+        {
+            __m128 a0 = _mm_loadu_ps(alpha), a1 = _mm_loadu_ps(alpha + 4);
+            __m128 a2 = _mm_loadu_ps(alpha + 8), a3 = _mm_loadu_ps(alpha + 12);
+            _MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+            const T *S0 = S + xofs[dx], *S1 = S + xofs[dx+1];
+            const T *S2 = S + xofs[dx+2], *S3 = S + xofs[dx+3];
+
+            __m128 s = _mm_setr_ps((float)S0[-cn], (float)S1[-cn], (float)S2[-cn], (float)S3[-cn]);
+            __m128 v = _mm_mul_ps(s, a0);
+            s = _mm_setr_ps((float)S0[0], (float)S1[0], (float)S2[0], (float)S3[0]);
+            v = _mm_add_ps(v, _mm_mul_ps(s, a1));
+            s = _mm_setr_ps((float)S0[cn], (float)S1[cn], (float)S2[cn], (float)S3[cn]);
+            v = _mm_add_ps(v, _mm_mul_ps(s, a2));
+            s = _mm_setr_ps((float)S0[cn*2], (float)S1[cn*2], (float)S2[cn*2], (float)S3[cn*2]);
+            v = _mm_add_ps(v, _mm_mul_ps(s, a3));
+            _mm_storeu_ps(D + dx, v);
+        }
+
+        return dx;
+    }
+};
+
+typedef HResizeCubicVec_X32f<ushort> HResizeCubicVec_16u32f;
+typedef HResizeCubicVec_X32f<short> HResizeCubicVec_16s32f;
+typedef HResizeCubicVec_X32f<float> HResizeCubicVec_32f;
+
+struct HResizeLanczos4Vec_8u32s
+{
+    int operator()(const uchar* S, uchar* _D, const int* xofs, const uchar* _alpha,
+                   int dx, int xmax, int cn ) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return dx;
+
+        const short* alpha = (const short*)_alpha;
+        int* D = (int*)_D;
+
+        for( ; dx <= xmax - 4; dx += 4, alpha += 32 )
+        {
+            // transpose the 4x4 matrix of the coefficient pairs
+            __m128 w0 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)alpha));
+            __m128 w1 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(alpha + 8)));
+            __m128 w2 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(alpha + 16)));
+            __m128 w3 = _mm_castsi128_ps(_mm_loadu_si128((const __m128i*)(alpha + 24)));
+            _MM_TRANSPOSE4_PS(w0, w1, w2, w3);
+            const uchar *S0 = S + xofs[dx], *S1 = S + xofs[dx+1];
+            const uchar *S2 = S + xofs[dx+2], *S3 = S + xofs[dx+3];
+            __m128i v = _mm_setzero_si128();
+
+            for( int j = -3; j <= 3; j += 2 )
+            {
+                int j0 = j*cn, j1 = j0 + cn;
+                __m128i s = _mm_setr_epi32(S0[j0] | (S0[j1] << 16), S1[j0] | (S1[j1] << 16),
+                                           S2[j0] | (S2[j1] << 16), S3[j0] | (S3[j1] << 16));
+                __m128 w = j == -3 ? w0 : j == -1 ? w1 : j == 1 ? w2 : w3;
+                v = _mm_add_epi32(v, _mm_madd_epi16(s, _mm_castps_si128(w)));
+            }
+            _mm_storeu_si128((__m128i*)(D + dx), v);
+        }
+
+        return dx;
+    }
+};
+
+template<typename T> struct HResizeLanczos4Vec_X32f
+{
+    int operator()(const uchar* _S, uchar* _D, const int* xofs, const uchar* _alpha,
+                   int dx, int xmax, int cn ) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE) )
+            return dx;
+
+        const T* S = (const T*)_S;
+        const float* alpha = (const float*)_alpha;
+        float* D = (float*)_D;
+
+        for( ; dx <= xmax - 4; dx += 4, alpha += 32 )
+        {
+            __m128 a[8];
+            a[0] = _mm_loadu_ps(alpha); a[1] = _mm_loadu_ps(alpha + 8);
+            a[2] = _mm_loadu_ps(alpha + 16); a[3] = _mm_loadu_ps(alpha + 24);
+            a[4] = _mm_loadu_ps(alpha + 4); a[5] = _mm_loadu_ps(alpha + 12);
+            a[6] = _mm_loadu_ps(alpha + 20); a[7] = _mm_loadu_ps(alpha + 28);
+            _MM_TRANSPOSE4_PS(a[0], a[1], a[2], a[3]);
+            _MM_TRANSPOSE4_PS(a[4], a[5], a[6], a[7]);
+            const T *S0 = S + xofs[dx], *S1 = S + xofs[dx+1];
+            const T *S2 = S + xofs[dx+2], *S3 = S + xofs[dx+3];
+
+            __m128 v = _mm_mul_ps(_mm_setr_ps((float)S0[-cn*3], (float)S1[-cn*3],
+                                              (float)S2[-cn*3], (float)S3[-cn*3]), a[0]);
+            for( int j = 1; j < 8; j++ )
+            {
+                int sj = (j - 3)*cn;
+                __m128 s = _mm_setr_ps((float)S0[sj], (float)S1[sj], (float)S2[sj], (float)S3[sj]);
+                v = _mm_add_ps(v, _mm_mul_ps(s, a[j]));
+            }
+            _mm_storeu_ps(D + dx, v);
+        }
+
+        return dx;
+    }
+};
+
+typedef HResizeLanczos4Vec_X32f<ushort> HResizeLanczos4Vec_16u32f;
+typedef HResizeLanczos4Vec_X32f<short> HResizeLanczos4Vec_16s32f;
+typedef HResizeLanczos4Vec_X32f<float> HResizeLanczos4Vec_32f;
 
 #else
 
@@ -794,6 +1073,16 @@ typedef HResizeNoVec HResizeLinearVec_8u32s;
 typedef HResizeNoVec HResizeLinearVec_16u32f;
 typedef HResizeNoVec HResizeLinearVec_16s32f;
 typedef HResizeNoVec HResizeLinearVec_32f;
+
+typedef HResizeKernelNoVec HResizeCubicVec_8u32s;
+typedef HResizeKernelNoVec HResizeCubicVec_16u32f;
+typedef HResizeKernelNoVec HResizeCubicVec_16s32f;
+typedef HResizeKernelNoVec HResizeCubicVec_32f;
+
+typedef HResizeKernelNoVec HResizeLanczos4Vec_8u32s;
+typedef HResizeKernelNoVec HResizeLanczos4Vec_16u32f;
+typedef HResizeKernelNoVec HResizeLanczos4Vec_16s32f;
+typedef HResizeKernelNoVec HResizeLanczos4Vec_32f;
     
 typedef VResizeNoVec VResizeLinearVec_32s8u;
 typedef VResizeNoVec VResizeLinearVec_32f16u;
@@ -894,7 +1183,7 @@ struct VResizeLinear
 };
 
 
-template<typename T, typename WT, typename AT>
+template<typename T, typename WT, typename AT, class VecOp>
 struct HResizeCubic
 {
     typedef T value_type;
@@ -905,6 +1194,7 @@ struct HResizeCubic
                     const int* xofs, const AT* alpha,
                     int swidth, int dwidth, int cn, int xmin, int xmax ) const
     {
+        VecOp vecOp;
         for( int k = 0; k < count; k++ )
         {
             const T *S = src[k];
@@ -932,6 +1222,9 @@ struct HResizeCubic
                 }
                 if( limit == dwidth )
                     break;
+                int dx1 = vecOp((const uchar*)S, (uchar*)D, xofs, (const uchar*)alpha, dx, xmax, cn);
+                alpha += (dx1 - dx)*4;
+                dx = dx1;
                 for( ; dx < xmax; dx++, alpha += 4 )
                 {
                     int sx = xofs[dx];
@@ -967,7 +1260,7 @@ struct VResizeCubic
 };
 
 
-template<typename T, typename WT, typename AT>
+template<typename T, typename WT, typename AT, class VecOp>
 struct HResizeLanczos4
 {
     typedef T value_type;
@@ -978,6 +1271,7 @@ struct HResizeLanczos4
                     const int* xofs, const AT* alpha,
                     int swidth, int dwidth, int cn, int xmin, int xmax ) const
     {
+        VecOp vecOp;
         for( int k = 0; k < count; k++ )
         {
             const T *S = src[k];
@@ -1005,6 +1299,9 @@ struct HResizeLanczos4
                 }
                 if( limit == dwidth )
                     break;
+                int dx1 = vecOp((const uchar*)S, (uchar*)D, xofs, (const uchar*)alpha, dx, xmax, cn);
+                alpha += (dx1 - dx)*8;
+                dx = dx1;
                 for( ; dx < xmax; dx++, alpha += 8 )
                 {
                     int sx = xofs[dx];
@@ -1069,130 +1366,179 @@ static inline int clip(int x, int a, int b)
 static const int MAX_ESIZE=16;
 
 template<class HResize, class VResize>
-static void resizeGeneric_( const Mat& src, Mat& dst,
-                            const int* xofs, const void* _alpha,
-                            const int* yofs, const void* _beta,
-                            int xmin, int xmax, int ksize )
+class ResizeInvoker
 {
+public:
     typedef typename HResize::value_type T;
     typedef typename HResize::buf_type WT;
     typedef typename HResize::alpha_type AT;
 
-    const AT* alpha = (const AT*)_alpha;
-    const AT* beta = (const AT*)_beta;
-    Size ssize = src.size(), dsize = dst.size();
-    int cn = src.channels();
-    ssize.width *= cn;
-    dsize.width *= cn;
-    int bufstep = (int)alignSize(dsize.width, 16);
-    AutoBuffer<WT> _buffer(bufstep*ksize);
-    const T* srows[MAX_ESIZE]={0};
-    WT* rows[MAX_ESIZE]={0};
-    int prev_sy[MAX_ESIZE];
-    int k, dy;
-    xmin *= cn;
-    xmax *= cn;
-
-    HResize hresize;
-    VResize vresize;
-
-    for( k = 0; k < ksize; k++ )
-    {
-        prev_sy[k] = -1;
-        rows[k] = (WT*)_buffer + bufstep*k;
-    }
+    ResizeInvoker(const Mat& _src, Mat& _dst, const int* _xofs, const void* _alpha,
+                  const int* _yofs, const void* _beta, int _xmin, int _xmax, int _ksize)
+        : src(&_src), dst(&_dst), xofs(_xofs), alpha((const AT*)_alpha), yofs(_yofs),
+          beta0((const AT*)_beta), xmin(_xmin), xmax(_xmax), ksize(_ksize) {}
 
-    // image resize is a separable operation. In case of not too strong
-    for( dy = 0; dy < dsize.height; dy++, beta += ksize )
+    void operator()(const BlockedRange& range) const
     {
-        int sy0 = yofs[dy], k, k0=ksize, k1=0, ksize2 = ksize/2;
+        const Mat& src = *this->src;
+        Mat& dst = *this->dst;
+        const AT* beta = beta0 + range.begin()*ksize;
+        Size ssize = src.size(), dsize = dst.size();
+        int cn = src.channels();
+        ssize.width *= cn;
+        dsize.width *= cn;
+        int bufstep = (int)alignSize(dsize.width, 16);
+        AutoBuffer<WT> _buffer(bufstep*ksize);
+        const T* srows[MAX_ESIZE]={0};
+        WT* rows[MAX_ESIZE]={0};
+        int prev_sy[MAX_ESIZE];
+        int k, dy;
+        int xmin = this->xmin*cn;
+        int xmax = this->xmax*cn;
+
+        HResize hresize;
+        VResize vresize;
 
         for( k = 0; k < ksize; k++ )
         {
-            int sy = clip(sy0 - ksize2 + 1 + k, 0, ssize.height);
-            for( k1 = std::max(k1, k); k1 < ksize; k1++ )
+            prev_sy[k] = -1;
+            rows[k] = (WT*)_buffer + bufstep*k;
+        }
+
+        // image resize is a separable operation. In case of not too strong
+        for( dy = range.begin(); dy < range.end(); dy++, beta += ksize )
+        {
+            int sy0 = yofs[dy], k, k0=ksize, k1=0, ksize2 = ksize/2;
+
+            for( k = 0; k < ksize; k++ )
             {
-                if( sy == prev_sy[k1] ) // if the sy-th row has been computed already, reuse it.
+                int sy = clip(sy0 - ksize2 + 1 + k, 0, ssize.height);
+                for( k1 = std::max(k1, k); k1 < ksize; k1++ )
                 {
-                    if( k1 > k )
-                        memcpy( rows[k], rows[k1], bufstep*sizeof(rows[0][0]) );
-                    break;
+                    if( sy == prev_sy[k1] ) // if the sy-th row has been computed already, reuse it.
+                    {
+                        if( k1 > k )
+                            memcpy( rows[k], rows[k1], bufstep*sizeof(rows[0][0]) );
+                        break;
+                    }
                 }
+                if( k1 == ksize )
+                    k0 = std::min(k0, k); // remember the first row that needs to be computed
+                srows[k] = (const T*)(src.data + src.step*sy);
+                prev_sy[k] = sy;
             }
-            if( k1 == ksize )
-                k0 = std::min(k0, k); // remember the first row that needs to be computed
-            srows[k] = (const T*)(src.data + src.step*sy);
-            prev_sy[k] = sy;
-        }
 
-        if( k0 < ksize )
-            hresize( srows + k0, rows + k0, ksize - k0, xofs, alpha,
-                     ssize.width, dsize.width, cn, xmin, xmax );
-		vresize( (const WT**)rows, (T*)(dst.data + dst.step*dy), beta, dsize.width );
+            if( k0 < ksize )
+                hresize( srows + k0, rows + k0, ksize - k0, xofs, alpha,
+                         ssize.width, dsize.width, cn, xmin, xmax );
+            vresize( (const WT**)rows, (T*)(dst.data + dst.step*dy), beta, dsize.width );
+        }
     }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    const int* xofs;
+    const AT* alpha;
+    const int* yofs;
+    const AT* beta0;
+    int xmin, xmax, ksize;
+};
+
+// every destination row band is processed with its own ring of the horizontally resized rows
+template<class HResize, class VResize>
+static void resizeGeneric_( const Mat& src, Mat& dst,
+                            const int* xofs, const void* _alpha,
+                            const int* yofs, const void* _beta,
+                            int xmin, int xmax, int ksize )
+{
+    parallel_for(resizeRange(dst), ResizeInvoker<HResize, VResize>(src, dst, xofs, _alpha,
+                 yofs, _beta, xmin, xmax, ksize));
 }
 
 
 template<typename T, typename WT>
-static void resizeAreaFast_( const Mat& src, Mat& dst, const int* ofs, const int* xofs,
-                             int scale_x, int scale_y )
+class ResizeAreaFastInvoker
 {
-    Size ssize = src.size(), dsize = dst.size();
-    int cn = src.channels();
-    int dy, dx, k = 0;
-    int area = scale_x*scale_y;
-    float scale = 1.f/(scale_x*scale_y);
-    int dwidth1 = (ssize.width/scale_x)*cn; 
-    dsize.width *= cn;
-    ssize.width *= cn;
+public:
+    ResizeAreaFastInvoker(const Mat& _src, Mat& _dst, const int* _ofs, const int* _xofs,
+                          int _scale_x, int _scale_y)
+        : src(&_src), dst(&_dst), ofs(_ofs), xofs(_xofs), scale_x(_scale_x), scale_y(_scale_y) {}
 
-    for( dy = 0; dy < dsize.height; dy++ )
+    void operator()(const BlockedRange& range) const
     {
-        T* D = (T*)(dst.data + dst.step*dy);
-        int sy0 = dy*scale_y, w = sy0 + scale_y <= ssize.height ? dwidth1 : 0;
-        if( sy0 >= ssize.height )
+        const Mat& src = *this->src;
+        Mat& dst = *this->dst;
+        Size ssize = src.size(), dsize = dst.size();
+        int cn = src.channels();
+        int dy, dx, k = 0;
+        int area = scale_x*scale_y;
+        float scale = 1.f/(scale_x*scale_y);
+        int dwidth1 = (ssize.width/scale_x)*cn; 
+        dsize.width *= cn;
+        ssize.width *= cn;
+
+        for( dy = range.begin(); dy < range.end(); dy++ )
         {
-            for( dx = 0; dx < dsize.width; dx++ )
-                D[dx] = 0;
-            continue;
-        }
+            T* D = (T*)(dst.data + dst.step*dy);
+            int sy0 = dy*scale_y, w = sy0 + scale_y <= ssize.height ? dwidth1 : 0;
+            if( sy0 >= ssize.height )
+            {
+                for( dx = 0; dx < dsize.width; dx++ )
+                    D[dx] = 0;
+                continue;
+            }
         
-        for( dx = 0; dx < w; dx++ )
-        {
-            const T* S = (const T*)(src.data + src.step*sy0) + xofs[dx];
-            WT sum = 0;
-            for( k = 0; k <= area - 4; k += 4 )
-                sum += S[ofs[k]] + S[ofs[k+1]] + S[ofs[k+2]] + S[ofs[k+3]];
-            for( ; k < area; k++ )
-                sum += S[ofs[k]];
-
-            D[dx] = saturate_cast<T>(sum*scale);
-        }
+            for( dx = 0; dx < w; dx++ )
+            {
+                const T* S = (const T*)(src.data + src.step*sy0) + xofs[dx];
+                WT sum = 0;
+                for( k = 0; k <= area - 4; k += 4 )
+                    sum += S[ofs[k]] + S[ofs[k+1]] + S[ofs[k+2]] + S[ofs[k+3]];
+                for( ; k < area; k++ )
+                    sum += S[ofs[k]];
+
+                D[dx] = saturate_cast<T>(sum*scale);
+            }
         
-        for( ; dx < dsize.width; dx++ )
-        {
-            WT sum = 0;
-            int count = 0, sx0 = xofs[dx];
-            if( sx0 >= ssize.width )
-                D[dx] = 0;
-            
-            for( int sy = 0; sy < scale_y; sy++ )
+            for( ; dx < dsize.width; dx++ )
             {
-                if( sy0 + sy >= ssize.height )
-                    break;
-                const T* S = (const T*)(src.data + src.step*(sy0 + sy)) + sx0;
-                for( int sx = 0; sx < scale_x*cn; sx += cn )
+                WT sum = 0;
+                int count = 0, sx0 = xofs[dx];
+                if( sx0 >= ssize.width )
+                    D[dx] = 0;
+            
+                for( int sy = 0; sy < scale_y; sy++ )
                 {
-                    if( sx0 + sx >= ssize.width )
+                    if( sy0 + sy >= ssize.height )
                         break;
-                    sum += S[sx];
-                    count++;
+                    const T* S = (const T*)(src.data + src.step*(sy0 + sy)) + sx0;
+                    for( int sx = 0; sx < scale_x*cn; sx += cn )
+                    {
+                        if( sx0 + sx >= ssize.width )
+                            break;
+                        sum += S[sx];
+                        count++;
+                    }
                 }
-            }
             
-            D[dx] = saturate_cast<T>((float)sum/count);
+                D[dx] = saturate_cast<T>((float)sum/count);
+            }
         }
     }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    const int *ofs, *xofs;
+    int scale_x, scale_y;
+};
+
+template<typename T, typename WT>
+static void resizeAreaFast_( const Mat& src, Mat& dst, const int* ofs, const int* xofs,
+                             int scale_x, int scale_y )
+{
+    parallel_for(resizeRange(dst), ResizeAreaFastInvoker<T, WT>(src, dst, ofs, xofs, scale_x, scale_y));
 }
 
 struct DecimateAlpha
@@ -1202,107 +1548,143 @@ struct DecimateAlpha
 };
 
 template<typename T, typename WT>
-static void resizeArea_( const Mat& src, Mat& dst, const DecimateAlpha* xofs, int xofs_count )
+class ResizeAreaInvoker
 {
-    Size ssize = src.size(), dsize = dst.size();
-    int cn = src.channels();
-    dsize.width *= cn;
-    AutoBuffer<WT> _buffer(dsize.width*2);
-    WT *buf = _buffer, *sum = buf + dsize.width;
-    int k, sy, dx, cur_dy = 0;
-    WT scale_y = (WT)ssize.height/dsize.height;
-
-    CV_Assert( cn <= 4 );
-    for( dx = 0; dx < dsize.width; dx++ )
-        buf[dx] = sum[dx] = 0;
+public:
+    ResizeAreaInvoker(const Mat& _src, Mat& _dst, const DecimateAlpha* _xofs, int _xofs_count)
+        : src(&_src), dst(&_dst), xofs(_xofs), xofs_count(_xofs_count) {}
 
-    for( sy = 0; sy < ssize.height; sy++ )
+    void operator()(const BlockedRange& range) const
     {
-        const T* S = (const T*)(src.data + src.step*sy);
-        if( cn == 1 )
-            for( k = 0; k < xofs_count; k++ )
-            {
-                int dxn = xofs[k].di;
-                WT alpha = xofs[k].alpha;
-                buf[dxn] += S[xofs[k].si]*alpha;
-            }
-        else if( cn == 2 )
-            for( k = 0; k < xofs_count; k++ )
-            {
-                int sxn = xofs[k].si;
-                int dxn = xofs[k].di;
-                WT alpha = xofs[k].alpha;
-                WT t0 = buf[dxn] + S[sxn]*alpha;
-                WT t1 = buf[dxn+1] + S[sxn+1]*alpha;
-                buf[dxn] = t0; buf[dxn+1] = t1;
-            }
-        else if( cn == 3 )
-            for( k = 0; k < xofs_count; k++ )
-            {
-                int sxn = xofs[k].si;
-                int dxn = xofs[k].di;
-                WT alpha = xofs[k].alpha;
-                WT t0 = buf[dxn] + S[sxn]*alpha;
-                WT t1 = buf[dxn+1] + S[sxn+1]*alpha;
-                WT t2 = buf[dxn+2] + S[sxn+2]*alpha;
-                buf[dxn] = t0; buf[dxn+1] = t1; buf[dxn+2] = t2;
-            }
-        else
-            for( k = 0; k < xofs_count; k++ )
-            {
-                int sxn = xofs[k].si;
-                int dxn = xofs[k].di;
-                WT alpha = xofs[k].alpha;
-                WT t0 = buf[dxn] + S[sxn]*alpha;
-                WT t1 = buf[dxn+1] + S[sxn+1]*alpha;
-                buf[dxn] = t0; buf[dxn+1] = t1;
-                t0 = buf[dxn+2] + S[sxn+2]*alpha;
-                t1 = buf[dxn+3] + S[sxn+3]*alpha;
-                buf[dxn+2] = t0; buf[dxn+3] = t1;
-            }
+        const Mat& src = *this->src;
+        Mat& dst = *this->dst;
+        Size ssize = src.size(), dsize = dst.size();
+        int cn = src.channels();
+        dsize.width *= cn;
+        AutoBuffer<WT> _buffer(dsize.width*2);
+        WT *buf = _buffer, *sum = buf + dsize.width;
+        int k, sy, dx, dy0 = range.begin(), dy1 = range.end();
+        WT scale_y = (WT)ssize.height/dsize.height;
+
+        CV_Assert( cn <= 4 );
+        for( dx = 0; dx < dsize.width; dx++ )
+            buf[dx] = sum[dx] = 0;
+
+        // The source rows are accumulated until the current destination row is complete;
+        // the last of them is partially carried over to the next row. A band that starts
+        // in the middle of the image first re-processes the row that completes the previous
+        // destination row (without storing it) to restore the carried over part.
+        int cur_dy = 0, sy0 = 0;
+        if( dy0 > 0 )
+        {
+            cur_dy = dy0 - 1;
+            sy0 = std::max(cvFloor(dy0*scale_y) - 2, 0);
+            while( sy0 < ssize.height - 1 && !(dy0*scale_y <= sy0 + 1) )
+                sy0++;
+        }
 
-        if( (cur_dy + 1)*scale_y <= sy + 1 || sy == ssize.height - 1 )
+        for( sy = sy0; sy < ssize.height && cur_dy < dy1; sy++ )
         {
-            WT beta = std::max(sy + 1 - (cur_dy+1)*scale_y, (WT)0);
-            WT beta1 = 1 - beta;
-            T* D = (T*)(dst.data + dst.step*cur_dy);
-            if( fabs(beta) < 1e-3 )
-                for( dx = 0; dx < dsize.width; dx++ )
+            const T* S = (const T*)(src.data + src.step*sy);
+            if( cn == 1 )
+                for( k = 0; k < xofs_count; k++ )
+                {
+                    int dxn = xofs[k].di;
+                    WT alpha = xofs[k].alpha;
+                    buf[dxn] += S[xofs[k].si]*alpha;
+                }
+            else if( cn == 2 )
+                for( k = 0; k < xofs_count; k++ )
+                {
+                    int sxn = xofs[k].si;
+                    int dxn = xofs[k].di;
+                    WT alpha = xofs[k].alpha;
+                    WT t0 = buf[dxn] + S[sxn]*alpha;
+                    WT t1 = buf[dxn+1] + S[sxn+1]*alpha;
+                    buf[dxn] = t0; buf[dxn+1] = t1;
+                }
+            else if( cn == 3 )
+                for( k = 0; k < xofs_count; k++ )
                 {
-                    D[dx] = saturate_cast<T>(sum[dx] + buf[dx]);
-                    sum[dx] = buf[dx] = 0;
+                    int sxn = xofs[k].si;
+                    int dxn = xofs[k].di;
+                    WT alpha = xofs[k].alpha;
+                    WT t0 = buf[dxn] + S[sxn]*alpha;
+                    WT t1 = buf[dxn+1] + S[sxn+1]*alpha;
+                    WT t2 = buf[dxn+2] + S[sxn+2]*alpha;
+                    buf[dxn] = t0; buf[dxn+1] = t1; buf[dxn+2] = t2;
                 }
             else
-                for( dx = 0; dx < dsize.width; dx++ )
+                for( k = 0; k < xofs_count; k++ )
                 {
-                    D[dx] = saturate_cast<T>(sum[dx] + buf[dx]*beta1);
-                    sum[dx] = buf[dx]*beta;
-                    buf[dx] = 0;
+                    int sxn = xofs[k].si;
+                    int dxn = xofs[k].di;
+                    WT alpha = xofs[k].alpha;
+                    WT t0 = buf[dxn] + S[sxn]*alpha;
+                    WT t1 = buf[dxn+1] + S[sxn+1]*alpha;
+                    buf[dxn] = t0; buf[dxn+1] = t1;
+                    t0 = buf[dxn+2] + S[sxn+2]*alpha;
+                    t1 = buf[dxn+3] + S[sxn+3]*alpha;
+                    buf[dxn+2] = t0; buf[dxn+3] = t1;
                 }
-            cur_dy++;
-        }
-        else
-        {
-            for( dx = 0; dx <= dsize.width - 2; dx += 2 )
+
+            if( (cur_dy + 1)*scale_y <= sy + 1 || sy == ssize.height - 1 )
             {
-                WT t0 = sum[dx] + buf[dx];
-                WT t1 = sum[dx+1] + buf[dx+1];
-                sum[dx] = t0; sum[dx+1] = t1;
-                buf[dx] = buf[dx+1] = 0;
+                WT beta = std::max(sy + 1 - (cur_dy+1)*scale_y, (WT)0);
+                WT beta1 = 1 - beta;
+                T* D = cur_dy >= dy0 ? (T*)(dst.data + dst.step*cur_dy) : 0;
+                if( fabs(beta) < 1e-3 )
+                    for( dx = 0; dx < dsize.width; dx++ )
+                    {
+                        if( D )
+                            D[dx] = saturate_cast<T>(sum[dx] + buf[dx]);
+                        sum[dx] = buf[dx] = 0;
+                    }
+                else
+                    for( dx = 0; dx < dsize.width; dx++ )
+                    {
+                        if( D )
+                            D[dx] = saturate_cast<T>(sum[dx] + buf[dx]*beta1);
+                        sum[dx] = buf[dx]*beta;
+                        buf[dx] = 0;
+                    }
+                cur_dy++;
             }
-            for( ; dx < dsize.width; dx++ )
+            else
             {
-                sum[dx] += buf[dx];
-                buf[dx] = 0;
+                for( dx = 0; dx <= dsize.width - 2; dx += 2 )
+                {
+                    WT t0 = sum[dx] + buf[dx];
+                    WT t1 = sum[dx+1] + buf[dx+1];
+                    sum[dx] = t0; sum[dx+1] = t1;
+                    buf[dx] = buf[dx+1] = 0;
+                }
+                for( ; dx < dsize.width; dx++ )
+                {
+                    sum[dx] += buf[dx];
+                    buf[dx] = 0;
+                }
             }
         }
     }
-}
 
+protected:
+    const Mat* src;
+    Mat* dst;
+    const DecimateAlpha* xofs;
+    int xofs_count;
+};
 
-typedef void (*ResizeFunc)( const Mat& src, Mat& dst,
-                            const int* xofs, const void* alpha,
-                            const int* yofs, const void* beta,
+template<typename T, typename WT>
+static void resizeArea_( const Mat& src, Mat& dst, const DecimateAlpha* xofs, int xofs_count )
+{
+    parallel_for(resizeRange(dst), ResizeAreaInvoker<T, WT>(src, dst, xofs, xofs_count));
+}
+
+
+typedef void (*ResizeFunc)( const Mat& src, Mat& dst,
+                            const int* xofs, const void* alpha,
+                            const int* yofs, const void* beta,
                             int xmin, int xmax, int ksize );
 
 typedef void (*ResizeAreaFastFunc)( const Mat& src, Mat& dst,
@@ -1356,26 +1738,26 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
     static ResizeFunc cubic_tab[] =
     {
         resizeGeneric_<
-            HResizeCubic<uchar, int, short>,
+            HResizeCubic<uchar, int, short, HResizeCubicVec_8u32s>,
             VResizeCubic<uchar, int, short,
                 FixedPtCast<int, uchar, INTER_RESIZE_COEF_BITS*2>,
                 VResizeCubicVec_32s8u> >,
         0,
         resizeGeneric_<
-            HResizeCubic<ushort, float, float>,
+            HResizeCubic<ushort, float, float, HResizeCubicVec_16u32f>,
             VResizeCubic<ushort, float, float, Cast<float, ushort>,
             VResizeCubicVec_32f16u> >,
         resizeGeneric_<
-            HResizeCubic<short, float, float>,
+            HResizeCubic<short, float, float, HResizeCubicVec_16s32f>,
             VResizeCubic<short, float, float, Cast<float, short>,
             VResizeCubicVec_32f16s> >,
 		0,
         resizeGeneric_<
-            HResizeCubic<float, float, float>,
+            HResizeCubic<float, float, float, HResizeCubicVec_32f>,
             VResizeCubic<float, float, float, Cast<float, float>,
             VResizeCubicVec_32f> >,
         resizeGeneric_<
-            HResizeCubic<double, double, float>,
+            HResizeCubic<double, double, float, HResizeKernelNoVec>,
             VResizeCubic<double, double, float, Cast<double, double>,
             VResizeNoVec> >,
         0
@@ -1383,22 +1765,22 @@ void cv::resize( InputArray _src, OutputArray _dst, Size dsize,
 
     static ResizeFunc lanczos4_tab[] =
     {
-        resizeGeneric_<HResizeLanczos4<uchar, int, short>,
+        resizeGeneric_<HResizeLanczos4<uchar, int, short, HResizeLanczos4Vec_8u32s>,
             VResizeLanczos4<uchar, int, short,
             FixedPtCast<int, uchar, INTER_RESIZE_COEF_BITS*2>,
             VResizeNoVec> >,
         0,
-        resizeGeneric_<HResizeLanczos4<ushort, float, float>,
+        resizeGeneric_<HResizeLanczos4<ushort, float, float, HResizeLanczos4Vec_16u32f>,
             VResizeLanczos4<ushort, float, float, Cast<float, ushort>,
             VResizeNoVec> >,
-       	resizeGeneric_<HResizeLanczos4<short, float, float>,
+       	resizeGeneric_<HResizeLanczos4<short, float, float, HResizeLanczos4Vec_16s32f>,
             VResizeLanczos4<short, float, float, Cast<float, short>,
             VResizeNoVec> >,
 		0,
-        resizeGeneric_<HResizeLanczos4<float, float, float>,
+        resizeGeneric_<HResizeLanczos4<float, float, float, HResizeLanczos4Vec_32f>,
             VResizeLanczos4<float, float, float, Cast<float, float>,
             VResizeNoVec> >,
-        resizeGeneric_<HResizeLanczos4<double, double, float>,
+        resizeGeneric_<HResizeLanczos4<double, double, float, HResizeKernelNoVec>,
             VResizeLanczos4<double, double, float, Cast<double, double>,
             VResizeNoVec> >,
         0
@@ -1974,9 +2356,194 @@ struct RemapVec_8u
     }
 };
 
+
+// single-channel bilinear interpolation of 4 pixels at once; the products are summed
+// in the same order as in remapBilinear, so the results match the scalar code exactly
+struct RemapVec_32f
+{
+    int operator()( const Mat& _src, void* _dst, const short* XY,
+                    const ushort* FXY, const void* _wtab, int width ) const
+    {
+        if( _src.channels() != 1 || !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        const float* S0 = (const float*)_src.data;
+        const float* wtab = (const float*)_wtab;
+        float* D = (float*)_dst;
+        size_t sstep = _src.step/sizeof(S0[0]);
+        int x = 0;
+
+        for( ; x <= width - 4; x += 4 )
+        {
+            __m128 v0, v1, v2, v3;
+            const float* S;
+            S = S0 + XY[x*2+1]*sstep + XY[x*2];
+            v0 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)S), (const __m64*)(S + sstep));
+            S = S0 + XY[x*2+3]*sstep + XY[x*2+2];
+            v1 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)S), (const __m64*)(S + sstep));
+            S = S0 + XY[x*2+5]*sstep + XY[x*2+4];
+            v2 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)S), (const __m64*)(S + sstep));
+            S = S0 + XY[x*2+7]*sstep + XY[x*2+6];
+            v3 = _mm_loadh_pi(_mm_loadl_pi(_mm_setzero_ps(), (const __m64*)S), (const __m64*)(S + sstep));
+
+            v0 = _mm_mul_ps(v0, _mm_loadu_ps(wtab + FXY[x]*4));
+            v1 = _mm_mul_ps(v1, _mm_loadu_ps(wtab + FXY[x+1]*4));
+            v2 = _mm_mul_ps(v2, _mm_loadu_ps(wtab + FXY[x+2]*4));
+            v3 = _mm_mul_ps(v3, _mm_loadu_ps(wtab + FXY[x+3]*4));
+            _MM_TRANSPOSE4_PS(v0, v1, v2, v3);
+            _mm_storeu_ps(D + x, _mm_add_ps(_mm_add_ps(_mm_add_ps(v0, v1), v2), v3));
+        }
+
+        return x;
+    }
+};
+
+
+struct RemapVec_16u
+{
+    int operator()( const Mat& _src, void* _dst, const short* XY,
+                    const ushort* FXY, const void* _wtab, int width ) const
+    {
+        if( _src.channels() != 1 || !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        const ushort* S0 = (const ushort*)_src.data;
+        const float* wtab = (const float*)_wtab;
+        ushort* D = (ushort*)_dst;
+        size_t sstep = _src.step/sizeof(S0[0]);
+        __m128i z = _mm_setzero_si128(), delta = _mm_set1_epi32(32768);
+        int x = 0;
+
+        for( ; x <= width - 4; x += 4 )
+        {
+            __m128 v[4];
+            for( int j = 0; j < 4; j++ )
+            {
+                const ushort* S = S0 + XY[(x+j)*2+1]*sstep + XY[(x+j)*2];
+                __m128i t = _mm_unpacklo_epi32(_mm_cvtsi32_si128(*(const int*)S),
+                                               _mm_cvtsi32_si128(*(const int*)(S + sstep)));
+                v[j] = _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(t, z)),
+                                  _mm_loadu_ps(wtab + FXY[x+j]*4));
+            }
+            _MM_TRANSPOSE4_PS(v[0], v[1], v[2], v[3]);
+            __m128i r = _mm_cvtps_epi32(_mm_add_ps(_mm_add_ps(_mm_add_ps(v[0], v[1]), v[2]), v[3]));
+            // there is no unsigned 32->16 packing in SSE2, so shift the range to the signed one
+            r = _mm_packs_epi32(_mm_sub_epi32(r, delta), z);
+            _mm_storel_epi64((__m128i*)(D + x), _mm_add_epi16(r, _mm_set1_epi16((short)-32768)));
+        }
+
+        return x;
+    }
+};
+
+
+// dot products of the 4x4 (bicubic) and 8x8 (Lanczos4) neighbourhoods of a single-channel pixel
+// with the interpolation weights. The generic versions return false and the scalar code is used.
+template<typename T, typename AT, typename WT> static inline bool
+remapBicubicSIMD( const T*, size_t, const AT*, WT& ) { return false; }
+
+template<typename T, typename AT, typename WT> static inline bool
+remapLanczos4SIMD( const T*, size_t, const AT*, WT& ) { return false; }
+
+static inline bool remapBicubicSIMD( const uchar* S, size_t sstep, const short* w, int& sum )
+{
+    __m128i z = _mm_setzero_si128();
+    __m128i s01 = _mm_unpacklo_epi32(_mm_cvtsi32_si128(*(const int*)S),
+                                     _mm_cvtsi32_si128(*(const int*)(S + sstep)));
+    __m128i s23 = _mm_unpacklo_epi32(_mm_cvtsi32_si128(*(const int*)(S + sstep*2)),
+                                     _mm_cvtsi32_si128(*(const int*)(S + sstep*3)));
+    __m128i r = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi8(s01, z), _mm_loadu_si128((const __m128i*)w)),
+                              _mm_madd_epi16(_mm_unpacklo_epi8(s23, z), _mm_loadu_si128((const __m128i*)(w + 8))));
+    r = _mm_add_epi32(r, _mm_srli_si128(r, 8));
+    r = _mm_add_epi32(r, _mm_srli_si128(r, 4));
+    sum = _mm_cvtsi128_si32(r);
+    return true;
+}
+
+static inline float hsum_ps( __m128 s )
+{
+    s = _mm_add_ps(s, _mm_movehl_ps(s, s));
+    s = _mm_add_ss(s, _mm_shuffle_ps(s, s, 1));
+    return _mm_cvtss_f32(s);
+}
+
+static inline __m128 load4_16u( const ushort* S, __m128i z )
+{
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_loadl_epi64((const __m128i*)S), z));
+}
+
+static inline bool remapBicubicSIMD( const ushort* S, size_t sstep, const float* w, float& sum )
+{
+    __m128i z = _mm_setzero_si128();
+    __m128 s = _mm_mul_ps(load4_16u(S, z), _mm_loadu_ps(w));
+    s = _mm_add_ps(s, _mm_mul_ps(load4_16u(S + sstep, z), _mm_loadu_ps(w + 4)));
+    s = _mm_add_ps(s, _mm_mul_ps(load4_16u(S + sstep*2, z), _mm_loadu_ps(w + 8)));
+    s = _mm_add_ps(s, _mm_mul_ps(load4_16u(S + sstep*3, z), _mm_loadu_ps(w + 12)));
+    sum = hsum_ps(s);
+    return true;
+}
+
+static inline bool remapBicubicSIMD( const float* S, size_t sstep, const float* w, float& sum )
+{
+    __m128 s = _mm_mul_ps(_mm_loadu_ps(S), _mm_loadu_ps(w));
+    s = _mm_add_ps(s, _mm_mul_ps(_mm_loadu_ps(S + sstep), _mm_loadu_ps(w + 4)));
+    s = _mm_add_ps(s, _mm_mul_ps(_mm_loadu_ps(S + sstep*2), _mm_loadu_ps(w + 8)));
+    s = _mm_add_ps(s, _mm_mul_ps(_mm_loadu_ps(S + sstep*3), _mm_loadu_ps(w + 12)));
+    sum = hsum_ps(s);
+    return true;
+}
+
+static inline bool remapLanczos4SIMD( const uchar* S, size_t sstep, const short* w, int& sum )
+{
+    __m128i z = _mm_setzero_si128(), r = z;
+    for( int i = 0; i < 8; i++, S += sstep, w += 8 )
+    {
+        __m128i t = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)S), z);
+        r = _mm_add_epi32(r, _mm_madd_epi16(t, _mm_loadu_si128((const __m128i*)w)));
+    }
+    r = _mm_add_epi32(r, _mm_srli_si128(r, 8));
+    r = _mm_add_epi32(r, _mm_srli_si128(r, 4));
+    sum = _mm_cvtsi128_si32(r);
+    return true;
+}
+
+static inline bool remapLanczos4SIMD( const ushort* S, size_t sstep, const float* w, float& sum )
+{
+    __m128i z = _mm_setzero_si128();
+    __m128 s = _mm_setzero_ps();
+    for( int i = 0; i < 8; i++, S += sstep, w += 8 )
+    {
+        __m128i t = _mm_loadu_si128((const __m128i*)S);
+        s = _mm_add_ps(s, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(t, z)), _mm_loadu_ps(w)));
+        s = _mm_add_ps(s, _mm_mul_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(t, z)), _mm_loadu_ps(w + 4)));
+    }
+    sum = hsum_ps(s);
+    return true;
+}
+
+static inline bool remapLanczos4SIMD( const float* S, size_t sstep, const float* w, float& sum )
+{
+    __m128 s = _mm_setzero_ps();
+    for( int i = 0; i < 8; i++, S += sstep, w += 8 )
+    {
+        s = _mm_add_ps(s, _mm_mul_ps(_mm_loadu_ps(S), _mm_loadu_ps(w)));
+        s = _mm_add_ps(s, _mm_mul_ps(_mm_loadu_ps(S + 4), _mm_loadu_ps(w + 4)));
+    }
+    sum = hsum_ps(s);
+    return true;
+}
+
 #else
 
 typedef RemapNoVec RemapVec_8u;
+typedef RemapNoVec RemapVec_16u;
+typedef RemapNoVec RemapVec_32f;
+
+template<typename T, typename AT, typename WT> static inline bool
+remapBicubicSIMD( const T*, size_t, const AT*, WT& ) { return false; }
+
+template<typename T, typename AT, typename WT> static inline bool
+remapLanczos4SIMD( const T*, size_t, const AT*, WT& ) { return false; }
 
 #endif
 
@@ -2202,6 +2769,11 @@ static void remapBicubic( const Mat& _src, Mat& _dst, const Mat& _xy,
     int borderType1 = borderType != BORDER_TRANSPARENT ? borderType : BORDER_REFLECT_101;
 
     unsigned width1 = std::max(ssize.width-3, 0), height1 = std::max(ssize.height-3, 0);
+#if CV_SSE2
+    bool useSIMD = cn == 1 && checkHardwareSupport(CV_CPU_SSE2);
+#else
+    bool useSIMD = false;
+#endif
 
     if( _dst.isContinuous() && _xy.isContinuous() && _fxy.isContinuous() )
     {
@@ -2223,6 +2795,12 @@ static void remapBicubic( const Mat& _src, Mat& _dst, const Mat& _xy,
             if( (unsigned)sx < width1 && (unsigned)sy < height1 )
             {
                 const T* S = S0 + sy*sstep + sx*cn;
+                WT vsum;
+                if( useSIMD && remapBicubicSIMD(S, sstep, w, vsum) )
+                {
+                    D[0] = castOp(vsum);
+                    continue;
+                }
                 for( k = 0; k < cn; k++ )
                 {
                     WT sum = S[0]*w[0] + S[cn]*w[1] + S[cn*2]*w[2] + S[cn*3]*w[3];
@@ -2307,6 +2885,11 @@ static void remapLanczos4( const Mat& _src, Mat& _dst, const Mat& _xy,
     int borderType1 = borderType != BORDER_TRANSPARENT ? borderType : BORDER_REFLECT_101;
     
     unsigned width1 = std::max(ssize.width-7, 0), height1 = std::max(ssize.height-7, 0);
+#if CV_SSE2
+    bool useSIMD = cn == 1 && checkHardwareSupport(CV_CPU_SSE2);
+#else
+    bool useSIMD = false;
+#endif
 
     if( _dst.isContinuous() && _xy.isContinuous() && _fxy.isContinuous() )
     {
@@ -2328,6 +2911,12 @@ static void remapLanczos4( const Mat& _src, Mat& _dst, const Mat& _xy,
             int i, k;
             if( (unsigned)sx < width1 && (unsigned)sy < height1 )
             {
+                WT vsum;
+                if( useSIMD && remapLanczos4SIMD(S, sstep, w, vsum) )
+                {
+                    D[0] = castOp(vsum);
+                    continue;
+                }
                 for( k = 0; k < cn; k++ )
                 {
                     WT sum = 0;
@@ -2404,6 +2993,221 @@ typedef void (*RemapFunc)(const Mat& _src, Mat& _dst, const Mat& _xy,
                           const Mat& _fxy, const void* _wtab,
                           int borderType, const Scalar& _borderValue);
 
+// the minimal number of destination pixels processed by one parallel_for chunk
+enum { REMAP_MIN_CHUNK_AREA = 1 << 15 };
+
+// Processes a horizontal stripe of the destination image: converts the maps into
+// the fixed-point format block by block (with its own buffers) and interpolates.
+class RemapInvoker
+{
+public:
+    RemapInvoker(const Mat& _src, Mat& _dst, const Mat* _m1, const Mat* _m2,
+                 RemapNNFunc _nnfunc, RemapFunc _ifunc, const void* _ctab,
+                 bool _planar_input, int _borderType, const Scalar& _borderValue)
+        : src(&_src), dst(&_dst), m1(_m1), m2(_m2), nnfunc(_nnfunc), ifunc(_ifunc),
+          ctab(_ctab), planar_input(_planar_input), borderType(_borderType),
+          borderValue(_borderValue) {}
+
+    void operator()(const BlockedRange& range) const
+    {
+        Mat dst = this->dst->rowRange(range.begin(), range.end());
+        const Mat& src = *this->src;
+        const Mat &map1 = *m1, &map2 = *m2;
+        int map_depth = map1.depth();
+
+        // the maps are already in the fixed-point format, so the stripe is processed at once
+        if( map1.type() == CV_16SC2 && (nnfunc ? !map2.data : ifunc != 0) )
+        {
+            Mat xy = map1.rowRange(range.begin(), range.end()), a;
+            if( map2.data )
+                a = map2.rowRange(range.begin(), range.end());
+            if( nnfunc )
+                nnfunc( src, dst, xy, borderType, borderValue );
+            else
+                ifunc( src, dst, xy, a, ctab, borderType, borderValue );
+            return;
+        }
+
+        int x, y, x1, y1;
+        const int buf_size = 1 << 14;
+        int brows0 = std::min(128, dst.rows);
+        int bcols0 = std::min(buf_size/brows0, dst.cols);
+        brows0 = std::min(buf_size/bcols0, dst.rows);
+        int y0 = range.begin();
+#if CV_SSE2
+        bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+
+        Mat _bufxy(brows0, bcols0, CV_16SC2), _bufa;
+        if( !nnfunc )
+            _bufa.create(brows0, bcols0, CV_16UC1);
+
+        for( y = 0; y < dst.rows; y += brows0 )
+        {
+            for( x = 0; x < dst.cols; x += bcols0 )
+            {
+                int brows = std::min(brows0, dst.rows - y);
+                int bcols = std::min(bcols0, dst.cols - x);
+                Mat dpart(dst, Rect(x, y, bcols, brows));
+                Mat bufxy(_bufxy, Rect(0, 0, bcols, brows));
+
+                if( nnfunc )
+                {
+                    if( map_depth != CV_32F )
+                    {
+                        for( y1 = 0; y1 < brows; y1++ )
+                        {
+                            short* XY = (short*)(bufxy.data + bufxy.step*y1);
+                            const short* sXY = (const short*)(m1->data + m1->step*(y0+y+y1)) + x*2;
+                            const ushort* sA = (const ushort*)(m2->data + m2->step*(y0+y+y1)) + x;
+
+                            for( x1 = 0; x1 < bcols; x1++ )
+                            {
+                                // round to the nearest pixel using the fractional part
+                                int a = sA[x1] & (INTER_TAB_SIZE2-1);
+                                XY[x1*2] = (short)(sXY[x1*2] + ((a & (INTER_TAB_SIZE-1)) >= INTER_TAB_SIZE/2));
+                                XY[x1*2+1] = (short)(sXY[x1*2+1] + ((a >> INTER_BITS) >= INTER_TAB_SIZE/2));
+                            }
+                        }
+                    }
+                    else if( !planar_input )
+                        map1(Rect(x,y0+y,bcols,brows)).convertTo(bufxy, bufxy.depth());
+                    else
+                    {
+                        for( y1 = 0; y1 < brows; y1++ )
+                        {
+                            short* XY = (short*)(bufxy.data + bufxy.step*y1);
+                            const float* sX = (const float*)(map1.data + map1.step*(y0+y+y1)) + x;
+                            const float* sY = (const float*)(map2.data + map2.step*(y0+y+y1)) + x;
+                            x1 = 0;
+
+                        #if CV_SSE2
+                            if( useSIMD )
+                            {
+                                for( ; x1 <= bcols - 8; x1 += 8 )
+                                {
+                                    __m128 fx0 = _mm_loadu_ps(sX + x1);
+                                    __m128 fx1 = _mm_loadu_ps(sX + x1 + 4);
+                                    __m128 fy0 = _mm_loadu_ps(sY + x1);
+                                    __m128 fy1 = _mm_loadu_ps(sY + x1 + 4);
+                                    __m128i ix0 = _mm_cvtps_epi32(fx0);
+                                    __m128i ix1 = _mm_cvtps_epi32(fx1);
+                                    __m128i iy0 = _mm_cvtps_epi32(fy0);
+                                    __m128i iy1 = _mm_cvtps_epi32(fy1);
+                                    ix0 = _mm_packs_epi32(ix0, ix1);
+                                    iy0 = _mm_packs_epi32(iy0, iy1);
+                                    ix1 = _mm_unpacklo_epi16(ix0, iy0);
+                                    iy1 = _mm_unpackhi_epi16(ix0, iy0);
+                                    _mm_storeu_si128((__m128i*)(XY + x1*2), ix1);
+                                    _mm_storeu_si128((__m128i*)(XY + x1*2 + 8), iy1);
+                                }
+                            }
+                        #endif
+
+                            for( ; x1 < bcols; x1++ )
+                            {
+                                XY[x1*2] = saturate_cast<short>(sX[x1]);
+                                XY[x1*2+1] = saturate_cast<short>(sY[x1]);
+                            }
+                        }
+                    }
+                    nnfunc( src, dpart, bufxy, borderType, borderValue );
+                    continue;
+                }
+
+                Mat bufa(_bufa, Rect(0,0,bcols, brows));
+                for( y1 = 0; y1 < brows; y1++ )
+                {
+                    short* XY = (short*)(bufxy.data + bufxy.step*y1);
+                    ushort* A = (ushort*)(bufa.data + bufa.step*y1);
+
+                    if( planar_input )
+                    {
+                        const float* sX = (const float*)(map1.data + map1.step*(y0+y+y1)) + x;
+                        const float* sY = (const float*)(map2.data + map2.step*(y0+y+y1)) + x;
+
+                        x1 = 0;
+                    #if CV_SSE2
+                        if( useSIMD )
+                        {
+                            __m128 scale = _mm_set1_ps((float)INTER_TAB_SIZE);
+                            __m128i mask = _mm_set1_epi32(INTER_TAB_SIZE-1);
+                            for( ; x1 <= bcols - 8; x1 += 8 )
+                            {
+                                __m128 fx0 = _mm_loadu_ps(sX + x1);
+                                __m128 fx1 = _mm_loadu_ps(sX + x1 + 4);
+                                __m128 fy0 = _mm_loadu_ps(sY + x1);
+                                __m128 fy1 = _mm_loadu_ps(sY + x1 + 4);
+                                __m128i ix0 = _mm_cvtps_epi32(_mm_mul_ps(fx0, scale));
+                                __m128i ix1 = _mm_cvtps_epi32(_mm_mul_ps(fx1, scale));
+                                __m128i iy0 = _mm_cvtps_epi32(_mm_mul_ps(fy0, scale));
+                                __m128i iy1 = _mm_cvtps_epi32(_mm_mul_ps(fy1, scale));
+                                __m128i mx0 = _mm_and_si128(ix0, mask);
+                                __m128i mx1 = _mm_and_si128(ix1, mask);
+                                __m128i my0 = _mm_and_si128(iy0, mask);
+                                __m128i my1 = _mm_and_si128(iy1, mask);
+                                mx0 = _mm_packs_epi32(mx0, mx1);
+                                my0 = _mm_packs_epi32(my0, my1);
+                                my0 = _mm_slli_epi16(my0, INTER_BITS);
+                                mx0 = _mm_or_si128(mx0, my0);
+                                _mm_storeu_si128((__m128i*)(A + x1), mx0);
+                                ix0 = _mm_srai_epi32(ix0, INTER_BITS);
+                                ix1 = _mm_srai_epi32(ix1, INTER_BITS);
+                                iy0 = _mm_srai_epi32(iy0, INTER_BITS);
+                                iy1 = _mm_srai_epi32(iy1, INTER_BITS);
+                                ix0 = _mm_packs_epi32(ix0, ix1);
+                                iy0 = _mm_packs_epi32(iy0, iy1);
+                                ix1 = _mm_unpacklo_epi16(ix0, iy0);
+                                iy1 = _mm_unpackhi_epi16(ix0, iy0);
+                                _mm_storeu_si128((__m128i*)(XY + x1*2), ix1);
+                                _mm_storeu_si128((__m128i*)(XY + x1*2 + 8), iy1);
+                            }
+                        }
+                    #endif
+
+                        for( ; x1 < bcols; x1++ )
+                        {
+                            int sx = cvRound(sX[x1]*INTER_TAB_SIZE);
+                            int sy = cvRound(sY[x1]*INTER_TAB_SIZE);
+                            int v = (sy & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (sx & (INTER_TAB_SIZE-1));
+                            XY[x1*2] = (short)(sx >> INTER_BITS);
+                            XY[x1*2+1] = (short)(sy >> INTER_BITS);
+                            A[x1] = (ushort)v;
+                        }
+                    }
+                    else
+                    {
+                        const float* sXY = (const float*)(map1.data + map1.step*(y0+y+y1)) + x*2;
+
+                        for( x1 = 0; x1 < bcols; x1++ )
+                        {
+                            int sx = cvRound(sXY[x1*2]*INTER_TAB_SIZE);
+                            int sy = cvRound(sXY[x1*2+1]*INTER_TAB_SIZE);
+                            int v = (sy & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (sx & (INTER_TAB_SIZE-1));
+                            XY[x1*2] = (short)(sx >> INTER_BITS);
+                            XY[x1*2+1] = (short)(sy >> INTER_BITS);
+                            A[x1] = (ushort)v;
+                        }
+                    }
+                }
+                ifunc(src, dpart, bufxy, bufa, ctab, borderType, borderValue);
+            }
+        }
+    }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    const Mat *m1, *m2;
+    RemapNNFunc nnfunc;
+    RemapFunc ifunc;
+    const void* ctab;
+    bool planar_input;
+    int borderType;
+    Scalar borderValue;
+};
+
+
 }
     
 void cv::remap( InputArray _src, OutputArray _dst,
@@ -2419,9 +3223,9 @@ void cv::remap( InputArray _src, OutputArray _dst,
     static RemapFunc linear_tab[] =
     {
         remapBilinear<FixedPtCast<int, uchar, INTER_REMAP_COEF_BITS>, RemapVec_8u, short>, 0,
-        remapBilinear<Cast<float, ushort>, RemapNoVec, float>,
+        remapBilinear<Cast<float, ushort>, RemapVec_16u, float>,
         remapBilinear<Cast<float, short>, RemapNoVec, float>, 0,
-        remapBilinear<Cast<float, float>, RemapNoVec, float>,
+        remapBilinear<Cast<float, float>, RemapVec_32f, float>,
         remapBilinear<Cast<double, double>, RemapNoVec, float>, 0
     };
 
@@ -2451,7 +3255,7 @@ void cv::remap( InputArray _src, OutputArray _dst,
     Mat dst = _dst.getMat();
     CV_Assert(dst.data != src.data);
 
-    int depth = src.depth(), map_depth = map1.depth();
+    int depth = src.depth();
     RemapNNFunc nnfunc = 0;
     RemapFunc ifunc = 0;
     const void* ctab = 0;
@@ -2462,12 +3266,6 @@ void cv::remap( InputArray _src, OutputArray _dst,
     {
         nnfunc = nn_tab[depth];
         CV_Assert( nnfunc != 0 );
-
-        if( map1.type() == CV_16SC2 && !map2.data ) // the data is already in the right format
-        {
-            nnfunc( src, dst, map1, borderType, borderValue );
-            return;
-        }
     }
     else
     {
@@ -2493,182 +3291,18 @@ void cv::remap( InputArray _src, OutputArray _dst,
     {
         if( map1.type() != CV_16SC2 )
             std::swap(m1, m2);
-        if( ifunc )
-        {
-            ifunc( src, dst, *m1, *m2, ctab, borderType, borderValue );
-            return;
-        }
     }
-    else
+    else if( !(nnfunc && map1.type() == CV_16SC2 && !map2.data) )
     {
         CV_Assert( (map1.type() == CV_32FC2 && !map2.data) ||
             (map1.type() == CV_32FC1 && map2.type() == CV_32FC1) );
         planar_input = map1.channels() == 1;
     }
 
-    int x, y, x1, y1;
-    const int buf_size = 1 << 14;
-    int brows0 = std::min(128, dst.rows);
-    int bcols0 = std::min(buf_size/brows0, dst.cols);
-    brows0 = std::min(buf_size/bcols0, dst.rows);
-#if CV_SSE2
-    bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
-#endif
-
-    Mat _bufxy(brows0, bcols0, CV_16SC2), _bufa;
-    if( !nnfunc )
-        _bufa.create(brows0, bcols0, CV_16UC1);
-
-    for( y = 0; y < dst.rows; y += brows0 )
-    {
-        for( x = 0; x < dst.cols; x += bcols0 )
-        {
-            int brows = std::min(brows0, dst.rows - y);
-            int bcols = std::min(bcols0, dst.cols - x);
-            Mat dpart(dst, Rect(x, y, bcols, brows));
-            Mat bufxy(_bufxy, Rect(0, 0, bcols, brows));
-
-            if( nnfunc )
-            {
-                if( map_depth != CV_32F )
-                {
-                    for( y1 = 0; y1 < brows; y1++ )
-                    {
-                        short* XY = (short*)(bufxy.data + bufxy.step*y1);
-                        const short* sXY = (const short*)(m1->data + m1->step*(y+y1)) + x*2;
-                        const ushort* sA = (const ushort*)(m2->data + m2->step*(y+y1)) + x;
-
-                        for( x1 = 0; x1 < bcols; x1++ )
-                        {
-                            int a = sA[x1] & (INTER_TAB_SIZE2-1);
-                            XY[x1*2] = sXY[x1*2] + NNDeltaTab_i[a][0];
-                            XY[x1*2+1] = sXY[x1*2+1] + NNDeltaTab_i[a][1];
-                        }
-                    }
-                }
-                else if( !planar_input )
-                    map1(Rect(0,0,bcols,brows)).convertTo(bufxy, bufxy.depth());
-                else
-                {
-                    for( y1 = 0; y1 < brows; y1++ )
-                    {
-                        short* XY = (short*)(bufxy.data + bufxy.step*y1);
-                        const float* sX = (const float*)(map1.data + map1.step*(y+y1)) + x;
-                        const float* sY = (const float*)(map2.data + map2.step*(y+y1)) + x;
-                        x1 = 0;
-
-                    #if CV_SSE2
-                        if( useSIMD )
-                        {
-                            for( ; x1 <= bcols - 8; x1 += 8 )
-                            {
-                                __m128 fx0 = _mm_loadu_ps(sX + x1);
-                                __m128 fx1 = _mm_loadu_ps(sX + x1 + 4);
-                                __m128 fy0 = _mm_loadu_ps(sY + x1);
-                                __m128 fy1 = _mm_loadu_ps(sY + x1 + 4);
-                                __m128i ix0 = _mm_cvtps_epi32(fx0);
-                                __m128i ix1 = _mm_cvtps_epi32(fx1);
-                                __m128i iy0 = _mm_cvtps_epi32(fy0);
-                                __m128i iy1 = _mm_cvtps_epi32(fy1);
-                                ix0 = _mm_packs_epi32(ix0, ix1);
-                                iy0 = _mm_packs_epi32(iy0, iy1);
-                                ix1 = _mm_unpacklo_epi16(ix0, iy0);
-                                iy1 = _mm_unpackhi_epi16(ix0, iy0);
-                                _mm_storeu_si128((__m128i*)(XY + x1*2), ix1);
-                                _mm_storeu_si128((__m128i*)(XY + x1*2 + 8), iy1);
-                            }
-                        }
-                    #endif
-
-                        for( ; x1 < bcols; x1++ )
-                        {
-                            XY[x1*2] = saturate_cast<short>(sX[x1]);
-                            XY[x1*2+1] = saturate_cast<short>(sY[x1]);
-                        }
-                    }
-                }
-                nnfunc( src, dpart, bufxy, borderType, borderValue );
-                continue;
-            }
-
-            Mat bufa(_bufa, Rect(0,0,bcols, brows));
-            for( y1 = 0; y1 < brows; y1++ )
-            {
-                short* XY = (short*)(bufxy.data + bufxy.step*y1);
-                ushort* A = (ushort*)(bufa.data + bufa.step*y1);
-
-                if( planar_input )
-                {
-                    const float* sX = (const float*)(map1.data + map1.step*(y+y1)) + x;
-                    const float* sY = (const float*)(map2.data + map2.step*(y+y1)) + x;
-
-                    x1 = 0;
-                #if CV_SSE2
-                    if( useSIMD )
-                    {
-                        __m128 scale = _mm_set1_ps((float)INTER_TAB_SIZE);
-                        __m128i mask = _mm_set1_epi32(INTER_TAB_SIZE-1);
-                        for( ; x1 <= bcols - 8; x1 += 8 )
-                        {
-                            __m128 fx0 = _mm_loadu_ps(sX + x1);
-                            __m128 fx1 = _mm_loadu_ps(sX + x1 + 4);
-                            __m128 fy0 = _mm_loadu_ps(sY + x1);
-                            __m128 fy1 = _mm_loadu_ps(sY + x1 + 4);
-                            __m128i ix0 = _mm_cvtps_epi32(_mm_mul_ps(fx0, scale));
-                            __m128i ix1 = _mm_cvtps_epi32(_mm_mul_ps(fx1, scale));
-                            __m128i iy0 = _mm_cvtps_epi32(_mm_mul_ps(fy0, scale));
-                            __m128i iy1 = _mm_cvtps_epi32(_mm_mul_ps(fy1, scale));
-                            __m128i mx0 = _mm_and_si128(ix0, mask);
-                            __m128i mx1 = _mm_and_si128(ix1, mask);
-                            __m128i my0 = _mm_and_si128(iy0, mask);
-                            __m128i my1 = _mm_and_si128(iy1, mask);
-                            mx0 = _mm_packs_epi32(mx0, mx1);
-                            my0 = _mm_packs_epi32(my0, my1);
-                            my0 = _mm_slli_epi16(my0, INTER_BITS);
-                            mx0 = _mm_or_si128(mx0, my0);
-                            _mm_storeu_si128((__m128i*)(A + x1), mx0);
-                            ix0 = _mm_srai_epi32(ix0, INTER_BITS);
-                            ix1 = _mm_srai_epi32(ix1, INTER_BITS);
-                            iy0 = _mm_srai_epi32(iy0, INTER_BITS);
-                            iy1 = _mm_srai_epi32(iy1, INTER_BITS);
-                            ix0 = _mm_packs_epi32(ix0, ix1);
-                            iy0 = _mm_packs_epi32(iy0, iy1);
-                            ix1 = _mm_unpacklo_epi16(ix0, iy0);
-                            iy1 = _mm_unpackhi_epi16(ix0, iy0);
-                            _mm_storeu_si128((__m128i*)(XY + x1*2), ix1);
-                            _mm_storeu_si128((__m128i*)(XY + x1*2 + 8), iy1);
-                        }
-                    }
-                #endif
-
-                    for( ; x1 < bcols; x1++ )
-                    {
-                        int sx = cvRound(sX[x1]*INTER_TAB_SIZE);
-                        int sy = cvRound(sY[x1]*INTER_TAB_SIZE);
-                        int v = (sy & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (sx & (INTER_TAB_SIZE-1));
-                        XY[x1*2] = (short)(sx >> INTER_BITS);
-                        XY[x1*2+1] = (short)(sy >> INTER_BITS);
-                        A[x1] = (ushort)v;
-                    }
-                }
-                else
-                {
-                    const float* sXY = (const float*)(map1.data + map1.step*(y+y1)) + x*2;
-
-                    for( x1 = 0; x1 < bcols; x1++ )
-                    {
-                        int sx = cvRound(sXY[x1*2]*INTER_TAB_SIZE);
-                        int sy = cvRound(sXY[x1*2+1]*INTER_TAB_SIZE);
-                        int v = (sy & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE + (sx & (INTER_TAB_SIZE-1));
-                        XY[x1*2] = (short)(sx >> INTER_BITS);
-                        XY[x1*2+1] = (short)(sy >> INTER_BITS);
-                        A[x1] = (ushort)v;
-                    }
-                }
-            }
-            ifunc(src, dpart, bufxy, bufa, ctab, borderType, borderValue);
-        }
-    }
+    int grain = std::max((int)REMAP_MIN_CHUNK_AREA/std::max(dst.cols, 1), 1);
+    parallel_for(BlockedRange(0, dst.rows, grain),
+                 RemapInvoker(src, dst, m1, m2, nnfunc, ifunc, ctab,
+                              planar_input, borderType, borderValue));
 }
 
 
@@ -2811,6 +3445,224 @@ void cv::convertMaps( InputArray _map1, InputArray _map2,
 }
 
 
+namespace cv
+{
+
+// Both warps compute the coordinates for 64x64 or 32x32 destination blocks and pass them
+// to remap(). The invokers process horizontal bands of blocks, each with its own buffers.
+class WarpAffineInvoker
+{
+public:
+    WarpAffineInvoker(const Mat& _src, Mat& _dst, int _interpolation, int _borderType,
+                      const Scalar& _borderValue, const int* _adelta, const int* _bdelta,
+                      const double* _M, int _bh0, int _bw0)
+        : src(&_src), dst(&_dst), interpolation(_interpolation), borderType(_borderType),
+          borderValue(_borderValue), adelta(_adelta), bdelta(_bdelta), M(_M),
+          bh0(_bh0), bw0(_bw0) {}
+
+    enum { BLOCK_SZ = 64 };
+
+    void operator()(const BlockedRange& range) const
+    {
+        short XY[BLOCK_SZ*BLOCK_SZ*2], A[BLOCK_SZ*BLOCK_SZ];
+        int x, y, x1, y1, width = dst->cols;
+        const int AB_BITS = MAX(10, (int)INTER_BITS);
+        const int AB_SCALE = 1 << AB_BITS;
+        int round_delta = interpolation == INTER_NEAREST ? AB_SCALE/2 : AB_SCALE/INTER_TAB_SIZE/2;
+#if CV_SSE2
+        bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
+#endif
+
+        for( y = range.begin(); y < range.end(); y += bh0 )
+        {
+            for( x = 0; x < width; x += bw0 )
+            {
+                int bw = std::min( bw0, width - x);
+                int bh = std::min( bh0, range.end() - y);
+
+                Mat _XY(bh, bw, CV_16SC2, XY), matA;
+                Mat dpart(*dst, Rect(x, y, bw, bh));
+
+                for( y1 = 0; y1 < bh; y1++ )
+                {
+                    short* xy = XY + y1*bw*2;
+                    int X0 = saturate_cast<int>((M[1]*(y + y1) + M[2])*AB_SCALE) + round_delta;
+                    int Y0 = saturate_cast<int>((M[4]*(y + y1) + M[5])*AB_SCALE) + round_delta;
+
+                    if( interpolation == INTER_NEAREST )
+                        for( x1 = 0; x1 < bw; x1++ )
+                        {
+                            int X = (X0 + adelta[x+x1]) >> AB_BITS;
+                            int Y = (Y0 + bdelta[x+x1]) >> AB_BITS;
+                            xy[x1*2] = saturate_cast<short>(X);
+                            xy[x1*2+1] = saturate_cast<short>(Y);
+                        }
+                    else
+                    {
+                        short* alpha = A + y1*bw;
+                        x1 = 0;
+                    #if CV_SSE2
+                        if( useSIMD )
+                        {
+                            __m128i fxy_mask = _mm_set1_epi32(INTER_TAB_SIZE - 1);
+                            __m128i XX = _mm_set1_epi32(X0), YY = _mm_set1_epi32(Y0);
+                            for( ; x1 <= bw - 8; x1 += 8 )
+                            {
+                                __m128i tx0, tx1, ty0, ty1;
+                                tx0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1)), XX);
+                                ty0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1)), YY);
+                                tx1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1 + 4)), XX);
+                                ty1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1 + 4)), YY);
+
+                                tx0 = _mm_srai_epi32(tx0, AB_BITS - INTER_BITS);
+                                ty0 = _mm_srai_epi32(ty0, AB_BITS - INTER_BITS);
+                                tx1 = _mm_srai_epi32(tx1, AB_BITS - INTER_BITS);
+                                ty1 = _mm_srai_epi32(ty1, AB_BITS - INTER_BITS);
+
+                                __m128i fx_ = _mm_packs_epi32(_mm_and_si128(tx0, fxy_mask),
+                                                              _mm_and_si128(tx1, fxy_mask));
+                                __m128i fy_ = _mm_packs_epi32(_mm_and_si128(ty0, fxy_mask),
+                                                              _mm_and_si128(ty1, fxy_mask));
+                                tx0 = _mm_packs_epi32(_mm_srai_epi32(tx0, INTER_BITS),
+                                                              _mm_srai_epi32(tx1, INTER_BITS));
+                                ty0 = _mm_packs_epi32(_mm_srai_epi32(ty0, INTER_BITS),
+                                                      _mm_srai_epi32(ty1, INTER_BITS));
+                                fx_ = _mm_adds_epi16(fx_, _mm_slli_epi16(fy_, INTER_BITS));
+
+                                _mm_storeu_si128((__m128i*)(xy + x1*2), _mm_unpacklo_epi16(tx0, ty0));
+                                _mm_storeu_si128((__m128i*)(xy + x1*2 + 8), _mm_unpackhi_epi16(tx0, ty0));
+                                _mm_storeu_si128((__m128i*)(alpha + x1), fx_);
+                            }
+                        }
+                    #endif
+                        for( ; x1 < bw; x1++ )
+                        {
+                            int X = (X0 + adelta[x+x1]) >> (AB_BITS - INTER_BITS);
+                            int Y = (Y0 + bdelta[x+x1]) >> (AB_BITS - INTER_BITS);
+                            xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
+                            xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
+                            alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
+                                    (X & (INTER_TAB_SIZE-1)));
+                        }
+                    }
+                }
+
+                if( interpolation == INTER_NEAREST )
+                    remap( *src, dpart, _XY, Mat(), interpolation, borderType, borderValue );
+                else
+                {
+                    Mat matA(bh, bw, CV_16U, A);
+                    remap( *src, dpart, _XY, matA, interpolation, borderType, borderValue );
+                }
+            }
+        }
+    }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    int interpolation, borderType;
+    Scalar borderValue;
+    const int *adelta, *bdelta;
+    const double* M;
+    int bh0, bw0;
+};
+
+
+class WarpPerspectiveInvoker
+{
+public:
+    WarpPerspectiveInvoker(const Mat& _src, Mat& _dst, int _interpolation, int _borderType,
+                           const Scalar& _borderValue, const double* _M, int _bh0, int _bw0)
+        : src(&_src), dst(&_dst), interpolation(_interpolation), borderType(_borderType),
+          borderValue(_borderValue), M(_M), bh0(_bh0), bw0(_bw0) {}
+
+    enum { BLOCK_SZ = 32 };
+
+    void operator()(const BlockedRange& range) const
+    {
+        short XY[BLOCK_SZ*BLOCK_SZ*2], A[BLOCK_SZ*BLOCK_SZ];
+        int x, y, x1, y1, width = dst->cols;
+
+        for( y = range.begin(); y < range.end(); y += bh0 )
+        {
+            for( x = 0; x < width; x += bw0 )
+            {
+                int bw = std::min( bw0, width - x);
+                int bh = std::min( bh0, range.end() - y);
+
+                Mat _XY(bh, bw, CV_16SC2, XY), matA;
+                Mat dpart(*dst, Rect(x, y, bw, bh));
+
+                for( y1 = 0; y1 < bh; y1++ )
+                {
+                    short* xy = XY + y1*bw*2;
+                    double X0 = M[0]*x + M[1]*(y + y1) + M[2];
+                    double Y0 = M[3]*x + M[4]*(y + y1) + M[5];
+                    double W0 = M[6]*x + M[7]*(y + y1) + M[8];
+
+                    if( interpolation == INTER_NEAREST )
+                        for( x1 = 0; x1 < bw; x1++ )
+                        {
+                            double W = W0 + M[6]*x1;
+                            W = W ? 1./W : 0;
+                            double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
+                            double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
+                            int X = saturate_cast<int>(fX);
+                            int Y = saturate_cast<int>(fY);
+                        
+                            xy[x1*2] = saturate_cast<short>(X);
+                            xy[x1*2+1] = saturate_cast<short>(Y);
+                        }
+                    else
+                    {
+                        short* alpha = A + y1*bw;
+                        for( x1 = 0; x1 < bw; x1++ )
+                        {
+                            double W = W0 + M[6]*x1;
+                            W = W ? INTER_TAB_SIZE/W : 0;
+                            double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
+                            double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
+                            int X = saturate_cast<int>(fX);
+                            int Y = saturate_cast<int>(fY);
+                        
+                            xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
+                            xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
+                            alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
+                                    (X & (INTER_TAB_SIZE-1)));
+                        }
+                    }
+                }
+
+                if( interpolation == INTER_NEAREST )
+                    remap( *src, dpart, _XY, Mat(), interpolation, borderType, borderValue );
+                else
+                {
+                    Mat matA(bh, bw, CV_16U, A);
+                    remap( *src, dpart, _XY, matA, interpolation, borderType, borderValue );
+                }
+            }
+        }
+    }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    int interpolation, borderType;
+    Scalar borderValue;
+    const double* M;
+    int bh0, bw0;
+};
+
+// rounds the parallel_for grain up to the whole number of the block rows
+static inline int warpGrainSize(Size dsize, int bh0)
+{
+    int rows = std::max((int)REMAP_MIN_CHUNK_AREA/std::max(dsize.width, 1), 1);
+    return (rows + bh0 - 1)/bh0*bh0;
+}
+
+}
+
 void cv::warpAffine( InputArray _src, OutputArray _dst,
                      InputArray _M0, Size dsize,
                      int flags, int borderType, const Scalar& borderValue )
@@ -2820,8 +3672,7 @@ void cv::warpAffine( InputArray _src, OutputArray _dst,
     Mat dst = _dst.getMat();
     CV_Assert( dst.data != src.data && src.cols > 0 && src.rows > 0 );
 
-    const int BLOCK_SZ = 64;
-    short XY[BLOCK_SZ*BLOCK_SZ*2], A[BLOCK_SZ*BLOCK_SZ];
+    const int BLOCK_SZ = WarpAffineInvoker::BLOCK_SZ;
     double M[6];
     Mat matM(2, 3, CV_64F, M);
     int interpolation = flags & INTER_MAX;
@@ -2843,15 +3694,11 @@ void cv::warpAffine( InputArray _src, OutputArray _dst,
         M[2] = b1; M[5] = b2;
     }
 
-    int x, y, x1, y1, width = dst.cols, height = dst.rows;
+    int x, width = dst.cols, height = dst.rows;
     AutoBuffer<int> _abdelta(width*2);
     int* adelta = &_abdelta[0], *bdelta = adelta + width;
     const int AB_BITS = MAX(10, (int)INTER_BITS);
     const int AB_SCALE = 1 << AB_BITS;
-    int round_delta = interpolation == INTER_NEAREST ? AB_SCALE/2 : AB_SCALE/INTER_TAB_SIZE/2;
-#if CV_SSE2
-    bool useSIMD = checkHardwareSupport(CV_CPU_SSE2);
-#endif
 
     for( x = 0; x < width; x++ )
     {
@@ -2863,89 +3710,9 @@ void cv::warpAffine( InputArray _src, OutputArray _dst,
     int bw0 = std::min(BLOCK_SZ*BLOCK_SZ/bh0, width);
     bh0 = std::min(BLOCK_SZ*BLOCK_SZ/bw0, height);
 
-    for( y = 0; y < height; y += bh0 )
-    {
-        for( x = 0; x < width; x += bw0 )
-        {
-            int bw = std::min( bw0, width - x);
-            int bh = std::min( bh0, height - y);
-
-            Mat _XY(bh, bw, CV_16SC2, XY), matA;
-            Mat dpart(dst, Rect(x, y, bw, bh));
-
-            for( y1 = 0; y1 < bh; y1++ )
-            {
-                short* xy = XY + y1*bw*2;
-                int X0 = saturate_cast<int>((M[1]*(y + y1) + M[2])*AB_SCALE) + round_delta;
-                int Y0 = saturate_cast<int>((M[4]*(y + y1) + M[5])*AB_SCALE) + round_delta;
-
-                if( interpolation == INTER_NEAREST )
-                    for( x1 = 0; x1 < bw; x1++ )
-                    {
-                        int X = (X0 + adelta[x+x1]) >> AB_BITS;
-                        int Y = (Y0 + bdelta[x+x1]) >> AB_BITS;
-                        xy[x1*2] = saturate_cast<short>(X);
-                        xy[x1*2+1] = saturate_cast<short>(Y);
-                    }
-                else
-                {
-                    short* alpha = A + y1*bw;
-                    x1 = 0;
-                #if CV_SSE2
-                    if( useSIMD )
-                    {
-                        __m128i fxy_mask = _mm_set1_epi32(INTER_TAB_SIZE - 1);
-                        __m128i XX = _mm_set1_epi32(X0), YY = _mm_set1_epi32(Y0);
-                        for( ; x1 <= bw - 8; x1 += 8 )
-                        {
-                            __m128i tx0, tx1, ty0, ty1;
-                            tx0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1)), XX);
-                            ty0 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1)), YY);
-                            tx1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(adelta + x + x1 + 4)), XX);
-                            ty1 = _mm_add_epi32(_mm_loadu_si128((const __m128i*)(bdelta + x + x1 + 4)), YY);
-
-                            tx0 = _mm_srai_epi32(tx0, AB_BITS - INTER_BITS);
-                            ty0 = _mm_srai_epi32(ty0, AB_BITS - INTER_BITS);
-                            tx1 = _mm_srai_epi32(tx1, AB_BITS - INTER_BITS);
-                            ty1 = _mm_srai_epi32(ty1, AB_BITS - INTER_BITS);
-
-                            __m128i fx_ = _mm_packs_epi32(_mm_and_si128(tx0, fxy_mask),
-                                                          _mm_and_si128(tx1, fxy_mask));
-                            __m128i fy_ = _mm_packs_epi32(_mm_and_si128(ty0, fxy_mask),
-                                                          _mm_and_si128(ty1, fxy_mask));
-                            tx0 = _mm_packs_epi32(_mm_srai_epi32(tx0, INTER_BITS),
-                                                          _mm_srai_epi32(tx1, INTER_BITS));
-                            ty0 = _mm_packs_epi32(_mm_srai_epi32(ty0, INTER_BITS),
-                                                  _mm_srai_epi32(ty1, INTER_BITS));
-                            fx_ = _mm_adds_epi16(fx_, _mm_slli_epi16(fy_, INTER_BITS));
-
-                            _mm_storeu_si128((__m128i*)(xy + x1*2), _mm_unpacklo_epi16(tx0, ty0));
-                            _mm_storeu_si128((__m128i*)(xy + x1*2 + 8), _mm_unpackhi_epi16(tx0, ty0));
-                            _mm_storeu_si128((__m128i*)(alpha + x1), fx_);
-                        }
-                    }
-                #endif
-                    for( ; x1 < bw; x1++ )
-                    {
-                        int X = (X0 + adelta[x+x1]) >> (AB_BITS - INTER_BITS);
-                        int Y = (Y0 + bdelta[x+x1]) >> (AB_BITS - INTER_BITS);
-                        xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
-                        xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
-                        alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
-                                (X & (INTER_TAB_SIZE-1)));
-                    }
-                }
-            }
-
-            if( interpolation == INTER_NEAREST )
-                remap( src, dpart, _XY, Mat(), interpolation, borderType, borderValue );
-            else
-            {
-                Mat matA(bh, bw, CV_16U, A);
-                remap( src, dpart, _XY, matA, interpolation, borderType, borderValue );
-            }
-        }
-    }
+    parallel_for(BlockedRange(0, height, warpGrainSize(dst.size(), bh0)),
+                 WarpAffineInvoker(src, dst, interpolation, borderType, borderValue,
+                                   adelta, bdelta, M, bh0, bw0));
 }
 
 
@@ -2958,8 +3725,7 @@ void cv::warpPerspective( InputArray _src, OutputArray _dst, InputArray _M0,
     
     CV_Assert( dst.data != src.data && src.cols > 0 && src.rows > 0 );
 
-    const int BLOCK_SZ = 32;
-    short XY[BLOCK_SZ*BLOCK_SZ*2], A[BLOCK_SZ*BLOCK_SZ];
+    const int BLOCK_SZ = WarpPerspectiveInvoker::BLOCK_SZ;
     double M[9];
     Mat matM(3, 3, CV_64F, M);
     int interpolation = flags & INTER_MAX;
@@ -2972,71 +3738,15 @@ void cv::warpPerspective( InputArray _src, OutputArray _dst, InputArray _M0,
     if( !(flags & WARP_INVERSE_MAP) )
          invert(matM, matM);
 
-    int x, y, x1, y1, width = dst.cols, height = dst.rows;
+    int width = dst.cols, height = dst.rows;
 
     int bh0 = std::min(BLOCK_SZ/2, height);
     int bw0 = std::min(BLOCK_SZ*BLOCK_SZ/bh0, width);
     bh0 = std::min(BLOCK_SZ*BLOCK_SZ/bw0, height);
 
-    for( y = 0; y < height; y += bh0 )
-    {
-        for( x = 0; x < width; x += bw0 )
-        {
-            int bw = std::min( bw0, width - x);
-            int bh = std::min( bh0, height - y);
-
-            Mat _XY(bh, bw, CV_16SC2, XY), matA;
-            Mat dpart(dst, Rect(x, y, bw, bh));
-
-            for( y1 = 0; y1 < bh; y1++ )
-            {
-                short* xy = XY + y1*bw*2;
-                double X0 = M[0]*x + M[1]*(y + y1) + M[2];
-                double Y0 = M[3]*x + M[4]*(y + y1) + M[5];
-                double W0 = M[6]*x + M[7]*(y + y1) + M[8];
-
-                if( interpolation == INTER_NEAREST )
-                    for( x1 = 0; x1 < bw; x1++ )
-                    {
-                        double W = W0 + M[6]*x1;
-                        W = W ? 1./W : 0;
-                        double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
-                        double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
-                        int X = saturate_cast<int>(fX);
-                        int Y = saturate_cast<int>(fY);
-                        
-                        xy[x1*2] = saturate_cast<short>(X);
-                        xy[x1*2+1] = saturate_cast<short>(Y);
-                    }
-                else
-                {
-                    short* alpha = A + y1*bw;
-                    for( x1 = 0; x1 < bw; x1++ )
-                    {
-                        double W = W0 + M[6]*x1;
-                        W = W ? INTER_TAB_SIZE/W : 0;
-                        double fX = std::max((double)INT_MIN, std::min((double)INT_MAX, (X0 + M[0]*x1)*W));
-                        double fY = std::max((double)INT_MIN, std::min((double)INT_MAX, (Y0 + M[3]*x1)*W));
-                        int X = saturate_cast<int>(fX);
-                        int Y = saturate_cast<int>(fY);
-                        
-                        xy[x1*2] = saturate_cast<short>(X >> INTER_BITS);
-                        xy[x1*2+1] = saturate_cast<short>(Y >> INTER_BITS);
-                        alpha[x1] = (short)((Y & (INTER_TAB_SIZE-1))*INTER_TAB_SIZE +
-                                (X & (INTER_TAB_SIZE-1)));
-                    }
-                }
-            }
-
-            if( interpolation == INTER_NEAREST )
-                remap( src, dpart, _XY, Mat(), interpolation, borderType, borderValue );
-            else
-            {
-                Mat matA(bh, bw, CV_16U, A);
-                remap( src, dpart, _XY, matA, interpolation, borderType, borderValue );
-            }
-        }
-    }
+    parallel_for(BlockedRange(0, height, warpGrainSize(dst.size(), bh0)),
+                 WarpPerspectiveInvoker(src, dst, interpolation, borderType, borderValue,
+                                        M, bh0, bw0));
 }
 
 
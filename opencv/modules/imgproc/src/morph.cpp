@@ -501,6 +501,50 @@ template<class VecUpdate> struct MorphFVec
     }
 };
 
+template<class VecUpdate> struct MorphPairIVec
+{
+    enum { ESZ = VecUpdate::ESZ };
+
+    int operator()(const uchar* a, const uchar* b, uchar* dst, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        int i;
+        width *= ESZ;
+        VecUpdate updateOp;
+
+        for( i = 0; i <= width - 16; i += 16 )
+        {
+            __m128i x = _mm_loadu_si128((const __m128i*)(a + i));
+            __m128i y = _mm_loadu_si128((const __m128i*)(b + i));
+            _mm_storeu_si128((__m128i*)(dst + i), updateOp(x, y));
+        }
+
+        return i/ESZ;
+    }
+};
+
+
+template<class VecUpdate> struct MorphPairFVec
+{
+    int operator()(const uchar* _a, const uchar* _b, uchar* _dst, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE) )
+            return 0;
+
+        const float *a = (const float*)_a, *b = (const float*)_b;
+        float* dst = (float*)_dst;
+        int i;
+        VecUpdate updateOp;
+
+        for( i = 0; i <= width - 4; i += 4 )
+            _mm_storeu_ps(dst + i, updateOp(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+
+        return i;
+    }
+};
+
 struct VMin8u
 {
     enum { ESZ = 1 };
@@ -565,6 +609,15 @@ typedef MorphIVec<VMax16s> DilateVec16s;
 typedef MorphFVec<VMin32f> ErodeVec32f;
 typedef MorphFVec<VMax32f> DilateVec32f;
 
+typedef MorphPairIVec<VMin8u> ErodePairVec8u;
+typedef MorphPairIVec<VMax8u> DilatePairVec8u;
+typedef MorphPairIVec<VMin16u> ErodePairVec16u;
+typedef MorphPairIVec<VMax16u> DilatePairVec16u;
+typedef MorphPairIVec<VMin16s> ErodePairVec16s;
+typedef MorphPairIVec<VMax16s> DilatePairVec16s;
+typedef MorphPairFVec<VMin32f> ErodePairVec32f;
+typedef MorphPairFVec<VMax32f> DilatePairVec32f;
+
 #else
 
 struct MorphRowNoVec
@@ -584,6 +637,11 @@ struct MorphNoVec
     int operator()(uchar**, int, uchar*, int) const { return 0; }
 };
 
+struct MorphPairNoVec
+{
+    int operator()(const uchar*, const uchar*, uchar*, int) const { return 0; }
+};
+
 #ifdef HAVE_TEGRA_OPTIMIZATION
 typedef tegra::MorphRowIVec<tegra::VMin8u> ErodeRowVec8u;
 typedef tegra::MorphRowIVec<tegra::VMax8u> DilateRowVec8u;
@@ -621,6 +679,15 @@ typedef MorphNoVec DilateVec16s;
 typedef MorphNoVec ErodeVec32f;
 typedef MorphNoVec DilateVec32f;
 
+typedef MorphPairNoVec ErodePairVec8u;
+typedef MorphPairNoVec DilatePairVec8u;
+typedef MorphPairNoVec ErodePairVec16u;
+typedef MorphPairNoVec DilatePairVec16u;
+typedef MorphPairNoVec ErodePairVec16s;
+typedef MorphPairNoVec DilatePairVec16s;
+typedef MorphPairNoVec ErodePairVec32f;
+typedef MorphPairNoVec DilatePairVec32f;
+
 #endif
 
 
@@ -634,6 +701,8 @@ template<class Op, class VecOp> struct MorphRowFilter : public BaseRowFilter
         anchor = _anchor;
     }
 
+    Ptr<BaseRowFilter> clone() const { return new MorphRowFilter(*this); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         int i, j, k, _ksize = ksize*cn;
@@ -688,6 +757,8 @@ template<class Op, class VecOp> struct MorphColumnFilter : public BaseColumnFilt
         anchor = _anchor;
     }
 
+    Ptr<BaseColumnFilter> clone() const { return new MorphColumnFilter(*this); }
+
     void operator()(const uchar** _src, uchar* dst, int dststep, int count, int width)
     {
         int i, k, _ksize = ksize;
@@ -785,6 +856,8 @@ template<class Op, class VecOp> struct MorphFilter : BaseFilter
         ptrs.resize( coords.size() );
     }
 
+    Ptr<BaseFilter> clone() const { return new MorphFilter(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width, int cn)
     {
         const Point* pt = &coords[0];
@@ -832,6 +905,213 @@ template<class Op, class VecOp> struct MorphFilter : BaseFilter
     vector<uchar*> ptrs;
     VecOp vecOp;
 };
+
+
+/*
+   van Herk/Gil-Werman algorithm for rectangular structuring elements. The running
+   min/max over a window of k elements takes 3 comparisons per element regardless of k:
+   the line is split into blocks of k elements, g is the min/max from the beginning of
+   the block, h is the min/max till the end of the block, and the result for the window
+   that starts at i is op(h[i], g[i+k-1]). The image is processed by rows and then by
+   columns; the pixels outside of the image are replaced with the neutral value of op,
+   which is equivalent to both BORDER_REPLICATE and the default constant border.
+*/
+
+// the structuring elements that are smaller than this are processed by FilterEngine;
+// the rows that are shorter than MORPH_VHGW_MIN_ROW_KSIZE bytes are processed by the
+// vectorized row filter, which is faster than the scalar van Herk/Gil-Werman code then
+enum { MORPH_VHGW_MIN_KSIZE = 8, MORPH_VHGW_MIN_ROW_KSIZE = 64 };
+
+// dst[i] = op(a[i], b[i]), i = 0..width-1
+template<class Op, class VecOp> static inline void
+morphPair( const typename Op::rtype* a, const typename Op::rtype* b,
+           typename Op::rtype* dst, int width )
+{
+    Op op;
+    VecOp vecOp;
+    int i = vecOp((const uchar*)a, (const uchar*)b, (uchar*)dst, width);
+    for( ; i < width; i++ )
+        dst[i] = op(a[i], b[i]);
+}
+
+// MinOp<uchar> and MaxOp<uchar> use a lookup table, which is slow in the long dependency
+// chains of the row pass; the plain comparison is faster there
+template<class Op> struct MorphChainOp { typedef Op type; };
+template<typename T> struct MinChainOp { T operator()(T a, T b) const { return std::min(a, b); } };
+template<typename T> struct MaxChainOp { T operator()(T a, T b) const { return std::max(a, b); } };
+template<> struct MorphChainOp<MinOp<uchar> > { typedef MinChainOp<uchar> type; };
+template<> struct MorphChainOp<MaxOp<uchar> > { typedef MaxChainOp<uchar> type; };
+
+template<class Op, class VecOp> class MorphRowVHGWInvoker
+{
+public:
+    typedef typename Op::rtype T;
+
+    MorphRowVHGWInvoker(const Mat& _src, Mat& _dst, const Ptr<BaseRowFilter>& _rowFilter,
+                        int _ksize, int _anchor, int _srcY, int _wholeWidth, int _ofsX, T _neutral)
+        : src(&_src), dst(&_dst), rowFilter(&_rowFilter), ksize(_ksize), anchor(_anchor),
+        srcY(_srcY), wholeWidth(_wholeWidth), ofsX(_ofsX), neutral(_neutral) {}
+
+    // computes the rows of dst from the source rows starting from srcY;
+    // if rowFilter is set (for short kernels), it is used instead of van Herk/Gil-Werman
+    void operator()(const BlockedRange& range) const
+    {
+        const Mat& src = *this->src;
+        Mat& dst = *this->dst;
+        Ptr<BaseRowFilter> rowFilter;
+        if( !this->rowFilter->empty() )
+            rowFilter = (*this->rowFilter)->clone();
+        int cn = src.channels(), k = ksize;
+        int width = src.cols, len = width + k - 1;
+        // the part of the padded row that is inside the image
+        int x0 = std::min(std::max(anchor - ofsX, 0), len);
+        int x1 = std::max(std::min(wholeWidth - ofsX + anchor, len), x0);
+        AutoBuffer<T> _buf(len*cn*3);
+        T *buf = _buf, *g = buf + len*cn, *h = g + len*cn;
+        typename MorphChainOp<Op>::type op;
+
+        for( int y = range.begin(); y < range.end(); y++ )
+        {
+            const T* S = (const T*)(src.data + src.step*(y + srcY)) - anchor*cn;
+            T* D = (T*)(dst.data + dst.step*y);
+            int i, j, p0;
+
+            for( i = 0; i < x0*cn; i++ )
+                buf[i] = neutral;
+            memcpy( buf + x0*cn, S + x0*cn, (x1 - x0)*cn*sizeof(T) );
+            for( i = x1*cn; i < len*cn; i++ )
+                buf[i] = neutral;
+
+            if( !rowFilter.empty() )
+            {
+                (*rowFilter)((const uchar*)buf, (uchar*)D, width, cn);
+                continue;
+            }
+
+            for( p0 = 0; p0 < len; p0 += k )
+            {
+                int b0 = p0*cn, b1 = std::min(p0 + k, len)*cn;
+                for( j = 0; j < cn; j++ )
+                {
+                    T m = buf[b0 + j];
+                    g[b0 + j] = m;
+                    for( i = b0 + cn + j; i < b1; i += cn )
+                        g[i] = m = op(m, buf[i]);
+                    m = buf[b1 - cn + j];
+                    h[b1 - cn + j] = m;
+                    for( i = b1 - cn*2 + j; i >= b0; i -= cn )
+                        h[i] = m = op(m, buf[i]);
+                }
+            }
+
+            morphPair<Op, VecOp>(h, g + (k - 1)*cn, D, width*cn);
+        }
+    }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    const Ptr<BaseRowFilter>* rowFilter;
+    int ksize, anchor, srcY, wholeWidth, ofsX;
+    T neutral;
+};
+
+template<class Op, class VecOp> class MorphColumnVHGWInvoker
+{
+public:
+    typedef typename Op::rtype T;
+    enum { CHUNK_SIZE = 1 << 10 };
+
+    MorphColumnVHGWInvoker(const uchar** _rows, Mat& _dst, int _ksize)
+        : rows(_rows), dst(&_dst), ksize(_ksize) {}
+
+    // processes the columns [range.begin()*chunk, range.end()*chunk) of dst. rows are
+    // the row-filtered source rows, there are ksize-1 more of them than dst rows
+    void operator()(const BlockedRange& range) const
+    {
+        Mat& dst = *this->dst;
+        int k = ksize, chunk = CHUNK_SIZE/sizeof(T);
+        int width = dst.cols*dst.channels(), height = dst.rows;
+        int x0 = range.begin()*chunk, x1 = std::min(range.end()*chunk, width);
+        int w = x1 - x0;
+        AutoBuffer<T> _buf(w*k*2);
+        T *h = _buf, *g = h + w*k;
+
+        for( int y0 = 0; y0 < height; y0 += k )
+        {
+            int t, n = std::min(k, height - y0);
+
+            // h for the rows [y0, y0 + k) and g for the rows [y0 + k, y0 + k + n - 1)
+            memcpy(h + w*(k - 1), (const T*)rows[y0 + k - 1] + x0, w*sizeof(T));
+            for( t = k - 2; t >= 0; t-- )
+                morphPair<Op, VecOp>(h + w*(t + 1), (const T*)rows[y0 + t] + x0, h + w*t, w);
+
+            if( n > 1 )
+                memcpy(g, (const T*)rows[y0 + k] + x0, w*sizeof(T));
+            for( t = 1; t < n - 1; t++ )
+                morphPair<Op, VecOp>(g + w*(t - 1), (const T*)rows[y0 + k + t] + x0, g + w*t, w);
+
+            memcpy((T*)(dst.data + dst.step*y0) + x0, h, w*sizeof(T));
+            for( t = 1; t < n; t++ )
+                morphPair<Op, VecOp>(h + w*t, g + w*(t - 1), (T*)(dst.data + dst.step*(y0 + t)) + x0, w);
+        }
+    }
+
+protected:
+    const uchar** rows;
+    Mat* dst;
+    int ksize;
+};
+
+template<class Op, class VecOp> static void
+morphVHGW_( int op, const Mat& src, Mat& dst, Size ksize, Point anchor,
+            Size wholeSize, Point ofs, double _neutral )
+{
+    typedef typename Op::rtype T;
+    T neutral = saturate_cast<T>(_neutral);
+    int i, cn = src.channels(), nrows = src.rows + ksize.height - 1;
+    // the source rows that are inside the image
+    int y0 = std::min(std::max(anchor.y - ofs.y, 0), nrows);
+    int y1 = std::max(std::min(wholeSize.height - ofs.y + anchor.y, nrows), y0);
+    Mat buf, neutralRow(1, src.cols, src.type());
+    vector<const uchar*> rows(nrows);
+    T* N = (T*)neutralRow.data;
+
+    for( i = 0; i < src.cols*cn; i++ )
+        N[i] = neutral;
+    for( i = 0; i < nrows; i++ )
+        rows[i] = neutralRow.data;
+
+    // the column pass can read the source rows directly unless they are overwritten by dst
+    if( ksize.width > 1 || !(dst.dataend <= src.datastart || src.dataend <= dst.datastart) )
+    {
+        Ptr<BaseRowFilter> rowFilter;
+        if( ksize.width*(int)sizeof(T) < MORPH_VHGW_MIN_ROW_KSIZE )
+            rowFilter = getMorphologyRowFilter(op, src.type(), ksize.width, 0);
+        // a single-row kernel does not need the column pass
+        if( ksize.height == 1 )
+            buf = dst;
+        else
+            buf.create(y1 - y0, src.cols, src.type());
+        parallel_for(BlockedRange(0, y1 - y0, std::max((1 << 15)/std::max(src.cols, 1), 1)),
+                     MorphRowVHGWInvoker<Op, VecOp>(src, buf, rowFilter, ksize.width, anchor.x,
+                     y0 - anchor.y, wholeSize.width, ofs.x, neutral));
+        if( ksize.height == 1 )
+            return;
+        for( i = y0; i < y1; i++ )
+            rows[i] = buf.data + buf.step*(i - y0);
+    }
+    else
+        for( i = y0; i < y1; i++ )
+            rows[i] = src.data + src.step*(i - anchor.y);
+
+    int chunk = MorphColumnVHGWInvoker<Op, VecOp>::CHUNK_SIZE/sizeof(T);
+    parallel_for(BlockedRange(0, (src.cols*cn + chunk - 1)/chunk),
+                 MorphColumnVHGWInvoker<Op, VecOp>(&rows[0], dst, ksize.height));
+}
+
+typedef void (*MorphVHGWFunc)( int op, const Mat& src, Mat& dst, Size ksize, Point anchor,
+                               Size wholeSize, Point ofs, double neutral );
     
 }
 
@@ -1049,6 +1329,51 @@ cv::Mat cv::getStructuringElement(int shape, Size ksize, Point anchor)
 namespace cv
 {
 
+// runs van Herk/Gil-Werman algorithm if the kernel is a large rectangle and the border
+// does not affect the result; returns false otherwise
+static bool morphVHGW( int op, const Mat& src, Mat& dst, const Mat& kernel, Point anchor,
+                       int iterations, int borderType, const Scalar& borderValue )
+{
+    static MorphVHGWFunc erodeTab[] =
+    {
+        morphVHGW_<MinOp<uchar>, ErodePairVec8u>, 0,
+        morphVHGW_<MinOp<ushort>, ErodePairVec16u>,
+        morphVHGW_<MinOp<short>, ErodePairVec16s>, 0,
+        morphVHGW_<MinOp<float>, ErodePairVec32f>, 0, 0
+    };
+    static MorphVHGWFunc dilateTab[] =
+    {
+        morphVHGW_<MaxOp<uchar>, DilatePairVec8u>, 0,
+        morphVHGW_<MaxOp<ushort>, DilatePairVec16u>,
+        morphVHGW_<MaxOp<short>, DilatePairVec16s>, 0,
+        morphVHGW_<MaxOp<float>, DilatePairVec32f>, 0, 0
+    };
+
+    int depth = src.depth(), border = borderType & ~BORDER_ISOLATED;
+    bool replicate = border == BORDER_REPLICATE;
+    MorphVHGWFunc func = op == MORPH_ERODE ? erodeTab[depth] : op == MORPH_DILATE ? dilateTab[depth] : 0;
+
+    if( !func || iterations != 1 || std::max(kernel.cols, kernel.rows) < MORPH_VHGW_MIN_KSIZE ||
+        !(replicate || (border == BORDER_CONSTANT && depth != CV_16S &&
+                        borderValue == morphologyDefaultBorderValue())) ||
+        countNonZero(kernel) != kernel.rows*kernel.cols )
+        return false;
+
+    // the same values as the default border value in createMorphologyFilter
+    double neutral = depth == CV_32F ? (replicate ? std::numeric_limits<double>::infinity() : FLT_MAX) :
+        depth == CV_8U ? UCHAR_MAX : depth == CV_16U ? USHRT_MAX : SHRT_MAX;
+    if( op == MORPH_DILATE )
+        neutral = depth == CV_32F ? -neutral : depth == CV_16S ? SHRT_MIN : 0;
+
+    Size wholeSize = src.size();
+    Point ofs;
+    if( !(borderType & BORDER_ISOLATED) )
+        src.locateROI(wholeSize, ofs);
+
+    func( op, src, dst, kernel.size(), anchor, wholeSize, ofs, neutral );
+    return true;
+}
+
 static void morphOp( int op, InputArray _src, OutputArray _dst,
                      InputArray _kernel,
                      Point anchor, int iterations,
@@ -1085,6 +1410,9 @@ static void morphOp( int op, InputArray _src, OutputArray _dst,
         iterations = 1;
     }
 
+    if( morphVHGW( op, src, dst, kernel, anchor, iterations, borderType, borderValue ) )
+        return;
+
     Ptr<FilterEngine> f = createMorphologyFilter(op, src.type(),
         kernel, anchor, borderType, borderType, borderValue );
 
@@ -94,6 +94,59 @@ static inline Point normalizeAnchor( Point anchor, Size ksize )
     return anchor;
 }
 
+#if CV_SSE2
+
+// one round of the perfect shuffle of 96 bytes held in 6 registers:
+// (a0, a1, a2, a3, a4, a5) -> (a0 x a3, a1 x a4, a2 x a5), where "x" interleaves the bytes
+#define CV_SHUFFLE_96_EPI8(a0, a1, a2, a3, a4, a5) \
+    { \
+        __m128i t0 = _mm_unpacklo_epi8(a0, a3), t1 = _mm_unpackhi_epi8(a0, a3); \
+        __m128i t2 = _mm_unpacklo_epi8(a1, a4), t3 = _mm_unpackhi_epi8(a1, a4); \
+        __m128i t4 = _mm_unpacklo_epi8(a2, a5), t5 = _mm_unpackhi_epi8(a2, a5); \
+        a0 = t0; a1 = t1; a2 = t2; a3 = t3; a4 = t4; a5 = t5; \
+    }
+
+// the inverse of CV_SHUFFLE_96_EPI8: even bytes go to the first half, odd bytes to the second one
+#define CV_UNSHUFFLE_96_EPI8(a0, a1, a2, a3, a4, a5) \
+    { \
+        __m128i m = _mm_set1_epi16(0x00ff); \
+        __m128i t0 = _mm_packus_epi16(_mm_and_si128(a0, m), _mm_and_si128(a1, m)); \
+        __m128i t3 = _mm_packus_epi16(_mm_srli_epi16(a0, 8), _mm_srli_epi16(a1, 8)); \
+        __m128i t1 = _mm_packus_epi16(_mm_and_si128(a2, m), _mm_and_si128(a3, m)); \
+        __m128i t4 = _mm_packus_epi16(_mm_srli_epi16(a2, 8), _mm_srli_epi16(a3, 8)); \
+        __m128i t2 = _mm_packus_epi16(_mm_and_si128(a4, m), _mm_and_si128(a5, m)); \
+        __m128i t5 = _mm_packus_epi16(_mm_srli_epi16(a4, 8), _mm_srli_epi16(a5, 8)); \
+        a0 = t0; a1 = t1; a2 = t2; a3 = t3; a4 = t4; a5 = t5; \
+    }
+
+// splits 32 packed 3-channel pixels v0..v5 into the planes (v0, v1), (v2, v3) and (v4, v5);
+// five perfect shuffles of 96 = 32*3 bytes transpose the 32x3 byte matrix
+static inline void _mm_deinterleave3_epi8( __m128i& v0, __m128i& v1, __m128i& v2,
+                                           __m128i& v3, __m128i& v4, __m128i& v5 )
+{
+    CV_SHUFFLE_96_EPI8(v0, v1, v2, v3, v4, v5);
+    CV_SHUFFLE_96_EPI8(v0, v1, v2, v3, v4, v5);
+    CV_SHUFFLE_96_EPI8(v0, v1, v2, v3, v4, v5);
+    CV_SHUFFLE_96_EPI8(v0, v1, v2, v3, v4, v5);
+    CV_SHUFFLE_96_EPI8(v0, v1, v2, v3, v4, v5);
+}
+
+// the inverse of _mm_deinterleave3_epi8
+static inline void _mm_interleave3_epi8( __m128i& v0, __m128i& v1, __m128i& v2,
+                                         __m128i& v3, __m128i& v4, __m128i& v5 )
+{
+    CV_UNSHUFFLE_96_EPI8(v0, v1, v2, v3, v4, v5);
+    CV_UNSHUFFLE_96_EPI8(v0, v1, v2, v3, v4, v5);
+    CV_UNSHUFFLE_96_EPI8(v0, v1, v2, v3, v4, v5);
+    CV_UNSHUFFLE_96_EPI8(v0, v1, v2, v3, v4, v5);
+    CV_UNSHUFFLE_96_EPI8(v0, v1, v2, v3, v4, v5);
+}
+
+#undef CV_SHUFFLE_96_EPI8
+#undef CV_UNSHUFFLE_96_EPI8
+
+#endif
+
 void preprocess2DKernel( const Mat& kernel, vector<Point>& coords, vector<uchar>& coeffs );
 void crossCorr( const Mat& src, const Mat& templ, Mat& dst,
                 Size corrsize, int ctype,
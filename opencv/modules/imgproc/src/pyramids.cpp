@@ -64,6 +64,11 @@ template<typename T1, typename T2> struct NoVec
     int operator()(T1**, T2*, int, int) const { return 0; }
 };
 
+template<typename T, typename WT> struct PyrDownNoHVec
+{
+    int operator()(const T*, WT*, int x, int) const { return x; }
+};
+
 #if CV_SSE2
 
 struct PyrDownVec_32s8u
@@ -177,135 +182,438 @@ struct PyrDownVec_32f
     }
 };
 
+struct PyrDownVec_32s16u
+{
+    int operator()(int** src, ushort* dst, int, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return 0;
+
+        int x = 0;
+        const int *row0 = src[0], *row1 = src[1], *row2 = src[2], *row3 = src[3], *row4 = src[4];
+        __m128i delta = _mm_set1_epi32(128), bias = _mm_set1_epi32(32768), bias16 = _mm_set1_epi16((short)-32768);
+
+        for( ; x <= width - 8; x += 8 )
+        {
+            __m128i r0, r1, r2, r3, r4, t0, t1;
+            r0 = _mm_load_si128((const __m128i*)(row0 + x));
+            r1 = _mm_load_si128((const __m128i*)(row1 + x));
+            r2 = _mm_load_si128((const __m128i*)(row2 + x));
+            r3 = _mm_load_si128((const __m128i*)(row3 + x));
+            r4 = _mm_load_si128((const __m128i*)(row4 + x));
+            r0 = _mm_add_epi32(r0, r4);
+            r1 = _mm_add_epi32(_mm_add_epi32(r1, r3), r2);
+            r0 = _mm_add_epi32(r0, _mm_add_epi32(r2, r2));
+            t0 = _mm_add_epi32(r0, _mm_slli_epi32(r1, 2));
+
+            r0 = _mm_load_si128((const __m128i*)(row0 + x + 4));
+            r1 = _mm_load_si128((const __m128i*)(row1 + x + 4));
+            r2 = _mm_load_si128((const __m128i*)(row2 + x + 4));
+            r3 = _mm_load_si128((const __m128i*)(row3 + x + 4));
+            r4 = _mm_load_si128((const __m128i*)(row4 + x + 4));
+            r0 = _mm_add_epi32(r0, r4);
+            r1 = _mm_add_epi32(_mm_add_epi32(r1, r3), r2);
+            r0 = _mm_add_epi32(r0, _mm_add_epi32(r2, r2));
+            t1 = _mm_add_epi32(r0, _mm_slli_epi32(r1, 2));
+
+            // there is no unsigned saturation from 32 to 16 bits in SSE2,
+            // so the values are shifted to the signed range and back
+            t0 = _mm_sub_epi32(_mm_srai_epi32(_mm_add_epi32(t0, delta), 8), bias);
+            t1 = _mm_sub_epi32(_mm_srai_epi32(_mm_add_epi32(t1, delta), 8), bias);
+            _mm_storeu_si128((__m128i*)(dst + x), _mm_xor_si128(_mm_packs_epi32(t0, t1), bias16));
+        }
+
+        return x;
+    }
+};
+
+// horizontal convolution and decimation of a single-channel row: computes row[x] for x
+// starting from the given position while the source pixels 2*x-2 ... 2*x+2 (and a few
+// more read by the vector loads) are inside the row; returns the first unprocessed x
+struct PyrDownHVec_8u32s
+{
+    int operator()(const uchar* src, int* row, int x, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return x;
+
+        __m128i mask = _mm_set1_epi16(0xff), z = _mm_setzero_si128();
+        for( ; x <= width - 9; x += 8 )
+        {
+            const uchar* s = src + x*2;
+            __m128i vm = _mm_loadu_si128((const __m128i*)(s - 2));
+            __m128i v0 = _mm_loadu_si128((const __m128i*)s);
+            __m128i vp = _mm_loadu_si128((const __m128i*)(s + 2));
+            __m128i e0 = _mm_and_si128(v0, mask);
+            __m128i t = _mm_add_epi16(_mm_slli_epi16(e0, 2), _mm_slli_epi16(e0, 1));
+            t = _mm_add_epi16(t, _mm_slli_epi16(_mm_add_epi16(_mm_srli_epi16(vm, 8), _mm_srli_epi16(v0, 8)), 2));
+            t = _mm_add_epi16(t, _mm_add_epi16(_mm_and_si128(vm, mask), _mm_and_si128(vp, mask)));
+            _mm_storeu_si128((__m128i*)(row + x), _mm_unpacklo_epi16(t, z));
+            _mm_storeu_si128((__m128i*)(row + x + 4), _mm_unpackhi_epi16(t, z));
+        }
+        return x;
+    }
+};
+
+struct PyrDownHVec_16u32s
+{
+    int operator()(const ushort* src, int* row, int x, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE2) )
+            return x;
+
+        __m128i mask = _mm_set1_epi32(0xffff);
+        for( ; x <= width - 5; x += 4 )
+        {
+            const ushort* s = src + x*2;
+            __m128i vm = _mm_loadu_si128((const __m128i*)(s - 2));
+            __m128i v0 = _mm_loadu_si128((const __m128i*)s);
+            __m128i vp = _mm_loadu_si128((const __m128i*)(s + 2));
+            __m128i e0 = _mm_and_si128(v0, mask);
+            __m128i t = _mm_add_epi32(_mm_slli_epi32(e0, 2), _mm_slli_epi32(e0, 1));
+            t = _mm_add_epi32(t, _mm_slli_epi32(_mm_add_epi32(_mm_srli_epi32(vm, 16), _mm_srli_epi32(v0, 16)), 2));
+            t = _mm_add_epi32(t, _mm_add_epi32(_mm_and_si128(vm, mask), _mm_and_si128(vp, mask)));
+            _mm_storeu_si128((__m128i*)(row + x), t);
+        }
+        return x;
+    }
+};
+
+struct PyrDownHVec_32f
+{
+    int operator()(const float* src, float* row, int x, int width) const
+    {
+        if( !checkHardwareSupport(CV_CPU_SSE) )
+            return x;
+
+        __m128 _4 = _mm_set1_ps(4.f), _6 = _mm_set1_ps(6.f);
+        for( ; x <= width - 5; x += 4 )
+        {
+            // the operations are done in the same order as in the scalar code
+            const float* s = src + x*2;
+            __m128 a = _mm_loadu_ps(s - 2), b = _mm_loadu_ps(s + 2);
+            __m128 c = _mm_loadu_ps(s), d = _mm_loadu_ps(s + 4), e = _mm_loadu_ps(s + 6);
+            __m128 em = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0));
+            __m128 om = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1));
+            __m128 e0 = _mm_shuffle_ps(c, d, _MM_SHUFFLE(2,0,2,0));
+            __m128 o0 = _mm_shuffle_ps(c, d, _MM_SHUFFLE(3,1,3,1));
+            __m128 ep = _mm_shuffle_ps(b, e, _MM_SHUFFLE(2,0,2,0));
+            __m128 t = _mm_add_ps(_mm_mul_ps(e0, _6), _mm_mul_ps(_mm_add_ps(om, o0), _4));
+            t = _mm_add_ps(_mm_add_ps(t, em), ep);
+            _mm_storeu_ps(row + x, t);
+        }
+        return x;
+    }
+};
+
 #else
 
 typedef NoVec<int, uchar> PyrDownVec_32s8u;
+typedef NoVec<int, ushort> PyrDownVec_32s16u;
 typedef NoVec<float, float> PyrDownVec_32f;
+typedef PyrDownNoHVec<uchar, int> PyrDownHVec_8u32s;
+typedef PyrDownNoHVec<ushort, int> PyrDownHVec_16u32s;
+typedef PyrDownNoHVec<float, float> PyrDownHVec_32f;
 
 #endif
 
-template<class CastOp, class VecOp> void
-pyrDown_( const Mat& _src, Mat& _dst )
+// Computes the rows of pyrDown() result one after another, starting from the given row.
+// The horizontally filtered source rows are kept in a ring buffer, so the object can be
+// used to produce the rows incrementally, as soon as the source rows they need are ready.
+template<class CastOp, class HVecOp, class VecOp> class PyrDownRows
 {
-    const int PD_SZ = 5;
+public:
     typedef typename CastOp::type1 WT;
     typedef typename CastOp::rtype T;
+    enum { PD_SZ = 5 };
 
-    Size ssize = _src.size(), dsize = _dst.size();
-    int cn = _src.channels();
-    int bufstep = (int)alignSize(dsize.width*cn, 16);
-    AutoBuffer<WT> _buf(bufstep*PD_SZ + 16);
-    WT* buf = alignPtr((WT*)_buf, 16);
-    int tabL[CV_CN_MAX*(PD_SZ+2)], tabR[CV_CN_MAX*(PD_SZ+2)];
-    AutoBuffer<int> _tabM(dsize.width*cn);
-    int* tabM = _tabM;
-    WT* rows[PD_SZ];
-    CastOp castOp;
-    VecOp vecOp;
-
-    CV_Assert( std::abs(dsize.width*2 - ssize.width) <= 2 &&
-               std::abs(dsize.height*2 - ssize.height) <= 2 );
-    int k, x, sy0 = -PD_SZ/2, sy = sy0, width0 = std::min((ssize.width-PD_SZ/2-1)/2 + 1, dsize.width);
-
-    for( x = 0; x <= PD_SZ+1; x++ )
+    PyrDownRows( const Mat& _src, Mat& _dst, int y0 ) : src(&_src), dst(&_dst), y(y0)
     {
-        int sx0 = borderInterpolate(x - PD_SZ/2, ssize.width, BORDER_REFLECT_101)*cn;
-        int sx1 = borderInterpolate(x + width0*2 - PD_SZ/2, ssize.width, BORDER_REFLECT_101)*cn;
-        for( k = 0; k < cn; k++ )
+        Size ssize = src->size(), dsize = dst->size();
+        cn = src->channels();
+        bufstep = (int)alignSize(dsize.width*cn, 16);
+        _buf.allocate(bufstep*PD_SZ + 16);
+        buf = alignPtr((WT*)_buf, 16);
+        _tabM.allocate(dsize.width*cn);
+        tabM = _tabM;
+
+        CV_Assert( std::abs(dsize.width*2 - ssize.width) <= 2 &&
+                   std::abs(dsize.height*2 - ssize.height) <= 2 );
+        int k, x;
+        sy0 = sy = y0*2 - PD_SZ/2;
+        width0 = std::min((ssize.width-PD_SZ/2-1)/2 + 1, dsize.width);
+
+        for( x = 0; x <= PD_SZ+1; x++ )
         {
-            tabL[x*cn + k] = sx0 + k;
-            tabR[x*cn + k] = sx1 + k;
+            int sx0 = borderInterpolate(x - PD_SZ/2, ssize.width, BORDER_REFLECT_101)*cn;
+            int sx1 = borderInterpolate(x + width0*2 - PD_SZ/2, ssize.width, BORDER_REFLECT_101)*cn;
+            for( k = 0; k < cn; k++ )
+            {
+                tabL[x*cn + k] = sx0 + k;
+                tabR[x*cn + k] = sx1 + k;
+            }
         }
-    }
-    
-    ssize.width *= cn;
-    dsize.width *= cn;
-    width0 *= cn;
 
-    for( x = 0; x < dsize.width; x++ )
-        tabM[x] = (x/cn)*2*cn + x % cn;
+        width0 *= cn;
 
-    for( int y = 0; y < dsize.height; y++ )
+        for( x = 0; x < dsize.width*cn; x++ )
+            tabM[x] = (x/cn)*2*cn + x % cn;
+    }
+
+    // computes the destination rows up to y1 (exclusive)
+    void operator()( int y1 )
     {
-        T* dst = (T*)(_dst.data + _dst.step*y);
-        WT *row0, *row1, *row2, *row3, *row4;
+        int k, x;
+        Size ssize = src->size(), dsize = dst->size();
+        WT* rows[PD_SZ];
+        CastOp castOp;
+        HVecOp hvecOp;
+        VecOp vecOp;
 
-        // fill the ring buffer (horizontal convolution and decimation)
-        for( ; sy <= y*2 + 2; sy++ )
+        ssize.width *= cn;
+        dsize.width *= cn;
+
+        for( ; y < y1; y++ )
         {
-            WT* row = buf + ((sy - sy0) % PD_SZ)*bufstep;
-            int _sy = borderInterpolate(sy, ssize.height, BORDER_REFLECT_101);
-            const T* src = (const T*)(_src.data + _src.step*_sy);
-            int limit = cn;
-            const int* tab = tabL;
+            T* _dst = (T*)(dst->data + dst->step*y);
+            WT *row0, *row1, *row2, *row3, *row4;
 
-            for( x = 0;;)
+            // fill the ring buffer (horizontal convolution and decimation)
+            for( ; sy <= y*2 + 2; sy++ )
             {
-                for( ; x < limit; x++ )
+                WT* row = buf + ((sy - sy0) % PD_SZ)*bufstep;
+                int _sy = borderInterpolate(sy, ssize.height, BORDER_REFLECT_101);
+                const T* _src = (const T*)(src->data + src->step*_sy);
+                int limit = cn;
+                const int* tab = tabL;
+
+                for( x = 0;;)
                 {
-                    row[x] = src[tab[x+cn*2]]*6 + (src[tab[x+cn]] + src[tab[x+cn*3]])*4 +
-                        src[tab[x]] + src[tab[x+cn*4]];
-                }
+                    for( ; x < limit; x++ )
+                    {
+                        row[x] = _src[tab[x+cn*2]]*6 + (_src[tab[x+cn]] + _src[tab[x+cn*3]])*4 +
+                            _src[tab[x]] + _src[tab[x+cn*4]];
+                    }
 
-                if( x == dsize.width )
-                    break;
+                    if( x == dsize.width )
+                        break;
 
-                if( cn == 1 )
-                {
-                    for( ; x < width0; x++ )
-                        row[x] = src[x*2]*6 + (src[x*2 - 1] + src[x*2 + 1])*4 +
-                            src[x*2 - 2] + src[x*2 + 2];
-                }
-                else if( cn == 3 )
-                {
-                    for( ; x < width0; x += 3 )
+                    if( cn == 1 )
                     {
-                        const T* s = src + x*2;
-                        WT t0 = s[0]*6 + (s[-3] + s[3])*4 + s[-6] + s[6];
-                        WT t1 = s[1]*6 + (s[-2] + s[4])*4 + s[-5] + s[7];
-                        WT t2 = s[2]*6 + (s[-1] + s[5])*4 + s[-4] + s[8];
-                        row[x] = t0; row[x+1] = t1; row[x+2] = t2;
+                        x = hvecOp(_src, row, x, width0);
+                        for( ; x < width0; x++ )
+                            row[x] = _src[x*2]*6 + (_src[x*2 - 1] + _src[x*2 + 1])*4 +
+                                _src[x*2 - 2] + _src[x*2 + 2];
                     }
-                }
-                else if( cn == 4 )
-                {
-                    for( ; x < width0; x += 4 )
+                    else if( cn == 3 )
                     {
-                        const T* s = src + x*2;
-                        WT t0 = s[0]*6 + (s[-4] + s[4])*4 + s[-8] + s[8];
-                        WT t1 = s[1]*6 + (s[-3] + s[5])*4 + s[-7] + s[9];
-                        row[x] = t0; row[x+1] = t1;
-                        t0 = s[2]*6 + (s[-2] + s[6])*4 + s[-6] + s[10];
-                        t1 = s[3]*6 + (s[-1] + s[7])*4 + s[-5] + s[11];
-                        row[x+2] = t0; row[x+3] = t1;
+                        for( ; x < width0; x += 3 )
+                        {
+                            const T* s = _src + x*2;
+                            WT t0 = s[0]*6 + (s[-3] + s[3])*4 + s[-6] + s[6];
+                            WT t1 = s[1]*6 + (s[-2] + s[4])*4 + s[-5] + s[7];
+                            WT t2 = s[2]*6 + (s[-1] + s[5])*4 + s[-4] + s[8];
+                            row[x] = t0; row[x+1] = t1; row[x+2] = t2;
+                        }
                     }
-                }
-                else
-                {
-                    for( ; x < width0; x++ )
+                    else if( cn == 4 )
                     {
-                        int sx = tabM[x];
-                        row[x] = src[sx]*6 + (src[sx - cn] + src[sx + cn])*4 +
-                            src[sx - cn*2] + src[sx + cn*2];
+                        for( ; x < width0; x += 4 )
+                        {
+                            const T* s = _src + x*2;
+                            WT t0 = s[0]*6 + (s[-4] + s[4])*4 + s[-8] + s[8];
+                            WT t1 = s[1]*6 + (s[-3] + s[5])*4 + s[-7] + s[9];
+                            row[x] = t0; row[x+1] = t1;
+                            t0 = s[2]*6 + (s[-2] + s[6])*4 + s[-6] + s[10];
+                            t1 = s[3]*6 + (s[-1] + s[7])*4 + s[-5] + s[11];
+                            row[x+2] = t0; row[x+3] = t1;
+                        }
                     }
+                    else
+                    {
+                        for( ; x < width0; x++ )
+                        {
+                            int sx = tabM[x];
+                            row[x] = _src[sx]*6 + (_src[sx - cn] + _src[sx + cn])*4 +
+                                _src[sx - cn*2] + _src[sx + cn*2];
+                        }
+                    }
+
+                    limit = dsize.width;
+                    tab = tabR - x;
                 }
+            }
+
+            // do vertical convolution and decimation and write the result to the destination image
+            for( k = 0; k < PD_SZ; k++ )
+                rows[k] = buf + ((y*2 - PD_SZ/2 + k - sy0) % PD_SZ)*bufstep;
+            row0 = rows[0]; row1 = rows[1]; row2 = rows[2]; row3 = rows[3]; row4 = rows[4];
+
+            x = vecOp(rows, _dst, (int)dst->step, dsize.width);
+            for( ; x < dsize.width; x++ )
+                _dst[x] = castOp(row2[x]*6 + (row1[x] + row3[x])*4 + row0[x] + row4[x]);
+        }
+    }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    int y, sy, sy0, cn, bufstep, width0;
+    AutoBuffer<WT> _buf;
+    WT* buf;
+    int tabL[CV_CN_MAX*(PD_SZ+2)], tabR[CV_CN_MAX*(PD_SZ+2)];
+    AutoBuffer<int> _tabM;
+    int* tabM;
+};
+
+template<class CastOp, class HVecOp, class VecOp> class PyrDownInvoker
+{
+public:
+    PyrDownInvoker( const Mat& _src, Mat& _dst ) : src(&_src), dst(&_dst) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        PyrDownRows<CastOp, HVecOp, VecOp> rows(*src, *dst, range.begin());
+        rows(range.end());
+    }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+};
+
+// each band of rows restarts the ring buffer, which costs 3 extra source rows
+static int pyrDownBandRows( int rows )
+{
+    int nthreads = std::max(getNumThreads(), 1);
+    return std::max((rows + nthreads - 1)/nthreads, 16);
+}
+
+template<class CastOp, class HVecOp, class VecOp> void
+pyrDown_( const Mat& _src, Mat& _dst )
+{
+    parallel_for( BlockedRange(0, _dst.rows, pyrDownBandRows(_dst.rows)),
+                  PyrDownInvoker<CastOp, HVecOp, VecOp>(_src, _dst) );
+}
 
-                limit = dsize.width;
-                tab = tabR - x;
+// the rows of pyrDown() result that can be computed from the rows [r.start, r.end)
+// of the source image of height h (dh is the height of the result)
+static Range pyrDownRowsFrom( Range r, int h, int dh )
+{
+    int y0 = std::min(r.start == 0 ? 0 : (r.start + 3)/2, dh);
+    int y1 = r.end == h ? dh : std::min((r.end - 1)/2, dh);
+    return Range(y0, std::max(y0, y1));
+}
+
+/*
+  Builds the pyramid levels 1..nlevels-1 in one pass. The rows of the level 1 are split
+  into bands that are processed in parallel. Each band produces its rows of the level 1 in
+  small portions and, after each portion, all the rows of the next levels that only depend
+  on the rows already computed by the band, so the data is consumed while it is in the cache.
+  The few rows at the band boundaries that depend on two bands are computed afterwards.
+*/
+template<class CastOp, class HVecOp, class VecOp> class PyramidInvoker
+{
+public:
+    typedef PyrDownRows<CastOp, HVecOp, VecOp> Rows;
+    enum { STEP_ROWS = 4 };
+
+    PyramidInvoker( vector<Mat>& _levels, int _bandRows )
+        : levels(&_levels), bandRows(_bandRows) {}
+
+    // rows of each level computed by the band
+    void bandRanges( int band, vector<Range>& ranges ) const
+    {
+        const vector<Mat>& pyr = *levels;
+        int nlevels = (int)pyr.size();
+        ranges.resize(nlevels);
+        ranges[1] = Range(band*bandRows, std::min((band + 1)*bandRows, pyr[1].rows));
+        for( int i = 2; i < nlevels; i++ )
+            ranges[i] = pyrDownRowsFrom(ranges[i-1], pyr[i-1].rows, pyr[i].rows);
+    }
+
+    void operator()( const BlockedRange& range ) const
+    {
+        vector<Mat>& pyr = *levels;
+        int nlevels = (int)pyr.size();
+        vector<Range> ranges;
+        vector<int> done(nlevels);
+        vector<Ptr<Rows> > rows(nlevels);
+
+        for( int band = range.begin(); band < range.end(); band++ )
+        {
+            bandRanges(band, ranges);
+            for( int i = 1; i < nlevels; i++ )
+            {
+                rows[i] = new Rows(pyr[i-1], pyr[i], ranges[i].start);
+                done[i] = ranges[i].start;
+            }
+
+            for( int y = ranges[1].start; y < ranges[1].end; )
+            {
+                y = std::min(y + STEP_ROWS, ranges[1].end);
+                (*rows[1])(y);
+                done[1] = y;
+
+                for( int i = 2; i < nlevels; i++ )
+                {
+                    Range r = pyrDownRowsFrom(Range(ranges[i-1].start, done[i-1]),
+                                              pyr[i-1].rows, pyr[i].rows);
+                    int y1 = std::min(r.end, ranges[i].end);
+                    if( y1 <= done[i] )
+                        break;
+                    (*rows[i])(y1);
+                    done[i] = y1;
+                }
             }
         }
+    }
 
-        // do vertical convolution and decimation and write the result to the destination image
-        for( k = 0; k < PD_SZ; k++ )
-            rows[k] = buf + ((y*2 - PD_SZ/2 + k - sy0) % PD_SZ)*bufstep;
-        row0 = rows[0]; row1 = rows[1]; row2 = rows[2]; row3 = rows[3]; row4 = rows[4];
+    // computes the rows not covered by any band; the levels are processed in order
+    void finish( int nbands ) const
+    {
+        vector<Mat>& pyr = *levels;
+        int nlevels = (int)pyr.size();
+        vector<vector<Range> > ranges(nbands);
 
-        x = vecOp(rows, dst, (int)_dst.step, dsize.width);
-        for( ; x < dsize.width; x++ )
-            dst[x] = castOp(row2[x]*6 + (row1[x] + row3[x])*4 + row0[x] + row4[x]);
+        for( int band = 0; band < nbands; band++ )
+            bandRanges(band, ranges[band]);
+
+        for( int i = 2; i < nlevels; i++ )
+        {
+            int y = 0;
+            for( int band = 0; band <= nbands; band++ )
+            {
+                int y1 = band < nbands ? ranges[band][i].start : pyr[i].rows;
+                if( y < y1 )
+                {
+                    Rows rows(pyr[i-1], pyr[i], y);
+                    rows(y1);
+                }
+                if( band < nbands )
+                    y = std::max(y, ranges[band][i].end);
+            }
+        }
     }
+
+protected:
+    vector<Mat>* levels;
+    int bandRows;
+};
+
+template<class CastOp, class HVecOp, class VecOp> void
+buildPyramid_( vector<Mat>& levels )
+{
+    int rows = levels[1].rows;
+    int bandRows = pyrDownBandRows(rows);
+    int nbands = (rows + bandRows - 1)/bandRows;
+    PyramidInvoker<CastOp, HVecOp, VecOp> invoker(levels, bandRows);
+
+    parallel_for( BlockedRange(0, nbands), invoker );
+    invoker.finish(nbands);
 }
 
+typedef void (*PyramidFunc)(vector<Mat>&);
 
 template<class CastOp, class VecOp> void
 pyrUp_( const Mat& _src, Mat& _dst )
@@ -410,15 +718,15 @@ void cv::pyrDown( InputArray _src, OutputArray _dst, const Size& _dsz )
     int depth = src.depth();
     PyrFunc func = 0;
     if( depth == CV_8U )
-        func = pyrDown_<FixPtCast<uchar, 8>, PyrDownVec_32s8u>;
+        func = pyrDown_<FixPtCast<uchar, 8>, PyrDownHVec_8u32s, PyrDownVec_32s8u>;
     else if( depth == CV_16S )
-        func = pyrDown_<FixPtCast<short, 8>, NoVec<int, short> >;
+        func = pyrDown_<FixPtCast<short, 8>, PyrDownNoHVec<short, int>, NoVec<int, short> >;
     else if( depth == CV_16U )
-        func = pyrDown_<FixPtCast<ushort, 8>, NoVec<int, ushort> >;
+        func = pyrDown_<FixPtCast<ushort, 8>, PyrDownHVec_16u32s, PyrDownVec_32s16u>;
     else if( depth == CV_32F )
-        func = pyrDown_<FltCast<float, 8>, PyrDownVec_32f>;
+        func = pyrDown_<FltCast<float, 8>, PyrDownHVec_32f, PyrDownVec_32f>;
     else if( depth == CV_64F )
-        func = pyrDown_<FltCast<double, 8>, NoVec<double, double> >;
+        func = pyrDown_<FltCast<double, 8>, PyrDownNoHVec<double, double>, NoVec<double, double> >;
     else
         CV_Error( CV_StsUnsupportedFormat, "" );
 
@@ -454,8 +762,36 @@ void cv::buildPyramid( InputArray _src, OutputArrayOfArrays _dst, int maxlevel )
     Mat src = _src.getMat();
     _dst.create( maxlevel + 1, 1, 0 );
     _dst.getMatRef(0) = src;
+
+    // the levels that already have the right size and type are reused
+    vector<Mat> levels(maxlevel + 1);
+    levels[0] = src;
     for( int i = 1; i <= maxlevel; i++ )
-        pyrDown( _dst.getMatRef(i-1), _dst.getMatRef(i) );
+    {
+        Mat& dst = _dst.getMatRef(i);
+        dst.create( Size((levels[i-1].cols + 1)/2, (levels[i-1].rows + 1)/2), src.type() );
+        levels[i] = dst;
+    }
+
+    if( maxlevel <= 0 || src.empty() )
+        return;
+
+    int depth = src.depth();
+    PyramidFunc func = 0;
+    if( depth == CV_8U )
+        func = buildPyramid_<FixPtCast<uchar, 8>, PyrDownHVec_8u32s, PyrDownVec_32s8u>;
+    else if( depth == CV_16S )
+        func = buildPyramid_<FixPtCast<short, 8>, PyrDownNoHVec<short, int>, NoVec<int, short> >;
+    else if( depth == CV_16U )
+        func = buildPyramid_<FixPtCast<ushort, 8>, PyrDownHVec_16u32s, PyrDownVec_32s16u>;
+    else if( depth == CV_32F )
+        func = buildPyramid_<FltCast<float, 8>, PyrDownHVec_32f, PyrDownVec_32f>;
+    else if( depth == CV_64F )
+        func = buildPyramid_<FltCast<double, 8>, PyrDownNoHVec<double, double>, NoVec<double, double> >;
+    else
+        CV_Error( CV_StsUnsupportedFormat, "" );
+
+    func( levels );
 }
 
 CV_IMPL void cvPyrDown( const void* srcarr, void* dstarr, int _filter )
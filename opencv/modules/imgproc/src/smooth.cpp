@@ -74,6 +74,8 @@ template<typename T, typename ST> struct RowSum : public BaseRowFilter
         anchor = _anchor;
     }
     
+    Ptr<BaseRowFilter> clone() const { return new RowSum(*this); }
+
     void operator()(const uchar* src, uchar* dst, int width, int cn)
     {
         const T* S = (const T*)src;
@@ -109,6 +111,8 @@ template<typename ST, typename T> struct ColumnSum : public BaseColumnFilter
 
     void reset() { sumCount = 0; }
     
+    Ptr<BaseColumnFilter> clone() const { return new ColumnSum(*this); }
+
     void operator()(const uchar** src, uchar* dst, int dststep, int count, int width)
     {
         int i;
@@ -1420,6 +1424,11 @@ bilateralFilter_32f( const Mat& src, Mat& dst, int d,
     // compute the min/max range for the input image (even if multichannel)
     
     minMaxLoc( src.reshape(1), &minValSrc, &maxValSrc );
+    if( std::abs(minValSrc - maxValSrc) < FLT_EPSILON )
+    {
+        src.copyTo(dst);
+        return;
+    }
     
     // temporary copy of the image with borders for easy processing
     Mat temp;
@@ -1478,6 +1487,9 @@ bilateralFilter_32f( const Mat& src, Mat& dst, int d,
                 {
                     float val = sptr[j + space_ofs[k]];
 					float alpha = (float)(std::abs(val - val0)*scale_index);
+                    // NaN's and infinities get the weight of the most distant colors
+                    if( !(alpha <= kExpNumBins) )
+                        alpha = (float)kExpNumBins;
                     int idx = cvFloor(alpha);
                     alpha -= idx;
                     float w = space_weight[k]*(expLUT[idx] + alpha*(expLUT[idx+1] - expLUT[idx]));
@@ -1500,6 +1512,8 @@ bilateralFilter_32f( const Mat& src, Mat& dst, int d,
                     float b = sptr_k[0], g = sptr_k[1], r = sptr_k[2];
 					float alpha = (float)((std::abs(b - b0) +
                         std::abs(g - g0) + std::abs(r - r0))*scale_index);
+                    if( !(alpha <= kExpNumBins) )
+                        alpha = (float)kExpNumBins;
                     int idx = cvFloor(alpha);
                     alpha -= idx;
                     float w = space_weight[k]*(expLUT[idx] + alpha*(expLUT[idx+1] - expLUT[idx]));
@@ -1516,16 +1530,316 @@ bilateralFilter_32f( const Mat& src, Mat& dst, int d,
     }
 }
 
+
+/*
+   Bilateral grid (J. Chen, S. Paris, F. Durand, "Real-time edge-aware image processing
+   with the bilateral grid", SIGGRAPH 2007). The pixels are splatted into a 3D grid
+   (x, y, intensity) with sigmaSpace x sigmaSpace x sigmaColor cells, the grid is blurred
+   with a small Gaussian kernel and the result is sliced back with trilinear interpolation,
+   so the cost does not depend on the spatial radius. For 3-channel images the range
+   coordinate is the sum of channels, i.e. the same L1 color distance as in the direct filter.
+*/
+
+// the grid and its blur buffer take at most BILATERAL_GRID_MAX_MEMORY bytes;
+// a larger grid (very small sigmaSpace or sigmaColor compared to the image size
+// and value range) is not worth it, and the direct filter is used instead
+enum { BILATERAL_GRID_PAD = 2, BILATERAL_GRID_MAX_MEMORY = 1 << 28 };
+
+struct BilateralGrid
+{
+    int width, height, depth, cn; // cn is the number of values per cell: channels + weight
+    size_t xstep, ystep;
+    float sigma_space, inv_sigma_space, inv_sigma_color, minval;
+    float* data;
+    float* buf;
+};
+
+template<typename T> static inline float bilateralGridRange( const T* p, int cn )
+{
+    return cn == 1 ? (float)p[0] : (float)p[0] + (float)p[1] + (float)p[2];
+}
+
+template<typename T> class BilateralGridSplatInvoker
+{
+public:
+    BilateralGridSplatInvoker(const Mat& _src, const BilateralGrid& _grid)
+        : src(&_src), grid(&_grid) {}
+
+    // fills the grid rows [range.begin(), range.end()), so the bands do not overlap
+    void operator()(const BlockedRange& range) const
+    {
+        const Mat& src = *this->src;
+        const BilateralGrid& g = *grid;
+        int cn = src.channels(), gcn = g.cn, width = src.cols;
+        int gy0 = range.begin(), gy1 = range.end();
+        int y0 = std::max(cvFloor((gy0 - 1 - BILATERAL_GRID_PAD)*g.sigma_space) - 1, 0);
+        int y1 = std::min(cvCeil((gy1 - BILATERAL_GRID_PAD)*g.sigma_space) + 1, src.rows);
+
+        for( int y = y0; y < y1; y++ )
+        {
+            float fy = y*g.inv_sigma_space + BILATERAL_GRID_PAD;
+            int iy = cvFloor(fy);
+            if( iy < gy0 - 1 || iy >= gy1 )
+                continue;
+            float ty = fy - iy;
+            const T* S = (const T*)(src.data + src.step*y);
+
+            for( int x = 0; x < width; x++, S += cn )
+            {
+                float fx = x*g.inv_sigma_space + BILATERAL_GRID_PAD;
+                float fz = (bilateralGridRange(S, cn) - g.minval)*g.inv_sigma_color + BILATERAL_GRID_PAD;
+                int ix = cvFloor(fx), iz = cvFloor(fz);
+                float tx = fx - ix, tz = fz - iz;
+
+                for( int dy = 0; dy < 2; dy++ )
+                {
+                    if( iy + dy < gy0 || iy + dy >= gy1 )
+                        continue;
+                    float wy = dy ? ty : 1.f - ty;
+                    float* cell = g.data + (iy + dy)*g.ystep + ix*g.xstep + iz*gcn;
+                    float* cells[] = { cell, cell + gcn, cell + g.xstep, cell + g.xstep + gcn };
+                    float w[] = { wy*(1.f - tx)*(1.f - tz), wy*(1.f - tx)*tz,
+                                  wy*tx*(1.f - tz), wy*tx*tz };
+
+                    for( int k = 0; k < 4; k++ )
+                    {
+                        float* c = cells[k];
+                        for( int j = 0; j < cn; j++ )
+                            c[j] += S[j]*w[k];
+                        c[cn] += w[k];
+                    }
+                }
+            }
+        }
+    }
+
+protected:
+    const Mat* src;
+    const BilateralGrid* grid;
+};
+
+// convolves n cells located at src, src + step, ... with the [1 4 6 4 1] kernel;
+// the kernel is not normalized since the scale cancels out when the grid is sliced
+static void bilateralGridBlurLine( const float* src, float* dst, int n, size_t step, int cn )
+{
+    for( int i = 0; i < n; i++, src += step, dst += step )
+        for( int j = 0; j < cn; j++ )
+        {
+            float s = src[j]*6;
+            if( i > 0 )
+                s += src[j - step]*4;
+            if( i > 1 )
+                s += src[j - step*2];
+            if( i < n - 1 )
+                s += src[j + step]*4;
+            if( i < n - 2 )
+                s += src[j + step*2];
+            dst[j] = s;
+        }
+}
+
+class BilateralGridBlurInvoker
+{
+public:
+    BilateralGridBlurInvoker(const BilateralGrid& _grid, bool _vertical)
+        : grid(&_grid), vertical(_vertical) {}
+
+    // the horizontal pass blurs each grid row along z and x from data to buf,
+    // the vertical pass blurs the grid along y from buf back to data
+    void operator()(const BlockedRange& range) const
+    {
+        const BilateralGrid& g = *grid;
+
+        if( !vertical )
+        {
+            AutoBuffer<float> _row(g.ystep);
+            float* row = _row;
+            for( int gy = range.begin(); gy < range.end(); gy++ )
+            {
+                const float* src = g.data + gy*g.ystep;
+                float* dst = g.buf + gy*g.ystep;
+                for( int gx = 0; gx < g.width; gx++ )
+                    bilateralGridBlurLine(src + gx*g.xstep, row + gx*g.xstep, g.depth, g.cn, g.cn);
+                for( int gz = 0; gz < g.depth; gz++ )
+                    bilateralGridBlurLine(row + gz*g.cn, dst + gz*g.cn, g.width, g.xstep, g.cn);
+            }
+        }
+        else
+        {
+            for( int gy = range.begin(); gy < range.end(); gy++ )
+            {
+                const float* src = g.buf + gy*g.ystep;
+                float* dst = g.data + gy*g.ystep;
+                size_t i, len = g.ystep;
+                for( i = 0; i < len; i++ )
+                    dst[i] = src[i]*6;
+                if( gy > 0 )
+                    for( i = 0; i < len; i++ )
+                        dst[i] += src[i - g.ystep]*4;
+                if( gy > 1 )
+                    for( i = 0; i < len; i++ )
+                        dst[i] += src[i - g.ystep*2];
+                if( gy < g.height - 1 )
+                    for( i = 0; i < len; i++ )
+                        dst[i] += src[i + g.ystep]*4;
+                if( gy < g.height - 2 )
+                    for( i = 0; i < len; i++ )
+                        dst[i] += src[i + g.ystep*2];
+            }
+        }
+    }
+
+protected:
+    const BilateralGrid* grid;
+    bool vertical;
+};
+
+template<typename T> class BilateralGridSliceInvoker
+{
+public:
+    BilateralGridSliceInvoker(const Mat& _src, Mat& _dst, const BilateralGrid& _grid)
+        : src(&_src), dst(&_dst), grid(&_grid) {}
+
+    void operator()(const BlockedRange& range) const
+    {
+        const Mat& src = *this->src;
+        Mat& dst = *this->dst;
+        const BilateralGrid& g = *grid;
+        int cn = src.channels(), gcn = g.cn, width = src.cols;
+
+        for( int y = range.begin(); y < range.end(); y++ )
+        {
+            float fy = y*g.inv_sigma_space + BILATERAL_GRID_PAD;
+            int iy = cvFloor(fy);
+            float ty = fy - iy;
+            const T* S = (const T*)(src.data + src.step*y);
+            T* D = (T*)(dst.data + dst.step*y);
+
+            for( int x = 0; x < width; x++, S += cn, D += cn )
+            {
+                float fx = x*g.inv_sigma_space + BILATERAL_GRID_PAD;
+                float fz = (bilateralGridRange(S, cn) - g.minval)*g.inv_sigma_color + BILATERAL_GRID_PAD;
+                int ix = cvFloor(fx), iz = cvFloor(fz);
+                float tx = fx - ix, tz = fz - iz;
+                const float* cell = g.data + iy*g.ystep + ix*g.xstep + iz*gcn;
+                const float* cells[] = { cell, cell + gcn, cell + g.xstep, cell + g.xstep + gcn };
+                float w[] = { (1.f - tx)*(1.f - tz), (1.f - tx)*tz, tx*(1.f - tz), tx*tz };
+                float sum[4] = { 0, 0, 0, 0 };
+
+                for( int dy = 0; dy < 2; dy++ )
+                {
+                    float wy = dy ? ty : 1.f - ty;
+                    for( int k = 0; k < 4; k++ )
+                    {
+                        const float* c = cells[k] + dy*g.ystep;
+                        float wk = w[k]*wy;
+                        for( int j = 0; j <= cn; j++ )
+                            sum[j] += c[j]*wk;
+                    }
+                }
+
+                float scale = 1.f/sum[cn];
+                for( int j = 0; j < cn; j++ )
+                    D[j] = saturate_cast<T>(sum[j]*scale);
+            }
+        }
+    }
+
+protected:
+    const Mat* src;
+    Mat* dst;
+    const BilateralGrid* grid;
+};
+
+// returns false if the grid would not fit into BILATERAL_GRID_MAX_MEMORY
+// or the image contains NaN's or infinities; the direct filter is used then
+template<typename T> static bool
+bilateralFilterGrid_( const Mat& src, Mat& dst, double sigma_color, double sigma_space )
+{
+    int cn = src.channels();
+    Size size = src.size();
+
+    CV_Assert( (cn == 1 || cn == 3) && src.type() == dst.type() && src.size() == dst.size() );
+
+    if( sigma_color <= 0 )
+        sigma_color = 1;
+    if( sigma_space <= 0 )
+        sigma_space = 1;
+
+    float minval = FLT_MAX, maxval = -FLT_MAX;
+    for( int y = 0; y < size.height; y++ )
+    {
+        const T* S = (const T*)(src.data + src.step*y);
+        for( int x = 0; x < size.width; x++, S += cn )
+        {
+            float v = bilateralGridRange(S, cn);
+            if( !(fabs(v) <= FLT_MAX) )
+                return false;
+            minval = std::min(minval, v);
+            maxval = std::max(maxval, v);
+        }
+    }
+
+    // check the grid size in double precision, before the dimensions are converted to int
+    double zrange = (double)maxval - minval;
+    if( zrange > FLT_MAX || 1./sigma_color > FLT_MAX )
+        return false;
+    double gsize = ((size.width - 1)/sigma_space + BILATERAL_GRID_PAD*2 + 3)*
+        ((size.height - 1)/sigma_space + BILATERAL_GRID_PAD*2 + 3)*
+        (zrange/sigma_color + BILATERAL_GRID_PAD*2 + 3)*(cn + 1)*2*sizeof(float);
+    if( gsize > (double)BILATERAL_GRID_MAX_MEMORY )
+        return false;
+
+    BilateralGrid g;
+    g.sigma_space = (float)sigma_space;
+    g.inv_sigma_space = (float)(1./sigma_space);
+    g.inv_sigma_color = (float)(1./sigma_color);
+    g.minval = minval;
+    g.width = cvFloor((size.width - 1)*g.inv_sigma_space) + BILATERAL_GRID_PAD*2 + 3;
+    g.height = cvFloor((size.height - 1)*g.inv_sigma_space) + BILATERAL_GRID_PAD*2 + 3;
+    g.depth = cvFloor((maxval - minval)*g.inv_sigma_color) + BILATERAL_GRID_PAD*2 + 3;
+    g.cn = cn + 1;
+
+    g.xstep = (size_t)g.depth*g.cn;
+    g.ystep = g.xstep*g.width;
+    size_t total = g.ystep*g.height;
+    AutoBuffer<float> _data(total*2);
+    g.data = _data;
+    g.buf = g.data + total;
+    memset( g.data, 0, total*sizeof(g.data[0]) );
+
+    int grain = std::max(1, (1 << 15)/(int)std::min(g.ystep, (size_t)(1 << 15)));
+    parallel_for(BlockedRange(0, g.height, grain), BilateralGridSplatInvoker<T>(src, g));
+    parallel_for(BlockedRange(0, g.height, grain), BilateralGridBlurInvoker(g, false));
+    parallel_for(BlockedRange(0, g.height, grain), BilateralGridBlurInvoker(g, true));
+    parallel_for(BlockedRange(0, size.height, std::max(1, (1 << 15)/std::max(size.width, 1))),
+                 BilateralGridSliceInvoker<T>(src, dst, g));
+    return true;
+}
 }
 
 void cv::bilateralFilter( InputArray _src, OutputArray _dst, int d,
                       double sigmaColor, double sigmaSpace,
-                      int borderType )
+                      int borderType, int method )
 {
     Mat src = _src.getMat();
     _dst.create( src.size(), src.type() );
     Mat dst = _dst.getMat();
-    
+
+    CV_Assert( method == BILATERAL_EXACT || method == BILATERAL_GRID );
+
+    if( method == BILATERAL_GRID && !src.empty() &&
+        (src.type() == CV_8UC1 || src.type() == CV_8UC3 ||
+         src.type() == CV_32FC1 || src.type() == CV_32FC3) )
+    {
+        if( src.data == dst.data )
+            src = src.clone();
+        if( src.depth() == CV_8U ?
+            bilateralFilterGrid_<uchar>( src, dst, sigmaColor, sigmaSpace ) :
+            bilateralFilterGrid_<float>( src, dst, sigmaColor, sigmaSpace ) )
+            return;
+    }
+
     if( src.depth() == CV_8U )
         bilateralFilter_8u( src, dst, d, sigmaColor, sigmaSpace, borderType );
     else if( src.depth() == CV_32F )
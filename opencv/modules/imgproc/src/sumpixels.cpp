@@ -234,6 +234,358 @@ typedef void (*IntegralFunc)(const uchar* src, size_t srcstep, uchar* sum, size_
                              uchar* sqsum, size_t sqsumstep, uchar* tilted, size_t tstep,
                              Size size, int cn );
 
+/*
+  The integral (and the integral of squares) without the tilted sum is computed in
+  two passes, each of them parallel:
+    1. every row of the source image is replaced by its prefix sum (rows are independent);
+    2. every row of the result is added to the previous one (columns are independent).
+  Each output element is obtained with exactly the same additions as in integral_(),
+  so the result is bit-exact for the floating-point sums too.
+*/
+
+template<typename T, typename ST, typename QT> struct IntegralRow
+{
+    // sum[x] (and sqsum[x]) = sum of src[x - k*cn] (their squares) over k >= 0, plus
+    // prevsum[x] (prevsqsum[x]) when it is not NULL; width is in pixels
+    void operator()( const T* src, ST* sum, QT* sqsum, const ST* prevsum,
+                     const QT* prevsqsum, int width, int cn ) const
+    {
+        width *= cn;
+        for( int k = 0; k < cn; k++ )
+        {
+            ST s = 0;
+            QT sq = 0;
+            if( sqsum && prevsum )
+                for( int x = k; x < width; x += cn )
+                {
+                    T it = src[x];
+                    s += it;
+                    sq += (QT)it*it;
+                    sum[x] = prevsum[x] + s;
+                    sqsum[x] = prevsqsum[x] + sq;
+                }
+            else if( sqsum )
+                for( int x = k; x < width; x += cn )
+                {
+                    T it = src[x];
+                    s += it;
+                    sq += (QT)it*it;
+                    sum[x] = s;
+                    sqsum[x] = sq;
+                }
+            else if( prevsum )
+                for( int x = k; x < width; x += cn )
+                {
+                    s += src[x];
+                    sum[x] = prevsum[x] + s;
+                }
+            else
+                for( int x = k; x < width; x += cn )
+                {
+                    s += src[x];
+                    sum[x] = s;
+                }
+        }
+    }
+};
+
+#if CV_SSE2
+static inline __m128i integralCarry( __m128i v, int cn )
+{
+    // broadcasts the last pixel of v
+    return cn == 1 ? _mm_shuffle_epi32(v, _MM_SHUFFLE(3,3,3,3)) :
+           cn == 2 ? _mm_shuffle_epi32(v, _MM_SHUFFLE(3,2,3,2)) : v;
+}
+#endif
+
+template<> struct IntegralRow<uchar, int, double>
+{
+    void operator()( const uchar* src, int* sum, double* sqsum, const int* prevsum,
+                     const double* prevsqsum, int width, int cn ) const
+    {
+        int x = 0, len = width*cn;
+        int s[4] = {0, 0, 0, 0};
+        double sq[4] = {0, 0, 0, 0};
+#if CV_SSE2
+        // the squares are summed as integers, which is exact while the row is short enough
+        if( checkHardwareSupport(CV_CPU_SSE2) && (cn == 1 || cn == 2 || cn == 4) &&
+            (!sqsum || width < INT_MAX/(255*255)) )
+        {
+            __m128i z = _mm_setzero_si128(), carry = z, sqcarry = z;
+            for( ; x <= len - 8; x += 8 )
+            {
+                __m128i v = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)(src + x)), z);
+                // the prefix sums of the 8 values fit into 16 bits
+                __m128i p = v;
+                if( cn == 1 )
+                    p = _mm_add_epi16(p, _mm_slli_si128(p, 2));
+                if( cn <= 2 )
+                    p = _mm_add_epi16(p, _mm_slli_si128(p, 4));
+                p = _mm_add_epi16(p, _mm_slli_si128(p, 8));
+                __m128i s0 = _mm_add_epi32(_mm_unpacklo_epi16(p, z), carry);
+                __m128i s1 = _mm_add_epi32(_mm_unpackhi_epi16(p, z), carry);
+                carry = integralCarry(s1, cn);
+                if( prevsum )
+                {
+                    s0 = _mm_add_epi32(s0, _mm_loadu_si128((const __m128i*)(prevsum + x)));
+                    s1 = _mm_add_epi32(s1, _mm_loadu_si128((const __m128i*)(prevsum + x + 4)));
+                }
+                _mm_storeu_si128((__m128i*)(sum + x), s0);
+                _mm_storeu_si128((__m128i*)(sum + x + 4), s1);
+
+                if( sqsum )
+                {
+                    __m128i lo = _mm_mullo_epi16(v, v), hi = _mm_mulhi_epu16(v, v);
+                    __m128i q0 = _mm_unpacklo_epi16(lo, hi), q1 = _mm_unpackhi_epi16(lo, hi);
+                    if( cn == 1 )
+                    {
+                        q0 = _mm_add_epi32(q0, _mm_slli_si128(q0, 4));
+                        q1 = _mm_add_epi32(q1, _mm_slli_si128(q1, 4));
+                    }
+                    if( cn <= 2 )
+                    {
+                        q0 = _mm_add_epi32(q0, _mm_slli_si128(q0, 8));
+                        q1 = _mm_add_epi32(q1, _mm_slli_si128(q1, 8));
+                    }
+                    q0 = _mm_add_epi32(q0, sqcarry);
+                    q1 = _mm_add_epi32(q1, integralCarry(q0, cn));
+                    sqcarry = integralCarry(q1, cn);
+
+                    __m128d d0 = _mm_cvtepi32_pd(q0), d1 = _mm_cvtepi32_pd(_mm_srli_si128(q0, 8));
+                    __m128d d2 = _mm_cvtepi32_pd(q1), d3 = _mm_cvtepi32_pd(_mm_srli_si128(q1, 8));
+                    if( prevsqsum )
+                    {
+                        d0 = _mm_add_pd(_mm_loadu_pd(prevsqsum + x), d0);
+                        d1 = _mm_add_pd(_mm_loadu_pd(prevsqsum + x + 2), d1);
+                        d2 = _mm_add_pd(_mm_loadu_pd(prevsqsum + x + 4), d2);
+                        d3 = _mm_add_pd(_mm_loadu_pd(prevsqsum + x + 6), d3);
+                    }
+                    _mm_storeu_pd(sqsum + x, d0);
+                    _mm_storeu_pd(sqsum + x + 2, d1);
+                    _mm_storeu_pd(sqsum + x + 4, d2);
+                    _mm_storeu_pd(sqsum + x + 6, d3);
+                }
+            }
+
+            if( x > 0 )
+            {
+                int CV_DECL_ALIGNED(16) buf[4];
+                _mm_store_si128((__m128i*)buf, carry);
+                for( int k = 0; k < cn; k++ )
+                    s[k] = buf[k];
+                _mm_store_si128((__m128i*)buf, sqcarry);
+                for( int k = 0; k < cn; k++ )
+                    sq[k] = buf[k];
+            }
+        }
+#endif
+        for( int k = 0; k < cn; k++ )
+        {
+            int x1 = x + k, sk = s[k];
+            double sqk = sq[k];
+            for( ; x1 < len; x1 += cn )
+            {
+                int it = src[x1];
+                sk += it;
+                sum[x1] = prevsum ? prevsum[x1] + sk : sk;
+                if( sqsum )
+                {
+                    sqk += (double)it*it;
+                    sqsum[x1] = prevsqsum ? prevsqsum[x1] + sqk : sqk;
+                }
+            }
+        }
+    }
+};
+
+// dst[x] = prev[x] + dst[x]
+static void integralAddRow( const int* prev, int* dst, int n )
+{
+    int x = 0;
+#if CV_SSE2
+    if( checkHardwareSupport(CV_CPU_SSE2) )
+        for( ; x <= n - 4; x += 4 )
+            _mm_storeu_si128((__m128i*)(dst + x),
+                _mm_add_epi32(_mm_loadu_si128((const __m128i*)(prev + x)),
+                              _mm_loadu_si128((const __m128i*)(dst + x))));
+#endif
+    for( ; x < n; x++ )
+        dst[x] = prev[x] + dst[x];
+}
+
+static void integralAddRow( const float* prev, float* dst, int n )
+{
+    int x = 0;
+#if CV_SSE2
+    if( checkHardwareSupport(CV_CPU_SSE2) )
+        for( ; x <= n - 4; x += 4 )
+            _mm_storeu_ps(dst + x, _mm_add_ps(_mm_loadu_ps(prev + x), _mm_loadu_ps(dst + x)));
+#endif
+    for( ; x < n; x++ )
+        dst[x] = prev[x] + dst[x];
+}
+
+static void integralAddRow( const double* prev, double* dst, int n )
+{
+    int x = 0;
+#if CV_SSE2
+    if( checkHardwareSupport(CV_CPU_SSE2) )
+        for( ; x <= n - 2; x += 2 )
+            _mm_storeu_pd(dst + x, _mm_add_pd(_mm_loadu_pd(prev + x), _mm_loadu_pd(dst + x)));
+#endif
+    for( ; x < n; x++ )
+        dst[x] = prev[x] + dst[x];
+}
+
+// pass 1: computes the prefix sums of the source rows [range) into the rows [range)+1
+// of the integrals, starting from the column ofs.x of the integral
+template<typename T, typename ST, typename QT> class IntegralRowInvoker
+{
+public:
+    IntegralRowInvoker( const Mat& _src, Mat& _sum, Mat& _sqsum, Point _ofs, bool _accumulate=false )
+        : src(&_src), sum(&_sum), sqsum(&_sqsum), ofs(_ofs), accumulate(_accumulate) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int width = src->cols, cn = src->channels();
+        bool inplace = ofs.x == 1;
+        AutoBuffer<ST> _buf(inplace ? 1 : width*cn);
+        AutoBuffer<QT> _sqbuf(inplace || !sqsum->data ? 1 : width*cn);
+        IntegralRow<T, ST, QT> rowFunc;
+
+        for( int y = range.begin(); y < range.end(); y++ )
+        {
+            ST* srow = sum->ptr<ST>(y + 1);
+            QT* sqrow = sqsum->data ? sqsum->ptr<QT>(y + 1) : 0;
+            // the second pass is done together with the first one, the previous row must be ready
+            const ST* prevrow = accumulate ? sum->ptr<ST>(y) : 0;
+            const QT* prevsqrow = accumulate && sqrow ? sqsum->ptr<QT>(y) : 0;
+
+            if( inplace )
+            {
+                for( int k = 0; k < cn; k++ )
+                {
+                    srow[k] = 0;
+                    if( sqrow )
+                        sqrow[k] = 0;
+                }
+                rowFunc( src->ptr<T>(y), srow + cn, sqrow ? sqrow + cn : 0,
+                         prevrow ? prevrow + cn : 0, prevsqrow ? prevsqrow + cn : 0, width, cn );
+            }
+            else
+            {
+                // the whole prefix is recomputed to get the same rounding, but only
+                // the columns starting from ofs.x are stored
+                int x0 = (ofs.x - 1)*cn, n = width*cn - x0;
+                rowFunc( src->ptr<T>(y), _buf, sqrow ? (QT*)_sqbuf : 0, 0, 0, width, cn );
+                memcpy( srow + x0 + cn, (ST*)_buf + x0, n*sizeof(ST) );
+                if( sqrow )
+                    memcpy( sqrow + x0 + cn, (QT*)_sqbuf + x0, n*sizeof(QT) );
+                if( prevrow )
+                {
+                    integralAddRow( prevrow + x0 + cn, srow + x0 + cn, n );
+                    if( sqrow )
+                        integralAddRow( prevsqrow + x0 + cn, sqrow + x0 + cn, n );
+                }
+            }
+        }
+    }
+
+protected:
+    const Mat* src;
+    Mat* sum;
+    Mat* sqsum;
+    Point ofs;
+    bool accumulate;
+};
+
+// pass 2: accumulates the rows [y0, y1) of the integrals;
+// the range is the range of the matrix elements (not pixels) within a row
+template<typename ST, typename QT> class IntegralColumnInvoker
+{
+public:
+    IntegralColumnInvoker( Mat& _sum, Mat& _sqsum, int _y0, int _y1 )
+        : sum(&_sum), sqsum(&_sqsum), y0(_y0), y1(_y1) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int x = range.begin(), n = range.end() - range.begin();
+        for( int y = y0; y < y1; y++ )
+        {
+            integralAddRow( sum->ptr<ST>(y - 1) + x, sum->ptr<ST>(y) + x, n );
+            if( sqsum->data )
+                integralAddRow( sqsum->ptr<QT>(y - 1) + x, sqsum->ptr<QT>(y) + x, n );
+        }
+    }
+
+protected:
+    Mat* sum;
+    Mat* sqsum;
+    int y0, y1;
+};
+
+// approximate size (in bytes) of the integral rows processed by one pass
+enum { INTEGRAL_BAND_SIZE = 1 << 16 };
+
+// recomputes the integrals in the rectangle [ofs.y, sum.rows) x [ofs.x, sum.cols);
+// the rest of the integrals must be valid
+template<typename T, typename ST, typename QT>
+static void integralParallel_( const Mat& src, Mat& sum, Mat& sqsum, Point ofs )
+{
+    int cn = src.channels(), height = src.rows;
+    int nthreads = std::max(getNumThreads(), 1);
+
+    if( ofs.y == 1 )
+    {
+        memset( sum.ptr(), 0, sum.cols*sum.elemSize() );
+        if( sqsum.data )
+            memset( sqsum.ptr(), 0, sqsum.cols*sqsum.elemSize() );
+    }
+
+    if( nthreads == 1 )
+    {
+        // on a single thread both passes are done row by row
+        IntegralRowInvoker<T, ST, QT>(src, sum, sqsum, ofs, true)( BlockedRange(ofs.y - 1, height) );
+        return;
+    }
+
+    // the passes are done for bands of rows that stay in the cache in between
+    size_t rowSize = sum.cols*sum.elemSize() + (sqsum.data ? sqsum.cols*sqsum.elemSize() : 0);
+    int bandRows = std::max((int)(INTEGRAL_BAND_SIZE/rowSize), 1);
+    // the column blocks are aligned to the cache lines
+    int x0 = ofs.x*cn, x1 = sum.cols*cn;
+    int grain = std::max(((x1 - x0 + nthreads - 1)/nthreads + 15) & -16, 16);
+
+    for( int y = ofs.y - 1; y < height; y += bandRows )
+    {
+        int y1 = std::min(y + bandRows, height);
+        parallel_for( BlockedRange(y, y1, std::max((y1 - y + nthreads - 1)/nthreads, 1)),
+                      IntegralRowInvoker<T, ST, QT>(src, sum, sqsum, ofs) );
+        parallel_for( BlockedRange(x0, x1, grain),
+                      IntegralColumnInvoker<ST, QT>(sum, sqsum, y + 1, y1 + 1) );
+    }
+}
+
+typedef void (*IntegralParallelFunc)( const Mat& src, Mat& sum, Mat& sqsum, Point ofs );
+
+static IntegralParallelFunc getIntegralParallelFunc( int depth, int sdepth )
+{
+    if( depth == CV_8U && sdepth == CV_32S )
+        return integralParallel_<uchar, int, double>;
+    if( depth == CV_8U && sdepth == CV_32F )
+        return integralParallel_<uchar, float, double>;
+    if( depth == CV_8U && sdepth == CV_64F )
+        return integralParallel_<uchar, double, double>;
+    if( depth == CV_32F && sdepth == CV_32F )
+        return integralParallel_<float, float, double>;
+    if( depth == CV_32F && sdepth == CV_64F )
+        return integralParallel_<float, double, double>;
+    if( depth == CV_64F && sdepth == CV_64F )
+        return integralParallel_<double, double, double>;
+    CV_Error( CV_StsUnsupportedFormat, "" );
+    return 0;
+}
+
 }
 
 
@@ -261,6 +613,17 @@ void cv::integral( InputArray _src, OutputArray _sum, OutputArray _sqsum, Output
         sqsum = _sqsum.getMat();
     }
     
+    if( !tilted.data )
+    {
+#ifdef HAVE_TEGRA_OPTIMIZATION
+        if( !(depth == CV_8U && sdepth == CV_32S) )
+#endif
+        {
+            getIntegralParallelFunc( depth, sdepth )( src, sum, sqsum, Point(1, 1) );
+            return;
+        }
+    }
+
     IntegralFunc func = 0;
 
     if( depth == CV_8U && sdepth == CV_32S )
@@ -282,6 +645,26 @@ void cv::integral( InputArray _src, OutputArray _sum, OutputArray _sqsum, Output
           tilted.data, tilted.step, src.size(), cn );
 }
     
+void cv::updateIntegral( InputArray _src, Rect roi, InputOutputArray _sum, InputOutputArray _sqsum )
+{
+    Mat src = _src.getMat(), sum = _sum.getMat(), sqsum;
+    int cn = src.channels();
+    Size isize(src.cols + 1, src.rows + 1);
+
+    CV_Assert( sum.size() == isize && sum.channels() == cn );
+    if( _sqsum.needed() )
+    {
+        sqsum = _sqsum.getMat();
+        CV_Assert( sqsum.size() == isize && sqsum.type() == CV_MAKETYPE(CV_64F, cn) );
+    }
+
+    roi &= Rect(0, 0, src.cols, src.rows);
+    if( roi.area() == 0 )
+        return;
+
+    getIntegralParallelFunc( src.depth(), sum.depth() )( src, sum, sqsum, Point(roi.x + 1, roi.y + 1) );
+}
+
 void cv::integral( InputArray src, OutputArray sum, int sdepth )
 {
     integral( src, sum, noArray(), noArray(), sdepth );
@@ -232,100 +232,110 @@ cv::crossCorr( const Mat& img, const Mat& templ, Mat& corr,
 
 /*****************************************************************************************/
 
-void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result, int method )
+namespace cv
+{
+
+static void
+templateStats( const Mat& templ, int method, Scalar& templMean,
+               double& templNorm, double& templSum2 )
 {
-    CV_Assert( CV_TM_SQDIFF <= method && method <= CV_TM_CCOEFF_NORMED );
-    
     int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
                   method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
-    bool isNormed = method == CV_TM_CCORR_NORMED ||
-                    method == CV_TM_SQDIFF_NORMED ||
-                    method == CV_TM_CCOEFF_NORMED;
-
-    Mat img = _img.getMat(), templ = _templ.getMat();
-    if( img.rows < templ.rows || img.cols < templ.cols )
-        std::swap(img, templ);
-    
-    CV_Assert( (img.depth() == CV_8U || img.depth() == CV_32F) &&
-               img.type() == templ.type() );
+    double invArea = 1./((double)templ.rows * templ.cols);
+    Scalar templSdv;
 
-    Size corrSize(img.cols - templ.cols + 1, img.rows - templ.rows + 1);
-    _result.create(corrSize, CV_32F);
-    Mat result = _result.getMat();
-    
-    int cn = img.channels();
-    crossCorr( img, templ, result, result.size(), result.type(), Point(0,0), 0, 0);
+    templMean = Scalar::all(0);
+    templNorm = templSum2 = 0;
 
     if( method == CV_TM_CCORR )
         return;
 
-    double invArea = 1./((double)templ.rows * templ.cols);
-
-    Mat sum, sqsum;
-    Scalar templMean, templSdv;
-    double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
-    double templNorm = 0, templSum2 = 0;
-    
     if( method == CV_TM_CCOEFF )
     {
-        integral(img, sum, CV_64F);
         templMean = mean(templ);
+        return;
     }
-    else
+
+    meanStdDev( templ, templMean, templSdv );
+
+    templNorm = CV_SQR(templSdv[0]) + CV_SQR(templSdv[1]) +
+                CV_SQR(templSdv[2]) + CV_SQR(templSdv[3]);
+
+    // the zero norm marks the flat template, the result is all 1's then
+    if( templNorm < DBL_EPSILON && method == CV_TM_CCOEFF_NORMED )
     {
-        integral(img, sum, sqsum, CV_64F);
-        meanStdDev( templ, templMean, templSdv );
+        templNorm = 0;
+        return;
+    }
 
-        templNorm = CV_SQR(templSdv[0]) + CV_SQR(templSdv[1]) +
-                    CV_SQR(templSdv[2]) + CV_SQR(templSdv[3]);
+    templSum2 = templNorm +
+                 CV_SQR(templMean[0]) + CV_SQR(templMean[1]) +
+                 CV_SQR(templMean[2]) + CV_SQR(templMean[3]);
 
-        if( templNorm < DBL_EPSILON && method == CV_TM_CCOEFF_NORMED )
-        {
-            result = Scalar::all(1);
-            return;
-        }
-        
-        templSum2 = templNorm +
-                     CV_SQR(templMean[0]) + CV_SQR(templMean[1]) +
-                     CV_SQR(templMean[2]) + CV_SQR(templMean[3]);
+    if( numType != 1 )
+    {
+        templMean = Scalar::all(0);
+        templNorm = templSum2;
+    }
 
-        if( numType != 1 )
-        {
-            templMean = Scalar::all(0);
-            templNorm = templSum2;
-        }
-        
-        templSum2 /= invArea;
-        templNorm = sqrt(templNorm);
-        templNorm /= sqrt(invArea); // care of accuracy here
+    templSum2 /= invArea;
+    templNorm = sqrt(templNorm);
+    templNorm /= sqrt(invArea); // care of accuracy here
+}
+
+/* turns the cross-correlation in the block r of result into the requested measure */
+static void
+normalizeTemplateBlock( Mat& result, Rect r, const Mat& sum, const Mat& sqsum,
+                        Size templSize, int cn, int method, const Scalar& templMean,
+                        double templNorm, double templSum2 )
+{
+    int numType = method == CV_TM_CCORR || method == CV_TM_CCORR_NORMED ? 0 :
+                  method == CV_TM_CCOEFF || method == CV_TM_CCOEFF_NORMED ? 1 : 2;
+    bool isNormed = method == CV_TM_CCORR_NORMED ||
+                    method == CV_TM_SQDIFF_NORMED ||
+                    method == CV_TM_CCOEFF_NORMED;
 
+    if( method == CV_TM_CCORR )
+        return;
+
+    if( method == CV_TM_CCOEFF_NORMED && templNorm == 0 )
+    {
+        result(r) = Scalar::all(1);
+        return;
+    }
+
+    double invArea = 1./((double)templSize.height * templSize.width);
+    double *q0 = 0, *q1 = 0, *q2 = 0, *q3 = 0;
+
+    if( sqsum.data )
+    {
         q0 = (double*)sqsum.data;
-        q1 = q0 + templ.cols*cn;
-        q2 = (double*)(sqsum.data + templ.rows*sqsum.step);
-        q3 = q2 + templ.cols*cn;
+        q1 = q0 + templSize.width*cn;
+        q2 = (double*)(sqsum.data + templSize.height*sqsum.step);
+        q3 = q2 + templSize.width*cn;
     }
 
     double* p0 = (double*)sum.data;
-    double* p1 = p0 + templ.cols*cn;
-    double* p2 = (double*)(sum.data + templ.rows*sum.step);
-    double* p3 = p2 + templ.cols*cn;
+    double* p1 = p0 + templSize.width*cn;
+    double* p2 = (double*)(sum.data + templSize.height*sum.step);
+    double* p3 = p2 + templSize.width*cn;
 
     int sumstep = sum.data ? (int)(sum.step / sizeof(double)) : 0;
     int sqstep = sqsum.data ? (int)(sqsum.step / sizeof(double)) : 0;
 
     int i, j, k;
-    
-    for( i = 0; i < result.rows; i++ )
+
+    for( i = r.y; i < r.y + r.height; i++ )
     {
         float* rrow = (float*)(result.data + i*result.step);
-        int idx = i * sumstep;
-        int idx2 = i * sqstep;
+        int idx = i * sumstep + r.x * cn;
+        int idx2 = i * sqstep + r.x * cn;
 
-        for( j = 0; j < result.cols; j++, idx += cn, idx2 += cn )
+        for( j = r.x; j < r.x + r.width; j++, idx += cn, idx2 += cn )
         {
             double num = rrow[j], t;
             double wndMean2 = 0, wndSum2 = 0;
-            
+
             if( numType == 1 )
             {
                 for( k = 0; k < cn; k++ )
@@ -366,6 +376,322 @@ void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result,
     }
 }
 
+/*
+   Computes the blocks of the proximity maps for the groups of the same size templates.
+   The task (g, i) computes the i-th block of all the templates of the g-th group:
+   the image block spectrum is computed once and multiplied by every template spectrum,
+   the same way as crossCorr() does it.
+*/
+class TemplateMatchInvoker
+{
+public:
+    TemplateMatchInvoker( const Mat& _image, const vector<Vec2i>& _tasks,
+                          const vector<vector<int> >& _groups, const vector<int>& _idx,
+                          const vector<Mat>& _templs, const vector<Mat>& _spectra,
+                          const vector<Size>& _blockSizes, const vector<Size>& _dftSizes,
+                          const vector<Scalar>& _templMean, const vector<double>& _templNorm,
+                          const vector<double>& _templSum2, const Mat& _sum, const Mat& _sqsum,
+                          int _method, Mat* _results )
+        : image(&_image), tasks(&_tasks), groups(&_groups), idx(&_idx), templs(&_templs),
+          spectra(&_spectra), blockSizes(&_blockSizes), dftSizes(&_dftSizes),
+          templMean(&_templMean), templNorm(&_templNorm), templSum2(&_templSum2),
+          sum(&_sum), sqsum(&_sqsum), method(_method), results(_results) {}
+
+    void operator()( const BlockedRange& range ) const
+    {
+        int depth = image->depth(), cn = image->channels();
+        Mat imgSpec, corrBuf, plane, cplane;
+
+        for( int t = range.begin(); t < range.end(); t++ )
+        {
+            const vector<int>& group = (*groups)[(*tasks)[t][0]];
+            int tile = (*tasks)[t][1], lead = (*idx)[group[0]];
+            const Mat& templ = (*templs)[lead];
+            Size blocksize = (*blockSizes)[lead], dftsize = (*dftSizes)[lead];
+            Size corrsize(image->cols - templ.cols + 1, image->rows - templ.rows + 1);
+            int maxDepth = (*spectra)[lead].depth();
+            int tileCountX = (corrsize.width + blocksize.width - 1)/blocksize.width;
+            int x = (tile%tileCountX)*blocksize.width;
+            int y = (tile/tileCountX)*blocksize.height;
+            Size bsz(std::min(blocksize.width, corrsize.width - x),
+                     std::min(blocksize.height, corrsize.height - y));
+            Size dsz(bsz.width + templ.cols - 1, bsz.height + templ.rows - 1);
+            Mat src0(*image, Rect(x, y, dsz.width, dsz.height));
+            int k;
+
+            imgSpec.create(dftsize.height*cn, dftsize.width, maxDepth);
+            for( k = 0; k < cn; k++ )
+            {
+                Mat dftImg(imgSpec, Rect(0, k*dftsize.height, dftsize.width, dftsize.height));
+                Mat dst1(dftImg, Rect(0, 0, dsz.width, dsz.height));
+                dftImg = Scalar::all(0);
+
+                if( cn > 1 )
+                {
+                    plane.create(dsz, depth);
+                    int pairs[] = {k, 0};
+                    mixChannels(&src0, 1, &plane, 1, pairs, 1);
+                    plane.convertTo(dst1, maxDepth);
+                }
+                else
+                    src0.convertTo(dst1, maxDepth);
+
+                dft( dftImg, dftImg, 0, dsz.height );
+            }
+
+            for( size_t m = 0; m < group.size(); m++ )
+            {
+                int i = group[m], ti = (*idx)[i];
+                const Mat& dftTempl = (*spectra)[ti];
+                Mat cdst(results[i], Rect(x, y, bsz.width, bsz.height));
+
+                for( k = 0; k < cn; k++ )
+                {
+                    Mat dftImg(imgSpec, Rect(0, k*dftsize.height, dftsize.width, dftsize.height));
+                    Mat dftTempl1(dftTempl, Rect(0, k*dftsize.height, dftsize.width, dftsize.height));
+                    mulSpectrums(dftImg, dftTempl1, corrBuf, 0, true);
+                    dft( corrBuf, corrBuf, DFT_INVERSE + DFT_SCALE, bsz.height );
+
+                    Mat src = corrBuf(Rect(0, 0, bsz.width, bsz.height));
+                    if( k == 0 )
+                        src.convertTo(cdst, CV_32F);
+                    else
+                    {
+                        if( maxDepth != CV_32F )
+                        {
+                            src.convertTo(cplane, CV_32F);
+                            src = cplane;
+                        }
+                        add(src, cdst, cdst);
+                    }
+                }
+
+                normalizeTemplateBlock( results[i], Rect(x, y, bsz.width, bsz.height),
+                                        *sum, *sqsum, templ.size(), cn, method,
+                                        (*templMean)[ti], (*templNorm)[ti], (*templSum2)[ti] );
+            }
+        }
+    }
+
+protected:
+    const Mat* image;
+    const vector<Vec2i>* tasks;
+    const vector<vector<int> >* groups;
+    const vector<int>* idx;
+    const vector<Mat>* templs;
+    const vector<Mat>* spectra;
+    const vector<Size>* blockSizes;
+    const vector<Size>* dftSizes;
+    const vector<Scalar>* templMean;
+    const vector<double>* templNorm;
+    const vector<double>* templSum2;
+    const Mat* sum;
+    const Mat* sqsum;
+    int method;
+    Mat* results;
+};
+
+}
+
+cv::TemplateMatcher::TemplateMatcher() : method(CV_TM_CCORR)
+{
+}
+
+cv::TemplateMatcher::TemplateMatcher( InputArrayOfArrays _templs, int _method ) : method(CV_TM_CCORR)
+{
+    create(_templs, _method);
+}
+
+void cv::TemplateMatcher::create( InputArrayOfArrays _templs, int _method )
+{
+    CV_Assert( CV_TM_SQDIFF <= _method && _method <= CV_TM_CCOEFF_NORMED );
+
+    int i, n = (int)_templs.total();
+    method = _method;
+    templs.resize(n);
+    templMean.resize(n);
+    templNorm.resize(n);
+    templSum2.resize(n);
+
+    for( i = 0; i < n; i++ )
+    {
+        _templs.getMat(i).copyTo(templs[i]);
+        const Mat& templ = templs[i];
+        CV_Assert( templ.dims <= 2 && !templ.empty() &&
+                   (templ.depth() == CV_8U || templ.depth() == CV_32F) &&
+                   templ.type() == templs[0].type() );
+        templateStats( templ, method, templMean[i], templNorm[i], templSum2[i] );
+    }
+
+    imageSize = Size();
+    spectra.resize(n);
+    blockSizes.resize(n);
+    dftSizes.resize(n);
+}
+
+int cv::TemplateMatcher::size() const
+{
+    return (int)templs.size();
+}
+
+/* computes the block sizes and the template spectra, the same way as crossCorr() does */
+void cv::TemplateMatcher::prepare( Size imgsize )
+{
+    const double blockScale = 4.5;
+    const int minBlockSize = 256;
+
+    if( imgsize == imageSize )
+        return;
+
+    Mat buf;
+    for( size_t i = 0; i < templs.size(); i++ )
+    {
+        const Mat& templ = templs[i];
+        int tdepth = templ.depth(), tcn = templ.channels();
+        int maxDepth = tdepth > CV_8U ? CV_64F : CV_32F;
+        Size corrsize(imgsize.width - templ.cols + 1, imgsize.height - templ.rows + 1);
+        Size blocksize, dftsize;
+
+        CV_Assert( corrsize.width > 0 && corrsize.height > 0 );
+
+        blocksize.width = cvRound(templ.cols*blockScale);
+        blocksize.width = std::max( blocksize.width, minBlockSize - templ.cols + 1 );
+        blocksize.width = std::min( blocksize.width, corrsize.width );
+        blocksize.height = cvRound(templ.rows*blockScale);
+        blocksize.height = std::max( blocksize.height, minBlockSize - templ.rows + 1 );
+        blocksize.height = std::min( blocksize.height, corrsize.height );
+
+        dftsize.width = std::max(getOptimalDFTSize(blocksize.width + templ.cols - 1), 2);
+        dftsize.height = getOptimalDFTSize(blocksize.height + templ.rows - 1);
+        if( dftsize.width <= 0 || dftsize.height <= 0 )
+            CV_Error( CV_StsOutOfRange, "the input arrays are too big" );
+
+        // recompute block size
+        blocksize.width = dftsize.width - templ.cols + 1;
+        blocksize.width = MIN( blocksize.width, corrsize.width );
+        blocksize.height = dftsize.height - templ.rows + 1;
+        blocksize.height = MIN( blocksize.height, corrsize.height );
+
+        blockSizes[i] = blocksize;
+        dftSizes[i] = dftsize;
+
+        // compute DFT of each template plane
+        Mat& dftTempl = spectra[i];
+        dftTempl.create( dftsize.height*tcn, dftsize.width, maxDepth );
+        for( int k = 0; k < tcn; k++ )
+        {
+            Mat src = templ;
+            Mat dst(dftTempl, Rect(0, k*dftsize.height, dftsize.width, dftsize.height));
+            Mat dst1(dftTempl, Rect(0, k*dftsize.height, templ.cols, templ.rows));
+
+            if( tcn > 1 )
+            {
+                buf.create(templ.size(), tdepth);
+                src = buf;
+                int pairs[] = {k, 0};
+                mixChannels(&templ, 1, &src, 1, pairs, 1);
+            }
+
+            src.convertTo(dst1, maxDepth);
+
+            if( dst.cols > templ.cols )
+            {
+                Mat part(dst, Range(0, templ.rows), Range(templ.cols, dst.cols));
+                part = Scalar::all(0);
+            }
+            dft(dst, dst, 0, templ.rows);
+        }
+    }
+
+    imageSize = imgsize;
+}
+
+void cv::TemplateMatcher::process( const Mat& img, const vector<int>& idx, Mat* results )
+{
+    int i, j, n = (int)idx.size();
+    if( n == 0 )
+        return;
+
+    CV_Assert( img.dims <= 2 && img.type() == templs[0].type() );
+    prepare( img.size() );
+
+    for( i = 0; i < n; i++ )
+    {
+        const Mat& templ = templs[idx[i]];
+        results[i].create(img.rows - templ.rows + 1, img.cols - templ.cols + 1, CV_32F);
+    }
+
+    if( method == CV_TM_CCOEFF )
+        integral(img, sum, CV_64F);
+    else if( method != CV_TM_CCORR )
+        integral(img, sum, sqsum, CV_64F);
+
+    // the templates of the same size share the block layout and the image block spectra
+    vector<vector<int> > groups;
+    for( i = 0; i < n; i++ )
+    {
+        Size tsize = templs[idx[i]].size();
+        for( j = 0; j < (int)groups.size(); j++ )
+            if( templs[idx[groups[j][0]]].size() == tsize )
+                break;
+        if( j == (int)groups.size() )
+            groups.push_back(vector<int>());
+        groups[j].push_back(i);
+    }
+
+    vector<Vec2i> tasks;
+    for( j = 0; j < (int)groups.size(); j++ )
+    {
+        int lead = idx[groups[j][0]];
+        Size corrsize = results[groups[j][0]].size(), blocksize = blockSizes[lead];
+        int tileCount = ((corrsize.width + blocksize.width - 1)/blocksize.width)*
+                        ((corrsize.height + blocksize.height - 1)/blocksize.height);
+        for( i = 0; i < tileCount; i++ )
+            tasks.push_back(Vec2i(j, i));
+    }
+
+    parallel_for( BlockedRange(0, (int)tasks.size()),
+                  TemplateMatchInvoker(img, tasks, groups, idx, templs, spectra,
+                                       blockSizes, dftSizes, templMean, templNorm,
+                                       templSum2, sum, sqsum, method, results) );
+}
+
+void cv::TemplateMatcher::match( InputArray _image, vector<Mat>& results )
+{
+    Mat image = _image.getMat();
+    int n = size();
+    vector<int> idx(n);
+    for( int i = 0; i < n; i++ )
+        idx[i] = i;
+    results.resize(n);
+    if( n > 0 )
+        process( image, idx, &results[0] );
+}
+
+void cv::TemplateMatcher::match( InputArray _image, int idx, OutputArray _result )
+{
+    CV_Assert( 0 <= idx && idx < size() );
+    Mat image = _image.getMat();
+    const Mat& templ = templs[idx];
+    _result.create(image.rows - templ.rows + 1, image.cols - templ.cols + 1, CV_32F);
+    Mat result = _result.getMat();
+    process( image, vector<int>(1, idx), &result );
+}
+
+void cv::matchTemplate( InputArray _img, InputArray _templ, OutputArray _result, int method )
+{
+    CV_Assert( CV_TM_SQDIFF <= method && method <= CV_TM_CCOEFF_NORMED );
+
+    Mat img = _img.getMat(), templ = _templ.getMat();
+    if( img.rows < templ.rows || img.cols < templ.cols )
+        std::swap(img, templ);
+
+    CV_Assert( (img.depth() == CV_8U || img.depth() == CV_32F) &&
+               img.type() == templ.type() );
+
+    TemplateMatcher matcher(vector<Mat>(1, templ), method);
+    matcher.match(img, 0, _result);
+}
 
 CV_IMPL void
 cvMatchTemplate( const CvArr* _img, const CvArr* _templ, CvArr* _result, int method )
@@ -284,4 +284,28 @@ int CV_CannyTest::validate_test_results( int test_case_idx )
 
 TEST(Imgproc_Canny, accuracy) { CV_CannyTest test; test.safe_run(); }
 
+TEST(Imgproc_Canny, result_does_not_depend_on_threads)
+{
+    Mat img(480, 640, CV_8UC1);
+    RNG rng(3);
+    rng.fill(img, RNG::UNIFORM, Scalar::all(0), Scalar::all(256));
+    GaussianBlur(img, img, Size(7, 7), 2);
+    for( int i = 0; i < 10; i++ )
+        line(img, Point(rng.uniform(0, img.cols), 0), Point(rng.uniform(0, img.cols), img.rows - 1),
+             Scalar::all(rng.uniform(0, 256)), 3);
+
+    cvtest::ThreadsGuard threadsGuard;
+    for( int L2 = 0; L2 < 2; L2++ )
+    {
+        Mat edges[2];
+        for( int k = 0; k < 2; k++ )
+        {
+            setNumThreads(k == 0 ? 1 : 8);
+            Canny(img, edges[k], 10, 60, 3, L2 != 0);
+        }
+        ASSERT_LT(0, countNonZero(edges[0]));
+        EXPECT_EQ(0, norm(edges[0], edges[1], NORM_INF));
+    }
+}
+
 /* End of file. */
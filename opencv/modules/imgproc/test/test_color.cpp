@@ -1669,3 +1669,106 @@ TEST(Imgproc_ColorLab, accuracy) { CV_ColorLabTest test; test.safe_run(); }
 TEST(Imgproc_ColorLuv, accuracy) { CV_ColorLuvTest test; test.safe_run(); }
 TEST(Imgproc_ColorRGB, accuracy) { CV_ColorRGBTest test; test.safe_run(); }
 TEST(Imgproc_ColorBayer, accuracy) { CV_ColorBayerTest test; test.safe_run(); }
+
+TEST(Imgproc_CvtColorResize, matches_separate_steps)
+{
+    RNG& rng = theRNG();
+    Mat bgr(241, 322, CV_8UC3), bayer(241, 322, CV_8UC1), yuv(240*3/2, 322, CV_8UC1);
+    rng.fill(bgr, RNG::UNIFORM, 0, 256);
+    rng.fill(bayer, RNG::UNIFORM, 0, 256);
+    rng.fill(yuv, RNG::UNIFORM, 0, 256);
+    GaussianBlur(bayer, bayer, Size(5, 5), 2);
+
+    const struct { const Mat* src; int code; } cases[] =
+    {
+        { &bayer, CV_BayerBG2BGR }, { &bayer, CV_BayerGR2BGR }, { &bayer, CV_BayerGB2BGR_VNG },
+        { &bayer, CV_BayerRG2GRAY }, { &yuv, CV_YUV420sp2BGR }, { &yuv, CV_YUV420i2RGBA },
+        { &bgr, CV_BGR2GRAY }, { &bgr, CV_BGR2HSV }
+    };
+    const int interps[] = { INTER_NEAREST, INTER_LINEAR, INTER_AREA };
+    const double scales[] = { 0.3, 0.5, 0.77, 1.6 };
+
+    for( int i = 0; i < (int)(sizeof(cases)/sizeof(cases[0])); i++ )
+    {
+        const Mat& src = *cases[i].src;
+        int code = cases[i].code;
+        Mat ref, dst;
+
+        // without resizing the rows must come out exactly as from cvtColor
+        cvtColor(src, ref, code);
+        cvtColorResize(src, dst, code, ref.size(), INTER_NEAREST, -1);
+        ASSERT_EQ(ref.type(), dst.type());
+        ASSERT_EQ(0, norm(ref, dst, NORM_INF)) << "code " << code;
+
+        for( int j = 0; j < 3; j++ )
+            for( int k = 0; k < 4; k++ )
+            {
+                Size dsize(cvRound(ref.cols*scales[k]), cvRound(ref.rows*scales[k]));
+                Mat small, expected;
+                resize(ref, small, dsize, 0, 0, interps[j]);
+                small.convertTo(expected, CV_32F, 1./255, -0.5);
+                cvtColorResize(src, dst, code, dsize, interps[j], CV_32F, 1./255, -0.5);
+
+                // the fused pass interpolates in floating point instead of rounding to 8 bits
+                ASSERT_LE(norm(expected, dst, NORM_INF), 1.01/255)
+                    << "code " << code << ", interpolation " << interps[j] << ", scale " << scales[k];
+            }
+    }
+
+    // YUV420 to gray is the luma plane
+    Mat luma;
+    cvtColorResize(yuv, luma, CV_YUV420sp2BGR, Size(322, 240), INTER_NEAREST, -1, 1, 0, 1);
+    ASSERT_EQ(0, norm(luma, yuv.rowRange(0, 240), NORM_INF));
+}
+
+TEST(Imgproc_CvtColor, parallel_bands_match_serial_result)
+{
+    RNG rng(20120803);
+    enum { D8U = 1, D16U = 2, D32F = 4 };
+    const struct { int code, scn, depths; } cases[] =
+    {
+        { CV_BayerBG2BGR, 1, D8U|D16U }, { CV_BayerGB2BGR, 1, D8U|D16U },
+        { CV_BayerRG2BGR, 1, D8U|D16U }, { CV_BayerGR2BGR, 1, D8U|D16U },
+        { CV_BayerBG2GRAY, 1, D8U|D16U }, { CV_BayerGR2GRAY, 1, D8U|D16U },
+        // the VNG demosaicing is only implemented for 8-bit images
+        { CV_BayerBG2BGR_VNG, 1, D8U }, { CV_BayerGB2BGR_VNG, 1, D8U },
+        { CV_BayerRG2BGR_VNG, 1, D8U }, { CV_BayerGR2BGR_VNG, 1, D8U },
+        { CV_BGR2HSV, 3, D8U|D32F }, { CV_RGB2HSV_FULL, 3, D8U|D32F }, { CV_HSV2BGR, 3, D8U|D32F },
+        { CV_BGR2Lab, 3, D8U|D32F }, { CV_Lab2RGB, 3, D8U|D32F },
+        { CV_BGR2Luv, 3, D8U|D32F }, { CV_Luv2BGR, 3, D8U|D32F },
+        { CV_BGR2GRAY, 3, D8U|D16U|D32F }, { CV_RGBA2GRAY, 4, D8U|D16U|D32F },
+        { CV_GRAY2BGR, 1, D8U|D16U|D32F },
+        { CV_BGR2YCrCb, 3, D8U|D16U|D32F }, { CV_YCrCb2RGB, 3, D8U|D16U|D32F }
+    };
+    const int depths[] = { CV_8U, CV_16U, CV_32F };
+    // the images are split into bands of 32768/width rows; none of the heights is a multiple of it
+    const Size sizes[] = { Size(333, 1001), Size(1017, 259) };
+
+    cvtest::ThreadsGuard threadsGuard;
+    for( int i = 0; i < (int)(sizeof(cases)/sizeof(cases[0])); i++ )
+        for( int d = 0; d < 3; d++ )
+        {
+            if( !(cases[i].depths & (1 << d)) )
+                continue;
+            for( int k = 0; k < 2; k++ )
+            {
+                int type = CV_MAKETYPE(depths[d], cases[i].scn);
+                // the second source is not continuous, so it is converted row by row
+                Mat src = k == 0 ? Mat(sizes[k], type) :
+                    Mat(sizes[k].height + 3, sizes[k].width + 5, type)(Rect(Point(2, 1), sizes[k]));
+                rng.fill(src, RNG::UNIFORM, Scalar::all(0), Scalar::all(depths[d] == CV_8U ? 256 :
+                                                                       depths[d] == CV_16U ? 65536 : 1));
+                GaussianBlur(src, src, Size(5, 5), 1.5);
+
+                Mat ref, dst;
+                setNumThreads(1);
+                cvtColor(src, ref, cases[i].code);
+                setNumThreads(4);
+                cvtColor(src, dst, cases[i].code);
+
+                ASSERT_EQ(ref.type(), dst.type());
+                EXPECT_EQ(0, norm(ref, dst, NORM_INF)) << "code " << cases[i].code << ", depth " << depths[d]
+                    << ", size " << src.cols << "x" << src.rows;
+            }
+        }
+}
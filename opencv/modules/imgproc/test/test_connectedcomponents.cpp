@@ -0,0 +1,116 @@
+/*M///////////////////////////////////////////////////////////////////////////////////////
+//
+//  IMPORTANT: READ BEFORE DOWNLOADING, COPYING, INSTALLING OR USING.
+//
+//  By downloading, copying, installing or using the software you agree to this license.
+//  If you do not agree to this license, do not download, install,
+//  copy or use the software.
+//
+//
+//                        Intel License Agreement
+//                For Open Source Computer Vision Library
+//
+// Copyright (C) 2000, Intel Corporation, all rights reserved.
+// Third party copyrights are property of their respective owners.
+//
+// Redistribution and use in source and binary forms, with or without modification,
+// are permitted provided that the following conditions are met:
+//
+//   * Redistribution's of source code must retain the above copyright notice,
+//     this list of conditions and the following disclaimer.
+//
+//   * Redistribution's in binary form must reproduce the above copyright notice,
+//     this list of conditions and the following disclaimer in the documentation
+//     and/or other materials provided with the distribution.
+//
+//   * The name of Intel Corporation may not be used to endorse or promote products
+//     derived from this software without specific prior written permission.
+//
+// This software is provided by the copyright holders and contributors "as is" and
+// any express or implied warranties, including, but not limited to, the implied
+// warranties of merchantability and fitness for a particular purpose are disclaimed.
+// In no event shall the Intel Corporation or contributors be liable for any direct,
+// indirect, incidental, special, exemplary, or consequential damages
+// (including, but not limited to, procurement of substitute goods or services;
+// loss of use, data, or profits; or business interruption) however caused
+// and on any theory of liability, whether in contract, strict liability,
+// or tort (including negligence or otherwise) arising in any way out of
+// the use of this software, even if advised of the possibility of such damage.
+//
+//M*/
+
+
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+// labels the components one by one with floodFill in the raster order of their first pixels
+static int referenceComponents( const Mat& img, Mat& labels, int connectivity )
+{
+    Mat work = img.clone();
+    labels = Mat::zeros(img.size(), CV_32S);
+    int nlabels = 1;
+
+    for( int y = 0; y < img.rows; y++ )
+        for( int x = 0; x < img.cols; x++ )
+            if( work.at<uchar>(y, x) )
+            {
+                Rect r;
+                floodFill(work, Point(x, y), Scalar::all(0), &r, Scalar(), Scalar(), connectivity);
+                // the filled pixels are the unlabeled foreground pixels that became 0
+                Mat filled = (work(r) == 0) & (img(r) != 0) & (labels(r) == 0);
+                labels(r).setTo(Scalar::all(nlabels++), filled);
+            }
+    return nlabels;
+}
+
+TEST(Imgproc_ConnectedComponents, matches_floodfill)
+{
+    RNG& rng = theRNG();
+
+    for( int k = 0; k < 4; k++ )
+    {
+        int connectivity = k % 2 ? 4 : 8;
+        Mat noise(700 + k, 1100 - k*3, CV_8U), img;
+        rng.fill(noise, RNG::UNIFORM, 0, 256);
+        if( k < 2 )
+            GaussianBlur(noise, noise, Size(9, 9), 3);
+        threshold(noise, img, k < 2 ? 130 : 160, 255, THRESH_BINARY);
+
+        Mat ref, labels, labels16, stats, centroids;
+        int nref = referenceComponents(img, ref, connectivity);
+        int n = connectedComponentsWithStats(img, labels, stats, centroids, connectivity);
+
+        ASSERT_EQ(nref, n);
+        ASSERT_EQ(0, norm(ref, labels, NORM_INF)) << "connectivity " << connectivity;
+        if( n <= 65536 )
+        {
+            ASSERT_EQ(n, connectedComponents(img, labels16, connectivity, CV_16U));
+            ASSERT_EQ(CV_16U, labels16.type());
+            labels16.convertTo(labels, CV_32S);
+            ASSERT_EQ(0, norm(ref, labels, NORM_INF));
+        }
+
+        ASSERT_EQ(n, stats.rows);
+        ASSERT_EQ(n, centroids.rows);
+        vector<Rect> boxes(n);
+        vector<Point2d> sums(n);
+        vector<int> areas(n, 0);
+        for( int y = 0; y < ref.rows; y++ )
+            for( int x = 0; x < ref.cols; x++ )
+            {
+                int l = ref.at<int>(y, x);
+                boxes[l] = areas[l]++ ? boxes[l] | Rect(x, y, 1, 1) : Rect(x, y, 1, 1);
+                sums[l] += Point2d(x, y);
+            }
+        for( int l = 0; l < n; l++ )
+        {
+            const int* st = stats.ptr<int>(l);
+            ASSERT_EQ(boxes[l], Rect(st[CC_STAT_LEFT], st[CC_STAT_TOP], st[CC_STAT_WIDTH], st[CC_STAT_HEIGHT]));
+            ASSERT_EQ(areas[l], st[CC_STAT_AREA]);
+            ASSERT_NEAR(sums[l].x/areas[l], centroids.at<double>(l, 0), 1e-6);
+            ASSERT_NEAR(sums[l].y/areas[l], centroids.at<double>(l, 1), 1e-6);
+        }
+    }
+}
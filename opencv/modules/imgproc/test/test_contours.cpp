@@ -390,4 +390,65 @@ _exit_:
 
 TEST(Imgproc_FindContours, accuracy) { CV_FindContourTest test; test.safe_run(); }
 
+TEST(Imgproc_FindContours, flat_buffer_matches_vectors)
+{
+    RNG& rng = theRNG();
+    ContourBuffer buf;
+
+    for( int iter = 0; iter < 30; iter++ )
+    {
+        Size sz(rng.uniform(3, 200), rng.uniform(3, 200));
+        Mat img(sz, CV_8U, Scalar::all(0));
+        for( int k = 0; k < 30; k++ )
+            circle(img, Point(rng.uniform(0, sz.width), rng.uniform(0, sz.height)),
+                   rng.uniform(1, 40), Scalar::all(k % 3 ? 255 : 0), rng.uniform(-1, 3));
+
+        for( int mode = RETR_EXTERNAL; mode <= RETR_TREE; mode++ )
+            for( int method = CHAIN_APPROX_NONE; method <= CHAIN_APPROX_SIMPLE; method++ )
+            {
+                Point offset(rng.uniform(-3, 3), rng.uniform(-3, 3));
+                Mat img1 = img.clone(), img2 = img.clone();
+                vector<vector<Point> > contours;
+                vector<Vec4i> hierarchy;
+
+                findContours(img1, contours, hierarchy, mode, method, offset);
+                findContours(img2, buf, mode, method, offset);
+
+                ASSERT_EQ(0, norm(img1, img2, NORM_INF));
+                int n = buf.size();
+                ASSERT_EQ(contours.size(), (size_t)n);
+                ASSERT_EQ(n + 1, (int)buf.offsets.size());
+                ASSERT_EQ(buf.points.size(), (size_t)buf.offsets[n]);
+
+                // the contours go in a different order; match them by the points
+                vector<int> idx(n, -1);
+                for( int i = 0; i < n; i++ )
+                {
+                    for( int j = 0; j < n && idx[i] < 0; j++ )
+                        if( (int)contours[j].size() == buf.count(i) &&
+                            std::equal(contours[j].begin(), contours[j].end(), buf.contour(i)) )
+                            idx[i] = j;
+                    ASSERT_GE(idx[i], 0);
+                }
+
+                for( int i = 0; i < n; i++ )
+                {
+                    const Vec4i& h = buf.hierarchy[i];
+                    int parent = hierarchy[idx[i]][3];
+                    EXPECT_EQ(h[3] < 0 ? -1 : idx[h[3]], parent);
+
+                    // the same children, listed in the opposite order
+                    int child = h[2], last = -1;
+                    for( ; child >= 0; child = buf.hierarchy[child][0] )
+                    {
+                        EXPECT_EQ(i, buf.hierarchy[child][3]);
+                        EXPECT_EQ(last, buf.hierarchy[child][1]);
+                        last = child;
+                    }
+                    EXPECT_EQ(last < 0 ? -1 : idx[last], hierarchy[idx[i]][2]);
+                }
+            }
+    }
+}
+
 /* End of file. */
@@ -1838,5 +1838,42 @@ TEST(Imgproc_Hist_MinMaxVal, accuracy) { CV_MinMaxHistTest test; test.safe_run()
 TEST(Imgproc_Hist_CalcBackProject, accuracy) { CV_CalcBackProjectTest test; test.safe_run(); }
 TEST(Imgproc_Hist_CalcBackProjectPatch, accuracy) { CV_CalcBackProjectPatchTest test; test.safe_run(); }
 TEST(Imgproc_Hist_BayesianProb, accuracy) { CV_BayesianProbTest test; test.safe_run(); }
+
+// the large images are processed in parallel chunks; the result must match the row-by-row accumulation
+TEST(Imgproc_Hist_Calc, parallel_matches_rowwise)
+{
+    RNG& rng = theRNG();
+    int channels[] = {2, 0, 1};
+    float r[] = {0, 256};
+    const float* ranges[] = {r, r, r};
+
+    for( int k = 0; k < 6; k++ )
+    {
+        int dims = k % 3 + 1, histSize[] = {16, k < 3 ? 32 : 30, 8};
+        Mat big(600, 900, CV_8UC3), mask;
+        rng.fill(big, RNG::UNIFORM, 0, 256);
+        big(Rect(0, 0, 300, 200)).setTo(Scalar::all(7));
+        Mat img = big(Rect(1, 2, 850, 590));
+        if( k >= 3 )
+        {
+            mask.create(img.size(), CV_8U);
+            rng.fill(mask, RNG::UNIFORM, 0, 2);
+        }
+
+        Mat hist, ref, bp, bpref(img.size(), CV_8U);
+        calcHist(&img, 1, channels, mask, hist, dims, histSize, ranges);
+        calcBackProject(&img, 1, channels, hist, bp, ranges, 0.01);
+        for( int y = 0; y < img.rows; y++ )
+        {
+            Mat row = img.row(y), bprow = bpref.row(y);
+            calcHist(&row, 1, channels, mask.empty() ? Mat() : mask.row(y), ref,
+                     dims, histSize, ranges, true, y > 0);
+            calcBackProject(&row, 1, channels, hist, bprow, ranges, 0.01);
+        }
+
+        ASSERT_EQ(0., norm(hist, ref, NORM_INF)) << "dims=" << dims;
+        ASSERT_EQ(0., norm(bp, bpref, NORM_INF)) << "dims=" << dims;
+    }
+}
  
 /* End Of File */
@@ -0,0 +1,55 @@
+#include "test_precomp.hpp"
+
+using namespace cv;
+using namespace std;
+
+TEST(Imgproc_HoughLines, result_does_not_depend_on_threads)
+{
+    Mat img(480, 640, CV_8UC1, Scalar::all(0));
+    RNG rng(1);
+    for( int i = 0; i < 20; i++ )
+        line(img, Point(rng.uniform(0, img.cols), rng.uniform(0, img.rows)),
+             Point(rng.uniform(0, img.cols), rng.uniform(0, img.rows)), Scalar::all(255), 2);
+    Mat gray;
+    GaussianBlur(img, gray, Size(9, 9), 2);
+
+    cvtest::ThreadsGuard threadsGuard;
+    vector<Vec2f> lines[2];
+    vector<Vec4i> segments[2];
+    vector<Vec3f> circles[2];
+
+    for( int k = 0; k < 2; k++ )
+    {
+        setNumThreads(k == 0 ? 1 : 4);
+        HoughLines(img, lines[k], 1, CV_PI/180, 80);
+        HoughLinesP(img, segments[k], 1, CV_PI/180, 80, 30, 5);
+        HoughCircles(gray, circles[k], CV_HOUGH_GRADIENT, 2, 20, 100, 20);
+    }
+
+    ASSERT_FALSE(lines[0].empty());
+    ASSERT_FALSE(segments[0].empty());
+    EXPECT_EQ(0, norm(Mat(lines[0]), Mat(lines[1]), NORM_INF));
+    EXPECT_EQ(0, norm(Mat(segments[0]), Mat(segments[1]), NORM_INF));
+    ASSERT_EQ(circles[0].size(), circles[1].size());
+    if( !circles[0].empty() )
+        EXPECT_EQ(0, norm(Mat(circles[0]), Mat(circles[1]), NORM_INF));
+}
+
+TEST(Imgproc_HoughLines, finds_drawn_line)
+{
+    Mat img(200, 300, CV_8UC1, Scalar::all(0));
+    line(img, Point(10, 50), Point(290, 50), Scalar::all(255));
+    line(img, Point(150, 10), Point(150, 190), Scalar::all(255));
+
+    vector<Vec2f> lines;
+    HoughLines(img, lines, 1, CV_PI/180, 150);
+    ASSERT_EQ(2u, lines.size());
+    EXPECT_NEAR(50, lines[0][0], 1);
+    EXPECT_NEAR(CV_PI/2, lines[0][1], 1e-3);
+    EXPECT_NEAR(150, lines[1][0], 1);
+    EXPECT_NEAR(0, lines[1][1], 1e-3);
+
+    vector<Vec4i> segments;
+    HoughLinesP(img, segments, 1, CV_PI/180, 50, 100, 2);
+    ASSERT_EQ(2u, segments.size());
+}
@@ -1384,4 +1384,79 @@ TEST(Imgproc_InitUndistortMap, accuracy) { CV_UndistortMapTest test; test.safe_r
 TEST(Imgproc_GetRectSubPix, accuracy) { CV_GetRectSubPixTest test; test.safe_run(); }
 TEST(Imgproc_GetQuadSubPix, accuracy) { CV_GetQuadSubPixTest test; test.safe_run(); }
 
+static void runWarps(const Mat& src, const Mat& mapx, const Mat& mapy, vector<Mat>& dst)
+{
+    static const int inter[] = { INTER_NEAREST, INTER_LINEAR, INTER_CUBIC, INTER_LANCZOS4 };
+    Mat A = getRotationMatrix2D(Point2f(src.cols*0.4f, src.rows*0.6f), 17, 0.9);
+    Mat P = (Mat_<double>(3, 3) << 0.9, 0.1, 5, -0.05, 1.1, -3, 1e-4, -2e-4, 1);
+    Mat map1, map2;
+    convertMaps(mapx, mapy, map1, map2, CV_16SC2);
+    dst.resize(16);
+
+    for( int i = 0; i < 4; i++ )
+    {
+        warpAffine(src, dst[i*4], A, Size(src.cols + 31, src.rows - 17), inter[i], BORDER_CONSTANT, Scalar::all(77));
+        warpPerspective(src, dst[i*4+1], P, src.size(), inter[i], BORDER_REFLECT);
+        remap(src, dst[i*4+2], mapx, mapy, inter[i], BORDER_REPLICATE);
+        dst[i*4+3] = Mat::zeros(src.size(), src.type());
+        remap(src, dst[i*4+3], map1, map2, inter[i], BORDER_TRANSPARENT);
+    }
+}
+
+TEST(Imgproc_Remap, parallel_tiles_match_serial_result)
+{
+    RNG rng(20120521);
+    Size sz(733, 517);
+    Mat mapx(sz, CV_32F), mapy(sz, CV_32F);
+    rng.fill(mapx, RNG::UNIFORM, -5, sz.width + 5);
+    rng.fill(mapy, RNG::UNIFORM, -5, sz.height + 5);
+
+    static const int types[] = { CV_8UC1, CV_8UC3, CV_16UC1, CV_32FC1, CV_32FC4 };
+    cvtest::ThreadsGuard threadsGuard;
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+    {
+        Mat src(sz, types[t]);
+        rng.fill(src, RNG::UNIFORM, 0, 256);
+
+        vector<Mat> ref, dst;
+        setNumThreads(1);
+        runWarps(src, mapx, mapy, ref);
+        setNumThreads(4);
+        runWarps(src, mapx, mapy, dst);
+
+        for( size_t i = 0; i < ref.size(); i++ )
+            EXPECT_EQ(0, norm(ref[i], dst[i], NORM_INF)) << "type " << types[t] << ", case #" << i;
+    }
+}
+
+TEST(Imgproc_Resize, parallel_bands_match_serial_result)
+{
+    RNG rng(20120604);
+    Size ssize(641, 479);
+    static const Size dsizes[] = { Size(320, 239), Size(213, 157), Size(1000, 700), Size(640, 481) };
+    static const int types[] = { CV_8UC1, CV_8UC3, CV_16UC1, CV_16SC4, CV_32FC1, CV_32FC3, CV_64FC1 };
+    static const int inter[] = { INTER_NEAREST, INTER_LINEAR, INTER_CUBIC, INTER_AREA, INTER_LANCZOS4 };
+    cvtest::ThreadsGuard threadsGuard;
+
+    for( int t = 0; t < (int)(sizeof(types)/sizeof(types[0])); t++ )
+    {
+        Mat src(ssize, types[t]);
+        rng.fill(src, RNG::UNIFORM, 0, 256);
+
+        for( int i = 0; i < (int)(sizeof(inter)/sizeof(inter[0])); i++ )
+            for( int j = 0; j < (int)(sizeof(dsizes)/sizeof(dsizes[0])); j++ )
+            {
+                Mat ref, dst;
+                setNumThreads(1);
+                resize(src, ref, dsizes[j], 0, 0, inter[i]);
+                setNumThreads(4);
+                resize(src, dst, dsizes[j], 0, 0, inter[i]);
+
+                EXPECT_EQ(0, norm(ref, dst, NORM_INF)) << "type " << types[t]
+                    << ", interpolation " << inter[i] << ", dsize " << dsizes[j].width << "x" << dsizes[j].height;
+            }
+    }
+}
+
 /* End of file. */
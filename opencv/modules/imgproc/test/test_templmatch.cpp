@@ -334,3 +334,58 @@ void CV_TemplMatchTest::prepare_to_validation( int /*test_case_idx*/ )
 }
 
 TEST(Imgproc_MatchTemplate, accuracy) { CV_TemplMatchTest test; test.safe_run(); }
+
+TEST(Imgproc_MatchTemplate, matcher_matches_reference)
+{
+    RNG& rng = theRNG();
+    int types[] = { CV_8UC1, CV_8UC3, CV_32FC1, CV_32FC3 };
+
+    for( int t = 0; t < 4; t++ )
+    {
+        Mat img(rng.uniform(50, 100), rng.uniform(50, 100), types[t]);
+        rng.fill(img, RNG::UNIFORM, 0, 256);
+        GaussianBlur(img, img, Size(5, 5), 2);
+
+        vector<Mat> templs;
+        for( int i = 0; i < 3; i++ )
+        {
+            // two templates of the same size share the image block spectra
+            Size tsize = i < 2 ? Size(12, 12) : Size(rng.uniform(1, 25), rng.uniform(1, 25));
+            templs.push_back(img(Rect(rng.uniform(0, img.cols - tsize.width),
+                                      rng.uniform(0, img.rows - tsize.height),
+                                      tsize.width, tsize.height)).clone());
+        }
+
+        for( int method = CV_TM_SQDIFF; method <= CV_TM_CCOEFF_NORMED; method++ )
+        {
+            TemplateMatcher matcher(templs, method);
+            vector<Mat> results;
+            for( int frame = 0; frame < 2; frame++ )
+            {
+                Mat image = frame == 0 ? img : img(Rect(3, 2, img.cols - 10, img.rows - 7));
+                matcher.match(image, results);
+                ASSERT_EQ(templs.size(), results.size());
+
+                for( size_t i = 0; i < templs.size(); i++ )
+                {
+                    Mat ref(image.rows - templs[i].rows + 1, image.cols - templs[i].cols + 1, CV_32F), single;
+                    CvMat _image = image, _templ = templs[i], _ref = ref;
+                    cvTsMatchTemplate(&_image, &_templ, &_ref, method);
+                    matcher.match(image, (int)i, single);
+                    EXPECT_EQ(0, norm(results[i], single, NORM_INF));
+
+                    Mat res = results[i];
+                    if( method >= CV_TM_CCOEFF )
+                    {
+                        // the same shift as in CV_TemplMatchTest, the results near 0 are unstable
+                        ref += Scalar::all(10.);
+                        res = res + Scalar::all(10.);
+                    }
+                    EXPECT_GE(cvtest::cmpEps2(cvtest::TS::ptr(), res, ref, img.depth() == CV_8U ? 1e-2 : 1e-3,
+                                              false, "TemplateMatcher result"), 0)
+                        << "type " << types[t] << ", method " << method << ", template " << i << ", frame " << frame;
+                }
+            }
+        }
+    }
+}
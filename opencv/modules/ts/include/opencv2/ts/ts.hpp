@@ -134,6 +134,19 @@ CV_EXPORTS int cmpEps2( TS* ts, const Mat& data, const Mat& refdata, double succ
     
 CV_EXPORTS int cmpEps2_64f( TS* ts, const double* val, const double* refval, int len,
                         double eps, const char* param_name );
+
+// restores the number of threads on scope exit, so a test that varies it
+// leaves the global setting intact even when a failed ASSERT or an exception ends it
+class ThreadsGuard
+{
+public:
+    ThreadsGuard() : nthreads(cv::getNumThreads()) {}
+    ~ThreadsGuard() { cv::setNumThreads(nthreads); }
+private:
+    ThreadsGuard(const ThreadsGuard&);
+    ThreadsGuard& operator = (const ThreadsGuard&);
+    int nthreads;
+};
     
 CV_EXPORTS void logicOp(const Mat& src1, const Mat& src2, Mat& dst, char c);
 CV_EXPORTS void logicOp(const Mat& src, const Scalar& s, Mat& dst, char c);
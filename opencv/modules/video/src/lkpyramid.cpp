@@ -558,31 +558,40 @@ void cv::calcOpticalFlowPyrLK( InputArray _prevImg, InputArray _nextImg,
     // pixels to simplify the further patch extraction.
     // Thanks to the reference counting, "temp" mat (the pyramid layer + border)
     // will not be deallocated, since {prevPyr|nextPyr}[level] will be a ROI in "temp".
+    // the levels smaller than the window are not used
+    Size sz = prevImg.size();
+    for( level = 0; level < maxLevel; level++ )
+    {
+        sz = Size((sz.width+1)/2, (sz.height+1)/2);
+        if( sz.width <= winSize.width || sz.height <= winSize.height )
+            break;
+    }
+    maxLevel = level;
+
     for( k = 0; k < 2; k++ )
     {
-        Size sz = prevImg.size();
         vector<Mat>& pyr = k == 0 ? prevPyr : nextPyr;
         Mat& img0 = k == 0 ? prevImg : nextImg;
-        
+        vector<Mat> temp(maxLevel+1);
+
+        pyr.resize(maxLevel+1);
+        sz = img0.size();
         for( level = 0; level <= maxLevel; level++ )
         {
-            Mat temp(sz.height + winSize.height*2,
-                     sz.width + winSize.width*2,
-                     img0.type());
-            pyr[level] = temp(Rect(winSize.width, winSize.height, sz.width, sz.height));
-            if( level == 0 )
-                img0.copyTo(pyr[level]);
-            else
-                pyrDown(pyr[level-1], pyr[level], pyr[level].size());
-            copyMakeBorder(pyr[level], temp, winSize.height, winSize.height,
-                           winSize.width, winSize.width, BORDER_REFLECT_101);
+            temp[level].create(sz.height + winSize.height*2,
+                               sz.width + winSize.width*2,
+                               img0.type());
+            pyr[level] = temp[level](Rect(winSize.width, winSize.height, sz.width, sz.height));
             sz = Size((sz.width+1)/2, (sz.height+1)/2);
-            if( sz.width <= winSize.width || sz.height <= winSize.height )
-            {
-                maxLevel = level;
-                break;
-            }
         }
+
+        // the levels are computed right inside the padded buffers
+        img0.copyTo(pyr[0]);
+        buildPyramid(pyr[0], pyr, maxLevel);
+
+        for( level = 0; level <= maxLevel; level++ )
+            copyMakeBorder(pyr[level], temp[level], winSize.height, winSize.height,
+                           winSize.width, winSize.width, BORDER_REFLECT_101|BORDER_ISOLATED);
     }
     // dI/dx ~ Ix, dI/dy ~ Iy
     Mat derivIBuf((prevImg.rows + winSize.height*2),
@@ -606,7 +615,7 @@ void cv::calcOpticalFlowPyrLK( InputArray _prevImg, InputArray _nextImg,
             imgSize.width + winSize.width*2, derivIBuf.type(), derivIBuf.data );
         Mat derivI = _derivI(Rect(winSize.width, winSize.height, imgSize.width, imgSize.height));
         calcSharrDeriv(prevPyr[level], derivI);
-        copyMakeBorder(derivI, _derivI, winSize.height, winSize.height, winSize.width, winSize.width, BORDER_CONSTANT);
+        copyMakeBorder(derivI, _derivI, winSize.height, winSize.height, winSize.width, winSize.width, BORDER_CONSTANT|BORDER_ISOLATED);
         
         Mat I = prevPyr[level], J = nextPyr[level];
         
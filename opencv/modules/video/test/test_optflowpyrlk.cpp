@@ -41,6 +41,9 @@
 
 #include "test_precomp.hpp"
 
+using namespace cv;
+using namespace std;
+
 /* ///////////////////// pyrlk_test ///////////////////////// */
 
 class CV_OptFlowPyrLKTest : public cvtest::BaseTest
@@ -211,4 +214,38 @@ _exit_:
 
 TEST(Video_OpticalFlowPyrLK, accuracy) { CV_OptFlowPyrLKTest test; test.safe_run(); }
 
+TEST(Video_OpticalFlowPyrLK, parallel_matches_serial)
+{
+    string path = cvtest::TS::ptr()->get_data_path() + "optflow/";
+    Mat prev = imread(path + "rock_1.bmp", 0), next = imread(path + "rock_2.bmp", 0);
+    ASSERT_FALSE(prev.empty() || next.empty());
+
+    // odd sizes, so that the pyramid levels are not split into equal bands
+    Rect roi(3, 5, prev.cols - 10, prev.rows - 12);
+    prev = prev(roi);
+    next = next(roi);
+
+    vector<Point2f> prevPts;
+    goodFeaturesToTrack(prev, prevPts, 200, 0.01, 5);
+    ASSERT_FALSE(prevPts.empty());
+
+    cvtest::ThreadsGuard threadsGuard;
+    vector<Point2f> nextPts[2];
+    vector<uchar> status[2];
+    vector<float> err[2];
+    for( int k = 0; k < 2; k++ )
+    {
+        setNumThreads(k == 0 ? 1 : 4);
+        calcOpticalFlowPyrLK(prev, next, prevPts, nextPts[k], status[k], err[k], Size(21, 21), 3);
+    }
+
+    ASSERT_EQ(nextPts[0].size(), nextPts[1].size());
+    for( size_t i = 0; i < prevPts.size(); i++ )
+    {
+        EXPECT_EQ(status[0][i], status[1][i]) << "point #" << i;
+        EXPECT_EQ(nextPts[0][i], nextPts[1][i]) << "point #" << i;
+        EXPECT_EQ(err[0][i], err[1][i]) << "point #" << i;
+    }
+}
+
 /* End of file. */